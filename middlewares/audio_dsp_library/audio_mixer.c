@@ -0,0 +1,164 @@
+/**
+  **************************************************************************
+  * @file     audio_mixer.c
+  * @brief    software volume and mute
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "audio_mixer.h"
+
+/** @addtogroup AT32F415_middlewares_audio_dsp_library
+  * @{
+  */
+
+/** @defgroup AUDIO_MIXER_library
+  * @brief software volume and mute
+  * @{
+  */
+
+/**
+  * @brief q15 gain of 0 to AUDIO_MIXER_RANGE_DB db of attenuation
+  */
+static const int16_t audio_mixer_db_table[AUDIO_MIXER_RANGE_DB + 1] =
+{
+  32767, 29204, 26028, 23197, 20675, 18426, 16422, 14636, 13045, 11626,
+  10362,  9235,  8231,  7336,  6538,  5827,  5193,  4628,  4125,  3677,
+   3277,  2920,  2603,  2320,  2067,  1843,  1642,  1464,  1304,  1163,
+   1036,   923,   823,   734,   654,   583,   519,   463,   413,   368,
+    328,   292,   260,   232,   207,   184,   164,   146,   130,   116,
+    104,    92,    82,    73,    65,    58,    52,    46,    41,    37,
+     33
+};
+
+/**
+  * @brief  start the ramp to the gain given by volume and mute.
+  * @param  mixer: mixer
+  * @retval none
+  */
+static void audio_mixer_update(audio_mixer_type *mixer)
+{
+  int32_t target = (mixer->mute ? 0 : mixer->volume) << 8;
+
+  mixer->target = target;
+  mixer->step = (target - mixer->gain) / AUDIO_MIXER_RAMP_FRAMES;
+  if(mixer->step == 0)
+  {
+    mixer->step = (target > mixer->gain) ? 1 : -1;
+  }
+}
+
+/**
+  * @brief  initialize a mixer at unity gain, not muted.
+  * @param  mixer: mixer
+  * @param  channels: interleaved channels
+  * @retval none
+  */
+void audio_mixer_init(audio_mixer_type *mixer, uint8_t channels)
+{
+  mixer->channels = channels;
+  mixer->volume = AUDIO_MIXER_UNITY;
+  mixer->mute = 0;
+  mixer->gain = AUDIO_MIXER_UNITY << 8;
+  mixer->target = mixer->gain;
+  mixer->step = 0;
+}
+
+/**
+  * @brief  set the volume.
+  * @param  mixer: mixer
+  * @param  attenuation_db: 0 for full scale, above AUDIO_MIXER_RANGE_DB is off
+  * @retval none
+  */
+void audio_mixer_set_volume(audio_mixer_type *mixer, uint8_t attenuation_db)
+{
+  mixer->volume = (attenuation_db > AUDIO_MIXER_RANGE_DB) ? 0 : audio_mixer_db_table[attenuation_db];
+  audio_mixer_update(mixer);
+}
+
+/**
+  * @brief  set the mute state.
+  * @param  mixer: mixer
+  * @param  mute: TRUE to mute
+  * @retval none
+  */
+void audio_mixer_set_mute(audio_mixer_type *mixer, confirm_state mute)
+{
+  mixer->mute = (uint8_t)mute;
+  audio_mixer_update(mixer);
+}
+
+/**
+  * @brief  apply the gain in place.
+  * @param  mixer: mixer
+  * @param  buf: interleaved q15 frames
+  * @param  frames: number of frames
+  * @retval none
+  */
+void audio_mixer_process(audio_mixer_type *mixer, int16_t *buf, uint32_t frames)
+{
+  int32_t gain;
+  uint8_t ch;
+
+  /* settled: nothing to do at unity, and a plain multiply otherwise */
+  if(mixer->gain == mixer->target)
+  {
+    gain = mixer->gain >> 8;
+    if(gain == AUDIO_MIXER_UNITY)
+    {
+      return;
+    }
+    frames *= mixer->channels;
+    while(frames--)
+    {
+      *buf = (int16_t)((*buf * gain + 0x4000) >> 15);
+      buf++;
+    }
+    return;
+  }
+
+  while(frames--)
+  {
+    if(mixer->gain != mixer->target)
+    {
+      mixer->gain += mixer->step;
+      if(((mixer->step > 0) && (mixer->gain > mixer->target)) ||
+         ((mixer->step < 0) && (mixer->gain < mixer->target)))
+      {
+        mixer->gain = mixer->target;
+      }
+    }
+    gain = mixer->gain >> 8;
+    for(ch = 0; ch < mixer->channels; ch++)
+    {
+      *buf = (int16_t)((*buf * gain + 0x4000) >> 15);
+      buf++;
+    }
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,100 @@
+/**
+  **************************************************************************
+  * @file     audio_mixer.h
+  * @brief    software volume and mute header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_MIXER_H
+#define __AUDIO_MIXER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_audio_dsp_library
+  * @{
+  */
+
+/** @defgroup AUDIO_MIXER_library_definition
+  * @{
+  */
+
+/**
+  * @brief volume in db of attenuation, 0 to AUDIO_MIXER_RANGE_DB, more is off.
+  *        gain changes ramp linearly over AUDIO_MIXER_RAMP_FRAMES frames so that
+  *        volume and mute changes do not click.
+  */
+#define AUDIO_MIXER_RANGE_DB             60
+#define AUDIO_MIXER_RAMP_FRAMES          256
+#define AUDIO_MIXER_UNITY                32767    /* q15 gain passed through unchanged */
+
+/**
+  * @}
+  */
+
+/** @defgroup AUDIO_MIXER_library_handler
+  * @{
+  */
+
+/**
+  * @brief volume and mute of one interleaved q15 stream
+  */
+typedef struct
+{
+  int32_t                                gain;                    /*!< current gain, q15 << 8          */
+  int32_t                                target;                  /*!< gain to ramp to, q15 << 8       */
+  int32_t                                step;                    /*!< ramp step per frame             */
+  int16_t                                volume;                  /*!< gain when not muted, q15        */
+  uint8_t                                mute;                    /*!< mute state                      */
+  uint8_t                                channels;                /*!< interleaved channels            */
+} audio_mixer_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup AUDIO_MIXER_library_exported_functions
+  * @{
+  */
+
+void              audio_mixer_init              (audio_mixer_type *mixer, uint8_t channels);
+void              audio_mixer_set_volume        (audio_mixer_type *mixer, uint8_t attenuation_db);
+void              audio_mixer_set_mute          (audio_mixer_type *mixer, confirm_state mute);
+void              audio_mixer_process           (audio_mixer_type *mixer, int16_t *buf, uint32_t frames);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
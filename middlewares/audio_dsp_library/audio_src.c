@@ -0,0 +1,413 @@
+/**
+  **************************************************************************
+  * @file     audio_src.c
+  * @brief    fixed-point polyphase sample rate converter
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "audio_src.h"
+#include <string.h>
+
+/** @addtogroup AT32F415_middlewares_audio_dsp_library
+  * @{
+  */
+
+/** @defgroup AUDIO_SRC_library
+  * @brief fixed-point polyphase sample rate converter
+  * @{
+  */
+
+#define AUDIO_SRC_PROTO_SIZE             (AUDIO_SRC_ZERO_CROSSINGS / 2 * AUDIO_SRC_PROTO_RES + 1)
+
+/**
+  * @brief right half of the prototype, sinc(0.9 * t) with a kaiser window
+  *        (beta 7), t from 0 to AUDIO_SRC_ZERO_CROSSINGS / 2 in steps of
+  *        1 / AUDIO_SRC_PROTO_RES, q15.
+  */
+static const int16_t audio_src_prototype[AUDIO_SRC_PROTO_SIZE] =
+{
+   32767,  32764,  32756,  32743,  32724,  32699,  32670,  32634,  32594,  32548,  32497,  32440,
+   32378,  32311,  32239,  32161,  32078,  31990,  31896,  31798,  31694,  31585,  31472,  31353,
+   31229,  31100,  30966,  30828,  30684,  30536,  30383,  30226,  30063,  29897,  29725,  29549,
+   29369,  29184,  28995,  28802,  28604,  28402,  28196,  27986,  27772,  27555,  27333,  27108,
+   26878,  26646,  26409,  26169,  25926,  25679,  25429,  25176,  24919,  24660,  24398,  24132,
+   23864,  23593,  23319,  23043,  22764,  22483,  22199,  21913,  21625,  21335,  21043,  20749,
+   20452,  20155,  19855,  19554,  19251,  18947,  18642,  18335,  18027,  17718,  17408,  17097,
+   16785,  16472,  16159,  15845,  15531,  15216,  14901,  14586,  14271,  13955,  13640,  13324,
+   13009,  12694,  12380,  12066,  11752,  11439,  11127,  10815,  10505,  10195,   9886,   9579,
+    9272,   8967,   8663,   8360,   8059,   7760,   7462,   7166,   6871,   6579,   6288,   6000,
+    5713,   5428,   5146,   4866,   4588,   4313,   4040,   3769,   3501,   3236,   2973,   2714,
+    2456,   2202,   1951,   1702,   1457,   1214,    975,    739,    506,    276,     50,   -173,
+    -393,   -609,   -822,  -1032,  -1238,  -1440,  -1639,  -1834,  -2026,  -2214,  -2398,  -2579,
+   -2756,  -2929,  -3098,  -3263,  -3425,  -3583,  -3737,  -3887,  -4033,  -4175,  -4314,  -4448,
+   -4579,  -4706,  -4828,  -4947,  -5062,  -5173,  -5280,  -5383,  -5482,  -5577,  -5669,  -5756,
+   -5840,  -5919,  -5995,  -6067,  -6135,  -6199,  -6260,  -6316,  -6369,  -6418,  -6463,  -6505,
+   -6543,  -6577,  -6608,  -6635,  -6658,  -6678,  -6695,  -6707,  -6717,  -6723,  -6725,  -6725,
+   -6721,  -6713,  -6703,  -6689,  -6672,  -6652,  -6629,  -6603,  -6574,  -6542,  -6507,  -6469,
+   -6428,  -6385,  -6339,  -6290,  -6239,  -6185,  -6129,  -6070,  -6009,  -5945,  -5879,  -5811,
+   -5741,  -5668,  -5594,  -5517,  -5439,  -5358,  -5276,  -5192,  -5106,  -5018,  -4929,  -4838,
+   -4746,  -4653,  -4557,  -4461,  -4363,  -4264,  -4164,  -4063,  -3961,  -3857,  -3753,  -3648,
+   -3542,  -3435,  -3328,  -3220,  -3111,  -3002,  -2892,  -2782,  -2671,  -2561,  -2450,  -2338,
+   -2227,  -2115,  -2004,  -1892,  -1781,  -1669,  -1558,  -1447,  -1336,  -1226,  -1116,  -1006,
+    -897,   -788,   -680,   -573,   -466,   -360,   -254,   -150,    -46,     57,    159,    260,
+     360,    459,    557,    654,    750,    845,    938,   1030,   1121,   1210,   1298,   1385,
+    1471,   1554,   1637,   1718,   1797,   1875,   1952,   2026,   2099,   2171,   2241,   2309,
+    2375,   2440,   2503,   2564,   2624,   2682,   2737,   2792,   2844,   2894,   2943,   2990,
+    3035,   3078,   3119,   3158,   3196,   3231,   3265,   3297,   3327,   3355,   3381,   3405,
+    3428,   3448,   3467,   3484,   3499,   3512,   3523,   3532,   3540,   3546,   3550,   3552,
+    3552,   3551,   3548,   3543,   3537,   3528,   3518,   3507,   3493,   3479,   3462,   3444,
+    3424,   3403,   3380,   3356,   3330,   3303,   3275,   3245,   3213,   3180,   3146,   3111,
+    3074,   3036,   2997,   2957,   2915,   2873,   2829,   2784,   2738,   2691,   2643,   2595,
+    2545,   2494,   2443,   2390,   2337,   2283,   2228,   2173,   2117,   2060,   2003,   1945,
+    1887,   1828,   1768,   1708,   1648,   1587,   1526,   1465,   1404,   1342,   1280,   1217,
+    1155,   1092,   1030,    967,    904,    842,    779,    716,    654,    591,    529,    467,
+     405,    343,    282,    221,    160,    100,     40,    -20,    -79,   -138,   -196,   -254,
+    -311,   -367,   -424,   -479,   -534,   -588,   -641,   -694,   -746,   -798,   -848,   -898,
+    -947,   -995,  -1043,  -1089,  -1135,  -1180,  -1223,  -1266,  -1308,  -1349,  -1390,  -1429,
+   -1467,  -1504,  -1540,  -1575,  -1610,  -1643,  -1675,  -1706,  -1736,  -1764,  -1792,  -1819,
+   -1844,  -1869,  -1892,  -1915,  -1936,  -1956,  -1975,  -1993,  -2010,  -2025,  -2040,  -2053,
+   -2065,  -2077,  -2087,  -2096,  -2104,  -2110,  -2116,  -2121,  -2124,  -2127,  -2128,  -2128,
+   -2127,  -2126,  -2123,  -2119,  -2114,  -2108,  -2101,  -2093,  -2084,  -2074,  -2063,  -2051,
+   -2038,  -2025,  -2010,  -1995,  -1978,  -1961,  -1943,  -1924,  -1904,  -1883,  -1862,  -1840,
+   -1817,  -1793,  -1769,  -1744,  -1718,  -1691,  -1664,  -1636,  -1608,  -1579,  -1549,  -1519,
+   -1488,  -1457,  -1425,  -1393,  -1360,  -1327,  -1293,  -1259,  -1225,  -1190,  -1155,  -1119,
+   -1083,  -1047,  -1011,   -974,   -937,   -900,   -863,   -825,   -788,   -750,   -712,   -674,
+    -636,   -598,   -560,   -522,   -484,   -445,   -407,   -369,   -331,   -293,   -256,   -218,
+    -181,   -143,   -106,    -69,    -32,      4,     40,     76,    112,    147,    182,    217,
+     251,    286,    319,    352,    385,    418,    450,    481,    512,    543,    573,    603,
+     632,    661,    689,    716,    743,    770,    796,    821,    846,    870,    894,    917,
+     939,    961,    982,   1002,   1022,   1041,   1060,   1078,   1095,   1112,   1127,   1143,
+    1157,   1171,   1184,   1197,   1209,   1220,   1230,   1240,   1249,   1257,   1265,   1272,
+    1278,   1284,   1289,   1293,   1297,   1300,   1302,   1304,   1305,   1305,   1305,   1304,
+    1302,   1300,   1297,   1293,   1289,   1284,   1279,   1273,   1266,   1259,   1251,   1243,
+    1234,   1225,   1215,   1204,   1193,   1181,   1169,   1157,   1144,   1130,   1116,   1102,
+    1087,   1071,   1055,   1039,   1023,   1006,    988,    970,    952,    934,    915,    896,
+     876,    857,    837,    816,    796,    775,    754,    732,    711,    689,    667,    645,
+     623,    600,    578,    555,    532,    509,    486,    463,    440,    417,    393,    370,
+     347,    323,    300,    277,    254,    230,    207,    184,    161,    138,    115,     92,
+      70,     47,     25,      2,    -20,    -42,    -63,    -85,   -106,   -127,   -148,   -169,
+    -190,   -210,   -230,   -249,   -269,   -288,   -307,   -326,   -344,   -362,   -380,   -397,
+    -414,   -431,   -447,   -463,   -479,   -494,   -509,   -524,   -538,   -552,   -566,   -579,
+    -592,   -604,   -616,   -627,   -639,   -649,   -660,   -670,   -679,   -688,   -697,   -705,
+    -713,   -721,   -728,   -734,   -741,   -746,   -752,   -757,   -761,   -765,   -769,   -772,
+    -775,   -778,   -780,   -782,   -783,   -784,   -784,   -784,   -784,   -783,   -782,   -781,
+    -779,   -776,   -774,   -771,   -767,   -764,   -760,   -755,   -751,   -745,   -740,   -734,
+    -728,   -722,   -715,   -708,   -700,   -693,   -685,   -677,   -668,   -659,   -650,   -641,
+    -631,   -622,   -612,   -601,   -591,   -580,   -569,   -558,   -547,   -535,   -524,   -512,
+    -500,   -487,   -475,   -463,   -450,   -437,   -424,   -411,   -398,   -385,   -372,   -358,
+    -345,   -331,   -318,   -304,   -290,   -277,   -263,   -249,   -235,   -222,   -208,   -194,
+    -180,   -166,   -152,   -139,   -125,   -111,    -98,    -84,    -71,    -57,    -44,    -31,
+     -17,     -4,      9,     22,     34,     47,     59,     72,     84,     96,    108,    120,
+     132,    143,    155,    166,    177,    188,    198,    209,    219,    229,    239,    249,
+     258,    267,    277,    285,    294,    302,    311,    319,    326,    334,    341,    348,
+     355,    362,    368,    374,    380,    386,    391,    396,    401,    406,    410,    415,
+     419,    422,    426,    429,    432,    435,    437,    439,    441,    443,    445,    446,
+     447,    448,    448,    449,    449,    449,    448,    448,    447,    446,    445,    443,
+     442,    440,    438,    436,    433,    430,    428,    424,    421,    418,    414,    410,
+     406,    402,    398,    393,    389,    384,    379,    374,    369,    363,    358,    352,
+     346,    340,    334,    328,    322,    315,    309,    302,    296,    289,    282,    275,
+     268,    261,    254,    246,    239,    232,    224,    217,    209,    202,    194,    186,
+     179,    171,    163,    156,    148,    140,    132,    125,    117,    109,    101,     94,
+      86,     78,     71,     63,     56,     48,     41,     33,     26,     18,     11,      4,
+      -3,    -10,    -17,    -24,    -31,    -38,    -45,    -51,    -58,    -64,    -71,    -77,
+     -83,    -89,    -95,   -101,   -107,   -112,   -118,   -123,   -129,   -134,   -139,   -144,
+    -149,   -154,   -158,   -163,   -167,   -171,   -176,   -180,   -183,   -187,   -191,   -194,
+    -198,   -201,   -204,   -207,   -210,   -212,   -215,   -217,   -219,   -222,   -224,   -225,
+    -227,   -229,   -230,   -232,   -233,   -234,   -235,   -236,   -236,   -237,   -237,   -238,
+    -238,   -238,   -238,   -238,   -237,   -237,   -236,   -236,   -235,   -234,   -233,   -232,
+    -231,   -229,   -228,   -226,   -225,   -223,   -221,   -219,   -217,   -215,   -213,   -211,
+    -208,   -206,   -203,   -200,   -198,   -195,   -192,   -189,   -186,   -183,   -180,   -177,
+    -174,   -170,   -167,   -164,   -160,   -157,   -153,   -149,   -146,   -142,   -138,   -135,
+    -131,   -127,   -123,   -119,   -115,   -112,   -108,   -104,   -100,    -96,    -92,    -88,
+     -84,    -80,    -76,    -72,    -68,    -64,    -60,    -56,    -52,    -48,    -44,    -40,
+     -36,    -33,    -29,    -25,    -21,    -17,    -14,    -10,     -6,     -3,      1,      4,
+       8,     11,     15,     18,     21,     25,     28,     31,     34,     37,     40,     43,
+      46,     49,     52,     55,     57,     60,     63,     65,     68,     70,     72,     75,
+      77,     79,     81,     83,     85,     87,     89,     90,     92,     94,     95,     97,
+      98,     99,    101,    102,    103,    104,    105,    106,    107,    108,    108,    109,
+     110,    110,    111,    111,    111,    112,    112,    112,    112,    112,    112,    112,
+     112,    112,    112,    111,    111,    111,    110,    110,    109,    108,    108,    107,
+     106,    105,    105,    104,    103,    102,    101,    100,     98,     97,     96,     95,
+      94,     92,     91,     90,     88,     87,     85,     84,     82,     81,     79,     78,
+      76,     74,     73,     71,     69,     68,     66,     64,     63,     61,     59,     57,
+      55,     54,     52,     50,     48,     46,     45,     43,     41,     39,     37,     36,
+      34,     32,     30,     28,     27,     25,     23,     21,     20,     18,     16,     15,
+      13,     11,     10,      8,      6,      5,      3,      2,      0,     -2,     -3,     -5,
+      -6,     -7,     -9,    -10,    -12,    -13,    -14,    -16,    -17,    -18,    -19,    -20,
+     -22,    -23,    -24,    -25,    -26,    -27,    -28,    -29,    -30,    -31,    -32,    -32,
+     -33,    -34,    -35,    -35,    -36,    -37,    -37,    -38,    -39,    -39,    -40,    -40,
+     -41,    -41,    -41,    -42,    -42,    -43,    -43,    -43,    -43,    -43,    -44,    -44,
+     -44,    -44,    -44,    -44,    -44,    -44,    -44,    -44,    -44,    -44,    -44,    -44,
+     -43,    -43,    -43,    -43,    -43,    -42,    -42,    -42,    -41,    -41,    -41,    -40,
+     -40,    -39,    -39,    -39,    -38,    -38,    -37,    -37,    -36,    -36,    -35,    -35,
+     -34,    -33,    -33,    -32,    -32,    -31,    -30,    -30,    -29,    -28,    -28,    -27,
+     -27,    -26,    -25,    -25,    -24,    -23,    -23,    -22,    -21,    -21,    -20,    -19,
+     -18,    -18,    -17,    -16,    -16,    -15,    -14,    -14,    -13,    -12,    -12,    -11,
+     -11,    -10,     -9,     -9,     -8,     -7,     -7,     -6,     -6,     -5,     -4,     -4,
+      -3,     -3,     -2,     -2,     -1,     -1,      0,      0,      1,      1,      2,      2,
+       3,      3,      4,      4,      4,      5,      5,      6,      6,      6,      7,      7,
+       7,      8,      8,      8,      9,      9,      9,      9,     10,     10,     10,     10,
+      10,     11,     11,     11,     11,     11,     11,     11,     12,     12,     12,     12,
+      12,     12,     12,     12,     12,     12,     12,     12,     12,     12,     12,     12,
+      12,     12,     12,     12,     12,     12,     12,     12,     12,     12,     11,     11,
+      11,     11,     11,     11,     11,     11,     10,     10,     10,     10,     10,     10,
+      10,      9,      9,      9,      9,      9,      9,      8,      8,      8,      8,      8,
+       8,      7,      7,      7,      7,      7,      6,      6,      6,      6,      6,      6,
+       5,      5,      5,      5,      5,      5,      4,      4,      4,      4,      4,      4,
+       0
+};
+
+/**
+  * @brief  greatest common divisor.
+  */
+static uint32_t audio_src_gcd(uint32_t a, uint32_t b)
+{
+  uint32_t t;
+
+  while(b != 0)
+  {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/**
+  * @brief  dot product of a history window and a coefficient row, two taps per
+  *         smlad. the history window is not word aligned.
+  * @param  x: oldest sample of the window
+  * @param  h: coefficient row
+  * @param  taps: window length, multiple of 4
+  * @retval q30 sum
+  */
+static int32_t audio_src_dot(const int16_t *x, const int16_t *h, uint16_t taps)
+{
+  int32_t acc = 0;
+
+  while(taps != 0)
+  {
+    acc = (int32_t)__SMLAD(__UNALIGNED_UINT32_READ(x), __UNALIGNED_UINT32_READ(h), (uint32_t)acc);
+    acc = (int32_t)__SMLAD(__UNALIGNED_UINT32_READ(x + 2), __UNALIGNED_UINT32_READ(h + 2), (uint32_t)acc);
+    x += 4;
+    h += 4;
+    taps -= 4;
+  }
+
+  return acc;
+}
+
+/**
+  * @brief  initialize a converter. the coefficient rows are the prototype
+  *         stretched to the lower of the two rates, one row per output phase
+  *         plus one, each row normalized to unity gain.
+  * @param  src: converter
+  * @param  in_freq: input rate in hz
+  * @param  out_freq: output rate in hz
+  * @param  channels: interleaved channels, 1 to AUDIO_SRC_CHANNELS_MAX
+  * @retval ERROR when the ratio does not fit the coefficient and history sizes
+  */
+error_status audio_src_init(audio_src_type *src, uint32_t in_freq, uint32_t out_freq, uint8_t channels)
+{
+  uint32_t phases, taps, row, tap, peak, index, weight, scale_num, scale_den;
+  uint64_t position;
+  int32_t value, sum, residue;
+  int16_t *h;
+
+  if((in_freq == 0) || (out_freq == 0) || (channels == 0) || (channels > AUDIO_SRC_CHANNELS_MAX))
+  {
+    return ERROR;
+  }
+
+  /* exact phases when the output grid repeats within AUDIO_SRC_PHASES outputs */
+  phases = out_freq / audio_src_gcd(in_freq, out_freq);
+  if(phases > AUDIO_SRC_PHASES)
+  {
+    phases = AUDIO_SRC_PHASES;
+  }
+
+  /* decimation stretches the filter over in_freq / out_freq more inputs */
+  scale_num = 1;
+  scale_den = 1;
+  taps = AUDIO_SRC_ZERO_CROSSINGS;
+  if(in_freq > out_freq)
+  {
+    scale_num = out_freq;
+    scale_den = in_freq;
+    taps = (AUDIO_SRC_ZERO_CROSSINGS * in_freq + out_freq - 1) / out_freq;
+  }
+  taps = (taps + 3) & ~3;
+
+  if((taps > AUDIO_SRC_TAPS_MAX) || ((phases + 1) * taps > AUDIO_SRC_COEF_MAX))
+  {
+    return ERROR;
+  }
+
+  src->in_freq = in_freq;
+  src->out_freq = out_freq;
+  src->phases = phases;
+  src->taps = taps;
+  src->channels = channels;
+
+  for(row = 0; row <= phases; row++)
+  {
+    h = &src->coef[row * taps];
+    sum = 0;
+    peak = 0;
+
+    for(tap = 0; tap < taps; tap++)
+    {
+      /* distance of tap to the output point in inputs is (taps / 2 - 1 - tap) + row / phases,
+         scaled to the lower rate and to prototype points */
+      value = (int32_t)(taps / 2 - 1 - tap) * (int32_t)phases + (int32_t)row;
+      position = (uint64_t)(value < 0 ? -value : value) * AUDIO_SRC_PROTO_RES * scale_num;
+      index = (uint32_t)(position / ((uint64_t)phases * scale_den));
+      weight = (uint32_t)(((position % ((uint64_t)phases * scale_den)) << 16) / ((uint64_t)phases * scale_den));
+
+      value = 0;
+      if(index < AUDIO_SRC_PROTO_SIZE - 1)
+      {
+        value = audio_src_prototype[index] +
+                (((audio_src_prototype[index + 1] - audio_src_prototype[index]) * (int32_t)weight) >> 16);
+      }
+      h[tap] = (int16_t)value;
+      sum += value;
+    }
+
+    /* unity gain for every row, the rounding residue goes to the largest tap */
+    residue = 32768;
+    for(tap = 0; tap < taps; tap++)
+    {
+      value = (int32_t)(((int64_t)h[tap] * 32768 + sum / 2) / sum);
+      h[tap] = (int16_t)__SSAT(value, 16);
+      residue -= h[tap];
+      if(h[tap] > h[peak])
+      {
+        peak = tap;
+      }
+    }
+    h[peak] = (int16_t)__SSAT(h[peak] + residue, 16);
+  }
+
+  audio_src_reset(src);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  clear the history and restart the output phase.
+  * @param  src: converter
+  * @retval none
+  */
+void audio_src_reset(audio_src_type *src)
+{
+  memset(src->history, 0, sizeof(src->history));
+  src->pos = 0;
+  src->acc = 0;
+  src->pending = 0;
+}
+
+/**
+  * @brief  convert interleaved q15 frames until the input is used up or the
+  *         output is full, the state carries over to the next call.
+  * @param  src: converter
+  * @param  in: input frames
+  * @param  in_frames: input frames available, returns the frames consumed
+  * @param  out: output frames
+  * @param  out_frames: output room in frames
+  * @retval output frames written
+  */
+uint32_t audio_src_process(audio_src_type *src, const int16_t *in, uint32_t *in_frames, int16_t *out, uint32_t out_frames)
+{
+  uint32_t consumed = 0, produced = 0;
+  uint32_t taps = src->taps, phase, frac;
+  const int16_t *h;
+  const int16_t *x;
+  int32_t y0, y1;
+  uint8_t ch;
+
+  while(produced < out_frames)
+  {
+    /* bring the history up to the next output point */
+    while(src->pending != 0)
+    {
+      if(consumed == *in_frames)
+      {
+        *in_frames = consumed;
+        return produced;
+      }
+
+      if(++src->pos == taps)
+      {
+        src->pos = 0;
+      }
+      for(ch = 0; ch < src->channels; ch++)
+      {
+        src->history[ch][src->pos] = *in;
+        src->history[ch][src->pos + taps] = *in++;
+      }
+      consumed++;
+      src->pending--;
+    }
+
+    /* row and q15 fraction of the output point between two rows */
+    phase = src->acc * src->phases;
+    frac = phase % src->out_freq;
+    h = &src->coef[(phase / src->out_freq) * taps];
+    if(frac != 0)
+    {
+      frac = (frac << 15) / src->out_freq;
+    }
+
+    for(ch = 0; ch < src->channels; ch++)
+    {
+      x = &src->history[ch][src->pos + 1];
+      y0 = (audio_src_dot(x, h, taps) + 0x4000) >> 15;
+      if(frac != 0)
+      {
+        y1 = (audio_src_dot(x, h + taps, taps) + 0x4000) >> 15;
+        y0 += ((y1 - y0) * (int32_t)frac) >> 15;
+      }
+      *out++ = (int16_t)__SSAT(y0, 16);
+    }
+    produced++;
+
+    src->acc += src->in_freq;
+    while(src->acc >= src->out_freq)
+    {
+      src->acc -= src->out_freq;
+      src->pending++;
+    }
+  }
+
+  *in_frames = consumed;
+  return produced;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,114 @@
+/**
+  **************************************************************************
+  * @file     audio_src.h
+  * @brief    fixed-point polyphase sample rate converter header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_SRC_H
+#define __AUDIO_SRC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_audio_dsp_library
+  * @{
+  */
+
+/** @defgroup AUDIO_SRC_library_definition
+  * @{
+  */
+
+/**
+  * @brief the converter is a polyphase fir built at init from a kaiser windowed
+  *        sinc prototype (cutoff 0.45 of the lower rate, about 70 db stopband,
+  *        50 to 66 db with the rows rounded to q15, see host_test).
+  *        AUDIO_SRC_ZERO_CROSSINGS is the filter length in samples of the lower
+  *        rate. ratios with at most AUDIO_SRC_PHASES phases (8/16/32 <-> 48 khz)
+  *        are exact, other ratios (44.1 <-> 48 khz) interpolate between phases.
+  */
+#define AUDIO_SRC_ZERO_CROSSINGS         24
+#define AUDIO_SRC_PROTO_RES              128      /* prototype points per sample */
+#define AUDIO_SRC_PHASES                 32
+
+/**
+  * @brief sizes for the supported ratios, the worst cases are 48 -> 8 khz for
+  *        the taps and 48 -> 44.1 khz for the coefficients.
+  */
+#define AUDIO_SRC_CHANNELS_MAX           2
+#define AUDIO_SRC_TAPS_MAX               144
+#define AUDIO_SRC_COEF_MAX               1024
+
+/**
+  * @}
+  */
+
+/** @defgroup AUDIO_SRC_library_handler
+  * @{
+  */
+
+/**
+  * @brief sample rate converter, samples are q15 with interleaved channels
+  */
+typedef struct
+{
+  uint32_t                               in_freq;                 /*!< input rate                      */
+  uint32_t                               out_freq;                /*!< output rate                     */
+  uint32_t                               acc;                     /*!< output position, 1/out_freq     */
+  uint16_t                               phases;                  /*!< coefficient rows minus one      */
+  uint16_t                               taps;                    /*!< taps per row, multiple of 4     */
+  uint16_t                               pos;                     /*!< history write position          */
+  uint16_t                               pending;                 /*!< inputs due before next output   */
+  uint8_t                                channels;                /*!< interleaved channels            */
+  int16_t                                coef[AUDIO_SRC_COEF_MAX];                                  /*!< phase rows       */
+  int16_t                                history[AUDIO_SRC_CHANNELS_MAX][AUDIO_SRC_TAPS_MAX * 2];   /*!< mirrored history */
+} audio_src_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup AUDIO_SRC_library_exported_functions
+  * @{
+  */
+
+error_status      audio_src_init                (audio_src_type *src, uint32_t in_freq, uint32_t out_freq, uint8_t channels);
+void              audio_src_reset               (audio_src_type *src);
+uint32_t          audio_src_process             (audio_src_type *src, const int16_t *in, uint32_t *in_frames, int16_t *out, uint32_t out_frames);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,306 @@
+/**
+  **************************************************************************
+  * @file     audio_dsp_host_test.c
+  * @brief    host bench of the audio sample rate converter and mixer
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs the q15 converter and mixer on the host. the dsp instructions are
+ * replaced by bit exact c in at32_host.h, so the output is the output of the
+ * target. every converter the usb audio example builds is fed in 1 ms
+ * packets as the example does:
+ * - thd+n of a 997 hz tone at -6 dbfs, from a least squares fit of the tone
+ *   and a dc offset, the residual taken over the whole output band
+ * - gain of a tone at 0.4 of the lower rate (passband edge)
+ * - down: level of a tone at 0.6 of the output rate, folded into the
+ *   output; up: level of the image of the 997 hz tone around the input rate
+ * - output frames per second of input
+ * the mixer must pass unity gain through bit exact, reach the gain of each
+ * db step, ramp without steps larger than one ramp step and mute to 0.
+ * the converters are timed in host ns per output frame, with the count of
+ * dual multiply-accumulates per stereo output frame. neither is a target
+ * cycle count.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "audio_src.h"
+#include "audio_mixer.h"
+
+#define TONE_FREQ                        997.0
+#define TONE_LEVEL                       (0.5 * 32767)
+#define RUN_SECONDS                      1
+#define THDN_MAX_DB                      -70.0
+#define PASSBAND_MAX_DB                  1.0
+#define STOPBAND_MIN_DB                  45.0
+
+typedef struct
+{
+  uint32_t in_freq;
+  uint32_t out_freq;
+} audio_rate_type;
+
+static const audio_rate_type rates[] =
+{
+  { 8000, 48000}, {16000, 48000}, {32000, 48000}, {44100, 48000}, {48000, 48000},
+  {48000,  8000}, {48000, 16000}, {48000, 32000}, {48000, 44100},
+};
+
+static audio_src_type src;
+static audio_mixer_type mixer;
+static int16_t in_buf[48000 * RUN_SECONDS * 2], out_buf[(48000 * RUN_SECONDS + 64) * 2];
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* a tone on both channels, the right one a quarter period ahead */
+static void tone(uint32_t freq, double tone_freq, uint32_t frames)
+{
+  uint32_t index;
+
+  for(index = 0; index < frames; index++)
+  {
+    in_buf[index * 2] = (int16_t)lrint(TONE_LEVEL * sin(2 * M_PI * tone_freq * index / freq));
+    in_buf[index * 2 + 1] = (int16_t)lrint(TONE_LEVEL * cos(2 * M_PI * tone_freq * index / freq));
+  }
+}
+
+/* convert the input in 1 ms packets, 44.1 khz packets are 44 or 45 frames */
+static uint32_t convert(const audio_rate_type *rate, uint32_t in_frames, double *ns)
+{
+  uint32_t used = 0, produced = 0, acc = 0, frames, taken;
+  struct timespec start, stop;
+
+  audio_src_reset(&src);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  while(used < in_frames)
+  {
+    acc += rate->in_freq;
+    frames = acc / 1000;
+    acc %= 1000;
+    if(used + frames > in_frames)
+    {
+      frames = in_frames - used;
+    }
+    taken = frames;
+    produced += audio_src_process(&src, &in_buf[used * 2], &taken, &out_buf[produced * 2],
+                                  sizeof(out_buf) / sizeof(out_buf[0]) / 2 - produced);
+    CHECK(taken == frames);
+    used += taken;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &stop);
+  if(ns != NULL)
+  {
+    *ns = ((stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec)) / produced;
+  }
+  return produced;
+}
+
+/* least squares fit of a tone and a dc offset to one channel from frame
+   skip on, returns the tone amplitude and the residual power against it
+   in db */
+static double fit(uint32_t frames, uint8_t channel, double tone_freq, double freq, uint32_t skip, double *residual_db)
+{
+  double a[3][4] = {{0}}, x[3], w, basis[3], fit_value, error, signal = 0, residual = 0, m;
+  uint32_t index;
+  int row, col, k;
+
+  for(index = skip; index < frames; index++)
+  {
+    w = 2 * M_PI * tone_freq * index / freq;
+    basis[0] = sin(w);
+    basis[1] = cos(w);
+    basis[2] = 1;
+    for(row = 0; row < 3; row++)
+    {
+      for(col = 0; col < 3; col++)
+      {
+        a[row][col] += basis[row] * basis[col];
+      }
+      a[row][3] += basis[row] * out_buf[index * 2 + channel];
+    }
+  }
+  for(k = 0; k < 3; k++)
+  {
+    for(row = k + 1; row < 3; row++)
+    {
+      m = a[row][k] / a[k][k];
+      for(col = k; col < 4; col++)
+      {
+        a[row][col] -= m * a[k][col];
+      }
+    }
+  }
+  for(k = 2; k >= 0; k--)
+  {
+    x[k] = a[k][3];
+    for(col = k + 1; col < 3; col++)
+    {
+      x[k] -= a[k][col] * x[col];
+    }
+    x[k] /= a[k][k];
+  }
+
+  for(index = skip; index < frames; index++)
+  {
+    w = 2 * M_PI * tone_freq * index / freq;
+    fit_value = x[0] * sin(w) + x[1] * cos(w);
+    error = out_buf[index * 2 + channel] - fit_value - x[2];
+    signal += fit_value * fit_value;
+    residual += error * error;
+  }
+  if(residual_db != NULL)
+  {
+    *residual_db = 10 * log10(residual / signal);
+  }
+  return sqrt(x[0] * x[0] + x[1] * x[1]);
+}
+
+static void src_test(const audio_rate_type *rate)
+{
+  uint32_t in_frames = rate->in_freq * RUN_SECONDS, produced, skip = rate->out_freq / 50;
+  uint32_t lower = (rate->in_freq < rate->out_freq) ? rate->in_freq : rate->out_freq;
+  double thdn_l, thdn_r, gain_db, reject_db = 0, ns, edge, stop, rms = 0;
+  uint32_t index;
+
+  CHECK(audio_src_init(&src, rate->in_freq, rate->out_freq, 2) == SUCCESS);
+
+  /* thd+n */
+  tone(rate->in_freq, TONE_FREQ, in_frames);
+  produced = convert(rate, in_frames, &ns);
+  fit(produced, 0, TONE_FREQ, rate->out_freq, skip, &thdn_l);
+  fit(produced, 1, TONE_FREQ, rate->out_freq, skip, &thdn_r);
+  CHECK(produced + 2 >= rate->out_freq * RUN_SECONDS);
+  CHECK(produced <= rate->out_freq * RUN_SECONDS + rate->out_freq / rate->in_freq + 2);
+
+  /* image of the tone around the input rate, upsampling only */
+  if(rate->out_freq > rate->in_freq)
+  {
+    reject_db = -20 * log10(fit(produced, 0, rate->in_freq - TONE_FREQ, rate->out_freq, skip, NULL) / TONE_LEVEL);
+  }
+
+  /* passband edge */
+  edge = 0.4 * lower;
+  tone(rate->in_freq, edge, in_frames);
+  produced = convert(rate, in_frames, NULL);
+  gain_db = 20 * log10(fit(produced, 0, edge, rate->out_freq, skip, NULL) / TONE_LEVEL);
+
+  /* a tone above the output nyquist, downsampling only */
+  if(rate->out_freq < rate->in_freq)
+  {
+    stop = (0.6 * rate->out_freq < 0.49 * rate->in_freq) ? 0.6 * rate->out_freq : 0.49 * rate->in_freq;
+    tone(rate->in_freq, stop, in_frames);
+    produced = convert(rate, in_frames, NULL);
+    for(index = skip; index < produced; index++)
+    {
+      rms += (double)out_buf[index * 2] * out_buf[index * 2];
+    }
+    rms = sqrt(rms / (produced - skip));
+    reject_db = -20 * log10((rms * sqrt(2) + 1e-9) / TONE_LEVEL);
+  }
+
+  printf("%5u -> %5u hz: taps %3u thd+n %6.1f %6.1f db, gain at %5.0f hz %+5.2f db, %s %5.1f db, "
+         "%3u smlad %5.1f host ns per frame\n",
+         rate->in_freq, rate->out_freq, src.taps, thdn_l, thdn_r, edge, gain_db,
+         (rate->out_freq > rate->in_freq) ? "image" : ((rate->out_freq < rate->in_freq) ? "alias" : "none "), reject_db,
+         src.taps, ns);
+
+  CHECK(thdn_l < THDN_MAX_DB && thdn_r < THDN_MAX_DB);
+  CHECK(fabs(gain_db) < PASSBAND_MAX_DB);
+  if(rate->out_freq != rate->in_freq)
+  {
+    CHECK(reject_db > STOPBAND_MIN_DB);
+  }
+}
+
+static void mixer_test(void)
+{
+  int16_t buf[2 * 1024];
+  uint32_t index;
+  uint8_t db;
+  int32_t last, step_max;
+
+  audio_mixer_init(&mixer, 2);
+
+  /* unity gain is a pass-through */
+  for(index = 0; index < 2048; index++)
+  {
+    buf[index] = (int16_t)(index * 37 - 32768);
+  }
+  audio_mixer_process(&mixer, buf, 1024);
+  for(index = 0; index < 2048; index++)
+  {
+    CHECK(buf[index] == (int16_t)(index * 37 - 32768));
+  }
+
+  /* each db step settles at its gain */
+  for(db = 0; db <= AUDIO_MIXER_RANGE_DB; db++)
+  {
+    audio_mixer_set_volume(&mixer, db);
+    for(index = 0; index < AUDIO_MIXER_RAMP_FRAMES + 2; index++)
+    {
+      buf[0] = buf[1] = 32767;
+      audio_mixer_process(&mixer, buf, 1);
+    }
+    CHECK(fabs(20 * log10(buf[0] / 32767.0) + db) < 0.1);
+    CHECK(buf[0] == buf[1]);
+  }
+
+  /* ramp from full scale to mute, no larger step than the ramp asks */
+  audio_mixer_set_volume(&mixer, 0);
+  for(index = 0; index < AUDIO_MIXER_RAMP_FRAMES + 2; index++)
+  {
+    buf[0] = buf[1] = 32767;
+    audio_mixer_process(&mixer, buf, 1);
+  }
+  audio_mixer_set_mute(&mixer, TRUE);
+  last = 32767;
+  step_max = 0;
+  for(index = 0; index < AUDIO_MIXER_RAMP_FRAMES + 2; index++)
+  {
+    buf[0] = buf[1] = 32767;
+    audio_mixer_process(&mixer, buf, 1);
+    step_max = (last - buf[0] > step_max) ? last - buf[0] : step_max;
+    CHECK(buf[0] <= last);
+    last = buf[0];
+  }
+  CHECK(buf[0] == 0 && buf[1] == 0);
+  CHECK(step_max <= 32767 / AUDIO_MIXER_RAMP_FRAMES + 2);
+  printf("mixer: unity bit exact, %u db steps, mute ramp largest step %d\n", AUDIO_MIXER_RANGE_DB + 1, step_max);
+}
+
+int main(void)
+{
+  uint32_t index;
+
+  for(index = 0; index < sizeof(rates) / sizeof(rates[0]); index++)
+  {
+    src_test(&rates[index]);
+  }
+  mixer_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+/**
+  **************************************************************************
+  * @file     bit_band.c
+  * @brief    bit-band access and event flag library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "bit_band.h"
+
+/** @addtogroup AT32F415_middlewares_bit_band_library
+  * @{
+  */
+
+/** @defgroup BIT_BAND_library
+  * @brief bit-band access and event flags
+  * @{
+  */
+
+/** @defgroup BIT_BAND_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  lower every flag of a group.
+  * @param  event: the group
+  * @retval none
+  */
+void bit_band_event_init(bit_band_event_type *event)
+{
+  event->flags = 0;
+}
+
+/**
+  * @brief  raise a flag, from any interrupt or thread.
+  * @param  event: the group
+  * @param  flag: 0..31
+  * @retval none
+  */
+void bit_band_event_set(bit_band_event_type *event, uint8_t flag)
+{
+  BIT_BAND(&event->flags, flag) = 1;
+}
+
+/**
+  * @brief  lower a flag.
+  * @param  event: the group
+  * @param  flag: 0..31
+  * @retval none
+  */
+void bit_band_event_clear(bit_band_event_type *event, uint8_t flag)
+{
+  BIT_BAND(&event->flags, flag) = 0;
+}
+
+/**
+  * @brief  state of a flag.
+  * @param  event: the group
+  * @param  flag: 0..31
+  * @retval SET or RESET
+  */
+flag_status bit_band_event_get(bit_band_event_type *event, uint8_t flag)
+{
+  return (BIT_BAND(&event->flags, flag) != 0) ? SET : RESET;
+}
+
+/**
+  * @brief  lower a raised flag and tell whether it was raised. a raise
+  *         between the test and the lowering is the same event, the caller
+  *         handles it after the take.
+  * @param  event: the group
+  * @param  flag: 0..31
+  * @retval SET when the flag was raised
+  */
+flag_status bit_band_event_take(bit_band_event_type *event, uint8_t flag)
+{
+  if(BIT_BAND(&event->flags, flag) == 0)
+  {
+    return RESET;
+  }
+  BIT_BAND(&event->flags, flag) = 0;
+  return SET;
+}
+
+/**
+  * @brief  take every raised flag of a mask, each one lowered on its own so
+  *         flags outside the mask or raised meanwhile are kept.
+  * @param  event: the group
+  * @param  mask: flags to take
+  * @retval flags taken
+  */
+uint32_t bit_band_event_take_any(bit_band_event_type *event, uint32_t mask)
+{
+  uint32_t raised = event->flags & mask, taken = raised;
+  uint8_t flag;
+
+  while(raised != 0)
+  {
+    flag = (uint8_t)(31 - __CLZ(raised));
+    BIT_BAND(&event->flags, flag) = 0;
+    raised &= ~((uint32_t)1 << flag);
+  }
+  return taken;
+}
+
+/**
+  * @brief  measure read-modify-write against bit-band access with the cycle
+  *         counter. the pin keeps its output level.
+  * @param  gpio: port of a pin set up as output
+  * @param  pin: pin number 0..15
+  * @param  count: runs of each operation
+  * @param  result: average cycles of each operation, counter reads excluded
+  * @retval none
+  */
+void bit_band_benchmark(gpio_type *gpio, uint8_t pin, uint32_t count, bit_band_benchmark_type *result)
+{
+  static bit_band_event_type event;
+  uint32_t index, start, base = 0, total[8] = {0}, primask;
+  __IO uint32_t sink;
+  uint32_t level;
+  uint16_t pins = (uint16_t)(1 << pin);
+
+  if(count == 0)
+  {
+    return;
+  }
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  level = BIT_BAND_GPIO_OUTPUT(gpio, pin);
+
+  for(index = 0; index < count; index++)
+  {
+    start = BIT_BAND_CYCLE_COUNT();
+    base += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    primask = __get_PRIMASK();
+    __disable_irq();
+    event.flags |= 0x00000100;
+    __set_PRIMASK(primask);
+    total[0] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    BIT_BAND_EVENT_SET(&event, 9);
+    total[1] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    primask = __get_PRIMASK();
+    __disable_irq();
+    sink = event.flags & 0x00000100;
+    event.flags &= ~0x00000100;
+    __set_PRIMASK(primask);
+    total[2] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    sink = bit_band_event_take(&event, 9);
+    total[3] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    sink = gpio_input_data_bit_read(gpio, pins);
+    total[4] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    sink = BIT_BAND_GPIO_INPUT(gpio, pin);
+    total[5] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    gpio_bits_write(gpio, pins, (confirm_state)level);
+    total[6] += BIT_BAND_CYCLE_COUNT() - start;
+
+    start = BIT_BAND_CYCLE_COUNT();
+    BIT_BAND_GPIO_OUTPUT(gpio, pin) = level;
+    total[7] += BIT_BAND_CYCLE_COUNT() - start;
+  }
+  (void)sink;
+
+  for(index = 0; index < 8; index++)
+  {
+    total[index] = (total[index] > base) ? (total[index] - base) / count : 0;
+  }
+  result->flag_set_rmw = total[0];
+  result->flag_set_alias = total[1];
+  result->flag_take_rmw = total[2];
+  result->flag_take_alias = total[3];
+  result->pin_read_mask = total[4];
+  result->pin_read_alias = total[5];
+  result->pin_write_driver = total[6];
+  result->pin_write_alias = total[7];
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
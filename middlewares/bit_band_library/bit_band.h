@@ -0,0 +1,159 @@
+/**
+  **************************************************************************
+  * @file     bit_band.h
+  * @brief    bit-band access and event flag library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BIT_BAND_H
+#define __BIT_BAND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_bit_band_library
+  * @{
+  */
+
+/** @defgroup BIT_BAND_library_definition
+  * @{
+  */
+
+/**
+  * @brief the first megabyte of sram (0x20000000) and of the peripherals
+  *        (0x40000000) is mirrored bit by bit in a word wide alias 32 MB
+  *        higher. a word read of an alias gives 0 or 1, a word write of an
+  *        alias changes that bit alone in one locked bus access, so no other
+  *        bit of the word is lost to an interrupt in between.
+  */
+#define BIT_BAND_REGION_SIZE             ((uint32_t)0x00100000)
+#define BIT_BAND_ALIAS_OFFSET            ((uint32_t)0x02000000)
+
+/**
+  * @brief whether addr lies in one of the two bit-band regions
+  */
+#define BIT_BAND_IN_REGION(addr)         (((((uint32_t)(addr)) & ~(BIT_BAND_REGION_SIZE - 1)) == SRAM_BASE) || \
+                                          ((((uint32_t)(addr)) & ~(BIT_BAND_REGION_SIZE - 1)) == PERIPH_BASE))
+
+/**
+  * @brief alias address of bit of the word or byte at addr. a constant
+  *        expression when addr is, such as &GPIOA->odt or a static variable.
+  *        addr must satisfy BIT_BAND_IN_REGION: an address past a region
+  *        wraps to the alias of its start.
+  */
+#define BIT_BAND_ALIAS(addr, bit)        ((((uint32_t)(addr)) & 0xF0000000) + BIT_BAND_ALIAS_OFFSET + \
+                                          ((((uint32_t)(addr)) & (BIT_BAND_REGION_SIZE - 1)) << 5) + ((uint32_t)(bit) << 2))
+
+/**
+  * @brief the bit as a word, read as 0 or 1 and written with 0 or 1.
+  *        the alias write of a peripheral register is a read and a write of
+  *        the whole register, so flags cleared by writing 0 (TMRx->ists) or
+  *        by reading (SPIx->sts) must go through the driver flag clear
+  *        functions instead.
+  */
+#define BIT_BAND(addr, bit)              (*(__IO uint32_t *)BIT_BAND_ALIAS(addr, bit))
+
+/**
+  * @brief single pin of a gpio by its number 0..15. the input reads as 0 or
+  *        1 without a mask and the output takes a level in one store, where
+  *        gpio_bits_write has to choose between scr and clr.
+  */
+#define BIT_BAND_GPIO_INPUT(gpio, pin)   BIT_BAND(&(gpio)->idt, pin)
+#define BIT_BAND_GPIO_OUTPUT(gpio, pin)  BIT_BAND(&(gpio)->odt, pin)
+
+/**
+  * @brief event flag of a group in sram, raised from an interrupt in one
+  *        store and without masking interrupts.
+  */
+#define BIT_BAND_EVENT_SET(event, flag)  (BIT_BAND(&(event)->flags, flag) = 1)
+
+/**
+  * @brief free running cycle counter used by bit_band_benchmark
+  */
+#ifndef BIT_BAND_CYCLE_COUNT
+#define BIT_BAND_CYCLE_COUNT()           (DWT->CYCCNT)
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup BIT_BAND_library_handler
+  * @{
+  */
+
+/**
+  * @brief group of 32 event flags, must be in the first megabyte of sram
+  */
+typedef struct
+{
+  __IO uint32_t                          flags;                   /*!< raised flags                    */
+} bit_band_event_type;
+
+/**
+  * @brief cycles per operation, read-modify-write against bit-band
+  */
+typedef struct
+{
+  uint32_t                               flag_set_rmw;            /*!< |= with interrupts masked       */
+  uint32_t                               flag_set_alias;          /*!< alias store                     */
+  uint32_t                               flag_take_rmw;           /*!< test and clear, interrupts masked */
+  uint32_t                               flag_take_alias;         /*!< test and clear through the alias */
+  uint32_t                               pin_read_mask;           /*!< gpio_input_data_bit_read        */
+  uint32_t                               pin_read_alias;          /*!< alias load                      */
+  uint32_t                               pin_write_driver;        /*!< gpio_bits_write                 */
+  uint32_t                               pin_write_alias;         /*!< alias store                     */
+} bit_band_benchmark_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup BIT_BAND_library_exported_functions
+  * @{
+  */
+
+void              bit_band_event_init           (bit_band_event_type *event);
+void              bit_band_event_set            (bit_band_event_type *event, uint8_t flag);
+void              bit_band_event_clear          (bit_band_event_type *event, uint8_t flag);
+flag_status       bit_band_event_get            (bit_band_event_type *event, uint8_t flag);
+flag_status       bit_band_event_take           (bit_band_event_type *event, uint8_t flag);
+uint32_t          bit_band_event_take_any       (bit_band_event_type *event, uint32_t mask);
+void              bit_band_benchmark            (gpio_type *gpio, uint8_t pin, uint32_t count, bit_band_benchmark_type *result);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+/**
+  **************************************************************************
+  * @file     bit_band_host_test.c
+  * @brief    host test of the bit-band alias addresses
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * the alias addresses only, the host has no bit-band memory to access
+ * through them. BIT_BAND_ALIAS is checked against the word and bit of the
+ * reference manual formula, alias base + byte offset * 32 + bit * 4, for
+ * sram words and bytes, gpio registers and the last byte of each region,
+ * and every alias of a region stays within the 32 MB above it.
+ * BIT_BAND_IN_REGION is checked at both bounds of both regions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bit_band.h"
+
+#define SRAM_ALIAS                       ((uint32_t)0x22000000)
+#define PERIPH_ALIAS                     ((uint32_t)0x42000000)
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+static int fails;
+
+/* the reference manual formula */
+static uint32_t alias_get(uint32_t alias_base, uint32_t region_base, uint32_t addr, uint32_t bit)
+{
+  return alias_base + (addr - region_base) * 32 + bit * 4;
+}
+
+static void sram_test(void)
+{
+  uint32_t addr, bit;
+
+  CHECK(BIT_BAND_ALIAS(0x20000000, 0) == 0x22000000);
+  CHECK(BIT_BAND_ALIAS(0x20000300, 2) == 0x22006008);
+  CHECK(BIT_BAND_ALIAS(0x20007FFC, 31) == 0x220FFFFC);
+
+  /* a byte and its word give the same alias for the same bit */
+  CHECK(BIT_BAND_ALIAS(0x20000301, 0) == BIT_BAND_ALIAS(0x20000300, 8));
+  CHECK(BIT_BAND_ALIAS(0x20000303, 7) == BIT_BAND_ALIAS(0x20000300, 31));
+
+  /* the last byte of the region */
+  CHECK(BIT_BAND_ALIAS(0x200FFFFF, 7) == 0x23FFFFFC);
+
+  for(addr = 0x20000000; addr < 0x20100000; addr += 0x1234)
+  {
+    for(bit = 0; bit < 8; bit++)
+    {
+      CHECK(BIT_BAND_ALIAS(addr, bit) == alias_get(SRAM_ALIAS, SRAM_BASE, addr, bit));
+      CHECK(BIT_BAND_ALIAS(addr, bit) >= SRAM_ALIAS && BIT_BAND_ALIAS(addr, bit) < SRAM_ALIAS + 0x02000000);
+    }
+  }
+}
+
+static void periph_test(void)
+{
+  uint32_t addr, bit;
+
+  CHECK(BIT_BAND_ALIAS(0x40000000, 0) == 0x42000000);
+  CHECK(BIT_BAND_ALIAS(0x4001080C, 7) == 0x4221019C);
+
+  /* pin 7 of GPIOA, its output and input data registers */
+  CHECK(BIT_BAND_ALIAS(&GPIOA->odt, 7) == 0x4221019C);
+  CHECK(BIT_BAND_ALIAS(&GPIOA->idt, 0) == alias_get(PERIPH_ALIAS, PERIPH_BASE, GPIOA_BASE + 0x08, 0));
+  CHECK(BIT_BAND_ALIAS(&GPIOC->odt, 13) == alias_get(PERIPH_ALIAS, PERIPH_BASE, GPIOC_BASE + 0x0C, 13));
+
+  /* the last byte of the region */
+  CHECK(BIT_BAND_ALIAS(0x400FFFFF, 7) == 0x43FFFFFC);
+
+  for(addr = 0x40000000; addr < 0x40100000; addr += 0x1234)
+  {
+    for(bit = 0; bit < 8; bit++)
+    {
+      CHECK(BIT_BAND_ALIAS(addr, bit) == alias_get(PERIPH_ALIAS, PERIPH_BASE, addr, bit));
+      CHECK(BIT_BAND_ALIAS(addr, bit) >= PERIPH_ALIAS && BIT_BAND_ALIAS(addr, bit) < PERIPH_ALIAS + 0x02000000);
+    }
+  }
+}
+
+static void region_test(void)
+{
+  CHECK(!BIT_BAND_IN_REGION(0x1FFFFFFF));
+  CHECK(BIT_BAND_IN_REGION(0x20000000));
+  CHECK(BIT_BAND_IN_REGION(0x200FFFFF));
+  CHECK(!BIT_BAND_IN_REGION(0x20100000));
+  CHECK(!BIT_BAND_IN_REGION(0x22000000));
+  CHECK(!BIT_BAND_IN_REGION(0x3FFFFFFF));
+  CHECK(BIT_BAND_IN_REGION(0x40000000));
+  CHECK(BIT_BAND_IN_REGION(0x400FFFFF));
+  CHECK(!BIT_BAND_IN_REGION(0x40100000));
+  CHECK(!BIT_BAND_IN_REGION(0x42000000));
+  CHECK(!BIT_BAND_IN_REGION(0x60000000));
+  CHECK(!BIT_BAND_IN_REGION(0xE0000000));
+  CHECK(BIT_BAND_IN_REGION(&GPIOA->odt) && BIT_BAND_IN_REGION(&CRM->ctrl));
+
+  /* past the region the alias wraps to the start, hence the check */
+  CHECK(BIT_BAND_ALIAS(0x20100000, 0) == BIT_BAND_ALIAS(0x20000000, 0));
+}
+
+int main(void)
+{
+  sram_test();
+  periph_test();
+  region_test();
+
+  printf(fails ? "FAILED\n" : "PASSED\n");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,327 @@
+/**
+  **************************************************************************
+  * @file     buffer_pool.c
+  * @brief    zero-copy buffer pool and queue library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "buffer_pool.h"
+
+/** @addtogroup AT32F415_middlewares_buffer_pool_library
+  * @{
+  */
+
+/**
+  * @brief  take a descriptor from the free list, caller holds the critical section.
+  * @param  pool: the pool to take from.
+  * @retval descriptor or NULL when the pool is empty.
+  */
+static buffer_desc_type* buffer_pool_take(buffer_pool_type *pool)
+{
+  buffer_desc_type *desc = pool->free_list;
+
+  if(desc != NULL)
+  {
+    pool->free_list = desc->next;
+    pool->free_count--;
+
+    if(pool->free_count < pool->min_free_count)
+    {
+      pool->min_free_count = pool->free_count;
+    }
+
+    desc->next = NULL;
+    desc->length = 0;
+  }
+  else
+  {
+    pool->get_fail_count++;
+  }
+
+  return desc;
+}
+
+/**
+  * @brief  give a descriptor back to its pool, caller holds the critical section.
+  * @param  desc: the descriptor to give back.
+  * @retval none.
+  */
+static void buffer_pool_give(buffer_desc_type *desc)
+{
+  buffer_pool_type *pool = desc->pool;
+
+  desc->next = pool->free_list;
+  pool->free_list = desc;
+  pool->free_count++;
+}
+
+/**
+  * @brief  initialize a pool of fixed size buffers.
+  * @param  pool: the pool to initialize.
+  * @param  desc: array of buf_count descriptors.
+  * @param  mem: buffer memory of BUFFER_POOL_MEM_WORDS(buf_count, buf_size) words.
+  * @param  buf_count: number of buffers.
+  * @param  buf_size: size of each buffer in bytes.
+  * @retval none.
+  */
+void buffer_pool_init(buffer_pool_type *pool, buffer_desc_type *desc, uint32_t *mem, uint16_t buf_count, uint16_t buf_size)
+{
+  uint16_t index;
+  uint16_t words = (buf_size + 3) / 4;
+
+  pool->free_list = NULL;
+  pool->count = buf_count;
+  pool->buf_size = buf_size;
+  pool->free_count = 0;
+  pool->get_fail_count = 0;
+
+  for(index = buf_count; index > 0; index--)
+  {
+    desc[index - 1].pool = pool;
+    desc[index - 1].data = (uint8_t *)&mem[(index - 1) * words];
+    desc[index - 1].size = buf_size;
+    desc[index - 1].length = 0;
+    desc[index - 1].tag = 0;
+    buffer_pool_give(&desc[index - 1]);
+  }
+
+  pool->min_free_count = pool->free_count;
+}
+
+/**
+  * @brief  get a buffer from a task.
+  * @param  pool: the pool to take from.
+  * @retval descriptor or NULL when the pool is empty.
+  */
+buffer_desc_type* buffer_pool_get(buffer_pool_type *pool)
+{
+  buffer_desc_type *desc;
+
+  taskENTER_CRITICAL();
+  desc = buffer_pool_take(pool);
+  taskEXIT_CRITICAL();
+
+  return desc;
+}
+
+/**
+  * @brief  get a buffer from an interrupt.
+  * @param  pool: the pool to take from.
+  * @retval descriptor or NULL when the pool is empty.
+  */
+buffer_desc_type* buffer_pool_get_from_isr(buffer_pool_type *pool)
+{
+  buffer_desc_type *desc;
+  UBaseType_t mask;
+
+  mask = taskENTER_CRITICAL_FROM_ISR();
+  desc = buffer_pool_take(pool);
+  taskEXIT_CRITICAL_FROM_ISR(mask);
+
+  return desc;
+}
+
+/**
+  * @brief  give a buffer back to its pool from a task.
+  * @param  desc: the descriptor to give back.
+  * @retval none.
+  */
+void buffer_pool_release(buffer_desc_type *desc)
+{
+  if(desc == NULL)
+  {
+    return;
+  }
+
+  taskENTER_CRITICAL();
+  buffer_pool_give(desc);
+  taskEXIT_CRITICAL();
+}
+
+/**
+  * @brief  give a buffer back to its pool from an interrupt.
+  * @param  desc: the descriptor to give back.
+  * @retval none.
+  */
+void buffer_pool_release_from_isr(buffer_desc_type *desc)
+{
+  UBaseType_t mask;
+
+  if(desc == NULL)
+  {
+    return;
+  }
+
+  mask = taskENTER_CRITICAL_FROM_ISR();
+  buffer_pool_give(desc);
+  taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/**
+  * @brief  create the descriptor queue.
+  * @param  bq: the queue to initialize.
+  * @param  depth: maximum number of queued buffers.
+  * @retval error_status (ERROR or SUCCESS).
+  */
+error_status buffer_queue_init(buffer_queue_type *bq, uint16_t depth)
+{
+  bq->drop_count = 0;
+  bq->queue = xQueueCreate(depth, sizeof(buffer_desc_type *));
+
+  return (bq->queue != NULL) ? SUCCESS : ERROR;
+}
+
+/**
+  * @brief  hand a buffer to the consumer from a task, only the pointer is copied.
+  * @param  bq: the destination queue.
+  * @param  desc: the filled buffer.
+  * @param  wait: ticks to wait for room in the queue.
+  * @retval error_status, on ERROR the buffer is released and counted as dropped.
+  */
+error_status buffer_queue_send(buffer_queue_type *bq, buffer_desc_type *desc, TickType_t wait)
+{
+  if(xQueueSend(bq->queue, &desc, wait) != pdPASS)
+  {
+    bq->drop_count++;
+    buffer_pool_release(desc);
+    return ERROR;
+  }
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  hand a buffer to the consumer from an interrupt, only the pointer is copied.
+  * @param  bq: the destination queue.
+  * @param  desc: the filled buffer.
+  * @param  woken: set to pdTRUE when a context switch is required.
+  * @retval error_status, on ERROR the buffer is released and counted as dropped.
+  */
+error_status buffer_queue_send_from_isr(buffer_queue_type *bq, buffer_desc_type *desc, BaseType_t *woken)
+{
+  if(xQueueSendFromISR(bq->queue, &desc, woken) != pdPASS)
+  {
+    bq->drop_count++;
+    buffer_pool_release_from_isr(desc);
+    return ERROR;
+  }
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  take ownership of the next filled buffer, release it with buffer_pool_release().
+  * @param  bq: the source queue.
+  * @param  wait: ticks to wait for a buffer.
+  * @retval descriptor or NULL on timeout.
+  */
+buffer_desc_type* buffer_queue_receive(buffer_queue_type *bq, TickType_t wait)
+{
+  buffer_desc_type *desc = NULL;
+
+  if(xQueueReceive(bq->queue, &desc, wait) != pdPASS)
+  {
+    return NULL;
+  }
+
+  return desc;
+}
+
+/**
+  * @brief  point the dma channel at a buffer and enable it.
+  * @param  rx: the dma receive handle.
+  * @retval none.
+  */
+static void buffer_dma_rx_arm(buffer_dma_rx_type *rx)
+{
+  rx->dma_channel->maddr = (uint32_t)rx->current->data;
+  rx->dma_channel->dtcnt = rx->current->size / rx->item_size;
+  rx->dma_channel->ctrl_bit.chen = TRUE;
+}
+
+/**
+  * @brief  start a dma reception into pool buffers. the channel must already be
+  *         configured (peripheral address, direction, widths, full data interrupt).
+  * @param  rx: the dma receive handle.
+  * @retval error_status (ERROR when the pool is empty or item_size is not
+  *         1, 2 or 4 bytes dividing the buffer size).
+  */
+error_status buffer_dma_rx_start(buffer_dma_rx_type *rx)
+{
+  if(((rx->item_size != 1) && (rx->item_size != 2) && (rx->item_size != 4)) ||
+     ((rx->pool->buf_size % rx->item_size) != 0))
+  {
+    return ERROR;
+  }
+
+  rx->overrun_count = 0;
+  rx->current = buffer_pool_get(rx->pool);
+
+  if(rx->current == NULL)
+  {
+    return ERROR;
+  }
+
+  buffer_dma_rx_arm(rx);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  close the buffer owned by the dma and hand it to the queue, then
+  *         re-arm the dma with a fresh buffer. call it from the dma full data
+  *         interrupt and from early end events (usart idle line, usb short packet).
+  * @param  rx: the dma receive handle.
+  * @param  woken: set to pdTRUE when a context switch is required.
+  * @retval none.
+  */
+void buffer_dma_rx_irq_handler(buffer_dma_rx_type *rx, BaseType_t *woken)
+{
+  buffer_desc_type *next;
+  uint16_t length;
+
+  rx->dma_channel->ctrl_bit.chen = FALSE;
+  length = rx->current->size - (uint16_t)(rx->dma_channel->dtcnt * rx->item_size);
+
+  if(length != 0)
+  {
+    next = buffer_pool_get_from_isr(rx->pool);
+
+    if(next != NULL)
+    {
+      rx->current->length = length;
+      buffer_queue_send_from_isr(rx->queue, rx->current, woken);
+      rx->current = next;
+    }
+    else
+    {
+      /* no free buffer: keep the current one and lose its content */
+      rx->overrun_count++;
+    }
+  }
+
+  buffer_dma_rx_arm(rx);
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,145 @@
+/**
+  **************************************************************************
+  * @file     buffer_pool.h
+  * @brief    zero-copy buffer pool and queue library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BUFFER_POOL_H
+#define __BUFFER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/** @addtogroup AT32F415_middlewares_buffer_pool_library
+  * @{
+  */
+
+/** @defgroup BUFFER_POOL_library_definition
+  * @{
+  */
+
+/**
+  * @brief words of memory needed by a pool of buf_count buffers of buf_size bytes,
+  *        buffers are word aligned so that dma can use any data width.
+  */
+#define BUFFER_POOL_MEM_WORDS(buf_count, buf_size) ((buf_count) * (((buf_size) + 3) / 4))
+
+/**
+  * @}
+  */
+
+/** @defgroup BUFFER_POOL_library_handler
+  * @{
+  */
+
+struct buffer_pool_struct;
+
+/**
+  * @brief buffer descriptor, ownership moves with the pointer: driver -> queue -> task -> pool
+  */
+typedef struct buffer_desc_struct
+{
+  struct buffer_desc_struct              *next;                   /*!< free list link                  */
+  struct buffer_pool_struct              *pool;                   /*!< owner pool                      */
+  uint8_t                                *data;                   /*!< buffer memory                   */
+  uint16_t                               size;                    /*!< buffer capacity in bytes        */
+  uint16_t                               length;                  /*!< valid bytes                     */
+  uint32_t                               tag;                     /*!< producer defined value          */
+} buffer_desc_type;
+
+/**
+  * @brief fixed size buffer pool
+  */
+typedef struct buffer_pool_struct
+{
+  buffer_desc_type                       *free_list;              /*!< free descriptors                */
+  uint16_t                               count;                   /*!< total descriptors               */
+  uint16_t                               buf_size;                /*!< capacity of every buffer        */
+  __IO uint16_t                          free_count;              /*!< free descriptors                */
+  __IO uint16_t                          min_free_count;          /*!< lowest free count since init    */
+  __IO uint32_t                          get_fail_count;          /*!< requests on an empty pool       */
+} buffer_pool_type;
+
+/**
+  * @brief descriptor queue from producers (isr) to a consumer task
+  */
+typedef struct
+{
+  QueueHandle_t                          queue;                   /*!< queue of buffer_desc_type*      */
+  __IO uint32_t                          drop_count;              /*!< buffers dropped on a full queue */
+} buffer_queue_type;
+
+/**
+  * @brief dma receive channel that fills pool buffers and hands them to a queue
+  */
+typedef struct
+{
+  dma_channel_type                       *dma_channel;            /*!< dma channel, already configured */
+  buffer_pool_type                       *pool;                   /*!< pool providing the buffers      */
+  buffer_queue_type                      *queue;                  /*!< queue receiving full buffers    */
+  buffer_desc_type                       *current;                /*!< buffer owned by the dma         */
+  uint8_t                                item_size;               /*!< dma memory data width in bytes  */
+  __IO uint32_t                          overrun_count;           /*!< data lost for lack of buffers   */
+} buffer_dma_rx_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup BUFFER_POOL_library_exported_functions
+  * @{
+  */
+
+void              buffer_pool_init              (buffer_pool_type *pool, buffer_desc_type *desc, uint32_t *mem, uint16_t buf_count, uint16_t buf_size);
+buffer_desc_type* buffer_pool_get               (buffer_pool_type *pool);
+buffer_desc_type* buffer_pool_get_from_isr      (buffer_pool_type *pool);
+void              buffer_pool_release           (buffer_desc_type *desc);
+void              buffer_pool_release_from_isr  (buffer_desc_type *desc);
+
+error_status      buffer_queue_init             (buffer_queue_type *bq, uint16_t depth);
+error_status      buffer_queue_send             (buffer_queue_type *bq, buffer_desc_type *desc, TickType_t wait);
+error_status      buffer_queue_send_from_isr    (buffer_queue_type *bq, buffer_desc_type *desc, BaseType_t *woken);
+buffer_desc_type* buffer_queue_receive          (buffer_queue_type *bq, TickType_t wait);
+
+error_status      buffer_dma_rx_start           (buffer_dma_rx_type *rx);
+void              buffer_dma_rx_irq_handler     (buffer_dma_rx_type *rx, BaseType_t *woken);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+/**
+  **************************************************************************
+  * @file     buffer_pool_host_test.c
+  * @brief    host model of the buffer pool and the dma receive path
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * checks the buffer pool, the descriptor queue and buffer_dma_rx against a
+ * model of the dma channel and of a consumer task:
+ * - pool accounting: empty pool, failed gets, lowest free count
+ * - item size checks of buffer_dma_rx_start
+ * - a long random stream received with full buffers and idle line ends,
+ *   with 1 and 2 byte items, a consumer that holds buffers for a while and
+ *   falls behind, and a queue shorter than the pool: every byte handed over is the byte sent
+ *   at that place, every byte not handed over is counted as an overrun or a
+ *   drop, and no descriptor is ever lost or owned twice
+ * the queue is a ring in the test, the freertos queue itself is not under
+ * test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "buffer_pool.h"
+
+#define BUF_COUNT                        4
+#define BUF_SIZE                         64
+#define STREAM_BYTES                     2000000
+#define EXPECT_MAX                       64
+
+/* queue model */
+struct QueueDefinition
+{
+  buffer_desc_type *item[16];
+  uint32_t depth, head, count;
+};
+
+static struct QueueDefinition queue_store;
+
+/* dma and consumer model */
+static dma_channel_type dma;
+static buffer_pool_type pool;
+static buffer_desc_type desc[BUF_COUNT];
+static uint32_t mem[BUFFER_POOL_MEM_WORDS(BUF_COUNT, BUF_SIZE)];
+static buffer_queue_type queue;
+static buffer_dma_rx_type rx;
+
+static struct
+{
+  uint32_t seq, length;
+} expect[EXPECT_MAX];
+static uint32_t expect_head, expect_count;
+static buffer_desc_type *held[BUF_COUNT];
+static uint32_t held_count;
+static uint32_t seq, arm_seq, received, lost;
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, const uint8_t ucQueueType)
+{
+  memset(&queue_store, 0, sizeof(queue_store));
+  queue_store.depth = uxQueueLength;
+  return (uxItemSize == sizeof(buffer_desc_type *)) ? &queue_store : NULL;
+}
+
+static BaseType_t queue_put(QueueHandle_t q, const void *item)
+{
+  if(q->count == q->depth)
+  {
+    return errQUEUE_FULL;
+  }
+  memcpy(&q->item[(q->head + q->count) % q->depth], item, sizeof(buffer_desc_type *));
+  q->count++;
+  return pdPASS;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait, const BaseType_t xCopyPosition)
+{
+  return queue_put(xQueue, pvItemToQueue);
+}
+
+BaseType_t xQueueGenericSendFromISR(QueueHandle_t xQueue, const void * const pvItemToQueue, BaseType_t * const pxHigherPriorityTaskWoken, const BaseType_t xCopyPosition)
+{
+  BaseType_t result = queue_put(xQueue, pvItemToQueue);
+
+  if(result == pdPASS && pxHigherPriorityTaskWoken != NULL)
+  {
+    *pxHigherPriorityTaskWoken = pdTRUE;
+  }
+  return result;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait)
+{
+  if(xQueue->count == 0)
+  {
+    return errQUEUE_EMPTY;
+  }
+  memcpy(pvBuffer, &xQueue->item[xQueue->head], sizeof(buffer_desc_type *));
+  xQueue->head = (xQueue->head + 1) % xQueue->depth;
+  xQueue->count--;
+  return pdPASS;
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static uint8_t stream_byte(uint32_t index)
+{
+  index *= 2654435761u;
+  return (uint8_t)(index >> 24);
+}
+
+static void pool_test(void)
+{
+  buffer_desc_type *got[BUF_COUNT + 1];
+  uint32_t index;
+
+  buffer_pool_init(&pool, desc, mem, BUF_COUNT, 6);
+  CHECK(pool.free_count == BUF_COUNT && pool.min_free_count == BUF_COUNT);
+  for(index = 0; index < BUF_COUNT; index++)
+  {
+    got[index] = buffer_pool_get(&pool);
+    CHECK(got[index] != NULL && got[index]->size == 6 && got[index]->pool == &pool);
+    CHECK(((uint32_t)(uintptr_t)got[index]->data & 3) == 0);
+  }
+  got[BUF_COUNT] = buffer_pool_get_from_isr(&pool);
+  CHECK(got[BUF_COUNT] == NULL && pool.get_fail_count == 1 && pool.min_free_count == 0);
+  for(index = 0; index <= BUF_COUNT; index++)
+  {
+    buffer_pool_release(got[index]);
+  }
+  CHECK(pool.free_count == BUF_COUNT);
+
+  /* 6 byte buffers take 1 or 2 byte items, 3 byte or 4 byte items are refused */
+  rx.dma_channel = &dma;
+  rx.pool = &pool;
+  rx.queue = &queue;
+  rx.item_size = 3;
+  CHECK(buffer_dma_rx_start(&rx) == ERROR);
+  rx.item_size = 4;
+  CHECK(buffer_dma_rx_start(&rx) == ERROR);
+  CHECK(pool.free_count == BUF_COUNT);
+  rx.item_size = 2;
+  CHECK(buffer_dma_rx_start(&rx) == SUCCESS && dma.dtcnt == 3 && dma.ctrl_bit.chen);
+  CHECK(pool.free_count == BUF_COUNT - 1);
+}
+
+/* what the consumer must get next: each buffer handed to the queue */
+static void expect_push(uint32_t from, uint32_t length)
+{
+  CHECK(expect_count < EXPECT_MAX);
+  expect[(expect_head + expect_count) % EXPECT_MAX].seq = from;
+  expect[(expect_head + expect_count) % EXPECT_MAX].length = length;
+  expect_count++;
+}
+
+/* the interrupt, with the model noting where the buffer went */
+static void rx_interrupt(void)
+{
+  uint32_t overruns = rx.overrun_count, drops = queue.drop_count, length = seq - arm_seq;
+  BaseType_t woken = pdFALSE;
+
+  buffer_dma_rx_irq_handler(&rx, &woken);
+  if(length == 0)
+  {
+    CHECK(rx.overrun_count == overruns && queue.drop_count == drops);
+  }
+  else if(rx.overrun_count != overruns || queue.drop_count != drops)
+  {
+    lost += length;
+  }
+  else
+  {
+    expect_push(arm_seq, length);
+  }
+  arm_seq = seq;
+  CHECK(dma.ctrl_bit.chen && dma.maddr == (uint32_t)(uintptr_t)rx.current->data);
+}
+
+static void consumer_step(void)
+{
+  buffer_desc_type *got;
+  uint32_t index, from;
+
+  /* the task takes a buffer, holds a few, and gives the oldest back */
+  got = buffer_queue_receive(&queue, 0);
+  if(got != NULL)
+  {
+    CHECK(expect_count != 0);
+    from = expect[expect_head].seq;
+    CHECK(got->length == expect[expect_head].length);
+    for(index = 0; index < got->length; index++)
+    {
+      if(got->data[index] != stream_byte(from + index))
+      {
+        CHECK(got->data[index] == stream_byte(from + index));
+        break;
+      }
+    }
+    received += got->length;
+    expect_head = (expect_head + 1) % EXPECT_MAX;
+    expect_count--;
+    held[held_count++] = got;
+  }
+  if(held_count != 0 && (held_count == BUF_COUNT - 1 || (rand_get() % 4) != 0))
+  {
+    buffer_pool_release(held[0]);
+    memmove(&held[0], &held[1], (held_count - 1) * sizeof(held[0]));
+    held_count--;
+  }
+}
+
+static void stream_test(uint8_t item_size, uint32_t depth, uint32_t consume)
+{
+  uint32_t burst, item, byte;
+
+  memset(&dma, 0, sizeof(dma));
+  buffer_pool_init(&pool, desc, mem, BUF_COUNT, BUF_SIZE);
+  CHECK(buffer_queue_init(&queue, (uint16_t)depth) == SUCCESS);
+  rx.dma_channel = &dma;
+  rx.pool = &pool;
+  rx.queue = &queue;
+  rx.item_size = item_size;
+  CHECK(buffer_dma_rx_start(&rx) == SUCCESS);
+  seq = arm_seq = received = lost = 0;
+  expect_head = expect_count = held_count = 0;
+
+  while(seq < STREAM_BYTES)
+  {
+    /* a burst of items, then the line goes idle */
+    burst = 1 + rand_get() % 150;
+    for(item = 0; item < burst; item++)
+    {
+      CHECK(dma.ctrl_bit.chen && dma.dtcnt != 0);
+      for(byte = 0; byte < item_size; byte++)
+      {
+        ((uint8_t *)(uintptr_t)dma.maddr)[(seq - arm_seq)] = stream_byte(seq);
+        seq++;
+      }
+      dma.dtcnt--;
+      if(dma.dtcnt == 0)
+      {
+        rx_interrupt();
+      }
+      if((rand_get() % consume) == 0)
+      {
+        consumer_step();
+      }
+    }
+    rx_interrupt();
+    if((rand_get() % 4) == 0)
+    {
+      consumer_step();
+    }
+
+    /* every descriptor is in one place: free, queued, held or in the dma */
+    CHECK(pool.free_count + queue.queue->count + held_count + 1 == BUF_COUNT);
+  }
+  while(queue.queue->count != 0 || held_count != 0)
+  {
+    consumer_step();
+  }
+  CHECK(expect_count == 0);
+  CHECK(received + lost == seq);
+  printf("item %u, queue depth %u: %u bytes, %u received, %u lost (%u overruns, %u drops), lowest free %u\n",
+         item_size, (unsigned)depth, (unsigned)seq, (unsigned)received, (unsigned)lost,
+         (unsigned)rx.overrun_count, (unsigned)queue.drop_count, (unsigned)pool.min_free_count);
+}
+
+int main(void)
+{
+  pool_test();
+  stream_test(1, BUF_COUNT, 8);
+  stream_test(2, BUF_COUNT, 8);
+  stream_test(1, 2, 32);
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,432 @@
+/**
+  **************************************************************************
+  * @file     encoder_service.c
+  * @brief    quadrature encoder service library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "encoder_service.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_encoder_service_library
+  * @{
+  */
+
+/** @defgroup ENC_library
+  * @brief quadrature encoder service
+  * @{
+  */
+
+/** @defgroup ENC_private_definition
+  * @{
+  */
+
+#define ENC_IRQ_FLAGS                    (TMR_OVF_FLAG | TMR_C3_FLAG | TMR_C4_FLAG)
+#define ENC_CONSISTENT_TRIES             3
+
+/**
+  * @}
+  */
+
+/** @defgroup ENC_private_functions
+  * @{
+  */
+
+/**
+  * @brief  signed counts from one counter value to another, the shorter
+  *         way round the range.
+  * @param  mask: counter range
+  * @param  to: later value
+  * @param  from: earlier value
+  * @retval counts moved
+  */
+static int64_t enc_delta(uint32_t mask, uint32_t to, uint32_t from)
+{
+  uint32_t delta = (to - from) & mask;
+
+  if(delta > (mask >> 1))
+  {
+    return (int64_t)delta - (int64_t)mask - 1;
+  }
+  return (int64_t)delta;
+}
+
+/**
+  * @brief  time base channel select of a channel number.
+  * @param  channel: 1..4
+  * @retval channel select
+  */
+static tmr_channel_select_type enc_channel_select(uint8_t channel)
+{
+  return (tmr_channel_select_type)(TMR_SELECT_CHANNEL_1 + 2 * (channel - 1));
+}
+
+/**
+  * @brief  timestamp of a time base capture, at most one wrap before the
+  *         last sample.
+  * @param  enc: the encoder
+  * @param  capture: captured time base value
+  * @retval timestamp in ticks
+  */
+static uint64_t enc_timestamp(enc_type *enc, uint32_t capture)
+{
+  return enc->time_now - ((enc->time_raw - capture) & enc->time_mask);
+}
+
+/**
+  * @brief  velocity from counts and ticks, saturated.
+  * @param  counts: counts moved
+  * @param  freq: ticks per second
+  * @param  ticks: time they took, not 0
+  * @retval counts per second, q8
+  */
+static int32_t enc_velocity(int64_t counts, uint32_t freq, uint64_t ticks)
+{
+  int64_t velocity = (counts * (int64_t)freq * (1 << ENC_VELOCITY_SHIFT)) / (int64_t)ticks;
+
+  if(velocity > INT32_MAX)
+  {
+    return INT32_MAX;
+  }
+  if(velocity < -INT32_MAX)
+  {
+    return -INT32_MAX;
+  }
+  return (int32_t)velocity;
+}
+
+/**
+  * @brief  position counted by the timer, without the shift of
+  *         enc_position_set. a reader below the encoder interrupt reads again
+  *         when the interrupt ran meanwhile.
+  * @param  enc: the encoder
+  * @retval counted position
+  */
+static int64_t enc_count_get(enc_type *enc)
+{
+  enc_base_type base;
+  uint32_t count, raw;
+  uint8_t index;
+
+  do
+  {
+    count = enc->irq_count;
+    index = enc->base_index;
+    base = enc->base[index];
+    raw = tmr_counter_value_get(enc->cfg.tmr) & enc->mask;
+  } while(count != enc->irq_count);
+
+  return base.position + enc_delta(enc->mask, raw, base.raw);
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup ENC_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  put the timer in encoder mode at position 0 and enable its
+  *         interrupts, and the a/b captures of the time base when there is
+  *         one. the nvic of the encoder timer is enabled by the caller.
+  * @param  enc: the encoder
+  * @param  cfg: configuration
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status enc_init(enc_type *enc, const enc_config_type *cfg)
+{
+  tmr_input_config_type input_struct;
+
+  if((cfg->counter_bits != 16 && cfg->counter_bits != 32) || cfg->sample_freq == 0)
+  {
+    return ERROR;
+  }
+  if(cfg->time_tmr != NULL &&
+     ((cfg->time_bits != 16 && cfg->time_bits != 32) || cfg->tick_freq == 0 ||
+      cfg->time_channel_a < 1 || cfg->time_channel_a > 4 || cfg->time_channel_b < 1 || cfg->time_channel_b > 4 ||
+      cfg->time_channel_a == cfg->time_channel_b))
+  {
+    return ERROR;
+  }
+
+  enc->cfg = *cfg;
+  enc->mask = (cfg->counter_bits == 32) ? 0xFFFFFFFF : 0xFFFF;
+  enc->base[0].position = 0;
+  enc->base[0].raw = 0;
+  enc->base_index = 0;
+  enc->offset = 0;
+  enc->offset_count = 0;
+  enc->have_reference = 0;
+  enc->last_position = 0;
+  enc->velocity = 0;
+  enc->sample_count = 0;
+  enc->irq_count = 0;
+
+  if(cfg->counter_bits == 32)
+  {
+    tmr_32_bit_function_enable(cfg->tmr, TRUE);
+  }
+  tmr_base_init(cfg->tmr, enc->mask, 0);
+  tmr_cnt_dir_set(cfg->tmr, TMR_COUNT_UP);
+  tmr_encoder_mode_config(cfg->tmr, cfg->mode, cfg->polarity_a, cfg->polarity_b);
+  tmr_input_channel_filter_set(cfg->tmr, TMR_SELECT_CHANNEL_1, cfg->filter);
+  tmr_input_channel_filter_set(cfg->tmr, TMR_SELECT_CHANNEL_2, cfg->filter);
+
+  /* the thirds of the range, no output */
+  tmr_output_channel_mode_select(cfg->tmr, TMR_SELECT_CHANNEL_3, TMR_OUTPUT_CONTROL_OFF);
+  tmr_output_channel_mode_select(cfg->tmr, TMR_SELECT_CHANNEL_4, TMR_OUTPUT_CONTROL_OFF);
+  tmr_channel_value_set(cfg->tmr, TMR_SELECT_CHANNEL_3, enc->mask / 3);
+  tmr_channel_value_set(cfg->tmr, TMR_SELECT_CHANNEL_4, enc->mask / 3 * 2);
+
+  tmr_counter_value_set(cfg->tmr, 0);
+  tmr_flag_clear(cfg->tmr, ENC_IRQ_FLAGS);
+  tmr_interrupt_enable(cfg->tmr, TMR_OVF_INT | TMR_C3_INT | TMR_C4_INT, TRUE);
+
+  if(cfg->time_tmr != NULL)
+  {
+    tmr_input_default_para_init(&input_struct);
+    input_struct.input_polarity_select = TMR_INPUT_BOTH_EDGE;
+    input_struct.input_mapped_select = TMR_CC_CHANNEL_MAPPED_DIRECT;
+    input_struct.input_filter_value = cfg->filter;
+    input_struct.input_channel_select = enc_channel_select(cfg->time_channel_a);
+    tmr_input_channel_init(cfg->time_tmr, &input_struct, TMR_CHANNEL_INPUT_DIV_1);
+    input_struct.input_channel_select = enc_channel_select(cfg->time_channel_b);
+    tmr_input_channel_init(cfg->time_tmr, &input_struct, TMR_CHANNEL_INPUT_DIV_1);
+
+    enc->time_mask = (cfg->time_bits == 32) ? 0xFFFFFFFF : 0xFFFF;
+    enc->time_raw = tmr_counter_value_get(cfg->time_tmr) & enc->time_mask;
+    enc->time_now = 0;
+  }
+
+  tmr_counter_enable(cfg->tmr, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  redefine the present position, e.g. at a reference mark, from any
+  *         context. the shift over the counted position is written with
+  *         interrupts off and is not a field enc_irq_handler writes, so an
+  *         encoder interrupt it preempted finishes its own update unharmed.
+  *         the velocity works on the counted position and goes on
+  *         undisturbed.
+  * @param  enc: the encoder
+  * @param  position: new present position
+  * @retval none
+  */
+void enc_position_set(enc_type *enc, int64_t position)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  enc->offset = position - enc_count_get(enc);
+  enc->offset_count++;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  extended position, from any context without locking. a reader
+  *         above the encoder interrupt never waits, one below it reads again
+  *         when the interrupt or enc_position_set ran meanwhile.
+  * @param  enc: the encoder
+  * @retval position in counts
+  */
+int64_t enc_position_get(enc_type *enc)
+{
+  int64_t position, offset;
+  uint32_t count;
+
+  do
+  {
+    count = enc->offset_count;
+    offset = enc->offset;
+    position = enc_count_get(enc);
+  } while(count != enc->offset_count);
+
+  return position + offset;
+}
+
+/**
+  * @brief  velocity update, called at sample_freq from the control loop and
+  *         at least once per time base wrap. with the time base the counts
+  *         between the last edges of two samples are divided by the time
+  *         between these edges (m/t). without a new edge the velocity is held
+  *         under one count over the time since the last edge and reaches 0
+  *         after stop_ticks. edges too dense to read a quiet moment fall back
+  *         to counts per sample period, which is exact enough at that speed.
+  * @param  enc: the encoder
+  * @retval none
+  */
+void enc_sample(enc_type *enc)
+{
+  tmr_type *time_tmr = enc->cfg.time_tmr;
+  uint32_t flag_a, flag_b, capture_a = 0, capture_b = 0, raw;
+  flag_status edge_a, edge_b;
+  uint64_t edge_time, elapsed, last_time;
+  int64_t position;
+  int32_t bound;
+  uint8_t tries;
+
+  if(time_tmr == NULL)
+  {
+    position = enc_count_get(enc);
+    enc->velocity = enc_velocity(position - enc->last_position, enc->cfg.sample_freq, 1);
+    enc->last_position = position;
+    enc->sample_count++;
+    return;
+  }
+
+  flag_a = TMR_C1_FLAG << (enc->cfg.time_channel_a - 1);
+  flag_b = TMR_C1_FLAG << (enc->cfg.time_channel_b - 1);
+  edge_a = tmr_flag_get(time_tmr, flag_a);
+  edge_b = tmr_flag_get(time_tmr, flag_b);
+  tmr_flag_clear(time_tmr, flag_a | flag_b);
+
+  /* position right after the last edge: no capture may change around it */
+  for(tries = 0; tries < ENC_CONSISTENT_TRIES; tries++)
+  {
+    capture_a = tmr_channel_value_get(time_tmr, enc_channel_select(enc->cfg.time_channel_a));
+    capture_b = tmr_channel_value_get(time_tmr, enc_channel_select(enc->cfg.time_channel_b));
+    position = enc_count_get(enc);
+    if(capture_a == tmr_channel_value_get(time_tmr, enc_channel_select(enc->cfg.time_channel_a)) &&
+       capture_b == tmr_channel_value_get(time_tmr, enc_channel_select(enc->cfg.time_channel_b)))
+    {
+      break;
+    }
+  }
+
+  /* the captures are older than now */
+  last_time = enc->time_now;
+  raw = tmr_counter_value_get(time_tmr) & enc->time_mask;
+  enc->time_now += (raw - enc->time_raw) & enc->time_mask;
+  enc->time_raw = raw;
+
+  if(tries == ENC_CONSISTENT_TRIES)
+  {
+    if(enc->time_now > last_time)
+    {
+      enc->velocity = enc_velocity(position - enc->last_position, enc->cfg.tick_freq, enc->time_now - last_time);
+    }
+    enc->have_reference = 0;
+  }
+  else if(edge_a != RESET || edge_b != RESET)
+  {
+    edge_time = 0;
+    if(edge_a != RESET)
+    {
+      edge_time = enc_timestamp(enc, capture_a);
+    }
+    if(edge_b != RESET && enc_timestamp(enc, capture_b) > edge_time)
+    {
+      edge_time = enc_timestamp(enc, capture_b);
+    }
+    if(enc->have_reference != 0 && edge_time > enc->ref_time)
+    {
+      enc->velocity = enc_velocity(position - enc->ref_position, enc->cfg.tick_freq, edge_time - enc->ref_time);
+    }
+    else if(enc->time_now > last_time)
+    {
+      /* no reference yet, counts over the sample as in the fallback */
+      enc->velocity = enc_velocity(position - enc->last_position, enc->cfg.tick_freq, enc->time_now - last_time);
+    }
+    enc->ref_position = position;
+    enc->ref_time = edge_time;
+    enc->have_reference = 1;
+  }
+  else if(enc->have_reference != 0)
+  {
+    elapsed = enc->time_now - enc->ref_time;
+    if(elapsed >= enc->cfg.stop_ticks)
+    {
+      enc->velocity = 0;
+    }
+    else if(elapsed != 0)
+    {
+      bound = enc_velocity(1, enc->cfg.tick_freq, elapsed);
+      if(enc->velocity > bound)
+      {
+        enc->velocity = bound;
+      }
+      else if(enc->velocity < -bound)
+      {
+        enc->velocity = -bound;
+      }
+    }
+  }
+
+  enc->last_position = position;
+  enc->sample_count++;
+}
+
+/**
+  * @brief  position now and the velocity of the last sample.
+  * @param  enc: the encoder
+  * @param  snapshot: the view
+  * @retval none
+  */
+void enc_snapshot_get(enc_type *enc, enc_snapshot_type *snapshot)
+{
+  snapshot->position = enc_position_get(enc);
+  snapshot->velocity = enc->velocity;
+  snapshot->sample_count = enc->sample_count;
+}
+
+/**
+  * @brief  wrap and third of the range interrupts, called from the encoder
+  *         timer interrupt handler. the new base goes to the slot readers do
+  *         not take and is swapped in whole.
+  * @param  enc: the encoder
+  * @retval none
+  */
+void enc_irq_handler(enc_type *enc)
+{
+  enc_base_type *base, *next;
+  uint32_t raw;
+
+  if(tmr_flag_get(enc->cfg.tmr, ENC_IRQ_FLAGS) == RESET)
+  {
+    return;
+  }
+  tmr_flag_clear(enc->cfg.tmr, ENC_IRQ_FLAGS);
+  raw = tmr_counter_value_get(enc->cfg.tmr) & enc->mask;
+
+  base = &enc->base[enc->base_index];
+  next = &enc->base[enc->base_index ^ 1];
+  next->position = base->position + enc_delta(enc->mask, raw, base->raw);
+  next->raw = raw;
+  enc->base_index ^= 1;
+  enc->irq_count++;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,164 @@
+/**
+  **************************************************************************
+  * @file     encoder_service.h
+  * @brief    quadrature encoder service library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ENCODER_SERVICE_H
+#define __ENCODER_SERVICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_encoder_service_library
+  * @{
+  */
+
+/** @defgroup ENC_library_definition
+  * @{
+  */
+
+/**
+  * @brief the encoder timer counts in encoder mode over its whole range. its
+  *        overflow and the compares of channel 3 and 4 at a third and two
+  *        thirds of the range interrupt, so the interrupt sees the counter at
+  *        least every third of the range and extends it to 64 bits by the
+  *        signed difference, whichever way the shaft turns or shakes around
+  *        a wrap. the interrupt publishes the base in one of two slots, a
+  *        reader of any priority takes the other one and adds the counter
+  *        moved since. the interrupt latency must stay under a sixth of the
+  *        range of counts. enc_position_set adds a shift the interrupt never
+  *        writes.
+  */
+#define ENC_BASE_SLOT_COUNT              2
+
+/**
+  * @brief velocity is in counts per second, q8
+  */
+#define ENC_VELOCITY_SHIFT               8
+
+/**
+  * @}
+  */
+
+/** @defgroup ENC_library_handler
+  * @{
+  */
+
+/**
+  * @brief configuration. for the m/t velocity the a and b signals also go to
+  *        two capture channels of a free running time base timer, which the
+  *        caller runs over its whole range and may share between encoders.
+  *        without it the velocity is counts per sample period.
+  */
+typedef struct
+{
+  tmr_type                               *tmr;                    /*!< encoder timer, TMR2, TMR3 or TMR5 */
+  uint8_t                                counter_bits;            /*!< 16, or 32 for TMR2 and TMR5     */
+  tmr_encoder_mode_type                  mode;                    /*!< counted edges                   */
+  tmr_input_polarity_type                polarity_a;              /*!< direction of signal a           */
+  tmr_input_polarity_type                polarity_b;              /*!< direction of signal b           */
+  uint8_t                                filter;                  /*!< input filter of a and b         */
+  tmr_type                               *time_tmr;               /*!< time base, NULL for counts per sample */
+  uint8_t                                time_bits;               /*!< 16 or 32                        */
+  uint8_t                                time_channel_a;          /*!< time base channel on a, 1..4    */
+  uint8_t                                time_channel_b;          /*!< time base channel on b, 1..4    */
+  uint32_t                               tick_freq;               /*!< time base count rate in hz      */
+  uint32_t                               sample_freq;             /*!< calls of enc_sample per second  */
+  uint32_t                               stop_ticks;              /*!< no edge this long is standstill */
+} enc_config_type;
+
+/**
+  * @brief counter value and the position it stands for
+  */
+typedef struct
+{
+  int64_t                                position;                /*!< extended position               */
+  uint32_t                               raw;                     /*!< counter at the position         */
+} enc_base_type;
+
+/**
+  * @brief consistent view for a control loop
+  */
+typedef struct
+{
+  int64_t                                position;                /*!< extended position now           */
+  int32_t                                velocity;                /*!< counts per second, q8           */
+  uint32_t                               sample_count;            /*!< enc_sample calls                */
+} enc_snapshot_type;
+
+/**
+  * @brief encoder
+  */
+typedef struct
+{
+  enc_config_type                        cfg;                     /*!< configuration                   */
+  uint32_t                               mask;                    /*!< counter range                   */
+  enc_base_type                          base[ENC_BASE_SLOT_COUNT]; /*!< bases of the interrupt        */
+  __IO uint8_t                           base_index;              /*!< slot readers take               */
+  __IO int64_t                           offset;                  /*!< enc_position_set shift          */
+  __IO uint32_t                          offset_count;            /*!< shifts, readers retry on a change */
+  uint32_t                               time_mask;               /*!< time base range                 */
+  uint32_t                               time_raw;                /*!< time base at the last sample    */
+  uint64_t                               time_now;                /*!< timestamp of the last sample    */
+  uint8_t                                have_reference;          /*!< reference edge is valid         */
+  int64_t                                ref_position;            /*!< counted position right after the reference edge */
+  uint64_t                               ref_time;                /*!< timestamp of the reference edge */
+  int64_t                                last_position;           /*!< counted position at the last sample */
+  __IO int32_t                           velocity;                /*!< counts per second, q8           */
+  __IO uint32_t                          sample_count;            /*!< enc_sample calls                */
+  __IO uint32_t                          irq_count;               /*!< base updates, readers retry on a change */
+} enc_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup ENC_library_exported_functions
+  * @{
+  */
+
+error_status      enc_init                      (enc_type *enc, const enc_config_type *cfg);
+void              enc_position_set              (enc_type *enc, int64_t position);
+int64_t           enc_position_get              (enc_type *enc);
+void              enc_sample                    (enc_type *enc);
+void              enc_snapshot_get              (enc_type *enc, enc_snapshot_type *snapshot);
+void              enc_irq_handler               (enc_type *enc);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
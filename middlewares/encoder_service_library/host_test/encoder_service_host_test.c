@@ -0,0 +1,388 @@
+/**
+  **************************************************************************
+  * @file     encoder_service_host_test.c
+  * @brief    host model of the encoder service
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs the encoder service against a model of a shaft, the 16-bit encoder
+ * timer and the time base. every driver access takes time: the shaft
+ * moves, each count crossed captures the time base on its a or b edge and
+ * raises the wrap and third of the range flags, and the encoder interrupt
+ * comes in after a random latency unless the caller runs with interrupts
+ * off or above the interrupt. every position read is checked against the
+ * count of the shaft and every sample against its velocity: at high speed,
+ * at low speed backwards, shaking around a wrap and reversing with 2 ms of
+ * interrupt latency. enc_position_set then runs from a context above the
+ * interrupt at random accesses, also inside the interrupt and inside
+ * enc_sample; positions follow every set and the velocity goes on.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "encoder_service.h"
+
+#define TICK_FREQ                        9000000.0
+#define ACCESS_TIME                      0.3e-6
+#define PI                               3.14159265358979
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* shaft motions */
+typedef enum
+{
+  MOTION_FAST,
+  MOTION_SLOW_BACK,
+  MOTION_SHAKE,
+  MOTION_REVERSE,
+  MOTION_STOP
+} motion_type;
+
+static tmr_type enc_tmr, time_tmr;
+static enc_type enc;
+static motion_type motion;
+static double now, latency, irq_at;
+static long long count_now, count_read;
+static uint32_t capture_a, capture_b, enc_flags;
+static int edge_a, edge_b;
+static int irq_enabled, in_irq, above_irq;
+static long irq_runs;
+
+/* position_set from above the interrupt */
+static int set_rate, in_set;
+static long long set_offset;
+static long set_runs, set_in_irq;
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+/* shaft position in counts */
+static double shaft(double t)
+{
+  switch(motion)
+  {
+    case MOTION_FAST:
+      return 1e6 * t;
+    case MOTION_SLOW_BACK:
+      return -20.0 * t;
+    case MOTION_SHAKE:
+      return 65536.0 * 3 + 0.37 + 3.3 * sin(2 * PI * 300 * t);
+    case MOTION_REVERSE:
+      return 2e5 * sin(2 * PI * 2 * t);
+    default:
+      return 1e3;
+  }
+}
+
+static uint32_t time_base(double t)
+{
+  return (uint32_t)(long long)floor(t * TICK_FREQ) & 0xFFFF;
+}
+
+/* move the shaft to t, with the captures and flags of every count crossed */
+static void world_to(double t)
+{
+  double x0 = shaft(now), x1 = shaft(t), edge;
+  long long k0 = (long long)floor(x0), k1 = (long long)floor(x1), k, next, crossed;
+  uint32_t raw;
+  int dir = (k1 > k0) ? 1 : -1;
+
+  for(k = k0; k != k1; k += dir)
+  {
+    next = k + dir;
+    crossed = (dir > 0) ? next : k;
+    edge = now + (t - now) * ((double)crossed - x0) / (x1 - x0);
+    if(crossed & 1)
+    {
+      capture_a = time_base(edge);
+      edge_a = 1;
+    }
+    else
+    {
+      capture_b = time_base(edge);
+      edge_b = 1;
+    }
+    raw = (uint32_t)next & 0xFFFF;
+    if((raw == 0 && dir > 0) || (raw == 0xFFFF && dir < 0))
+    {
+      enc_flags |= TMR_OVF_FLAG;
+    }
+    if(raw == 0xFFFF / 3)
+    {
+      enc_flags |= TMR_C3_FLAG;
+    }
+    if(raw == 0xFFFF / 3 * 2)
+    {
+      enc_flags |= TMR_C4_FLAG;
+    }
+  }
+  count_now = k1;
+  now = t;
+  if(enc_flags != 0 && irq_at < 0)
+  {
+    irq_at = now + latency * (rand_get() / 16777216.0);
+  }
+}
+
+/* a register access: time passes, a context above the interrupt may set
+   the position and the interrupt may come in */
+static void access(void)
+{
+  world_to(now + ACCESS_TIME);
+
+  if(set_rate != 0 && in_set == 0 && host_primask == 0 && (rand_get() % set_rate) == 0)
+  {
+    in_set = 1;
+    set_in_irq += in_irq;
+    enc_position_set(&enc, (long long)(rand_get() << 8) - 0x80000000LL);
+    set_offset = enc_position_get(&enc) - count_read;
+    set_runs++;
+    in_set = 0;
+  }
+
+  if(irq_enabled && in_irq == 0 && above_irq == 0 && in_set == 0 && host_primask == 0 && irq_at >= 0 && now >= irq_at)
+  {
+    in_irq = 1;
+    irq_at = -1;
+    irq_runs++;
+    enc_irq_handler(&enc);
+    in_irq = 0;
+    if(enc_flags != 0)
+    {
+      irq_at = now;
+    }
+  }
+}
+
+void tmr_32_bit_function_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void tmr_base_init(tmr_type *tmr_x, uint32_t tmr_pr, uint32_t tmr_div)
+{
+}
+
+void tmr_cnt_dir_set(tmr_type *tmr_x, tmr_count_mode_type tmr_cnt_dir)
+{
+}
+
+void tmr_encoder_mode_config(tmr_type *tmr_x, tmr_encoder_mode_type encoder_mode, tmr_input_polarity_type ic1_polarity, tmr_input_polarity_type ic2_polarity)
+{
+}
+
+void tmr_input_channel_filter_set(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, uint16_t filter_value)
+{
+}
+
+void tmr_output_channel_mode_select(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, tmr_output_control_mode_type oc_mode)
+{
+}
+
+void tmr_channel_value_set(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, uint32_t tmr_channel_value)
+{
+}
+
+void tmr_counter_value_set(tmr_type *tmr_x, uint32_t tmr_cnt_value)
+{
+}
+
+void tmr_interrupt_enable(tmr_type *tmr_x, uint32_t tmr_interrupt, confirm_state new_state)
+{
+  irq_enabled = new_state;
+}
+
+void tmr_input_default_para_init(tmr_input_config_type *input_struct)
+{
+  memset(input_struct, 0, sizeof(*input_struct));
+}
+
+void tmr_input_channel_init(tmr_type *tmr_x, tmr_input_config_type *input_struct, tmr_channel_input_divider_type divider_factor)
+{
+}
+
+void tmr_counter_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void tmr_flag_clear(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  access();
+  if(tmr_x == &enc_tmr)
+  {
+    enc_flags &= ~tmr_flag;
+    return;
+  }
+  if(tmr_flag & TMR_C1_FLAG)
+  {
+    edge_a = 0;
+  }
+  if(tmr_flag & TMR_C2_FLAG)
+  {
+    edge_b = 0;
+  }
+}
+
+flag_status tmr_flag_get(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  access();
+  if(tmr_x == &enc_tmr)
+  {
+    return (enc_flags & tmr_flag) ? SET : RESET;
+  }
+  return (((tmr_flag & TMR_C1_FLAG) && edge_a) || ((tmr_flag & TMR_C2_FLAG) && edge_b)) ? SET : RESET;
+}
+
+uint32_t tmr_counter_value_get(tmr_type *tmr_x)
+{
+  access();
+  if(tmr_x == &enc_tmr)
+  {
+    count_read = count_now;
+    return (uint32_t)count_now & 0xFFFF;
+  }
+  return time_base(now);
+}
+
+uint32_t tmr_channel_value_get(tmr_type *tmr_x, tmr_channel_select_type tmr_channel)
+{
+  access();
+  return (tmr_channel == TMR_SELECT_CHANNEL_1) ? capture_a : capture_b;
+}
+
+/* runs a motion for some seconds: every position read against the shaft
+   count, every sample after the warmup against the shaft velocity within
+   rel of it plus abs */
+static void run(const char *name, motion_type moved, double seconds, double irq_latency, int readers_above,
+                int sets, double rel, double abs, double warmup)
+{
+  enc_config_type cfg;
+  double end, next_sample, last_sample, velocity, expected;
+  long reads = 0, wrong = 0, samples = 0, off = 0;
+  int64_t position;
+
+  motion = moved;
+  now = 0;
+  latency = irq_latency;
+  irq_at = -1;
+  enc_flags = 0;
+  edge_a = edge_b = 0;
+  irq_runs = 0;
+  above_irq = 0;
+  set_rate = 0;
+  set_runs = set_in_irq = 0;
+  world_to(0);
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.tmr = &enc_tmr;
+  cfg.counter_bits = 16;
+  cfg.mode = TMR_ENCODER_MODE_C;
+  cfg.time_tmr = &time_tmr;
+  cfg.time_bits = 16;
+  cfg.time_channel_a = 1;
+  cfg.time_channel_b = 2;
+  cfg.tick_freq = (uint32_t)TICK_FREQ;
+  cfg.sample_freq = 1000;
+  cfg.stop_ticks = (uint32_t)TICK_FREQ / 2;
+  CHECK(enc_init(&enc, &cfg) == SUCCESS);
+  set_offset = enc_position_get(&enc) - count_read;
+  set_rate = sets;
+
+  end = now + seconds;
+  next_sample = now + 1e-3;
+  last_sample = now;
+  while(now < end)
+  {
+    above_irq = readers_above && (rand_get() & 1);
+    position = enc_position_get(&enc);
+    above_irq = 0;
+    reads++;
+    if(position - set_offset != count_read && wrong++ < 3)
+    {
+      printf("  %s: read %lld shaft %lld\n", name, (long long)(position - set_offset), count_read);
+    }
+
+    if(now >= next_sample)
+    {
+      next_sample += 1e-3;
+      above_irq = readers_above;
+      enc_sample(&enc);
+      above_irq = 0;
+      velocity = enc.velocity / 256.0;
+      expected = (shaft(now) - shaft(last_sample)) / (now - last_sample);
+      last_sample = now;
+      if(now > warmup)
+      {
+        samples++;
+        if(fabs(velocity - expected) > abs + rel * fabs(expected) && off++ < 3)
+        {
+          printf("  %s: velocity %.2f shaft %.2f\n", name, velocity, expected);
+        }
+      }
+    }
+    access();
+  }
+
+  printf("%-32s reads %ld wrong %ld, irqs %ld, sets %ld (%ld in the irq), samples %ld off %ld\n",
+         name, reads, wrong, irq_runs, set_runs, set_in_irq, samples, off);
+  CHECK(wrong == 0);
+  CHECK(off == 0);
+  CHECK(irq_runs > 0);
+  CHECK(sets == 0 || (set_runs > 0 && set_in_irq > 0));
+}
+
+static void motion_test(void)
+{
+  run("high speed 1e6 c/s", MOTION_FAST, 0.4, 20e-6, 0, 0, 0.002, 0, 0.01);
+  run("high speed, readers above irq", MOTION_FAST, 0.4, 20e-6, 1, 0, 0.002, 0, 0.01);
+  run("low speed -20 c/s", MOTION_SLOW_BACK, 3.0, 20e-6, 0, 0, 0.001, 0, 0.15);
+  run("shaking across a wrap", MOTION_SHAKE, 0.3, 50e-6, 1, 0, 0, 1e9, 1e9);
+  run("reversing, 2 ms irq latency", MOTION_REVERSE, 0.6, 2e-3, 1, 0, 0.01, 5000, 0.01);
+}
+
+static void position_set_test(void)
+{
+  run("high speed, sets above irq", MOTION_FAST, 0.4, 20e-6, 0, 50, 0.002, 0, 0.01);
+  run("reversing, sets above irq", MOTION_REVERSE, 0.6, 2e-3, 1, 50, 0.01, 5000, 0.01);
+
+  /* at rest the set position reads back */
+  motion = MOTION_STOP;
+  world_to(now + 1e-3);
+  enc_position_set(&enc, 1000000000000LL);
+  CHECK(enc_position_get(&enc) == 1000000000000LL);
+}
+
+int main(void)
+{
+  motion_test();
+  position_set_test();
+
+  printf(fails ? "FAILED\n" : "PASSED\n");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,611 @@
+/**
+  **************************************************************************
+  * @file     flash_ftl.c
+  * @brief    flash translation layer for block storage on nor flash
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+#include "flash_ftl.h"
+
+/** @addtogroup AT32F415_middlewares_flash_ftl_library
+  * @{
+  */
+
+/* sector header and slot tags in the first slot of every sector */
+#define FLASH_FTL_MAGIC                  0x4C544641
+#define FLASH_FTL_HEADER_SIZE            16
+#define FLASH_FTL_TAG_SIZE               8
+#define FLASH_FTL_NONE                   0xFFFF
+
+/**
+  * @brief  crc32 of the header words, a torn header or one whose magic was
+  *         cleared before erase never checks.
+  */
+static uint32_t flash_ftl_crc(const uint32_t *word, uint32_t count)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t bit;
+
+  while(count--)
+  {
+    crc ^= *word++;
+    for(bit = 0; bit < 32; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+/**
+  * @brief  byte offset of a sector.
+  */
+static uint32_t flash_ftl_sector_addr(flash_ftl_type *ftl, uint32_t sector)
+{
+  return sector * ftl->media->sector_size;
+}
+
+/**
+  * @brief  read the header and the tags of a sector.
+  * @param  ftl: the ftl.
+  * @param  sector: sector number.
+  * @param  meta: header words followed by two words per slot.
+  * @retval SUCCESS when the header is valid.
+  */
+static error_status flash_ftl_meta_read(flash_ftl_type *ftl, uint32_t sector, uint32_t *meta)
+{
+  if(ftl->media->read(flash_ftl_sector_addr(ftl, sector), (uint8_t *)meta,
+                      FLASH_FTL_HEADER_SIZE + ftl->slots * FLASH_FTL_TAG_SIZE) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  if(meta[0] != FLASH_FTL_MAGIC || meta[3] != flash_ftl_crc(meta, 3))
+  {
+    return ERROR;
+  }
+  return SUCCESS;
+}
+
+/**
+  * @brief  logical block of a slot tag, FLASH_FTL_UNMAPPED for a blank, torn
+  *         or out of range tag.
+  */
+static uint32_t flash_ftl_tag_block(flash_ftl_type *ftl, const uint32_t *meta, uint32_t slot)
+{
+  const uint32_t *tag = &meta[FLASH_FTL_HEADER_SIZE / 4 + slot * 2];
+
+  if(tag[0] != ~tag[1] || tag[0] >= ftl->block_count)
+  {
+    return FLASH_FTL_UNMAPPED;
+  }
+  return tag[0];
+}
+
+/**
+  * @brief  check that a region reads back erased.
+  */
+static confirm_state flash_ftl_blank(flash_ftl_type *ftl, uint32_t addr, uint32_t length)
+{
+  uint32_t chunk[16];
+  uint32_t size, index;
+
+  while(length)
+  {
+    size = length < sizeof(chunk) ? length : sizeof(chunk);
+    if(ftl->media->read(addr, (uint8_t *)chunk, size) != SUCCESS)
+    {
+      return FALSE;
+    }
+    for(index = 0; index < size / 4; index++)
+    {
+      if(chunk[index] != 0xFFFFFFFF)
+      {
+        return FALSE;
+      }
+    }
+    addr += size;
+    length -= size;
+  }
+  return TRUE;
+}
+
+/**
+  * @brief  make a free sector blank, erasing it only when it is not.
+  */
+static error_status flash_ftl_erase(flash_ftl_type *ftl, uint32_t sector)
+{
+  uint32_t addr = flash_ftl_sector_addr(ftl, sector);
+
+  if(flash_ftl_blank(ftl, addr, ftl->media->sector_size) == FALSE)
+  {
+    if(ftl->media->erase(addr) != SUCCESS)
+    {
+      return ERROR;
+    }
+    ftl->erase_count[sector]++;
+    ftl->stats.erases++;
+  }
+  ftl->state[sector] = FLASH_FTL_SECTOR_ERASED;
+  return SUCCESS;
+}
+
+/**
+  * @brief  take the least worn free sector, preferring erased ones, write its
+  *         header and make it the active sector.
+  */
+static error_status flash_ftl_open(flash_ftl_type *ftl)
+{
+  uint32_t header[4];
+  uint32_t sector, best = FLASH_FTL_NONE;
+
+  for(sector = 0; sector < ftl->sector_count; sector++)
+  {
+    if(ftl->state[sector] > FLASH_FTL_SECTOR_ERASED)
+    {
+      continue;
+    }
+    if(best == FLASH_FTL_NONE || ftl->state[sector] > ftl->state[best] ||
+       (ftl->state[sector] == ftl->state[best] && ftl->erase_count[sector] < ftl->erase_count[best]))
+    {
+      best = sector;
+    }
+  }
+
+  if(best == FLASH_FTL_NONE)
+  {
+    return ERROR;
+  }
+  if(ftl->state[best] == FLASH_FTL_SECTOR_DIRTY && flash_ftl_erase(ftl, best) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  /* the sector leaves the free pool even if the header program fails */
+  ftl->free_count--;
+  ftl->state[best] = FLASH_FTL_SECTOR_FULL;
+  ftl->valid[best] = 0;
+  ftl->sector_seq[best] = ++ftl->seq;
+
+  header[0] = FLASH_FTL_MAGIC;
+  header[1] = ftl->seq;
+  header[2] = ftl->erase_count[best];
+  header[3] = flash_ftl_crc(header, 3);
+  if(ftl->media->program(flash_ftl_sector_addr(ftl, best), (uint8_t *)header, sizeof(header)) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  ftl->state[best] = FLASH_FTL_SECTOR_ACTIVE;
+  ftl->active = best;
+  ftl->write_slot = 0;
+  return SUCCESS;
+}
+
+/**
+  * @brief  append a block to the active sector and point the map at it. the
+  *         data is programmed before its tag, so a block without a valid tag
+  *         is never used.
+  */
+static error_status flash_ftl_append(flash_ftl_type *ftl, uint32_t block, const uint8_t *buffer)
+{
+  uint32_t tag[2];
+  uint32_t addr, slot, old;
+
+  if(ftl->active == FLASH_FTL_NONE || ftl->write_slot == ftl->slots)
+  {
+    if(ftl->active != FLASH_FTL_NONE)
+    {
+      ftl->state[ftl->active] = FLASH_FTL_SECTOR_FULL;
+      ftl->active = FLASH_FTL_NONE;
+    }
+    if(flash_ftl_open(ftl) != SUCCESS)
+    {
+      return ERROR;
+    }
+  }
+
+  slot = ftl->write_slot++;
+  addr = flash_ftl_sector_addr(ftl, ftl->active);
+  tag[0] = block;
+  tag[1] = ~block;
+  ftl->stats.flash_writes++;
+
+  if(ftl->media->program(addr + (slot + 1) * FLASH_FTL_BLOCK_SIZE, buffer, FLASH_FTL_BLOCK_SIZE) != SUCCESS ||
+     ftl->media->program(addr + FLASH_FTL_HEADER_SIZE + slot * FLASH_FTL_TAG_SIZE, (uint8_t *)tag, sizeof(tag)) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  old = ftl->map[block];
+  if(old != FLASH_FTL_UNMAPPED)
+  {
+    ftl->valid[old / ftl->slots]--;
+  }
+  ftl->map[block] = ftl->active * ftl->slots + slot;
+  ftl->valid[ftl->active]++;
+  return SUCCESS;
+}
+
+/**
+  * @brief  full sector with the fewest valid blocks, the least worn on a tie.
+  */
+static uint32_t flash_ftl_victim(flash_ftl_type *ftl)
+{
+  uint32_t sector, best = FLASH_FTL_NONE;
+
+  for(sector = 0; sector < ftl->sector_count; sector++)
+  {
+    if(ftl->state[sector] != FLASH_FTL_SECTOR_FULL)
+    {
+      continue;
+    }
+    if(best == FLASH_FTL_NONE || ftl->valid[sector] < ftl->valid[best] ||
+       (ftl->valid[sector] == ftl->valid[best] && ftl->erase_count[sector] < ftl->erase_count[best]))
+    {
+      best = sector;
+    }
+  }
+  return best;
+}
+
+/**
+  * @brief  check that the valid blocks of a sector fit in the active sector
+  *         and one free sector.
+  */
+static confirm_state flash_ftl_room(flash_ftl_type *ftl, uint32_t sector)
+{
+  uint32_t room = 0;
+
+  if(ftl->active != FLASH_FTL_NONE)
+  {
+    room = ftl->slots - ftl->write_slot;
+  }
+  if(ftl->free_count != 0)
+  {
+    room += ftl->slots;
+  }
+  return ftl->valid[sector] <= room ? TRUE : FALSE;
+}
+
+/**
+  * @brief  move the valid blocks of a sector to the active sector and erase it.
+  *         the magic is cleared before the erase so an interrupted erase
+  *         leaves a sector without a header.
+  */
+static error_status flash_ftl_collect(flash_ftl_type *ftl, uint32_t sector)
+{
+  uint32_t meta[(FLASH_FTL_HEADER_SIZE + FLASH_FTL_SLOT_MAX * FLASH_FTL_TAG_SIZE) / 4];
+  uint32_t addr = flash_ftl_sector_addr(ftl, sector);
+  uint32_t slot, block, zero = 0;
+
+  if(ftl->valid[sector] != 0)
+  {
+    if(flash_ftl_meta_read(ftl, sector, meta) != SUCCESS)
+    {
+      return ERROR;
+    }
+    for(slot = 0; slot < ftl->slots; slot++)
+    {
+      block = flash_ftl_tag_block(ftl, meta, slot);
+      if(block == FLASH_FTL_UNMAPPED || ftl->map[block] != sector * ftl->slots + slot)
+      {
+        continue;
+      }
+      if(ftl->media->read(addr + (slot + 1) * FLASH_FTL_BLOCK_SIZE, (uint8_t *)ftl->buffer, FLASH_FTL_BLOCK_SIZE) != SUCCESS ||
+         flash_ftl_append(ftl, block, (uint8_t *)ftl->buffer) != SUCCESS)
+      {
+        return ERROR;
+      }
+      ftl->stats.gc_copies++;
+    }
+  }
+
+  if(ftl->media->program(addr, (uint8_t *)&zero, sizeof(zero)) != SUCCESS)
+  {
+    return ERROR;
+  }
+  ftl->state[sector] = FLASH_FTL_SECTOR_DIRTY;
+  ftl->free_count++;
+  ftl->stats.gc_count++;
+  return flash_ftl_erase(ftl, sector);
+}
+
+/**
+  * @brief  mount the ftl on a flash region, rebuilding the map from the sector
+  *         tags. a blank region mounts as an empty disk.
+  * @param  ftl: the ftl.
+  * @param  media: the flash region, at most FLASH_FTL_SECTOR_MAX sectors of
+  *         2 to FLASH_FTL_SLOT_MAX + 1 blocks.
+  * @retval ERROR when the region does not fit the ram tables or cannot be read.
+  */
+error_status flash_ftl_init(flash_ftl_type *ftl, const flash_ftl_media_type *media)
+{
+  uint32_t meta[(FLASH_FTL_HEADER_SIZE + FLASH_FTL_SLOT_MAX * FLASH_FTL_TAG_SIZE) / 4];
+  uint32_t sector, slot, block, cur, cur_sector, newest = FLASH_FTL_NONE;
+  uint32_t known = 0, erase_sum = 0, spare;
+  uint8_t *byte = (uint8_t *)&ftl->stats;
+
+  ftl->media = media;
+  ftl->slots = media->sector_size / FLASH_FTL_BLOCK_SIZE - 1;
+  ftl->sector_count = media->sector_count;
+  spare = FLASH_FTL_SPARE_SECTORS + media->sector_count / FLASH_FTL_SPARE_DIV;
+  if(ftl->slots == 0 || ftl->slots > FLASH_FTL_SLOT_MAX ||
+     media->sector_count > FLASH_FTL_SECTOR_MAX || media->sector_count <= spare)
+  {
+    return ERROR;
+  }
+  ftl->block_count = (media->sector_count - spare) * ftl->slots;
+  if(ftl->block_count > FLASH_FTL_BLOCK_MAX)
+  {
+    return ERROR;
+  }
+
+  ftl->seq = 0;
+  ftl->active = FLASH_FTL_NONE;
+  ftl->write_slot = 0;
+  ftl->free_count = 0;
+  for(block = 0; block < ftl->block_count; block++)
+  {
+    ftl->map[block] = FLASH_FTL_UNMAPPED;
+  }
+  for(block = 0; block < sizeof(flash_ftl_stats_type); block++)
+  {
+    byte[block] = 0;
+  }
+
+  for(sector = 0; sector < ftl->sector_count; sector++)
+  {
+    ftl->valid[sector] = 0;
+    ftl->sector_seq[sector] = 0;
+    if(flash_ftl_meta_read(ftl, sector, meta) != SUCCESS)
+    {
+      ftl->state[sector] = FLASH_FTL_SECTOR_DIRTY;
+      ftl->erase_count[sector] = FLASH_FTL_NONE;
+      ftl->free_count++;
+      continue;
+    }
+
+    ftl->state[sector] = FLASH_FTL_SECTOR_FULL;
+    ftl->sector_seq[sector] = meta[1];
+    ftl->erase_count[sector] = meta[2];
+    erase_sum += meta[2];
+    known++;
+    if(newest == FLASH_FTL_NONE || meta[1] > ftl->seq)
+    {
+      ftl->seq = meta[1];
+      newest = sector;
+    }
+
+    /* the newest copy of a block wins: later sector, or later slot */
+    for(slot = 0; slot < ftl->slots; slot++)
+    {
+      block = flash_ftl_tag_block(ftl, meta, slot);
+      if(block == FLASH_FTL_UNMAPPED)
+      {
+        continue;
+      }
+      cur = ftl->map[block];
+      if(cur != FLASH_FTL_UNMAPPED)
+      {
+        cur_sector = cur / ftl->slots;
+        if(ftl->sector_seq[cur_sector] > meta[1] ||
+           (cur_sector == sector && cur > sector * ftl->slots + slot))
+        {
+          continue;
+        }
+        ftl->valid[cur_sector]--;
+      }
+      ftl->map[block] = sector * ftl->slots + slot;
+      ftl->valid[sector]++;
+    }
+  }
+
+  /* sectors without a header inherit the average wear */
+  for(sector = 0; sector < ftl->sector_count; sector++)
+  {
+    if(ftl->erase_count[sector] == FLASH_FTL_NONE)
+    {
+      ftl->erase_count[sector] = known ? erase_sum / known : 0;
+    }
+  }
+
+  /* resume the newest sector after its last tagged slot, skipping a slot
+     whose data was programmed without its tag */
+  if(newest != FLASH_FTL_NONE)
+  {
+    if(ftl->media->read(flash_ftl_sector_addr(ftl, newest), (uint8_t *)meta,
+                        FLASH_FTL_HEADER_SIZE + ftl->slots * FLASH_FTL_TAG_SIZE) != SUCCESS)
+    {
+      return ERROR;
+    }
+    for(slot = ftl->slots; slot > 0; slot--)
+    {
+      if(meta[FLASH_FTL_HEADER_SIZE / 4 + (slot - 1) * 2] != 0xFFFFFFFF ||
+         meta[FLASH_FTL_HEADER_SIZE / 4 + (slot - 1) * 2 + 1] != 0xFFFFFFFF)
+      {
+        break;
+      }
+    }
+    while(slot < ftl->slots &&
+          flash_ftl_blank(ftl, flash_ftl_sector_addr(ftl, newest) + (slot + 1) * FLASH_FTL_BLOCK_SIZE,
+                          FLASH_FTL_BLOCK_SIZE) == FALSE)
+    {
+      slot++;
+    }
+    if(slot < ftl->slots)
+    {
+      ftl->state[newest] = FLASH_FTL_SECTOR_ACTIVE;
+      ftl->active = newest;
+      ftl->write_slot = slot;
+    }
+  }
+  return SUCCESS;
+}
+
+/**
+  * @brief  read logical blocks, blocks never written read as 0xff.
+  * @param  ftl: the ftl.
+  * @param  block: first logical block.
+  * @param  buffer: count * FLASH_FTL_BLOCK_SIZE bytes.
+  * @param  count: number of blocks.
+  * @retval ERROR on a range or media error.
+  */
+error_status flash_ftl_read(flash_ftl_type *ftl, uint32_t block, uint8_t *buffer, uint32_t count)
+{
+  uint32_t phys, index;
+
+  if(block + count > ftl->block_count || block + count < block)
+  {
+    return ERROR;
+  }
+
+  while(count--)
+  {
+    phys = ftl->map[block++];
+    if(phys == FLASH_FTL_UNMAPPED)
+    {
+      for(index = 0; index < FLASH_FTL_BLOCK_SIZE; index++)
+      {
+        buffer[index] = 0xFF;
+      }
+    }
+    else if(ftl->media->read(flash_ftl_sector_addr(ftl, phys / ftl->slots) +
+                             (phys % ftl->slots + 1) * FLASH_FTL_BLOCK_SIZE, buffer, FLASH_FTL_BLOCK_SIZE) != SUCCESS)
+    {
+      return ERROR;
+    }
+    buffer += FLASH_FTL_BLOCK_SIZE;
+  }
+  return SUCCESS;
+}
+
+/**
+  * @brief  write logical blocks. a sector is collected first only when the
+  *         write would take the last free sector, which garbage collection
+  *         needs.
+  * @param  ftl: the ftl.
+  * @param  block: first logical block.
+  * @param  buffer: count * FLASH_FTL_BLOCK_SIZE bytes.
+  * @param  count: number of blocks.
+  * @retval ERROR on a range or media error.
+  */
+error_status flash_ftl_write(flash_ftl_type *ftl, uint32_t block, const uint8_t *buffer, uint32_t count)
+{
+  uint32_t victim;
+
+  if(block + count > ftl->block_count || block + count < block)
+  {
+    return ERROR;
+  }
+
+  while(count--)
+  {
+    /* keep one free sector for the copies of the next collection */
+    while(ftl->free_count == 0 ||
+          (ftl->free_count == 1 && (ftl->active == FLASH_FTL_NONE || ftl->write_slot == ftl->slots)))
+    {
+      victim = flash_ftl_victim(ftl);
+      if(victim == FLASH_FTL_NONE || flash_ftl_room(ftl, victim) == FALSE ||
+         flash_ftl_collect(ftl, victim) != SUCCESS)
+      {
+        return ERROR;
+      }
+      ftl->stats.gc_forced++;
+    }
+
+    if(flash_ftl_append(ftl, block++, buffer) != SUCCESS)
+    {
+      return ERROR;
+    }
+    ftl->stats.host_writes++;
+    buffer += FLASH_FTL_BLOCK_SIZE;
+  }
+  return SUCCESS;
+}
+
+/**
+  * @brief  unmap logical blocks whose data the caller no longer needs, so
+  *         garbage collection does not copy them. an unmapped block reads as
+  *         0xff. the unmap is not written to the flash, after a power loss
+  *         the block may read as any of its earlier contents.
+  * @param  ftl: the ftl.
+  * @param  block: first logical block.
+  * @param  count: number of blocks.
+  * @retval ERROR on a range error.
+  */
+error_status flash_ftl_trim(flash_ftl_type *ftl, uint32_t block, uint32_t count)
+{
+  uint32_t phys;
+
+  if(block + count > ftl->block_count || block + count < block)
+  {
+    return ERROR;
+  }
+
+  while(count--)
+  {
+    phys = ftl->map[block];
+    if(phys != FLASH_FTL_UNMAPPED)
+    {
+      ftl->valid[phys / ftl->slots]--;
+      ftl->map[block] = FLASH_FTL_UNMAPPED;
+      ftl->stats.trims++;
+    }
+    block++;
+  }
+  return SUCCESS;
+}
+
+/**
+  * @brief  do one unit of deferred work: collect a sector at most half valid
+  *         while fewer than FLASH_FTL_GC_FREE_TARGET are free, else erase a
+  *         dirty free sector. call it when the host is idle, from the same
+  *         context as the reads and writes.
+  * @param  ftl: the ftl.
+  * @retval TRUE when work was done and more may be pending.
+  */
+confirm_state flash_ftl_background(flash_ftl_type *ftl)
+{
+  uint32_t sector;
+
+  if(ftl->free_count < FLASH_FTL_GC_FREE_TARGET)
+  {
+    sector = flash_ftl_victim(ftl);
+    if(sector != FLASH_FTL_NONE && ftl->valid[sector] <= ftl->slots / 2 &&
+       flash_ftl_room(ftl, sector) == TRUE)
+    {
+      return flash_ftl_collect(ftl, sector) == SUCCESS ? TRUE : FALSE;
+    }
+  }
+
+  for(sector = 0; sector < ftl->sector_count; sector++)
+  {
+    if(ftl->state[sector] == FLASH_FTL_SECTOR_DIRTY)
+    {
+      return flash_ftl_erase(ftl, sector) == SUCCESS ? TRUE : FALSE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,187 @@
+/**
+  **************************************************************************
+  * @file     flash_ftl.h
+  * @brief    flash translation layer for block storage on nor flash header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_FTL_H
+#define __FLASH_FTL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_flash_ftl_library
+  * @{
+  */
+
+/** @defgroup FLASH_FTL_library_definition
+  * @{
+  */
+
+/**
+  * @brief the ftl exports FLASH_FTL_BLOCK_SIZE byte logical blocks on a flash
+  *        region of equal erase sectors (4 kb on the w25q spi nor, 1 or 2 kb
+  *        on the internal flash). blocks are written to the next free slot of
+  *        the active sector instead of in place, so a block write never needs
+  *        a read-erase-write of its sector. the first slot of every sector
+  *        holds its header and one tag (logical block number) per data slot,
+  *        the map is rebuilt from these tags at init, the newest copy of a
+  *        block wins. stale copies are reclaimed by garbage collection, in
+  *        flash_ftl_background when the host is idle and in the write path
+  *        only when free sectors run out.
+  */
+#define FLASH_FTL_BLOCK_SIZE             512
+
+/**
+  * @brief ram sizes: the map takes two bytes per logical block, the sector
+  *        tables nine bytes per sector.
+  */
+#ifndef FLASH_FTL_SECTOR_MAX
+#define FLASH_FTL_SECTOR_MAX             256
+#endif
+#ifndef FLASH_FTL_BLOCK_MAX
+#define FLASH_FTL_BLOCK_MAX              1792
+#endif
+#define FLASH_FTL_SLOT_MAX               15       /* data slots of an 8 kb sector */
+
+/**
+  * @brief sectors kept out of the exported capacity for garbage collection,
+  *        FLASH_FTL_SPARE_SECTORS plus one per FLASH_FTL_SPARE_DIV sectors.
+  */
+#ifndef FLASH_FTL_SPARE_SECTORS
+#define FLASH_FTL_SPARE_SECTORS          4
+#endif
+#ifndef FLASH_FTL_SPARE_DIV
+#define FLASH_FTL_SPARE_DIV              32
+#endif
+
+/**
+  * @brief flash_ftl_background collects sectors while fewer than this many are
+  *        free, the write path collects when only one is left.
+  */
+#ifndef FLASH_FTL_GC_FREE_TARGET
+#define FLASH_FTL_GC_FREE_TARGET         6
+#endif
+
+#define FLASH_FTL_UNMAPPED               0xFFFF
+
+/**
+  * @}
+  */
+
+/** @defgroup FLASH_FTL_library_handler
+  * @{
+  */
+
+/**
+  * @brief flash region access, addresses are offsets in the region. program
+  *        only clears bits and may be called again on programmed bytes with
+  *        zero bits, erase sets a whole sector to 0xff.
+  */
+typedef struct
+{
+  uint32_t                               sector_size;             /*!< erase unit in bytes             */
+  uint32_t                               sector_count;            /*!< sectors in the region           */
+  error_status (*read)(uint32_t addr, uint8_t *buffer, uint32_t length);          /*!< read bytes   */
+  error_status (*program)(uint32_t addr, const uint8_t *buffer, uint32_t length); /*!< program bytes */
+  error_status (*erase)(uint32_t addr);                                           /*!< erase sector */
+} flash_ftl_media_type;
+
+/**
+  * @brief sector state
+  */
+typedef enum
+{
+  FLASH_FTL_SECTOR_DIRTY                 = 0x00, /*!< free, content unknown     */
+  FLASH_FTL_SECTOR_ERASED                = 0x01, /*!< free and blank            */
+  FLASH_FTL_SECTOR_ACTIVE                = 0x02, /*!< receiving block writes    */
+  FLASH_FTL_SECTOR_FULL                  = 0x03  /*!< written, may hold valid blocks */
+} flash_ftl_sector_state_type;
+
+/**
+  * @brief statistics, a block write is FLASH_FTL_BLOCK_SIZE bytes
+  */
+typedef struct
+{
+  uint32_t                               host_writes;             /*!< blocks written by the caller    */
+  uint32_t                               flash_writes;            /*!< blocks programmed, with gc      */
+  uint32_t                               erases;                  /*!< sectors erased                  */
+  uint32_t                               gc_count;                /*!< sectors collected               */
+  uint32_t                               gc_forced;               /*!< collected in the write path     */
+  uint32_t                               gc_copies;               /*!< valid blocks moved by gc        */
+  uint32_t                               trims;                   /*!< mapped blocks unmapped          */
+} flash_ftl_stats_type;
+
+/**
+  * @brief flash translation layer, owned by the caller
+  */
+typedef struct
+{
+  const flash_ftl_media_type             *media;                  /*!< flash region                    */
+  uint32_t                               block_count;             /*!< exported logical blocks         */
+  uint32_t                               seq;                     /*!< newest sector sequence          */
+  uint16_t                               sector_count;            /*!< sectors in use                  */
+  uint16_t                               slots;                   /*!< data slots per sector           */
+  uint16_t                               active;                  /*!< sector receiving writes         */
+  uint16_t                               write_slot;              /*!< next slot of the active sector  */
+  uint16_t                               free_count;              /*!< dirty and erased sectors        */
+  uint16_t                               map[FLASH_FTL_BLOCK_MAX];          /*!< block to slot       */
+  uint8_t                                valid[FLASH_FTL_SECTOR_MAX];       /*!< valid slots         */
+  uint8_t                                state[FLASH_FTL_SECTOR_MAX];       /*!< sector state        */
+  uint32_t                               sector_seq[FLASH_FTL_SECTOR_MAX];  /*!< write order         */
+  uint32_t                               erase_count[FLASH_FTL_SECTOR_MAX]; /*!< wear                */
+  uint32_t                               buffer[FLASH_FTL_BLOCK_SIZE / 4];  /*!< gc copy buffer      */
+  flash_ftl_stats_type                   stats;                   /*!< statistics                      */
+} flash_ftl_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup FLASH_FTL_library_exported_functions
+  * @{
+  */
+
+error_status      flash_ftl_init                (flash_ftl_type *ftl, const flash_ftl_media_type *media);
+error_status      flash_ftl_read                (flash_ftl_type *ftl, uint32_t block, uint8_t *buffer, uint32_t count);
+error_status      flash_ftl_write               (flash_ftl_type *ftl, uint32_t block, const uint8_t *buffer, uint32_t count);
+error_status      flash_ftl_trim                (flash_ftl_type *ftl, uint32_t block, uint32_t count);
+confirm_state     flash_ftl_background          (flash_ftl_type *ftl);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
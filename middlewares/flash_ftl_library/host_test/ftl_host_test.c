@@ -0,0 +1,307 @@
+/**
+  **************************************************************************
+  * @file     ftl_host_test.c
+  * @brief    host simulator of the flash translation layer with power loss
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs flash_ftl.c on the host over a ram model of a 256 kb spi nor with
+ * 4 kb sectors. a power cut is simulated at a random program or erase:
+ * the cut program leaves a random prefix of its bytes (and a partly
+ * programmed byte), the cut erase leaves random bits set, then the ftl is
+ * mounted again and every logical block must read back either its last
+ * completed write or the write that was cut.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "flash_ftl.h"
+
+#define NOR_SECTOR_SIZE                  4096
+#define NOR_SECTOR_COUNT                 64
+#define NOR_READ_KB_PER_MS               2.25
+#define NOR_PAGE_PROGRAM_MS              0.7
+#define NOR_SECTOR_ERASE_MS              45.0
+
+#define POWER_CUT_CYCLES                 3000
+#define POWER_CUT_OPS_MAX                400
+
+static uint8_t nor[NOR_SECTOR_SIZE * NOR_SECTOR_COUNT];
+static long nor_ops, nor_cut_at = -1;
+static jmp_buf nor_cut;
+static double nor_time_ms;
+static uint32_t rand_state = 1;
+
+static flash_ftl_type ftl;
+static uint32_t block_version[FLASH_FTL_BLOCK_MAX];
+static uint32_t block_pending[FLASH_FTL_BLOCK_MAX];
+static uint32_t next_version = 1;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+/* nor model, programming only clears bits */
+
+static void nor_power_check(void)
+{
+  if(nor_cut_at >= 0 && nor_ops++ == nor_cut_at)
+  {
+    longjmp(nor_cut, 1);
+  }
+}
+
+static error_status nor_read(uint32_t addr, uint8_t *buffer, uint32_t length)
+{
+  memcpy(buffer, nor + addr, length);
+  nor_time_ms += length / (NOR_READ_KB_PER_MS * 1000);
+  return SUCCESS;
+}
+
+static error_status nor_program(uint32_t addr, const uint8_t *buffer, uint32_t length)
+{
+  uint32_t index, done;
+
+  nor_time_ms += ((length + 255) / 256) * NOR_PAGE_PROGRAM_MS;
+  if(nor_cut_at >= 0 && nor_ops == nor_cut_at)
+  {
+    done = rand_get() % (length + 1);
+    for(index = 0; index < done; index++)
+    {
+      nor[addr + index] &= buffer[index];
+    }
+    if(done < length)
+    {
+      nor[addr + done] &= buffer[done] | (uint8_t)rand_get();
+    }
+  }
+  nor_power_check();
+  for(index = 0; index < length; index++)
+  {
+    nor[addr + index] &= buffer[index];
+  }
+  return SUCCESS;
+}
+
+static error_status nor_erase(uint32_t addr)
+{
+  uint32_t index;
+
+  nor_time_ms += NOR_SECTOR_ERASE_MS;
+  if(nor_cut_at >= 0 && nor_ops == nor_cut_at)
+  {
+    for(index = 0; index < NOR_SECTOR_SIZE; index++)
+    {
+      nor[addr + index] |= (uint8_t)rand_get() & (uint8_t)rand_get();
+    }
+  }
+  nor_power_check();
+  memset(nor + addr, 0xFF, NOR_SECTOR_SIZE);
+  return SUCCESS;
+}
+
+static const flash_ftl_media_type nor_media =
+{
+  NOR_SECTOR_SIZE, NOR_SECTOR_COUNT, nor_read, nor_program, nor_erase
+};
+
+/* block content: block number, version, then a filler derived from both */
+
+static void block_fill(uint8_t *buffer, uint32_t block, uint32_t version)
+{
+  uint32_t index;
+
+  memcpy(buffer, &block, 4);
+  memcpy(buffer + 4, &version, 4);
+  for(index = 8; index < FLASH_FTL_BLOCK_SIZE; index++)
+  {
+    buffer[index] = (uint8_t)(block * 7 + version * 13 + index);
+  }
+}
+
+static int block_check(const uint8_t *buffer, uint32_t block, uint32_t *version)
+{
+  uint8_t expect[FLASH_FTL_BLOCK_SIZE];
+  uint32_t index;
+
+  memset(expect, 0xFF, sizeof(expect));
+  if(memcmp(buffer, expect, sizeof(expect)) == 0)
+  {
+    /* never written */
+    *version = 0;
+    return 1;
+  }
+  memcpy(version, buffer + 4, 4);
+  block_fill(expect, block, *version);
+  for(index = 0; index < FLASH_FTL_BLOCK_SIZE; index++)
+  {
+    if(buffer[index] != expect[index])
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static long disk_verify(const char *when)
+{
+  uint8_t buffer[FLASH_FTL_BLOCK_SIZE];
+  uint32_t block, version = 0;
+  long bad = 0;
+
+  for(block = 0; block < ftl.block_count; block++)
+  {
+    if(flash_ftl_read(&ftl, block, buffer, 1) != SUCCESS || !block_check(buffer, block, &version) ||
+       (version != block_version[block] && version != block_pending[block]))
+    {
+      if(bad++ < 5)
+      {
+        printf("  %s: block %u got %u want %u or %u\n", when, block, version, block_version[block], block_pending[block]);
+      }
+    }
+    else
+    {
+      block_version[block] = version;
+    }
+    block_pending[block] = block_version[block];
+  }
+  return bad;
+}
+
+static void disk_write(uint32_t block, uint32_t count)
+{
+  static uint8_t buffer[8 * FLASH_FTL_BLOCK_SIZE];
+  uint32_t index;
+
+  for(index = 0; index < count; index++)
+  {
+    block_pending[block + index] = next_version;
+    block_fill(buffer + index * FLASH_FTL_BLOCK_SIZE, block + index, next_version++);
+  }
+  if(flash_ftl_write(&ftl, block, buffer, count) != SUCCESS)
+  {
+    printf("write of block %u failed, %u free sectors\n", block, ftl.free_count);
+    exit(1);
+  }
+  for(index = 0; index < count; index++)
+  {
+    block_version[block + index] = block_pending[block + index];
+  }
+}
+
+/* writes of 1 to 8 blocks, three quarters inside the hot area, idle gc at times */
+static void disk_workload(long steps, uint32_t hot)
+{
+  uint32_t block, count;
+  long step;
+
+  for(step = 0; step < steps; step++)
+  {
+    count = 1 + rand_get() % 8;
+    block = (rand_get() % 4 == 0) ? rand_get() % (ftl.block_count - count) : rand_get() % (hot - count);
+    disk_write(block, count);
+    if(rand_get() % 8 == 0)
+    {
+      while(flash_ftl_background(&ftl) == TRUE && rand_get() % 4);
+    }
+  }
+}
+
+int main(void)
+{
+  flash_ftl_stats_type stats;
+  uint32_t block;
+  long cycle, cuts = 0, bad = 0;
+  double start, naive;
+
+  memset(nor, 0xFF, sizeof(nor));
+  if(flash_ftl_init(&ftl, &nor_media) != SUCCESS)
+  {
+    printf("init failed\n");
+    return 1;
+  }
+  printf("geometry: %u sectors, %u slots, %u blocks (%u kb of %u kb)\n",
+         ftl.sector_count, ftl.slots, ftl.block_count, ftl.block_count / 2, NOR_SECTOR_COUNT * NOR_SECTOR_SIZE / 1024);
+
+  /* fill the disk then random overwrites, no power loss */
+  for(block = 0; block + 8 <= ftl.block_count; block += 8)
+  {
+    disk_write(block, 8);
+  }
+  disk_workload(20000, ftl.block_count);
+  bad += disk_verify("steady");
+  stats = ftl.stats;
+  printf("steady state: host %u flash %u (wa %.2f), erases %u, gc %u (forced %u), copies %u\n",
+         stats.host_writes, stats.flash_writes, (double)stats.flash_writes / stats.host_writes,
+         stats.erases, stats.gc_count, stats.gc_forced, stats.gc_copies);
+
+  /* mount again without loss */
+  if(flash_ftl_init(&ftl, &nor_media) != SUCCESS)
+  {
+    printf("remount failed\n");
+    return 1;
+  }
+  bad += disk_verify("remount");
+
+  /* power cuts at random program and erase operations */
+  for(cycle = 0; cycle < POWER_CUT_CYCLES; cycle++)
+  {
+    nor_ops = 0;
+    nor_cut_at = rand_get() % POWER_CUT_OPS_MAX;
+    if(setjmp(nor_cut) == 0)
+    {
+      disk_workload(1000, ftl.block_count / 3 + 16);
+    }
+    else
+    {
+      cuts++;
+    }
+    nor_cut_at = -1;
+    if(flash_ftl_init(&ftl, &nor_media) != SUCCESS)
+    {
+      printf("remount after power cut failed\n");
+      return 1;
+    }
+    bad += disk_verify("power cut");
+  }
+  printf("power cuts: %ld in %ld cycles, bad blocks %ld\n", cuts, cycle, bad);
+
+  /* sequential copy of 256 kb, idle gc first */
+  memset(&ftl.stats, 0, sizeof(ftl.stats));
+  while(flash_ftl_background(&ftl) == TRUE);
+  start = nor_time_ms;
+  for(block = 0; block < 512; block += 8)
+  {
+    disk_write((block + ftl.block_count / 3) % (ftl.block_count - 8), 8);
+  }
+  stats = ftl.stats;
+  naive = 512 * (NOR_SECTOR_SIZE / (NOR_READ_KB_PER_MS * 1000) + NOR_SECTOR_ERASE_MS + 16 * NOR_PAGE_PROGRAM_MS);
+  printf("256 kb copy: %.0f ms (%.0f kb/s), %u erases, %u forced gc; read-erase-write: %.0f ms (%.0f kb/s)\n",
+         nor_time_ms - start, 256000.0 / (nor_time_ms - start), stats.erases, stats.gc_forced, naive, 256000.0 / naive);
+
+  printf(bad ? "FAILED\n" : "passed\n");
+  return bad != 0;
+}
@@ -0,0 +1,785 @@
+/*
+ * FreeRTOS Kernel V10.4.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+/*
+ * An implementation of pvPortMalloc() and vPortFree() based on the two level
+ * segregated fit (TLSF) algorithm.  Free blocks are kept in size classes
+ * indexed by two bitmaps, so both allocation and free execute in constant time
+ * regardless of the number of free blocks, and adjacent free blocks are merged
+ * immediately as with heap_4.c.
+ *
+ * Small requests are served first from fixed-block pools (see heap_tlsf.h),
+ * which keeps short lived message buffers away from the general heap and so
+ * limits fragmentation.
+ *
+ * Use this file instead of heap_4.c, not in addition to it.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_tlsf.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+    #error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if ( portBYTE_ALIGNMENT != 8 )
+    #error heap_tlsf.c assumes an 8 byte alignment
+#endif
+
+/* Second level subdivisions of each power of two, as a power of two. */
+#define heapSL_INDEX_COUNT_LOG2    ( 4 )
+#define heapSL_INDEX_COUNT         ( 1UL << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks below heapSMALL_BLOCK_SIZE are kept in linear size classes. */
+#define heapALIGN_SIZE_LOG2        ( 3 )
+#define heapFL_INDEX_SHIFT         ( heapSL_INDEX_COUNT_LOG2 + heapALIGN_SIZE_LOG2 )
+#define heapSMALL_BLOCK_SIZE       ( ( size_t ) 1 << heapFL_INDEX_SHIFT )
+
+/* Largest block is 2^heapFL_INDEX_MAX bytes, enough for the whole SRAM. */
+#define heapFL_INDEX_MAX           ( 16 )
+#define heapFL_INDEX_COUNT         ( heapFL_INDEX_MAX - heapFL_INDEX_SHIFT + 1 )
+#define heapBLOCK_SIZE_MAX         ( ( size_t ) 1 << heapFL_INDEX_MAX )
+
+/* Flags kept in the low bits of xSize, sizes are multiples of 8. */
+#define heapBLOCK_FREE_BIT         ( ( size_t ) 1 )
+#define heapBLOCK_PREV_FREE_BIT    ( ( size_t ) 2 )
+#define heapBLOCK_FLAGS_MASK       ( heapBLOCK_FREE_BIT | heapBLOCK_PREV_FREE_BIT )
+
+/* Allocate the memory for the heap. */
+#if ( configAPPLICATION_ALLOCATED_HEAP == 1 )
+
+/* The application writer has already defined the array used for the RTOS
+* heap - probably so it can be placed in a special segment or address. */
+    extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+    PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Header of every block.  pxNextFree and pxPrevFree are only valid while the
+ * block is free, they overlay the first bytes of the payload otherwise. */
+typedef struct A_TLSF_BLOCK
+{
+    struct A_TLSF_BLOCK * pxPrevPhysBlock; /*<< The block physically before this one, valid when heapBLOCK_PREV_FREE_BIT is set. */
+    size_t xSize;                          /*<< Payload size in bytes plus the flag bits. */
+    struct A_TLSF_BLOCK * pxNextFree;      /*<< Next block in the same size class. */
+    struct A_TLSF_BLOCK * pxPrevFree;      /*<< Previous block in the same size class. */
+} TlsfBlock_t;
+
+/* Only the first two members are overhead for an allocated block. */
+#define heapHEADER_SIZE            ( ( size_t ) ( 2 * sizeof( void * ) + portBYTE_ALIGNMENT - 1 ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapMINIMUM_PAYLOAD        ( ( size_t ) ( 2 * sizeof( void * ) ) )
+
+#define heapBLOCK_SIZE( pxBlock )        ( ( pxBlock )->xSize & ~heapBLOCK_FLAGS_MASK )
+#define heapBLOCK_PAYLOAD( pxBlock )     ( ( void * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapHEADER_SIZE ) )
+#define heapBLOCK_FROM_PAYLOAD( pv )     ( ( TlsfBlock_t * ) ( ( ( uint8_t * ) ( pv ) ) - heapHEADER_SIZE ) )
+#define heapBLOCK_NEXT_PHYS( pxBlock )   ( ( TlsfBlock_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapHEADER_SIZE + heapBLOCK_SIZE( pxBlock ) ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Position of the most and least significant set bit, -1 for zero.
+ */
+static int prvFls( uint32_t ulWord );
+static int prvFfs( uint32_t ulWord );
+
+/*
+ * Map a size to its first and second level index.  prvMappingSearch() rounds
+ * the size up to the next class so that any block found there is big enough.
+ */
+static void prvMappingInsert( size_t xSize, int * pxFl, int * pxSl );
+static void prvMappingSearch( size_t xSize, int * pxFl, int * pxSl );
+
+/*
+ * Size class free list maintenance.
+ */
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) PRIVILEGED_FUNCTION;
+static TlsfBlock_t * prvSearchSuitableBlock( int xFl, int xSl ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called automatically to setup the required heap structures the first time
+ * pvPortMalloc() is called.
+ */
+static void prvHeapInit( void ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+/* Free list heads and the bitmaps of non-empty classes. */
+PRIVILEGED_DATA static TlsfBlock_t * pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+PRIVILEGED_DATA static uint32_t ulFlBitmap = 0;
+PRIVILEGED_DATA static uint32_t ulSlBitmap[ heapFL_INDEX_COUNT ];
+PRIVILEGED_DATA static BaseType_t xHeapInitialised = pdFALSE;
+
+/* Statistics. */
+PRIVILEGED_DATA static size_t xTotalHeapSize = 0U;
+PRIVILEGED_DATA static size_t xFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xMinimumEverFreeBytesRemaining = 0U;
+PRIVILEGED_DATA static size_t xNumberOfFreeBlocks = 0U;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulAllocations = 0;
+PRIVILEGED_DATA static size_t xNumberOfSuccessfulFrees = 0;
+PRIVILEGED_DATA static size_t xNumberOfFailedAllocations = 0;
+PRIVILEGED_DATA static uint32_t ulMaxAllocationTime = 0;
+PRIVILEGED_DATA static uint32_t ulAllocationTimeHistogram[ heapTLSF_LATENCY_BINS ];
+
+#if ( configHEAP_TLSF_POOL_COUNT > 0 )
+
+/* A free pool block only holds the link to the next free block. */
+    typedef struct A_POOL_BLOCK
+    {
+        struct A_POOL_BLOCK * pxNext;
+    } PoolBlock_t;
+
+    static const size_t xPoolBlockSizes[ configHEAP_TLSF_POOL_COUNT ] = configHEAP_TLSF_POOL_BLOCK_SIZES;
+    static const size_t xPoolBlockCounts[ configHEAP_TLSF_POOL_COUNT ] = configHEAP_TLSF_POOL_BLOCK_COUNTS;
+
+    PRIVILEGED_DATA static PoolBlock_t * pxPoolFreeList[ configHEAP_TLSF_POOL_COUNT ];
+    PRIVILEGED_DATA static uint8_t * pucPoolStart[ configHEAP_TLSF_POOL_COUNT ];
+    PRIVILEGED_DATA static uint8_t * pucPoolEnd[ configHEAP_TLSF_POOL_COUNT ];
+    PRIVILEGED_DATA static size_t xPoolFreeBlocks[ configHEAP_TLSF_POOL_COUNT ];
+    PRIVILEGED_DATA static size_t xPoolMinimumEverFreeBlocks[ configHEAP_TLSF_POOL_COUNT ];
+    PRIVILEGED_DATA static size_t xPoolMissCount[ configHEAP_TLSF_POOL_COUNT ];
+
+#endif /* configHEAP_TLSF_POOL_COUNT */
+
+/*-----------------------------------------------------------*/
+
+static int prvFls( uint32_t ulWord )
+{
+    if( ulWord == 0 )
+    {
+        return -1;
+    }
+
+    #if defined( __GNUC__ )
+        return 31 - __builtin_clz( ulWord );
+    #elif defined( __CC_ARM )
+        return 31 - ( int ) __clz( ulWord );
+    #elif defined( __ICCARM__ )
+        return 31 - ( int ) __CLZ( ulWord );
+    #else
+        {
+            int xBit = 31;
+
+            while( ( ulWord & 0x80000000UL ) == 0 )
+            {
+                ulWord <<= 1;
+                xBit--;
+            }
+
+            return xBit;
+        }
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static int prvFfs( uint32_t ulWord )
+{
+    return prvFls( ulWord & ( ~ulWord + 1UL ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, int * pxFl, int * pxSl )
+{
+    int xFl, xSl;
+
+    if( xSize < heapSMALL_BLOCK_SIZE )
+    {
+        xFl = 0;
+        xSl = ( int ) ( xSize / ( heapSMALL_BLOCK_SIZE / heapSL_INDEX_COUNT ) );
+    }
+    else
+    {
+        xFl = prvFls( ( uint32_t ) xSize );
+        xSl = ( int ) ( ( xSize >> ( xFl - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT );
+        xFl -= ( heapFL_INDEX_SHIFT - 1 );
+    }
+
+    *pxFl = xFl;
+    *pxSl = xSl;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize, int * pxFl, int * pxSl )
+{
+    if( xSize >= heapSMALL_BLOCK_SIZE )
+    {
+        xSize += ( ( size_t ) 1 << ( prvFls( ( uint32_t ) xSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+    }
+
+    prvMappingInsert( xSize, pxFl, pxSl );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    int xFl, xSl;
+
+    prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &xFl, &xSl );
+
+    pxBlock->pxPrevFree = NULL;
+    pxBlock->pxNextFree = pxFreeLists[ xFl ][ xSl ];
+
+    if( pxBlock->pxNextFree != NULL )
+    {
+        pxBlock->pxNextFree->pxPrevFree = pxBlock;
+    }
+
+    pxFreeLists[ xFl ][ xSl ] = pxBlock;
+    ulFlBitmap |= ( 1UL << xFl );
+    ulSlBitmap[ xFl ] |= ( 1UL << xSl );
+
+    xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+    xNumberOfFreeBlocks++;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( TlsfBlock_t * pxBlock ) /* PRIVILEGED_FUNCTION */
+{
+    int xFl, xSl;
+
+    prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &xFl, &xSl );
+
+    if( pxBlock->pxNextFree != NULL )
+    {
+        pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+    }
+
+    if( pxBlock->pxPrevFree != NULL )
+    {
+        pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+    }
+    else
+    {
+        /* The block was the head of its class. */
+        pxFreeLists[ xFl ][ xSl ] = pxBlock->pxNextFree;
+
+        if( pxFreeLists[ xFl ][ xSl ] == NULL )
+        {
+            ulSlBitmap[ xFl ] &= ~( 1UL << xSl );
+
+            if( ulSlBitmap[ xFl ] == 0 )
+            {
+                ulFlBitmap &= ~( 1UL << xFl );
+            }
+        }
+    }
+
+    xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+    xNumberOfFreeBlocks--;
+}
+/*-----------------------------------------------------------*/
+
+static TlsfBlock_t * prvSearchSuitableBlock( int xFl, int xSl ) /* PRIVILEGED_FUNCTION */
+{
+    uint32_t ulSlMap, ulFlMap;
+
+    /* First look for a non-empty class at this first level, then move up to
+     * the next non-empty first level. */
+    ulSlMap = ulSlBitmap[ xFl ] & ( ~0UL << xSl );
+
+    if( ulSlMap == 0 )
+    {
+        ulFlMap = ulFlBitmap & ( ~0UL << ( xFl + 1 ) );
+
+        if( ulFlMap == 0 )
+        {
+            return NULL;
+        }
+
+        xFl = prvFfs( ulFlMap );
+        ulSlMap = ulSlBitmap[ xFl ];
+    }
+
+    xSl = prvFfs( ulSlMap );
+
+    return pxFreeLists[ xFl ][ xSl ];
+}
+/*-----------------------------------------------------------*/
+
+void * pvPortMalloc( size_t xWantedSize )
+{
+    TlsfBlock_t * pxBlock, * pxRemainder;
+    void * pvReturn = NULL;
+    size_t xBlockSize;
+    int xFl, xSl;
+
+    #ifdef configHEAP_TLSF_TIMESTAMP
+        uint32_t ulStart, ulTime;
+    #endif
+
+    vTaskSuspendAll();
+    {
+        #ifdef configHEAP_TLSF_TIMESTAMP
+            ulStart = ( uint32_t ) configHEAP_TLSF_TIMESTAMP();
+        #endif
+
+        if( xHeapInitialised == pdFALSE )
+        {
+            prvHeapInit();
+        }
+
+        #if ( configHEAP_TLSF_POOL_COUNT > 0 )
+            {
+                BaseType_t xPool;
+                BaseType_t xMissCounted = pdFALSE;
+
+                /* Pools are sorted by block size, take the smallest that fits
+                 * and still has a free block. */
+                for( xPool = 0; ( xPool < configHEAP_TLSF_POOL_COUNT ) && ( pvReturn == NULL ); xPool++ )
+                {
+                    if( ( xWantedSize > 0 ) && ( xWantedSize <= xPoolBlockSizes[ xPool ] ) )
+                    {
+                        if( pxPoolFreeList[ xPool ] != NULL )
+                        {
+                            pvReturn = pxPoolFreeList[ xPool ];
+                            pxPoolFreeList[ xPool ] = pxPoolFreeList[ xPool ]->pxNext;
+                            xPoolFreeBlocks[ xPool ]--;
+
+                            if( xPoolFreeBlocks[ xPool ] < xPoolMinimumEverFreeBlocks[ xPool ] )
+                            {
+                                xPoolMinimumEverFreeBlocks[ xPool ] = xPoolFreeBlocks[ xPool ];
+                            }
+                        }
+                        else if( xMissCounted == pdFALSE )
+                        {
+                            xPoolMissCount[ xPool ]++;
+                            xMissCounted = pdTRUE;
+                        }
+                    }
+                }
+            }
+        #endif /* configHEAP_TLSF_POOL_COUNT */
+
+        if( ( pvReturn == NULL ) && ( xWantedSize > 0 ) && ( xWantedSize < heapBLOCK_SIZE_MAX ) )
+        {
+            /* Round up to the alignment and to the room needed by the free
+             * list links once the block is freed again. */
+            xBlockSize = ( xWantedSize + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+            if( xBlockSize < heapMINIMUM_PAYLOAD )
+            {
+                xBlockSize = heapMINIMUM_PAYLOAD;
+            }
+
+            prvMappingSearch( xBlockSize, &xFl, &xSl );
+
+            if( xFl < heapFL_INDEX_COUNT )
+            {
+                pxBlock = prvSearchSuitableBlock( xFl, xSl );
+            }
+            else
+            {
+                pxBlock = NULL;
+            }
+
+            if( pxBlock != NULL )
+            {
+                prvRemoveFreeBlock( pxBlock );
+
+                if( heapBLOCK_SIZE( pxBlock ) >= ( xBlockSize + heapHEADER_SIZE + heapMINIMUM_PAYLOAD ) )
+                {
+                    /* Split the block, the remainder stays free.  Its previous
+                     * block is the one being allocated so the prev free bit is
+                     * clear. */
+                    pxRemainder = ( TlsfBlock_t * ) ( ( ( uint8_t * ) pxBlock ) + heapHEADER_SIZE + xBlockSize );
+                    pxRemainder->xSize = ( heapBLOCK_SIZE( pxBlock ) - xBlockSize - heapHEADER_SIZE ) | heapBLOCK_FREE_BIT;
+                    pxRemainder->pxPrevPhysBlock = pxBlock;
+                    heapBLOCK_NEXT_PHYS( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+                    pxBlock->xSize = xBlockSize | ( pxBlock->xSize & heapBLOCK_PREV_FREE_BIT );
+                    prvInsertFreeBlock( pxRemainder );
+                }
+                else
+                {
+                    pxBlock->xSize &= ~heapBLOCK_FREE_BIT;
+                    heapBLOCK_NEXT_PHYS( pxBlock )->xSize &= ~heapBLOCK_PREV_FREE_BIT;
+                }
+
+                if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+                {
+                    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pvReturn = heapBLOCK_PAYLOAD( pxBlock );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        if( pvReturn != NULL )
+        {
+            xNumberOfSuccessfulAllocations++;
+        }
+        else
+        {
+            xNumberOfFailedAllocations++;
+        }
+
+        #ifdef configHEAP_TLSF_TIMESTAMP
+            {
+                int xBin;
+
+                ulTime = ( uint32_t ) configHEAP_TLSF_TIMESTAMP() - ulStart;
+                xBin = prvFls( ulTime ) + 1;
+
+                if( xBin >= heapTLSF_LATENCY_BINS )
+                {
+                    xBin = heapTLSF_LATENCY_BINS - 1;
+                }
+
+                ulAllocationTimeHistogram[ xBin ]++;
+
+                if( ulTime > ulMaxAllocationTime )
+                {
+                    ulMaxAllocationTime = ulTime;
+                }
+            }
+        #endif /* configHEAP_TLSF_TIMESTAMP */
+
+        traceMALLOC( pvReturn, xWantedSize );
+    }
+    ( void ) xTaskResumeAll();
+
+    #if ( configUSE_MALLOC_FAILED_HOOK == 1 )
+        {
+            if( pvReturn == NULL )
+            {
+                extern void vApplicationMallocFailedHook( void );
+                vApplicationMallocFailedHook();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* if ( configUSE_MALLOC_FAILED_HOOK == 1 ) */
+
+    configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+    return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void * pv )
+{
+    TlsfBlock_t * pxBlock, * pxNeighbour;
+
+    if( pv == NULL )
+    {
+        return;
+    }
+
+    vTaskSuspendAll();
+    {
+        #if ( configHEAP_TLSF_POOL_COUNT > 0 )
+            {
+                BaseType_t xPool;
+
+                for( xPool = 0; xPool < configHEAP_TLSF_POOL_COUNT; xPool++ )
+                {
+                    if( ( ( uint8_t * ) pv >= pucPoolStart[ xPool ] ) && ( ( uint8_t * ) pv < pucPoolEnd[ xPool ] ) )
+                    {
+                        ( ( PoolBlock_t * ) pv )->pxNext = pxPoolFreeList[ xPool ];
+                        pxPoolFreeList[ xPool ] = ( PoolBlock_t * ) pv;
+                        xPoolFreeBlocks[ xPool ]++;
+                        xNumberOfSuccessfulFrees++;
+                        traceFREE( pv, xPoolBlockSizes[ xPool ] );
+                        ( void ) xTaskResumeAll();
+                        return;
+                    }
+                }
+            }
+        #endif /* configHEAP_TLSF_POOL_COUNT */
+
+        pxBlock = heapBLOCK_FROM_PAYLOAD( pv );
+
+        /* Check the block is actually allocated. */
+        configASSERT( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 );
+
+        if( ( pxBlock->xSize & heapBLOCK_FREE_BIT ) == 0 )
+        {
+            traceFREE( pv, heapBLOCK_SIZE( pxBlock ) );
+            pxBlock->xSize |= heapBLOCK_FREE_BIT;
+
+            /* Merge with the previous block. */
+            if( ( pxBlock->xSize & heapBLOCK_PREV_FREE_BIT ) != 0 )
+            {
+                pxNeighbour = pxBlock->pxPrevPhysBlock;
+                prvRemoveFreeBlock( pxNeighbour );
+                pxNeighbour->xSize += heapHEADER_SIZE + heapBLOCK_SIZE( pxBlock );
+                pxBlock = pxNeighbour;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* Merge with the next block. */
+            pxNeighbour = heapBLOCK_NEXT_PHYS( pxBlock );
+
+            if( ( pxNeighbour->xSize & heapBLOCK_FREE_BIT ) != 0 )
+            {
+                prvRemoveFreeBlock( pxNeighbour );
+                pxBlock->xSize += heapHEADER_SIZE + heapBLOCK_SIZE( pxNeighbour );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxNeighbour = heapBLOCK_NEXT_PHYS( pxBlock );
+            pxNeighbour->pxPrevPhysBlock = pxBlock;
+            pxNeighbour->xSize |= heapBLOCK_PREV_FREE_BIT;
+
+            prvInsertFreeBlock( pxBlock );
+            xNumberOfSuccessfulFrees++;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+    return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+    return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+    /* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void ) /* PRIVILEGED_FUNCTION */
+{
+    TlsfBlock_t * pxFirstBlock, * pxEndBlock;
+    uint8_t * pucAlignedHeap;
+    size_t uxAddress;
+    size_t xHeapSize = configTOTAL_HEAP_SIZE;
+
+    /* Ensure the heap starts on a correctly aligned boundary. */
+    uxAddress = ( size_t ) ucHeap;
+
+    if( ( uxAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+    {
+        uxAddress += ( portBYTE_ALIGNMENT - 1 );
+        uxAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+        xHeapSize -= uxAddress - ( size_t ) ucHeap;
+    }
+
+    xHeapSize &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+    pucAlignedHeap = ( uint8_t * ) uxAddress;
+
+    #if ( configHEAP_TLSF_POOL_COUNT > 0 )
+        {
+            BaseType_t xPool;
+            size_t xBlock, xPoolBlockSize;
+
+            /* The pools are carved from the start of the heap. */
+            for( xPool = 0; xPool < configHEAP_TLSF_POOL_COUNT; xPool++ )
+            {
+                configASSERT( ( xPool == 0 ) || ( xPoolBlockSizes[ xPool ] > xPoolBlockSizes[ xPool - 1 ] ) );
+
+                xPoolBlockSize = ( xPoolBlockSizes[ xPool ] + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+                configASSERT( ( xPoolBlockSize * xPoolBlockCounts[ xPool ] ) < xHeapSize );
+
+                pucPoolStart[ xPool ] = pucAlignedHeap;
+                pxPoolFreeList[ xPool ] = NULL;
+
+                for( xBlock = xPoolBlockCounts[ xPool ]; xBlock > 0; xBlock-- )
+                {
+                    PoolBlock_t * pxPoolBlock = ( PoolBlock_t * ) ( pucAlignedHeap + ( ( xBlock - 1 ) * xPoolBlockSize ) );
+
+                    pxPoolBlock->pxNext = pxPoolFreeList[ xPool ];
+                    pxPoolFreeList[ xPool ] = pxPoolBlock;
+                }
+
+                pucAlignedHeap += xPoolBlockSize * xPoolBlockCounts[ xPool ];
+                xHeapSize -= xPoolBlockSize * xPoolBlockCounts[ xPool ];
+                pucPoolEnd[ xPool ] = pucAlignedHeap;
+                xPoolFreeBlocks[ xPool ] = xPoolBlockCounts[ xPool ];
+                xPoolMinimumEverFreeBlocks[ xPool ] = xPoolBlockCounts[ xPool ];
+                xPoolMissCount[ xPool ] = 0;
+            }
+        }
+    #endif /* configHEAP_TLSF_POOL_COUNT */
+
+    configASSERT( xHeapSize < heapBLOCK_SIZE_MAX );
+
+    /* One free block covering the heap, followed by a zero sized allocated
+     * block that stops the merging at the end of the heap. */
+    pxFirstBlock = ( TlsfBlock_t * ) pucAlignedHeap;
+    pxFirstBlock->pxPrevPhysBlock = NULL;
+    pxFirstBlock->xSize = ( xHeapSize - ( 2 * heapHEADER_SIZE ) ) | heapBLOCK_FREE_BIT;
+
+    pxEndBlock = heapBLOCK_NEXT_PHYS( pxFirstBlock );
+    pxEndBlock->pxPrevPhysBlock = pxFirstBlock;
+    pxEndBlock->xSize = heapBLOCK_PREV_FREE_BIT;
+
+    xTotalHeapSize = heapBLOCK_SIZE( pxFirstBlock );
+    prvInsertFreeBlock( pxFirstBlock );
+    xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+
+    xHeapInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t * pxHeapStats )
+{
+    TlsfBlock_t * pxBlock;
+    size_t xMaxSize = 0, xMinSize = 0;
+    int xFl, xSl;
+
+    vTaskSuspendAll();
+    {
+        /* The largest free block is in the highest non-empty class and the
+         * smallest in the lowest, so only those two lists are walked. */
+        if( ulFlBitmap != 0 )
+        {
+            xFl = prvFls( ulFlBitmap );
+            xSl = prvFls( ulSlBitmap[ xFl ] );
+
+            for( pxBlock = pxFreeLists[ xFl ][ xSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+            {
+                if( heapBLOCK_SIZE( pxBlock ) > xMaxSize )
+                {
+                    xMaxSize = heapBLOCK_SIZE( pxBlock );
+                }
+            }
+
+            xFl = prvFfs( ulFlBitmap );
+            xSl = prvFfs( ulSlBitmap[ xFl ] );
+            xMinSize = heapBLOCK_SIZE( pxFreeLists[ xFl ][ xSl ] );
+
+            for( pxBlock = pxFreeLists[ xFl ][ xSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+            {
+                if( heapBLOCK_SIZE( pxBlock ) < xMinSize )
+                {
+                    xMinSize = heapBLOCK_SIZE( pxBlock );
+                }
+            }
+        }
+
+        pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+        pxHeapStats->xSizeOfSmallestFreeBlockInBytes = xMinSize;
+        pxHeapStats->xNumberOfFreeBlocks = xNumberOfFreeBlocks;
+    }
+    ( void ) xTaskResumeAll();
+
+    taskENTER_CRITICAL();
+    {
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetTlsfHeapStats( TlsfHeapStats_t * pxHeapStats )
+{
+    HeapStats_t xHeapStats;
+    int xBin;
+
+    vPortGetHeapStats( &xHeapStats );
+
+    vTaskSuspendAll();
+    {
+        pxHeapStats->xTotalHeapSize = xTotalHeapSize;
+        pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+        pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+        pxHeapStats->xPeakUsedBytes = xTotalHeapSize - xMinimumEverFreeBytesRemaining;
+        pxHeapStats->xSizeOfLargestFreeBlockInBytes = xHeapStats.xSizeOfLargestFreeBlockInBytes;
+        pxHeapStats->xNumberOfFreeBlocks = xNumberOfFreeBlocks;
+        pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+        pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+        pxHeapStats->xNumberOfFailedAllocations = xNumberOfFailedAllocations;
+        pxHeapStats->ulMaxAllocationTime = ulMaxAllocationTime;
+
+        for( xBin = 0; xBin < heapTLSF_LATENCY_BINS; xBin++ )
+        {
+            pxHeapStats->ulAllocationTimeHistogram[ xBin ] = ulAllocationTimeHistogram[ xBin ];
+        }
+
+        #if ( configHEAP_TLSF_POOL_COUNT > 0 )
+            {
+                BaseType_t xPool;
+
+                for( xPool = 0; xPool < configHEAP_TLSF_POOL_COUNT; xPool++ )
+                {
+                    pxHeapStats->xPoolStats[ xPool ].xBlockSize = xPoolBlockSizes[ xPool ];
+                    pxHeapStats->xPoolStats[ xPool ].xBlockCount = xPoolBlockCounts[ xPool ];
+                    pxHeapStats->xPoolStats[ xPool ].xFreeBlocks = xPoolFreeBlocks[ xPool ];
+                    pxHeapStats->xPoolStats[ xPool ].xMinimumEverFreeBlocks = xPoolMinimumEverFreeBlocks[ xPool ];
+                    pxHeapStats->xPoolStats[ xPool ].xMissCount = xPoolMissCount[ xPool ];
+                }
+            }
+        #endif /* configHEAP_TLSF_POOL_COUNT */
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortResetTlsfLatencyStats( void )
+{
+    int xBin;
+
+    vTaskSuspendAll();
+    {
+        for( xBin = 0; xBin < heapTLSF_LATENCY_BINS; xBin++ )
+        {
+            ulAllocationTimeHistogram[ xBin ] = 0;
+        }
+
+        ulMaxAllocationTime = 0;
+    }
+    ( void ) xTaskResumeAll();
+}
@@ -0,0 +1,101 @@
+/*
+ * FreeRTOS Kernel V10.4.3
+ * Copyright (C) 2020 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * https://www.FreeRTOS.org
+ * https://github.com/FreeRTOS
+ *
+ */
+
+#ifndef HEAP_TLSF_H
+#define HEAP_TLSF_H
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+/*
+ * Fixed-block pools served ahead of the TLSF heap.  Requests up to the block
+ * size of a pool are taken from the smallest pool that still has a free block.
+ * The pool storage is carved from configTOTAL_HEAP_SIZE.  Define
+ * configHEAP_TLSF_POOL_COUNT to 0 to disable the pools.
+ */
+#ifndef configHEAP_TLSF_POOL_COUNT
+    #define configHEAP_TLSF_POOL_COUNT          3
+    #define configHEAP_TLSF_POOL_BLOCK_SIZES    { 16, 32, 64 }
+    #define configHEAP_TLSF_POOL_BLOCK_COUNTS   { 16, 8, 4 }
+#endif
+
+/*
+ * Allocation latency is recorded in a log2 histogram when the application
+ * provides a free running counter, for example:
+ * #define configHEAP_TLSF_TIMESTAMP()    ( DWT->CYCCNT )
+ */
+#define heapTLSF_LATENCY_BINS    16
+
+/* Statistics of one fixed-block pool. */
+typedef struct xTLSF_POOL_STATS
+{
+    size_t xBlockSize;                 /* Size of each block in the pool. */
+    size_t xBlockCount;                /* Number of blocks in the pool. */
+    size_t xFreeBlocks;                /* Blocks currently free. */
+    size_t xMinimumEverFreeBlocks;     /* Lowest number of free blocks since start. */
+    size_t xMissCount;                 /* Requests that fitted this pool first but found it empty. */
+} TlsfPoolStats_t;
+
+/* Statistics of the whole heap, returned by vPortGetTlsfHeapStats(). */
+typedef struct xTLSF_HEAP_STATS
+{
+    size_t xTotalHeapSize;             /* Bytes managed by the TLSF heap (pools excluded). */
+    size_t xAvailableHeapSpaceInBytes; /* Free bytes in the TLSF heap. */
+    size_t xMinimumEverFreeBytesRemaining;
+    size_t xPeakUsedBytes;             /* Highest number of bytes in use since start. */
+    size_t xSizeOfLargestFreeBlockInBytes;
+    size_t xNumberOfFreeBlocks;
+    size_t xNumberOfSuccessfulAllocations;
+    size_t xNumberOfSuccessfulFrees;
+    size_t xNumberOfFailedAllocations;
+    uint32_t ulMaxAllocationTime;      /* Longest allocation in configHEAP_TLSF_TIMESTAMP() counts. */
+    uint32_t ulAllocationTimeHistogram[ heapTLSF_LATENCY_BINS ]; /* Bin n counts allocations taking [2^(n-1), 2^n) counts. */
+    #if ( configHEAP_TLSF_POOL_COUNT > 0 )
+        TlsfPoolStats_t xPoolStats[ configHEAP_TLSF_POOL_COUNT ];
+    #endif
+} TlsfHeapStats_t;
+
+/*
+ * Returns the extended statistics of heap_tlsf.c.  Only the free lists of the
+ * largest and smallest non-empty size classes are walked.
+ */
+void vPortGetTlsfHeapStats( TlsfHeapStats_t * pxHeapStats );
+
+/*
+ * Clears the allocation latency histogram and the maximum allocation time.
+ */
+void vPortResetTlsfLatencyStats( void );
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* HEAP_TLSF_H */
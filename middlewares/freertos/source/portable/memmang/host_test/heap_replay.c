@@ -0,0 +1,430 @@
+/**
+  **************************************************************************
+  * @file     heap_replay.c
+  * @brief    trace replay benchmark of heap_tlsf against heap_4
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * replays the same allocation traces on heap_4 and heap_tlsf, both built
+ * with the configTOTAL_HEAP_SIZE of the freertos demo, and reports for each
+ * - failed allocations, and those that failed although the free bytes
+ *   covered the request: the cost of fragmentation
+ * - the fragmentation itself, 1 - largest free block / free bytes, sampled
+ *   along the trace
+ * - mean, 99th percentile and worst time of malloc and free
+ * the traces are synthetic, modelled on the allocation patterns of the demo
+ * projects: usb and fatfs sector and packet buffers, rtos messages and a
+ * few long-lived task stacks, and a log-uniform churn that stresses the
+ * fragmentation, and a checkerboard of small holes that a first fit list
+ * has to walk before it fails. each trace ends with every block freed, the heap must then
+ * be whole again and the contents of every block intact.
+ * the times are host times, only their relation between the allocators
+ * means something. each trace runs several times and an operation keeps its
+ * fastest run, so a host interrupt does not show up as a worst case.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TRACE_OPS                        200000
+#define TRACE_SLOTS                      256
+#define CHECKER_SMALL                    200
+#define CHECKER_LARGE                    16
+#define TRACE_RUNS                       5
+#define SAMPLE_PERIOD                    64
+#define DEMO_BLOCKS                      11
+
+typedef struct
+{
+  uint16_t slot;
+  uint16_t size;                         /* 0 frees the slot */
+} trace_op_type;
+
+typedef struct
+{
+  const char *name;
+  void *(*alloc)(size_t size);
+  void (*release)(void *pv);
+  void (*stats_get)(HeapStats_t *stats);
+} heap_type;
+
+typedef struct
+{
+  uint32_t mallocs, fails, frag_fails, samples;
+  double frag_sum, frag_max;
+  double malloc_mean, malloc_p99, malloc_max;
+  double free_mean, free_p99, free_max;
+} result_type;
+
+void *heap_4_malloc(size_t size);
+void heap_4_free(void *pv);
+void heap_4_stats_get(HeapStats_t *stats);
+void *heap_tlsf_malloc(size_t size);
+void heap_tlsf_free(void *pv);
+void heap_tlsf_stats_get(HeapStats_t *stats);
+
+static const heap_type heaps[] =
+{
+  {"heap_4",    heap_4_malloc,    heap_4_free,    heap_4_stats_get},
+  {"heap_tlsf", heap_tlsf_malloc, heap_tlsf_free, heap_tlsf_stats_get},
+};
+
+static trace_op_type trace[TRACE_OPS];
+static uint32_t trace_count;
+static uint32_t op_time[TRACE_OPS];
+static uint32_t sort_buf[TRACE_OPS];
+static void *slot_ptr[TRACE_SLOTS];
+static uint16_t slot_size[TRACE_SLOTS];
+static uint32_t rand_state;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* the allocators run with the scheduler suspended or in a critical section,
+   on the host there is a single thread */
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+  return pdFALSE;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+uint32_t system_core_clock;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static uint32_t ns_get(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+/* usb mass storage and fatfs: 512 byte sector buffers and 64 byte packet
+   buffers that live for a transfer, two task stacks and tcbs for good */
+static uint16_t usb_size_get(uint32_t slot)
+{
+  if(slot < 4)
+  {
+    return (slot & 1) ? 92 : 1024;
+  }
+  return ((rand_get() % 4) == 0) ? 512 : 64;
+}
+
+/* rtos messages of 16 to 48 bytes with the odd queue or timer */
+static uint16_t message_size_get(uint32_t slot)
+{
+  if((rand_get() % 16) == 0)
+  {
+    return (uint16_t)(80 + rand_get() % 160);
+  }
+  return (uint16_t)(16 + rand_get() % 33);
+}
+
+/* sizes spread evenly over 4 to 1024 bytes in log scale */
+static uint16_t churn_size_get(uint32_t slot)
+{
+  uint32_t base = 4u << (rand_get() % 8);
+
+  return (uint16_t)(base + rand_get() % base);
+}
+
+/* a trace frees a random slot that holds a block, or fills an empty one. the
+   slots 0..3 are filled first and freed last, the usb trace keeps its task
+   stacks there */
+static void trace_build(uint16_t (*size_get)(uint32_t slot), uint32_t slots, uint32_t seed)
+{
+  uint8_t used[TRACE_SLOTS] = {0};
+  uint32_t index = 0, slot;
+
+  rand_state = seed;
+  for(slot = 0; slot < 4; slot++)
+  {
+    trace[index].slot = (uint16_t)slot;
+    trace[index].size = size_get(slot);
+    used[slot] = 1;
+    index++;
+  }
+  while(index < TRACE_OPS - slots)
+  {
+    slot = 4 + rand_get() % (slots - 4);
+    trace[index].slot = (uint16_t)slot;
+    trace[index].size = used[slot] ? 0 : size_get(slot);
+    used[slot] ^= 1;
+    index++;
+  }
+  for(slot = 0; slot < slots; slot++)
+  {
+    trace[index].slot = (uint16_t)slot;
+    trace[index].size = 0;
+    index++;
+  }
+  trace_count = index;
+}
+
+/* the worst case of a first fit list: the heap filled with small blocks,
+   every other one freed, then larger requests that no hole fits */
+static void trace_checker_build(void)
+{
+  uint32_t index = 0, slot;
+
+  while(index + 2 * (CHECKER_SMALL + CHECKER_LARGE) <= TRACE_OPS)
+  {
+    for(slot = 0; slot < CHECKER_SMALL; slot++)
+    {
+      trace[index].slot = (uint16_t)slot;
+      trace[index++].size = 24;
+    }
+    for(slot = 1; slot < CHECKER_SMALL; slot += 2)
+    {
+      trace[index].slot = (uint16_t)slot;
+      trace[index++].size = 0;
+    }
+    for(slot = CHECKER_SMALL; slot < CHECKER_SMALL + CHECKER_LARGE; slot++)
+    {
+      trace[index].slot = (uint16_t)slot;
+      trace[index++].size = 128;
+    }
+    for(slot = 0; slot < CHECKER_SMALL + CHECKER_LARGE; slot++)
+    {
+      if(slot >= CHECKER_SMALL || (slot & 1) == 0)
+      {
+        trace[index].slot = (uint16_t)slot;
+        trace[index++].size = 0;
+      }
+    }
+  }
+  trace_count = index;
+}
+
+static int compare(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+/* mean, 99th percentile and worst of the kept times of one kind of op */
+static void time_summary(uint32_t want_free, double *mean, double *p99, double *max)
+{
+  uint32_t index, count = 0;
+  double sum = 0;
+
+  for(index = 0; index < trace_count; index++)
+  {
+    if((trace[index].size == 0) == want_free && op_time[index] != UINT32_MAX)
+    {
+      sort_buf[count++] = op_time[index];
+      sum += op_time[index];
+    }
+  }
+  qsort(sort_buf, count, sizeof(uint32_t), compare);
+  *mean = count ? sum / count : 0;
+  *p99 = count ? sort_buf[(count * 99) / 100] : 0;
+  *max = count ? sort_buf[count - 1] : 0;
+}
+
+static void replay(const heap_type *heap, uint32_t heap_free, result_type *result)
+{
+  HeapStats_t stats;
+  uint32_t run, index, start, elapsed, k;
+  uint16_t slot, size;
+  uint8_t *block;
+  double frag;
+
+  memset(result, 0, sizeof(*result));
+  for(index = 0; index < trace_count; index++)
+  {
+    op_time[index] = UINT32_MAX;
+  }
+
+  for(run = 0; run < TRACE_RUNS; run++)
+  {
+    memset(slot_ptr, 0, sizeof(slot_ptr));
+    for(index = 0; index < trace_count; index++)
+    {
+      slot = trace[index].slot;
+      size = trace[index].size;
+      if(size != 0)
+      {
+        start = ns_get();
+        block = heap->alloc(size);
+        elapsed = ns_get() - start;
+        if(run == 0)
+        {
+          result->mallocs++;
+        }
+        if(block == NULL)
+        {
+          if(run == 0)
+          {
+            heap->stats_get(&stats);
+            result->fails++;
+            if(stats.xAvailableHeapSpaceInBytes >= size)
+            {
+              result->frag_fails++;
+            }
+          }
+        }
+        else
+        {
+          memset(block, (uint8_t)(slot + index), size);
+        }
+        slot_ptr[slot] = block;
+        slot_size[slot] = size;
+        /* a failed malloc takes the same path every run */
+        op_time[index] = (elapsed < op_time[index]) ? elapsed : op_time[index];
+      }
+      else if(slot_ptr[slot] != NULL)
+      {
+        block = slot_ptr[slot];
+        for(k = 1; k < slot_size[slot]; k++)
+        {
+          if(block[k] != block[0])
+          {
+            CHECK(block[k] == block[0]);
+            break;
+          }
+        }
+        start = ns_get();
+        heap->release(block);
+        elapsed = ns_get() - start;
+        slot_ptr[slot] = NULL;
+        op_time[index] = (elapsed < op_time[index]) ? elapsed : op_time[index];
+      }
+
+      if(run == 0 && (index % SAMPLE_PERIOD) == 0)
+      {
+        heap->stats_get(&stats);
+        if(stats.xAvailableHeapSpaceInBytes != 0)
+        {
+          frag = 1.0 - (double)stats.xSizeOfLargestFreeBlockInBytes / stats.xAvailableHeapSpaceInBytes;
+          result->frag_sum += frag;
+          result->frag_max = (frag > result->frag_max) ? frag : result->frag_max;
+          result->samples++;
+        }
+      }
+    }
+
+    /* every block is back, the heap is one free block again */
+    heap->stats_get(&stats);
+    CHECK(stats.xAvailableHeapSpaceInBytes == heap_free);
+    CHECK(stats.xNumberOfFreeBlocks == 1);
+  }
+
+  time_summary(0, &result->malloc_mean, &result->malloc_p99, &result->malloc_max);
+  time_summary(1, &result->free_mean, &result->free_p99, &result->free_max);
+}
+
+int main(void)
+{
+  static const struct
+  {
+    const char *name;
+    uint16_t (*size_get)(uint32_t slot);
+    uint32_t slots;
+  } traces[] =
+  {
+    {"usb/fatfs buffers", usb_size_get,     24},
+    {"rtos messages",     message_size_get, 96},
+    {"log-uniform churn", churn_size_get,   32},
+    {"checkerboard",      NULL,             CHECKER_SMALL + CHECKER_LARGE},
+  };
+  uint32_t heap_free[2], t, h;
+  HeapStats_t stats;
+  static const uint16_t demo_size[DEMO_BLOCKS] =
+  {
+    2048, 2048, 1024, 512, configMINIMAL_STACK_SIZE * 4,
+    128, 128, 128, 128, 128, 128
+  };
+  result_type result;
+  void *block, *demo[DEMO_BLOCKS];
+
+  /* the heaps set themselves up on the first allocation */
+  for(h = 0; h < 2; h++)
+  {
+    block = heaps[h].alloc(8);
+    heaps[h].release(block);
+    heaps[h].stats_get(&stats);
+    heap_free[h] = stats.xAvailableHeapSpaceInBytes;
+  }
+  /* the demo: four task stacks, the idle stack, five tcbs and the serial
+     rx queue fit in heap_tlsf next to its pools */
+  for(h = 0; h < DEMO_BLOCKS; h++)
+  {
+    demo[h] = heaps[1].alloc(demo_size[h]);
+    CHECK(demo[h] != NULL);
+  }
+  for(h = 0; h < DEMO_BLOCKS; h++)
+  {
+    heaps[1].release(demo[h]);
+  }
+
+  printf("configTOTAL_HEAP_SIZE %u, free after init: heap_4 %u, heap_tlsf %u (pools excluded)\n",
+         (unsigned)configTOTAL_HEAP_SIZE, (unsigned)heap_free[0], (unsigned)heap_free[1]);
+
+  for(t = 0; t < sizeof(traces) / sizeof(traces[0]); t++)
+  {
+    if(traces[t].size_get != NULL)
+    {
+      trace_build(traces[t].size_get, traces[t].slots, 1 + t);
+    }
+    else
+    {
+      trace_checker_build();
+    }
+    printf("\n%s, %u ops, %u slots\n", traces[t].name, (unsigned)trace_count, (unsigned)traces[t].slots);
+    printf("  %-9s %8s %6s %9s %10s %8s  %-22s %-22s\n", "", "mallocs", "fails", "frag.fail",
+           "frag mean", "frag max", "malloc ns mean/p99/max", "free ns mean/p99/max");
+    for(h = 0; h < 2; h++)
+    {
+      replay(&heaps[h], heap_free[h], &result);
+      printf("  %-9s %8u %6u %9u %9.1f%% %7.1f%%  %5.0f %5.0f %8.0f   %5.0f %5.0f %8.0f\n",
+             heaps[h].name, (unsigned)result.mallocs, (unsigned)result.fails, (unsigned)result.frag_fails,
+             result.samples ? 100.0 * result.frag_sum / result.samples : 0.0, 100.0 * result.frag_max,
+             result.malloc_mean, result.malloc_p99, result.malloc_max,
+             result.free_mean, result.free_p99, result.free_max);
+    }
+  }
+
+  printf("\n%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
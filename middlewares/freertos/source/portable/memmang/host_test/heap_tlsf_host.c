@@ -0,0 +1,37 @@
+/**
+  **************************************************************************
+  * @file     heap_tlsf_host.c
+  * @brief    heap_tlsf built under its own names for the replay benchmark
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* the replay links both allocators into one program, each one keeps its
+   static heap and exports its functions under a prefix */
+#define pvPortMalloc                     heap_tlsf_malloc
+#define vPortFree                        heap_tlsf_free
+#define xPortGetFreeHeapSize             heap_tlsf_free_size_get
+#define xPortGetMinimumEverFreeHeapSize  heap_tlsf_minimum_free_size_get
+#define vPortInitialiseBlocks            heap_tlsf_blocks_init
+#define vPortGetHeapStats                heap_tlsf_stats_get
+#define vPortGetTlsfHeapStats            heap_tlsf_tlsf_stats_get
+#define vPortResetTlsfLatencyStats       heap_tlsf_latency_stats_reset
+
+#include "../heap_tlsf.c"
@@ -0,0 +1,617 @@
+/**
+  **************************************************************************
+  * @file     freq_meter.c
+  * @brief    frequency and period measurement library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "freq_meter.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_freq_meter_library
+  * @{
+  */
+
+/** @defgroup FREQ_METER_library
+  * @brief frequency and period measurement
+  * @{
+  */
+
+/** @defgroup FREQ_METER_private_definition
+  * @{
+  */
+
+#define FREQ_METER_DMA_CHANNEL_SPACE     0x14
+
+/**
+  * @brief a ring slot already read. the slot before the next read is
+  *        overwritten only when the dma lapped the reader.
+  */
+#define FREQ_METER_CONSUMED              0xFFFFFFFF
+
+/**
+  * @}
+  */
+
+/** @defgroup FREQ_METER_private_functions
+  * @{
+  */
+
+/**
+  * @brief  map a dma channel to a flexible request, the flexible channel
+  *         number is the channel's own.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  request: flexible request
+  * @retval none
+  */
+static void freq_meter_dma_map(dma_channel_type *dma_channel, dma_flexible_request_type request)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    dma_flexible_config(DMA2, (uint8_t)(FLEX_CHANNEL1 + (base - DMA2_CHANNEL1_BASE) / FREQ_METER_DMA_CHANNEL_SPACE), request);
+  }
+  else
+  {
+    dma_flexible_config(DMA1, (uint8_t)(FLEX_CHANNEL1 + (base - DMA1_CHANNEL1_BASE) / FREQ_METER_DMA_CHANNEL_SPACE), request);
+  }
+}
+
+/**
+  * @brief  capture channel to a ring in loop mode.
+  * @param  meter: the engine
+  * @param  channel: capture channel 1..4
+  * @param  dma_channel: dma channel
+  * @param  request: capture request of the channel
+  * @param  ring: ring of ring_size words
+  * @param  ring_size: captures in the ring
+  * @retval none
+  */
+static void freq_meter_ring_init(freq_meter_type *meter, uint8_t channel, dma_channel_type *dma_channel,
+                                 dma_flexible_request_type request, uint32_t *ring, uint16_t ring_size)
+{
+  dma_init_type dma_init_struct;
+  uint16_t index;
+
+  for(index = 0; index < ring_size; index++)
+  {
+    ring[index] = FREQ_METER_CONSUMED;
+  }
+
+  dma_reset(dma_channel);
+  dma_default_para_init(&dma_init_struct);
+  dma_init_struct.buffer_size = ring_size;
+  dma_init_struct.direction = DMA_DIR_PERIPHERAL_TO_MEMORY;
+  dma_init_struct.memory_base_addr = (uint32_t)ring;
+  dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_WORD;
+  dma_init_struct.memory_inc_enable = TRUE;
+  /* c1dt to c4dt are consecutive registers */
+  dma_init_struct.peripheral_base_addr = (uint32_t)(&meter->cfg.tmr->c1dt + (channel - 1));
+  dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_WORD;
+  dma_init_struct.peripheral_inc_enable = FALSE;
+  dma_init_struct.priority = DMA_PRIORITY_HIGH;
+  dma_init_struct.loop_mode_enable = TRUE;
+  dma_init(dma_channel, &dma_init_struct);
+  freq_meter_dma_map(dma_channel, request);
+  dma_channel_enable(dma_channel, TRUE);
+
+  tmr_dma_request_enable(meter->cfg.tmr, (tmr_dma_request_type)(TMR_C1_DMA_REQUEST << (channel - 1)), TRUE);
+}
+
+/**
+  * @brief  ring slot written next by the dma.
+  * @param  dma_channel: dma channel of the ring
+  * @param  ring_size: captures in the ring
+  * @retval slot index
+  */
+static uint16_t freq_meter_write_get(dma_channel_type *dma_channel, uint16_t ring_size)
+{
+  uint16_t write = ring_size - dma_data_number_get(dma_channel);
+
+  return (write >= ring_size) ? 0 : write;
+}
+
+/**
+  * @brief  timestamp of a capture, at most one counter wrap before the poll.
+  * @param  meter: the engine
+  * @param  capture: captured counter value
+  * @retval timestamp in ticks
+  */
+static uint64_t freq_meter_timestamp(freq_meter_type *meter, uint32_t capture)
+{
+  return meter->now - ((meter->now_raw - capture) & meter->mask);
+}
+
+/**
+  * @brief  whether the slot before the next read is still consumed.
+  * @param  ring: ring
+  * @param  ring_size: captures in the ring
+  * @param  read: next slot to read
+  * @retval TRUE when the dma has not lapped the reader
+  */
+static confirm_state freq_meter_ring_intact(const uint32_t *ring, uint16_t ring_size, uint16_t read)
+{
+  return (ring[(read == 0 ? ring_size : read) - 1] == FREQ_METER_CONSUMED) ? TRUE : FALSE;
+}
+
+/**
+  * @brief  restart an input after its ring was overwritten, the batch so far
+  *         is dropped.
+  * @param  input: the input
+  * @param  write: slot written next to the rising ring
+  * @param  fall_write: slot written next to the falling ring
+  * @retval none
+  */
+static void freq_meter_resync(freq_meter_input_type *input, uint16_t write, uint16_t fall_write)
+{
+  uint16_t index;
+
+  for(index = 0; index < input->cfg.ring_size; index++)
+  {
+    input->cfg.ring[index] = FREQ_METER_CONSUMED;
+    if(input->cfg.fall_ring != NULL)
+    {
+      input->cfg.fall_ring[index] = FREQ_METER_CONSUMED;
+    }
+  }
+  input->read = write;
+  input->fall_read = fall_write;
+  input->have_edge = 0;
+  input->high_open = 0;
+  input->count = 0;
+  input->high_sum = 0;
+  input->high_count = 0;
+  input->overrun_count++;
+}
+
+/**
+  * @brief  a rising edge closes an interval.
+  * @param  input: the input
+  * @param  edge: timestamp
+  * @retval none
+  */
+static void freq_meter_rise(freq_meter_input_type *input, uint64_t edge)
+{
+  uint64_t span, magnitude;
+  uint32_t interval;
+  int64_t deviation;
+
+  if(input->have_edge != 0 && edge > input->last_edge)
+  {
+    span = edge - input->last_edge;
+    interval = (span > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)span;
+    if(input->count == 0)
+    {
+      input->first_edge = input->last_edge;
+      input->reference = interval;
+      input->deviation_sum = 0;
+      input->deviation_square_sum = 0;
+      input->interval_min = interval;
+      input->interval_max = interval;
+    }
+    deviation = (int64_t)interval - input->reference;
+    input->deviation_sum += deviation;
+    magnitude = (uint64_t)((deviation < 0) ? -deviation : deviation);
+    input->deviation_square_sum += magnitude * magnitude;
+    if(interval < input->interval_min)
+    {
+      input->interval_min = interval;
+    }
+    if(interval > input->interval_max)
+    {
+      input->interval_max = interval;
+    }
+    input->count++;
+  }
+  input->last_edge = edge;
+  input->have_edge = 1;
+  input->high_open = 1;
+}
+
+/**
+  * @brief  a falling edge ends the high time of the last rising edge. a fall
+  *         older than that edge belongs to a pulse already given up.
+  * @param  input: the input
+  * @param  edge: timestamp
+  * @retval none
+  */
+static void freq_meter_fall(freq_meter_input_type *input, uint64_t edge)
+{
+  if(input->high_open != 0 && edge > input->last_edge)
+  {
+    input->high_sum += edge - input->last_edge;
+    input->high_count++;
+    input->high_open = 0;
+  }
+}
+
+/**
+  * @brief  read the new captures of an input in time order.
+  * @param  meter: the engine
+  * @param  input: the input
+  * @param  write: slot written next to the rising ring
+  * @param  fall_write: slot written next to the falling ring
+  * @retval none
+  */
+static void freq_meter_input_poll(freq_meter_type *meter, freq_meter_input_type *input, uint16_t write, uint16_t fall_write)
+{
+  uint32_t *ring = input->cfg.ring, *fall_ring = input->cfg.fall_ring;
+  uint16_t size = input->cfg.ring_size, read = input->read, fall_read = input->fall_read;
+  uint64_t rise, fall;
+
+  if(freq_meter_ring_intact(ring, size, read) == FALSE ||
+     (fall_ring != NULL && freq_meter_ring_intact(fall_ring, size, fall_read) == FALSE))
+  {
+    freq_meter_resync(input, write, fall_write);
+    return;
+  }
+
+  while(input->read != write || (fall_ring != NULL && input->fall_read != fall_write))
+  {
+    rise = (input->read != write) ? freq_meter_timestamp(meter, ring[input->read]) : UINT64_MAX;
+    fall = (fall_ring != NULL && input->fall_read != fall_write) ? freq_meter_timestamp(meter, fall_ring[input->fall_read]) : UINT64_MAX;
+    if(rise <= fall)
+    {
+      ring[input->read] = FREQ_METER_CONSUMED;
+      input->read = (input->read + 1 == size) ? 0 : input->read + 1;
+      freq_meter_rise(input, rise);
+    }
+    else
+    {
+      fall_ring[input->fall_read] = FREQ_METER_CONSUMED;
+      input->fall_read = (input->fall_read + 1 == size) ? 0 : input->fall_read + 1;
+      freq_meter_fall(input, fall);
+    }
+  }
+
+  /* lapped while being read */
+  if(freq_meter_ring_intact(ring, size, read) == FALSE ||
+     (fall_ring != NULL && freq_meter_ring_intact(fall_ring, size, fall_read) == FALSE))
+  {
+    freq_meter_resync(input, write, fall_write);
+  }
+}
+
+/**
+  * @brief  integer square root.
+  * @param  value: radicand
+  * @retval floor of the root
+  */
+static uint32_t freq_meter_sqrt(uint64_t value)
+{
+  uint64_t root = 0, bit = (uint64_t)1 << 62;
+
+  while(bit > value)
+  {
+    bit >>= 2;
+  }
+  while(bit != 0)
+  {
+    if(value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+/**
+  * @brief  close the batch of an input into its result.
+  * @param  meter: the engine
+  * @param  input: the input
+  * @param  span: ticks of the gate
+  * @retval none
+  */
+static void freq_meter_input_close(freq_meter_type *meter, freq_meter_input_type *input, uint64_t span)
+{
+  freq_meter_result_type *result = &input->result;
+  uint64_t variance, magnitude;
+  uint32_t periods;
+
+  if(input->cfg.mode == FREQ_METER_MODE_GATED)
+  {
+    result->intervals = input->count;
+    result->frequency = ((uint64_t)input->count * meter->cfg.tick_freq * 1000 + span / 2) / span;
+    result->span = span;
+    result->sequence = meter->sequence;
+    input->count = 0;
+    return;
+  }
+
+  if(input->count == 0)
+  {
+    /* a slow signal: the batch goes on until a whole interval is seen */
+    if(++input->idle_gates >= FREQ_METER_TIMEOUT_GATES)
+    {
+      input->idle_gates = 0;
+      result->intervals = 0;
+      result->frequency = 0;
+      result->duty = 0;
+      result->span = span * FREQ_METER_TIMEOUT_GATES;
+      result->sequence = meter->sequence;
+    }
+    return;
+  }
+
+  periods = (input->cfg.mode == FREQ_METER_MODE_PERIOD) ? (1 << input->cfg.divider) : 1;
+  result->span = input->last_edge - input->first_edge;
+  result->intervals = input->count;
+  result->frequency = ((uint64_t)input->count * periods * meter->cfg.tick_freq * 1000 + result->span / 2) / result->span;
+  result->interval_mean = (uint32_t)(result->span / input->count);
+  result->interval_min = input->interval_min;
+  result->interval_max = input->interval_max;
+  magnitude = (uint64_t)((input->deviation_sum < 0) ? -input->deviation_sum : input->deviation_sum);
+  variance = (input->deviation_square_sum * 256 - magnitude * magnitude * 256 / input->count) / input->count;
+  result->jitter_rms = freq_meter_sqrt(variance);
+  result->duty = 0;
+  if(input->cfg.mode == FREQ_METER_MODE_DUTY && input->high_count != 0 && result->interval_mean != 0)
+  {
+    variance = input->high_sum * 10000 / ((uint64_t)input->high_count * result->interval_mean);
+    result->duty = (uint16_t)((variance > 10000) ? 10000 : variance);
+  }
+  result->sequence = meter->sequence;
+
+  input->count = 0;
+  input->high_sum = 0;
+  input->high_count = 0;
+  input->idle_gates = 0;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup FREQ_METER_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  set up the time base, inputs are added with freq_meter_input_add
+  *         and the counter started with freq_meter_start.
+  * @param  meter: the engine
+  * @param  cfg: configuration
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status freq_meter_init(freq_meter_type *meter, const freq_meter_config_type *cfg)
+{
+  if((cfg->counter_bits != 16 && cfg->counter_bits != 32) || cfg->tick_freq == 0 || cfg->gate_ticks == 0)
+  {
+    return ERROR;
+  }
+
+  meter->cfg = *cfg;
+  meter->input_count = 0;
+  meter->mask = (cfg->counter_bits == 32) ? 0xFFFFFFFF : 0xFFFF;
+  meter->now_raw = 0;
+  meter->now = 0;
+  meter->gate_start = 0;
+  meter->sequence = 0;
+
+  if(cfg->counter_bits == 32)
+  {
+    tmr_32_bit_function_enable(cfg->tmr, TRUE);
+  }
+  tmr_base_init(cfg->tmr, meter->mask, cfg->div);
+  tmr_cnt_dir_set(cfg->tmr, TMR_COUNT_UP);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  add an input: capture channels and their rings, or the counting
+  *         timer of a gated input.
+  * @param  meter: the engine
+  * @param  input: input configuration
+  * @retval SUCCESS or ERROR on a bad configuration or too many inputs
+  */
+error_status freq_meter_input_add(freq_meter_type *meter, const freq_meter_input_config_type *input)
+{
+  freq_meter_input_type *in;
+  tmr_input_config_type input_struct;
+
+  if(meter->input_count >= FREQ_METER_INPUT_MAX)
+  {
+    return ERROR;
+  }
+  if(input->mode == FREQ_METER_MODE_GATED)
+  {
+    if(input->count_tmr == NULL)
+    {
+      return ERROR;
+    }
+  }
+  else if(input->ring == NULL || input->ring_size < 2 || input->channel < 1 || input->channel > 4 ||
+          (input->mode == FREQ_METER_MODE_DUTY && ((input->channel & 1) == 0 || input->fall_ring == NULL)))
+  {
+    return ERROR;
+  }
+
+  in = &meter->input[meter->input_count];
+  in->cfg = *input;
+  in->read = 0;
+  in->fall_read = 0;
+  in->have_edge = 0;
+  in->high_open = 0;
+  in->idle_gates = 0;
+  in->count = 0;
+  in->high_sum = 0;
+  in->high_count = 0;
+  in->overrun_count = 0;
+  in->result.sequence = 0;
+  in->result.intervals = 0;
+  in->result.frequency = 0;
+  in->result.duty = 0;
+  in->result.interval_mean = 0;
+  in->result.interval_min = 0;
+  in->result.interval_max = 0;
+  in->result.jitter_rms = 0;
+  in->result.span = 0;
+
+  if(input->mode == FREQ_METER_MODE_GATED)
+  {
+    in->cfg.ring = NULL;
+    in->cfg.fall_ring = NULL;
+    in->last_count = (uint16_t)input->count_tmr->cval;
+  }
+  else
+  {
+    /* channel n is select 2 * (n - 1) */
+    tmr_input_default_para_init(&input_struct);
+    input_struct.input_channel_select = (tmr_channel_select_type)(TMR_SELECT_CHANNEL_1 + 2 * (input->channel - 1));
+    input_struct.input_polarity_select = TMR_INPUT_RISING_EDGE;
+    input_struct.input_mapped_select = TMR_CC_CHANNEL_MAPPED_DIRECT;
+    input_struct.input_filter_value = input->filter;
+    tmr_input_channel_init(meter->cfg.tmr, &input_struct,
+                           (input->mode == FREQ_METER_MODE_PERIOD) ? input->divider : TMR_CHANNEL_INPUT_DIV_1);
+    freq_meter_ring_init(meter, input->channel, input->dma_channel, input->request, input->ring, input->ring_size);
+
+    if(input->mode == FREQ_METER_MODE_DUTY)
+    {
+      /* the next channel watches the same pin for the falling edges */
+      input_struct.input_channel_select = (tmr_channel_select_type)(TMR_SELECT_CHANNEL_1 + 2 * input->channel);
+      input_struct.input_polarity_select = TMR_INPUT_FALLING_EDGE;
+      input_struct.input_mapped_select = TMR_CC_CHANNEL_MAPPED_INDIRECT;
+      tmr_input_channel_init(meter->cfg.tmr, &input_struct, TMR_CHANNEL_INPUT_DIV_1);
+      freq_meter_ring_init(meter, input->channel + 1, input->fall_dma_channel, input->fall_request,
+                           input->fall_ring, input->ring_size);
+    }
+    else
+    {
+      in->cfg.fall_ring = NULL;
+    }
+  }
+
+  meter->input_count++;
+  return SUCCESS;
+}
+
+/**
+  * @brief  start the time base, the first batch begins.
+  * @param  meter: the engine
+  * @retval none
+  */
+void freq_meter_start(freq_meter_type *meter)
+{
+  tmr_counter_value_set(meter->cfg.tmr, 0);
+  meter->now_raw = 0;
+  meter->now = 0;
+  meter->gate_start = 0;
+  tmr_counter_enable(meter->cfg.tmr, TRUE);
+}
+
+/**
+  * @brief  read the new captures of every input and close the batch when the
+  *         gate is over. call it from one context, at least once per counter
+  *         wrap and before any ring fills up.
+  * @param  meter: the engine
+  * @retval SET when a batch was closed and new results are out
+  */
+flag_status freq_meter_poll(freq_meter_type *meter)
+{
+  uint16_t write[FREQ_METER_INPUT_MAX], fall_write[FREQ_METER_INPUT_MAX];
+  freq_meter_input_type *input;
+  uint32_t raw;
+  uint64_t span;
+  uint16_t count;
+  uint8_t index;
+
+  /* ring positions before the counter, every capture read is older than it.
+     the falling ring first, a fall missed now pairs with its rise next time */
+  for(index = 0; index < meter->input_count; index++)
+  {
+    input = &meter->input[index];
+    if(input->cfg.fall_ring != NULL)
+    {
+      fall_write[index] = freq_meter_write_get(input->cfg.fall_dma_channel, input->cfg.ring_size);
+    }
+    if(input->cfg.ring != NULL)
+    {
+      write[index] = freq_meter_write_get(input->cfg.dma_channel, input->cfg.ring_size);
+    }
+  }
+  raw = meter->cfg.tmr->cval & meter->mask;
+  meter->now += (raw - meter->now_raw) & meter->mask;
+  meter->now_raw = raw;
+
+  for(index = 0; index < meter->input_count; index++)
+  {
+    input = &meter->input[index];
+    if(input->cfg.ring != NULL)
+    {
+      freq_meter_input_poll(meter, input, write[index], (input->cfg.fall_ring != NULL) ? fall_write[index] : 0);
+    }
+    else
+    {
+      count = (uint16_t)input->cfg.count_tmr->cval;
+      input->count += (uint16_t)(count - input->last_count);
+      input->last_count = count;
+    }
+  }
+
+  span = meter->now - meter->gate_start;
+  if(span < meter->cfg.gate_ticks)
+  {
+    return RESET;
+  }
+  meter->sequence++;
+  for(index = 0; index < meter->input_count; index++)
+  {
+    freq_meter_input_close(meter, &meter->input[index], span);
+  }
+  meter->gate_start = meter->now;
+  return SET;
+}
+
+/**
+  * @brief  copy the last result of an input.
+  * @param  meter: the engine
+  * @param  input: input index in the order added
+  * @param  result: the copy
+  * @retval none
+  */
+void freq_meter_result_get(freq_meter_type *meter, uint8_t input, freq_meter_result_type *result)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  *result = meter->input[input].result;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,202 @@
+/**
+  **************************************************************************
+  * @file     freq_meter.h
+  * @brief    frequency and period measurement library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FREQ_METER_H
+#define __FREQ_METER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_freq_meter_library
+  * @{
+  */
+
+/** @defgroup FREQ_METER_library_definition
+  * @{
+  */
+
+/**
+  * @brief one free running timer is the time base of every input. its
+  *        capture channels write each edge through a dma channel in loop mode
+  *        into a ring, nothing interrupts per edge. freq_meter_poll reads the
+  *        rings, extends the captures to 64-bit timestamps against the counter
+  *        and closes a batch every gate. it must run at least once per counter
+  *        wrap and before a ring fills up.
+  */
+#ifndef FREQ_METER_INPUT_MAX
+#define FREQ_METER_INPUT_MAX             4
+#endif
+
+/**
+  * @brief gates without a whole period before a reciprocal input reports 0 hz
+  */
+#ifndef FREQ_METER_TIMEOUT_GATES
+#define FREQ_METER_TIMEOUT_GATES         8
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup FREQ_METER_library_handler
+  * @{
+  */
+
+/**
+  * @brief measurement method of an input
+  */
+typedef enum
+{
+  FREQ_METER_MODE_PERIOD                 = 0x00, /*!< reciprocal: rising edges captured on one channel */
+  FREQ_METER_MODE_DUTY                   = 0x01, /*!< reciprocal: channel pair 1/2 or 3/4 on one pin, rising and falling */
+  FREQ_METER_MODE_GATED                  = 0x02  /*!< edges counted by a timer clocked by the signal */
+} freq_meter_mode_type;
+
+/**
+  * @brief an input. reciprocal inputs measure the time of whole periods and
+  *        suit low and middle frequencies, the input divider makes every
+  *        capture span 2, 4 or 8 periods. gated inputs count edges during the
+  *        gate and suit frequencies too fast to capture, the counting timer
+  *        is set to external clock by the caller and must not wrap between
+  *        two polls.
+  */
+typedef struct
+{
+  freq_meter_mode_type                   mode;                    /*!< measurement method              */
+  uint8_t                                channel;                 /*!< capture channel 1..4, 1 or 3 for duty */
+  tmr_channel_input_divider_type         divider;                 /*!< periods per capture, period mode */
+  uint8_t                                filter;                  /*!< input filter                    */
+  dma_channel_type                       *dma_channel;            /*!< dma of the rising edges         */
+  dma_flexible_request_type              request;                 /*!< capture request of the channel  */
+  uint32_t                               *ring;                   /*!< rising edge captures            */
+  dma_channel_type                       *fall_dma_channel;       /*!< dma of the falling edges, duty  */
+  dma_flexible_request_type              fall_request;            /*!< capture request of channel + 1  */
+  uint32_t                               *fall_ring;              /*!< falling edge captures, duty     */
+  uint16_t                               ring_size;               /*!< captures in each ring           */
+  tmr_type                               *count_tmr;              /*!< counting timer, gated mode      */
+} freq_meter_input_config_type;
+
+/**
+  * @brief configuration
+  */
+typedef struct
+{
+  tmr_type                               *tmr;                    /*!< time base and capture timer     */
+  uint16_t                               div;                     /*!< time base divider register      */
+  uint8_t                                counter_bits;            /*!< 16, or 32 for TMR2 and TMR5     */
+  uint32_t                               tick_freq;               /*!< time base count rate in hz      */
+  uint32_t                               gate_ticks;              /*!< batch length in ticks           */
+} freq_meter_config_type;
+
+/**
+  * @brief result of a batch. an interval is the time of one capture to the
+  *        next, divider periods of the signal.
+  */
+typedef struct
+{
+  uint32_t                               sequence;                /*!< batch number, changes when new  */
+  uint32_t                               intervals;               /*!< intervals or gated edges        */
+  uint64_t                               frequency;               /*!< frequency in millihertz         */
+  uint16_t                               duty;                    /*!< high time in 0.01 %, duty mode  */
+  uint32_t                               interval_mean;           /*!< mean interval in ticks          */
+  uint32_t                               interval_min;            /*!< shortest interval in ticks      */
+  uint32_t                               interval_max;            /*!< longest interval in ticks       */
+  uint32_t                               jitter_rms;              /*!< interval deviation, ticks / 16  */
+  uint64_t                               span;                    /*!< ticks the result covers         */
+} freq_meter_result_type;
+
+/**
+  * @brief state of an input
+  */
+typedef struct
+{
+  freq_meter_input_config_type           cfg;                     /*!< configuration                   */
+  uint16_t                               read;                    /*!< next rising capture             */
+  uint16_t                               fall_read;               /*!< next falling capture            */
+  uint8_t                                have_edge;               /*!< last_edge is valid              */
+  uint8_t                                high_open;               /*!< rising edge waits for its fall  */
+  uint8_t                                idle_gates;              /*!< gates without a whole interval  */
+  uint64_t                               last_edge;               /*!< timestamp of the last rising edge */
+  uint64_t                               first_edge;              /*!< first rising edge of the batch  */
+  uint32_t                               count;                   /*!< intervals or edges of the batch */
+  uint32_t                               reference;               /*!< first interval of the batch     */
+  int64_t                                deviation_sum;           /*!< sum of interval - reference     */
+  uint64_t                               deviation_square_sum;    /*!< sum of its squares              */
+  uint32_t                               interval_min;            /*!< shortest interval of the batch  */
+  uint32_t                               interval_max;            /*!< longest interval of the batch   */
+  uint64_t                               high_sum;                /*!< high time of the batch          */
+  uint32_t                               high_count;              /*!< high times of the batch         */
+  uint16_t                               last_count;              /*!< counting timer at the last poll */
+  freq_meter_result_type                 result;                  /*!< last closed batch               */
+  __IO uint32_t                          overrun_count;           /*!< rings found overwritten         */
+} freq_meter_input_type;
+
+/**
+  * @brief measurement engine
+  */
+typedef struct
+{
+  freq_meter_config_type                 cfg;                     /*!< configuration                   */
+  freq_meter_input_type                  input[FREQ_METER_INPUT_MAX]; /*!< inputs                      */
+  uint8_t                                input_count;             /*!< inputs in use                   */
+  uint32_t                               mask;                    /*!< counter range                   */
+  uint32_t                               now_raw;                 /*!< counter at the last poll        */
+  uint64_t                               now;                     /*!< timestamp of the last poll      */
+  uint64_t                               gate_start;              /*!< timestamp the batch began       */
+  uint32_t                               sequence;                /*!< batches closed                  */
+} freq_meter_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup FREQ_METER_library_exported_functions
+  * @{
+  */
+
+error_status      freq_meter_init               (freq_meter_type *meter, const freq_meter_config_type *cfg);
+error_status      freq_meter_input_add          (freq_meter_type *meter, const freq_meter_input_config_type *input);
+void              freq_meter_start              (freq_meter_type *meter);
+flag_status       freq_meter_poll               (freq_meter_type *meter);
+void              freq_meter_result_get         (freq_meter_type *meter, uint8_t input, freq_meter_result_type *result);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
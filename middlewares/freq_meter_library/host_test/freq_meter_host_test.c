@@ -0,0 +1,424 @@
+/**
+  **************************************************************************
+  * @file     freq_meter_host_test.c
+  * @brief    host model of the capture frequency meter
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs freq_meter against a model of the time base timer, its capture dma
+ * channels in loop mode and a counting timer. signals are edge times in
+ * ticks with a duty and gaussian jitter, each capture writes the counter,
+ * masked to the counter width, to the ring of its channel. the poll runs
+ * at random times.
+ * 32-bit time base, four inputs: a 1 khz period input, a 12.345 khz duty
+ * input with 5 ticks of jitter, a 5 mhz gated input and a 200 khz input
+ * with the divider of 8, every batch against the signal; a stalled poll
+ * overruns the duty rings and the input recovers. the channel pair and
+ * the input count are checked. 16-bit time base: a 3 hz input over many
+ * counter wraps, then 0 hz once the signal stops.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "freq_meter.h"
+
+#define NO_EDGE                          1e300
+#define PI                               3.14159265358979
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* a dma channel of the model */
+typedef struct
+{
+  dma_channel_type *channel;
+  uint32_t *ring;
+  uint16_t size, count;
+} dma_model_type;
+
+/* a signal: next edges in ticks */
+typedef struct
+{
+  double period, duty, jitter, rise, fall;
+  int divider, divider_count, gated;
+  dma_channel_type *rise_channel, *fall_channel;
+} signal_type;
+
+static tmr_type time_base, count_tmr;
+static dma_model_type dma_model[8];
+static int dma_model_count;
+static double now;
+static uint32_t mask;
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static double gauss(void)
+{
+  double u = (rand_get() + 1.0) / 16777218.0, v = (rand_get() + 1.0) / 16777218.0;
+
+  return sqrt(-2 * log(u)) * cos(2 * PI * v);
+}
+
+static dma_model_type *dma_find(dma_channel_type *dmax_channely)
+{
+  int index;
+
+  for(index = 0; index < dma_model_count; index++)
+  {
+    if(dma_model[index].channel == dmax_channely)
+    {
+      return &dma_model[index];
+    }
+  }
+  dma_model[dma_model_count].channel = dmax_channely;
+  return &dma_model[dma_model_count++];
+}
+
+void tmr_32_bit_function_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void tmr_base_init(tmr_type *tmr_x, uint32_t tmr_pr, uint32_t tmr_div)
+{
+  tmr_x->pr = tmr_pr;
+}
+
+void tmr_cnt_dir_set(tmr_type *tmr_x, tmr_count_mode_type tmr_cnt_dir)
+{
+}
+
+void tmr_input_default_para_init(tmr_input_config_type *input_struct)
+{
+  memset(input_struct, 0, sizeof(*input_struct));
+}
+
+void tmr_input_channel_init(tmr_type *tmr_x, tmr_input_config_type *input_struct, tmr_channel_input_divider_type divider_factor)
+{
+}
+
+void tmr_dma_request_enable(tmr_type *tmr_x, tmr_dma_request_type dma_request, confirm_state new_state)
+{
+}
+
+void tmr_counter_value_set(tmr_type *tmr_x, uint32_t tmr_cnt_value)
+{
+  tmr_x->cval = tmr_cnt_value;
+}
+
+void tmr_counter_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void dma_reset(dma_channel_type *dmax_channely)
+{
+}
+
+void dma_default_para_init(dma_init_type *dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(*dma_init_struct));
+}
+
+void dma_init(dma_channel_type *dmax_channely, dma_init_type *dma_init_struct)
+{
+  dma_model_type *dma = dma_find(dmax_channely);
+
+  CHECK(dma_init_struct->loop_mode_enable == TRUE);
+  dma->ring = (uint32_t *)dma_init_struct->memory_base_addr;
+  dma->size = dma->count = dma_init_struct->buffer_size;
+}
+
+void dma_flexible_config(dma_type *dma_x, uint8_t flex_channelx, dma_flexible_request_type flexible_request)
+{
+}
+
+void dma_channel_enable(dma_channel_type *dmax_channely, confirm_state new_state)
+{
+}
+
+uint16_t dma_data_number_get(dma_channel_type *dmax_channely)
+{
+  return dma_find(dmax_channely)->count;
+}
+
+static void capture(dma_channel_type *dmax_channely, double edge)
+{
+  dma_model_type *dma = dma_find(dmax_channely);
+
+  dma->ring[dma->size - dma->count] = (uint32_t)floor(edge) & mask;
+  if(--dma->count == 0)
+  {
+    dma->count = dma->size;
+  }
+}
+
+/* every edge of the signals up to a time, in time order per signal */
+static void signals_run(signal_type *signal, int count, double until)
+{
+  signal_type *s;
+  int index, any = 1;
+  double rise;
+
+  while(any)
+  {
+    any = 0;
+    for(index = 0; index < count; index++)
+    {
+      s = &signal[index];
+      if(fmin(s->rise, s->fall) > until)
+      {
+        continue;
+      }
+      any = 1;
+      if(s->rise <= s->fall)
+      {
+        if(s->gated)
+        {
+          count_tmr.cval = (count_tmr.cval + 1) & 0xFFFF;
+        }
+        else if(++s->divider_count >= s->divider)
+        {
+          s->divider_count = 0;
+          capture(s->rise_channel, s->rise);
+        }
+        rise = s->rise;
+        s->rise = rise + s->period + s->jitter * gauss();
+        s->fall = s->fall_channel ? rise + s->period * s->duty : NO_EDGE;
+      }
+      else
+      {
+        capture(s->fall_channel, s->fall);
+        s->fall = NO_EDGE;
+      }
+    }
+  }
+  now = until;
+  time_base.cval = (uint32_t)floor(now) & mask;
+}
+
+static void wide_test(void)
+{
+  static uint32_t ring0[256], ring1[256], fall1[256], ring3[64];
+  freq_meter_input_config_type input[4];
+  freq_meter_config_type cfg;
+  freq_meter_result_type result;
+  freq_meter_type meter;
+  signal_type signal[4];
+  int index, batches = 0;
+
+  memset(&cfg, 0, sizeof(cfg));
+  memset(input, 0, sizeof(input));
+  memset(signal, 0, sizeof(signal));
+  dma_model_count = 0;
+  mask = 0xFFFFFFFF;
+  now = 0;
+  time_base.cval = 0;
+  count_tmr.cval = 0;
+
+  /* 72 mhz ticks, 100 ms gates */
+  cfg.tmr = &time_base;
+  cfg.counter_bits = 32;
+  cfg.tick_freq = 72000000;
+  cfg.gate_ticks = 7200000;
+  CHECK(freq_meter_init(&meter, &cfg) == SUCCESS);
+
+  input[0].mode = FREQ_METER_MODE_PERIOD;
+  input[0].channel = 1;
+  input[0].divider = TMR_CHANNEL_INPUT_DIV_1;
+  input[0].dma_channel = DMA1_CHANNEL1;
+  input[0].ring = ring0;
+  input[0].ring_size = 256;
+  input[1].mode = FREQ_METER_MODE_DUTY;
+  input[1].channel = 3;
+  input[1].dma_channel = DMA1_CHANNEL2;
+  input[1].ring = ring1;
+  input[1].fall_dma_channel = DMA1_CHANNEL3;
+  input[1].fall_ring = fall1;
+  input[1].ring_size = 256;
+  input[2].mode = FREQ_METER_MODE_GATED;
+  input[2].count_tmr = &count_tmr;
+  input[3].mode = FREQ_METER_MODE_PERIOD;
+  input[3].channel = 2;
+  input[3].divider = TMR_CHANNEL_INPUT_DIV_8;
+  input[3].dma_channel = DMA1_CHANNEL4;
+  input[3].ring = ring3;
+  input[3].ring_size = 64;
+
+  /* duty takes a channel pair */
+  input[1].channel = 2;
+  CHECK(freq_meter_input_add(&meter, &input[1]) == ERROR);
+  input[1].channel = 3;
+  for(index = 0; index < 4; index++)
+  {
+    CHECK(freq_meter_input_add(&meter, &input[index]) == SUCCESS);
+  }
+  CHECK(freq_meter_input_add(&meter, &input[0]) == ERROR);
+  freq_meter_start(&meter);
+
+  signal[0].period = 72000000 / 1000.0;
+  signal[0].divider = 1;
+  signal[0].rise_channel = DMA1_CHANNEL1;
+  signal[0].rise = 1234.5;
+  signal[0].fall = NO_EDGE;
+  signal[1].period = 72000000 / 12345.0;
+  signal[1].duty = 0.3;
+  signal[1].jitter = 5;
+  signal[1].divider = 1;
+  signal[1].rise_channel = DMA1_CHANNEL2;
+  signal[1].fall_channel = DMA1_CHANNEL3;
+  signal[1].rise = 77.7;
+  signal[1].fall = NO_EDGE;
+  signal[2].period = 72000000 / 5e6;
+  signal[2].gated = 1;
+  signal[2].rise = 3;
+  signal[2].fall = NO_EDGE;
+  signal[3].period = 72000000 / 200000.0;
+  signal[3].divider = 8;
+  signal[3].rise_channel = DMA1_CHANNEL4;
+  signal[3].rise = 10;
+  signal[3].fall = NO_EDGE;
+
+  /* 4 s, polls every 0.5 to 1.9 ms, inside the 2.5 ms the ring of input 3
+     takes to fill */
+  while(now < 72000000.0 * 4)
+  {
+    signals_run(signal, 4, now + 36000 + rand_get() % 100000);
+    if(freq_meter_poll(&meter) == SET && ++batches > 1)
+    {
+      freq_meter_result_get(&meter, 0, &result);
+      CHECK(fabs(result.frequency / 1000.0 - 1000.0) < 0.02);
+      freq_meter_result_get(&meter, 1, &result);
+      CHECK(fabs(result.frequency / 1000.0 - 12345.0) < 1.5);
+      CHECK(abs((int)result.duty - 3000) <= 3);
+      CHECK(fabs(result.jitter_rms / 16.0 - 5) < 0.8);
+      freq_meter_result_get(&meter, 2, &result);
+      CHECK(fabs(result.frequency / 1000.0 - 5e6) < 5e6 * 0.002);
+      freq_meter_result_get(&meter, 3, &result);
+      CHECK(fabs(result.frequency / 1000.0 - 200000.0) < 1.0);
+    }
+  }
+  for(index = 0; index < 4; index++)
+  {
+    CHECK(meter.input[index].overrun_count == 0);
+  }
+  freq_meter_result_get(&meter, 1, &result);
+  printf("32-bit: %d batches, duty input %.3f hz, duty %.2f %%, jitter %.2f ticks, intervals %lu..%lu\n",
+         batches, result.frequency / 1000.0, result.duty / 100.0, result.jitter_rms / 16.0,
+         (unsigned long)result.interval_min, (unsigned long)result.interval_max);
+  CHECK(batches >= 38);
+
+  /* a stalled poll: 370 edges into the 256 slots of the duty rings */
+  signals_run(signal, 4, now + 72000000.0 * 0.03);
+  freq_meter_poll(&meter);
+  CHECK(meter.input[1].overrun_count > 0);
+  printf("stalled poll: %lu overruns on the duty input\n", (unsigned long)meter.input[1].overrun_count);
+  for(index = 0; index < 3;)
+  {
+    signals_run(signal, 4, now + 72000);
+    index += (freq_meter_poll(&meter) == SET);
+  }
+  freq_meter_result_get(&meter, 1, &result);
+  CHECK(fabs(result.frequency / 1000.0 - 12345.0) < 1.5 && abs((int)result.duty - 3000) <= 3);
+}
+
+static void narrow_test(void)
+{
+  static uint32_t ring[8];
+  freq_meter_input_config_type input;
+  freq_meter_config_type cfg;
+  freq_meter_result_type result;
+  freq_meter_type meter;
+  signal_type signal;
+  int index, results = 0, stopped = 0;
+
+  memset(&cfg, 0, sizeof(cfg));
+  memset(&input, 0, sizeof(input));
+  memset(&signal, 0, sizeof(signal));
+  dma_model_count = 0;
+  mask = 0xFFFF;
+  now = 0;
+  time_base.cval = 0;
+
+  /* 1 mhz ticks, the counter wraps every 65.5 ms, 100 ms gates */
+  cfg.tmr = &time_base;
+  cfg.counter_bits = 16;
+  cfg.tick_freq = 1000000;
+  cfg.gate_ticks = 100000;
+  CHECK(freq_meter_init(&meter, &cfg) == SUCCESS);
+  input.mode = FREQ_METER_MODE_PERIOD;
+  input.channel = 4;
+  input.dma_channel = DMA2_CHANNEL1;
+  input.ring = ring;
+  input.ring_size = 8;
+  CHECK(freq_meter_input_add(&meter, &input) == SUCCESS);
+  freq_meter_start(&meter);
+
+  signal.period = 1e6 / 3.0;
+  signal.divider = 1;
+  signal.rise_channel = DMA2_CHANNEL1;
+  signal.rise = 500;
+  signal.fall = NO_EDGE;
+  while(now < 1e6 * 10)
+  {
+    signals_run(&signal, 1, now + 20000 + rand_get() % 40000);
+    if(freq_meter_poll(&meter) == SET)
+    {
+      freq_meter_result_get(&meter, 0, &result);
+      if(result.sequence == meter.sequence && result.intervals > 0)
+      {
+        results++;
+        CHECK(fabs(result.frequency / 1000.0 - 3.0) < 0.0011);
+      }
+    }
+  }
+  CHECK(results >= 20);
+
+  /* the signal stops: 0 hz after FREQ_METER_TIMEOUT_GATES */
+  signal.rise = NO_EDGE;
+  for(index = 0; index < 100; index++)
+  {
+    signals_run(&signal, 1, now + 30000);
+    if(freq_meter_poll(&meter) == SET)
+    {
+      freq_meter_result_get(&meter, 0, &result);
+      stopped |= (result.sequence == meter.sequence && result.frequency == 0);
+    }
+  }
+  CHECK(stopped);
+  printf("16-bit: %d results of 3 hz across the counter wraps, stop %s\n", results, stopped ? "seen" : "not seen");
+}
+
+int main(void)
+{
+  wide_test();
+  narrow_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+/**
+  **************************************************************************
+  * @file     at32_host.h
+  * @brief    cortex-m4 core stand-ins for the host tests
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * forced into every host test translation unit (-include) by host_test.mk.
+ * the device header is taken as it is, then the core intrinsics that are
+ * arm instructions are replaced by c, and the core debug blocks by memory
+ * of the test, so that the middleware sources build unchanged with the
+ * host compiler. peripherals are the test's business: a test either
+ * redefines the peripheral pointers it needs or maps memory at their
+ * addresses.
+ */
+
+#ifndef __AT32_HOST_H
+#define __AT32_HOST_H
+
+#include <stdint.h>
+#include "at32f415.h"
+
+/* interrupt masking: the host test runs interrupts as plain calls */
+extern uint32_t host_primask;
+
+#define __disable_irq()                  (host_primask = 1)
+#define __enable_irq()                   (host_primask = 0)
+#define __get_PRIMASK()                  (host_primask)
+#define __set_PRIMASK(value)             (host_primask = (value))
+
+#undef __DSB
+#undef __ISB
+#undef __DMB
+#undef __WFI
+#undef __WFE
+#define __DSB()
+#define __ISB()
+#define __DMB()
+#define __WFI()
+#define __WFE()
+
+/* dsp extension, only what the middlewares use */
+static inline int32_t host_qadd(int32_t a, int32_t b)
+{
+  int64_t sum = (int64_t)a + b;
+
+  return (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : (int32_t)sum);
+}
+
+static inline uint32_t host_smuad(uint32_t x, uint32_t y)
+{
+  return (uint32_t)((int32_t)(int16_t)x * (int16_t)y + (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16));
+}
+
+static inline uint32_t host_smusd(uint32_t x, uint32_t y)
+{
+  return (uint32_t)((int32_t)(int16_t)x * (int16_t)y - (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16));
+}
+
+static inline uint32_t host_smlad(uint32_t x, uint32_t y, uint32_t acc)
+{
+  return host_smuad(x, y) + acc;
+}
+
+#define __QADD(a, b)                     host_qadd((a), (b))
+#define __SMUAD(x, y)                    host_smuad((x), (y))
+#define __SMUSD(x, y)                    host_smusd((x), (y))
+#define __SMLAD(x, y, acc)               host_smlad((x), (y), (acc))
+#define __PKHBT(a, b, shift)             ((((uint32_t)(a)) & 0x0000FFFF) | ((((uint32_t)(b)) << (shift)) & 0xFFFF0000))
+
+/* cycle counter and trace enable */
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+
+#undef DWT
+#define DWT                              (&host_dwt)
+#undef CoreDebug
+#define CoreDebug                        (&host_core_debug)
+
+#endif
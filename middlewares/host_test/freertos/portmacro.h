@@ -0,0 +1,50 @@
+/*
+ * freertos port macros for the host tests: one thread, critical sections
+ * and interrupt masks are left to the test (vPortEnterCritical and
+ * vPortExitCritical), the kernel types match the arm cm3/cm4 port.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+
+#define portCHAR                         char
+#define portFLOAT                        float
+#define portDOUBLE                       double
+#define portLONG                         long
+#define portSHORT                        short
+#define portSTACK_TYPE                   uint32_t
+#define portBASE_TYPE                    long
+
+typedef portSTACK_TYPE                   StackType_t;
+typedef long                             BaseType_t;
+typedef unsigned long                    UBaseType_t;
+typedef uint32_t                         TickType_t;
+
+#define portMAX_DELAY                    (TickType_t)0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC          1
+#define portSTACK_GROWTH                 (-1)
+#define portTICK_PERIOD_MS               ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT               8
+
+extern void vPortEnterCritical(void);
+extern void vPortExitCritical(void);
+
+#define portYIELD()
+#define portYIELD_FROM_ISR(x)            (void)(x)
+#define portEND_SWITCHING_ISR(x)         (void)(x)
+#define portSET_INTERRUPT_MASK_FROM_ISR() 0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x) (void)(x)
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()             vPortEnterCritical()
+#define portEXIT_CRITICAL()              vPortExitCritical()
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters) void vFunction(void *pvParameters)
+#define portNOP()
+#define portSUPPRESS_TICKS_AND_SLEEP(x)
+#define portINLINE                       inline
+#define portFORCE_INLINE                 inline
+
+#endif
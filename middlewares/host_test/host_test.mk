@@ -0,0 +1,51 @@
+# common rules of the middleware host tests.
+#
+# a library keeps its host test in <library>/host_test, next to the sources,
+# with a makefile that sets
+#   REPO      path of the repository root
+#   TEST      name of the test program
+#   SRCS      test and library sources
+#   CONF_DIR  directory of an at32f415_conf.h (optional)
+#   INCS      more -I options (optional)
+#   DEFS      more -D or -include options (optional)
+#   LIBS      more libraries (optional)
+#   FREERTOS  1 to build against the freertos kernel headers (optional)
+# and then includes this file. a library with more than one test program
+# lists them in TESTS instead of TEST and gives each one <name>_SRCS and,
+# where needed, <name>_DEFS and <name>_LIBS; INCS and CONF_DIR are shared.
+# "make test" builds the programs in build/ and runs them, the exit status
+# tells the result; "make clean" removes build/.
+# unused functions are dropped at link time, so a library function that
+# only drives hardware the test does not model needs no stub.
+
+CONF_DIR ?= $(REPO)/project/at_start_f415/examples/tmr/6_steps/inc
+HOST_DIR  = $(REPO)/middlewares/host_test
+BUILD     = build
+CC       ?= gcc
+
+ifeq ($(FREERTOS),1)
+INCS     += -I$(REPO)/middlewares/freertos/source/include -I$(HOST_DIR)/freertos
+endif
+
+CFLAGS    = -O1 -g -Wall -Wno-unused-function -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast \
+            -DAT32F415RCT7 -I. -I.. $(INCS) -I$(HOST_DIR) -I$(CONF_DIR) \
+            -I$(REPO)/libraries/cmsis/cm4/device_support -I$(REPO)/libraries/cmsis/cm4/core_support \
+            -I$(REPO)/libraries/drivers/inc -include at32_host.h -ffunction-sections -fdata-sections
+
+TESTS    ?= $(TEST)
+$(TEST)_SRCS ?= $(SRCS)
+$(TEST)_DEFS ?= $(DEFS)
+$(TEST)_LIBS ?= $(LIBS)
+
+.SECONDEXPANSION:
+$(addprefix $(BUILD)/,$(TESTS)): $(BUILD)/%: $$($$*_SRCS) $(HOST_DIR)/at32_host.c $(wildcard *.h ../*.h)
+	@mkdir -p $(BUILD)
+	$(CC) $(CFLAGS) $($*_DEFS) -o $@ $($*_SRCS) $(HOST_DIR)/at32_host.c $($*_LIBS) -lm -Wl,--gc-sections
+
+test: $(addprefix $(BUILD)/,$(TESTS))
+	@for test in $(TESTS); do echo ./$(BUILD)/$$test; ./$(BUILD)/$$test || exit 1; done
+
+clean:
+	rm -rf $(BUILD)
+
+.PHONY: test clean
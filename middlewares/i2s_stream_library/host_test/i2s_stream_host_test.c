@@ -0,0 +1,407 @@
+/**
+  **************************************************************************
+  * @file     i2s_stream_host_test.c
+  * @brief    host model of the i2s full duplex stream
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs i2s_stream against a model of both i2s and their dma channels in
+ * loop mode over the rings, one halfword per word clock, the transmitter
+ * LEAD words ahead of the receiver. the input is a known word sequence and
+ * the process callback copies its receive block to its transmit block and
+ * takes some word clocks, so the output must be the input delayed by two
+ * blocks. i2s_enable checks that the slave listens before the master
+ * starts the clocks. checked: 16-bit 32-frame blocks with prompt
+ * interrupts, no bad word and the slack; a process as long as a block
+ * underruns; every 50th interrupt late by more than a block counts overruns
+ * and underruns and the stream recovers at the same delay; 24-bit in
+ * 32-bit slots with 4-frame blocks and the receiver as master; stop
+ * silences the interrupt.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "i2s_stream.h"
+
+#define LEAD                             2
+#define OUT_WORDS                        400000
+#define RING_WORDS                       4096
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+static uint16_t rx_count, tx_count, ring_words;
+static uint16_t *rx_ring_model, *tx_ring_model;
+static int rx_on, tx_on, i2s_tx_on, i2s_rx_on, order_ok;
+static i2s_operation_mode_type mode_tx, mode_rx;
+static uint32_t dma_flags;
+
+static i2s_stream_type stream;
+static uint16_t tx_ring[RING_WORDS], rx_ring[RING_WORDS];
+static uint16_t out[OUT_WORDS];
+static long now, out_count;
+static int process_words;
+
+static int fails;
+
+void dma_reset(dma_channel_type *dmax_channely)
+{
+}
+
+void dma_default_para_init(dma_init_type *dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(*dma_init_struct));
+}
+
+void dma_init(dma_channel_type *dmax_channely, dma_init_type *dma_init_struct)
+{
+  if(dmax_channely == DMA1_CHANNEL4)
+  {
+    rx_ring_model = (uint16_t *)(uintptr_t)dma_init_struct->memory_base_addr;
+    ring_words = dma_init_struct->buffer_size;
+  }
+  else
+  {
+    tx_ring_model = (uint16_t *)(uintptr_t)dma_init_struct->memory_base_addr;
+  }
+}
+
+void dma_flexible_config(dma_type *dma_x, uint8_t flex_channelx, dma_flexible_request_type flexible_request)
+{
+}
+
+void dma_interrupt_enable(dma_channel_type *dmax_channely, uint32_t dma_int, confirm_state new_state)
+{
+}
+
+void dma_channel_enable(dma_channel_type *dmax_channely, confirm_state new_state)
+{
+  if(dmax_channely == DMA1_CHANNEL4)
+  {
+    rx_on = new_state;
+  }
+  else
+  {
+    tx_on = new_state;
+  }
+}
+
+void dma_data_number_set(dma_channel_type *dmax_channely, uint16_t data_number)
+{
+  if(dmax_channely == DMA1_CHANNEL4)
+  {
+    rx_count = data_number;
+  }
+  else
+  {
+    tx_count = data_number;
+  }
+}
+
+uint16_t dma_data_number_get(dma_channel_type *dmax_channely)
+{
+  return (dmax_channely == DMA1_CHANNEL4) ? rx_count : tx_count;
+}
+
+flag_status dma_interrupt_flag_get(uint32_t dmax_int_flag)
+{
+  return (dma_flags & dmax_int_flag & 0x0FFFFFFF) ? SET : RESET;
+}
+
+void dma_flag_clear(uint32_t dmax_flag)
+{
+  dma_flags &= ~(dmax_flag & 0x0FFFFFFF);
+}
+
+void spi_i2s_reset(spi_type *spi_x)
+{
+}
+
+void i2s_default_para_init(i2s_init_type *i2s_init_struct)
+{
+  memset(i2s_init_struct, 0, sizeof(*i2s_init_struct));
+}
+
+void i2s_init(spi_type *spi_x, i2s_init_type *i2s_init_struct)
+{
+  if(spi_x == SPI1)
+  {
+    mode_tx = i2s_init_struct->operation_mode;
+  }
+  else
+  {
+    mode_rx = i2s_init_struct->operation_mode;
+  }
+}
+
+void spi_i2s_dma_transmitter_enable(spi_type *spi_x, confirm_state new_state)
+{
+}
+
+void spi_i2s_dma_receiver_enable(spi_type *spi_x, confirm_state new_state)
+{
+}
+
+/* the master starts the clocks, the slave must already listen */
+void i2s_enable(spi_type *spi_x, confirm_state new_state)
+{
+  int master = (spi_x == SPI1) ? (mode_tx == I2S_MODE_MASTER_TX) : (mode_rx == I2S_MODE_MASTER_RX);
+
+  if(new_state && master)
+  {
+    order_ok = (spi_x == SPI1) ? i2s_rx_on : i2s_tx_on;
+  }
+  if(spi_x == SPI1)
+  {
+    i2s_tx_on = new_state;
+  }
+  else
+  {
+    i2s_rx_on = new_state;
+  }
+}
+
+static uint16_t in_word(long index)
+{
+  return (uint16_t)(index * 2654435761u >> 13) | 1;
+}
+
+static void out_word(void)
+{
+  out[out_count++] = tx_ring_model[ring_words - tx_count];
+  if(--tx_count == 0)
+  {
+    tx_count = ring_words;
+  }
+}
+
+/* one word clock, the transmitter starts LEAD words ahead */
+static void tick(void)
+{
+  int index;
+
+  if(!(rx_on && tx_on && i2s_tx_on && i2s_rx_on))
+  {
+    return;
+  }
+  if(now == 0)
+  {
+    for(index = 0; index < LEAD; index++)
+    {
+      out_word();
+    }
+  }
+  out_word();
+
+  rx_ring_model[ring_words - rx_count] = in_word(now);
+  if(--rx_count == ring_words / 2)
+  {
+    dma_flags |= stream.hdt_flag;
+  }
+  if(rx_count == 0)
+  {
+    rx_count = ring_words;
+    dma_flags |= stream.fdt_flag;
+  }
+  now++;
+}
+
+static void loopback(const uint16_t *rx, uint16_t *tx, uint16_t frames)
+{
+  int index;
+
+  memcpy(tx, rx, frames * stream.frame_words * sizeof(uint16_t));
+  for(index = 0; index < process_words; index++)
+  {
+    tick();
+  }
+}
+
+/* words word clocks, the interrupt taken latency words after its flag and
+   every late_every-th one late_words later still */
+static void run(long words, int latency, int late_every, int late_words)
+{
+  long pending = -1, end = now + words;
+  int irqs = 0, wait;
+
+  while(now < end)
+  {
+    tick();
+    if((dma_flags & (stream.hdt_flag | stream.fdt_flag) & 0x0FFFFFFF) && pending < 0)
+    {
+      pending = now;
+    }
+    if(pending >= 0)
+    {
+      wait = latency + ((late_every != 0 && (irqs % late_every) == late_every - 1) ? late_words : 0);
+      if(now - pending >= wait)
+      {
+        irqs++;
+        pending = -1;
+        i2s_stream_dma_irq_handler(&stream);
+      }
+    }
+  }
+}
+
+/* the output is the input delayed by a constant outside the glitches, the
+   words off it are counted */
+static long delay_get(long from, long *bad)
+{
+  long delay = -1, index, shift;
+
+  for(index = from; index < out_count && delay < 0; index++)
+  {
+    for(shift = 0; shift < 8192 && shift <= index; shift++)
+    {
+      if(out[index] == in_word(index - shift))
+      {
+        delay = shift;
+        break;
+      }
+    }
+  }
+  *bad = 0;
+  for(index = from; index < out_count; index++)
+  {
+    if(index - delay < 0 || out[index] != in_word(index - delay))
+    {
+      (*bad)++;
+    }
+  }
+  return delay;
+}
+
+static void setup(uint16_t block_frames, i2s_data_channel_format_type format, i2s_stream_clock_type clock, int words)
+{
+  i2s_stream_config_type cfg;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.tx_spi = SPI1;
+  cfg.rx_spi = SPI2;
+  cfg.clock = clock;
+  cfg.data_channel_format = format;
+  cfg.tx_dma_channel = DMA1_CHANNEL5;
+  cfg.tx_request = DMA_FLEXIBLE_SPI1_TX;
+  cfg.rx_dma_channel = DMA1_CHANNEL4;
+  cfg.rx_request = DMA_FLEXIBLE_SPI2_RX;
+  cfg.tx_ring = tx_ring;
+  cfg.rx_ring = rx_ring;
+  cfg.block_frames = block_frames;
+  cfg.process = loopback;
+  CHECK(i2s_stream_init(&stream, &cfg) == SUCCESS);
+  now = 0;
+  out_count = 0;
+  dma_flags = 0;
+  process_words = words;
+  order_ok = 0;
+}
+
+static void config_test(void)
+{
+  i2s_stream_config_type cfg;
+
+  memset(&cfg, 0, sizeof(cfg));
+  CHECK(i2s_stream_init(&stream, &cfg) == ERROR);
+}
+
+static void block_test(void)
+{
+  long bad, delay;
+
+  /* prompt interrupts and a short process */
+  setup(32, I2S_DATA_16BIT_CHANNEL_16BIT, I2S_STREAM_CLOCK_TX_MASTER, 10);
+  CHECK(mode_tx == I2S_MODE_MASTER_TX && mode_rx == I2S_MODE_SLAVE_RX && stream.half_words == 64);
+  CHECK(stream.hdt_flag == DMA1_HDT4_FLAG && stream.fdt_flag == DMA1_FDT4_FLAG);
+  i2s_stream_start(&stream);
+  CHECK(order_ok);
+  run(100000, 3, 0, 0);
+  delay = delay_get(64 * 4, &bad);
+  printf("32-frame blocks: delay %ld frames, %ld bad words, %u blocks, slack min %u frames, under %u over %u\n",
+         delay / 2, bad, (unsigned)stream.block_count, stream.slack_min,
+         (unsigned)stream.underrun_count, (unsigned)stream.overrun_count);
+  CHECK(delay == 2 * 64 && bad == 0 && stream.underrun_count == 0 && stream.overrun_count == 0);
+  CHECK(stream.slack_min == (64 - LEAD - 3 - 10) / 2);
+  i2s_stream_stop(&stream);
+
+  /* a process as long as a block underruns, calls two blocks behind look
+     on time again so most are counted */
+  setup(32, I2S_DATA_16BIT_CHANNEL_16BIT, I2S_STREAM_CLOCK_TX_MASTER, 64);
+  i2s_stream_start(&stream);
+  run(20000, 3, 0, 0);
+  printf("process of a block: under %u of %u blocks, slack min %u\n",
+         (unsigned)stream.underrun_count, (unsigned)stream.block_count, stream.slack_min);
+  CHECK(stream.underrun_count * 10 >= stream.block_count * 9 && stream.slack_min == 0);
+  i2s_stream_stop(&stream);
+}
+
+static void late_test(void)
+{
+  long bad, delay;
+
+  /* every 50th interrupt late by more than a block */
+  setup(32, I2S_DATA_16BIT_CHANNEL_16BIT, I2S_STREAM_CLOCK_TX_MASTER, 4);
+  i2s_stream_start(&stream);
+  run(100000, 2, 50, 70);
+  delay = delay_get(64 * 4, &bad);
+  printf("late interrupts: over %u under %u of %u blocks, %ld bad words, delay %ld frames\n",
+         (unsigned)stream.overrun_count, (unsigned)stream.underrun_count, (unsigned)stream.block_count, bad, delay / 2);
+  CHECK(stream.overrun_count > 0 && stream.underrun_count > 0);
+  CHECK(delay == 2 * 64 && bad > 0 && bad < 100000 / 10);
+  i2s_stream_stop(&stream);
+}
+
+static void wide_test(void)
+{
+  long bad, delay;
+  uint32_t blocks;
+
+  /* 24-bit in 32-bit slots, the receiver is master */
+  setup(4, I2S_DATA_24BIT_CHANNEL_32BIT, I2S_STREAM_CLOCK_RX_MASTER, 2);
+  CHECK(mode_tx == I2S_MODE_SLAVE_TX && mode_rx == I2S_MODE_MASTER_RX);
+  CHECK(stream.half_words == 16 && stream.frame_words == 4);
+  i2s_stream_start(&stream);
+  CHECK(order_ok);
+  run(50000, 1, 0, 0);
+  delay = delay_get(32 * 4, &bad);
+  printf("4-frame blocks, 24-bit: delay %ld frames, %ld bad words, slack min %u frames, under %u over %u\n",
+         delay / 4, bad, stream.slack_min, (unsigned)stream.underrun_count, (unsigned)stream.overrun_count);
+  CHECK(delay == 2 * 16 && bad == 0 && stream.underrun_count == 0 && stream.overrun_count == 0);
+
+  /* stop silences the interrupt */
+  i2s_stream_stop(&stream);
+  blocks = stream.block_count;
+  dma_flags |= stream.hdt_flag;
+  i2s_stream_dma_irq_handler(&stream);
+  CHECK(stream.block_count == blocks && !rx_on && !tx_on);
+}
+
+int main(void)
+{
+  config_test();
+  block_test();
+  late_test();
+  wide_test();
+
+  printf(fails ? "FAILED\n" : "PASSED\n");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,329 @@
+/**
+  **************************************************************************
+  * @file     i2s_stream.c
+  * @brief    i2s full duplex streaming library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "i2s_stream.h"
+#include <stddef.h>
+#include <string.h>
+
+/** @addtogroup AT32F415_middlewares_i2s_stream_library
+  * @{
+  */
+
+/** @defgroup I2S_STREAM_library
+  * @brief i2s full duplex streaming
+  * @{
+  */
+
+/** @defgroup I2S_STREAM_private_definition
+  * @{
+  */
+
+#define I2S_STREAM_DMA_CHANNEL_SPACE     0x14
+
+/**
+  * @}
+  */
+
+/** @defgroup I2S_STREAM_private_functions
+  * @{
+  */
+
+/**
+  * @brief  flag of a dma channel from the matching channel 1 flag, the
+  *         channels are I2S_STREAM_DMA_CHANNEL_SPACE apart and their flags
+  *         four bits apart.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  channel1_flag: DMA1_xxx1_FLAG
+  * @retval flag of the channel
+  */
+static uint32_t i2s_stream_dma_flag(dma_channel_type *dma_channel, uint32_t channel1_flag)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    return 0x10000000 | (channel1_flag << ((base - DMA2_CHANNEL1_BASE) / I2S_STREAM_DMA_CHANNEL_SPACE * 4));
+  }
+  return channel1_flag << ((base - DMA1_CHANNEL1_BASE) / I2S_STREAM_DMA_CHANNEL_SPACE * 4);
+}
+
+/**
+  * @brief  loop mode channel between a ring and an i2s data register, the
+  *         flexible channel number is the channel's own.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  request: flexible request
+  * @param  direction: DMA_DIR_MEMORY_TO_PERIPHERAL or DMA_DIR_PERIPHERAL_TO_MEMORY
+  * @param  spi: the i2s
+  * @param  ring: the ring
+  * @param  ring_words: halfwords of the ring
+  * @retval none
+  */
+static void i2s_stream_dma_init(dma_channel_type *dma_channel, dma_flexible_request_type request,
+                                dma_dir_type direction, spi_type *spi, uint16_t *ring, uint16_t ring_words)
+{
+  dma_init_type dma_init_struct;
+  uint32_t base = (uint32_t)dma_channel;
+
+  dma_reset(dma_channel);
+  dma_default_para_init(&dma_init_struct);
+  dma_init_struct.buffer_size = ring_words;
+  dma_init_struct.direction = direction;
+  dma_init_struct.memory_base_addr = (uint32_t)ring;
+  dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_HALFWORD;
+  dma_init_struct.memory_inc_enable = TRUE;
+  dma_init_struct.peripheral_base_addr = (uint32_t)&spi->dt;
+  dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_HALFWORD;
+  dma_init_struct.peripheral_inc_enable = FALSE;
+  dma_init_struct.priority = DMA_PRIORITY_VERY_HIGH;
+  dma_init_struct.loop_mode_enable = TRUE;
+  dma_init(dma_channel, &dma_init_struct);
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    dma_flexible_config(DMA2, (uint8_t)(FLEX_CHANNEL1 + (base - DMA2_CHANNEL1_BASE) / I2S_STREAM_DMA_CHANNEL_SPACE), request);
+  }
+  else
+  {
+    dma_flexible_config(DMA1, (uint8_t)(FLEX_CHANNEL1 + (base - DMA1_CHANNEL1_BASE) / I2S_STREAM_DMA_CHANNEL_SPACE), request);
+  }
+}
+
+/**
+  * @brief  ring halfword moved next by a loop mode channel.
+  * @param  dma_channel: the channel
+  * @param  ring_words: halfwords of the ring
+  * @retval halfword index
+  */
+static uint16_t i2s_stream_position_get(dma_channel_type *dma_channel, uint16_t ring_words)
+{
+  uint16_t position = ring_words - dma_data_number_get(dma_channel);
+
+  return (position >= ring_words) ? 0 : position;
+}
+
+/**
+  * @brief  a block has been received: hand it to the process callback with
+  *         the transmit block of the same half, which has just played.
+  * @param  stream: the stream
+  * @param  half: 0 or 1
+  * @retval none
+  */
+static void i2s_stream_half_done(i2s_stream_type *stream, uint8_t half)
+{
+  uint16_t ring_words = stream->half_words * 2, offset = half * stream->half_words;
+  uint16_t position, slack;
+  uint8_t late;
+
+  if(stream->running == 0)
+  {
+    return;
+  }
+
+  /* the receive channel is back in the half when this call is a block late,
+     the transmit channel ahead of it is then playing the block as well */
+  position = i2s_stream_position_get(stream->cfg.rx_dma_channel, ring_words);
+  late = ((position < stream->half_words) == (half == 0)) ? 1 : 0;
+  if(late != 0)
+  {
+    stream->overrun_count++;
+  }
+
+  stream->cfg.process(stream->cfg.rx_ring + offset, stream->cfg.tx_ring + offset, stream->cfg.block_frames);
+
+  /* the block filled must still be ahead of the transmit channel */
+  position = i2s_stream_position_get(stream->cfg.tx_dma_channel, ring_words);
+  if(late != 0 || (position < stream->half_words) == (half == 0))
+  {
+    stream->underrun_count++;
+    stream->slack_min = 0;
+  }
+  else
+  {
+    slack = (uint16_t)(((offset + ring_words - position) % ring_words) / stream->frame_words);
+    if(slack < stream->slack_min)
+    {
+      stream->slack_min = slack;
+    }
+  }
+  stream->block_count++;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup I2S_STREAM_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  set both i2s and their dma channels up, the stream is stopped.
+  *         the spi, dma and gpio clocks and the pins are set up by the
+  *         caller, the receive channel interrupt is enabled in the nvic by
+  *         the caller.
+  * @param  stream: the stream
+  * @param  cfg: configuration, copied
+  * @retval SUCCESS, or ERROR on a bad configuration
+  */
+error_status i2s_stream_init(i2s_stream_type *stream, const i2s_stream_config_type *cfg)
+{
+  i2s_init_type i2s_init_struct;
+  uint32_t words;
+
+  if(cfg->tx_spi == NULL || cfg->rx_spi == NULL || cfg->tx_spi == cfg->rx_spi ||
+     cfg->tx_dma_channel == NULL || cfg->rx_dma_channel == NULL || cfg->tx_dma_channel == cfg->rx_dma_channel ||
+     cfg->tx_ring == NULL || cfg->rx_ring == NULL || cfg->process == NULL ||
+     cfg->block_frames == 0 || cfg->block_frames > I2S_STREAM_BLOCK_FRAMES_MAX)
+  {
+    return ERROR;
+  }
+
+  stream->cfg = *cfg;
+  stream->frame_words = (cfg->data_channel_format == I2S_DATA_16BIT_CHANNEL_16BIT ||
+                         cfg->data_channel_format == I2S_DATA_16BIT_CHANNEL_32BIT) ? 2 : 4;
+  words = (uint32_t)cfg->block_frames * stream->frame_words;
+  if(words * 2 > 0xFFFF)
+  {
+    return ERROR;
+  }
+  stream->half_words = (uint16_t)words;
+  stream->running = 0;
+  stream->block_count = 0;
+  stream->overrun_count = 0;
+  stream->underrun_count = 0;
+  stream->slack_min = cfg->block_frames;
+  stream->hdt_flag = i2s_stream_dma_flag(cfg->rx_dma_channel, DMA1_HDT1_FLAG);
+  stream->fdt_flag = i2s_stream_dma_flag(cfg->rx_dma_channel, DMA1_FDT1_FLAG);
+
+  i2s_stream_dma_init(cfg->tx_dma_channel, cfg->tx_request, DMA_DIR_MEMORY_TO_PERIPHERAL,
+                      cfg->tx_spi, cfg->tx_ring, stream->half_words * 2);
+  i2s_stream_dma_init(cfg->rx_dma_channel, cfg->rx_request, DMA_DIR_PERIPHERAL_TO_MEMORY,
+                      cfg->rx_spi, cfg->rx_ring, stream->half_words * 2);
+  dma_interrupt_enable(cfg->rx_dma_channel, DMA_HDT_INT | DMA_FDT_INT, TRUE);
+
+  i2s_default_para_init(&i2s_init_struct);
+  i2s_init_struct.audio_protocol = cfg->audio_protocol;
+  i2s_init_struct.audio_sampling_freq = cfg->audio_sampling_freq;
+  i2s_init_struct.data_channel_format = cfg->data_channel_format;
+  i2s_init_struct.clock_polarity = cfg->clock_polarity;
+
+  spi_i2s_reset(cfg->tx_spi);
+  i2s_init_struct.operation_mode = (cfg->clock == I2S_STREAM_CLOCK_TX_MASTER) ? I2S_MODE_MASTER_TX : I2S_MODE_SLAVE_TX;
+  i2s_init_struct.mclk_output_enable = (cfg->clock == I2S_STREAM_CLOCK_TX_MASTER) ? cfg->mclk_output_enable : FALSE;
+  i2s_init(cfg->tx_spi, &i2s_init_struct);
+  spi_i2s_dma_transmitter_enable(cfg->tx_spi, TRUE);
+
+  spi_i2s_reset(cfg->rx_spi);
+  i2s_init_struct.operation_mode = (cfg->clock == I2S_STREAM_CLOCK_RX_MASTER) ? I2S_MODE_MASTER_RX : I2S_MODE_SLAVE_RX;
+  i2s_init_struct.mclk_output_enable = (cfg->clock == I2S_STREAM_CLOCK_RX_MASTER) ? cfg->mclk_output_enable : FALSE;
+  i2s_init(cfg->rx_spi, &i2s_init_struct);
+  spi_i2s_dma_receiver_enable(cfg->rx_spi, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  start from silence, the slaves before the master so that both
+  *         sides begin on the same frame.
+  * @param  stream: the stream
+  * @retval none
+  */
+void i2s_stream_start(i2s_stream_type *stream)
+{
+  uint16_t ring_words = stream->half_words * 2;
+
+  if(stream->running != 0)
+  {
+    return;
+  }
+
+  memset(stream->cfg.tx_ring, 0, ring_words * sizeof(uint16_t));
+  memset(stream->cfg.rx_ring, 0, ring_words * sizeof(uint16_t));
+  dma_flag_clear(stream->hdt_flag | stream->fdt_flag);
+  dma_data_number_set(stream->cfg.tx_dma_channel, ring_words);
+  dma_data_number_set(stream->cfg.rx_dma_channel, ring_words);
+  dma_channel_enable(stream->cfg.rx_dma_channel, TRUE);
+  dma_channel_enable(stream->cfg.tx_dma_channel, TRUE);
+  stream->running = 1;
+
+  if(stream->cfg.clock == I2S_STREAM_CLOCK_RX_MASTER)
+  {
+    i2s_enable(stream->cfg.tx_spi, TRUE);
+    i2s_enable(stream->cfg.rx_spi, TRUE);
+  }
+  else
+  {
+    i2s_enable(stream->cfg.rx_spi, TRUE);
+    i2s_enable(stream->cfg.tx_spi, TRUE);
+  }
+}
+
+/**
+  * @brief  stop both i2s and their dma channels.
+  * @param  stream: the stream
+  * @retval none
+  */
+void i2s_stream_stop(i2s_stream_type *stream)
+{
+  stream->running = 0;
+  i2s_enable(stream->cfg.tx_spi, FALSE);
+  i2s_enable(stream->cfg.rx_spi, FALSE);
+  dma_channel_enable(stream->cfg.tx_dma_channel, FALSE);
+  dma_channel_enable(stream->cfg.rx_dma_channel, FALSE);
+  dma_flag_clear(stream->hdt_flag | stream->fdt_flag);
+}
+
+/**
+  * @brief  receive channel interrupt. a call late by more than a block is
+  *         counted in overrun_count, a process that ends after its transmit
+  *         block began to play in underrun_count.
+  * @param  stream: the stream
+  * @retval none
+  */
+void i2s_stream_dma_irq_handler(i2s_stream_type *stream)
+{
+  if(dma_interrupt_flag_get(stream->hdt_flag) != RESET)
+  {
+    dma_flag_clear(stream->hdt_flag);
+    i2s_stream_half_done(stream, 0);
+  }
+  if(dma_interrupt_flag_get(stream->fdt_flag) != RESET)
+  {
+    dma_flag_clear(stream->fdt_flag);
+    i2s_stream_half_done(stream, 1);
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,142 @@
+/**
+  **************************************************************************
+  * @file     i2s_stream.h
+  * @brief    i2s full duplex streaming library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __I2S_STREAM_H
+#define __I2S_STREAM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_i2s_stream_library
+  * @{
+  */
+
+/** @defgroup I2S_STREAM_library_definition
+  * @{
+  */
+
+/**
+  * @brief an i2s is one direction only, full duplex takes two of them on the
+  *        same ck and ws lines: one transmits, one receives. each runs a dma
+  *        channel in loop mode over a ring of two blocks. the half and full
+  *        transfer interrupts of the receive channel hand the block just
+  *        received and the transmit block just played to the process
+  *        callback, which has one block period to fill it. input to output
+  *        the stream is delayed by two blocks.
+  *        the rings hold halfwords as the i2s data register moves them, a
+  *        left and right pair per frame, two halfwords per sample with the
+  *        high one first in the 24 and 32-bit formats.
+  */
+#define I2S_STREAM_BLOCK_FRAMES_MAX      0x3FFF
+
+/**
+  * @}
+  */
+
+/** @defgroup I2S_STREAM_library_handler
+  * @{
+  */
+
+/**
+  * @brief which side drives ck and ws
+  */
+typedef enum
+{
+  I2S_STREAM_CLOCK_TX_MASTER             = 0x00, /*!< transmitter is master, receiver slave */
+  I2S_STREAM_CLOCK_RX_MASTER             = 0x01, /*!< receiver is master, transmitter slave */
+  I2S_STREAM_CLOCK_EXTERNAL              = 0x02  /*!< both slaves of the codec clocks */
+} i2s_stream_clock_type;
+
+/**
+  * @brief configuration
+  */
+typedef struct
+{
+  spi_type                               *tx_spi;                 /*!< SPI1 or SPI2 transmitting       */
+  spi_type                               *rx_spi;                 /*!< the other one, receiving        */
+  i2s_stream_clock_type                  clock;                   /*!< clock master                    */
+  i2s_audio_protocol_type                audio_protocol;          /*!< frame format                    */
+  i2s_audio_sampling_freq_type           audio_sampling_freq;     /*!< frames per second of a master   */
+  i2s_data_channel_format_type           data_channel_format;     /*!< sample and slot width           */
+  i2s_clock_polarity_type                clock_polarity;          /*!< ck idle level                   */
+  confirm_state                          mclk_output_enable;      /*!< mclk out of a master            */
+  dma_channel_type                       *tx_dma_channel;         /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              tx_request;              /*!< DMA_FLEXIBLE_SPIx_TX            */
+  dma_channel_type                       *rx_dma_channel;         /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              rx_request;              /*!< DMA_FLEXIBLE_SPIx_RX            */
+  uint16_t                               *tx_ring;                /*!< two blocks played               */
+  uint16_t                               *rx_ring;                /*!< two blocks received             */
+  uint16_t                               block_frames;            /*!< frames of a block               */
+  void                                   (*process)(const uint16_t *rx_block, uint16_t *tx_block, uint16_t frames); /*!< block callback */
+} i2s_stream_config_type;
+
+/**
+  * @brief stream and its telemetry
+  */
+typedef struct
+{
+  i2s_stream_config_type                 cfg;                     /*!< configuration                   */
+  uint16_t                               half_words;              /*!< halfwords of a block            */
+  uint8_t                                frame_words;             /*!< halfwords of a frame            */
+  __IO uint8_t                           running;                 /*!< stream started                  */
+  uint32_t                               hdt_flag;                /*!< half transfer flag, rx channel  */
+  uint32_t                               fdt_flag;                /*!< full transfer flag, rx channel  */
+  __IO uint32_t                          block_count;             /*!< blocks processed                */
+  __IO uint32_t                          overrun_count;           /*!< blocks received again before their process */
+  __IO uint32_t                          underrun_count;          /*!< blocks filled after their play started */
+  __IO uint16_t                          slack_min;               /*!< fewest frames left before a filled block played */
+} i2s_stream_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup I2S_STREAM_library_exported_functions
+  * @{
+  */
+
+error_status      i2s_stream_init               (i2s_stream_type *stream, const i2s_stream_config_type *cfg);
+void              i2s_stream_start              (i2s_stream_type *stream);
+void              i2s_stream_stop               (i2s_stream_type *stream);
+void              i2s_stream_dma_irq_handler    (i2s_stream_type *stream);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,965 @@
+/**
+  **************************************************************************
+  * @file     bldc_commutation.c
+  * @brief    six step bldc commutation library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "bldc_commutation.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup BLDC_library
+  * @brief six step bldc commutation
+  * @{
+  */
+
+/** @defgroup BLDC_private_definition
+  * @{
+  */
+
+#define BLDC_COMPARE_NEVER               0xFFFFFFFF
+#define BLDC_CM1_MASK                    0x00007070
+#define BLDC_CM2_MASK                    0x00000070
+#define BLDC_CCTRL_MASK                  0x00000555
+
+/* zero crossing detection of a step */
+#define ZC_NONE                          0
+#define ZC_BLANK                         1
+#define ZC_WAIT                          2
+
+#ifndef BLDC_HALL_FILTER
+#define BLDC_HALL_FILTER                 0x08
+#endif
+
+/* phase drive of a step */
+#define PHASE_FLOAT                      0
+#define PHASE_PWM                        1
+#define PHASE_LOW                        2
+
+/**
+  * @brief phase a/b/c drive of the six steps, a+b-, a+c-, b+c-, b+a-, c+a-, c+b-
+  */
+static const uint8_t bldc_step_drive[BLDC_STEP_COUNT][3] =
+{
+  {PHASE_PWM,   PHASE_LOW,   PHASE_FLOAT},
+  {PHASE_PWM,   PHASE_FLOAT, PHASE_LOW  },
+  {PHASE_FLOAT, PHASE_PWM,   PHASE_LOW  },
+  {PHASE_LOW,   PHASE_PWM,   PHASE_FLOAT},
+  {PHASE_LOW,   PHASE_FLOAT, PHASE_PWM  },
+  {PHASE_FLOAT, PHASE_LOW,   PHASE_PWM  }
+};
+
+/**
+  * @brief floating phase of the six steps
+  */
+static const uint8_t bldc_step_float[BLDC_STEP_COUNT] = {2, 1, 0, 2, 1, 0};
+
+/**
+  * @brief forward step of the hall states 5, 1, 3, 2, 6, 4, the states 0 and 7
+  *        are invalid
+  */
+static const uint8_t bldc_hall_table_default[8] =
+{
+  BLDC_HALL_INVALID, 1, 3, 2, 5, 0, 4, BLDC_HALL_INVALID
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup BLDC_private_functions
+  * @{
+  */
+
+/**
+  * @brief  step after step in the commanded direction.
+  * @param  step: current step.
+  * @param  dir: rotation direction.
+  * @retval next step.
+  */
+static uint8_t bldc_step_advance(uint8_t step, bldc_dir_type dir)
+{
+  if(dir == BLDC_DIR_FORWARD)
+  {
+    return (step == BLDC_STEP_COUNT - 1) ? 0 : step + 1;
+  }
+  return (step == 0) ? BLDC_STEP_COUNT - 1 : step - 1;
+}
+
+/**
+  * @brief  step driving the rotor in the commanded direction at a hall state,
+  *         reverse drives the opposite vector of forward.
+  * @param  bldc: the commutation engine.
+  * @param  hall: hall state.
+  * @retval drive step.
+  */
+static uint8_t bldc_hall_drive(bldc_type *bldc, uint8_t hall)
+{
+  uint8_t step = bldc->cfg.hall_table[hall];
+
+  if(bldc->dir == BLDC_DIR_REVERSE)
+  {
+    step = (step + BLDC_STEP_COUNT / 2) % BLDC_STEP_COUNT;
+  }
+  return step;
+}
+
+/**
+  * @brief  write the pattern of a step to the buffered TMR1 channel control
+  *         bits, it reaches the outputs on the next hall event.
+  * @param  bldc: the commutation engine.
+  * @param  step: step to load.
+  * @retval none.
+  */
+static void bldc_preload(bldc_type *bldc, uint8_t step)
+{
+  tmr_type *tmr_x = bldc->pwm_tmr;
+  const bldc_pattern_type *pattern = &bldc->pattern[step];
+
+  tmr_x->cm1 = (tmr_x->cm1 & ~BLDC_CM1_MASK) | pattern->cm1;
+  tmr_x->cm2 = (tmr_x->cm2 & ~BLDC_CM2_MASK) | pattern->cm2;
+  tmr_x->cctrl = (tmr_x->cctrl & ~BLDC_CCTRL_MASK) | pattern->cctrl;
+  bldc->next_step = step;
+}
+
+/**
+  * @brief  connect CMP1 to the floating phase of a step. the comparator output
+  *         is inverted for a falling back-emf, so every zero crossing is a
+  *         rising edge on exint line 19.
+  * @param  bldc: the commutation engine.
+  * @param  step: step on the outputs.
+  * @retval none.
+  */
+static void bldc_zc_select(bldc_type *bldc, uint8_t step)
+{
+  confirm_state falling = (step & 1) ? FALSE : TRUE;
+
+  if(bldc->dir == BLDC_DIR_REVERSE)
+  {
+    falling = (falling == TRUE) ? FALSE : TRUE;
+  }
+
+  CMP->ctrlsts2_bit.cmp1ninvsel = bldc->cfg.zc_input[bldc_step_float[step]];
+  CMP->ctrlsts1_bit.cmp1p = (falling == TRUE) ? CMP_POL_INVERTING : CMP_POL_NON_INVERTING;
+}
+
+/**
+  * @brief  add the length of a step to the speed history.
+  * @param  bldc: the commutation engine.
+  * @param  interval: step length in ticks.
+  * @retval none.
+  */
+static void bldc_history_add(bldc_type *bldc, uint32_t interval)
+{
+  bldc->interval = interval;
+  bldc->history_sum += interval - bldc->history[bldc->history_pos];
+  bldc->history[bldc->history_pos] = interval;
+  bldc->history_pos = (bldc->history_pos == BLDC_STEP_COUNT - 1) ? 0 : bldc->history_pos + 1;
+  if(bldc->history_count < BLDC_STEP_COUNT)
+  {
+    bldc->history_count++;
+  }
+}
+
+/**
+  * @brief  write the compare value of the pwm phase to the three channels.
+  * @param  bldc: the commutation engine.
+  * @param  duty: TMR1 compare value.
+  * @retval none.
+  */
+static void bldc_duty_write(bldc_type *bldc, uint32_t duty)
+{
+  tmr_channel_value_set(bldc->pwm_tmr, TMR_SELECT_CHANNEL_1, duty);
+  tmr_channel_value_set(bldc->pwm_tmr, TMR_SELECT_CHANNEL_2, duty);
+  tmr_channel_value_set(bldc->pwm_tmr, TMR_SELECT_CHANNEL_3, duty);
+}
+
+/**
+  * @brief  move the pwm phase compare value by at most duty_slew towards the
+  *         duty asked for. a sudden step of the current would shift the zero
+  *         crossings of the sensorless loop out of their window.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+static void bldc_duty_slew(bldc_type *bldc)
+{
+  uint32_t duty = bldc->pwm_tmr->c1dt;
+  uint32_t slew = bldc->cfg.duty_slew;
+
+  if(duty == bldc->duty)
+  {
+    return;
+  }
+  if(duty < bldc->duty)
+  {
+    duty = (bldc->duty - duty > slew) ? duty + slew : bldc->duty;
+  }
+  else
+  {
+    duty = (duty - bldc->duty > slew) ? duty - slew : bldc->duty;
+  }
+  bldc_duty_write(bldc, duty);
+}
+
+/**
+  * @brief  turn the outputs off and leave the commutation state.
+  * @param  bldc: the commutation engine.
+  * @param  state: BLDC_STATE_STOP or BLDC_STATE_STALL.
+  * @retval none.
+  */
+static void bldc_outputs_off(bldc_type *bldc, bldc_state_type state)
+{
+  tmr_output_enable(bldc->pwm_tmr, FALSE);
+  bldc->com_tmr->c2dt = BLDC_COMPARE_NEVER;
+  bldc->zc_armed = ZC_NONE;
+  bldc->state = state;
+}
+
+/**
+  * @brief  take a zero crossing of the floating phase. it times the
+  *         commutation half a step later, during the startup it counts towards
+  *         closing the loop, in the run state it restarts TMR2 and gives the
+  *         step length. a zero crossing sooner than half a step after the
+  *         last one or than a quarter step after the commutation is noise.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+static void bldc_zc_accept(bldc_type *bldc)
+{
+  tmr_type *com_tmr = bldc->com_tmr;
+  uint32_t now = com_tmr->cval;
+  uint32_t interval;
+
+  if(bldc->state == BLDC_STATE_STARTUP && bldc->zc_valid == 0)
+  {
+    /* the first one of the startup is taken as mid step */
+    interval = (now - bldc->com_tick) * 2;
+  }
+  else
+  {
+    /* steps bridged since the last zero crossing are in the count */
+    interval = now / (bldc->zc_miss + 1);
+    if(interval < bldc->interval / 2 || now - bldc->com_tick < bldc->interval / 4)
+    {
+      return;
+    }
+  }
+
+  if(bldc->state == BLDC_STATE_STARTUP)
+  {
+    if(++bldc->zc_valid >= bldc->cfg.zc_confirm)
+    {
+      bldc->state = BLDC_STATE_RUN;
+    }
+  }
+  else
+  {
+    bldc_history_add(bldc, interval);
+  }
+
+  bldc->zc_armed = ZC_NONE;
+  bldc->zc_count++;
+  bldc->interval = interval;
+  bldc->zc_miss = 0;
+  com_tmr->cval = 0;
+  com_tmr->c2dt = interval / 2;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup BLDC_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  fill a configuration with defaults: hall mode, 1 mhz ticks, hall
+  *         inputs on pa0/pa1/pa2, back-emf of phase a/b/c on pa0/pa1/pa5,
+  *         startup duty of 10% for a TMR1 period of 3600.
+  * @param  cfg: configuration.
+  * @retval none.
+  */
+void bldc_default_para_init(bldc_config_type *cfg)
+{
+  cfg->mode = BLDC_MODE_HALL;
+  cfg->tick_freq = 1000000;
+  cfg->pole_pairs = 4;
+  cfg->deadtime = 72;
+  cfg->stall_ticks = 500000;
+  cfg->hall_table = bldc_hall_table_default;
+  cfg->hall_gpio = GPIOA;
+  cfg->hall_pins[0] = GPIO_PINS_0;
+  cfg->hall_pins[1] = GPIO_PINS_1;
+  cfg->hall_pins[2] = GPIO_PINS_2;
+  cfg->hall_delay = 1;
+  cfg->zc_input[0] = CMP_NON_INVERTING_PA0_PA2;
+  cfg->zc_input[1] = CMP_NON_INVERTING_PA1_PA3;
+  cfg->zc_input[2] = CMP_NON_INVERTING_PA5_PA7;
+  cfg->zc_blank = 50;
+  cfg->zc_confirm = 6;
+  cfg->align_ticks = 200000;
+  cfg->startup_period = 20000;
+  cfg->startup_min = 4000;
+  cfg->startup_ramp = 8;
+  cfg->startup_duty = 360;
+  cfg->duty_slew = 36;
+}
+
+/**
+  * @brief  initialize the engine. the caller enables the clocks, sets up the
+  *         pins, configures the time bases (TMR1 pwm period, TMR2 in 32-bit
+  *         mode counting at tick_freq) and enables the TMR1 hall, TMR2 and, in
+  *         sensorless mode, CMP1 interrupts in the nvic. the TMR2 interrupt
+  *         must preempt the TMR1 hall interrupt, CMP1 must have the same
+  *         priority as the TMR1 hall interrupt. the outputs stay off.
+  * @param  bldc: the commutation engine.
+  * @param  pwm_tmr: TMR1.
+  * @param  com_tmr: TMR2.
+  * @param  cfg: configuration.
+  * @retval SUCCESS, or ERROR for an invalid configuration.
+  */
+error_status bldc_init(bldc_type *bldc, tmr_type *pwm_tmr, tmr_type *com_tmr, const bldc_config_type *cfg)
+{
+  tmr_output_config_type tmr_output_struct;
+  tmr_input_config_type tmr_input_struct;
+  tmr_brkdt_config_type tmr_brkdt_struct;
+  cmp_init_type cmp_init_struct;
+  exint_init_type exint_init_struct;
+  bldc_pattern_type *pattern;
+  uint8_t step, phase, hall;
+
+  if(cfg->tick_freq == 0 || cfg->pole_pairs == 0 || cfg->stall_ticks == 0 || cfg->hall_table == NULL)
+  {
+    return ERROR;
+  }
+
+  /* the open loop and blanking compares must come before the TMR2 overflow,
+     which is the stall timeout */
+  if(cfg->mode == BLDC_MODE_SENSORLESS &&
+     (cfg->align_ticks >= cfg->stall_ticks || cfg->startup_period >= cfg->stall_ticks ||
+      cfg->zc_blank >= cfg->stall_ticks || cfg->startup_min == 0 || cfg->zc_confirm == 0))
+  {
+    return ERROR;
+  }
+
+  /* a start that never gets to the duty asked for: no drive or no slew, a
+     ramp that never reaches startup_min, or a blanking that hides the zero
+     crossing in the middle of the last open loop step */
+  if(cfg->mode == BLDC_MODE_SENSORLESS &&
+     (cfg->startup_duty == 0 || cfg->duty_slew == 0 || cfg->zc_blank >= cfg->startup_min / 2 ||
+      (cfg->startup_ramp == 0 && cfg->startup_period > cfg->startup_min)))
+  {
+    return ERROR;
+  }
+
+  bldc->pwm_tmr = pwm_tmr;
+  bldc->com_tmr = com_tmr;
+  bldc->cfg = *cfg;
+  bldc->state = BLDC_STATE_STOP;
+  bldc->com_count = 0;
+  bldc->zc_count = 0;
+  bldc->zc_miss_count = 0;
+  bldc->hall_error_count = 0;
+  bldc->stall_count = 0;
+
+  /* every step needs exactly one hall state */
+  for(step = 0; step < BLDC_STEP_COUNT; step++)
+  {
+    bldc->step_hall[step] = BLDC_HALL_INVALID;
+  }
+  for(hall = 0; hall < 8; hall++)
+  {
+    step = cfg->hall_table[hall];
+    if(step < BLDC_STEP_COUNT)
+    {
+      if(bldc->step_hall[step] != BLDC_HALL_INVALID)
+      {
+        return ERROR;
+      }
+      bldc->step_hall[step] = hall;
+    }
+  }
+  for(step = 0; step < BLDC_STEP_COUNT; step++)
+  {
+    if(cfg->mode == BLDC_MODE_HALL && bldc->step_hall[step] == BLDC_HALL_INVALID)
+    {
+      return ERROR;
+    }
+  }
+
+  /* register bits of the step patterns: the pwm phase runs pwm a on its high
+     switch, the low phase forces its reference high with only the
+     complementary output enabled, the floating phase forces it low with only
+     the high output enabled, the disabled outputs sit at their off level */
+  for(step = 0; step < BLDC_STEP_COUNT; step++)
+  {
+    pattern = &bldc->pattern[step];
+    pattern->cm1 = 0;
+    pattern->cm2 = 0;
+    pattern->cctrl = 0;
+    for(phase = 0; phase < 3; phase++)
+    {
+      uint32_t octrl, enable;
+
+      switch(bldc_step_drive[step][phase])
+      {
+        case PHASE_PWM:
+          octrl = TMR_OUTPUT_CONTROL_PWM_MODE_A;
+          enable = 0x1;
+          break;
+        case PHASE_LOW:
+          octrl = TMR_OUTPUT_CONTROL_FORCE_HIGH;
+          enable = 0x4;
+          break;
+        default:
+          octrl = TMR_OUTPUT_CONTROL_FORCE_LOW;
+          enable = 0x1;
+          break;
+      }
+      if(phase == 2)
+      {
+        pattern->cm2 |= octrl << 4;
+      }
+      else
+      {
+        pattern->cm1 |= octrl << (4 + phase * 8);
+      }
+      pattern->cctrl |= enable << (phase * 4);
+    }
+  }
+
+  /* TMR1 channel 1/2/3 with buffered duty, outputs off until started */
+  tmr_output_default_para_init(&tmr_output_struct);
+  tmr_output_struct.oc_mode = TMR_OUTPUT_CONTROL_FORCE_LOW;
+  tmr_output_struct.oc_output_state = TRUE;
+  tmr_output_struct.oc_polarity = TMR_OUTPUT_ACTIVE_HIGH;
+  tmr_output_struct.oc_idle_state = FALSE;
+  tmr_output_struct.occ_output_state = FALSE;
+  tmr_output_struct.occ_polarity = TMR_OUTPUT_ACTIVE_HIGH;
+  tmr_output_struct.occ_idle_state = FALSE;
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_1, &tmr_output_struct);
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_2, &tmr_output_struct);
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_3, &tmr_output_struct);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_1, TRUE);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_2, TRUE);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_3, TRUE);
+  bldc_duty_set(bldc, 0);
+
+  tmr_brkdt_default_para_init(&tmr_brkdt_struct);
+  tmr_brkdt_struct.deadtime = cfg->deadtime;
+  tmr_brkdt_struct.fcsoen_state = TRUE;
+  tmr_brkdt_struct.fcsodis_state = TRUE;
+  tmr_brkdt_config(pwm_tmr, &tmr_brkdt_struct);
+  tmr_output_enable(pwm_tmr, FALSE);
+
+  /* buffered channel control bits, swapped by the hall event or the rising
+     edge of TMR2 TRGOUT on IS1 */
+  tmr_channel_buffer_enable(pwm_tmr, TRUE);
+  tmr_hall_select(pwm_tmr, TRUE);
+  tmr_trigger_input_select(pwm_tmr, TMR_SUB_INPUT_SEL_IS1);
+
+  /* TMR2 channel 2 raw output rises commutation delay ticks after a restart */
+  tmr_period_value_set(com_tmr, cfg->stall_ticks);
+  tmr_output_default_para_init(&tmr_output_struct);
+  tmr_output_struct.oc_mode = TMR_OUTPUT_CONTROL_PWM_MODE_B;
+  tmr_output_struct.oc_output_state = FALSE;
+  tmr_output_channel_config(com_tmr, TMR_SELECT_CHANNEL_2, &tmr_output_struct);
+  tmr_output_channel_buffer_enable(com_tmr, TMR_SELECT_CHANNEL_2, FALSE);
+  com_tmr->c2dt = BLDC_COMPARE_NEVER;
+  tmr_primary_mode_select(com_tmr, TMR_PRIMARY_SEL_C2ORAW);
+
+  /* only a real overflow is a stall, not a restart */
+  tmr_overflow_request_source_set(com_tmr, TRUE);
+
+  if(cfg->mode == BLDC_MODE_HALL)
+  {
+    /* hall a/b/c xor on channel 1, every edge captures the step length into
+       c1dt and restarts the counter */
+    tmr_input_default_para_init(&tmr_input_struct);
+    tmr_input_struct.input_channel_select = TMR_SELECT_CHANNEL_1;
+    tmr_input_struct.input_mapped_select = TMR_CC_CHANNEL_MAPPED_STI;
+    tmr_input_struct.input_polarity_select = TMR_INPUT_RISING_EDGE;
+    tmr_input_struct.input_filter_value = BLDC_HALL_FILTER;
+    tmr_input_channel_init(com_tmr, &tmr_input_struct, TMR_CHANNEL_INPUT_DIV_1);
+    tmr_channel1_input_select(com_tmr, TMR_CHANEL1_2_3_CONNECTED_C1IRAW_XOR);
+    tmr_trigger_input_select(com_tmr, TMR_SUB_INPUT_SEL_C1INC);
+    tmr_sub_mode_select(com_tmr, TMR_SUB_RESET_MODE);
+    tmr_interrupt_enable(com_tmr, TMR_C1_INT, TRUE);
+  }
+  else
+  {
+    /* channel 1 compare interrupt at the end of the blanking */
+    tmr_output_default_para_init(&tmr_output_struct);
+    tmr_output_struct.oc_mode = TMR_OUTPUT_CONTROL_OFF;
+    tmr_output_struct.oc_output_state = FALSE;
+    tmr_output_channel_config(com_tmr, TMR_SELECT_CHANNEL_1, &tmr_output_struct);
+    tmr_output_channel_buffer_enable(com_tmr, TMR_SELECT_CHANNEL_1, FALSE);
+    com_tmr->c1dt = BLDC_COMPARE_NEVER;
+    tmr_interrupt_enable(com_tmr, TMR_C1_INT, TRUE);
+
+    /* floating phase against the virtual neutral on pa4 */
+    cmp_default_para_init(&cmp_init_struct);
+    cmp_init_struct.cmp_non_inverting = cfg->zc_input[0];
+    cmp_init_struct.cmp_inverting = CMP_INVERTING_PA4;
+    cmp_init_struct.cmp_speed = CMP_SPEED_FAST;
+    cmp_init_struct.cmp_output = CMP_OUTPUT_NONE;
+    cmp_init_struct.cmp_hysteresis = CMP_HYSTERESIS_MEDIUM;
+    cmp_init(CMP1_SELECTION, &cmp_init_struct);
+    cmp_enable(CMP1_SELECTION, TRUE);
+
+    exint_default_para_init(&exint_init_struct);
+    exint_init_struct.line_enable = TRUE;
+    exint_init_struct.line_mode = EXINT_LINE_INTERRUPT;
+    exint_init_struct.line_select = EXINT_LINE_19;
+    exint_init_struct.line_polarity = EXINT_TRIGGER_RISING_EDGE;
+    exint_init(&exint_init_struct);
+    exint_flag_clear(EXINT_LINE_19);
+  }
+
+  tmr_flag_clear(com_tmr, TMR_OVF_FLAG | TMR_C1_FLAG);
+  tmr_interrupt_enable(com_tmr, TMR_OVF_INT, TRUE);
+
+  /* float every phase */
+  bldc->zc_armed = ZC_NONE;
+  bldc->step = 0;
+  pwm_tmr->cm1 = (pwm_tmr->cm1 & ~BLDC_CM1_MASK) |
+                 (TMR_OUTPUT_CONTROL_FORCE_LOW << 4) | (TMR_OUTPUT_CONTROL_FORCE_LOW << 12);
+  pwm_tmr->cm2 = (pwm_tmr->cm2 & ~BLDC_CM2_MASK) | (TMR_OUTPUT_CONTROL_FORCE_LOW << 4);
+  pwm_tmr->cctrl = (pwm_tmr->cctrl & ~BLDC_CCTRL_MASK) | 0x111;
+  tmr_event_sw_trigger(pwm_tmr, TMR_HALL_SWTRIG);
+  tmr_flag_clear(pwm_tmr, TMR_HALL_FLAG);
+  tmr_interrupt_enable(pwm_tmr, TMR_HALL_INT, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  start the motor. in hall mode the step of the present hall state is
+  *         driven at once, in sensorless mode the rotor is aligned and then
+  *         accelerated in open loop until zc_confirm zero crossings in a row
+  *         are seen.
+  * @param  bldc: the commutation engine.
+  * @param  dir: rotation direction.
+  * @param  duty: TMR1 compare value of the pwm phase, in sensorless mode
+  *         reached after the loop closes.
+  * @retval SUCCESS, or ERROR when running or on an invalid hall state.
+  */
+error_status bldc_start(bldc_type *bldc, bldc_dir_type dir, uint32_t duty)
+{
+  tmr_type *com_tmr = bldc->com_tmr;
+  uint8_t hall, step;
+
+  if(bldc->state != BLDC_STATE_STOP && bldc->state != BLDC_STATE_STALL)
+  {
+    return ERROR;
+  }
+
+  bldc->dir = dir;
+  bldc->edge_seen = 0;
+  bldc->zc_armed = ZC_NONE;
+  bldc->zc_early = 0;
+  bldc->zc_valid = 0;
+  bldc->zc_miss = 0;
+  bldc->com_tick = 0;
+  bldc->interval = 0;
+  bldc->history_sum = 0;
+  bldc->history_pos = 0;
+  bldc->history_count = 0;
+  for(step = 0; step < BLDC_STEP_COUNT; step++)
+  {
+    bldc->history[step] = 0;
+  }
+
+  /* no hardware commutation before the first position event */
+  com_tmr->c2dt = BLDC_COMPARE_NEVER;
+  com_tmr->cval = 0;
+  tmr_flag_clear(com_tmr, TMR_OVF_FLAG | TMR_C1_FLAG);
+
+  if(bldc->cfg.mode == BLDC_MODE_HALL)
+  {
+    hall = bldc_hall_get(bldc);
+    if(bldc->cfg.hall_table[hall] >= BLDC_STEP_COUNT)
+    {
+      bldc->hall_error_count++;
+      return ERROR;
+    }
+    bldc->next_hall = hall;
+    bldc_preload(bldc, bldc_hall_drive(bldc, hall));
+    bldc->state = BLDC_STATE_RUN;
+  }
+  else
+  {
+    bldc->forced_period = bldc->cfg.startup_period;
+    bldc_preload(bldc, 0);
+    exint_flag_clear(EXINT_LINE_19);
+    bldc->state = BLDC_STATE_ALIGN;
+  }
+
+  /* the sensorless open loop drives with startup_duty whatever the load,
+     the duty asked for is reached after the loop closes */
+  bldc_duty_set(bldc, duty);
+  if(bldc->cfg.mode == BLDC_MODE_SENSORLESS)
+  {
+    bldc_duty_write(bldc, bldc->cfg.startup_duty);
+  }
+  tmr_output_enable(bldc->pwm_tmr, TRUE);
+
+  /* the hall interrupt loads the step after this one */
+  tmr_event_sw_trigger(bldc->pwm_tmr, TMR_HALL_SWTRIG);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  stop the motor, the outputs go to their off level and the motor
+  *         coasts.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+void bldc_stop(bldc_type *bldc)
+{
+  bldc_outputs_off(bldc, BLDC_STATE_STOP);
+}
+
+/**
+  * @brief  set the duty of the pwm phase. in hall mode it is applied at the
+  *         next TMR1 overflow. in sensorless mode it is approached by
+  *         duty_slew every commutation once the loop is closed.
+  * @param  bldc: the commutation engine.
+  * @param  duty: TMR1 compare value.
+  * @retval none.
+  */
+void bldc_duty_set(bldc_type *bldc, uint32_t duty)
+{
+  bldc->duty = duty;
+  if(bldc->cfg.mode == BLDC_MODE_HALL)
+  {
+    bldc_duty_write(bldc, duty);
+  }
+}
+
+/**
+  * @brief  mechanical speed from the last electrical period. the six steps of
+  *         the period are summed, so unequal hall sensor spacing cancels out.
+  *         a motor slowing down is seen from the running step before the next
+  *         position event.
+  * @param  bldc: the commutation engine.
+  * @retval speed in rpm, 0 when not running.
+  */
+uint32_t bldc_speed_get(bldc_type *bldc)
+{
+  uint64_t period;
+  uint32_t sum, count, running;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  sum = bldc->history_sum;
+  count = bldc->history_count;
+  running = bldc->com_tmr->cval;
+  __set_PRIMASK(primask);
+
+  if(bldc->state != BLDC_STATE_RUN || count == 0)
+  {
+    return 0;
+  }
+
+  period = (uint64_t)sum * BLDC_STEP_COUNT / count;
+  if(period < (uint64_t)running * BLDC_STEP_COUNT)
+  {
+    period = (uint64_t)running * BLDC_STEP_COUNT;
+  }
+  if(period == 0)
+  {
+    return 0;
+  }
+  return (uint32_t)((uint64_t)60 * bldc->cfg.tick_freq / (period * bldc->cfg.pole_pairs));
+}
+
+/**
+  * @brief  read the hall inputs.
+  * @param  bldc: the commutation engine.
+  * @retval hall state, bit 0/1/2 for hall a/b/c.
+  */
+uint8_t bldc_hall_get(bldc_type *bldc)
+{
+  uint32_t idt = bldc->cfg.hall_gpio->idt;
+  uint8_t hall = 0;
+
+  if(idt & bldc->cfg.hall_pins[0])
+  {
+    hall |= 0x1;
+  }
+  if(idt & bldc->cfg.hall_pins[1])
+  {
+    hall |= 0x2;
+  }
+  if(idt & bldc->cfg.hall_pins[2])
+  {
+    hall |= 0x4;
+  }
+  return hall;
+}
+
+/**
+  * @brief  TMR1 hall interrupt, called after the hardware swapped in the
+  *         buffered step. loads the following step and, in sensorless mode,
+  *         moves the comparator to the new floating phase and times the next
+  *         commutation of the open loop or of a missed zero crossing.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+void bldc_com_irq_handler(bldc_type *bldc)
+{
+  tmr_type *com_tmr = bldc->com_tmr;
+
+  if(tmr_interrupt_flag_get(bldc->pwm_tmr, TMR_HALL_FLAG) == RESET)
+  {
+    return;
+  }
+  tmr_flag_clear(bldc->pwm_tmr, TMR_HALL_FLAG | TMR_TRIGGER_FLAG);
+
+  if(bldc->state == BLDC_STATE_STOP || bldc->state == BLDC_STATE_STALL)
+  {
+    return;
+  }
+
+  bldc->step = bldc->next_step;
+  bldc->com_tick = com_tmr->cval;
+  bldc->com_count++;
+
+  if(bldc->cfg.mode == BLDC_MODE_HALL)
+  {
+    bldc->hall = bldc->next_hall;
+    bldc->next_hall = bldc->step_hall[bldc_step_advance(bldc->cfg.hall_table[bldc->hall], bldc->dir)];
+    bldc_preload(bldc, bldc_hall_drive(bldc, bldc->next_hall));
+    return;
+  }
+
+  bldc_preload(bldc, bldc_step_advance(bldc->step, bldc->dir));
+  bldc_zc_select(bldc, bldc->step);
+
+  switch(bldc->state)
+  {
+    case BLDC_STATE_ALIGN:
+      com_tmr->cval = 0;
+      bldc->com_tick = 0;
+      com_tmr->c2dt = bldc->cfg.align_ticks;
+      bldc->state = BLDC_STATE_STARTUP;
+      bldc->zc_armed = ZC_NONE;
+      return;
+
+    case BLDC_STATE_STARTUP:
+      /* the count runs on from the zero crossing of the step just ended,
+         without one it restarts here */
+      if(bldc->zc_armed != ZC_NONE)
+      {
+        bldc->zc_valid = 0;
+      }
+      if(bldc->zc_valid == 0)
+      {
+        com_tmr->cval = 0;
+        bldc->com_tick = 0;
+      }
+      /* a step is not cut short twice in a row */
+      bldc->zc_early = (bldc->zc_early == 1) ? 2 : 0;
+      com_tmr->c2dt = bldc->com_tick + bldc->forced_period;
+      if(bldc->forced_period > bldc->cfg.startup_min)
+      {
+        /* the back-emf is watched from the end of the ramp on, below that
+           speed it is too weak to trust */
+        bldc->forced_period -= (bldc->forced_period * bldc->cfg.startup_ramp) >> 8;
+        if(bldc->forced_period < bldc->cfg.startup_min)
+        {
+          bldc->forced_period = bldc->cfg.startup_min;
+        }
+        bldc->zc_armed = ZC_NONE;
+        return;
+      }
+      break;
+
+    default:
+      /* commutated by the bridge, the zero crossing of the last step was lost */
+      if(bldc->zc_armed != ZC_NONE)
+      {
+        bldc->zc_miss_count++;
+        if(++bldc->zc_miss > BLDC_ZC_MISS_MAX)
+        {
+          bldc->stall_count++;
+          bldc_outputs_off(bldc, BLDC_STATE_STALL);
+          return;
+        }
+
+        /* the comparator never left the crossed level, the rotor runs ahead */
+        if(bldc->zc_armed == ZC_BLANK)
+        {
+          bldc->interval -= bldc->interval / 4;
+        }
+      }
+
+      /* bridge to the predicted commutation if this zero crossing is lost */
+      com_tmr->c2dt += bldc->interval;
+      bldc_duty_slew(bldc);
+      break;
+  }
+
+  /* no zero crossing is taken before the end of the blanking */
+  com_tmr->c1dt = bldc->com_tick + bldc->cfg.zc_blank;
+  bldc->zc_armed = ZC_BLANK;
+}
+
+/**
+  * @brief  TMR2 interrupt. a hall edge records the step length and checks the
+  *         hall state against the step loaded, an out of order state loads its
+  *         own step and commutates by software. in sensorless mode the channel
+  *         1 compare ends the blanking: when the comparator already shows the
+  *         zero crossing of the step, the rotor runs ahead of the open loop
+  *         and the step is cut short. an overflow is a stall.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+void bldc_timer_irq_handler(bldc_type *bldc)
+{
+  tmr_type *com_tmr = bldc->com_tmr;
+  uint32_t interval;
+  uint8_t hall;
+
+  if(tmr_interrupt_flag_get(com_tmr, TMR_OVF_FLAG) != RESET)
+  {
+    tmr_flag_clear(com_tmr, TMR_OVF_FLAG);
+    if(bldc->state != BLDC_STATE_STOP && bldc->state != BLDC_STATE_STALL)
+    {
+      bldc->stall_count++;
+      bldc_outputs_off(bldc, BLDC_STATE_STALL);
+    }
+  }
+
+  if(tmr_interrupt_flag_get(com_tmr, TMR_C1_FLAG) == RESET)
+  {
+    return;
+  }
+
+  if(bldc->cfg.mode == BLDC_MODE_SENSORLESS)
+  {
+    tmr_flag_clear(com_tmr, TMR_C1_FLAG);
+    if(bldc->zc_armed != ZC_BLANK)
+    {
+      return;
+    }
+
+    /* edges of the blanking time are demagnetization or switching noise */
+    exint_flag_clear(EXINT_LINE_19);
+    if(cmp_output_value_get(CMP1_SELECTION) == 0)
+    {
+      bldc->zc_early = 0;
+      bldc->zc_armed = ZC_WAIT;
+    }
+    else if(bldc->state == BLDC_STATE_STARTUP && bldc->zc_early == 0)
+    {
+      bldc->zc_early = 1;
+      bldc->zc_armed = ZC_NONE;
+      bldc->zc_valid = 0;
+      tmr_event_sw_trigger(bldc->pwm_tmr, TMR_HALL_SWTRIG);
+    }
+    else
+    {
+      /* still demagnetizing, or the zero crossing is already past: look
+         again later */
+      com_tmr->c1dt += bldc->cfg.zc_blank;
+    }
+    return;
+  }
+
+  interval = com_tmr->c1dt;
+  tmr_flag_clear(com_tmr, TMR_C1_FLAG);
+  hall = bldc_hall_get(bldc);
+
+  if(bldc->state != BLDC_STATE_RUN)
+  {
+    return;
+  }
+  if(bldc->cfg.hall_table[hall] >= BLDC_STEP_COUNT)
+  {
+    bldc->hall_error_count++;
+    return;
+  }
+
+  /* the first edge after the start measures no full step */
+  if(bldc->edge_seen != 0)
+  {
+    bldc_history_add(bldc, interval);
+  }
+  bldc->edge_seen = 1;
+
+  if(hall == bldc->next_hall)
+  {
+    com_tmr->c2dt = bldc->cfg.hall_delay;
+  }
+  else
+  {
+    bldc->hall_error_count++;
+    com_tmr->c2dt = BLDC_COMPARE_NEVER;
+    bldc->next_hall = hall;
+    bldc_preload(bldc, bldc_hall_drive(bldc, hall));
+    tmr_event_sw_trigger(bldc->pwm_tmr, TMR_HALL_SWTRIG);
+  }
+}
+
+/**
+  * @brief  CMP1 exint line 19 interrupt. a zero crossing after the blanking
+  *         times the commutation half a step later. during the startup it
+  *         counts towards closing the loop, in the run state it restarts TMR2
+  *         and gives the step length.
+  * @param  bldc: the commutation engine.
+  * @retval none.
+  */
+void bldc_zc_irq_handler(bldc_type *bldc)
+{
+  if(exint_interrupt_flag_get(EXINT_LINE_19) == RESET)
+  {
+    return;
+  }
+  exint_flag_clear(EXINT_LINE_19);
+
+  /* a spike gone by the time it is read is switching noise */
+  if(bldc->zc_armed != ZC_WAIT || cmp_output_value_get(CMP1_SELECTION) == 0)
+  {
+    return;
+  }
+
+  bldc_zc_accept(bldc);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
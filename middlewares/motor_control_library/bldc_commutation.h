@@ -0,0 +1,209 @@
+/**
+  **************************************************************************
+  * @file     bldc_commutation.h
+  * @brief    six step bldc commutation library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __BLDC_COMMUTATION_H
+#define __BLDC_COMMUTATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup BLDC_library_definition
+  * @{
+  */
+
+/**
+  * @brief TMR1 channel 1/2/3 and 1c/2c/3c drive the high and low switches of
+  *        phase a/b/c. one phase is pwm on its high switch, one has its low
+  *        switch on and the third floats. the pattern of the next step is
+  *        written to the buffered channel control bits of TMR1 and swapped in
+  *        by the hardware on the hall event, which is the TRGOUT of the
+  *        commutation timer (TMR2 channel 2 raw output) on TMR1 input IS1.
+  */
+#define BLDC_STEP_COUNT                  6
+#define BLDC_HALL_INVALID                0xFF
+
+/**
+  * @brief the commutation timer is TMR2 in 32-bit mode, its counter restarts on
+  *        every hall edge (hall mode) or back-emf zero crossing (sensorless
+  *        mode), channel 2 compare gives the commutation delay after it. in
+  *        sensorless mode channel 1 compare ends the blanking of each step.
+  *        BLDC_ZC_MISS_MAX lost zero crossings in a row are bridged by the
+  *        predicted commutation, one more stops the motor as stalled.
+  */
+#ifndef BLDC_ZC_MISS_MAX
+#define BLDC_ZC_MISS_MAX                 6
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup BLDC_library_handler
+  * @{
+  */
+
+/**
+  * @brief position sensing mode
+  */
+typedef enum
+{
+  BLDC_MODE_HALL                         = 0x00, /*!< hall sensors on TMR2 channel 1/2/3 */
+  BLDC_MODE_SENSORLESS                   = 0x01  /*!< back-emf zero crossing on CMP1 */
+} bldc_mode_type;
+
+/**
+  * @brief rotation direction
+  */
+typedef enum
+{
+  BLDC_DIR_FORWARD                       = 0x00, /*!< steps 0, 1, 2 ... */
+  BLDC_DIR_REVERSE                       = 0x01  /*!< steps 5, 4, 3 ... */
+} bldc_dir_type;
+
+/**
+  * @brief commutation state
+  */
+typedef enum
+{
+  BLDC_STATE_STOP                        = 0x00, /*!< outputs off */
+  BLDC_STATE_ALIGN                       = 0x01, /*!< sensorless, rotor held on the first step */
+  BLDC_STATE_STARTUP                     = 0x02, /*!< sensorless, open loop ramp */
+  BLDC_STATE_RUN                         = 0x03, /*!< commutated from hall edges or zero crossings */
+  BLDC_STATE_STALL                       = 0x04  /*!< no position event in stall_ticks, outputs off */
+} bldc_state_type;
+
+/**
+  * @brief configuration, filled with bldc_default_para_init. times are in
+  *        ticks of the commutation timer.
+  */
+typedef struct
+{
+  bldc_mode_type                         mode;                    /*!< position sensing mode           */
+  uint32_t                               tick_freq;               /*!< commutation timer count rate    */
+  uint8_t                                pole_pairs;              /*!< motor pole pairs                */
+  uint8_t                                deadtime;                /*!< TMR1 dead time register value   */
+  uint32_t                               stall_ticks;             /*!< no event timeout, period of TMR2*/
+  const uint8_t                          *hall_table;             /*!< hall state to forward step      */
+  gpio_type                              *hall_gpio;              /*!< port of the hall inputs         */
+  uint16_t                               hall_pins[3];            /*!< hall a/b/c, bit 0/1/2 of state  */
+  uint32_t                               hall_delay;              /*!< hall edge to commutation        */
+  cmp_non_inverting_type                 zc_input[3];             /*!< CMP1 input of phase a/b/c       */
+  uint32_t                               zc_blank;                /*!< commutation to first zc accepted*/
+  uint8_t                                zc_confirm;              /*!< zc in a row to close the loop   */
+  uint32_t                               align_ticks;             /*!< sensorless rotor alignment      */
+  uint32_t                               startup_period;          /*!< first open loop step            */
+  uint32_t                               startup_min;             /*!< last open loop step, zc watched */
+  uint8_t                                startup_ramp;            /*!< step shortened by ramp / 256    */
+  uint32_t                               startup_duty;            /*!< TMR1 compare of align and ramp  */
+  uint32_t                               duty_slew;               /*!< sensorless duty step per step   */
+} bldc_config_type;
+
+/**
+  * @brief drive pattern of one step, the TMR1 register bits it changes
+  */
+typedef struct
+{
+  uint32_t                               cm1;                     /*!< channel 1/2 output control      */
+  uint32_t                               cm2;                     /*!< channel 3 output control        */
+  uint32_t                               cctrl;                   /*!< channel 1/2/3 enables           */
+} bldc_pattern_type;
+
+/**
+  * @brief commutation engine
+  */
+typedef struct
+{
+  tmr_type                               *pwm_tmr;                /*!< TMR1                            */
+  tmr_type                               *com_tmr;                /*!< TMR2                            */
+  bldc_config_type                       cfg;                     /*!< configuration                   */
+  bldc_pattern_type                      pattern[BLDC_STEP_COUNT];                /*!< step patterns   */
+  uint8_t                                step_hall[BLDC_STEP_COUNT];              /*!< forward step to hall state */
+  __IO bldc_state_type                   state;                   /*!< commutation state               */
+  bldc_dir_type                          dir;                     /*!< commanded direction             */
+  uint8_t                                step;                    /*!< step on the outputs             */
+  uint8_t                                next_step;               /*!< step in the buffered bits       */
+  uint8_t                                hall;                    /*!< hall state of the step driven   */
+  uint8_t                                next_hall;               /*!< hall state of the next step     */
+  uint8_t                                edge_seen;               /*!< hall edge seen since the start   */
+  uint8_t                                zc_armed;                /*!< zc of this step: none, blanking, wait */
+  uint8_t                                zc_early;                /*!< open loop step cut short        */
+  uint8_t                                zc_valid;                /*!< zc in a row during the startup  */
+  uint8_t                                zc_miss;                 /*!< bridged zc in a row             */
+  uint32_t                               com_tick;                /*!< timer count at the commutation  */
+  uint32_t                               forced_period;           /*!< open loop step                  */
+  uint32_t                               duty;                    /*!< TMR1 compare of the run state   */
+  uint32_t                               interval;                /*!< last step in ticks              */
+  uint32_t                               history[BLDC_STEP_COUNT];                /*!< last six steps  */
+  uint32_t                               history_sum;             /*!< electrical period in ticks      */
+  uint8_t                                history_pos;             /*!< oldest step in history          */
+  uint8_t                                history_count;           /*!< valid steps in history          */
+  __IO uint32_t                          com_count;               /*!< commutations                    */
+  __IO uint32_t                          zc_count;                /*!< zero crossings accepted         */
+  __IO uint32_t                          zc_miss_count;           /*!< zero crossings bridged          */
+  __IO uint32_t                          hall_error_count;        /*!< invalid or out of order states  */
+  __IO uint32_t                          stall_count;             /*!< stall timeouts                  */
+} bldc_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup BLDC_library_exported_functions
+  * @{
+  */
+
+void              bldc_default_para_init        (bldc_config_type *cfg);
+error_status      bldc_init                     (bldc_type *bldc, tmr_type *pwm_tmr, tmr_type *com_tmr, const bldc_config_type *cfg);
+error_status      bldc_start                    (bldc_type *bldc, bldc_dir_type dir, uint32_t duty);
+void              bldc_stop                     (bldc_type *bldc);
+void              bldc_duty_set                 (bldc_type *bldc, uint32_t duty);
+uint32_t          bldc_speed_get                (bldc_type *bldc);
+uint8_t           bldc_hall_get                 (bldc_type *bldc);
+void              bldc_com_irq_handler          (bldc_type *bldc);
+void              bldc_timer_irq_handler        (bldc_type *bldc);
+void              bldc_zc_irq_handler           (bldc_type *bldc);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
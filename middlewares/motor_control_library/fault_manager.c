@@ -0,0 +1,471 @@
+/**
+  **************************************************************************
+  * @file     fault_manager.c
+  * @brief    current limit and fault management library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "fault_manager.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup FAULT_library
+  * @brief current limit and fault management
+  * @{
+  */
+
+/** @defgroup FAULT_private_functions
+  * @{
+  */
+
+/**
+  * @brief  exint line of a comparator output.
+  * @param  cmp_sel: CMP1_SELECTION or CMP2_SELECTION
+  * @retval exint line
+  */
+static uint32_t fault_exint_line(cmp_sel_type cmp_sel)
+{
+  return (cmp_sel == CMP1_SELECTION) ? EXINT_LINE_19 : EXINT_LINE_20;
+}
+
+/**
+  * @brief  pass an event to the application.
+  * @param  fault: the fault manager
+  * @param  event: what happened
+  * @param  source: FAULT_SOURCE_ bits of the trip
+  * @retval none
+  */
+static void fault_notify(fault_type *fault, fault_event_type event, uint32_t source)
+{
+  if(fault->cfg.event_handler != NULL)
+  {
+    fault->cfg.event_handler(event, source);
+  }
+}
+
+/**
+  * @brief  source of a break: a software request, else the trip comparator
+  *         when its output is still high, else the pin.
+  * @param  fault: the fault manager
+  * @retval FAULT_SOURCE_ bits
+  */
+static uint32_t fault_break_source(fault_type *fault)
+{
+  uint32_t source = fault->pending_source;
+
+  fault->pending_source = 0;
+  if(fault->cfg.trip_enable == TRUE && cmp_output_value_get(fault->cfg.trip_cmp) != 0)
+  {
+    source |= FAULT_SOURCE_OVERCURRENT;
+  }
+  if(source == 0)
+  {
+    source = FAULT_SOURCE_BREAK_PIN;
+  }
+  return source;
+}
+
+/**
+  * @brief  account a trip with the outputs already off and schedule the
+  *         retry, each one waits twice as long as the one before. a trip with
+  *         the retries used up locks the outputs off.
+  * @param  fault: the fault manager
+  * @param  source: FAULT_SOURCE_ bits
+  * @retval none
+  */
+static void fault_trip(fault_type *fault, uint32_t source)
+{
+  tmr_interrupt_enable(fault->pwm_tmr, TMR_OVF_INT, FALSE);
+  fault->limited = 0;
+  fault->limit_run = 0;
+  fault->trip_count++;
+  fault->last_source = source;
+  fault->last_trip_tick = fault->tick;
+
+  if(fault->retries >= fault->cfg.retry_max)
+  {
+    fault->state = FAULT_STATE_LOCKED;
+    fault->lockout_count++;
+    fault_notify(fault, FAULT_EVENT_LOCKOUT, source);
+    return;
+  }
+
+  fault->retries++;
+  fault->countdown = fault->retry_delay ? fault->retry_delay : 1;
+  fault->retry_delay = (fault->retry_delay > fault->cfg.retry_delay_max / 2) ?
+                       fault->cfg.retry_delay_max : fault->retry_delay * 2;
+  fault->state = FAULT_STATE_TRIPPED;
+  fault_notify(fault, FAULT_EVENT_TRIP, source);
+}
+
+/**
+  * @brief  turn the outputs on again unless the break input is still active,
+  *         which counts as another trip.
+  * @param  fault: the fault manager
+  * @retval none
+  */
+static void fault_retry(fault_type *fault)
+{
+  tmr_type *pwm_tmr = fault->pwm_tmr;
+
+  tmr_flag_clear(pwm_tmr, TMR_BRK_FLAG);
+  if(tmr_flag_get(pwm_tmr, TMR_BRK_FLAG) != RESET)
+  {
+    fault_trip(fault, fault_break_source(fault));
+    return;
+  }
+
+  fault->retry_count++;
+  fault_notify(fault, FAULT_EVENT_RETRY, fault->last_source);
+  fault->run_ticks = 0;
+  fault->state = FAULT_STATE_ARMED;
+  tmr_interrupt_enable(pwm_tmr, TMR_BRK_INT, TRUE);
+  tmr_output_enable(pwm_tmr, TRUE);
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup FAULT_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  fill a configuration with the defaults: limit on CMP1 (pa1 against
+  *         vrefint) clearing channel 1/2/3, trip on CMP2 (pa3 against vrefint),
+  *         tripping after 100 limited periods in a row, up to 5 retries from
+  *         10 ms backing off to 1 s, cleared by 2 s of clean run.
+  * @param  cfg: configuration to fill
+  * @retval none
+  */
+void fault_default_para_init(fault_config_type *cfg)
+{
+  cfg->limit_enable = TRUE;
+  cfg->limit_cmp = CMP1_SELECTION;
+  cfg->limit_input = CMP_NON_INVERTING_PA1_PA3;
+  cfg->limit_level = CMP_INVERTING_VREFINT;
+  cfg->limit_hysteresis = CMP_HYSTERESIS_LOW;
+  cfg->limit_channels = 0x07;
+  cfg->limit_cycles_max = 100;
+  cfg->trip_enable = TRUE;
+  cfg->trip_cmp = CMP2_SELECTION;
+  cfg->trip_input = CMP_NON_INVERTING_PA1_PA3;
+  cfg->trip_level = CMP_INVERTING_VREFINT;
+  cfg->brk_polarity = TMR_BRK_INPUT_ACTIVE_HIGH;
+  cfg->retry_delay = 10;
+  cfg->retry_delay_max = 1000;
+  cfg->retry_max = 5;
+  cfg->retry_reset = 2000;
+  cfg->event_handler = NULL;
+}
+
+/**
+  * @brief  route the comparators into TMR1 and arm the break. the limit
+  *         comparator output clears the selected channels until the next
+  *         overflow and its exint line counts the events, the trip comparator
+  *         drives the break input. the outputs stay off after a break until
+  *         the retry.
+  * @param  fault: the fault manager
+  * @param  pwm_tmr: TMR1, the only timer with a break input from the comparators
+  * @param  cfg: configuration
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status fault_init(fault_type *fault, tmr_type *pwm_tmr, const fault_config_type *cfg)
+{
+  cmp_init_type cmp_init_struct;
+  exint_init_type exint_init_struct;
+  uint8_t channel;
+
+  if(pwm_tmr != TMR1 || cfg->retry_delay_max < cfg->retry_delay ||
+     (cfg->limit_enable == TRUE && cfg->trip_enable == TRUE && cfg->limit_cmp == cfg->trip_cmp))
+  {
+    return ERROR;
+  }
+
+  fault->pwm_tmr = pwm_tmr;
+  fault->cfg = *cfg;
+  fault->state = FAULT_STATE_ARMED;
+  fault->limited = 0;
+  fault->pending_source = 0;
+  fault->retries = 0;
+  fault->retry_delay = cfg->retry_delay;
+  fault->countdown = 0;
+  fault->run_ticks = 0;
+  fault->tick = 0;
+  fault->limit_events = 0;
+  fault->limit_cycles = 0;
+  fault->limit_run = 0;
+  fault->limit_run_max = 0;
+  fault->trip_count = 0;
+  fault->retry_count = 0;
+  fault->lockout_count = 0;
+  fault->last_source = 0;
+  fault->last_trip_tick = 0;
+
+  cmp_default_para_init(&cmp_init_struct);
+  cmp_init_struct.cmp_polarity = CMP_POL_NON_INVERTING;
+  cmp_init_struct.cmp_speed = CMP_SPEED_FAST;
+
+  if(cfg->limit_enable == TRUE)
+  {
+    cmp_init_struct.cmp_non_inverting = cfg->limit_input;
+    cmp_init_struct.cmp_inverting = cfg->limit_level;
+    cmp_init_struct.cmp_output = CMP_OUTPUT_TMR1CHCLR;
+    cmp_init_struct.cmp_hysteresis = cfg->limit_hysteresis;
+    cmp_init(cfg->limit_cmp, &cmp_init_struct);
+    cmp_enable(cfg->limit_cmp, TRUE);
+
+    tmr_output_channel_switch_select(pwm_tmr, TMR_CH_SWITCH_SELECT_CXORAW_OFF);
+    for(channel = 0; channel < 4; channel++)
+    {
+      if(cfg->limit_channels & (1 << channel))
+      {
+        tmr_output_channel_switch_set(pwm_tmr, (tmr_channel_select_type)(TMR_SELECT_CHANNEL_1 + channel * 2), TRUE);
+      }
+    }
+
+    exint_default_para_init(&exint_init_struct);
+    exint_init_struct.line_enable = TRUE;
+    exint_init_struct.line_mode = EXINT_LINE_INTERRUPT;
+    exint_init_struct.line_select = fault_exint_line(cfg->limit_cmp);
+    exint_init_struct.line_polarity = EXINT_TRIGGER_RISING_EDGE;
+    exint_init(&exint_init_struct);
+    exint_flag_clear(fault_exint_line(cfg->limit_cmp));
+  }
+
+  if(cfg->trip_enable == TRUE)
+  {
+    cmp_init_struct.cmp_non_inverting = cfg->trip_input;
+    cmp_init_struct.cmp_inverting = cfg->trip_level;
+    cmp_init_struct.cmp_output = CMP_OUTPUT_TMR1BRK;
+    cmp_init_struct.cmp_hysteresis = CMP_HYSTERESIS_NONE;
+    cmp_init(cfg->trip_cmp, &cmp_init_struct);
+    cmp_enable(cfg->trip_cmp, TRUE);
+  }
+
+  /* only the break bits, the dead time is the motor control's */
+  pwm_tmr->brk_bit.brkv = cfg->brk_polarity;
+  pwm_tmr->brk_bit.aoen = FALSE;
+  pwm_tmr->brk_bit.brken = TRUE;
+
+  tmr_interrupt_enable(pwm_tmr, TMR_OVF_INT, FALSE);
+  tmr_flag_clear(pwm_tmr, TMR_BRK_FLAG);
+  tmr_interrupt_enable(pwm_tmr, TMR_BRK_INT, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  raise a fault from software, e.g. over temperature or under
+  *         voltage. the software break turns the outputs off at once and the
+  *         break interrupt handles it like any other trip.
+  * @param  fault: the fault manager
+  * @param  source: FAULT_SOURCE_SOFTWARE or application bits above it
+  * @retval none
+  */
+void fault_report(fault_type *fault, uint32_t source)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if(fault->state == FAULT_STATE_TRIPPED || fault->state == FAULT_STATE_LOCKED)
+  {
+    fault->last_source |= source;
+  }
+  else
+  {
+    fault->pending_source |= source;
+    tmr_event_sw_trigger(fault->pwm_tmr, TMR_BRK_SWTRIG);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  leave the lockout. the retries start over and the outputs come
+  *         back at the next tick when the break input is inactive.
+  * @param  fault: the fault manager
+  * @retval SUCCESS or ERROR when not locked
+  */
+error_status fault_clear(fault_type *fault)
+{
+  uint32_t primask;
+  error_status status = ERROR;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if(fault->state == FAULT_STATE_LOCKED)
+  {
+    fault->retries = 0;
+    fault->retry_delay = fault->cfg.retry_delay;
+    fault->countdown = 1;
+    fault->state = FAULT_STATE_TRIPPED;
+    status = SUCCESS;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  limit comparator edge, called from CMP1_IRQHandler or
+  *         CMP2_IRQHandler. the first edge of a period starts the per period
+  *         accounting on the TMR1 overflow.
+  * @param  fault: the fault manager
+  * @retval none
+  */
+void fault_limit_irq_handler(fault_type *fault)
+{
+  uint32_t line = fault_exint_line(fault->cfg.limit_cmp);
+
+  if(exint_interrupt_flag_get(line) == RESET)
+  {
+    return;
+  }
+  exint_flag_clear(line);
+  fault->limit_events++;
+
+  if(fault->state == FAULT_STATE_ARMED)
+  {
+    tmr_flag_clear(fault->pwm_tmr, TMR_OVF_FLAG);
+    tmr_interrupt_enable(fault->pwm_tmr, TMR_OVF_INT, TRUE);
+    fault->state = FAULT_STATE_LIMITING;
+  }
+  if(fault->state == FAULT_STATE_LIMITING)
+  {
+    fault->limited = 1;
+  }
+}
+
+/**
+  * @brief  end of a pwm period while limiting, called from
+  *         TMR1_OVF_TMR10_IRQHandler. a comparator still high at the overflow
+  *         limits the next period too without a new edge. a period without
+  *         limit stops the accounting until the next edge, limit_cycles_max
+  *         limited periods in a row raise a trip.
+  * @param  fault: the fault manager
+  * @retval none
+  */
+void fault_cycle_irq_handler(fault_type *fault)
+{
+  uint8_t high;
+
+  if(tmr_interrupt_flag_get(fault->pwm_tmr, TMR_OVF_FLAG) == RESET)
+  {
+    return;
+  }
+  tmr_flag_clear(fault->pwm_tmr, TMR_OVF_FLAG);
+
+  if(fault->state != FAULT_STATE_LIMITING)
+  {
+    tmr_interrupt_enable(fault->pwm_tmr, TMR_OVF_INT, FALSE);
+    return;
+  }
+
+  high = (cmp_output_value_get(fault->cfg.limit_cmp) != 0);
+  if(fault->limited == 0 && high == 0)
+  {
+    fault->limit_run = 0;
+    fault->state = FAULT_STATE_ARMED;
+    tmr_interrupt_enable(fault->pwm_tmr, TMR_OVF_INT, FALSE);
+    return;
+  }
+
+  fault->limited = high;
+  fault->limit_cycles++;
+  fault->limit_run++;
+  if(fault->limit_run > fault->limit_run_max)
+  {
+    fault->limit_run_max = fault->limit_run;
+  }
+  if(fault->cfg.limit_cycles_max != 0 && fault->limit_run >= fault->cfg.limit_cycles_max)
+  {
+    fault->pending_source |= FAULT_SOURCE_LIMIT;
+    tmr_event_sw_trigger(fault->pwm_tmr, TMR_BRK_SWTRIG);
+  }
+}
+
+/**
+  * @brief  break, called from TMR1_BRK_TMR9_IRQHandler. the outputs are off
+  *         already. the break interrupt stays off until the retry, its flag
+  *         cannot be cleared while the input is active.
+  * @param  fault: the fault manager
+  * @retval none
+  */
+void fault_break_irq_handler(fault_type *fault)
+{
+  if(tmr_interrupt_flag_get(fault->pwm_tmr, TMR_BRK_FLAG) == RESET)
+  {
+    return;
+  }
+  tmr_interrupt_enable(fault->pwm_tmr, TMR_BRK_INT, FALSE);
+  tmr_flag_clear(fault->pwm_tmr, TMR_BRK_FLAG);
+
+  fault_trip(fault, fault_break_source(fault));
+}
+
+/**
+  * @brief  time base of the retries, called every millisecond, e.g. from
+  *         SysTick_Handler at a lower priority than the TMR1 interrupts.
+  * @param  fault: the fault manager
+  * @retval none
+  */
+void fault_tick_handler(fault_type *fault)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  fault->tick++;
+  if(fault->state == FAULT_STATE_TRIPPED)
+  {
+    if(--fault->countdown == 0)
+    {
+      fault_retry(fault);
+    }
+  }
+  else if(fault->state != FAULT_STATE_LOCKED && fault->retries != 0)
+  {
+    /* a clean run forgives the trips before it */
+    if(++fault->run_ticks >= fault->cfg.retry_reset)
+    {
+      fault->retries = 0;
+      fault->retry_delay = fault->cfg.retry_delay;
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
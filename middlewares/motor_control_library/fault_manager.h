@@ -0,0 +1,173 @@
+/**
+  **************************************************************************
+  * @file     fault_manager.h
+  * @brief    current limit and fault management library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FAULT_MANAGER_H
+#define __FAULT_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup FAULT_library_definition
+  * @{
+  */
+
+/**
+  * @brief the protection itself needs no software: the limit comparator
+  *        clears the TMR1 channel outputs until the next period and the trip
+  *        comparator, the TMR1_BRK pin or a software break turns every output
+  *        off through the break input. the interrupts only count, decide and
+  *        retry. give the break interrupt the highest priority, then the
+  *        TMR1 overflow, then the limit comparator. call fault_init after the
+  *        motor control init, it keeps the timer setup and adds the output
+  *        switch and break bits.
+  */
+
+/**
+  * @brief fault sources
+  */
+#define FAULT_SOURCE_OVERCURRENT         ((uint32_t)0x00000001) /*!< trip comparator */
+#define FAULT_SOURCE_BREAK_PIN           ((uint32_t)0x00000002) /*!< TMR1_BRK pin */
+#define FAULT_SOURCE_LIMIT               ((uint32_t)0x00000004) /*!< limit held for limit_cycles_max periods */
+#define FAULT_SOURCE_SOFTWARE            ((uint32_t)0x00000008) /*!< fault_report */
+
+/**
+  * @}
+  */
+
+/** @defgroup FAULT_library_handler
+  * @{
+  */
+
+/**
+  * @brief protection state
+  */
+typedef enum
+{
+  FAULT_STATE_ARMED                      = 0x00, /*!< outputs allowed, no limit this period */
+  FAULT_STATE_LIMITING                   = 0x01, /*!< the limit comparator cuts periods short */
+  FAULT_STATE_TRIPPED                    = 0x02, /*!< outputs off, waiting for the retry */
+  FAULT_STATE_LOCKED                     = 0x03  /*!< outputs off until fault_clear */
+} fault_state_type;
+
+/**
+  * @brief events given to the event handler
+  */
+typedef enum
+{
+  FAULT_EVENT_TRIP                       = 0x00, /*!< outputs turned off, a retry follows */
+  FAULT_EVENT_RETRY                      = 0x01, /*!< outputs about to be turned on again */
+  FAULT_EVENT_LOCKOUT                    = 0x02  /*!< retries used up, outputs stay off */
+} fault_event_type;
+
+/**
+  * @brief configuration, filled with fault_default_para_init. the delays
+  *        are in calls of fault_tick_handler, one per millisecond.
+  */
+typedef struct
+{
+  confirm_state                          limit_enable;            /*!< cycle by cycle current limit    */
+  cmp_sel_type                           limit_cmp;               /*!< comparator of the limit         */
+  cmp_non_inverting_type                 limit_input;             /*!< current sense of the limit      */
+  cmp_inverting_type                     limit_level;             /*!< limit threshold                 */
+  cmp_hysteresis_type                    limit_hysteresis;        /*!< limit comparator hysteresis     */
+  uint8_t                                limit_channels;          /*!< bit 0..3: TMR1 channel 1..4 cleared */
+  uint16_t                               limit_cycles_max;        /*!< limited periods in a row to trip, 0 never */
+  confirm_state                          trip_enable;             /*!< overcurrent trip                */
+  cmp_sel_type                           trip_cmp;                /*!< comparator of the trip          */
+  cmp_non_inverting_type                 trip_input;              /*!< current sense of the trip       */
+  cmp_inverting_type                     trip_level;              /*!< trip threshold                  */
+  tmr_brk_polarity_type                  brk_polarity;            /*!< active level of the break input */
+  uint16_t                               retry_delay;             /*!< first retry after a trip        */
+  uint16_t                               retry_delay_max;         /*!< the delay doubles up to this    */
+  uint8_t                                retry_max;               /*!< trips in a row before lockout   */
+  uint16_t                               retry_reset;             /*!< clean run that clears the count */
+  void                                   (*event_handler)(fault_event_type event, uint32_t source); /*!< may be NULL */
+} fault_config_type;
+
+/**
+  * @brief fault manager and its telemetry
+  */
+typedef struct
+{
+  tmr_type                               *pwm_tmr;                /*!< TMR1                            */
+  fault_config_type                      cfg;                     /*!< configuration                   */
+  __IO fault_state_type                  state;                   /*!< protection state                */
+  __IO uint8_t                           limited;                 /*!< limit seen in this period       */
+  __IO uint32_t                          pending_source;          /*!< software break being raised     */
+  uint8_t                                retries;                 /*!< trips since the last clean run  */
+  uint16_t                               retry_delay;             /*!< delay of the next retry         */
+  uint16_t                               countdown;               /*!< ticks to the retry              */
+  uint16_t                               run_ticks;               /*!< ticks since the last retry      */
+  __IO uint32_t                          tick;                    /*!< ticks since init                */
+  __IO uint32_t                          limit_events;            /*!< limit comparator edges          */
+  __IO uint32_t                          limit_cycles;            /*!< periods cut by the limit        */
+  __IO uint16_t                          limit_run;               /*!< limited periods in a row        */
+  __IO uint16_t                          limit_run_max;           /*!< longest run of limited periods  */
+  __IO uint32_t                          trip_count;              /*!< trips                           */
+  __IO uint32_t                          retry_count;             /*!< retries done                    */
+  __IO uint32_t                          lockout_count;           /*!< lockouts                        */
+  __IO uint32_t                          last_source;             /*!< source of the last trip         */
+  __IO uint32_t                          last_trip_tick;          /*!< tick of the last trip           */
+} fault_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup FAULT_library_exported_functions
+  * @{
+  */
+
+void              fault_default_para_init       (fault_config_type *cfg);
+error_status      fault_init                    (fault_type *fault, tmr_type *pwm_tmr, const fault_config_type *cfg);
+void              fault_report                  (fault_type *fault, uint32_t source);
+error_status      fault_clear                   (fault_type *fault);
+void              fault_limit_irq_handler       (fault_type *fault);
+void              fault_cycle_irq_handler       (fault_type *fault);
+void              fault_break_irq_handler       (fault_type *fault);
+void              fault_tick_handler            (fault_type *fault);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,641 @@
+/**
+  **************************************************************************
+  * @file     foc_control.c
+  * @brief    field oriented control library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "foc_control.h"
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup FOC_library
+  * @brief field oriented control
+  * @{
+  */
+
+/** @defgroup FOC_private_definition
+  * @{
+  */
+
+/* 1 / sqrt(3) and sqrt(3) / 2 in q15 */
+#define FOC_INV_SQRT3                    18919
+#define FOC_SQRT3_DIV2                   28378
+
+/**
+  * @brief sine of a full turn in 256 steps and the first step again, q15
+  */
+static const int16_t foc_sin_table[257] =
+{
+       0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+    6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+   12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+   18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+   23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+   27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+   30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+   32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+   32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+   32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+   30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+   27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+   23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+   18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+   12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+    6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+       0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+   -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+  -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+  -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+  -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+  -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+  -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+  -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+  -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+  -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+  -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+  -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+  -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+  -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+  -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+   -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+       0
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup FOC_private_functions
+  * @{
+  */
+
+/**
+  * @brief  integer square root, used for the q axis voltage limit.
+  * @param  value: radicand
+  * @retval square root rounded down
+  */
+static uint32_t foc_sqrt(uint32_t value)
+{
+  uint32_t root = 0, bit = 1UL << 30;
+
+  while(bit > value)
+  {
+    bit >>= 2;
+  }
+  while(bit != 0)
+  {
+    if(value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+/**
+  * @brief  run a pi controller for one period. the integrator stops while the
+  *         output is limited in the direction of the error and is kept inside
+  *         the limit, so a limit that shrinks does not leave it wound up.
+  * @param  pi: the controller
+  * @param  error: reference minus measurement
+  * @param  limit: output magnitude limit, q15
+  * @retval controller output, q15
+  */
+static int32_t foc_pi_run(foc_pi_type *pi, int32_t error, int32_t limit)
+{
+  int32_t integral, out;
+
+  error = __SSAT(error, 16);
+  integral = __QADD(pi->integral, error * pi->ki * 2);
+  out = ((error * pi->kp) >> (15 - pi->kp_shift)) + (integral >> 16);
+
+  if(out > limit)
+  {
+    out = limit;
+    if(error > 0)
+    {
+      integral = pi->integral;
+    }
+  }
+  else if(out < -limit)
+  {
+    out = -limit;
+    if(error < 0)
+    {
+      integral = pi->integral;
+    }
+  }
+
+  if(integral > (limit << 16))
+  {
+    integral = limit << 16;
+  }
+  else if(integral < -(limit << 16))
+  {
+    integral = -(limit << 16);
+  }
+  pi->integral = integral;
+
+  return out;
+}
+
+/**
+  * @brief  read the phase currents of the last conversion. the phase with the
+  *         highest duty had the shortest low switch time around the sample,
+  *         it is rebuilt from the other two.
+  * @param  foc: the control loop
+  * @retval none
+  */
+static void foc_current_read(foc_type *foc)
+{
+  int32_t sum = 0;
+  uint8_t phase;
+
+  for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+  {
+    /* right aligned data minus the preempt offset, sign extended */
+    int32_t value = (int16_t)adc_preempt_conversion_data_get(foc->adc, (adc_preempt_channel_type)phase);
+
+    if(phase != foc->skip_phase)
+    {
+      foc->i_abc[phase] = (foc_q15_type)__SSAT(value << 4, 16);
+      sum += foc->i_abc[phase];
+    }
+  }
+  foc->i_abc[foc->skip_phase] = (foc_q15_type)__SSAT(-sum, 16);
+}
+
+/**
+  * @brief  write the duty of the three phases, the timer loads them at the
+  *         next overflow. the channels run pwm mode b so the high switch is on
+  *         around the top of the count.
+  * @param  foc: the control loop
+  * @retval none
+  */
+static void foc_duty_apply(foc_type *foc)
+{
+  uint16_t period = foc->cfg.period;
+
+  foc->pwm_tmr->c1dt = period - foc->duty[0];
+  foc->pwm_tmr->c2dt = period - foc->duty[1];
+  foc->pwm_tmr->c3dt = period - foc->duty[2];
+}
+
+/**
+  * @brief  clear the controllers and center every phase.
+  * @param  foc: the control loop
+  * @retval none
+  */
+static void foc_reset(foc_type *foc)
+{
+  uint8_t phase;
+
+  foc->pi_d.integral = 0;
+  foc->pi_q.integral = 0;
+  foc->v_d = 0;
+  foc->v_q = 0;
+  foc->skip_phase = 0;
+  for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+  {
+    foc->i_abc[phase] = 0;
+    foc->duty[phase] = foc->cfg.period >> 1;
+  }
+  foc_duty_apply(foc);
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup FOC_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  fill a configuration with the defaults: 20 khz center aligned pwm
+  *         from a 144 mhz timer clock, 0.5 us dead time, shunts on adc channel
+  *         0/1/2.
+  * @param  cfg: configuration to fill
+  * @retval none
+  */
+void foc_default_para_init(foc_config_type *cfg)
+{
+  cfg->period = 3600;
+  cfg->deadtime = 72;
+  cfg->adc_channel[0] = ADC_CHANNEL_0;
+  cfg->adc_channel[1] = ADC_CHANNEL_1;
+  cfg->adc_channel[2] = ADC_CHANNEL_2;
+  cfg->adc_sampletime = ADC_SAMPLETIME_7_5;
+  cfg->kp = 16384;
+  cfg->ki = 655;
+  cfg->kp_shift = 1;
+  cfg->v_max = 31129;
+}
+
+/**
+  * @brief  initialize the pwm timer and the adc for the control loop. the
+  *         timer starts counting with the outputs off, every overflow at the
+  *         bottom of the count converts the three shunts as preempt channels.
+  * @param  foc: the control loop
+  * @param  pwm_tmr: TMR1, the only timer whose TRGOUT starts adc1 preempt
+  *         conversions
+  * @param  adc: ADC1
+  * @param  cfg: configuration
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status foc_init(foc_type *foc, tmr_type *pwm_tmr, adc_type *adc, const foc_config_type *cfg)
+{
+  tmr_output_config_type tmr_output_struct;
+  tmr_brkdt_config_type tmr_brkdt_struct;
+  adc_base_config_type adc_base_struct;
+  uint8_t phase;
+
+  if(pwm_tmr != TMR1 || cfg->period < 2 || cfg->kp_shift > 15 || cfg->v_max <= 0)
+  {
+    return ERROR;
+  }
+
+  foc->pwm_tmr = pwm_tmr;
+  foc->adc = adc;
+  foc->cfg = *cfg;
+  foc->state = FOC_STATE_STOP;
+  foc->pi_d.kp = cfg->kp;
+  foc->pi_d.ki = cfg->ki;
+  foc->pi_d.kp_shift = cfg->kp_shift;
+  foc->pi_q = foc->pi_d;
+  foc->id_ref = 0;
+  foc->iq_ref = 0;
+  foc->theta = 0;
+  foc->theta_step = 0;
+  foc->cycles_last = 0;
+  foc->cycles_max = 0;
+  foc->period_count = 0;
+
+  /* center aligned with an overflow event every second turn of the count.
+     the repetition counter is set before tmr_base_init so that its software
+     overflow loads 1 with the counter at 0: the top of the count is skipped
+     and every overflow event falls at the bottom, where every low switch
+     conducts */
+  tmr_cnt_dir_set(pwm_tmr, TMR_COUNT_TWO_WAY_1);
+  tmr_repetition_counter_set(pwm_tmr, 1);
+  tmr_base_init(pwm_tmr, cfg->period, 0);
+  tmr_period_buffer_enable(pwm_tmr, TRUE);
+
+  tmr_output_default_para_init(&tmr_output_struct);
+  tmr_output_struct.oc_mode = TMR_OUTPUT_CONTROL_PWM_MODE_B;
+  tmr_output_struct.oc_output_state = TRUE;
+  tmr_output_struct.oc_polarity = TMR_OUTPUT_ACTIVE_HIGH;
+  tmr_output_struct.oc_idle_state = FALSE;
+  tmr_output_struct.occ_output_state = TRUE;
+  tmr_output_struct.occ_polarity = TMR_OUTPUT_ACTIVE_HIGH;
+  tmr_output_struct.occ_idle_state = FALSE;
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_1, &tmr_output_struct);
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_2, &tmr_output_struct);
+  tmr_output_channel_config(pwm_tmr, TMR_SELECT_CHANNEL_3, &tmr_output_struct);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_1, TRUE);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_2, TRUE);
+  tmr_output_channel_buffer_enable(pwm_tmr, TMR_SELECT_CHANNEL_3, TRUE);
+  foc_reset(foc);
+
+  tmr_brkdt_default_para_init(&tmr_brkdt_struct);
+  tmr_brkdt_struct.deadtime = cfg->deadtime;
+  tmr_brkdt_struct.fcsoen_state = TRUE;
+  tmr_brkdt_struct.fcsodis_state = TRUE;
+  tmr_brkdt_config(pwm_tmr, &tmr_brkdt_struct);
+  tmr_output_enable(pwm_tmr, FALSE);
+
+  tmr_primary_mode_select(pwm_tmr, TMR_PRIMARY_SEL_OVERFLOW);
+
+  /* the shunts of phase a/b/c in preempt channel 1/2/3 */
+  adc_base_default_para_init(&adc_base_struct);
+  adc_base_struct.sequence_mode = TRUE;
+  adc_base_struct.repeat_mode = FALSE;
+  adc_base_struct.data_align = ADC_RIGHT_ALIGNMENT;
+  adc_base_struct.ordinary_channel_length = 1;
+  adc_base_config(adc, &adc_base_struct);
+  adc_preempt_channel_length_set(adc, FOC_PHASE_COUNT);
+  for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+  {
+    adc_preempt_channel_set(adc, cfg->adc_channel[phase], phase + 1, cfg->adc_sampletime);
+    adc_preempt_offset_value_set(adc, (adc_preempt_channel_type)phase, 0);
+  }
+  adc_preempt_conversion_trigger_set(adc, ADC12_PREEMPT_TRIG_TMR1TRGOUT, TRUE);
+  adc_flag_clear(adc, ADC_PCCE_FLAG);
+  adc_interrupt_enable(adc, ADC_PCCE_INT, TRUE);
+  adc_enable(adc, TRUE);
+
+  adc_calibration_init(adc);
+  while(adc_calibration_init_status_get(adc));
+  adc_calibration_start(adc);
+  while(adc_calibration_status_get(adc));
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  tmr_counter_enable(pwm_tmr, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  start the control loop. the current offsets are measured with the
+  *         outputs off first, then the outputs are enabled with the current
+  *         loops closed.
+  * @param  foc: the control loop
+  * @retval none
+  */
+void foc_start(foc_type *foc)
+{
+  uint8_t phase;
+
+  if(foc->state != FOC_STATE_STOP)
+  {
+    return;
+  }
+
+  for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+  {
+    adc_preempt_offset_value_set(foc->adc, (adc_preempt_channel_type)phase, 0);
+    foc->offset_sum[phase] = 0;
+  }
+  foc->calibrate_count = 0;
+  foc->state = FOC_STATE_CALIBRATE;
+}
+
+/**
+  * @brief  stop the control loop, every switch off.
+  * @param  foc: the control loop
+  * @retval none
+  */
+void foc_stop(foc_type *foc)
+{
+  tmr_output_enable(foc->pwm_tmr, FALSE);
+  foc->state = FOC_STATE_STOP;
+  foc_reset(foc);
+}
+
+/**
+  * @brief  set the current references.
+  * @param  foc: the control loop
+  * @param  id_ref: flux current, q15
+  * @param  iq_ref: torque current, q15
+  * @retval none
+  */
+void foc_current_set(foc_type *foc, foc_q15_type id_ref, foc_q15_type iq_ref)
+{
+  foc->id_ref = id_ref;
+  foc->iq_ref = iq_ref;
+}
+
+/**
+  * @brief  set the rotor angle. a position sensor calls it with a step of 0
+  *         before every period, an open loop start sets the step once and the
+  *         angle advances by it every period.
+  * @param  foc: the control loop
+  * @param  theta: electrical angle, 65536 is a turn
+  * @param  theta_step: angle added after every period
+  * @retval none
+  */
+void foc_angle_set(foc_type *foc, foc_angle_type theta, int16_t theta_step)
+{
+  foc->theta = theta;
+  foc->theta_step = theta_step;
+}
+
+/**
+  * @brief  sine and cosine of an angle, linear between the 256 table steps.
+  * @param  theta: electrical angle, 65536 is a turn
+  * @param  sin_val: sine, q15
+  * @param  cos_val: cosine, q15
+  * @retval none
+  */
+void foc_sin_cos(foc_angle_type theta, foc_q15_type *sin_val, foc_q15_type *cos_val)
+{
+  uint32_t index = theta >> 8, frac = theta & 0xFF;
+  int32_t value;
+
+  value = foc_sin_table[index];
+  *sin_val = (foc_q15_type)(value + (((foc_sin_table[index + 1] - value) * (int32_t)frac) >> 8));
+
+  index = ((theta + 0x4000) & 0xFFFF) >> 8;
+  value = foc_sin_table[index];
+  *cos_val = (foc_q15_type)(value + (((foc_sin_table[index + 1] - value) * (int32_t)frac) >> 8));
+}
+
+/**
+  * @brief  one period of the control loop from the phase currents in i_abc:
+  *         clarke and park transforms, d and q current controllers, voltage
+  *         limit, inverse park and space vector modulation into duty. the
+  *         dual 16-bit multiply accumulate instructions do each rotation in
+  *         two multiplies.
+  * @param  foc: the control loop
+  * @retval none
+  */
+void foc_compute(foc_type *foc)
+{
+  foc_q15_type sin_val, cos_val;
+  uint32_t rot, rot_swap, pair;
+  int32_t v_a, v_b, v_c, v_max, v_min, offset, limit, gain, duty;
+  uint8_t phase, skip;
+
+  /* clarke, the three currents sum to zero */
+  foc->i_alpha = foc->i_abc[0];
+  foc->i_beta = (foc_q15_type)__SSAT(((foc->i_abc[1] - foc->i_abc[2]) * FOC_INV_SQRT3) >> 15, 16);
+
+  /* park: d = alpha cos + beta sin, q = beta cos - alpha sin */
+  foc_sin_cos(foc->theta, &sin_val, &cos_val);
+  rot = __PKHBT((uint16_t)cos_val, (uint32_t)sin_val, 16);
+  rot_swap = __PKHBT((uint16_t)sin_val, (uint32_t)cos_val, 16);
+  pair = __PKHBT((uint16_t)foc->i_alpha, (uint32_t)foc->i_beta, 16);
+  foc->i_d = (foc_q15_type)__SSAT((int32_t)__SMUAD(pair, rot) >> 15, 16);
+  pair = __PKHBT((uint16_t)foc->i_beta, (uint32_t)foc->i_alpha, 16);
+  foc->i_q = (foc_q15_type)__SSAT((int32_t)__SMUSD(pair, rot) >> 15, 16);
+
+  /* d first, q gets what is left of the voltage circle */
+  limit = foc->cfg.v_max;
+  foc->v_d = (foc_q15_type)foc_pi_run(&foc->pi_d, foc->id_ref - foc->i_d, limit);
+  limit = (int32_t)foc_sqrt((uint32_t)(limit * limit - foc->v_d * foc->v_d));
+  foc->v_q = (foc_q15_type)foc_pi_run(&foc->pi_q, foc->iq_ref - foc->i_q, limit);
+
+  /* inverse park: alpha = d cos - q sin, beta = d sin + q cos */
+  pair = __PKHBT((uint16_t)foc->v_d, (uint32_t)foc->v_q, 16);
+  foc->v_alpha = (foc_q15_type)__SSAT((int32_t)__SMUSD(pair, rot) >> 15, 16);
+  foc->v_beta = (foc_q15_type)__SSAT((int32_t)__SMUAD(pair, rot_swap) >> 15, 16);
+
+  /* phase voltages with the mid point of the highest and lowest added, the
+     same modulation as the symmetric space vector sequence */
+  v_a = foc->v_alpha;
+  v_b = (foc->v_beta * FOC_SQRT3_DIV2 - foc->v_alpha * 16384) >> 15;
+  v_c = -v_a - v_b;
+  v_max = v_a > v_b ? v_a : v_b;
+  v_max = v_max > v_c ? v_max : v_c;
+  v_min = v_a < v_b ? v_a : v_b;
+  v_min = v_min < v_c ? v_min : v_c;
+  offset = -((v_max + v_min) >> 1);
+
+  /* a phase voltage of 1.0 is vdc / sqrt(3), half a period of duty is vdc / 2 */
+  gain = (foc->cfg.period * FOC_INV_SQRT3) >> 15;
+  skip = 0;
+  for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+  {
+    int32_t v = (phase == 0) ? v_a : ((phase == 1) ? v_b : v_c);
+
+    duty = (foc->cfg.period >> 1) + (((v + offset) * gain) >> 15);
+    if(duty < 0)
+    {
+      duty = 0;
+    }
+    else if(duty > foc->cfg.period)
+    {
+      duty = foc->cfg.period;
+    }
+    foc->duty[phase] = (uint16_t)duty;
+    if(foc->duty[phase] > foc->duty[skip])
+    {
+      skip = phase;
+    }
+  }
+  foc->skip_phase = skip;
+
+  foc->theta += foc->theta_step;
+}
+
+/**
+  * @brief  measure the control loop without the hardware: foc_compute runs
+  *         on a rotating current vector with the outputs off. the controller
+  *         state and angle are restored after.
+  * @param  foc: the control loop, stopped
+  * @param  count: periods to run
+  * @retval mean cycles of a period, 0 when the loop is not stopped
+  */
+uint32_t foc_benchmark(foc_type *foc, uint32_t count)
+{
+  foc_pi_type pi_d = foc->pi_d, pi_q = foc->pi_q;
+  foc_angle_type theta = foc->theta;
+  int16_t theta_step = foc->theta_step;
+  foc_q15_type sin_val, cos_val;
+  uint32_t index, start, total = 0;
+
+  if(foc->state != FOC_STATE_STOP || count == 0)
+  {
+    return 0;
+  }
+
+  foc->theta_step = 0x0100;
+  for(index = 0; index < count; index++)
+  {
+    foc_sin_cos(foc->theta, &sin_val, &cos_val);
+    foc->i_abc[0] = sin_val >> 2;
+    foc->i_abc[1] = (-(sin_val >> 1) - ((cos_val * FOC_SQRT3_DIV2) >> 15)) >> 2;
+    foc->i_abc[2] = -foc->i_abc[0] - foc->i_abc[1];
+
+    start = FOC_CYCLE_COUNT();
+    foc_compute(foc);
+    total += FOC_CYCLE_COUNT() - start;
+  }
+
+  foc->pi_d = pi_d;
+  foc->pi_q = pi_q;
+  foc->theta = theta;
+  foc->theta_step = theta_step;
+  foc_reset(foc);
+
+  return total / count;
+}
+
+/**
+  * @brief  adc preempt conversion end, called from ADC1_IRQHandler once per
+  *         pwm period. the cycles from entry to the new duty are kept in
+  *         cycles_last and cycles_max, to be read against the pwm period on
+  *         the target.
+  * @param  foc: the control loop
+  * @retval none
+  */
+void foc_adc_irq_handler(foc_type *foc)
+{
+  uint32_t start = FOC_CYCLE_COUNT(), cycles;
+  uint8_t phase;
+
+  if(adc_interrupt_flag_get(foc->adc, ADC_PCCE_FLAG) == RESET)
+  {
+    return;
+  }
+  adc_flag_clear(foc->adc, ADC_PCCE_FLAG);
+
+  switch(foc->state)
+  {
+    case FOC_STATE_CALIBRATE:
+      for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+      {
+        foc->offset_sum[phase] += adc_preempt_conversion_data_get(foc->adc, (adc_preempt_channel_type)phase);
+      }
+      if(++foc->calibrate_count < FOC_CALIBRATE_COUNT)
+      {
+        return;
+      }
+      /* the adc subtracts the offsets from now on */
+      for(phase = 0; phase < FOC_PHASE_COUNT; phase++)
+      {
+        adc_preempt_offset_value_set(foc->adc, (adc_preempt_channel_type)phase,
+                                     (uint16_t)((foc->offset_sum[phase] + FOC_CALIBRATE_COUNT / 2) / FOC_CALIBRATE_COUNT));
+      }
+      foc_reset(foc);
+      foc->state = FOC_STATE_RUN;
+      tmr_output_enable(foc->pwm_tmr, TRUE);
+      return;
+    case FOC_STATE_RUN:
+      foc_current_read(foc);
+      foc_compute(foc);
+      foc_duty_apply(foc);
+      break;
+    default:
+      return;
+  }
+
+  cycles = FOC_CYCLE_COUNT() - start;
+  foc->cycles_last = cycles;
+  if(cycles > foc->cycles_max)
+  {
+    foc->cycles_max = cycles;
+  }
+  foc->period_count++;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,181 @@
+/**
+  **************************************************************************
+  * @file     foc_control.h
+  * @brief    field oriented control library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FOC_CONTROL_H
+#define __FOC_CONTROL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_motor_control_library
+  * @{
+  */
+
+/** @defgroup FOC_library_definition
+  * @{
+  */
+
+/**
+  * @brief fixed point formats. currents and voltages are q15, 1.0 of a
+  *        current is the full scale of the shunt amplifier, 1.0 of a voltage
+  *        is the largest linear space vector, vdc / sqrt(3). the electrical
+  *        angle is an unsigned 16-bit fraction of a turn.
+  */
+typedef int16_t foc_q15_type;
+typedef uint16_t foc_angle_type;
+
+/**
+  * @brief the pwm timer counts up and down, its overflow event is kept at the
+  *        bottom of the count by a repetition counter of 1 and starts the adc
+  *        preempt conversions of the three phase currents through TRGOUT.
+  *        FOC_CALIBRATE_COUNT conversions with the outputs off give the
+  *        current offsets at start.
+  */
+#define FOC_PHASE_COUNT                  3
+#ifndef FOC_CALIBRATE_COUNT
+#define FOC_CALIBRATE_COUNT              64
+#endif
+
+/**
+  * @brief free running cycle counter used for the control loop statistics
+  */
+#ifndef FOC_CYCLE_COUNT
+#define FOC_CYCLE_COUNT()                (DWT->CYCCNT)
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup FOC_library_handler
+  * @{
+  */
+
+/**
+  * @brief control state
+  */
+typedef enum
+{
+  FOC_STATE_STOP                         = 0x00, /*!< outputs off */
+  FOC_STATE_CALIBRATE                    = 0x01, /*!< outputs off, current offsets measured */
+  FOC_STATE_RUN                          = 0x02  /*!< current loops closed */
+} foc_state_type;
+
+/**
+  * @brief pi controller, out = (e * kp) >> (15 - kp_shift) + integral >> 16
+  */
+typedef struct
+{
+  int16_t                                kp;                      /*!< proportional gain, q15          */
+  int16_t                                ki;                      /*!< integral gain per period, q15   */
+  uint8_t                                kp_shift;                /*!< proportional gain scale, 0..15  */
+  int32_t                                integral;                /*!< integrator, q31                 */
+} foc_pi_type;
+
+/**
+  * @brief configuration, filled with foc_default_para_init
+  */
+typedef struct
+{
+  uint16_t                               period;                  /*!< half pwm period in timer ticks  */
+  uint8_t                                deadtime;                /*!< pwm timer dead time register    */
+  adc_channel_select_type                adc_channel[FOC_PHASE_COUNT]; /*!< shunt of phase a/b/c   */
+  adc_sampletime_select_type             adc_sampletime;          /*!< sample time of the shunts       */
+  int16_t                                kp;                      /*!< d and q proportional gain, q15  */
+  int16_t                                ki;                      /*!< d and q integral gain, q15      */
+  uint8_t                                kp_shift;                /*!< proportional gain scale         */
+  foc_q15_type                           v_max;                   /*!< voltage vector limit            */
+} foc_config_type;
+
+/**
+  * @brief control loop
+  */
+typedef struct
+{
+  tmr_type                               *pwm_tmr;                /*!< advanced timer on the bridge    */
+  adc_type                               *adc;                    /*!< adc sampling the shunts         */
+  foc_config_type                        cfg;                     /*!< configuration                   */
+  __IO foc_state_type                    state;                   /*!< control state                   */
+  foc_pi_type                            pi_d;                    /*!< flux current controller         */
+  foc_pi_type                            pi_q;                    /*!< torque current controller       */
+  __IO foc_q15_type                      id_ref;                  /*!< flux current reference          */
+  __IO foc_q15_type                      iq_ref;                  /*!< torque current reference        */
+  __IO foc_angle_type                    theta;                   /*!< electrical angle of the rotor   */
+  __IO int16_t                           theta_step;              /*!< angle advanced every period     */
+  foc_q15_type                           i_abc[FOC_PHASE_COUNT];  /*!< phase currents                  */
+  foc_q15_type                           i_alpha;                 /*!< stator current, alpha           */
+  foc_q15_type                           i_beta;                  /*!< stator current, beta            */
+  foc_q15_type                           i_d;                     /*!< rotor current, d                */
+  foc_q15_type                           i_q;                     /*!< rotor current, q                */
+  foc_q15_type                           v_d;                     /*!< rotor voltage, d                */
+  foc_q15_type                           v_q;                     /*!< rotor voltage, q                */
+  foc_q15_type                           v_alpha;                 /*!< stator voltage, alpha           */
+  foc_q15_type                           v_beta;                  /*!< stator voltage, beta            */
+  uint16_t                               duty[FOC_PHASE_COUNT];   /*!< high switch on time in ticks    */
+  uint8_t                                skip_phase;              /*!< phase with the shortest sample  */
+  uint32_t                               offset_sum[FOC_PHASE_COUNT]; /*!< calibration sums        */
+  uint16_t                               calibrate_count;         /*!< calibration conversions done    */
+  __IO uint32_t                          cycles_last;             /*!< cycles of the last period       */
+  __IO uint32_t                          cycles_max;              /*!< most cycles of a period         */
+  __IO uint32_t                          period_count;            /*!< control periods run             */
+} foc_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup FOC_library_exported_functions
+  * @{
+  */
+
+void              foc_default_para_init         (foc_config_type *cfg);
+error_status      foc_init                      (foc_type *foc, tmr_type *pwm_tmr, adc_type *adc, const foc_config_type *cfg);
+void              foc_start                     (foc_type *foc);
+void              foc_stop                      (foc_type *foc);
+void              foc_current_set               (foc_type *foc, foc_q15_type id_ref, foc_q15_type iq_ref);
+void              foc_angle_set                 (foc_type *foc, foc_angle_type theta, int16_t theta_step);
+void              foc_sin_cos                   (foc_angle_type theta, foc_q15_type *sin_val, foc_q15_type *cos_val);
+void              foc_compute                   (foc_type *foc);
+uint32_t          foc_benchmark                 (foc_type *foc, uint32_t count);
+void              foc_adc_irq_handler           (foc_type *foc);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
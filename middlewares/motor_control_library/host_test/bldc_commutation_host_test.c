@@ -0,0 +1,697 @@
+/**
+  **************************************************************************
+  * @file     bldc_commutation_host_test.c
+  * @brief    host test of the bldc six-step commutation
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs bldc_commutation with the real tmr, cmp and exint drivers against a
+ * model of the inverter and of a 4 pole pair motor with trapezoidal
+ * back-emf, in 1 us steps:
+ * - TMR1 takes the buffered step on the TMR2 channel 2 rising edge or on a
+ *   software hall event, TMR2 resets on the xor of the hall inputs or runs
+ *   free, CMP1 compares the floating phase against the neutral and sets
+ *   exint line 19, the freewheeling current of a phase just floated holds
+ *   the comparator for a while
+ * - interrupts run in priority order, with random masked stretches
+ * hall mode: commutation lag and angle, speed estimate, plugging into
+ * reverse, glitches on the hall inputs and a locked rotor. sensorless mode:
+ * the start in both directions closes the loop at the same time whatever
+ * duty the start asks for, the commutation angle and speed estimate in
+ * both directions, switching noise on the comparator and a locked rotor.
+ * configurations the open loop can not close with are rejected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "bldc_commutation.h"
+
+#define PWM_PERIOD                       3600
+#define POLE_PAIRS                       4
+#define VDC                              24.0
+#define RES                              0.5
+#define IND                              0.0005
+#define KE                               0.02
+#define INERTIA                          2e-5
+#define FRICTION                         2e-5
+#define COULOMB                          0.005
+#define FAN                              5e-7
+#define PI                               3.14159265358979
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+cmp_type host_cmp;
+exint_type host_exint;
+gpio_type host_gpioa;
+static tmr_type tmr1, tmr2;
+static bldc_type bldc;
+
+/* motor */
+static double theta, omega, current, demag_until;
+static int demag_level, locked, noise, glitches;
+static long now_us;
+
+/* outputs as taken by the last hall event */
+static uint32_t out_cm1, out_cm2, out_cctrl;
+static int c2_prev, cmp_prev, cmp_hyst;
+static uint8_t hall_prev, hall_glitch;
+static long glitch_until, masked_until, cmp_pend;
+
+/* commutation log */
+static int measure, bad_pattern;
+static long hall_edge, lag_min, lag_max, angle_n;
+static double angle_sum, angle_max;
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+/* write 0 to clear flags and interrupt enables the plain memory lacks */
+void tmr_flag_clear(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  tmr_x->ists &= ~tmr_flag;
+}
+
+flag_status tmr_interrupt_flag_get(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  return ((tmr_x->ists & tmr_flag) && (tmr_x->iden & tmr_flag)) ? SET : RESET;
+}
+
+void exint_flag_clear(uint32_t exint_line)
+{
+  host_exint.intsts &= ~exint_line;
+}
+
+flag_status exint_interrupt_flag_get(uint32_t exint_line)
+{
+  return (host_exint.intsts & host_exint.inten & exint_line) ? SET : RESET;
+}
+
+void crm_periph_reset(crm_periph_reset_type value, confirm_state new_state)
+{
+  (void)value;
+  (void)new_state;
+}
+
+/* normalized back-emf of phase a at an electrical angle */
+static double trapezoid(double deg)
+{
+  deg = fmod(deg, 360);
+  if(deg < 0)
+  {
+    deg += 360;
+  }
+  if(deg < 30)
+  {
+    return deg / 30;
+  }
+  if(deg < 150)
+  {
+    return 1;
+  }
+  if(deg < 210)
+  {
+    return 1 - (deg - 150) / 30;
+  }
+  if(deg < 330)
+  {
+    return -1;
+  }
+  return -1 + (deg - 330) / 30;
+}
+
+static double electrical_deg(void)
+{
+  double deg = fmod(theta * POLE_PAIRS * 180 / PI, 360);
+
+  return (deg < 0) ? deg + 360 : deg;
+}
+
+static double rpm_get(void)
+{
+  return omega * 60 / (2 * PI);
+}
+
+/* hall state of the rotor, in the order of the default hall table */
+static uint8_t hall_sensors(void)
+{
+  static const uint8_t step_hall[6] = {5, 1, 3, 2, 6, 4};
+  double deg = electrical_deg() - 30;
+
+  if(deg < 0)
+  {
+    deg += 360;
+  }
+  return step_hall[(int)(deg / 60) % 6];
+}
+
+/* drive of a phase from the outputs: 0 float, 1 pwm high, 2 low, -1 other */
+static int phase_drive(int phase)
+{
+  uint32_t mode = (phase == 2) ? (out_cm2 >> 4) & 7 : (out_cm1 >> (4 + 8 * phase)) & 7;
+  uint32_t enable = (out_cctrl >> (4 * phase)) & 0x5;
+
+  if(mode == TMR_OUTPUT_CONTROL_PWM_MODE_A && enable == 1)
+  {
+    return 1;
+  }
+  if(mode == TMR_OUTPUT_CONTROL_FORCE_HIGH && enable == 4)
+  {
+    return 2;
+  }
+  if(mode == TMR_OUTPUT_CONTROL_FORCE_LOW && enable == 1)
+  {
+    return 0;
+  }
+  return -1;
+}
+
+/* step on the outputs, -1 when off; any other pattern is counted */
+static int output_step(void)
+{
+  static const int8_t drive[6][3] = {{1, 2, 0}, {1, 0, 2}, {0, 1, 2}, {2, 1, 0}, {2, 0, 1}, {0, 2, 1}};
+  int state[3], step, phase;
+
+  for(phase = 0; phase < 3; phase++)
+  {
+    state[phase] = phase_drive(phase);
+  }
+  for(step = 0; step < 6; step++)
+  {
+    if(state[0] == drive[step][0] && state[1] == drive[step][1] && state[2] == drive[step][2])
+    {
+      return step;
+    }
+  }
+  if(out_cctrl != 0 && !(state[0] == 0 && state[1] == 0 && state[2] == 0))
+  {
+    bad_pattern++;
+  }
+  return -1;
+}
+
+/* TMR1 hall event: the buffered channel bits reach the outputs */
+static void hall_event(void)
+{
+  static const uint8_t floating[6] = {2, 1, 0, 2, 1, 0};
+  int prev = output_step(), step, was[3], phase;
+  double ideal, error;
+
+  for(phase = 0; phase < 3; phase++)
+  {
+    was[phase] = phase_drive(phase);
+  }
+  out_cm1 = tmr1.cm1 & 0x7070;
+  out_cm2 = tmr1.cm2 & 0x70;
+  out_cctrl = tmr1.cctrl & 0x555;
+  tmr1.ists |= TMR_HALL_FLAG;
+  step = output_step();
+  if(step < 0 || prev < 0 || step == prev)
+  {
+    return;
+  }
+
+  /* the phase just floated goes on conducting through a diode */
+  if(was[floating[step]] == 1 || was[floating[step]] == 2)
+  {
+    demag_until = now_us + IND * current / VDC * 1e6 * 2;
+    demag_level = (was[floating[step]] == 2) ? 1 : 0;
+  }
+
+  if(measure)
+  {
+    /* entry angle of the step in the direction of rotation */
+    ideal = (bldc.dir == BLDC_DIR_REVERSE) ? 90 + 60 * ((step + 3) % 6) : 30 + 60 * step;
+    error = fmod(electrical_deg() - ideal + 540, 360) - 180;
+    if(bldc.dir == BLDC_DIR_REVERSE)
+    {
+      error = -error;
+    }
+    angle_sum += error;
+    angle_n++;
+    if(fabs(error) > angle_max)
+    {
+      angle_max = fabs(error);
+    }
+    if(bldc.cfg.mode == BLDC_MODE_HALL && hall_edge != 0)
+    {
+      if(now_us - hall_edge < lag_min)
+      {
+        lag_min = now_us - hall_edge;
+      }
+      if(now_us - hall_edge > lag_max)
+      {
+        lag_max = now_us - hall_edge;
+      }
+    }
+  }
+}
+
+/* pending interrupts in priority order: TMR2, then TMR1 hall and CMP1 by
+   irq number. other code masks them for random stretches */
+static void interrupts_run(void)
+{
+  int n;
+
+  if(now_us < masked_until)
+  {
+    return;
+  }
+  for(n = 0; n < 8; n++)
+  {
+    if(tmr1.swevt & TMR_HALL_SWTRIG)
+    {
+      tmr1.swevt = 0;
+      hall_event();
+    }
+    if(tmr2.ists & tmr2.iden & (TMR_C1_FLAG | TMR_OVF_FLAG))
+    {
+      bldc_timer_irq_handler(&bldc);
+    }
+    else if(tmr1.ists & tmr1.iden & TMR_HALL_FLAG)
+    {
+      bldc_com_irq_handler(&bldc);
+    }
+    else if((host_exint.intsts & host_exint.inten & EXINT_LINE_19) && now_us > cmp_pend)
+    {
+      bldc_zc_irq_handler(&bldc);
+    }
+    else
+    {
+      break;
+    }
+  }
+  if(tmr1.swevt & TMR_HALL_SWTRIG)
+  {
+    tmr1.swevt = 0;
+    hall_event();
+  }
+  if(rand_get() % 100 == 0)
+  {
+    masked_until = now_us + 1 + rand_get() % 20;
+  }
+}
+
+static void tick(void)
+{
+  double dt = 1e-6, torque, load, shape[3], emf[3];
+  int state[3], phase, high = -1, low = -1, input, sensed = -1, raw, c2, out;
+  uint8_t hall;
+
+  now_us++;
+
+  /* motor and inverter, the pwm phase at its average voltage */
+  for(phase = 0; phase < 3; phase++)
+  {
+    shape[phase] = trapezoid(electrical_deg() - 120 * phase);
+    emf[phase] = KE * omega * shape[phase];
+    state[phase] = phase_drive(phase);
+    if(state[phase] == 1)
+    {
+      high = phase;
+    }
+    if(state[phase] == 2)
+    {
+      low = phase;
+    }
+  }
+  if(tmr1.brk_bit.oen && high >= 0 && low >= 0)
+  {
+    current += (VDC * tmr1.c1dt / (tmr1.pr + 1) - (emf[high] - emf[low]) - 2 * RES * current) / (2 * IND) * dt;
+    current = (current < 0) ? 0 : current;
+    torque = KE * current * (shape[high] - shape[low]);
+  }
+  else
+  {
+    current -= VDC / (2 * IND) * dt;
+    current = (current < 0) ? 0 : current;
+    torque = 0;
+  }
+  if(locked)
+  {
+    omega = 0;
+  }
+  else
+  {
+    load = FRICTION * omega + FAN * omega * fabs(omega) + ((omega > 0) ? COULOMB : ((omega < 0) ? -COULOMB : 0));
+    if(omega == 0 && fabs(torque) < COULOMB)
+    {
+      load = torque;
+    }
+    omega += (torque - load) / INERTIA * dt;
+    theta += omega * dt;
+  }
+
+  /* hall inputs on pa0/pa1/pa2 */
+  hall = hall_sensors();
+  if(glitches && rand_get() % 10000 == 0)
+  {
+    hall_glitch = 1 << (rand_get() % 3);
+    glitch_until = now_us + 1 + rand_get() % 3;
+  }
+  if(hall_glitch && now_us < glitch_until)
+  {
+    hall ^= hall_glitch;
+  }
+  else
+  {
+    hall_glitch = 0;
+  }
+  host_gpioa.idt = hall;
+  if(hall != hall_prev && hall == hall_sensors())
+  {
+    hall_edge = now_us;
+  }
+
+  /* TMR2: reset on the hall xor, or free running to the stall overflow */
+  if(tmr2.stctrl_bit.smsel == TMR_SUB_RESET_MODE && tmr2.stctrl_bit.stis == TMR_SUB_INPUT_SEL_C1INC && hall != hall_prev)
+  {
+    tmr2.c1dt = tmr2.cval;
+    tmr2.ists |= TMR_C1_FLAG;
+    tmr2.cval = 0;
+  }
+  else if(tmr2.ctrl1_bit.tmren)
+  {
+    if(tmr2.cval >= tmr2.pr)
+    {
+      tmr2.cval = 0;
+      tmr2.ists |= TMR_OVF_FLAG;
+    }
+    else
+    {
+      tmr2.cval++;
+    }
+    if((tmr2.cm1 & 3) == 0 && tmr2.cval == tmr2.c1dt)
+    {
+      tmr2.ists |= TMR_C1_FLAG;
+    }
+  }
+  hall_prev = hall;
+
+  /* channel 2 raw output on TRGOUT, its rising edge is the TMR1 hall event */
+  c2 = tmr2.cval >= tmr2.c2dt;
+  if(c2 && !c2_prev && tmr1.ctrl2_bit.ccfs && tmr1.stctrl_bit.stis == TMR_SUB_INPUT_SEL_IS1)
+  {
+    tmr1.ists |= TMR_TRIGGER_FLAG;
+    hall_event();
+  }
+  c2_prev = c2;
+
+  /* CMP1 between the selected phase and the neutral */
+  input = host_cmp.ctrlsts2_bit.cmp1ninvsel;
+  for(phase = 0; phase < 3; phase++)
+  {
+    if(bldc.cfg.zc_input[phase] == input)
+    {
+      sensed = phase;
+    }
+  }
+  if(sensed >= 0 && emf[sensed] > 0.01)
+  {
+    cmp_hyst = 1;
+  }
+  else if(sensed >= 0 && emf[sensed] < -0.01)
+  {
+    cmp_hyst = 0;
+  }
+  raw = cmp_hyst;
+  if(sensed >= 0 && state[sensed] != 0)
+  {
+    raw = (state[sensed] == 1) ? 1 : 0;
+  }
+  if(now_us < demag_until && sensed >= 0 && state[sensed] == 0)
+  {
+    raw = demag_level;
+  }
+  if(noise && now_us % 25 == 0 && rand_get() % 2)
+  {
+    raw ^= 1;
+  }
+  out = raw ^ host_cmp.ctrlsts1_bit.cmp1p;
+  host_cmp.ctrlsts1_bit.cmp1value = out;
+  if(out && !cmp_prev && (host_exint.polcfg1 & EXINT_LINE_19))
+  {
+    host_exint.intsts |= EXINT_LINE_19;
+    cmp_pend = now_us;
+  }
+  cmp_prev = out;
+
+  interrupts_run();
+}
+
+static void run_ms(long ms)
+{
+  long n = ms * 1000;
+
+  while(n--)
+  {
+    tick();
+  }
+}
+
+/* duty ramp of the application in 1 ms steps */
+static void duty_ramp(uint32_t duty, int ms)
+{
+  uint32_t start = bldc.duty;
+  int k;
+
+  for(k = 1; k <= ms; k++)
+  {
+    bldc_duty_set(&bldc, start + (int32_t)(duty - start) * k / ms);
+    run_ms(1);
+  }
+}
+
+/* ms until the loop closes, -1 when it does not in 3 s */
+static long closing_wait(void)
+{
+  long start = now_us;
+
+  while(bldc.state != BLDC_STATE_RUN && now_us - start < 3000000)
+  {
+    tick();
+  }
+  return (bldc.state == BLDC_STATE_RUN) ? (now_us - start) / 1000 : -1;
+}
+
+static void stats_reset(void)
+{
+  angle_sum = 0;
+  angle_max = 0;
+  angle_n = 0;
+  lag_min = 1 << 30;
+  lag_max = 0;
+  measure = 1;
+}
+
+/* speed estimate within a tolerance of the model speed */
+static int speed_check(const char *name, double tolerance)
+{
+  double estimate = bldc_speed_get(&bldc), speed = fabs(rpm_get());
+
+  printf("%-32s %6.0f rpm, estimate %+.2f%%, angle mean %+.2f max %.2f deg\n", name, rpm_get(),
+         (speed > 0) ? (estimate - speed) / speed * 100 : 0, angle_n ? angle_sum / angle_n : 0, angle_max);
+  return speed > 100 && fabs(estimate - speed) < speed * tolerance / 100;
+}
+
+static void hardware_reset(void)
+{
+  memset(&tmr1, 0, sizeof(tmr1));
+  memset(&tmr2, 0, sizeof(tmr2));
+  memset(&host_cmp, 0, sizeof(host_cmp));
+  memset(&host_exint, 0, sizeof(host_exint));
+  out_cm1 = out_cm2 = out_cctrl = 0;
+  c2_prev = cmp_prev = 0;
+  theta = 0.3;
+  omega = 0;
+  current = 0;
+  locked = noise = glitches = measure = 0;
+  hall_prev = hall_sensors();
+  host_gpioa.idt = hall_prev;
+  tmr1.pr = PWM_PERIOD - 1;
+  tmr2.ctrl1_bit.tmren = 1;
+}
+
+static void hall_test(void)
+{
+  bldc_config_type cfg;
+
+  hardware_reset();
+  bldc_default_para_init(&cfg);
+  cfg.hall_delay = 5;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+  CHECK(bldc_start(&bldc, BLDC_DIR_FORWARD, PWM_PERIOD / 2) == SUCCESS);
+  run_ms(1500);
+  stats_reset();
+  run_ms(500);
+  CHECK(speed_check("hall forward 50%", 0.5));
+  CHECK(lag_min == cfg.hall_delay && lag_max <= cfg.hall_delay + 1);
+  CHECK(angle_max < 2);
+  bldc_duty_set(&bldc, PWM_PERIOD * 4 / 5);
+  run_ms(1000);
+  stats_reset();
+  run_ms(500);
+  CHECK(speed_check("hall forward 80%", 0.5));
+  CHECK(bldc.hall_error_count == 0);
+
+  /* plugging into reverse while spinning */
+  bldc_stop(&bldc);
+  run_ms(100);
+  measure = 0;
+  CHECK(bldc_start(&bldc, BLDC_DIR_REVERSE, PWM_PERIOD * 4 / 5) == SUCCESS);
+  run_ms(2500);
+  stats_reset();
+  run_ms(500);
+  CHECK(speed_check("hall reverse 80%", 0.5));
+  CHECK(omega < 0 && angle_max < 2);
+
+  /* glitches on the hall inputs */
+  glitches = 1;
+  stats_reset();
+  run_ms(2000);
+  glitches = 0;
+  run_ms(200);
+  CHECK(speed_check("hall reverse with glitches", 1));
+  CHECK(bldc.state == BLDC_STATE_RUN && bldc.hall_error_count > 0);
+
+  locked = 1;
+  run_ms(700);
+  CHECK(bldc.state == BLDC_STATE_STALL && bldc.stall_count == 1);
+  CHECK(bad_pattern == 0);
+}
+
+/* from standstill, the loop closes after the same open loop in both
+   directions, whatever duty the start asks for */
+static void sensorless_start_test(void)
+{
+  static const uint32_t duty[] = {PWM_PERIOD / 10, PWM_PERIOD / 5, PWM_PERIOD / 2, PWM_PERIOD * 9 / 10};
+  bldc_config_type cfg;
+  long closed[2];
+  int index, dir;
+
+  for(index = 0; index < (int)(sizeof(duty) / sizeof(duty[0])); index++)
+  {
+    for(dir = 0; dir < 2; dir++)
+    {
+      hardware_reset();
+      bldc_default_para_init(&cfg);
+      cfg.mode = BLDC_MODE_SENSORLESS;
+      CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+      CHECK(bldc_start(&bldc, dir ? BLDC_DIR_REVERSE : BLDC_DIR_FORWARD, duty[index]) == SUCCESS);
+      CHECK(tmr1.c1dt == cfg.startup_duty);
+      closed[dir] = closing_wait();
+      CHECK(closed[dir] > 0);
+      run_ms(500);
+      CHECK(bldc.state == BLDC_STATE_RUN && (dir ? omega < 0 : omega > 0));
+      CHECK(tmr1.c1dt == duty[index]);
+    }
+    printf("sensorless start at %2u%% duty      closed after %ld ms forward, %ld ms reverse\n",
+           (unsigned)(duty[index] * 100 / PWM_PERIOD), closed[0], closed[1]);
+    CHECK(closed[0] == closed[1]);
+  }
+  CHECK(bad_pattern == 0);
+}
+
+static void sensorless_run_test(bldc_dir_type dir)
+{
+  bldc_config_type cfg;
+
+  hardware_reset();
+  bldc_default_para_init(&cfg);
+  cfg.mode = BLDC_MODE_SENSORLESS;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+  CHECK(bldc_start(&bldc, dir, cfg.startup_duty) == SUCCESS);
+  CHECK(closing_wait() > 0);
+
+  /* switching spikes on the comparator */
+  noise = 1;
+  duty_ramp(PWM_PERIOD / 2, 500);
+  run_ms(1500);
+  stats_reset();
+  run_ms(500);
+  noise = 0;
+  CHECK(speed_check((dir == BLDC_DIR_FORWARD) ? "sensorless forward 50%, noise" : "sensorless reverse 50%, noise", 1));
+  CHECK(fabs(angle_sum / angle_n) < 3 && angle_max < 10);
+  CHECK((dir == BLDC_DIR_FORWARD) ? omega > 0 : omega < 0);
+
+  duty_ramp(PWM_PERIOD * 9 / 10, 500);
+  run_ms(1000);
+  stats_reset();
+  run_ms(500);
+  CHECK(speed_check((dir == BLDC_DIR_FORWARD) ? "sensorless forward 90%" : "sensorless reverse 90%", 1));
+  CHECK(fabs(angle_sum / angle_n) < 3 && angle_max < 10);
+  CHECK(bldc.state == BLDC_STATE_RUN && bldc.stall_count == 0);
+
+  locked = 1;
+  run_ms(700);
+  CHECK(bldc.state == BLDC_STATE_STALL && bldc.stall_count == 1);
+  CHECK(bad_pattern == 0);
+}
+
+/* open loops that can not close are refused */
+static void config_test(void)
+{
+  bldc_config_type cfg;
+
+  bldc_default_para_init(&cfg);
+  cfg.mode = BLDC_MODE_SENSORLESS;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+  cfg.startup_duty = 0;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == ERROR);
+  bldc_default_para_init(&cfg);
+  cfg.mode = BLDC_MODE_SENSORLESS;
+  cfg.startup_ramp = 0;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == ERROR);
+  cfg.startup_period = cfg.startup_min;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+  bldc_default_para_init(&cfg);
+  cfg.mode = BLDC_MODE_SENSORLESS;
+  cfg.zc_blank = cfg.startup_min / 2;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == ERROR);
+  bldc_default_para_init(&cfg);
+  cfg.mode = BLDC_MODE_SENSORLESS;
+  cfg.align_ticks = cfg.stall_ticks;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == ERROR);
+
+  /* hall mode has no open loop */
+  bldc_default_para_init(&cfg);
+  cfg.startup_duty = 0;
+  CHECK(bldc_init(&bldc, &tmr1, &tmr2, &cfg) == SUCCESS);
+}
+
+int main(void)
+{
+  hall_test();
+  sensorless_start_test();
+  sensorless_run_test(BLDC_DIR_FORWARD);
+  sensorless_run_test(BLDC_DIR_REVERSE);
+  config_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,43 @@
+/**
+  **************************************************************************
+  * @file     bldc_commutation_host_test.h
+  * @brief    peripheral models of the bldc commutation host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* forced into every translation unit of the test after at32_host.h: the
+   peripherals bldc_commutation.c reaches by name are memory of the test */
+
+#ifndef __BLDC_COMMUTATION_HOST_TEST_H
+#define __BLDC_COMMUTATION_HOST_TEST_H
+
+extern cmp_type host_cmp;
+extern exint_type host_exint;
+extern gpio_type host_gpioa;
+
+#undef CMP
+#define CMP                              (&host_cmp)
+#undef EXINT
+#define EXINT                            (&host_exint)
+#undef GPIOA
+#define GPIOA                            (&host_gpioa)
+
+#endif
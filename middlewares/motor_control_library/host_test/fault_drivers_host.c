@@ -0,0 +1,38 @@
+/**
+  **************************************************************************
+  * @file     fault_drivers_host.c
+  * @brief    tmr, cmp and exint drivers of the fault manager host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* the real drivers write the peripheral registers of the model. the flag
+   and software event functions are renamed, the test gives them the write
+   0 to clear, interrupt enable and break semantics plain memory does not
+   have */
+#define tmr_flag_clear                   drv_tmr_flag_clear
+#define tmr_interrupt_flag_get           drv_tmr_interrupt_flag_get
+#define tmr_event_sw_trigger             drv_tmr_event_sw_trigger
+#define exint_flag_clear                 drv_exint_flag_clear
+#define exint_interrupt_flag_get         drv_exint_interrupt_flag_get
+
+#include "../../../libraries/drivers/src/at32f415_tmr.c"
+#include "../../../libraries/drivers/src/at32f415_cmp.c"
+#include "../../../libraries/drivers/src/at32f415_exint.c"
@@ -0,0 +1,347 @@
+/**
+  **************************************************************************
+  * @file     fault_manager_host_test.c
+  * @brief    host model of the fault manager
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs fault_manager with the real tmr, cmp and exint drivers against a
+ * model of the protection hardware: the break input turns the outputs off
+ * and keeps the break flag raised while it is active, the limit comparator
+ * raises exint line 19 on its rising edge, interrupts run in priority
+ * order, break first. pwm periods of 50 us, a tick every 20 of them.
+ * checks the comparator routing and timer bits, the limit accounting of
+ * scattered and held limits with the overflow interrupt off when quiet, the
+ * trip after limit_cycles_max limited periods, the retry delay doubling on
+ * a held overcurrent, the lockout after the retries are used up and its
+ * clear, software reports, the retry count forgiven after a clean run and
+ * a retry_max of 0.
+ */
+
+#include <stdio.h>
+#include "fault_manager.h"
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+tmr_type host_tmr1;
+cmp_type host_cmp;
+exint_type host_exint;
+static fault_type fault;
+
+/* comparator and break pin levels */
+static int limit_level, limit_prev, trip_level, pin_level, in_irq;
+static long period_count;
+
+/* event log */
+static int event_count[3];
+static uint32_t event_tick[3][32];
+
+static int fails;
+
+/* the break input of the model: active while the trip comparator or the pin is */
+static void hardware_update(void)
+{
+  if(host_tmr1.brk_bit.brken && ((trip_level || pin_level) == (host_tmr1.brk_bit.brkv == 1)))
+  {
+    host_tmr1.ists |= TMR_BRK_FLAG;
+    host_tmr1.brk_bit.oen = 0;
+  }
+  host_cmp.ctrlsts1_bit.cmp1value = limit_level;
+  host_cmp.ctrlsts1_bit.cmp2value = trip_level;
+  if(limit_level && !limit_prev && (host_exint.polcfg1 & EXINT_LINE_19))
+  {
+    host_exint.intsts |= EXINT_LINE_19;
+  }
+  limit_prev = limit_level;
+}
+
+/* write 0 to clear flags and interrupt enables the plain memory lacks, the
+   break flag comes back while the input is active */
+void tmr_flag_clear(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  tmr_x->ists &= ~tmr_flag;
+  hardware_update();
+}
+
+flag_status tmr_interrupt_flag_get(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  return ((tmr_x->ists & tmr_flag) && (tmr_x->iden & tmr_flag)) ? SET : RESET;
+}
+
+void tmr_event_sw_trigger(tmr_type *tmr_x, tmr_event_trigger_type tmr_event)
+{
+  if(tmr_event == TMR_BRK_SWTRIG && tmr_x->brk_bit.brken)
+  {
+    tmr_x->ists |= TMR_BRK_FLAG;
+    tmr_x->brk_bit.oen = 0;
+  }
+}
+
+void exint_flag_clear(uint32_t exint_line)
+{
+  host_exint.intsts &= ~exint_line;
+}
+
+flag_status exint_interrupt_flag_get(uint32_t exint_line)
+{
+  return (host_exint.intsts & host_exint.inten & exint_line) ? SET : RESET;
+}
+
+void crm_periph_reset(crm_periph_reset_type value, confirm_state new_state)
+{
+  (void)value;
+  (void)new_state;
+}
+
+/* pending interrupts in priority order until none is left */
+static void irq_dispatch(void)
+{
+  int guard = 0;
+
+  if(in_irq)
+  {
+    return;
+  }
+  in_irq = 1;
+  while(guard++ < 100)
+  {
+    hardware_update();
+    if(host_tmr1.ists & host_tmr1.iden & TMR_BRK_FLAG)
+    {
+      fault_break_irq_handler(&fault);
+    }
+    else if(host_tmr1.ists & host_tmr1.iden & TMR_OVF_FLAG)
+    {
+      fault_cycle_irq_handler(&fault);
+    }
+    else if(host_exint.intsts & host_exint.inten & EXINT_LINE_19)
+    {
+      fault_limit_irq_handler(&fault);
+    }
+    else
+    {
+      break;
+    }
+  }
+  CHECK(guard < 100);
+  in_irq = 0;
+}
+
+static void event_log(fault_event_type event, uint32_t source)
+{
+  (void)source;
+  if(event_count[event] < 32)
+  {
+    event_tick[event][event_count[event]] = fault.tick;
+  }
+  event_count[event]++;
+}
+
+/* one pwm period: the limit comparator inside it and at its end, then the
+   overflow, every 20th period a tick */
+static void period_run(int limit_inside, int limit_at_end)
+{
+  if(limit_inside)
+  {
+    limit_level = 1;
+    irq_dispatch();
+  }
+  limit_level = limit_at_end;
+  irq_dispatch();
+  host_tmr1.ists |= TMR_OVF_FLAG;
+  irq_dispatch();
+  if(++period_count % 20 == 0)
+  {
+    fault_tick_handler(&fault);
+    irq_dispatch();
+  }
+}
+
+static void periods_run(long count, int limit)
+{
+  while(count-- > 0)
+  {
+    period_run(limit, 0);
+  }
+}
+
+static void ms_run(long ms)
+{
+  periods_run(ms * 20, 0);
+}
+
+static int outputs_on(void)
+{
+  return host_tmr1.brk_bit.oen;
+}
+
+/* ticks from now until the outputs come back, at most limit */
+static uint32_t retry_wait(uint32_t limit)
+{
+  uint32_t start = fault.tick;
+
+  while(!outputs_on() && fault.tick < start + limit)
+  {
+    periods_run(1, 0);
+  }
+  return fault.tick - start;
+}
+
+static void setup_test(fault_config_type *cfg)
+{
+  fault_config_type bad;
+  fault_type other;
+
+  fault_default_para_init(cfg);
+  cfg->event_handler = event_log;
+  CHECK(fault_init(&fault, TMR1, cfg) == SUCCESS);
+  CHECK(host_cmp.ctrlsts1_bit.cmp1tag == CMP_OUTPUT_TMR1CHCLR && host_cmp.ctrlsts1_bit.cmp2tag == CMP_OUTPUT_TMR1BRK);
+  CHECK(host_tmr1.cm1_output_bit.c1osen && host_tmr1.cm1_output_bit.c2osen);
+  CHECK(host_tmr1.cm2_output_bit.c3osen && !host_tmr1.cm2_output_bit.c4osen);
+  CHECK(host_tmr1.brk_bit.brken && !host_tmr1.brk_bit.aoen && host_tmr1.brk_bit.brkv);
+
+  /* limit and trip on the same comparator */
+  bad = *cfg;
+  bad.trip_cmp = CMP1_SELECTION;
+  CHECK(fault_init(&other, TMR1, &bad) == ERROR);
+  host_tmr1.brk_bit.oen = 1;
+}
+
+static void limit_test(void)
+{
+  int count;
+
+  /* scattered limited periods */
+  periods_run(10, 0);
+  period_run(1, 0);
+  periods_run(3, 0);
+  period_run(1, 0);
+  period_run(1, 0);
+  periods_run(5, 0);
+  CHECK(fault.limit_cycles == 3 && fault.limit_run_max == 2 && fault.limit_events == 3);
+  CHECK(fault.state == FAULT_STATE_ARMED);
+  CHECK(!(host_tmr1.iden & TMR_OVF_INT));
+
+  /* comparator held high over overflows: one edge, every period counted */
+  limit_level = 1;
+  irq_dispatch();
+  for(count = 0; count < 5; count++)
+  {
+    period_run(0, 1);
+  }
+  period_run(0, 0);
+  periods_run(2, 0);
+  CHECK(fault.limit_events == 4 && fault.limit_run_max == 6);
+  CHECK(outputs_on() && fault.trip_count == 0);
+
+  /* limit_cycles_max limited periods in a row trip */
+  periods_run(99, 1);
+  CHECK(outputs_on());
+  periods_run(1, 1);
+  CHECK(!outputs_on() && fault.state == FAULT_STATE_TRIPPED);
+  CHECK(fault.last_source == FAULT_SOURCE_LIMIT && event_count[FAULT_EVENT_TRIP] == 1);
+  CHECK(retry_wait(100) == 10 && outputs_on() && event_count[FAULT_EVENT_RETRY] == 1);
+}
+
+static void retry_test(void)
+{
+  int index;
+
+  /* trip comparator held 100 ms: the retries after 10, 20 and 40 ms fail */
+  trip_level = 1;
+  irq_dispatch();
+  CHECK(!outputs_on() && fault.last_source == FAULT_SOURCE_OVERCURRENT);
+  ms_run(100);
+  CHECK(fault.trip_count == 4 && event_count[FAULT_EVENT_TRIP] == 4);
+  printf("held overcurrent, trips at tick");
+  for(index = 0; index < event_count[FAULT_EVENT_TRIP]; index++)
+  {
+    printf(" %lu", (unsigned long)event_tick[FAULT_EVENT_TRIP][index]);
+  }
+  printf("\n");
+  CHECK(event_tick[FAULT_EVENT_TRIP][2] - event_tick[FAULT_EVENT_TRIP][1] == 20);
+  CHECK(event_tick[FAULT_EVENT_TRIP][3] - event_tick[FAULT_EVENT_TRIP][2] == 40);
+  trip_level = 0;
+  ms_run(100);
+  CHECK(outputs_on() && fault.state == FAULT_STATE_ARMED && fault.retry_count == 2);
+
+  /* break pin: the fifth retry, then lockout */
+  pin_level = 1;
+  irq_dispatch();
+  pin_level = 0;
+  CHECK(fault.last_source == FAULT_SOURCE_BREAK_PIN && fault.state == FAULT_STATE_TRIPPED && fault.retries == 5);
+  ms_run(200);
+  CHECK(outputs_on());
+  pin_level = 1;
+  irq_dispatch();
+  pin_level = 0;
+  CHECK(fault.last_source == FAULT_SOURCE_BREAK_PIN && fault.state == FAULT_STATE_LOCKED);
+  CHECK(event_count[FAULT_EVENT_LOCKOUT] == 1);
+  ms_run(3000);
+  CHECK(!outputs_on() && fault.state == FAULT_STATE_LOCKED);
+
+  /* a report while locked is recorded, the clear arms again */
+  fault_report(&fault, FAULT_SOURCE_SOFTWARE);
+  irq_dispatch();
+  CHECK(fault.trip_count == 6 && (fault.last_source & FAULT_SOURCE_SOFTWARE));
+  CHECK(fault_clear(&fault) == SUCCESS);
+  ms_run(2);
+  CHECK(outputs_on() && fault.state == FAULT_STATE_ARMED);
+  CHECK(fault_clear(&fault) == ERROR);
+
+  /* software report: retry at 10 ms, a clean 2 s forgives it */
+  fault_report(&fault, FAULT_SOURCE_SOFTWARE);
+  irq_dispatch();
+  CHECK(!outputs_on() && fault.last_source == FAULT_SOURCE_SOFTWARE);
+  ms_run(15);
+  CHECK(outputs_on());
+  ms_run(2100);
+  CHECK(fault.retries == 0);
+  fault_report(&fault, FAULT_SOURCE_SOFTWARE);
+  irq_dispatch();
+  CHECK(retry_wait(100) == 10);
+}
+
+static void no_retry_test(fault_config_type *cfg)
+{
+  cfg->retry_max = 0;
+  CHECK(fault_init(&fault, TMR1, cfg) == SUCCESS);
+  host_tmr1.brk_bit.oen = 1;
+  trip_level = 1;
+  irq_dispatch();
+  trip_level = 0;
+  ms_run(50);
+  CHECK(fault.state == FAULT_STATE_LOCKED && !outputs_on());
+}
+
+int main(void)
+{
+  fault_config_type cfg;
+
+  setup_test(&cfg);
+  limit_test();
+  retry_test();
+  no_retry_test(&cfg);
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
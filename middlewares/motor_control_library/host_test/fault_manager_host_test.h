@@ -0,0 +1,43 @@
+/**
+  **************************************************************************
+  * @file     fault_manager_host_test.h
+  * @brief    peripheral models of the fault manager host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* forced into every translation unit of the test after at32_host.h: the
+   peripherals fault_manager.c reaches by name are memory of the test */
+
+#ifndef __FAULT_MANAGER_HOST_TEST_H
+#define __FAULT_MANAGER_HOST_TEST_H
+
+extern tmr_type host_tmr1;
+extern cmp_type host_cmp;
+extern exint_type host_exint;
+
+#undef TMR1
+#define TMR1                             (&host_tmr1)
+#undef CMP
+#define CMP                              (&host_cmp)
+#undef EXINT
+#define EXINT                            (&host_exint)
+
+#endif
@@ -0,0 +1,388 @@
+/**
+  **************************************************************************
+  * @file     foc_control_host_test.c
+  * @brief    host model of the foc current loop
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs foc_control with the real tmr and adc drivers against an average
+ * model of the inverter and of a 4 pole pair surface magnet motor, 100
+ * steps per pwm period:
+ * - the preempt conversions of a period read the three shunts at the
+ *   bottom of the count with an offset and gaussian noise of one count,
+ *   a phase whose low switch conducts for less than 4 us reads garbage
+ * - the duty written in a period applies from the next one
+ * checks the sine table, the timer and adc setup, the space vector
+ * modulation against the voltage vector asked for, the offset calibration,
+ * a current step on a locked rotor, the voltage circle and the d current
+ * at speed, integrator windup when the reference drops, braking, the open
+ * loop angle advance and the stop. the times checked are of the model
+ * motor, not of the processor.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "foc_control.h"
+
+#define PWM_PERIOD                       3600
+#define POLE_PAIRS                       4
+#define VDC                              24.0
+#define I_FULL                           20.0
+#define RES                              0.5
+#define IND                              0.0005
+#define FLUX                             0.01
+#define INERTIA                          2e-5
+#define FRICTION                         1e-5
+#define TS                               50e-6
+#define STEPS                            100
+#define PI                               3.14159265358979
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+tmr_type host_tmr1;
+static tmr_type tmr2;
+static adc_type adc1;
+static foc_type foc;
+
+/* motor, ic = -ia - ib */
+static double ia, ib, omega, theta, load;
+static double duty_now[3] = {0.5, 0.5, 0.5}, duty_next[3] = {0.5, 0.5, 0.5};
+static const int offset[3] = {2048 + 37, 2048 - 21, 2048 + 12};
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+/* the calibration of the model ends at once */
+flag_status adc_calibration_init_status_get(adc_type *adc_x)
+{
+  adc_x->ctrl2_bit.adcalinit = 0;
+  return RESET;
+}
+
+flag_status adc_calibration_status_get(adc_type *adc_x)
+{
+  adc_x->ctrl2_bit.adcal = 0;
+  return RESET;
+}
+
+static double gauss(void)
+{
+  double u = (rand_get() + 1.0) / 16777218.0, v = (rand_get() + 1.0) / 16777218.0;
+
+  return sqrt(-2 * log(u)) * cos(2 * PI * v);
+}
+
+static uint16_t adc_sample(double current, int phase)
+{
+  long value = lround(offset[phase] + current / I_FULL * 2048.0 + gauss());
+
+  return (uint16_t)((value < 0) ? 0 : ((value > 4095) ? 4095 : value));
+}
+
+static double i_d(void)
+{
+  double th = theta * POLE_PAIRS;
+
+  return (2.0 / 3.0) * (ia * cos(th) + ib * cos(th - 2 * PI / 3) + (-ia - ib) * cos(th + 2 * PI / 3));
+}
+
+static double i_q(void)
+{
+  double th = theta * POLE_PAIRS;
+
+  return -(2.0 / 3.0) * (ia * sin(th) + ib * sin(th - 2 * PI / 3) + (-ia - ib) * sin(th + 2 * PI / 3));
+}
+
+static double rpm(void)
+{
+  return omega * 60 / (2 * PI);
+}
+
+/* the position sensor gives the angle every period */
+static void sensor(void)
+{
+  double th = fmod(theta * POLE_PAIRS, 2 * PI);
+
+  if(th < 0)
+  {
+    th += 2 * PI;
+  }
+  foc_angle_set(&foc, (foc_angle_type)((uint32_t)lround(th / (2 * PI) * 65536.0) & 0xFFFF), 0);
+}
+
+/* one pwm period: conversions at the bottom, the interrupt, then the motor */
+static void period_run(void)
+{
+  double current[3] = {ia, ib, -ia - ib};
+  uint16_t offsets[3] = {adc1.pcdto1_bit.pcdto1, adc1.pcdto2_bit.pcdto2, adc1.pcdto3_bit.pcdto3};
+  int16_t data[3];
+  double dt = TS / STEPS, th, e[3], v[3], vn, te;
+  int phase, step;
+
+  for(phase = 0; phase < 3; phase++)
+  {
+    uint16_t raw = adc_sample(current[phase], phase);
+    if(host_tmr1.brk_bit.oen && 2.0 * (1.0 - duty_now[phase]) * TS < 4e-6)
+    {
+      raw = rand_get() & 0xFFF;
+    }
+    data[phase] = (int16_t)(raw - offsets[phase]);
+  }
+  adc1.pdt1_bit.pdt1 = (uint16_t)data[0];
+  adc1.pdt2_bit.pdt2 = (uint16_t)data[1];
+  adc1.pdt3_bit.pdt3 = (uint16_t)data[2];
+  adc1.sts_bit.pcce = 1;
+  foc_adc_irq_handler(&foc);
+  CHECK(adc1.sts_bit.pcce == 0);
+
+  /* the compare values load at the next overflow */
+  for(phase = 0; phase < 3; phase++)
+  {
+    duty_now[phase] = duty_next[phase];
+  }
+  duty_next[0] = (PWM_PERIOD - host_tmr1.c1dt) / (double)PWM_PERIOD;
+  duty_next[1] = (PWM_PERIOD - host_tmr1.c2dt) / (double)PWM_PERIOD;
+  duty_next[2] = (PWM_PERIOD - host_tmr1.c3dt) / (double)PWM_PERIOD;
+
+  for(step = 0; step < STEPS; step++)
+  {
+    th = theta * POLE_PAIRS;
+    for(phase = 0; phase < 3; phase++)
+    {
+      e[phase] = -omega * POLE_PAIRS * FLUX * sin(th - phase * 2 * PI / 3);
+      v[phase] = host_tmr1.brk_bit.oen ? VDC * duty_now[phase] : e[phase];
+    }
+    if(!host_tmr1.brk_bit.oen)
+    {
+      ia = ib = 0;
+    }
+    vn = (v[0] + v[1] + v[2] - e[0] - e[1] - e[2]) / 3.0;
+    ia += dt / IND * (v[0] - vn - RES * ia - e[0]);
+    ib += dt / IND * (v[1] - vn - RES * ib - e[1]);
+    te = 1.5 * POLE_PAIRS * FLUX * i_q();
+    omega += dt / INERTIA * (te - FRICTION * omega - load);
+    theta += dt * omega;
+  }
+}
+
+static void sin_cos_test(void)
+{
+  foc_q15_type sin_val, cos_val;
+  uint32_t angle;
+  long error = 0;
+
+  for(angle = 0; angle < 65536; angle++)
+  {
+    foc_sin_cos((foc_angle_type)angle, &sin_val, &cos_val);
+    error = labs(sin_val - lround(32767 * sin(2 * PI * angle / 65536.0))) > error ?
+            labs(sin_val - lround(32767 * sin(2 * PI * angle / 65536.0))) : error;
+    error = labs(cos_val - lround(32767 * cos(2 * PI * angle / 65536.0))) > error ?
+            labs(cos_val - lround(32767 * cos(2 * PI * angle / 65536.0))) : error;
+  }
+  printf("sin/cos: max error %ld lsb\n", error);
+  CHECK(error <= 4);
+}
+
+static void setup_test(void)
+{
+  foc_config_type cfg;
+
+  foc_default_para_init(&cfg);
+  CHECK(foc_init(&foc, TMR1, &adc1, &cfg) == SUCCESS);
+  CHECK(host_tmr1.pr == PWM_PERIOD && host_tmr1.ctrl1_bit.cnt_dir == 2 && host_tmr1.rpr == 1);
+  CHECK(host_tmr1.ctrl2_bit.ptos == TMR_PRIMARY_SEL_OVERFLOW);
+  CHECK(adc1.ctrl2_bit.pctesel_l == ADC12_PREEMPT_TRIG_TMR1TRGOUT && adc1.ctrl2_bit.pcten);
+  CHECK(adc1.psq_bit.pclen == 2);
+  CHECK(!host_tmr1.brk_bit.oen);
+
+  /* only TMR1 triggers the preempt conversions */
+  CHECK(foc_init(&foc, &tmr2, &adc1, &cfg) == ERROR);
+  cfg.kp_shift = 16;
+  CHECK(foc_init(&foc, TMR1, &adc1, &cfg) == ERROR);
+}
+
+/* the duty of the three phases, as line voltages, against the vector asked
+   for through the integrators */
+static void svpwm_test(void)
+{
+  foc_config_type cfg;
+  double mag, ang, th, d[3], va, vb, ea, eb, error = 0;
+  int vd, vq, count, phase;
+
+  foc_default_para_init(&cfg);
+  CHECK(foc_init(&foc, TMR1, &adc1, &cfg) == SUCCESS);
+  for(count = 0; count < 20000; count++)
+  {
+    mag = rand_get() / 16777216.0 * cfg.v_max;
+    ang = rand_get() / 16777216.0 * 2 * PI;
+    vd = (int)(mag * cos(ang));
+    vq = (int)(mag * sin(ang) * 0.999);
+    foc.pi_d.kp = foc.pi_d.ki = foc.pi_q.kp = foc.pi_q.ki = 0;
+    foc.pi_d.integral = vd << 16;
+    foc.pi_q.integral = vq << 16;
+    foc.id_ref = foc.iq_ref = 0;
+    foc.i_abc[0] = foc.i_abc[1] = foc.i_abc[2] = 0;
+    foc.theta = (foc_angle_type)rand_get();
+    foc.theta_step = 0;
+    th = foc.theta / 65536.0 * 2 * PI;
+    foc_compute(&foc);
+    for(phase = 0; phase < 3; phase++)
+    {
+      CHECK(foc.duty[phase] <= PWM_PERIOD);
+      d[phase] = foc.duty[phase] / (double)PWM_PERIOD;
+    }
+    va = (2 * d[0] - d[1] - d[2]) / 3 * sqrt(3.0) * 32768;
+    vb = (d[1] - d[2]) * 32768;
+    ea = foc.v_d * cos(th) - foc.v_q * sin(th);
+    eb = foc.v_d * sin(th) + foc.v_q * cos(th);
+    error = fmax(error, hypot(va - ea, vb - eb) / 32768);
+  }
+  printf("svpwm: max vector error %.5f\n", error);
+  CHECK(error < 0.002);
+}
+
+static void current_loop_test(void)
+{
+  foc_config_type cfg;
+  double settle = -1, iq_max = 0, id_max = 0, v_max = 0, iq_min, lock = (17.0 * PI / 180.0) / POLE_PAIRS;
+  long count, limited = 0;
+  foc_angle_type angle;
+
+  /* gains for about 1 khz of current loop bandwidth on the model motor */
+  foc_default_para_init(&cfg);
+  cfg.kp = 18555;
+  cfg.kp_shift = 3;
+  cfg.ki = 7428;
+  CHECK(foc_init(&foc, TMR1, &adc1, &cfg) == SUCCESS);
+
+  /* offsets with the outputs off */
+  theta = lock;
+  omega = 0;
+  foc_start(&foc);
+  CHECK(foc.state == FOC_STATE_CALIBRATE);
+  for(count = 0; count < FOC_CALIBRATE_COUNT; count++)
+  {
+    period_run();
+  }
+  CHECK(foc.state == FOC_STATE_RUN && host_tmr1.brk_bit.oen);
+  CHECK(abs(adc1.pcdto1_bit.pcdto1 - offset[0]) <= 1);
+  CHECK(abs(adc1.pcdto2_bit.pcdto2 - offset[1]) <= 1);
+  CHECK(abs(adc1.pcdto3_bit.pcdto3 - offset[2]) <= 1);
+
+  /* 2 a step on a locked rotor */
+  sensor();
+  foc_current_set(&foc, 0, 3277);
+  for(count = 0; count < 200; count++)
+  {
+    sensor();
+    omega = 0;
+    theta = lock;
+    period_run();
+    iq_max = fmax(iq_max, i_q());
+    id_max = fmax(id_max, fabs(i_d()));
+    if(settle < 0 && fabs(i_q() - 2.0) < 0.04)
+    {
+      settle = count * TS;
+    }
+  }
+  printf("locked rotor: iq %.3f a, settled in %.2f ms, overshoot %.1f %%, id max %.3f a\n",
+         i_q(), settle * 1e3, (iq_max / 2.0 - 1) * 100, id_max);
+  CHECK(fabs(i_q() - 2.0) < 0.04);
+  CHECK(settle > 0 && settle < 1e-3);
+  CHECK(iq_max < 2.2 && id_max < 0.2);
+
+  /* 5 a with a load: the motor runs into the voltage circle */
+  load = 0.03;
+  foc_current_set(&foc, 0, 8192);
+  for(count = 0; count < 60000; count++)
+  {
+    sensor();
+    period_run();
+    v_max = fmax(v_max, hypot(foc.v_d, foc.v_q) / 32768.0);
+    limited += (hypot(foc.v_d, foc.v_q) / 32768.0 > 0.94);
+  }
+  printf("free run: %.0f rpm, iq %.3f a, id %.3f a, |v| max %.3f, %ld periods limited\n",
+         rpm(), i_q(), i_d(), v_max, limited);
+  CHECK(v_max <= cfg.v_max / 32768.0 + 0.001);
+  CHECK(limited > 0);
+  CHECK(rpm() > 1000);
+  CHECK(fabs(i_d()) < 0.3);
+
+  /* the reference drops to 0.2 a: the integrators did not wind up */
+  foc_current_set(&foc, 0, 328);
+  iq_max = -1e9;
+  iq_min = 1e9;
+  for(count = 0; count < 400; count++)
+  {
+    sensor();
+    period_run();
+    if(count > 40)
+    {
+      iq_max = fmax(iq_max, i_q());
+      iq_min = fmin(iq_min, i_q());
+    }
+  }
+  printf("reference drop: iq %.3f a, %.3f..%.3f a\n", i_q(), iq_min, iq_max);
+  CHECK(fabs(i_q() - 0.2) < 0.15 && iq_max < 0.45 && iq_min > -0.05);
+
+  /* braking */
+  foc_current_set(&foc, 0, -3277);
+  for(count = 0; count < 400; count++)
+  {
+    sensor();
+    period_run();
+  }
+  printf("braking: iq %.3f a at %.0f rpm\n", i_q(), rpm());
+  CHECK(fabs(i_q() + 2.0) < 0.15);
+
+  /* open loop angle advance */
+  foc_angle_set(&foc, 0, 100);
+  angle = foc.theta;
+  period_run();
+  period_run();
+  CHECK((foc_angle_type)(foc.theta - angle) == 200);
+
+  foc_stop(&foc);
+  CHECK(foc.state == FOC_STATE_STOP && !host_tmr1.brk_bit.oen);
+  count = foc.period_count;
+  period_run();
+  CHECK(foc.period_count == (uint32_t)count);
+  CHECK(foc.duty[0] == PWM_PERIOD / 2 && host_tmr1.c1dt == PWM_PERIOD / 2);
+}
+
+int main(void)
+{
+  sin_cos_test();
+  setup_test();
+  svpwm_test();
+  current_loop_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
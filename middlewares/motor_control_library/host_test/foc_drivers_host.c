@@ -0,0 +1,33 @@
+/**
+  **************************************************************************
+  * @file     foc_drivers_host.c
+  * @brief    tmr and adc drivers of the foc control host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* the real drivers write the peripheral registers of the model. the adc
+   calibration status functions are renamed, the test gives them a
+   calibration that ends at once, which plain memory does not do */
+#define adc_calibration_init_status_get  drv_adc_calibration_init_status_get
+#define adc_calibration_status_get       drv_adc_calibration_status_get
+
+#include "../../../libraries/drivers/src/at32f415_tmr.c"
+#include "../../../libraries/drivers/src/at32f415_adc.c"
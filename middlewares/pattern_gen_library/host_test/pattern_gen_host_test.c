@@ -0,0 +1,375 @@
+/**
+  **************************************************************************
+  * @file     pattern_gen_host_test.c
+  * @brief    host model of the dma pattern generator
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs pattern_gen against a model of the pacing timer and of a dma channel
+ * in loop mode: every timer overflow moves the next ring sample to the
+ * destination and raises the half and full transfer flags, the interrupt
+ * runs after every transfer or only every few of them.
+ * checks the transfer flags of dma1 and dma2 channels and the flexible
+ * request mapping, a segment list with repeats played sample for sample and
+ * then the idle sample, a looping list with late interrupts counted as
+ * underruns and without them played without a gap, 32-bit samples, and the
+ * ws2812, 8080 bus and sine encoders against golden values.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "pattern_gen.h"
+
+#define OUT_MAX                          4096
+#define PI                               3.14159265358979
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* timer and dma model, the drivers are these functions */
+static uint32_t dma_count, dma_size, dma_flags, dma_int, dma_on, tmr_on;
+static uint32_t flex_dma, flex_channel, flex_request;
+
+static uint16_t dest16;
+static uint32_t dest32;
+static uint32_t out[OUT_MAX];
+static int out_count, done_count;
+
+static int fails;
+
+void tmr_base_init(tmr_type *tmr_x, uint32_t tmr_pr, uint32_t tmr_div)
+{
+}
+
+void tmr_cnt_dir_set(tmr_type *tmr_x, tmr_count_mode_type tmr_cnt_dir)
+{
+}
+
+void tmr_dma_request_enable(tmr_type *tmr_x, tmr_dma_request_type dma_request, confirm_state new_state)
+{
+}
+
+void tmr_counter_value_set(tmr_type *tmr_x, uint32_t tmr_cnt_value)
+{
+}
+
+void tmr_counter_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+  tmr_on = new_state;
+}
+
+void dma_reset(dma_channel_type *dmax_channely)
+{
+}
+
+void dma_default_para_init(dma_init_type *dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(*dma_init_struct));
+}
+
+void dma_init(dma_channel_type *dmax_channely, dma_init_type *dma_init_struct)
+{
+  dma_size = dma_init_struct->buffer_size;
+}
+
+void dma_flexible_config(dma_type *dma_x, uint8_t flex_channelx, dma_flexible_request_type flexible_request)
+{
+  flex_dma = (uint32_t)dma_x;
+  flex_channel = flex_channelx;
+  flex_request = flexible_request;
+}
+
+void dma_interrupt_enable(dma_channel_type *dmax_channely, uint32_t dma_int_value, confirm_state new_state)
+{
+  dma_int = new_state ? dma_int_value : 0;
+}
+
+void dma_channel_enable(dma_channel_type *dmax_channely, confirm_state new_state)
+{
+  dma_on = new_state;
+}
+
+void dma_data_number_set(dma_channel_type *dmax_channely, uint16_t dma_data_number)
+{
+  dma_count = dma_data_number;
+}
+
+uint16_t dma_data_number_get(dma_channel_type *dmax_channely)
+{
+  return (uint16_t)dma_count;
+}
+
+flag_status dma_interrupt_flag_get(uint32_t dmax_int_flag)
+{
+  return (dma_flags & dmax_int_flag & 0x0FFFFFFF) ? SET : RESET;
+}
+
+void dma_flag_clear(uint32_t dmax_flag)
+{
+  dma_flags &= ~(dmax_flag & 0x0FFFFFFF);
+}
+
+static void done_handler(void)
+{
+  done_count++;
+}
+
+/* one pacing timer overflow: one transfer from the ring */
+static void transfer(pattern_type *pattern)
+{
+  uint32_t index;
+
+  if(!tmr_on || !dma_on)
+  {
+    return;
+  }
+  index = dma_size - dma_count;
+  if(pattern->cfg.width == PATTERN_WIDTH_32)
+  {
+    dest32 = ((uint32_t *)pattern->cfg.ring)[index];
+    out[out_count++] = dest32;
+  }
+  else
+  {
+    dest16 = ((uint16_t *)pattern->cfg.ring)[index];
+    out[out_count++] = dest16;
+  }
+  if(--dma_count == dma_size / 2)
+  {
+    dma_flags |= pattern->hdt_flag;
+  }
+  if(dma_count == 0)
+  {
+    dma_count = dma_size;
+    dma_flags |= pattern->fdt_flag;
+  }
+}
+
+static void flag_test(void)
+{
+  static uint16_t ring[8];
+  pattern_config_type cfg;
+  pattern_type pattern;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.tmr = TMR3;
+  cfg.request = DMA_FLEXIBLE_TMR3_OVERFLOW;
+  cfg.dest_addr = (uint32_t)&dest16;
+  cfg.width = PATTERN_WIDTH_16;
+  cfg.ring = ring;
+  cfg.ring_size = 8;
+
+  cfg.dma_channel = DMA1_CHANNEL1;
+  CHECK(pattern_init(&pattern, &cfg) == SUCCESS);
+  CHECK(pattern.hdt_flag == DMA1_HDT1_FLAG && pattern.fdt_flag == DMA1_FDT1_FLAG);
+  CHECK(flex_dma == (uint32_t)DMA1 && flex_channel == FLEX_CHANNEL1);
+  cfg.dma_channel = DMA1_CHANNEL7;
+  CHECK(pattern_init(&pattern, &cfg) == SUCCESS);
+  CHECK(pattern.hdt_flag == DMA1_HDT7_FLAG && pattern.fdt_flag == DMA1_FDT7_FLAG);
+  CHECK(flex_dma == (uint32_t)DMA1 && flex_channel == FLEX_CHANNEL7);
+  cfg.dma_channel = DMA2_CHANNEL3;
+  CHECK(pattern_init(&pattern, &cfg) == SUCCESS);
+  CHECK(pattern.hdt_flag == DMA2_HDT3_FLAG && pattern.fdt_flag == DMA2_FDT3_FLAG);
+  CHECK(flex_dma == (uint32_t)DMA2 && flex_channel == FLEX_CHANNEL3);
+  CHECK(flex_request == DMA_FLEXIBLE_TMR3_OVERFLOW);
+  CHECK(dma_int == (DMA_HDT_INT | DMA_FDT_INT));
+
+  /* the ring halves must be equal */
+  cfg.ring_size = 7;
+  CHECK(pattern_init(&pattern, &cfg) == ERROR);
+}
+
+static void list_test(void)
+{
+  static const uint16_t a[5] = {1, 2, 3, 4, 5}, b[3] = {10, 11, 12}, c[1] = {7};
+  static const pattern_segment_type seg_c = {c, 1, 0, NULL}, seg_b = {b, 3, 4, &seg_c}, seg_a = {a, 5, 2, &seg_b};
+  static pattern_segment_type loop;
+  static uint16_t ring[16];
+  uint32_t expect[64];
+  pattern_config_type cfg;
+  pattern_type pattern;
+  int index, repeat, count = 0;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.tmr = TMR3;
+  cfg.dma_channel = DMA2_CHANNEL4;
+  cfg.request = DMA_FLEXIBLE_TMR3_OVERFLOW;
+  cfg.dest_addr = (uint32_t)&dest16;
+  cfg.width = PATTERN_WIDTH_16;
+  cfg.ring = ring;
+  cfg.ring_size = 8;
+  cfg.idle = 0xEE;
+  cfg.done = done_handler;
+  CHECK(pattern_init(&pattern, &cfg) == SUCCESS);
+  CHECK(dest16 == 0xEE);
+
+  /* a a b b b b c, then the idle sample */
+  for(repeat = 0; repeat < 2; repeat++)
+  {
+    for(index = 0; index < 5; index++)
+    {
+      expect[count++] = a[index];
+    }
+  }
+  for(repeat = 0; repeat < 4; repeat++)
+  {
+    for(index = 0; index < 3; index++)
+    {
+      expect[count++] = b[index];
+    }
+  }
+  expect[count++] = c[0];
+
+  out_count = 0;
+  CHECK(pattern_start(&pattern, &seg_a) == SUCCESS);
+  CHECK(pattern_start(&pattern, &seg_a) == ERROR);
+  for(index = 0; index < 200 && pattern.state != PATTERN_STATE_IDLE; index++)
+  {
+    transfer(&pattern);
+    pattern_dma_irq_handler(&pattern);
+  }
+  printf("list: %d samples out for %d, %lu halves\n", out_count, count, (unsigned long)pattern.half_count);
+  CHECK(pattern.state == PATTERN_STATE_IDLE && done_count == 1 && dest16 == 0xEE);
+  CHECK(out_count >= count && out_count - count < 8);
+  CHECK(memcmp(out, expect, count * sizeof(uint32_t)) == 0);
+  for(index = count; index < out_count; index++)
+  {
+    CHECK(out[index] == 0xEE);
+  }
+  CHECK(pattern.underrun_count == 0);
+
+  /* a looping list: a late interrupt is an underrun */
+  loop.data = b;
+  loop.count = 3;
+  loop.repeat = 0;
+  loop.next = &loop;
+  CHECK(pattern_start(&pattern, &loop) == SUCCESS);
+  for(index = 0; index < 300; index++)
+  {
+    transfer(&pattern);
+    if(index % 7 == 6)
+    {
+      pattern_dma_irq_handler(&pattern);
+    }
+  }
+  printf("late interrupts: %lu underruns in %lu halves\n", (unsigned long)pattern.underrun_count, (unsigned long)pattern.half_count);
+  CHECK(pattern.state == PATTERN_STATE_RUN && pattern.underrun_count > 0);
+  pattern_stop(&pattern);
+  CHECK(dest16 == 0xEE && !tmr_on && !dma_on && pattern.state == PATTERN_STATE_IDLE);
+
+  /* in time, the loop plays without a gap */
+  out_count = 0;
+  pattern.underrun_count = 0;
+  CHECK(pattern_start(&pattern, &loop) == SUCCESS);
+  for(index = 0; index < 300; index++)
+  {
+    transfer(&pattern);
+    pattern_dma_irq_handler(&pattern);
+  }
+  for(index = 0; index < 300; index++)
+  {
+    CHECK(out[index] == b[index % 3]);
+  }
+  CHECK(pattern.underrun_count == 0 && done_count == 1);
+  pattern_stop(&pattern);
+}
+
+static void word_test(void)
+{
+  static const uint32_t set_reset[2] = {0x00010002, 0x00020001};
+  static const pattern_segment_type segment = {set_reset, 2, 9, NULL};
+  static uint32_t ring[4];
+  pattern_config_type cfg;
+  pattern_type pattern;
+  int index;
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.tmr = TMR2;
+  cfg.dma_channel = DMA1_CHANNEL2;
+  cfg.request = DMA_FLEXIBLE_TMR2_OVERFLOW;
+  cfg.dest_addr = (uint32_t)&dest32;
+  cfg.width = PATTERN_WIDTH_32;
+  cfg.ring = ring;
+  cfg.ring_size = 4;
+  cfg.idle = 0x00030000;
+  CHECK(pattern_init(&pattern, &cfg) == SUCCESS);
+  CHECK(dest32 == 0x00030000);
+
+  out_count = 0;
+  CHECK(pattern_start(&pattern, &segment) == SUCCESS);
+  for(index = 0; index < 100 && pattern.state != PATTERN_STATE_IDLE; index++)
+  {
+    transfer(&pattern);
+    pattern_dma_irq_handler(&pattern);
+  }
+  CHECK(pattern.state == PATTERN_STATE_IDLE && dest32 == 0x00030000);
+  CHECK(out_count >= 18);
+  for(index = 0; index < 18; index++)
+  {
+    CHECK(out[index] == set_reset[index % 2]);
+  }
+}
+
+static void encode_test(void)
+{
+  static const uint8_t grb[2] = {0xA5, 0x01}, data[2] = {0x5A, 0xFF};
+  static const uint16_t ws2812[16] = {60, 30, 60, 30, 30, 60, 30, 60, 30, 30, 30, 30, 30, 30, 30, 60};
+  uint16_t bits[16], sine[1000];
+  uint32_t words[4];
+  double error = 0;
+  int index;
+
+  /* ws2812: one compare value per bit, msb first */
+  CHECK(pattern_ws2812_encode(grb, 2, 30, 60, bits) == 16);
+  CHECK(memcmp(bits, ws2812, sizeof(ws2812)) == 0);
+
+  /* 8080: a data word with wr low, then the same with wr high */
+  CHECK(pattern_bus8080_encode(data, 2, 4, GPIO_PINS_4, words) == 0);
+  CHECK(pattern_bus8080_encode(data, 2, 9, GPIO_PINS_0, words) == 0);
+  CHECK(pattern_bus8080_encode(data, 2, 8, GPIO_PINS_9, words) == 0);
+  CHECK(pattern_bus8080_encode(data, 2, 0, GPIO_PINS_8, words) == 4);
+  CHECK(words[0] == (0x5A | (0xA5u << 16) | (0x100u << 16)) && words[1] == (0x5A | (0xA5u << 16) | 0x100));
+  CHECK(words[2] == (0xFF | (0x100u << 16)) && words[3] == (0xFF | 0x100));
+  CHECK(pattern_bus8080_encode(data, 1, 8, GPIO_PINS_0, words) == 2 && words[1] == (0x5A00 | 0xA5000000u | 1));
+
+  /* sine against libm */
+  pattern_sine_encode(1000, 2048, 2000, 0, sine);
+  for(index = 0; index < 1000; index++)
+  {
+    error = fmax(error, fabs(sine[index] - (2048 + 2000 * sin(2 * PI * index / 1000))));
+  }
+  printf("sine: max error %.3f lsb\n", error);
+  CHECK(error < 1.5);
+  pattern_sine_encode(4, 100, 50, 16384, sine);
+  CHECK(sine[0] == 150 && sine[1] == 100 && sine[2] == 50 && sine[3] == 100);
+}
+
+int main(void)
+{
+  flag_test();
+  list_test();
+  word_test();
+  encode_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
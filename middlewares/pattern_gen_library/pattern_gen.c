@@ -0,0 +1,457 @@
+/**
+  **************************************************************************
+  * @file     pattern_gen.c
+  * @brief    dma pattern generator library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "pattern_gen.h"
+#include <stddef.h>
+#include <string.h>
+
+/** @addtogroup AT32F415_middlewares_pattern_gen_library
+  * @{
+  */
+
+/** @defgroup PATTERN_GEN_library
+  * @brief dma pattern generator
+  * @{
+  */
+
+/** @defgroup PATTERN_GEN_private_definition
+  * @{
+  */
+
+#define PATTERN_DMA_CHANNEL_SPACE        0x14
+
+/**
+  * @brief sine of a quarter turn in 64 steps, q15
+  */
+static const int16_t pattern_sin_table[65] =
+{
+      0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+   6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+  12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+  18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+  23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+  27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+  30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+  32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+  32767
+};
+
+/**
+  * @}
+  */
+
+/** @defgroup PATTERN_GEN_private_functions
+  * @{
+  */
+
+/**
+  * @brief  flag of a dma channel from the matching channel 1 flag, the
+  *         channels are PATTERN_DMA_CHANNEL_SPACE apart and their flags four
+  *         bits apart.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  channel1_flag: DMA1_xxx1_FLAG
+  * @retval flag of the channel
+  */
+static uint32_t pattern_dma_flag(dma_channel_type *dma_channel, uint32_t channel1_flag)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    return 0x10000000 | (channel1_flag << ((base - DMA2_CHANNEL1_BASE) / PATTERN_DMA_CHANNEL_SPACE * 4));
+  }
+  return channel1_flag << ((base - DMA1_CHANNEL1_BASE) / PATTERN_DMA_CHANNEL_SPACE * 4);
+}
+
+/**
+  * @brief  write a sample to the destination register.
+  * @param  pattern: the generator
+  * @param  sample: value
+  * @retval none
+  */
+static void pattern_dest_write(pattern_type *pattern, uint32_t sample)
+{
+  if(pattern->cfg.width == PATTERN_WIDTH_32)
+  {
+    *(__IO uint32_t *)pattern->cfg.dest_addr = sample;
+  }
+  else
+  {
+    *(__IO uint16_t *)pattern->cfg.dest_addr = (uint16_t)sample;
+  }
+}
+
+/**
+  * @brief  fill one half of the ring from the segment list. after the end of
+  *         the list the idle sample fills the rest and the half is remembered
+  *         to stop once it has played.
+  * @param  pattern: the generator
+  * @param  half: 0 or 1
+  * @retval none
+  */
+static void pattern_fill(pattern_type *pattern, uint8_t half)
+{
+  const pattern_segment_type *segment;
+  uint32_t size = (pattern->cfg.width == PATTERN_WIDTH_32) ? 4 : 2;
+  uint16_t half_size = pattern->cfg.ring_size / 2, done = 0, count;
+  uint8_t *dest = (uint8_t *)pattern->cfg.ring + half * half_size * size;
+
+  while(done < half_size)
+  {
+    segment = pattern->segment;
+    if(segment == NULL)
+    {
+      for(; done < half_size; done++)
+      {
+        if(size == 4)
+        {
+          ((uint32_t *)dest)[done] = pattern->cfg.idle;
+        }
+        else
+        {
+          ((uint16_t *)dest)[done] = (uint16_t)pattern->cfg.idle;
+        }
+      }
+      if(pattern->state == PATTERN_STATE_RUN)
+      {
+        pattern->end_half = half;
+        pattern->state = PATTERN_STATE_DRAIN;
+      }
+      break;
+    }
+
+    count = segment->count - pattern->position;
+    if(count > half_size - done)
+    {
+      count = half_size - done;
+    }
+    memcpy(dest + done * size, (const uint8_t *)segment->data + pattern->position * size, count * size);
+    done += count;
+    pattern->position += count;
+
+    if(pattern->position >= segment->count)
+    {
+      pattern->position = 0;
+      if(++pattern->played >= segment->repeat)
+      {
+        pattern->played = 0;
+        pattern->segment = segment->next;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  a half of the ring has played: stop when it held the end of the
+  *         list, else refill it. the dma is expected in the other half.
+  * @param  pattern: the generator
+  * @param  half: 0 or 1
+  * @retval none
+  */
+static void pattern_half_done(pattern_type *pattern, uint8_t half)
+{
+  uint16_t half_size = pattern->cfg.ring_size / 2, index;
+
+  if(pattern->state == PATTERN_STATE_IDLE)
+  {
+    return;
+  }
+  if(pattern->state == PATTERN_STATE_DRAIN && pattern->end_half == half)
+  {
+    pattern_stop(pattern);
+    if(pattern->cfg.done != NULL)
+    {
+      pattern->cfg.done();
+    }
+    return;
+  }
+
+  index = pattern->cfg.ring_size - dma_data_number_get(pattern->cfg.dma_channel);
+  if((index < half_size) == (half == 0))
+  {
+    pattern->underrun_count++;
+  }
+  pattern_fill(pattern, half);
+  pattern->half_count++;
+}
+
+/**
+  * @brief  sine of an angle, linear between the quarter table steps.
+  * @param  angle: 65536 is a turn
+  * @retval sine, q15
+  */
+static int32_t pattern_sin(uint16_t angle)
+{
+  uint32_t value = angle & 0x3FFF, index, frac;
+  int32_t sine;
+
+  if(angle & 0x4000)
+  {
+    value = 0x4000 - value;
+  }
+  index = value >> 8;
+  frac = value & 0xFF;
+  sine = pattern_sin_table[index];
+  if(frac != 0)
+  {
+    sine += ((pattern_sin_table[index + 1] - sine) * (int32_t)frac) >> 8;
+  }
+  return (angle & 0x8000) ? -sine : sine;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup PATTERN_GEN_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  initialize the pacing timer and the dma channel, the destination
+  *         gets the idle sample. the timer clock, the destination peripheral
+  *         and the dma interrupt in the nvic are set up by the caller.
+  * @param  pattern: the generator
+  * @param  cfg: configuration
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status pattern_init(pattern_type *pattern, const pattern_config_type *cfg)
+{
+  dma_init_type dma_init_struct;
+  uint32_t base = (uint32_t)cfg->dma_channel, index;
+
+  if(cfg->ring == NULL || cfg->ring_size < 2 || (cfg->ring_size & 1) != 0)
+  {
+    return ERROR;
+  }
+
+  pattern->cfg = *cfg;
+  pattern->state = PATTERN_STATE_IDLE;
+  pattern->segment = NULL;
+  pattern->half_count = 0;
+  pattern->underrun_count = 0;
+  pattern->hdt_flag = pattern_dma_flag(cfg->dma_channel, DMA1_HDT1_FLAG);
+  pattern->fdt_flag = pattern_dma_flag(cfg->dma_channel, DMA1_FDT1_FLAG);
+
+  tmr_base_init(cfg->tmr, cfg->period, cfg->div);
+  tmr_cnt_dir_set(cfg->tmr, TMR_COUNT_UP);
+  tmr_dma_request_enable(cfg->tmr, TMR_OVERFLOW_DMA_REQUEST, TRUE);
+
+  dma_reset(cfg->dma_channel);
+  dma_default_para_init(&dma_init_struct);
+  dma_init_struct.buffer_size = cfg->ring_size;
+  dma_init_struct.direction = DMA_DIR_MEMORY_TO_PERIPHERAL;
+  dma_init_struct.memory_base_addr = (uint32_t)cfg->ring;
+  dma_init_struct.peripheral_base_addr = cfg->dest_addr;
+  if(cfg->width == PATTERN_WIDTH_32)
+  {
+    dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_WORD;
+    dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_WORD;
+  }
+  else
+  {
+    dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_HALFWORD;
+    dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_HALFWORD;
+  }
+  dma_init_struct.memory_inc_enable = TRUE;
+  dma_init_struct.peripheral_inc_enable = FALSE;
+  dma_init_struct.priority = DMA_PRIORITY_HIGH;
+  dma_init_struct.loop_mode_enable = TRUE;
+  dma_init(cfg->dma_channel, &dma_init_struct);
+
+  /* the flexible channel number is the channel's own */
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    index = (base - DMA2_CHANNEL1_BASE) / PATTERN_DMA_CHANNEL_SPACE;
+    dma_flexible_config(DMA2, (uint8_t)(FLEX_CHANNEL1 + index), cfg->request);
+  }
+  else
+  {
+    index = (base - DMA1_CHANNEL1_BASE) / PATTERN_DMA_CHANNEL_SPACE;
+    dma_flexible_config(DMA1, (uint8_t)(FLEX_CHANNEL1 + index), cfg->request);
+  }
+  dma_interrupt_enable(cfg->dma_channel, DMA_HDT_INT | DMA_FDT_INT, TRUE);
+
+  pattern_dest_write(pattern, cfg->idle);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  play a segment list. both halves of the ring are filled before
+  *         the timer starts, the first sample goes out at the first overflow.
+  * @param  pattern: the generator
+  * @param  segment: first segment
+  * @retval SUCCESS or ERROR when already playing
+  */
+error_status pattern_start(pattern_type *pattern, const pattern_segment_type *segment)
+{
+  if(pattern->state != PATTERN_STATE_IDLE || segment == NULL)
+  {
+    return ERROR;
+  }
+
+  pattern->segment = segment;
+  pattern->position = 0;
+  pattern->played = 0;
+  pattern->state = PATTERN_STATE_RUN;
+  pattern_fill(pattern, 0);
+  pattern_fill(pattern, 1);
+
+  dma_channel_enable(pattern->cfg.dma_channel, FALSE);
+  dma_data_number_set(pattern->cfg.dma_channel, pattern->cfg.ring_size);
+  dma_flag_clear(pattern->hdt_flag | pattern->fdt_flag);
+  dma_channel_enable(pattern->cfg.dma_channel, TRUE);
+
+  tmr_counter_value_set(pattern->cfg.tmr, 0);
+  tmr_counter_enable(pattern->cfg.tmr, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  stop at once and put the idle sample on the destination.
+  * @param  pattern: the generator
+  * @retval none
+  */
+void pattern_stop(pattern_type *pattern)
+{
+  tmr_counter_enable(pattern->cfg.tmr, FALSE);
+  dma_channel_enable(pattern->cfg.dma_channel, FALSE);
+  pattern->state = PATTERN_STATE_IDLE;
+  pattern->segment = NULL;
+  pattern_dest_write(pattern, pattern->cfg.idle);
+}
+
+/**
+  * @brief  half and full transfer of the ring, called from the dma channel
+  *         interrupt handler. a refill must finish before the dma is back in
+  *         the half, a late one is counted in underrun_count.
+  * @param  pattern: the generator
+  * @retval none
+  */
+void pattern_dma_irq_handler(pattern_type *pattern)
+{
+  if(dma_interrupt_flag_get(pattern->hdt_flag) != RESET)
+  {
+    dma_flag_clear(pattern->hdt_flag);
+    pattern_half_done(pattern, 0);
+  }
+  if(dma_interrupt_flag_get(pattern->fdt_flag) != RESET)
+  {
+    dma_flag_clear(pattern->fdt_flag);
+    pattern_half_done(pattern, 1);
+  }
+}
+
+/**
+  * @brief  ws2812 bits as compare values of a pwm channel with the pacing
+  *         timer period as bit time, most significant bit first. a segment of
+  *         0 repeated for 50 us or more latches the leds.
+  * @param  grb: green, red, blue bytes of the leds in chain order
+  * @param  length: bytes
+  * @param  t0h: high time of a 0 bit in timer ticks
+  * @param  t1h: high time of a 1 bit in timer ticks
+  * @param  out: length * 8 compare values
+  * @retval compare values written
+  */
+uint16_t pattern_ws2812_encode(const uint8_t *grb, uint16_t length, uint16_t t0h, uint16_t t1h, uint16_t *out)
+{
+  uint16_t index, count = 0;
+  uint8_t bit;
+
+  for(index = 0; index < length; index++)
+  {
+    for(bit = 0x80; bit != 0; bit >>= 1)
+    {
+      out[count++] = (grb[index] & bit) ? t1h : t0h;
+    }
+  }
+  return count;
+}
+
+/**
+  * @brief  8080 bus writes as GPIOx->scr words: data on eight pins from
+  *         data_pin up, wr low with the data, then wr high to latch it.
+  * @param  data: bytes to write
+  * @param  length: bytes
+  * @param  data_pin: lowest data pin number, 0..8
+  * @param  wr_pin: GPIO_PINS_x of wr, outside the data pins
+  * @param  out: length * 2 scr words
+  * @retval scr words written, 0 on a bad pin choice
+  */
+uint16_t pattern_bus8080_encode(const uint8_t *data, uint16_t length, uint8_t data_pin, uint16_t wr_pin, uint32_t *out)
+{
+  uint16_t index, count = 0;
+  uint32_t bus;
+
+  if(data_pin > 8 || (wr_pin & (0xFF << data_pin)) != 0)
+  {
+    return 0;
+  }
+
+  for(index = 0; index < length; index++)
+  {
+    bus = ((uint32_t)data[index] << data_pin) | ((uint32_t)(uint8_t)~data[index] << (data_pin + 16));
+    out[count++] = bus | ((uint32_t)wr_pin << 16);
+    out[count++] = bus | wr_pin;
+  }
+  return count;
+}
+
+/**
+  * @brief  one turn of a sine in count samples, offset + amplitude * sin,
+  *         e.g. a dac or pwm waveform, or the coil current of a microstepped
+  *         stepper with the second coil at phase 16384.
+  * @param  count: samples of the turn
+  * @param  offset: middle value
+  * @param  amplitude: peak value, at most offset
+  * @param  phase: start angle, 65536 is a turn
+  * @param  out: count samples
+  * @retval none
+  */
+void pattern_sine_encode(uint16_t count, uint16_t offset, uint16_t amplitude, uint16_t phase, uint16_t *out)
+{
+  uint16_t index;
+  uint16_t angle;
+
+  for(index = 0; index < count; index++)
+  {
+    angle = (uint16_t)(phase + ((uint32_t)index << 16) / count);
+    out[index] = (uint16_t)(offset + ((amplitude * pattern_sin(angle) + 16384) >> 15));
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
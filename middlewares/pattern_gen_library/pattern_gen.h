@@ -0,0 +1,160 @@
+/**
+  **************************************************************************
+  * @file     pattern_gen.h
+  * @brief    dma pattern generator library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PATTERN_GEN_H
+#define __PATTERN_GEN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_pattern_gen_library
+  * @{
+  */
+
+/** @defgroup PATTERN_GEN_library_definition
+  * @{
+  */
+
+/**
+  * @brief a pacing timer requests one dma transfer per overflow, the dma
+  *        channel is mapped to that request with dma_flexible_config and runs
+  *        in loop mode over a ring of samples. each half of the ring is
+  *        refilled from the segment list while the other half plays, so the
+  *        segments follow each other without a gap. the destination is any
+  *        peripheral register: GPIOx->odt (16-bit, the whole port), GPIOx->scr
+  *        (32-bit, set and reset of chosen pins) or a buffered TMRx->cxdt.
+  *        every sample costs a dma bus transfer, the sample rate is bounded
+  *        by the bus at a few mhz.
+  */
+
+/**
+  * @brief sample width
+  */
+typedef enum
+{
+  PATTERN_WIDTH_16                       = 0x00, /*!< halfword samples, odt or cxdt */
+  PATTERN_WIDTH_32                       = 0x01  /*!< word samples, scr */
+} pattern_width_type;
+
+/**
+  * @brief generator state
+  */
+typedef enum
+{
+  PATTERN_STATE_IDLE                     = 0x00, /*!< stopped, idle sample on the destination */
+  PATTERN_STATE_RUN                      = 0x01, /*!< segments playing */
+  PATTERN_STATE_DRAIN                    = 0x02  /*!< list ended, last samples playing */
+} pattern_state_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup PATTERN_GEN_library_handler
+  * @{
+  */
+
+/**
+  * @brief a segment plays count samples repeat times (0 plays once) and goes
+  *        on with next. a next pointing back to an earlier segment loops for
+  *        ever until pattern_stop.
+  */
+typedef struct pattern_segment_struct
+{
+  const void                             *data;                   /*!< samples, of the generator width */
+  uint16_t                               count;                   /*!< samples in data                 */
+  uint16_t                               repeat;                  /*!< times played                    */
+  const struct pattern_segment_struct    *next;                   /*!< following segment or NULL       */
+} pattern_segment_type;
+
+/**
+  * @brief configuration
+  */
+typedef struct
+{
+  tmr_type                               *tmr;                    /*!< pacing timer                    */
+  uint16_t                               period;                  /*!< pacing timer period register    */
+  uint16_t                               div;                     /*!< pacing timer divider register   */
+  dma_channel_type                       *dma_channel;            /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              request;                 /*!< the pacing timer overflow       */
+  uint32_t                               dest_addr;               /*!< destination register            */
+  pattern_width_type                     width;                   /*!< sample width                    */
+  void                                   *ring;                   /*!< ring of ring_size samples       */
+  uint16_t                               ring_size;               /*!< samples in the ring, even       */
+  uint32_t                               idle;                    /*!< sample after the last segment   */
+  void                                   (*done)(void);           /*!< called when the list ended, may be NULL */
+} pattern_config_type;
+
+/**
+  * @brief pattern generator
+  */
+typedef struct
+{
+  pattern_config_type                    cfg;                     /*!< configuration                   */
+  __IO pattern_state_type                state;                   /*!< generator state                 */
+  const pattern_segment_type             *segment;                /*!< segment being filled            */
+  uint16_t                               position;                /*!< next sample of the segment      */
+  uint16_t                               played;                  /*!< plays of the segment done       */
+  uint8_t                                end_half;                /*!< half holding the end of the list */
+  uint32_t                               hdt_flag;                /*!< half transfer flag of the channel */
+  uint32_t                               fdt_flag;                /*!< full transfer flag of the channel */
+  __IO uint32_t                          half_count;              /*!< halves refilled                 */
+  __IO uint32_t                          underrun_count;          /*!< refills later than their half   */
+} pattern_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup PATTERN_GEN_library_exported_functions
+  * @{
+  */
+
+error_status      pattern_init                  (pattern_type *pattern, const pattern_config_type *cfg);
+error_status      pattern_start                 (pattern_type *pattern, const pattern_segment_type *segment);
+void              pattern_stop                  (pattern_type *pattern);
+void              pattern_dma_irq_handler       (pattern_type *pattern);
+uint16_t          pattern_ws2812_encode         (const uint8_t *grb, uint16_t length, uint16_t t0h, uint16_t t1h, uint16_t *out);
+uint16_t          pattern_bus8080_encode        (const uint8_t *data, uint16_t length, uint8_t data_pin, uint16_t wr_pin, uint32_t *out);
+void              pattern_sine_encode           (uint16_t count, uint16_t offset, uint16_t amplitude, uint16_t phase, uint16_t *out);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,353 @@
+/**
+  **************************************************************************
+  * @file     pwm_scheduler_host_test.c
+  * @brief    host model of the pwm burst update scheduler
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs pwm_scheduler against a model of synchronized timers with buffered
+ * compare registers and of their dma channels: at every overflow the
+ * buffered values become the active ones and the overflow request starts a
+ * burst that moves the shadow table to the compare registers, one
+ * transfer per timer clock after a random latency. every counter or dma
+ * count read of the scheduler advances the model by a clock.
+ * checks the configuration checks and the burst setup, 20000 commits at
+ * random times: at every overflow the active values of every timer are one
+ * whole commit, the same commit on all timers, and the newest commit that
+ * returned at least two overflows before, then a stopped timer inside its
+ * guard gives up the commit and a 32-bit timer near the top of its count
+ * waits for the window after the wrap. the model itself sees the torn sets
+ * of a copy made without the window.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pwm_scheduler.h"
+
+#define TMR_COUNT                        3
+#define COMMIT_COUNT                     20000
+#define GUARD                            8
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* timers, the compare values driving the outputs and the dma bursts */
+static tmr_type tmr[TMR_COUNT];
+static dma_channel_type *channel[TMR_COUNT];
+static uint32_t active[TMR_COUNT][4];
+static int burst[TMR_COUNT], burst_index[TMR_COUNT], burst_delay[TMR_COUNT];
+static int burst_length[TMR_COUNT], burst_base[TMR_COUNT];
+static uint16_t dma_count[TMR_COUNT];
+static int timer_count = TMR_COUNT, stopped = -1, jitter, overrun;
+static uint32_t last_counter[TMR_COUNT];
+static pwm_sched_type sched;
+
+/* overflow count at the return of each commit */
+static long overflow_count, commit_done[COMMIT_COUNT + 2000];
+static int commit_last = -1, torn, skewed, stale;
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static int timer_index(tmr_type *tmr_x)
+{
+  return (int)(tmr_x - tmr);
+}
+
+static int channel_index(dma_channel_type *dmax_channely)
+{
+  int index;
+
+  for(index = 0; index < TMR_COUNT && channel[index] != dmax_channely; index++);
+  return index;
+}
+
+void tmr_output_channel_buffer_enable(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, confirm_state new_state)
+{
+}
+
+void tmr_dma_control_config(tmr_type *tmr_x, tmr_dma_transfer_length_type dma_length, tmr_dma_address_type dma_base_address)
+{
+  burst_length[timer_index(tmr_x)] = dma_length + 1;
+  burst_base[timer_index(tmr_x)] = dma_base_address;
+}
+
+void tmr_dma_request_enable(tmr_type *tmr_x, tmr_dma_request_type dma_request, confirm_state new_state)
+{
+}
+
+void dma_reset(dma_channel_type *dmax_channely)
+{
+}
+
+void dma_default_para_init(dma_init_type *dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(*dma_init_struct));
+}
+
+void dma_init(dma_channel_type *dmax_channely, dma_init_type *dma_init_struct)
+{
+  CHECK(dma_init_struct->loop_mode_enable == TRUE);
+  dma_count[channel_index(dmax_channely)] = dma_init_struct->buffer_size;
+}
+
+void dma_flexible_config(dma_type *dma_x, uint8_t flex_channelx, dma_flexible_request_type flexible_request)
+{
+}
+
+void dma_channel_enable(dma_channel_type *dmax_channely, confirm_state new_state)
+{
+}
+
+/* commit values of a commit, timer and channel */
+static uint32_t commit_value(int commit, int timer, int cdt)
+{
+  return 100 + (uint32_t)commit * 16 + timer * 4 + cdt;
+}
+
+/* at the overflow of the last timer: one whole commit, the same on all
+   timers, the newest that returned two overflows before */
+static void overflow_check(void)
+{
+  int timer, cdt, commit = -1, first = -1, expect = commit_last;
+
+  for(timer = 0; timer < timer_count; timer++)
+  {
+    commit = (active[timer][0] < 100) ? -1 : (int)(active[timer][0] - 100) / 16;
+    for(cdt = 0; cdt < 4; cdt++)
+    {
+      torn += (active[timer][cdt] != ((commit < 0) ? 0 : commit_value(commit, timer, cdt)));
+    }
+    if(timer == 0)
+    {
+      first = commit;
+    }
+    skewed += (commit != first);
+  }
+  while(expect >= 0 && commit_done[expect] > overflow_count - 2)
+  {
+    expect--;
+  }
+  stale += (first != expect);
+}
+
+/* one timer clock: a transfer of each pending burst, then the counters */
+static void clock_run(void)
+{
+  int timer, index;
+
+  for(timer = 0; timer < timer_count; timer++)
+  {
+    if(burst[timer] == 0)
+    {
+      continue;
+    }
+    if(burst_delay[timer] > 0)
+    {
+      burst_delay[timer]--;
+      continue;
+    }
+    index = burst_base[timer] - TMR_C1DT_ADDRESS + burst_index[timer]++;
+    (&tmr[timer].c1dt)[index] = sched.shadow[timer][index - (burst_base[timer] - TMR_C1DT_ADDRESS)];
+    if(--dma_count[timer] == 0)
+    {
+      dma_count[timer] = burst_length[timer];
+      burst[timer] = 0;
+    }
+  }
+  for(timer = 0; timer < timer_count; timer++)
+  {
+    if(timer == stopped)
+    {
+      continue;
+    }
+    if(tmr[timer].cval != tmr[timer].pr)
+    {
+      tmr[timer].cval++;
+      continue;
+    }
+    /* overflow: the buffered values load, the request starts a burst */
+    tmr[timer].cval = 0;
+    memcpy(active[timer], (const void *)&tmr[timer].c1dt, sizeof(active[timer]));
+    overrun += burst[timer];
+    burst[timer] = 1;
+    burst_index[timer] = 0;
+    burst_delay[timer] = jitter ? (int)(rand_get() % 3) : 0;
+    if(timer == timer_count - 1)
+    {
+      overflow_count++;
+      overflow_check();
+    }
+  }
+}
+
+uint32_t host_counter(tmr_type *tmr_x)
+{
+  clock_run();
+  last_counter[timer_index(tmr_x)] = tmr_x->cval;
+  return tmr_x->cval;
+}
+
+uint16_t dma_data_number_get(dma_channel_type *dmax_channely)
+{
+  clock_run();
+  return dma_count[channel_index(dmax_channely)];
+}
+
+static void clocks_run(uint32_t count)
+{
+  while(count-- > 0)
+  {
+    clock_run();
+  }
+}
+
+static void commit_stage(int commit)
+{
+  int timer, cdt;
+
+  for(timer = 0; timer < timer_count; timer++)
+  {
+    for(cdt = 0; cdt < 4; cdt++)
+    {
+      pwm_sched_set(&sched, (uint8_t)timer, (uint8_t)(cdt + 1), commit_value(commit, timer, cdt));
+    }
+  }
+}
+
+static void setup(pwm_sched_timer_type *timer)
+{
+  int index;
+
+  channel[0] = DMA1_CHANNEL2;
+  channel[1] = DMA1_CHANNEL5;
+  channel[2] = DMA2_CHANNEL1;
+  for(index = 0; index < TMR_COUNT; index++)
+  {
+    tmr[index].pr = 999;
+    timer[index].tmr = &tmr[index];
+    timer[index].dma_channel = channel[index];
+    timer[index].request = DMA_FLEXIBLE_TMR1_OVERFLOW;
+    timer[index].first_channel = 1;
+    timer[index].channel_count = 4;
+  }
+}
+
+static void config_test(pwm_sched_timer_type *timer)
+{
+  /* the guard leaves no window */
+  CHECK(pwm_sched_init(&sched, timer, TMR_COUNT, 500) == ERROR);
+  timer[1].first_channel = 2;
+  CHECK(pwm_sched_init(&sched, timer, TMR_COUNT, GUARD) == ERROR);
+  timer[1].first_channel = 1;
+  CHECK(pwm_sched_init(&sched, timer, 0, GUARD) == ERROR);
+  CHECK(pwm_sched_init(&sched, timer, TMR_COUNT, GUARD) == SUCCESS);
+  CHECK(burst_length[0] == 4 && burst_base[0] == TMR_C1DT_ADDRESS);
+}
+
+static void commit_test(void)
+{
+  int commit;
+
+  jitter = 1;
+  for(commit = 0; commit < COMMIT_COUNT; commit++)
+  {
+    commit_stage(commit);
+    /* not a channel of the timer, ignored */
+    pwm_sched_set(&sched, 0, 5, 0xDEAD);
+    CHECK(pwm_sched_commit(&sched) == SUCCESS);
+    commit_done[commit] = overflow_count;
+    commit_last = commit;
+    clocks_run(rand_get() % 2500);
+  }
+  clocks_run(3000);
+  printf("commits: %lu, %lu waited, %ld overflows\n", (unsigned long)sched.commit_count,
+         (unsigned long)sched.wait_count, overflow_count);
+  CHECK(sched.commit_count == COMMIT_COUNT && sched.wait_count > 0);
+  CHECK(torn == 0 && skewed == 0 && stale == 0 && overrun == 0);
+  CHECK(active[0][0] == commit_value(COMMIT_COUNT - 1, 0, 0));
+
+  /* a stopped timer inside its guard: the commit gives up after a period */
+  stopped = 1;
+  tmr[1].cval = 2;
+  CHECK(pwm_sched_commit(&sched) == ERROR && sched.timeout_count == 1);
+  stopped = -1;
+  tmr[1].cval = tmr[0].cval;
+  clocks_run(3000);
+  CHECK(pwm_sched_commit(&sched) == SUCCESS);
+
+  /* the model sees a copy made without the window */
+  for(commit = COMMIT_COUNT; commit < COMMIT_COUNT + 2000; commit++)
+  {
+    int timer, cdt;
+
+    commit_stage(commit);
+    for(timer = 0; timer < TMR_COUNT; timer++)
+    {
+      for(cdt = 0; cdt < 4; cdt++)
+      {
+        sched.shadow[timer][cdt] = sched.staging[timer][cdt];
+        clock_run();
+      }
+    }
+    commit_done[commit] = overflow_count;
+    commit_last = commit;
+    clocks_run(rand_get() % 2500);
+  }
+  printf("copy without the window: %d torn, %d skewed sets\n", torn, skewed);
+  CHECK(torn + skewed > 0);
+}
+
+/* a 32-bit timer of the plus mode: its period times the divider does not
+   fit 32 bits and the guard reaches past the top of the count */
+static void wide_test(pwm_sched_timer_type *timer)
+{
+  jitter = 0;
+  timer_count = 1;
+  memset(&tmr[0], 0, sizeof(tmr[0]));
+  tmr[0].pr = 0xFFFFFFFF;
+  tmr[0].div = 0xFFFF;
+  CHECK(pwm_sched_init(&sched, timer, 1, GUARD) == SUCCESS);
+  tmr[0].cval = 0xFFFFFFFF - GUARD / 2;
+  commit_stage(0);
+  CHECK(pwm_sched_commit(&sched) == SUCCESS);
+  CHECK(last_counter[0] >= GUARD && last_counter[0] <= 0xFFFFFFFF - GUARD);
+  CHECK(sched.wait_count == 1 && sched.timeout_count == 0);
+}
+
+int main(void)
+{
+  pwm_sched_timer_type timer[TMR_COUNT];
+
+  setup(timer);
+  config_test(timer);
+  commit_test();
+  wide_test(timer);
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+/**
+  **************************************************************************
+  * @file     pwm_scheduler_host_test.h
+  * @brief    timer counter hook of the pwm scheduler host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* forced into every translation unit of the test after at32_host.h: every
+   counter read of the scheduler advances the timer model by a clock */
+
+#ifndef __PWM_SCHEDULER_HOST_TEST_H
+#define __PWM_SCHEDULER_HOST_TEST_H
+
+uint32_t host_counter(tmr_type *tmr);
+
+#define PWM_SCHED_COUNTER(tmr)           host_counter(tmr)
+
+#endif
@@ -0,0 +1,276 @@
+/**
+  **************************************************************************
+  * @file     pwm_scheduler.c
+  * @brief    pwm burst update scheduler library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "pwm_scheduler.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_pwm_scheduler_library
+  * @{
+  */
+
+/** @defgroup PWM_SCHED_library
+  * @brief pwm burst update scheduler
+  * @{
+  */
+
+/** @defgroup PWM_SCHED_private_definition
+  * @{
+  */
+
+#define PWM_SCHED_DMA_CHANNEL_SPACE      0x14
+
+/**
+  * @}
+  */
+
+/** @defgroup PWM_SCHED_private_functions
+  * @{
+  */
+
+/**
+  * @brief  map a dma channel to a flexible request, the flexible channel
+  *         number is the channel's own.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  request: flexible request
+  * @retval none
+  */
+static void pwm_sched_dma_map(dma_channel_type *dma_channel, dma_flexible_request_type request)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    dma_flexible_config(DMA2, (uint8_t)(FLEX_CHANNEL1 + (base - DMA2_CHANNEL1_BASE) / PWM_SCHED_DMA_CHANNEL_SPACE), request);
+  }
+  else
+  {
+    dma_flexible_config(DMA1, (uint8_t)(FLEX_CHANNEL1 + (base - DMA1_CHANNEL1_BASE) / PWM_SCHED_DMA_CHANNEL_SPACE), request);
+  }
+}
+
+/**
+  * @brief  whether a timer is clear of its overflows by the guard and its
+  *         last burst is complete, so no burst starts before the guard ends.
+  * @param  sched: the scheduler
+  * @param  timer: timer index
+  * @retval TRUE in a safe window
+  */
+static confirm_state pwm_sched_window(pwm_sched_type *sched, uint8_t timer)
+{
+  pwm_sched_timer_type *t = &sched->timer[timer];
+  uint32_t counter = PWM_SCHED_COUNTER(t->tmr);
+
+  if(counter < sched->guard || counter > t->tmr->pr - sched->guard)
+  {
+    return FALSE;
+  }
+  if(dma_data_number_get(t->dma_channel) != t->channel_count)
+  {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup PWM_SCHED_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  take the timers over: buffer their compare channels, set up the
+  *         dma burst and start the dma on the overflow requests. the staging
+  *         table starts with the compare values in place. the guard in timer
+  *         ticks covers the burst and a commit of every timer.
+  * @param  sched: the scheduler
+  * @param  timer: timers
+  * @param  timer_count: 1..PWM_SCHED_TMR_MAX
+  * @param  guard: ticks kept clear of an overflow
+  * @retval SUCCESS or ERROR on a bad configuration
+  */
+error_status pwm_sched_init(pwm_sched_type *sched, const pwm_sched_timer_type *timer, uint8_t timer_count, uint16_t guard)
+{
+  dma_init_type dma_init_struct;
+  pwm_sched_timer_type *t;
+  __IO uint32_t *cdt;
+  uint8_t index, channel;
+
+  if(timer_count == 0 || timer_count > PWM_SCHED_TMR_MAX)
+  {
+    return ERROR;
+  }
+  for(index = 0; index < timer_count; index++)
+  {
+    if(timer[index].first_channel < 1 || timer[index].channel_count < 1 ||
+       timer[index].first_channel + timer[index].channel_count > PWM_SCHED_CHANNEL_MAX + 1 ||
+       timer[index].tmr->pr <= 2 * (uint32_t)guard)
+    {
+      return ERROR;
+    }
+  }
+
+  sched->timer_count = timer_count;
+  sched->guard = guard;
+  sched->commit_count = 0;
+  sched->wait_count = 0;
+  sched->timeout_count = 0;
+
+  for(index = 0; index < timer_count; index++)
+  {
+    t = &sched->timer[index];
+    *t = timer[index];
+
+    /* c1dt to c4dt are consecutive registers */
+    cdt = &t->tmr->c1dt + (t->first_channel - 1);
+    for(channel = 0; channel < t->channel_count; channel++)
+    {
+      sched->staging[index][channel] = cdt[channel];
+      sched->shadow[index][channel] = cdt[channel];
+      tmr_output_channel_buffer_enable(t->tmr, (tmr_channel_select_type)(TMR_SELECT_CHANNEL_1 + 2 * (t->first_channel - 1 + channel)), TRUE);
+    }
+
+    tmr_dma_control_config(t->tmr, (tmr_dma_transfer_length_type)(TMR_DMA_TRANSFER_1BYTE + t->channel_count - 1),
+                           (tmr_dma_address_type)(TMR_C1DT_ADDRESS + t->first_channel - 1));
+
+    dma_reset(t->dma_channel);
+    dma_default_para_init(&dma_init_struct);
+    dma_init_struct.buffer_size = t->channel_count;
+    dma_init_struct.direction = DMA_DIR_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_base_addr = (uint32_t)sched->shadow[index];
+    dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_WORD;
+    dma_init_struct.memory_inc_enable = TRUE;
+    dma_init_struct.peripheral_base_addr = (uint32_t)&t->tmr->dmadt;
+    dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_WORD;
+    dma_init_struct.peripheral_inc_enable = FALSE;
+    dma_init_struct.priority = DMA_PRIORITY_VERY_HIGH;
+    dma_init_struct.loop_mode_enable = TRUE;
+    dma_init(t->dma_channel, &dma_init_struct);
+    pwm_sched_dma_map(t->dma_channel, t->request);
+    dma_channel_enable(t->dma_channel, TRUE);
+
+    tmr_dma_request_enable(t->tmr, TMR_OVERFLOW_DMA_REQUEST, TRUE);
+  }
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  stage the next compare value of a channel, nothing changes on
+  *         the outputs before pwm_sched_commit. call it from the same context
+  *         as the commit.
+  * @param  sched: the scheduler
+  * @param  timer: timer index
+  * @param  channel: compare channel, 1..4, one of the timer's
+  * @param  value: compare value
+  * @retval none
+  */
+void pwm_sched_set(pwm_sched_type *sched, uint8_t timer, uint8_t channel, uint32_t value)
+{
+  pwm_sched_timer_type *t = &sched->timer[timer];
+
+  if(timer < sched->timer_count && channel >= t->first_channel && channel < t->first_channel + t->channel_count)
+  {
+    sched->staging[timer][channel - t->first_channel] = value;
+  }
+}
+
+/**
+  * @brief  hand the staging table to the dma of every timer. the timers are
+  *         polled until every one is in a safe window at once, which takes at
+  *         most twice the guard for synchronized timers, and only the copy
+  *         runs with interrupts off. the whole table then takes effect on all
+  *         of them at the same overflow. the wait gives up after as many polls
+  *         as the longest timer period has timer clocks, at least a period,
+  *         when a timer is stopped, the timers are not synchronized or a
+  *         burst does not complete. the poll count stops at UINT32_MAX.
+  * @param  sched: the scheduler
+  * @retval SUCCESS, or ERROR when no window came and nothing was committed
+  */
+error_status pwm_sched_commit(pwm_sched_type *sched)
+{
+  uint32_t primask, poll, polls = 0;
+  uint64_t period;
+  uint8_t index, channel;
+  confirm_state ready;
+
+  for(index = 0; index < sched->timer_count; index++)
+  {
+    /* a 32-bit period of the plus mode times the divider overflows 32 bits */
+    period = ((uint64_t)sched->timer[index].tmr->pr + 1) * ((uint64_t)sched->timer[index].tmr->div + 1);
+    period = (period > UINT32_MAX) ? UINT32_MAX : period;
+    polls = ((uint32_t)period > polls) ? (uint32_t)period : polls;
+  }
+
+  /* polls + 1 tries, also when polls is saturated */
+  poll = 0;
+  do
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    /* one window for all timers, else a timer checked late could miss the
+       overflow the others take the table at */
+    ready = TRUE;
+    for(index = 0; index < sched->timer_count && ready == TRUE; index++)
+    {
+      ready = pwm_sched_window(sched, index);
+    }
+    if(ready == TRUE)
+    {
+      for(index = 0; index < sched->timer_count; index++)
+      {
+        for(channel = 0; channel < sched->timer[index].channel_count; channel++)
+        {
+          sched->shadow[index][channel] = sched->staging[index][channel];
+        }
+      }
+      __set_PRIMASK(primask);
+
+      sched->commit_count++;
+      if(poll != 0)
+      {
+        sched->wait_count++;
+      }
+      return SUCCESS;
+    }
+    __set_PRIMASK(primask);
+  } while(poll++ < polls);
+
+  sched->timeout_count++;
+  return ERROR;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,128 @@
+/**
+  **************************************************************************
+  * @file     pwm_scheduler.h
+  * @brief    pwm burst update scheduler library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PWM_SCHEDULER_H
+#define __PWM_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_pwm_scheduler_library
+  * @{
+  */
+
+/** @defgroup PWM_SCHED_library_definition
+  * @{
+  */
+
+/**
+  * @brief every timer of the scheduler has a dma channel on its overflow
+  *        request and a dma burst over its consecutive compare registers.
+  *        the dma runs in loop mode and rewrites the shadow values of the
+  *        timer right after each overflow, the compare registers are
+  *        buffered and take them all at once at the following overflow. new
+  *        values go to a staging table, pwm_sched_commit copies it to the
+  *        shadows in a window clear of every overflow, so a commit is seen by
+  *        all timers two overflows later and never in part.
+  */
+#ifndef PWM_SCHED_TMR_MAX
+#define PWM_SCHED_TMR_MAX                4
+#endif
+#define PWM_SCHED_CHANNEL_MAX            4
+
+/**
+  * @brief counter of a timer, read while waiting for a safe window
+  */
+#ifndef PWM_SCHED_COUNTER
+#define PWM_SCHED_COUNTER(tmr)           ((tmr)->cval)
+#endif
+
+/**
+  * @}
+  */
+
+/** @defgroup PWM_SCHED_library_handler
+  * @{
+  */
+
+/**
+  * @brief a timer of the scheduler. its pwm channels are configured and the
+  *        timer started by the caller, timers meant to change together run
+  *        synchronized with the same period.
+  */
+typedef struct
+{
+  tmr_type                               *tmr;                    /*!< pwm timer                       */
+  dma_channel_type                       *dma_channel;            /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              request;                 /*!< overflow request of the timer   */
+  uint8_t                                first_channel;           /*!< first compare channel, 1..4     */
+  uint8_t                                channel_count;           /*!< consecutive channels updated    */
+} pwm_sched_timer_type;
+
+/**
+  * @brief scheduler
+  */
+typedef struct
+{
+  pwm_sched_timer_type                   timer[PWM_SCHED_TMR_MAX]; /*!< timers                         */
+  uint8_t                                timer_count;             /*!< timers in use                   */
+  uint16_t                               guard;                   /*!< ticks kept clear of an overflow */
+  uint32_t                               staging[PWM_SCHED_TMR_MAX][PWM_SCHED_CHANNEL_MAX];  /*!< next values */
+  uint32_t                               shadow[PWM_SCHED_TMR_MAX][PWM_SCHED_CHANNEL_MAX];   /*!< dma source */
+  __IO uint32_t                          commit_count;            /*!< commits                         */
+  __IO uint32_t                          wait_count;              /*!< commits that waited for a window */
+  __IO uint32_t                          timeout_count;           /*!< commits given up without a window */
+} pwm_sched_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup PWM_SCHED_library_exported_functions
+  * @{
+  */
+
+error_status      pwm_sched_init                (pwm_sched_type *sched, const pwm_sched_timer_type *timer, uint8_t timer_count, uint16_t guard);
+void              pwm_sched_set                 (pwm_sched_type *sched, uint8_t timer, uint8_t channel, uint32_t value);
+error_status      pwm_sched_commit              (pwm_sched_type *sched);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
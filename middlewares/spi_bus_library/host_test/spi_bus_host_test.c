@@ -0,0 +1,595 @@
+/**
+  **************************************************************************
+  * @file     spi_bus_host_test.c
+  * @brief    host model of the spi bus driver
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs spi_bus against memory mapped at the peripheral addresses, a model
+ * of its receive and transmit dma channels that moves one frame per step
+ * and three memory slaves on cs pins of GPIOA: a command frame, 0x02 write
+ * or 0x03 read, an address frame and data. every frame checks that exactly
+ * one slave is selected and that the spi runs at the slave's speed and
+ * mode, and the dma widths match the frame size; the spi may only be
+ * stopped or started with both channels off. checked: a queue of eight
+ * descriptors over two 8-bit slaves with cs held between command and data
+ * and no idle frame between descriptors; a 16-bit lsb first slave whose
+ * data is queued by the completion of its command, with interrupt latency;
+ * a 70000 frame transfer in two chunks; a dma error dropping the head.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "spi_bus.h"
+
+#define PERIPH_SIZE                      0x30000
+#define SLAVE_COUNT                      3
+#define BIG_LENGTH                       70000
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* a memory slave */
+typedef struct
+{
+  uint16_t pin;
+  uint32_t setup;
+  int selected, state, command, address;
+  uint16_t memory[256];
+} slave_type;
+
+/* a dma channel of the model, a new count restarts it */
+typedef struct
+{
+  dma_channel_type *channel;
+  uint32_t address;
+  uint16_t count;
+} dma_model_type;
+
+static uint32_t dma_flags;
+static int flexible[2][8];
+static uint16_t pins;
+static int cs_falls, enable_bad;
+static slave_type slave[SLAVE_COUNT];
+static spi_bus_device_type device[SLAVE_COUNT];
+static dma_model_type rx_model, tx_model;
+static long gaps, frames;
+
+static uint32_t rand_state = 1;
+static int fails;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+void spi_i2s_reset(spi_type *spi_x)
+{
+  memset((void *)spi_x, 0, 0x24);
+}
+
+void spi_default_para_init(spi_init_type *spi_init_struct)
+{
+  memset(spi_init_struct, 0, sizeof(*spi_init_struct));
+}
+
+void spi_init(spi_type *spi_x, spi_init_type *spi_init_struct)
+{
+  spi_x->ctrl1_bit.msten = spi_init_struct->master_slave_mode;
+  spi_x->ctrl1_bit.swcsen = 1;
+  spi_x->ctrl1_bit.swcsil = 1;
+}
+
+void spi_i2s_dma_transmitter_enable(spi_type *spi_x, confirm_state new_state)
+{
+  spi_x->ctrl2_bit.dmaten = new_state;
+}
+
+void spi_i2s_dma_receiver_enable(spi_type *spi_x, confirm_state new_state)
+{
+  spi_x->ctrl2_bit.dmaren = new_state;
+}
+
+/* the spi stops and starts between chunks only */
+void spi_enable(spi_type *spi_x, confirm_state new_state)
+{
+  if(rx_model.channel != NULL && (rx_model.channel->ctrl_bit.chen || tx_model.channel->ctrl_bit.chen))
+  {
+    enable_bad++;
+  }
+  spi_x->ctrl1_bit.spien = new_state;
+}
+
+flag_status spi_i2s_flag_get(spi_type *spi_x, uint32_t spi_i2s_flag)
+{
+  return RESET;
+}
+
+uint16_t spi_i2s_data_receive(spi_type *spi_x)
+{
+  return 0;
+}
+
+void dma_reset(dma_channel_type *dmax_channely)
+{
+  dmax_channely->ctrl = 0;
+  dmax_channely->dtcnt = 0;
+  dmax_channely->paddr = 0;
+  dmax_channely->maddr = 0;
+}
+
+void dma_default_para_init(dma_init_type *dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(*dma_init_struct));
+}
+
+void dma_init(dma_channel_type *dmax_channely, dma_init_type *dma_init_struct)
+{
+  dmax_channely->ctrl_bit.dtd = (dma_init_struct->direction == DMA_DIR_MEMORY_TO_PERIPHERAL);
+  dmax_channely->ctrl_bit.mincm = dma_init_struct->memory_inc_enable;
+  dmax_channely->ctrl_bit.mwidth = dma_init_struct->memory_data_width;
+  dmax_channely->ctrl_bit.pwidth = dma_init_struct->peripheral_data_width;
+  dmax_channely->ctrl_bit.chpl = dma_init_struct->priority;
+  dmax_channely->maddr = dma_init_struct->memory_base_addr;
+  dmax_channely->paddr = dma_init_struct->peripheral_base_addr;
+  dmax_channely->dtcnt = dma_init_struct->buffer_size;
+}
+
+void dma_flexible_config(dma_type *dma_x, uint8_t flex_channelx, dma_flexible_request_type flexible_request)
+{
+  flexible[dma_x == DMA2][flex_channelx] = flexible_request;
+}
+
+void dma_interrupt_enable(dma_channel_type *dmax_channely, uint32_t dma_int, confirm_state new_state)
+{
+  dmax_channely->ctrl |= dma_int;
+}
+
+flag_status dma_interrupt_flag_get(uint32_t dmax_int_flag)
+{
+  return (dma_flags & dmax_int_flag & 0x0FFFFFFF) ? SET : RESET;
+}
+
+void dma_flag_clear(uint32_t dmax_flag)
+{
+  dma_flags &= ~(dmax_flag & 0x0FFFFFFF);
+}
+
+void gpio_default_para_init(gpio_init_type *gpio_init_struct)
+{
+  memset(gpio_init_struct, 0, sizeof(*gpio_init_struct));
+}
+
+void gpio_init(gpio_type *gpio_x, gpio_init_type *gpio_init_struct)
+{
+}
+
+/* a slave released by its cs starts over with a command */
+void gpio_bits_set(gpio_type *gpio_x, uint16_t pins_set)
+{
+  int index;
+
+  pins |= pins_set;
+  for(index = 0; index < SLAVE_COUNT; index++)
+  {
+    if(pins_set & slave[index].pin)
+    {
+      slave[index].selected = 0;
+    }
+  }
+}
+
+void gpio_bits_reset(gpio_type *gpio_x, uint16_t pins_reset)
+{
+  cs_falls++;
+  pins &= ~pins_reset;
+}
+
+/* the private functions are checked too */
+#include "../spi_bus.c"
+
+static spi_bus_type bus;
+
+/* one frame on the wires, the frame the selected slave answers */
+static uint16_t slave_frame(uint16_t mosi)
+{
+  slave_type *selected = NULL;
+  uint32_t setup;
+  int index, count = 0;
+
+  for(index = 0; index < SLAVE_COUNT; index++)
+  {
+    if((pins & slave[index].pin) == 0)
+    {
+      selected = &slave[index];
+      count++;
+    }
+  }
+  CHECK(count == 1);
+  if(count != 1)
+  {
+    return 0xEEEE;
+  }
+
+  setup = SPI1->ctrl1_bit.mdiv_l | (SPI1->ctrl2_bit.mdiv_h << 3) | (SPI1->ctrl1_bit.clkpol << 4) |
+          (SPI1->ctrl1_bit.clkpha << 5) | (SPI1->ctrl1_bit.ltf << 6) | (SPI1->ctrl1_bit.fbn << 7);
+  CHECK(setup == selected->setup);
+
+  if(selected->selected == 0)
+  {
+    selected->selected = 1;
+    selected->state = 0;
+  }
+  switch(selected->state)
+  {
+    case 0:
+      selected->command = mosi;
+      selected->state = 1;
+      return 0xA5;
+    case 1:
+      selected->address = mosi & 0xFF;
+      selected->state = 2;
+      return 0x5A;
+    default:
+      if(selected->command == 0x02)
+      {
+        selected->memory[selected->address++ & 0xFF] = mosi;
+        return 0;
+      }
+      return selected->memory[selected->address++ & 0xFF];
+  }
+}
+
+static void dma_sync(dma_model_type *model)
+{
+  if(model->channel->ctrl_bit.chen && model->channel->dtcnt != model->count)
+  {
+    model->address = model->channel->maddr;
+    model->count = (uint16_t)model->channel->dtcnt;
+  }
+}
+
+/* one frame time: the transmit channel feeds the spi, the receive channel
+   takes the answer */
+static void step(void)
+{
+  dma_channel_type *rx = rx_model.channel, *tx = tx_model.channel;
+  uint32_t size;
+  uint16_t mosi, miso;
+
+  dma_sync(&rx_model);
+  dma_sync(&tx_model);
+  if(!(tx->ctrl_bit.chen && tx_model.count != 0 && SPI1->ctrl1_bit.spien))
+  {
+    if(bus.head != NULL)
+    {
+      gaps++;
+    }
+    return;
+  }
+  CHECK(rx->ctrl_bit.chen && rx_model.count == tx_model.count);
+  CHECK(tx->ctrl_bit.pwidth == SPI1->ctrl1_bit.fbn && tx->ctrl_bit.mwidth == SPI1->ctrl1_bit.fbn &&
+        rx->ctrl_bit.pwidth == SPI1->ctrl1_bit.fbn && rx->ctrl_bit.mwidth == SPI1->ctrl1_bit.fbn);
+
+  size = tx->ctrl_bit.mwidth ? 2 : 1;
+  mosi = (size == 2) ? *(uint16_t *)(uintptr_t)tx_model.address : *(uint8_t *)(uintptr_t)tx_model.address;
+  if(tx->ctrl_bit.mincm)
+  {
+    tx_model.address += size;
+  }
+  tx->dtcnt = --tx_model.count;
+
+  miso = slave_frame(mosi);
+  if(size == 2)
+  {
+    *(uint16_t *)(uintptr_t)rx_model.address = miso;
+  }
+  else
+  {
+    *(uint8_t *)(uintptr_t)rx_model.address = (uint8_t)miso;
+  }
+  if(rx->ctrl_bit.mincm)
+  {
+    rx_model.address += size;
+  }
+  rx->dtcnt = --rx_model.count;
+  if(rx_model.count == 0)
+  {
+    dma_flags |= bus.rx_fdt_flag;
+  }
+  frames++;
+}
+
+static int irq_pending(void)
+{
+  return (dma_flags & bus.rx_fdt_flag & 0x0FFFFFFF) != 0;
+}
+
+/* steps until the queue is empty, the interrupt comes up to latency frames
+   after its flag */
+static void run(int latency)
+{
+  int wait = -1;
+
+  while(bus.head != NULL || irq_pending())
+  {
+    step();
+    if(irq_pending())
+    {
+      if(wait < 0)
+      {
+        wait = latency ? (int)(rand_get() % (latency + 1)) : 0;
+      }
+      if(wait-- == 0)
+      {
+        spi_bus_dma_irq_handler(&bus);
+        wait = -1;
+      }
+    }
+  }
+}
+
+static int completes, chained;
+
+static void complete(spi_bus_transfer_type *transfer)
+{
+  completes++;
+}
+
+/* the command completion queues its data */
+static void chain(spi_bus_transfer_type *transfer)
+{
+  completes++;
+  if(transfer->context != NULL)
+  {
+    CHECK(spi_bus_submit(&bus, (spi_bus_transfer_type *)transfer->context) == SUCCESS);
+    chained++;
+  }
+}
+
+static void transfer_fill(spi_bus_transfer_type *transfer, int index, const void *tx, void *rx, uint32_t length,
+                          confirm_state cs_hold, void (*done)(spi_bus_transfer_type *), void *context)
+{
+  memset(transfer, 0, sizeof(*transfer));
+  transfer->device = &device[index];
+  transfer->tx = tx;
+  transfer->rx = rx;
+  transfer->length = length;
+  transfer->cs_hold = cs_hold;
+  transfer->complete = done;
+  transfer->context = context;
+}
+
+static void init_test(void)
+{
+  spi_bus_config_type cfg;
+  uint32_t division;
+  int index;
+
+  CHECK(spi_bus_dma_flag(DMA1_CHANNEL2, DMA1_FDT1_FLAG) == DMA1_FDT2_FLAG);
+  CHECK(spi_bus_dma_flag(DMA2_CHANNEL5, DMA1_DTERR1_FLAG) == DMA2_DTERR5_FLAG);
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.spi = SPI1;
+  cfg.tx_dma_channel = DMA1_CHANNEL3;
+  cfg.tx_request = DMA_FLEXIBLE_SPI1_TX;
+  cfg.rx_dma_channel = DMA1_CHANNEL3;
+  cfg.rx_request = DMA_FLEXIBLE_SPI1_RX;
+  cfg.fill = 0xFF;
+  CHECK(spi_bus_init(&bus, &cfg) == ERROR);
+  cfg.rx_dma_channel = DMA1_CHANNEL2;
+  CHECK(spi_bus_init(&bus, &cfg) == SUCCESS);
+  CHECK(flexible[0][FLEX_CHANNEL2] == DMA_FLEXIBLE_SPI1_RX && flexible[0][FLEX_CHANNEL3] == DMA_FLEXIBLE_SPI1_TX);
+  CHECK(DMA1_CHANNEL2->ctrl_bit.chpl > DMA1_CHANNEL3->ctrl_bit.chpl);
+  rx_model.channel = DMA1_CHANNEL2;
+  tx_model.channel = DMA1_CHANNEL3;
+
+  for(index = 0; index < SLAVE_COUNT; index++)
+  {
+    spi_bus_device_init(&device[index], GPIOA, (uint16_t)(GPIO_PINS_0 << index));
+    slave[index].pin = (uint16_t)(GPIO_PINS_0 << index);
+  }
+  CHECK(pins == 0x7);
+  device[1].mclk_freq_division = SPI_MCLK_DIV_1024;
+  device[1].clock_polarity = SPI_CLOCK_POLARITY_HIGH;
+  device[1].clock_phase = SPI_CLOCK_PHASE_2EDGE;
+  device[2].frame_bit_num = SPI_FRAME_16BIT;
+  device[2].first_bit_transmission = SPI_FIRST_BIT_LSB;
+  device[2].mclk_freq_division = SPI_MCLK_DIV_8;
+
+  /* the slave sees the division as its low bits and the high bit */
+  for(index = 0; index < SLAVE_COUNT; index++)
+  {
+    division = device[index].mclk_freq_division;
+    slave[index].setup = (spi_bus_setup_get(&device[index]) & ~0xFu) |
+                         ((division > SPI_MCLK_DIV_256) ? (8 | (division & 7)) : division);
+  }
+}
+
+static void queue_test(void)
+{
+  static uint8_t command_write[2][2], command_read[2][2], answer[2];
+  static uint8_t write_data[2][256], read_data[2][256];
+  static spi_bus_transfer_type transfer[8];
+  int index, slave_index;
+
+  CHECK(spi_bus_submit(&bus, &transfer[0]) == ERROR);
+
+  /* write then read both 8-bit slaves, command and data as two descriptors
+     with cs held */
+  for(slave_index = 0; slave_index < 2; slave_index++)
+  {
+    for(index = 0; index < 256; index++)
+    {
+      write_data[slave_index][index] = (uint8_t)(index * 7 + slave_index);
+    }
+    command_write[slave_index][0] = 0x02;
+    command_read[slave_index][0] = 0x03;
+  }
+  transfer_fill(&transfer[0], 0, command_write[0], answer, 2, TRUE, complete, NULL);
+  transfer_fill(&transfer[1], 0, write_data[0], NULL, 200, FALSE, complete, NULL);
+  transfer_fill(&transfer[2], 1, command_write[1], NULL, 2, TRUE, complete, NULL);
+  transfer_fill(&transfer[3], 1, write_data[1], NULL, 256, FALSE, complete, NULL);
+  transfer_fill(&transfer[4], 0, command_read[0], NULL, 2, TRUE, complete, NULL);
+  transfer_fill(&transfer[5], 0, NULL, read_data[0], 200, FALSE, complete, NULL);
+  transfer_fill(&transfer[6], 1, command_read[1], NULL, 2, TRUE, complete, NULL);
+  transfer_fill(&transfer[7], 1, NULL, read_data[1], 256, FALSE, complete, NULL);
+  gaps = 0;
+  frames = 0;
+  cs_falls = 0;
+  completes = 0;
+  for(index = 0; index < 8; index++)
+  {
+    CHECK(spi_bus_submit(&bus, &transfer[index]) == SUCCESS);
+  }
+  CHECK(spi_bus_submit(&bus, &transfer[3]) == ERROR);
+  CHECK(transfer[0].status == SPI_BUS_STATUS_ACTIVE && transfer[1].status == SPI_BUS_STATUS_QUEUED);
+  CHECK(spi_bus_busy_get(&bus) == SET);
+  run(0);
+
+  CHECK(spi_bus_busy_get(&bus) == RESET && completes == 8 && pins == 0x7);
+  for(index = 0; index < 8; index++)
+  {
+    CHECK(transfer[index].status == SPI_BUS_STATUS_DONE);
+  }
+  CHECK(answer[0] == 0xA5 && answer[1] == 0x5A);
+  CHECK(memcmp(read_data[0], write_data[0], 200) == 0 && memcmp(read_data[1], write_data[1], 256) == 0);
+  CHECK(slave[0].memory[199] == write_data[0][199] && slave[0].memory[200] == 0);
+  CHECK(cs_falls == 4 && bus.reconfig_count == 4);
+  CHECK(gaps == 0);
+  printf("queue of 8: %ld frames, %ld idle frame slots, %d cs assertions, %u spi setups\n",
+         frames, gaps, cs_falls, (unsigned)bus.reconfig_count);
+}
+
+static void chain_test(void)
+{
+  static uint16_t command_write[2] = {0x02, 0x10}, command_read[2] = {0x03, 0x10};
+  static uint16_t write_data[256], read_data[256];
+  static spi_bus_transfer_type transfer[4];
+  int index;
+
+  for(index = 0; index < 256; index++)
+  {
+    write_data[index] = (uint16_t)(0x1234 + index * 0x0101);
+  }
+
+  /* the read command queued behind the write command comes before the
+     chained write data, the held cs is given up for it */
+  transfer_fill(&transfer[1], 2, write_data, NULL, 100, FALSE, complete, NULL);
+  transfer_fill(&transfer[0], 2, command_write, NULL, 2, TRUE, chain, &transfer[1]);
+  transfer_fill(&transfer[3], 2, NULL, read_data, 100, FALSE, complete, NULL);
+  transfer_fill(&transfer[2], 2, command_read, NULL, 2, TRUE, chain, &transfer[3]);
+  CHECK(spi_bus_submit(&bus, &transfer[0]) == SUCCESS);
+  CHECK(spi_bus_submit(&bus, &transfer[2]) == SUCCESS);
+  run(5);
+  CHECK(spi_bus_busy_get(&bus) == RESET && pins == 0x7);
+  CHECK(transfer[1].status == SPI_BUS_STATUS_DONE && transfer[3].status == SPI_BUS_STATUS_DONE);
+
+  /* one after the other, each data on the held cs of its command */
+  memset(read_data, 0, sizeof(read_data));
+  completes = 0;
+  chained = 0;
+  cs_falls = 0;
+  transfer_fill(&transfer[1], 2, write_data, NULL, 100, FALSE, complete, NULL);
+  transfer_fill(&transfer[0], 2, command_write, NULL, 2, TRUE, chain, &transfer[1]);
+  transfer_fill(&transfer[3], 2, NULL, read_data, 100, FALSE, complete, NULL);
+  transfer_fill(&transfer[2], 2, command_read, NULL, 2, TRUE, chain, &transfer[3]);
+  CHECK(spi_bus_submit(&bus, &transfer[0]) == SUCCESS);
+  run(5);
+  CHECK(spi_bus_submit(&bus, &transfer[2]) == SUCCESS);
+  run(5);
+  CHECK(chained == 2 && completes == 4 && cs_falls == 2);
+  CHECK(memcmp(read_data, write_data, 200) == 0);
+  CHECK(slave[2].memory[0x10] == 0x1234 && slave[2].memory[0x10 + 99] == write_data[99]);
+  printf("16-bit lsb first slave, data chained by completions: %d chained, %d cs assertions\n", chained, cs_falls);
+}
+
+static void chunk_test(void)
+{
+  static uint8_t tx[BIG_LENGTH], rx[BIG_LENGTH];
+  static spi_bus_transfer_type transfer;
+  uint32_t chunks = bus.chunk_count;
+  int index, last;
+
+  for(index = 0; index < BIG_LENGTH; index++)
+  {
+    tx[index] = (uint8_t)(index * 13);
+  }
+  tx[0] = 0x02;
+  tx[1] = 0x00;
+  transfer_fill(&transfer, 1, tx, rx, BIG_LENGTH, FALSE, complete, NULL);
+  cs_falls = 0;
+  gaps = 0;
+  CHECK(spi_bus_submit(&bus, &transfer) == SUCCESS);
+  run(3);
+  CHECK(transfer.status == SPI_BUS_STATUS_DONE && bus.chunk_count - chunks == 2 && cs_falls == 1);
+  CHECK(rx[0] == 0xA5 && rx[1] == 0x5A);
+
+  /* the slave memory wraps at 256, the last write of an address stays */
+  for(index = 0; index < 256; index++)
+  {
+    last = 2 + ((BIG_LENGTH - 2 - 1 - index) / 256) * 256 + index;
+    CHECK(slave[1].memory[index] == tx[last]);
+  }
+  printf("%d frames: %u chunks, %ld idle frame slots with latency up to 3\n",
+         BIG_LENGTH, (unsigned)(bus.chunk_count - chunks), gaps);
+}
+
+static void error_test(void)
+{
+  static uint8_t command[2][2] = {{0x03, 0x00}, {0x03, 0x00}};
+  static spi_bus_transfer_type transfer[2];
+
+  completes = 0;
+  transfer_fill(&transfer[0], 0, command[0], NULL, 2, FALSE, complete, NULL);
+  transfer_fill(&transfer[1], 1, command[1], NULL, 2, FALSE, complete, NULL);
+  CHECK(spi_bus_submit(&bus, &transfer[0]) == SUCCESS && spi_bus_submit(&bus, &transfer[1]) == SUCCESS);
+  dma_flags |= bus.tx_dterr_flag;
+  spi_bus_dma_irq_handler(&bus);
+  CHECK(transfer[0].status == SPI_BUS_STATUS_ERROR && bus.error_count == 1);
+  CHECK(transfer[1].status == SPI_BUS_STATUS_ACTIVE);
+  CHECK(spi_bus_transfer_wait(&transfer[0]) == ERROR);
+  run(0);
+  CHECK(spi_bus_transfer_wait(&transfer[1]) == SUCCESS && completes == 2 && pins == 0x7);
+}
+
+int main(void)
+{
+  if(mmap((void *)PERIPH_BASE, PERIPH_SIZE, PROT_READ | PROT_WRITE,
+          MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) != (void *)PERIPH_BASE)
+  {
+    printf("peripheral memory not mapped\n");
+    return 1;
+  }
+
+  init_test();
+  queue_test();
+  chain_test();
+  chunk_test();
+  error_test();
+  CHECK(enable_bad == 0);
+
+  printf(fails ? "FAILED\n" : "PASSED\n");
+  return fails ? 1 : 0;
+}
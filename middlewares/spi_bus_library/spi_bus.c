@@ -0,0 +1,502 @@
+/**
+  **************************************************************************
+  * @file     spi_bus.c
+  * @brief    spi bus driver library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "spi_bus.h"
+#include <stddef.h>
+
+/** @addtogroup AT32F415_middlewares_spi_bus_library
+  * @{
+  */
+
+/** @defgroup SPI_BUS_library
+  * @brief spi bus driver
+  * @{
+  */
+
+/** @defgroup SPI_BUS_private_definition
+  * @{
+  */
+
+#define SPI_BUS_DMA_CHANNEL_SPACE        0x14
+#define SPI_BUS_SETUP_NONE               0xFFFFFFFF
+
+/**
+  * @}
+  */
+
+/** @defgroup SPI_BUS_private_functions
+  * @{
+  */
+
+/**
+  * @brief  flag of a dma channel from the matching channel 1 flag, the
+  *         channels are SPI_BUS_DMA_CHANNEL_SPACE apart and their flags four
+  *         bits apart.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  channel1_flag: DMA1_xxx1_FLAG
+  * @retval flag of the channel
+  */
+static uint32_t spi_bus_dma_flag(dma_channel_type *dma_channel, uint32_t channel1_flag)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    return 0x10000000 | (channel1_flag << ((base - DMA2_CHANNEL1_BASE) / SPI_BUS_DMA_CHANNEL_SPACE * 4));
+  }
+  return channel1_flag << ((base - DMA1_CHANNEL1_BASE) / SPI_BUS_DMA_CHANNEL_SPACE * 4);
+}
+
+/**
+  * @brief  map a dma channel to a flexible request, the flexible channel
+  *         number is the channel's own.
+  * @param  dma_channel: DMA1_CHANNELx or DMA2_CHANNELx
+  * @param  request: flexible request
+  * @retval none
+  */
+static void spi_bus_dma_map(dma_channel_type *dma_channel, dma_flexible_request_type request)
+{
+  uint32_t base = (uint32_t)dma_channel;
+
+  if(base >= DMA2_CHANNEL1_BASE)
+  {
+    dma_flexible_config(DMA2, (uint8_t)(FLEX_CHANNEL1 + (base - DMA2_CHANNEL1_BASE) / SPI_BUS_DMA_CHANNEL_SPACE), request);
+  }
+  else
+  {
+    dma_flexible_config(DMA1, (uint8_t)(FLEX_CHANNEL1 + (base - DMA1_CHANNEL1_BASE) / SPI_BUS_DMA_CHANNEL_SPACE), request);
+  }
+}
+
+/**
+  * @brief  spi setup of a device packed in a word, devices with the same
+  *         word share the setup.
+  * @param  device: the device
+  * @retval setup word
+  */
+static uint32_t spi_bus_setup_get(const spi_bus_device_type *device)
+{
+  return (uint32_t)device->mclk_freq_division | ((uint32_t)device->clock_polarity << 4) |
+         ((uint32_t)device->clock_phase << 5) | ((uint32_t)device->first_bit_transmission << 6) |
+         ((uint32_t)device->frame_bit_num << 7);
+}
+
+/**
+  * @brief  set the spi up for a device, its cs and any other cs are high.
+  *         called with both dma channels off.
+  * @param  bus: the bus
+  * @param  device: the device
+  * @param  setup: setup word of the device
+  * @retval none
+  */
+static void spi_bus_configure(spi_bus_type *bus, const spi_bus_device_type *device, uint32_t setup)
+{
+  spi_type *spi = bus->cfg.spi;
+
+  spi_enable(spi, FALSE);
+  if(device->mclk_freq_division > SPI_MCLK_DIV_256)
+  {
+    spi->ctrl2_bit.mdiv_h = 1;
+    spi->ctrl1_bit.mdiv_l = device->mclk_freq_division & 0x7;
+  }
+  else
+  {
+    spi->ctrl2_bit.mdiv_h = 0;
+    spi->ctrl1_bit.mdiv_l = device->mclk_freq_division;
+  }
+  spi->ctrl1_bit.ltf = device->first_bit_transmission;
+  spi->ctrl1_bit.fbn = device->frame_bit_num;
+  spi->ctrl1_bit.clkpol = device->clock_polarity;
+  spi->ctrl1_bit.clkpha = device->clock_phase;
+
+  /* the frame size is the dma transfer size */
+  bus->cfg.rx_dma_channel->ctrl_bit.pwidth = device->frame_bit_num;
+  bus->cfg.rx_dma_channel->ctrl_bit.mwidth = device->frame_bit_num;
+  bus->cfg.tx_dma_channel->ctrl_bit.pwidth = device->frame_bit_num;
+  bus->cfg.tx_dma_channel->ctrl_bit.mwidth = device->frame_bit_num;
+  spi_enable(spi, TRUE);
+
+  bus->setup = setup;
+  bus->reconfig_count++;
+}
+
+/**
+  * @brief  drive the cs of the holding device high.
+  * @param  bus: the bus
+  * @retval none
+  */
+static void spi_bus_cs_release(spi_bus_type *bus)
+{
+  if(bus->cs_device != NULL)
+  {
+    if(bus->cs_device->cs_gpio != NULL)
+    {
+      gpio_bits_set(bus->cs_device->cs_gpio, bus->cs_device->cs_pin);
+    }
+    bus->cs_device = NULL;
+  }
+}
+
+/**
+  * @brief  start the next chunk of the head transfer. called with the
+  *         receive channel interrupt masked, from it or with interrupts off.
+  * @param  bus: the bus
+  * @retval none
+  */
+static void spi_bus_chunk_start(spi_bus_type *bus)
+{
+  spi_bus_transfer_type *transfer = bus->head;
+  const spi_bus_device_type *device = transfer->device;
+  dma_channel_type *rx = bus->cfg.rx_dma_channel;
+  dma_channel_type *tx = bus->cfg.tx_dma_channel;
+  uint32_t offset, remaining, setup;
+
+  /* both channels stop before the spi or their widths change */
+  rx->ctrl_bit.chen = FALSE;
+  tx->ctrl_bit.chen = FALSE;
+
+  if(transfer->status != SPI_BUS_STATUS_ACTIVE)
+  {
+    if(bus->cs_device != device)
+    {
+      spi_bus_cs_release(bus);
+      setup = spi_bus_setup_get(device);
+      if(bus->setup != setup)
+      {
+        spi_bus_configure(bus, device, setup);
+      }
+      if(device->cs_gpio != NULL)
+      {
+        gpio_bits_reset(device->cs_gpio, device->cs_pin);
+      }
+      bus->cs_device = device;
+    }
+    transfer->done = 0;
+    transfer->status = SPI_BUS_STATUS_ACTIVE;
+  }
+
+  remaining = transfer->length - transfer->done;
+  transfer->chunk = (uint16_t)((remaining > SPI_BUS_CHUNK_MAX) ? SPI_BUS_CHUNK_MAX : remaining);
+  offset = transfer->done << device->frame_bit_num;
+
+  if(transfer->rx != NULL)
+  {
+    rx->maddr = (uint32_t)transfer->rx + offset;
+    rx->ctrl_bit.mincm = TRUE;
+  }
+  else
+  {
+    rx->maddr = (uint32_t)&bus->sink;
+    rx->ctrl_bit.mincm = FALSE;
+  }
+  if(transfer->tx != NULL)
+  {
+    tx->maddr = (uint32_t)transfer->tx + offset;
+    tx->ctrl_bit.mincm = TRUE;
+  }
+  else
+  {
+    tx->maddr = (uint32_t)&bus->cfg.fill;
+    tx->ctrl_bit.mincm = FALSE;
+  }
+  rx->dtcnt = transfer->chunk;
+  tx->dtcnt = transfer->chunk;
+  /* receive first, the spi only moves when the transmit channel writes */
+  rx->ctrl_bit.chen = TRUE;
+  tx->ctrl_bit.chen = TRUE;
+  bus->chunk_count++;
+}
+
+/**
+  * @brief  take the head transfer off the queue and start the next one.
+  * @param  bus: the bus
+  * @param  status: SPI_BUS_STATUS_DONE or SPI_BUS_STATUS_ERROR
+  * @retval the finished transfer
+  */
+static spi_bus_transfer_type *spi_bus_finish(spi_bus_type *bus, spi_bus_status_type status)
+{
+  spi_bus_transfer_type *transfer = bus->head;
+
+  bus->head = transfer->next;
+  if(bus->head == NULL)
+  {
+    bus->tail = NULL;
+  }
+  transfer->next = NULL;
+  if(transfer->cs_hold == FALSE || status != SPI_BUS_STATUS_DONE)
+  {
+    spi_bus_cs_release(bus);
+  }
+
+  if(bus->head != NULL)
+  {
+    spi_bus_chunk_start(bus);
+  }
+  transfer->status = status;
+  return transfer;
+}
+
+/**
+  * @}
+  */
+
+/** @defgroup SPI_BUS_exported_functions
+  * @{
+  */
+
+/**
+  * @brief  set the spi up as full duplex master and its two dma channels.
+  *         the spi, dma and gpio clocks and the sck, miso and mosi pins are
+  *         set up by the caller, the receive channel interrupt is enabled in
+  *         the nvic by the caller.
+  * @param  bus: the bus
+  * @param  cfg: configuration, copied
+  * @retval SUCCESS, or ERROR on a bad configuration
+  */
+error_status spi_bus_init(spi_bus_type *bus, const spi_bus_config_type *cfg)
+{
+  spi_init_type spi_init_struct;
+  dma_init_type dma_init_struct;
+
+  if(cfg->spi == NULL || cfg->tx_dma_channel == NULL || cfg->rx_dma_channel == NULL ||
+     cfg->tx_dma_channel == cfg->rx_dma_channel)
+  {
+    return ERROR;
+  }
+
+  bus->cfg = *cfg;
+  bus->head = NULL;
+  bus->tail = NULL;
+  bus->setup = SPI_BUS_SETUP_NONE;
+  bus->cs_device = NULL;
+  bus->sink = 0;
+  bus->transfer_count = 0;
+  bus->chunk_count = 0;
+  bus->reconfig_count = 0;
+  bus->error_count = 0;
+  bus->rx_fdt_flag = spi_bus_dma_flag(cfg->rx_dma_channel, DMA1_FDT1_FLAG);
+  bus->rx_dterr_flag = spi_bus_dma_flag(cfg->rx_dma_channel, DMA1_DTERR1_FLAG);
+  bus->tx_dterr_flag = spi_bus_dma_flag(cfg->tx_dma_channel, DMA1_DTERR1_FLAG);
+
+  spi_i2s_reset(cfg->spi);
+  spi_default_para_init(&spi_init_struct);
+  spi_init_struct.transmission_mode = SPI_TRANSMIT_FULL_DUPLEX;
+  spi_init_struct.master_slave_mode = SPI_MODE_MASTER;
+  spi_init_struct.cs_mode_selection = SPI_CS_SOFTWARE_MODE;
+  spi_init(cfg->spi, &spi_init_struct);
+  spi_i2s_dma_transmitter_enable(cfg->spi, TRUE);
+  spi_i2s_dma_receiver_enable(cfg->spi, TRUE);
+
+  dma_reset(cfg->rx_dma_channel);
+  dma_default_para_init(&dma_init_struct);
+  dma_init_struct.direction = DMA_DIR_PERIPHERAL_TO_MEMORY;
+  dma_init_struct.memory_base_addr = (uint32_t)&bus->sink;
+  dma_init_struct.peripheral_base_addr = (uint32_t)&cfg->spi->dt;
+  dma_init_struct.memory_inc_enable = TRUE;
+  dma_init_struct.peripheral_inc_enable = FALSE;
+  /* the receive channel wins, a frame waiting in the spi is never overrun */
+  dma_init_struct.priority = DMA_PRIORITY_VERY_HIGH;
+  dma_init_struct.loop_mode_enable = FALSE;
+  dma_init(cfg->rx_dma_channel, &dma_init_struct);
+  spi_bus_dma_map(cfg->rx_dma_channel, cfg->rx_request);
+
+  dma_reset(cfg->tx_dma_channel);
+  dma_init_struct.direction = DMA_DIR_MEMORY_TO_PERIPHERAL;
+  dma_init_struct.memory_base_addr = (uint32_t)&bus->cfg.fill;
+  dma_init_struct.priority = DMA_PRIORITY_HIGH;
+  dma_init(cfg->tx_dma_channel, &dma_init_struct);
+  spi_bus_dma_map(cfg->tx_dma_channel, cfg->tx_request);
+
+  dma_flag_clear(bus->rx_fdt_flag | bus->rx_dterr_flag);
+  dma_flag_clear(bus->tx_dterr_flag);
+  dma_interrupt_enable(cfg->rx_dma_channel, DMA_FDT_INT | DMA_DTERR_INT, TRUE);
+  dma_interrupt_enable(cfg->tx_dma_channel, DMA_DTERR_INT, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  fill a device with mode 0, msb first, 8-bit frames at the
+  *         highest speed and drive its cs pin high.
+  * @param  device: the device
+  * @param  cs_gpio: port of the cs pin, NULL when the device has none
+  * @param  cs_pin: GPIO_PINS_x
+  * @retval none
+  */
+void spi_bus_device_init(spi_bus_device_type *device, gpio_type *cs_gpio, uint16_t cs_pin)
+{
+  gpio_init_type gpio_init_struct;
+
+  device->cs_gpio = cs_gpio;
+  device->cs_pin = cs_pin;
+  device->mclk_freq_division = SPI_MCLK_DIV_2;
+  device->clock_polarity = SPI_CLOCK_POLARITY_LOW;
+  device->clock_phase = SPI_CLOCK_PHASE_1EDGE;
+  device->first_bit_transmission = SPI_FIRST_BIT_MSB;
+  device->frame_bit_num = SPI_FRAME_8BIT;
+
+  if(cs_gpio != NULL)
+  {
+    gpio_bits_set(cs_gpio, cs_pin);
+    gpio_default_para_init(&gpio_init_struct);
+    gpio_init_struct.gpio_out_type = GPIO_OUTPUT_PUSH_PULL;
+    gpio_init_struct.gpio_drive_strength = GPIO_DRIVE_STRENGTH_STRONGER;
+    gpio_init_struct.gpio_pull = GPIO_PULL_UP;
+    gpio_init_struct.gpio_mode = GPIO_MODE_OUTPUT;
+    gpio_init_struct.gpio_pins = cs_pin;
+    gpio_init(cs_gpio, &gpio_init_struct);
+  }
+}
+
+/**
+  * @brief  queue a transfer, it starts at once on an idle bus. may be called
+  *         from the completion of another transfer.
+  * @param  bus: the bus
+  * @param  transfer: descriptor, untouched by the caller until it is done
+  * @retval SUCCESS, or ERROR when the descriptor is empty or already queued
+  */
+error_status spi_bus_submit(spi_bus_type *bus, spi_bus_transfer_type *transfer)
+{
+  uint32_t primask;
+
+  if(transfer->device == NULL || transfer->length == 0 ||
+     transfer->status == SPI_BUS_STATUS_QUEUED || transfer->status == SPI_BUS_STATUS_ACTIVE)
+  {
+    return ERROR;
+  }
+
+  transfer->next = NULL;
+  transfer->status = SPI_BUS_STATUS_QUEUED;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if(bus->head == NULL)
+  {
+    bus->head = transfer;
+    bus->tail = transfer;
+    spi_bus_chunk_start(bus);
+  }
+  else
+  {
+    bus->tail->next = transfer;
+    bus->tail = transfer;
+  }
+  __set_PRIMASK(primask);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  wait for a queued transfer to end.
+  * @param  transfer: the descriptor
+  * @retval SUCCESS when all frames were exchanged, ERROR otherwise
+  */
+error_status spi_bus_transfer_wait(spi_bus_transfer_type *transfer)
+{
+  while(transfer->status == SPI_BUS_STATUS_QUEUED || transfer->status == SPI_BUS_STATUS_ACTIVE)
+  {
+  }
+  return (transfer->status == SPI_BUS_STATUS_DONE) ? SUCCESS : ERROR;
+}
+
+/**
+  * @brief  whether a transfer is queued or running.
+  * @param  bus: the bus
+  * @retval SET while the bus is in use
+  */
+flag_status spi_bus_busy_get(spi_bus_type *bus)
+{
+  return (bus->head != NULL) ? SET : RESET;
+}
+
+/**
+  * @brief  receive channel interrupt, also give it the transmit channel
+  *         interrupt when that one is separate.
+  * @param  bus: the bus
+  * @retval none
+  */
+void spi_bus_dma_irq_handler(spi_bus_type *bus)
+{
+  spi_bus_transfer_type *transfer;
+
+  if(dma_interrupt_flag_get(bus->rx_dterr_flag) != RESET || dma_interrupt_flag_get(bus->tx_dterr_flag) != RESET)
+  {
+    dma_flag_clear(bus->rx_dterr_flag | bus->rx_fdt_flag);
+    dma_flag_clear(bus->tx_dterr_flag);
+    bus->cfg.rx_dma_channel->ctrl_bit.chen = FALSE;
+    bus->cfg.tx_dma_channel->ctrl_bit.chen = FALSE;
+    if(bus->head != NULL)
+    {
+      /* the frames in flight are lost with the transfer */
+      while(spi_i2s_flag_get(bus->cfg.spi, SPI_I2S_BF_FLAG) != RESET)
+      {
+      }
+      spi_i2s_data_receive(bus->cfg.spi);
+      bus->error_count++;
+      transfer = spi_bus_finish(bus, SPI_BUS_STATUS_ERROR);
+      if(transfer->complete != NULL)
+      {
+        transfer->complete(transfer);
+      }
+    }
+    return;
+  }
+
+  if(dma_interrupt_flag_get(bus->rx_fdt_flag) != RESET)
+  {
+    dma_flag_clear(bus->rx_fdt_flag);
+    if(bus->head == NULL)
+    {
+      return;
+    }
+    transfer = bus->head;
+    transfer->done += transfer->chunk;
+    if(transfer->done < transfer->length)
+    {
+      spi_bus_chunk_start(bus);
+      return;
+    }
+
+    /* the last frame is in, the bus is idle */
+    bus->transfer_count++;
+    transfer = spi_bus_finish(bus, SPI_BUS_STATUS_DONE);
+    if(transfer->complete != NULL)
+    {
+      transfer->complete(transfer);
+    }
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,175 @@
+/**
+  **************************************************************************
+  * @file     spi_bus.h
+  * @brief    spi bus driver library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SPI_BUS_H
+#define __SPI_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_spi_bus_library
+  * @{
+  */
+
+/** @defgroup SPI_BUS_library_definition
+  * @{
+  */
+
+/**
+  * @brief the spi runs as full duplex master with software cs. transfers are
+  *        queued as descriptors and each one runs as a receive and a transmit
+  *        dma pair, the receive channel finishing last. its full transfer
+  *        interrupt starts the next descriptor at once and only then calls
+  *        the completion of the finished one, so the gap between two
+  *        descriptors is the interrupt entry and a few register writes. the
+  *        spi is set up again only when the speed or mode changes, the cs pin of a
+  *        device is driven low for its transfers and high afterwards.
+  *        a descriptor longer than SPI_BUS_CHUNK_MAX frames runs in chunks.
+  */
+#define SPI_BUS_CHUNK_MAX                0xFFFF
+
+/**
+  * @}
+  */
+
+/** @defgroup SPI_BUS_library_handler
+  * @{
+  */
+
+/**
+  * @brief transfer status
+  */
+typedef enum
+{
+  SPI_BUS_STATUS_IDLE                    = 0x00, /*!< not queued */
+  SPI_BUS_STATUS_QUEUED                  = 0x01, /*!< waiting for the bus */
+  SPI_BUS_STATUS_ACTIVE                  = 0x02, /*!< on the bus */
+  SPI_BUS_STATUS_DONE                    = 0x03, /*!< all frames exchanged */
+  SPI_BUS_STATUS_ERROR                   = 0x04  /*!< dma error, transfer dropped */
+} spi_bus_status_type;
+
+/**
+  * @brief a device on the bus, filled with spi_bus_device_init. speed and mode
+  *        may be changed afterwards while no transfer of the device is queued.
+  */
+typedef struct
+{
+  gpio_type                              *cs_gpio;                /*!< port of the cs pin, NULL for none */
+  uint16_t                               cs_pin;                  /*!< cs pin, active low              */
+  spi_mclk_freq_div_type                 mclk_freq_division;      /*!< sck division                    */
+  spi_clock_polarity_type                clock_polarity;          /*!< sck idle level                  */
+  spi_clock_phase_type                   clock_phase;             /*!< sampling edge                   */
+  spi_first_bit_type                     first_bit_transmission;  /*!< bit order                       */
+  spi_frame_bit_num_type                 frame_bit_num;           /*!< 8 or 16-bit frames              */
+} spi_bus_device_type;
+
+/**
+  * @brief transfer descriptor. tx NULL sends the fill frame, rx NULL drops
+  *        the received frames. with cs_hold the cs stays low after the
+  *        transfer, the next transfer must be for the same device, which
+  *        lets a command and its data be queued as two descriptors or the
+  *        data be queued by the completion of the command.
+  */
+typedef struct spi_bus_transfer_struct
+{
+  const spi_bus_device_type              *device;                 /*!< addressed device                */
+  const void                             *tx;                     /*!< frames sent, or NULL            */
+  void                                   *rx;                     /*!< frames received, or NULL        */
+  uint32_t                               length;                  /*!< frames exchanged                */
+  confirm_state                          cs_hold;                 /*!< keep cs low afterwards          */
+  void                                   (*complete)(struct spi_bus_transfer_struct *transfer); /*!< may be NULL */
+  void                                   *context;                /*!< free for the caller             */
+  struct spi_bus_transfer_struct         *next;                   /*!< queue link, owned by the bus    */
+  uint32_t                               done;                    /*!< frames of the finished chunks   */
+  uint16_t                               chunk;                   /*!< frames of the running chunk     */
+  __IO spi_bus_status_type               status;                  /*!< transfer status                 */
+} spi_bus_transfer_type;
+
+/**
+  * @brief configuration
+  */
+typedef struct
+{
+  spi_type                               *spi;                    /*!< SPI1 or SPI2                    */
+  dma_channel_type                       *tx_dma_channel;         /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              tx_request;              /*!< DMA_FLEXIBLE_SPIx_TX            */
+  dma_channel_type                       *rx_dma_channel;         /*!< DMA1_CHANNELx or DMA2_CHANNELx  */
+  dma_flexible_request_type              rx_request;              /*!< DMA_FLEXIBLE_SPIx_RX            */
+  uint16_t                               fill;                    /*!< frame sent when tx is NULL      */
+} spi_bus_config_type;
+
+/**
+  * @brief spi bus
+  */
+typedef struct
+{
+  spi_bus_config_type                    cfg;                     /*!< configuration                   */
+  spi_bus_transfer_type                  *head;                   /*!< transfer on the bus             */
+  spi_bus_transfer_type                  *tail;                   /*!< last transfer queued            */
+  uint32_t                               setup;                   /*!< speed and mode the spi runs at  */
+  const spi_bus_device_type              *cs_device;              /*!< device holding its cs low       */
+  uint32_t                               rx_fdt_flag;             /*!< full transfer flag, rx channel  */
+  uint32_t                               rx_dterr_flag;           /*!< error flag, rx channel          */
+  uint32_t                               tx_dterr_flag;           /*!< error flag, tx channel          */
+  uint16_t                               sink;                    /*!< frames dropped for rx NULL      */
+  __IO uint32_t                          transfer_count;          /*!< transfers done                  */
+  __IO uint32_t                          chunk_count;             /*!< dma chunks run                  */
+  __IO uint32_t                          reconfig_count;          /*!< spi set up for another mode      */
+  __IO uint32_t                          error_count;             /*!< transfers dropped on dma errors */
+} spi_bus_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup SPI_BUS_library_exported_functions
+  * @{
+  */
+
+error_status      spi_bus_init                  (spi_bus_type *bus, const spi_bus_config_type *cfg);
+void              spi_bus_device_init           (spi_bus_device_type *device, gpio_type *cs_gpio, uint16_t cs_pin);
+error_status      spi_bus_submit                (spi_bus_type *bus, spi_bus_transfer_type *transfer);
+error_status      spi_bus_transfer_wait         (spi_bus_transfer_type *transfer);
+flag_status       spi_bus_busy_get              (spi_bus_type *bus);
+void              spi_bus_dma_irq_handler       (spi_bus_type *bus);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,268 @@
+/**
+  **************************************************************************
+  * @file     timer_wheel_host_test.c
+  * @brief    host model of the timer wheel
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs the timer wheel on a model of a free running 32-bit tmr and its
+ * compare channel, starting from just before the counter wraps:
+ * - thousands of one shot and periodic timers, restarted and stopped at
+ *   random, also from their own callbacks, with delays from a few ticks to
+ *   the full range and random slack
+ * - no callback comes early, none later than its slack, none for a stopped
+ *   timer, and no running timer is left overdue past its slack
+ * - interrupts are enabled again after every call
+ * then times start and stop with more and more running timers: the cost
+ * must not grow with their number.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timer_wheel.h"
+
+#define TIMERS                           4000
+#define STEPS                            1000000
+#define SCALE_TIMERS                     16000
+#define SCALE_OPS                        200000
+
+static tmr_type tmr;
+static uint32_t compare_value;
+static confirm_state compare_int;
+static flag_status compare_flag;
+
+static timer_wheel_type wheel;
+static timer_wheel_timer_type timer[SCALE_TIMERS];
+static uint32_t expect_at[TIMERS], slack_of[TIMERS];
+static uint8_t armed[TIMERS];
+static uint32_t fired, max_late;
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* the tmr channel as the wheel uses it */
+void tmr_channel_value_set(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, uint32_t tmr_channel_value)
+{
+  compare_value = tmr_channel_value;
+}
+
+void tmr_interrupt_enable(tmr_type *tmr_x, uint32_t tmr_interrupt, confirm_state new_state)
+{
+  compare_int = new_state;
+}
+
+void tmr_event_sw_trigger(tmr_type *tmr_x, tmr_event_trigger_type tmr_event)
+{
+  compare_flag = SET;
+}
+
+flag_status tmr_flag_get(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  return compare_flag;
+}
+
+void tmr_flag_clear(tmr_type *tmr_x, uint32_t tmr_flag)
+{
+  compare_flag = RESET;
+}
+
+void tmr_output_default_para_init(tmr_output_config_type *tmr_output_struct)
+{
+}
+
+void tmr_output_channel_config(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, tmr_output_config_type *tmr_output_struct)
+{
+}
+
+void tmr_output_channel_buffer_enable(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, confirm_state new_state)
+{
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static void timer_arm(uint32_t index, uint32_t delay, uint32_t slack)
+{
+  slack_of[index] = slack;
+  expect_at[index] = tmr.cval + delay;
+  armed[index] = 1;
+  CHECK(timer_wheel_start(&wheel, &timer[index], delay, slack) == SUCCESS);
+  CHECK(host_primask == 0);
+}
+
+static void callback(void *arg)
+{
+  uint32_t index = (uint32_t)(uintptr_t)arg;
+  int32_t late = (int32_t)(tmr.cval - expect_at[index]);
+
+  CHECK(armed[index]);
+  CHECK(late >= 0);
+  CHECK(late <= (int32_t)slack_of[index] + 1);
+  {
+    max_late = (uint32_t)late;
+  }
+  fired++;
+
+  if(timer[index].period != 0)
+  {
+    expect_at[index] += timer[index].period;
+  }
+  else
+  {
+    armed[index] = 0;
+    if((rand_get() % 4) == 0)
+    {
+      timer_arm(index, rand_get() % 100000, 0);
+    }
+  }
+}
+
+/* service a raised flag, then let the counter run. a compare match on the
+   way raises the flag again */
+static void run(uint32_t ticks)
+{
+  uint32_t distance, nest;
+
+  while(1)
+  {
+    for(nest = 0; nest < 10 && compare_flag == SET; nest++)
+    {
+      timer_wheel_irq_handler(&wheel);
+    }
+    if(compare_flag == SET)
+    {
+      CHECK(compare_flag == RESET);
+      compare_flag = RESET;
+    }
+    if(ticks == 0)
+    {
+      break;
+    }
+
+    distance = compare_value - tmr.cval;
+    if(compare_int == TRUE && distance != 0 && distance <= ticks)
+    {
+      tmr.cval += distance;
+      ticks -= distance;
+      compare_flag = SET;
+    }
+    else
+    {
+      tmr.cval += ticks;
+      ticks = 0;
+    }
+  }
+}
+
+static void random_test(void)
+{
+  uint32_t step, index, delay, count, active = 0;
+
+  tmr.cval = 0xFFFF0000;
+  timer_wheel_init(&wheel, &tmr, TMR_SELECT_CHANNEL_1);
+  for(index = 0; index < TIMERS; index++)
+  {
+    timer_wheel_timer_init(&timer[index], callback, (void *)(uintptr_t)index, ((index % 10) == 0) ? 1000 + index * 64 : 0);
+  }
+
+  for(step = 0; step < STEPS; step++)
+  {
+    index = rand_get() % TIMERS;
+    count = rand_get() % 100;
+    if(count < 10 && !(timer[index].period != 0 && armed[index]))
+    {
+      switch(rand_get() % 4)
+      {
+        case 0:  delay = rand_get() % 64; break;
+        case 1:  delay = rand_get() % 5000; break;
+        case 2:  delay = rand_get() % 2000000; break;
+        default: delay = (rand_get() * 7u) % TIMER_WHEEL_MAX_DELAY; break;
+      }
+      timer_arm(index, delay, rand_get() % 512);
+    }
+    else if(count < 13 && timer[index].period == 0)
+    {
+      timer_wheel_stop(&wheel, &timer[index]);
+      CHECK(host_primask == 0 && timer_wheel_active(&timer[index]) == RESET);
+      armed[index] = 0;
+    }
+
+    run((rand_get() % 3) ? rand_get() % 50 : rand_get() % 5000);
+  }
+
+  for(index = 0; index < TIMERS; index++)
+  {
+    CHECK(!armed[index] || (int32_t)(tmr.cval - expect_at[index]) <= (int32_t)slack_of[index] + 1);
+    active += armed[index];
+  }
+  CHECK(wheel.active_count == active);
+  printf("%u steps, %u callbacks, %u running, worst lateness %u ticks, wheel max latency %u\n",
+         STEPS, (unsigned)fired, (unsigned)active, (unsigned)max_late, (unsigned)wheel.max_latency);
+}
+
+static void noop(void *arg)
+{
+}
+
+static void scale_test(void)
+{
+  uint32_t running, index, op;
+  struct timespec t0, t1;
+  double ns;
+
+  printf("running timers   start+stop ns\n");
+  for(running = 10; running <= SCALE_TIMERS; running *= 4)
+  {
+    tmr.cval = 0;
+    timer_wheel_init(&wheel, &tmr, TMR_SELECT_CHANNEL_1);
+    for(index = 0; index < running; index++)
+    {
+      timer_wheel_timer_init(&timer[index], noop, NULL, 0);
+      timer_wheel_start(&wheel, &timer[index], 1000 + rand_get() % 10000000, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for(op = 0; op < SCALE_OPS; op++)
+    {
+      index = rand_get() % running;
+      timer_wheel_stop(&wheel, &timer[index]);
+      timer_wheel_start(&wheel, &timer[index], 1000 + rand_get() % 10000000, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / SCALE_OPS;
+    CHECK(wheel.active_count == running);
+    printf("%14u   %13.1f\n", (unsigned)running, ns);
+  }
+}
+
+int main(void)
+{
+  random_test();
+  scale_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
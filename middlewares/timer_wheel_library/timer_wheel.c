@@ -0,0 +1,494 @@
+/**
+  **************************************************************************
+  * @file     timer_wheel.c
+  * @brief    hierarchical software timer wheel library
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "timer_wheel.h"
+
+/** @addtogroup AT32F415_middlewares_timer_wheel_library
+  * @{
+  */
+
+/* timer states kept in the level field when the timer is not in a slot */
+#define TIMER_WHEEL_STATE_IDLE           0xFF
+#define TIMER_WHEEL_STATE_PENDING        0xFE
+
+#define TIMER_WHEEL_SHIFT(level)         ((level) * TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK            (TIMER_WHEEL_SLOTS - 1)
+
+static void list_init(timer_wheel_list_type *head)
+{
+  head->next = head;
+  head->prev = head;
+}
+
+static void list_add_tail(timer_wheel_list_type *head, timer_wheel_list_type *node)
+{
+  node->next = head;
+  node->prev = head->prev;
+  head->prev->next = node;
+  head->prev = node;
+}
+
+static void list_del(timer_wheel_list_type *node)
+{
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->next = node;
+  node->prev = node;
+}
+
+/**
+  * @brief  move every node of src to the empty list dst.
+  */
+static void list_move(timer_wheel_list_type *src, timer_wheel_list_type *dst)
+{
+  if(src->next == src)
+  {
+    list_init(dst);
+    return;
+  }
+
+  dst->next = src->next;
+  dst->prev = src->prev;
+  dst->next->prev = dst;
+  dst->prev->next = dst;
+  list_init(src);
+}
+
+/**
+  * @brief  index of the lowest set bit, value must not be zero.
+  */
+static uint32_t bit_lowest(uint32_t value)
+{
+  return __CLZ(__RBIT(value));
+}
+
+/**
+  * @brief  link a timer in the slot matching its expiry, caller holds the critical section.
+  * @param  wheel: the timer wheel.
+  * @param  timer: the timer, expires already set.
+  * @retval none.
+  */
+static void timer_wheel_insert(timer_wheel_type *wheel, timer_wheel_timer_type *timer)
+{
+  uint32_t expires = timer->expires;
+  uint32_t shift, diff;
+  uint8_t level;
+
+  /* expired while waiting: run it on the next tick processed */
+  if((int32_t)(expires - wheel->base) < 0)
+  {
+    expires = wheel->base;
+  }
+
+  if((expires - wheel->base) < TIMER_WHEEL_SLOTS)
+  {
+    level = 0;
+    timer->slot = expires & TIMER_WHEEL_SLOT_MASK;
+  }
+  else
+  {
+    for(level = 1; level < TIMER_WHEEL_LEVELS; level++)
+    {
+      shift = TIMER_WHEEL_SHIFT(level);
+      diff = ((expires >> shift) - (wheel->base >> shift)) & (0xFFFFFFFF >> shift);
+
+      if(diff < TIMER_WHEEL_SLOTS)
+      {
+        timer->slot = (expires >> shift) & TIMER_WHEEL_SLOT_MASK;
+        break;
+      }
+    }
+
+    if(level == TIMER_WHEEL_LEVELS)
+    {
+      /* beyond the wheel range: park in the farthest slot of the last level */
+      level = TIMER_WHEEL_LEVELS - 1;
+      shift = TIMER_WHEEL_SHIFT(level);
+      timer->slot = ((wheel->base >> shift) + TIMER_WHEEL_SLOTS - 1) & TIMER_WHEEL_SLOT_MASK;
+    }
+  }
+
+  timer->level = level;
+  list_add_tail(&wheel->slot[level][timer->slot], &timer->node);
+  wheel->bitmap[level] |= (uint32_t)1 << timer->slot;
+}
+
+/**
+  * @brief  unlink a timer from its slot or from the expired list.
+  * @param  wheel: the timer wheel.
+  * @param  timer: the timer.
+  * @retval none.
+  */
+static void timer_wheel_remove(timer_wheel_type *wheel, timer_wheel_timer_type *timer)
+{
+  timer_wheel_list_type *head;
+
+  if(timer->level == TIMER_WHEEL_STATE_IDLE)
+  {
+    return;
+  }
+
+  list_del(&timer->node);
+
+  if(timer->level != TIMER_WHEEL_STATE_PENDING)
+  {
+    head = &wheel->slot[timer->level][timer->slot];
+    if(head->next == head)
+    {
+      wheel->bitmap[timer->level] &= ~((uint32_t)1 << timer->slot);
+    }
+  }
+
+  timer->level = TIMER_WHEEL_STATE_IDLE;
+  wheel->active_count--;
+}
+
+/**
+  * @brief  earliest tick at which a slot has to be processed: a level 0 expiry
+  *         or the start of a higher level slot that has to be cascaded.
+  * @param  wheel: the timer wheel.
+  * @param  next: earliest tick.
+  * @retval SET when the wheel holds timers.
+  */
+static flag_status timer_wheel_next_event(timer_wheel_type *wheel, uint32_t *next)
+{
+  flag_status found = RESET;
+  uint32_t shift, first, event;
+  uint8_t level;
+
+  for(level = 0; level < TIMER_WHEEL_LEVELS; level++)
+  {
+    if(wheel->bitmap[level] == 0)
+    {
+      continue;
+    }
+
+    /* first slot boundary of this level at or after base */
+    shift = TIMER_WHEEL_SHIFT(level);
+    first = (wheel->base + ((uint32_t)1 << shift) - 1) & ~(((uint32_t)1 << shift) - 1);
+    event = first + (bit_lowest(__ROR(wheel->bitmap[level], (first >> shift) & TIMER_WHEEL_SLOT_MASK)) << shift);
+
+    if((found == RESET) || ((int32_t)(event - *next) < 0))
+    {
+      *next = event;
+      found = SET;
+    }
+  }
+
+  return found;
+}
+
+/**
+  * @brief  process every slot up to tick now: cascade the higher levels and call
+  *         the expired timers. all timers of one tick are collected and called
+  *         in a single pass.
+  * @param  wheel: the timer wheel.
+  * @param  now: current tick.
+  * @retval none.
+  */
+static void timer_wheel_advance(timer_wheel_type *wheel, uint32_t now)
+{
+  timer_wheel_list_type expired, cascade;
+  timer_wheel_timer_type *timer;
+  uint32_t tick, primask, latency;
+  int8_t level;
+  uint8_t index;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  while((timer_wheel_next_event(wheel, &tick) == SET) && ((int32_t)(tick - now) <= 0))
+  {
+    /* cascade from the highest level so that timers move down level by level */
+    for(level = TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+    {
+      if((tick & (((uint32_t)1 << TIMER_WHEEL_SHIFT(level)) - 1)) != 0)
+      {
+        continue;
+      }
+
+      index = (tick >> TIMER_WHEEL_SHIFT(level)) & TIMER_WHEEL_SLOT_MASK;
+      list_move(&wheel->slot[level][index], &cascade);
+      wheel->bitmap[level] &= ~((uint32_t)1 << index);
+      wheel->base = tick;
+
+      while(cascade.next != &cascade)
+      {
+        timer = (timer_wheel_timer_type *)cascade.next;
+        list_del(&timer->node);
+        timer_wheel_insert(wheel, timer);
+      }
+    }
+
+    index = tick & TIMER_WHEEL_SLOT_MASK;
+    list_move(&wheel->slot[0][index], &expired);
+    wheel->bitmap[0] &= ~((uint32_t)1 << index);
+    wheel->base = tick + 1;
+
+    for(timer = (timer_wheel_timer_type *)expired.next; &timer->node != &expired;
+        timer = (timer_wheel_timer_type *)timer->node.next)
+    {
+      timer->level = TIMER_WHEEL_STATE_PENDING;
+    }
+
+    /* callbacks run with interrupts enabled, they may start or stop any timer */
+    while(expired.next != &expired)
+    {
+      timer = (timer_wheel_timer_type *)expired.next;
+      timer_wheel_remove(wheel, timer);
+
+      latency = wheel->tmr_x->cval - timer->expires;
+      if(latency > wheel->max_latency)
+      {
+        wheel->max_latency = latency;
+      }
+      wheel->expire_count++;
+
+      if(timer->period != 0)
+      {
+        timer->expires += timer->period;
+        timer_wheel_insert(wheel, timer);
+        wheel->active_count++;
+      }
+
+      __set_PRIMASK(primask);
+      timer->callback(timer->arg);
+      __disable_irq();
+    }
+  }
+
+  if((int32_t)(now + 1 - wheel->base) > 0)
+  {
+    wheel->base = now + 1;
+  }
+
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  program the compare channel with the next event, caller holds the
+  *         critical section. an event already in the past is raised by software.
+  * @param  wheel: the timer wheel.
+  * @retval none.
+  */
+static void timer_wheel_program(timer_wheel_type *wheel)
+{
+  uint32_t next;
+
+  if(timer_wheel_next_event(wheel, &next) == RESET)
+  {
+    tmr_interrupt_enable(wheel->tmr_x, wheel->channel_flag, FALSE);
+    return;
+  }
+
+  tmr_channel_value_set(wheel->tmr_x, wheel->channel, next);
+  tmr_interrupt_enable(wheel->tmr_x, wheel->channel_flag, TRUE);
+
+  /* the compare only matches on equality, do not miss an event already passed */
+  if((int32_t)(wheel->tmr_x->cval - next) >= 0)
+  {
+    tmr_event_sw_trigger(wheel->tmr_x, (tmr_event_trigger_type)wheel->channel_flag);
+  }
+}
+
+/**
+  * @brief  initialize the wheel on a running 32-bit tmr. the tmr base must already
+  *         be configured (32-bit mode, period 0xFFFFFFFF, counter enabled) and its
+  *         interrupt enabled in the nvic; the irq handler calls timer_wheel_irq_handler.
+  * @param  wheel: the timer wheel.
+  * @param  tmr_x: TMR2 or TMR5.
+  * @param  channel: TMR_SELECT_CHANNEL_1, TMR_SELECT_CHANNEL_2, TMR_SELECT_CHANNEL_3
+  *         or TMR_SELECT_CHANNEL_4.
+  * @retval none.
+  */
+void timer_wheel_init(timer_wheel_type *wheel, tmr_type *tmr_x, tmr_channel_select_type channel)
+{
+  tmr_output_config_type tmr_output_struct;
+  uint8_t level, index;
+
+  wheel->tmr_x = tmr_x;
+  wheel->channel = channel;
+  wheel->channel_flag = TMR_C1_FLAG << (channel >> 1);
+  wheel->base = tmr_x->cval;
+  wheel->active_count = 0;
+  wheel->expire_count = 0;
+  wheel->max_latency = 0;
+
+  for(level = 0; level < TIMER_WHEEL_LEVELS; level++)
+  {
+    wheel->bitmap[level] = 0;
+    for(index = 0; index < TIMER_WHEEL_SLOTS; index++)
+    {
+      list_init(&wheel->slot[level][index]);
+    }
+  }
+
+  /* compare channel without output, only the flag is used */
+  tmr_output_default_para_init(&tmr_output_struct);
+  tmr_output_struct.oc_mode = TMR_OUTPUT_CONTROL_OFF;
+  tmr_output_struct.oc_output_state = FALSE;
+  tmr_output_channel_config(tmr_x, channel, &tmr_output_struct);
+  tmr_output_channel_buffer_enable(tmr_x, channel, FALSE);
+
+  tmr_interrupt_enable(tmr_x, wheel->channel_flag, FALSE);
+  tmr_flag_clear(tmr_x, wheel->channel_flag);
+}
+
+/**
+  * @brief  initialize a timer.
+  * @param  timer: the timer.
+  * @param  callback: expiry callback, called from the tmr interrupt.
+  * @param  arg: callback argument.
+  * @param  period: reload in ticks for a periodic timer, 0 for a one shot timer.
+  *         periodic expiries are computed from the previous expiry, not from the
+  *         callback time, so they do not drift.
+  * @retval none.
+  */
+void timer_wheel_timer_init(timer_wheel_timer_type *timer, timer_wheel_callback_type callback, void *arg, uint32_t period)
+{
+  list_init(&timer->node);
+  timer->expires = 0;
+  timer->period = period;
+  timer->callback = callback;
+  timer->arg = arg;
+  timer->level = TIMER_WHEEL_STATE_IDLE;
+  timer->slot = 0;
+}
+
+/**
+  * @brief  start or restart a timer, O(1). can be called from tasks, interrupts
+  *         and timer callbacks.
+  * @param  wheel: the timer wheel.
+  * @param  timer: the timer.
+  * @param  delay: timeout in ticks, up to TIMER_WHEEL_MAX_DELAY.
+  * @param  slack: allowed lateness in ticks. the expiry is rounded up to a multiple
+  *         of the largest power of two not above slack + 1, so that timers with
+  *         close deadlines expire on the same tick and share one interrupt.
+  * @retval error_status (ERROR when delay is out of range).
+  */
+error_status timer_wheel_start(timer_wheel_type *wheel, timer_wheel_timer_type *timer, uint32_t delay, uint32_t slack)
+{
+  uint32_t primask, now, granule;
+
+  if(delay > TIMER_WHEEL_MAX_DELAY)
+  {
+    return ERROR;
+  }
+
+  granule = (uint32_t)1 << (31 - __CLZ((slack < TIMER_WHEEL_MAX_DELAY) ? slack + 1 : TIMER_WHEEL_MAX_DELAY));
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  timer_wheel_remove(wheel, timer);
+
+  now = wheel->tmr_x->cval;
+  if(wheel->active_count == 0)
+  {
+    /* nothing kept the wheel moving, catch up with the counter */
+    wheel->base = now;
+  }
+
+  if(delay <= TIMER_WHEEL_MAX_DELAY - (granule - 1))
+  {
+    timer->expires = (now + delay + granule - 1) & ~(granule - 1);
+  }
+  else
+  {
+    timer->expires = now + delay;
+  }
+
+  timer_wheel_insert(wheel, timer);
+  wheel->active_count++;
+  timer_wheel_program(wheel);
+
+  __set_PRIMASK(primask);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  stop a timer, O(1). stopping an idle timer has no effect.
+  * @param  wheel: the timer wheel.
+  * @param  timer: the timer.
+  * @retval none.
+  */
+void timer_wheel_stop(timer_wheel_type *wheel, timer_wheel_timer_type *timer)
+{
+  uint32_t primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  timer_wheel_remove(wheel, timer);
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  check whether a timer is running.
+  * @param  timer: the timer.
+  * @retval SET when the timer is running or expired and waiting for its callback.
+  */
+flag_status timer_wheel_active(timer_wheel_timer_type *timer)
+{
+  return (timer->level != TIMER_WHEEL_STATE_IDLE) ? SET : RESET;
+}
+
+/**
+  * @brief  current tick of the wheel time base.
+  * @param  wheel: the timer wheel.
+  * @retval tick.
+  */
+uint32_t timer_wheel_now(timer_wheel_type *wheel)
+{
+  return wheel->tmr_x->cval;
+}
+
+/**
+  * @brief  handle the compare event, call it from the tmr interrupt handler.
+  * @param  wheel: the timer wheel.
+  * @retval none.
+  */
+void timer_wheel_irq_handler(timer_wheel_type *wheel)
+{
+  uint32_t primask;
+
+  if(tmr_flag_get(wheel->tmr_x, wheel->channel_flag) == RESET)
+  {
+    return;
+  }
+
+  tmr_flag_clear(wheel->tmr_x, wheel->channel_flag);
+
+  timer_wheel_advance(wheel, wheel->tmr_x->cval);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  timer_wheel_program(wheel);
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,144 @@
+/**
+  **************************************************************************
+  * @file     timer_wheel.h
+  * @brief    hierarchical software timer wheel library header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*!< define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup AT32F415_middlewares_timer_wheel_library
+  * @{
+  */
+
+/** @defgroup TIMER_WHEEL_library_definition
+  * @{
+  */
+
+/**
+  * @brief the wheel is driven by a free running 32-bit counter (TMR2 or TMR5 with
+  *        tmr_32_bit_function_enable, period 0xFFFFFFFF), one count is one tick,
+  *        e.g. 1 us with a 1 mhz counter. every level has 32 slots, so
+  *        TIMER_WHEEL_LEVELS levels cover 2^(5 * TIMER_WHEEL_LEVELS) ticks exactly,
+  *        longer timeouts are parked in the last level and placed again later.
+  */
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS               5
+#endif
+#define TIMER_WHEEL_SLOT_BITS            5
+#define TIMER_WHEEL_SLOTS                (1 << TIMER_WHEEL_SLOT_BITS)
+
+/**
+  * @brief longest timeout accepted by timer_wheel_start, in ticks. half of the
+  *        signed range is kept as margin for the time the wheel lags the counter.
+  */
+#define TIMER_WHEEL_MAX_DELAY            0x3FFFFFFF
+
+/**
+  * @}
+  */
+
+/** @defgroup TIMER_WHEEL_library_handler
+  * @{
+  */
+
+/**
+  * @brief expiry callback, called from the timer interrupt
+  */
+typedef void (*timer_wheel_callback_type)(void *arg);
+
+/**
+  * @brief doubly linked list node, a list head is a node linked to itself
+  */
+typedef struct timer_wheel_list_struct
+{
+  struct timer_wheel_list_struct         *next;
+  struct timer_wheel_list_struct         *prev;
+} timer_wheel_list_type;
+
+/**
+  * @brief software timer, owned by the caller
+  */
+typedef struct
+{
+  timer_wheel_list_type                  node;                    /*!< slot list link                  */
+  uint32_t                               expires;                 /*!< expiry time in ticks            */
+  uint32_t                               period;                  /*!< reload in ticks, 0 for one shot */
+  timer_wheel_callback_type              callback;                /*!< expiry callback                 */
+  void                                   *arg;                    /*!< callback argument               */
+  uint8_t                                level;                   /*!< wheel level or state            */
+  uint8_t                                slot;                    /*!< slot in the level               */
+} timer_wheel_timer_type;
+
+/**
+  * @brief timer wheel and the tmr channel driving it
+  */
+typedef struct
+{
+  tmr_type                               *tmr_x;                  /*!< free running 32-bit tmr         */
+  tmr_channel_select_type                channel;                 /*!< compare channel 1 to 4          */
+  uint32_t                               channel_flag;            /*!< channel flag/interrupt/event    */
+  uint32_t                               base;                    /*!< first tick not yet processed    */
+  uint32_t                               active_count;            /*!< running timers                  */
+  uint32_t                               bitmap[TIMER_WHEEL_LEVELS];                      /*!< non empty slots */
+  timer_wheel_list_type                  slot[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];     /*!< slot lists      */
+  __IO uint32_t                          expire_count;            /*!< callbacks called                */
+  __IO uint32_t                          max_latency;             /*!< worst expiry to callback ticks  */
+} timer_wheel_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup TIMER_WHEEL_library_exported_functions
+  * @{
+  */
+
+void              timer_wheel_init              (timer_wheel_type *wheel, tmr_type *tmr_x, tmr_channel_select_type channel);
+void              timer_wheel_timer_init        (timer_wheel_timer_type *timer, timer_wheel_callback_type callback, void *arg, uint32_t period);
+error_status      timer_wheel_start             (timer_wheel_type *wheel, timer_wheel_timer_type *timer, uint32_t delay, uint32_t slack);
+void              timer_wheel_stop              (timer_wheel_type *wheel, timer_wheel_timer_type *timer);
+flag_status       timer_wheel_active            (timer_wheel_timer_type *timer);
+uint32_t          timer_wheel_now               (timer_wheel_type *wheel);
+void              timer_wheel_irq_handler       (timer_wheel_type *wheel);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
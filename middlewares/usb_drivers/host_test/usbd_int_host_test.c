@@ -0,0 +1,262 @@
+/**
+  **************************************************************************
+  * @file     usbd_int_host_test.c
+  * @brief    host model of the usb device interrupt and deferred handler
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * drives usbd_irq_handler with transfer complete interrupts of a bulk out
+ * endpoint whose class handler takes OUT_HANDLER_US (an msc flash write) and
+ * of a bulk in endpoint whose handler takes IN_HANDLER_US. the otg registers
+ * are plain memory and the time is a simulated 144 mhz cycle counter that the
+ * class handlers advance, so the interrupt time shows which handlers run in
+ * the interrupt, not the cost of the driver code on the target.
+ * - with USBD_DEFERRED_EVENT 1 the interrupt only queues the events: it is
+ *   shorter than the shortest handler, every event reaches its class handler
+ *   in order once usbd_deferred_handler runs, a transfer event queued before
+ *   a bus reset is dropped and counted stale, a full queue counts overflows.
+ * - with USBD_DEFERRED_EVENT 0 every event reaches its handler from the
+ *   interrupt, which then lasts as long as the handler.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "usb_core.h"
+#include "usbd_int.h"
+
+#define CYCLES_PER_US                    144
+#define OUT_HANDLER_US                   2000
+#define IN_HANDLER_US                    200
+#define EVENTS                           200
+#define OUT_EPT                          1
+#define IN_EPT                           2
+
+static uint32_t otg_regs[0x30000 / 4];
+static uint32_t host_clock, notify_count;
+static uint32_t out_calls, in_calls, reset_events, order_errors;
+static uint8_t last_ept;
+static int fails;
+
+otg_core_type otg_core_struct;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+uint32_t host_usb_time(void)
+{
+  return host_clock++;
+}
+
+void host_usb_notify(void)
+{
+  notify_count++;
+}
+
+void usb_delay_ms(uint32_t ms)
+{
+}
+
+void usb_delay_us(uint32_t us)
+{
+}
+
+/* class handlers that take the time of the work they stand for */
+static usb_sts_type class_out(void *udev, uint8_t ept_num)
+{
+  CHECK(ept_num == OUT_EPT);
+  order_errors += (last_ept == OUT_EPT);
+  last_ept = OUT_EPT;
+  out_calls++;
+  host_clock += OUT_HANDLER_US * CYCLES_PER_US;
+  return USB_OK;
+}
+
+static usb_sts_type class_in(void *udev, uint8_t ept_num)
+{
+  CHECK(ept_num == IN_EPT);
+  order_errors += (last_ept == IN_EPT);
+  last_ept = IN_EPT;
+  in_calls++;
+  host_clock += IN_HANDLER_US * CYCLES_PER_US;
+  return USB_OK;
+}
+
+static usb_sts_type class_event(void *udev, usbd_event_type event)
+{
+  reset_events += (event == USBD_RESET_EVENT);
+  return USB_OK;
+}
+
+static usbd_class_handler class_handler =
+{
+  NULL, NULL, NULL, NULL, NULL, class_in, class_out, NULL, class_event, NULL
+};
+
+/* the controller flags a transfer complete on one endpoint */
+static void transfer_complete(otg_global_type *usbx, uint8_t ept, uint8_t in)
+{
+  usbx->gintmsk = USB_OTG_OEPT_FLAG | USB_OTG_IEPT_FLAG | USB_OTG_USBRST_FLAG;
+  usbx->gintsts = in ? USB_OTG_IEPT_FLAG : USB_OTG_OEPT_FLAG;
+  OTG_DEVICE(usbx)->daintmsk = 0xFFFFFFFF;
+  OTG_DEVICE(usbx)->daint = in ? (1 << ept) : (1 << (16 + ept));
+  OTG_DEVICE(usbx)->doepmsk = 0xFF;
+  OTG_DEVICE(usbx)->diepmsk = 0xFF;
+  if(in)
+  {
+    USB_INEPT(usbx, ept)->diepint = USB_OTG_DIEPINT_XFERC_FLAG;
+  }
+  else
+  {
+    USB_OUTEPT(usbx, ept)->doepint = USB_OTG_DOEPINT_XFERC_FLAG;
+  }
+}
+
+static void bus_reset(otg_global_type *usbx)
+{
+  usbx->gintmsk = USB_OTG_USBRST_FLAG;
+  usbx->gintsts = USB_OTG_USBRST_FLAG;
+  OTG_DEVICE(usbx)->daint = 0;
+}
+
+static uint32_t irq_run(void)
+{
+  uint32_t start = host_clock;
+
+  usbd_irq_handler(&otg_core_struct);
+  return host_clock - start;
+}
+
+static void device_init(void)
+{
+  usbd_core_type *udev = &otg_core_struct.dev;
+
+  memset(otg_regs, 0, sizeof(otg_regs));
+  memset(&otg_core_struct, 0, sizeof(otg_core_struct));
+  otg_core_struct.usb_reg = (otg_global_type *)otg_regs;
+  udev->usb_reg = (otg_global_type *)otg_regs;
+  udev->class_handler = &class_handler;
+  udev->conn_state = USB_CONN_STATE_CONFIGURED;
+  out_calls = 0;
+  in_calls = 0;
+  reset_events = 0;
+  order_errors = 0;
+  last_ept = 0;
+  notify_count = 0;
+}
+
+static void isr_time_test(void)
+{
+  otg_global_type *usbx = (otg_global_type *)otg_regs;
+  uint32_t index, time, isr_max = 0, isr_total = 0;
+
+  device_init();
+  for(index = 0; index < EVENTS; index++)
+  {
+    /* out and in completions alternate */
+    transfer_complete(usbx, (index & 1) ? IN_EPT : OUT_EPT, index & 1);
+    time = irq_run();
+    isr_total += time;
+    isr_max = (time > isr_max) ? time : isr_max;
+#if (USBD_DEFERRED_EVENT == 1)
+    if(notify_count != 0)
+    {
+      notify_count = 0;
+      usbd_deferred_handler(&otg_core_struct);
+    }
+#endif
+  }
+
+  printf("%s: interrupt average %.1f us, max %.1f us, out handler %u us, in handler %u us, %u out and %u in calls\n",
+         USBD_DEFERRED_EVENT ? "deferred" : "in interrupt", isr_total / (double)EVENTS / CYCLES_PER_US,
+         isr_max / (double)CYCLES_PER_US, OUT_HANDLER_US, IN_HANDLER_US, out_calls, in_calls);
+
+  CHECK(out_calls == EVENTS / 2 && in_calls == EVENTS / 2);
+  CHECK(order_errors == 0);
+#if (USBD_DEFERRED_EVENT == 1)
+  {
+    usbd_deferred_type *defer = &otg_core_struct.dev.deferred;
+
+    CHECK(isr_max < IN_HANDLER_US * CYCLES_PER_US);
+    CHECK(defer->isr_count == EVENTS);
+    CHECK(defer->event_count[USBD_DEFERRED_OUT] == EVENTS / 2 && defer->event_count[USBD_DEFERRED_IN] == EVENTS / 2);
+    CHECK(defer->handler_time_max[USBD_DEFERRED_OUT] >= OUT_HANDLER_US * CYCLES_PER_US);
+    CHECK(defer->handler_time_max[USBD_DEFERRED_IN] >= IN_HANDLER_US * CYCLES_PER_US);
+    CHECK(defer->level_max == 1 && defer->overflow_count == 0 && defer->stale_count == 0);
+    printf("  isr_time_max %u cycles, handler max out %u in %u cycles, latency max out %u cycles\n",
+           defer->isr_time_max, defer->handler_time_max[USBD_DEFERRED_OUT], defer->handler_time_max[USBD_DEFERRED_IN],
+           defer->latency_max[USBD_DEFERRED_OUT]);
+  }
+#else
+  CHECK(isr_max >= OUT_HANDLER_US * CYCLES_PER_US);
+#endif
+}
+
+#if (USBD_DEFERRED_EVENT == 1)
+/* events wait in the queue while the handler does not run */
+static void queue_test(void)
+{
+  otg_global_type *usbx = (otg_global_type *)otg_regs;
+  usbd_deferred_type *defer = &otg_core_struct.dev.deferred;
+  uint32_t index;
+
+  /* more completions than the queue holds */
+  device_init();
+  for(index = 0; index < USBD_DEFERRED_QUEUE_SIZE + 4; index++)
+  {
+    transfer_complete(usbx, (index & 1) ? IN_EPT : OUT_EPT, index & 1);
+    irq_run();
+  }
+  CHECK(out_calls == 0 && in_calls == 0);
+  CHECK(defer->level_max == USBD_DEFERRED_QUEUE_SIZE && defer->overflow_count == 4);
+  usbd_deferred_handler(&otg_core_struct);
+  CHECK(out_calls + in_calls == USBD_DEFERRED_QUEUE_SIZE && order_errors == 0);
+
+  /* a bus reset with a transfer event still queued */
+  device_init();
+  transfer_complete(usbx, OUT_EPT, 0);
+  irq_run();
+  bus_reset(usbx);
+  irq_run();
+  otg_core_struct.dev.conn_state = USB_CONN_STATE_CONFIGURED;
+  usbd_deferred_handler(&otg_core_struct);
+  CHECK(out_calls == 0 && defer->stale_count == 1);
+  CHECK(reset_events == 1);
+
+  /* events after the reset are handled */
+  transfer_complete(usbx, OUT_EPT, 0);
+  irq_run();
+  usbd_deferred_handler(&otg_core_struct);
+  CHECK(out_calls == 1 && defer->stale_count == 1);
+
+  printf("  queue of %u: overflow and stale events counted\n", USBD_DEFERRED_QUEUE_SIZE);
+}
+#endif
+
+int main(void)
+{
+  isr_time_test();
+#if (USBD_DEFERRED_EVENT == 1)
+  queue_test();
+#endif
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
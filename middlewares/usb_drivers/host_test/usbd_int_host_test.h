@@ -0,0 +1,39 @@
+/**
+  **************************************************************************
+  * @file     usbd_int_host_test.h
+  * @brief    time base and notify of the usb interrupt host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#ifndef __USBD_INT_HOST_TEST_H
+#define __USBD_INT_HOST_TEST_H
+
+#include <stdint.h>
+
+/* the deferred handler runs from the test instead of pendsv, and the time
+   base is a simulated cycle counter */
+uint32_t host_usb_time(void);
+void host_usb_notify(void);
+
+#define USBD_DEFERRED_TIME()             host_usb_time()
+#define USBD_DEFERRED_NOTIFY()           host_usb_notify()
+
+#endif
@@ -112,6 +112,88 @@ typedef struct
   void         *pdata;                                               /*!< usb class data pointer */
 }usbd_class_handler;
 
+/**
+  * @brief usb device fifo sizes in 32-bit words, used instead of the usb_conf.h
+  *        sizes when set before usbd_init
+  */
+typedef struct
+{
+  uint16_t                               rx_size;                    /*!< shared receive fifo size */
+  uint16_t                               tx_size[USB_EPT_MAX_NUM];   /*!< in endpoint transmit fifo size */
+}usbd_fifo_plan_type;
+
+#if (USBD_DEFERRED_EVENT == 1)
+/**
+  * @brief deferred event mode: usbd_irq_handler only services the hardware
+  *        (fifo, endpoint and address registers) and queues the transfer
+  *        complete, setup and state events, the class handlers run from
+  *        usbd_deferred_handler. USBD_DEFERRED_NOTIFY is called when an event
+  *        is queued, by default it pends PendSV, which must then have the
+  *        lowest priority and call usbd_deferred_handler. an rtos can wake a
+  *        task instead. USBD_DEFERRED_TIME is the time base of the isr duration
+  *        and latency statistics, by default the dwt cycle counter.
+  */
+#ifndef USBD_DEFERRED_QUEUE_SIZE
+#define USBD_DEFERRED_QUEUE_SIZE         16          /* power of two */
+#endif
+#ifndef USBD_DEFERRED_NOTIFY
+#define USBD_DEFERRED_NOTIFY()           (SCB->ICSR = SCB_ICSR_PENDSVSET_Msk)
+#endif
+#ifndef USBD_DEFERRED_TIME
+#define USBD_DEFERRED_TIME()             (DWT->CYCCNT)
+#define USBD_DEFERRED_TIME_DWT           1           /* usbd_deferred_init starts the dwt */
+#endif
+
+/**
+  * @brief usb device deferred event type
+  */
+typedef enum
+{
+  USBD_DEFERRED_IN,                      /*!< in transfer complete, param is the endpoint */
+  USBD_DEFERRED_OUT,                     /*!< out transfer complete, param is the endpoint */
+  USBD_DEFERRED_SETUP,                   /*!< setup received, param is the endpoint */
+  USBD_DEFERRED_CLEAR,                   /*!< enumeration done, class clear handler */
+  USBD_DEFERRED_CLASS_EVENT,             /*!< class event, param is the usbd_event_type */
+  USBD_DEFERRED_TYPE_NUM
+}usbd_deferred_event_type;
+
+/**
+  * @brief usb device deferred queue entry
+  */
+typedef struct
+{
+  uint8_t                                type;                       /*!< usbd_deferred_event_type */
+  uint8_t                                param;                      /*!< endpoint or event */
+  uint8_t                                epoch;                      /*!< bus reset count when queued */
+  uint8_t                                setup[8];                   /*!< setup packet of USBD_DEFERRED_SETUP */
+  uint32_t                               time;                       /*!< USBD_DEFERRED_TIME when queued */
+}usbd_deferred_entry_type;
+
+/**
+  * @brief usb device deferred event queue and statistics, times are in
+  *        USBD_DEFERRED_TIME units
+  */
+typedef struct
+{
+  usbd_deferred_entry_type               queue[USBD_DEFERRED_QUEUE_SIZE];   /*!< event queue */
+  __IO uint16_t                          head;                       /*!< written by the isr */
+  __IO uint16_t                          tail;                       /*!< written by the deferred handler */
+  __IO uint8_t                           epoch;                      /*!< bus reset count */
+  __IO uint32_t                          sof_count;                  /*!< sof received */
+  uint32_t                               sof_done;                   /*!< sof handled */
+
+  __IO uint32_t                          isr_count;                  /*!< interrupts serviced */
+  __IO uint32_t                          isr_time_last;              /*!< last isr duration */
+  __IO uint32_t                          isr_time_max;               /*!< longest isr duration */
+  __IO uint32_t                          overflow_count;             /*!< events lost, queue full */
+  __IO uint32_t                          stale_count;                /*!< events dropped after a bus reset */
+  __IO uint16_t                          level_max;                  /*!< queue high water mark */
+  uint32_t                               event_count[USBD_DEFERRED_TYPE_NUM];    /*!< events handled */
+  uint32_t                               latency_max[USBD_DEFERRED_TYPE_NUM];    /*!< worst queue to handler time */
+  uint32_t                               handler_time_max[USBD_DEFERRED_TYPE_NUM]; /*!< longest handler */
+}usbd_deferred_type;
+#endif
+
 /**
   * @brief usb device core struct type
   */
@@ -140,6 +222,12 @@ typedef struct
   uint32_t                               default_config;             /*!< usb default config state */
   uint32_t                               dev_config;                 /*!< usb device config state */
   uint32_t                               config_status;              /*!< usb configure status */
+
+  usbd_fifo_plan_type                    *fifo_plan;                 /*!< usb fifo sizes, NULL for usb_conf.h */
+
+#if (USBD_DEFERRED_EVENT == 1)
+  usbd_deferred_type                     deferred;                   /*!< usb deferred events */
+#endif
 }usbd_core_type;
 
 void usbd_core_in_handler(usbd_core_type *udev, uint8_t ept_num);
@@ -60,6 +60,10 @@ void usbd_incomisioin_handler(usbd_core_type *udev);
 void usbd_discon_handler(usbd_core_type *udev);
 void usbd_incomisoout_handler(usbd_core_type *udev);
 void usb_write_empty_txfifo(usbd_core_type *udev, uint32_t ept_num);
+#if (USBD_DEFERRED_EVENT == 1)
+void usbd_deferred_init(usbd_core_type *udev);
+void usbd_deferred_handler(otg_core_type *otgdev);
+#endif
 
 /**
   * @}
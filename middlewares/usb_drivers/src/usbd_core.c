@@ -26,6 +26,9 @@
 #include "usb_core.h"
 #include "usbd_core.h"
 #include "usbd_sdr.h"
+#if (USBD_DEFERRED_EVENT == 1)
+#include "usbd_int.h"
+#endif
 
 /** @addtogroup AT32F415_middlewares_usbd_drivers
   * @{
@@ -460,7 +463,7 @@ void usbd_ept_send(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint
   usb_ept_info *ept_info = &udev->ept_in[ept_addr & 0x7F];
   otg_eptin_type *ept_in = USB_INEPT(usbx, ept_info->eptn);
   otg_device_type *dev = OTG_DEVICE(usbx);
-  uint32_t pktcnt;
+  uint32_t pktcnt, primask;
   
   /* check endpoint fifo */
   usbd_ept_in_check_fifo(udev, ept_addr);
@@ -536,8 +539,12 @@ void usbd_ept_send(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint
   {
     if(ept_info->total_len > 0)
     {
-      /* set in endpoint tx fifo empty interrupt mask */
+      /* set in endpoint tx fifo empty interrupt mask, the usb interrupt
+         clears other bits of this register */
+      primask = __get_PRIMASK();
+      __disable_irq();
       dev->diepempmsk |= 1 << ept_info->eptn;
+      __set_PRIMASK(primask);
     }
   }
   else
@@ -685,6 +692,20 @@ void usbd_flush_tx_fifo(usbd_core_type *udev, uint8_t ept_num)
 void usbd_fifo_alloc(usbd_core_type *udev)
 {
   usb_reg_type *usbx = udev->usb_reg;
+  uint8_t i_index;
+
+  if(udev->fifo_plan != NULL)
+  {
+    /* set receive fifo size */
+    usb_set_rx_fifo(usbx, udev->fifo_plan->rx_size);
+
+    /* set tx fifo size of every in endpoint, in order */
+    for(i_index = 0; i_index < USB_EPT_MAX_NUM; i_index ++)
+    {
+      usb_set_tx_fifo(usbx, i_index, udev->fifo_plan->tx_size[i_index]);
+    }
+    return;
+  }
 
   if(usbx == OTG1_GLOBAL)
   {
@@ -790,6 +811,11 @@ usb_sts_type usbd_core_init(usbd_core_type *udev,
   udev->class_handler = class_handler;
   udev->desc_handler = desc_handler;
 
+#if (USBD_DEFERRED_EVENT == 1)
+  /* empty the deferred event queue */
+  usbd_deferred_init(udev);
+#endif
+
   /* set device disconnect */
   usbd_disconnect(udev);
 
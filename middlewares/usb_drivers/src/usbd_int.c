@@ -37,6 +37,10 @@
   * @{
   */
 
+#if (USBD_DEFERRED_EVENT == 1)
+static usbd_deferred_entry_type *usbd_deferred_post(usbd_core_type *udev, uint8_t type, uint8_t param);
+#endif
+
 /**
   * @brief  usb device interrput request handler.
   * @param  otgdev: to the structure of otg_core_type
@@ -47,6 +51,9 @@ void usbd_irq_handler(otg_core_type *otgdev)
   otg_global_type *usbx = otgdev->usb_reg;
   usbd_core_type *udev = &otgdev->dev;
   uint32_t intsts = usb_global_get_all_interrupt(usbx);
+#if (USBD_DEFERRED_EVENT == 1)
+  uint32_t isr_start = USBD_DEFERRED_TIME();
+#endif
 
   /* check current device mode */
   if(usbx->gintsts_bit.curmode == 0)
@@ -79,7 +86,15 @@ void usbd_irq_handler(otg_core_type *otgdev)
     /* sof interrupt */
     if(intsts & USB_OTG_SOF_FLAG)
     {
+#if (USBD_DEFERRED_EVENT == 1)
+      if(udev->class_handler->sof_handler)
+      {
+        udev->deferred.sof_count ++;
+        USBD_DEFERRED_NOTIFY();
+      }
+#else
       usbd_sof_handler(udev);
+#endif
       usb_global_clear_interrupt(usbx, USB_OTG_SOF_FLAG);
     }
 
@@ -135,8 +150,168 @@ void usbd_irq_handler(otg_core_type *otgdev)
       usb_global_clear_interrupt(usbx, USB_OTG_USBSUSP_FLAG);
     }
   }
+
+#if (USBD_DEFERRED_EVENT == 1)
+  isr_start = USBD_DEFERRED_TIME() - isr_start;
+  udev->deferred.isr_time_last = isr_start;
+  if(isr_start > udev->deferred.isr_time_max)
+  {
+    udev->deferred.isr_time_max = isr_start;
+  }
+  udev->deferred.isr_count ++;
+#endif
 }
 
+#if (USBD_DEFERRED_EVENT == 1)
+/**
+  * @brief  queue an event for usbd_deferred_handler, called from the usb
+  *         interrupt only.
+  * @param  udev: to the structure of usbd_core_type
+  * @param  type: event type of usbd_deferred_event_type
+  * @param  param: endpoint number or usbd_event_type
+  * @retval queued entry, NULL when the queue is full
+  */
+static usbd_deferred_entry_type *usbd_deferred_post(usbd_core_type *udev, uint8_t type, uint8_t param)
+{
+  usbd_deferred_type *defer = &udev->deferred;
+  usbd_deferred_entry_type *entry;
+  uint16_t level = (uint16_t)(defer->head - defer->tail);
+
+  if(level >= USBD_DEFERRED_QUEUE_SIZE)
+  {
+    defer->overflow_count ++;
+    return NULL;
+  }
+
+  entry = &defer->queue[defer->head & (USBD_DEFERRED_QUEUE_SIZE - 1)];
+  entry->type = type;
+  entry->param = param;
+  entry->epoch = defer->epoch;
+  entry->time = USBD_DEFERRED_TIME();
+  if(type == USBD_DEFERRED_SETUP)
+  {
+    /* the setup buffer is overwritten by the next setup packet */
+    for(level = 0; level < 8; level ++)
+    {
+      entry->setup[level] = udev->setup_buffer[level];
+    }
+  }
+  defer->head ++;
+
+  level = (uint16_t)(defer->head - defer->tail);
+  if(level > defer->level_max)
+  {
+    defer->level_max = level;
+  }
+
+  USBD_DEFERRED_NOTIFY();
+  return entry;
+}
+
+/**
+  * @brief  reset the deferred event queue and statistics and start the dwt
+  *         cycle counter when it is the time base, called by usbd_core_init.
+  * @param  udev: to the structure of usbd_core_type
+  * @retval none
+  */
+void usbd_deferred_init(usbd_core_type *udev)
+{
+  usbd_deferred_type *defer = &udev->deferred;
+  uint8_t *byte = (uint8_t *)defer;
+  uint32_t i_index;
+
+  for(i_index = 0; i_index < sizeof(usbd_deferred_type); i_index ++)
+  {
+    byte[i_index] = 0;
+  }
+
+#ifdef USBD_DEFERRED_TIME_DWT
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+  * @brief  run the class handlers of the queued events in order, called from
+  *         PendSV or a task after USBD_DEFERRED_NOTIFY. transfer and setup
+  *         events queued before a bus reset are dropped.
+  * @param  otgdev: to the structure of otg_core_type
+  * @retval none
+  */
+void usbd_deferred_handler(otg_core_type *otgdev)
+{
+  usbd_core_type *udev = &otgdev->dev;
+  usbd_deferred_type *defer = &udev->deferred;
+  usbd_deferred_entry_type *entry;
+  uint32_t start, elapsed;
+  uint8_t i_index;
+
+  /* sof events are only counted by the isr */
+  while(defer->sof_done != defer->sof_count)
+  {
+    defer->sof_done ++;
+    usbd_sof_handler(udev);
+  }
+
+  while(defer->tail != defer->head)
+  {
+    entry = &defer->queue[defer->tail & (USBD_DEFERRED_QUEUE_SIZE - 1)];
+    start = USBD_DEFERRED_TIME();
+    elapsed = start - entry->time;
+    if(elapsed > defer->latency_max[entry->type])
+    {
+      defer->latency_max[entry->type] = elapsed;
+    }
+
+    if(entry->type <= USBD_DEFERRED_SETUP && entry->epoch != defer->epoch)
+    {
+      /* the endpoints were reset since this event */
+      defer->stale_count ++;
+    }
+    else
+    {
+      switch(entry->type)
+      {
+        case USBD_DEFERRED_IN:
+          usbd_core_in_handler(udev, entry->param);
+          break;
+        case USBD_DEFERRED_OUT:
+          usbd_core_out_handler(udev, entry->param);
+          break;
+        case USBD_DEFERRED_SETUP:
+          for(i_index = 0; i_index < 8; i_index ++)
+          {
+            udev->setup_buffer[i_index] = entry->setup[i_index];
+          }
+          usbd_core_setup_handler(udev, entry->param);
+          if(udev->device_addr != 0)
+          {
+            OTG_DEVICE(udev->usb_reg)->dcfg_bit.devaddr = udev->device_addr;
+            udev->device_addr = 0;
+          }
+          break;
+        case USBD_DEFERRED_CLEAR:
+          if(udev->class_handler->clear_handler != 0)
+            udev->class_handler->clear_handler(udev);
+          break;
+        default:
+          if(udev->class_handler->event_handler != 0)
+            udev->class_handler->event_handler(udev, (usbd_event_type)entry->param);
+          break;
+      }
+      defer->event_count[entry->type] ++;
+
+      elapsed = USBD_DEFERRED_TIME() - start;
+      if(elapsed > defer->handler_time_max[entry->type])
+      {
+        defer->handler_time_max[entry->type] = elapsed;
+      }
+    }
+    defer->tail ++;
+  }
+}
+#endif
+
 /**
   * @brief  usb write tx fifo.
   * @param  udev: to the structure of usbd_core_type
@@ -203,7 +378,11 @@ void usbd_inept_handler(usbd_core_type *udev)
       {
         OTG_DEVICE(usbx)->diepempmsk &= ~(1 << ept_num);
         usb_ept_in_clear(usbx, ept_num , USB_OTG_DIEPINT_XFERC_FLAG);
+#if (USBD_DEFERRED_EVENT == 1)
+        usbd_deferred_post(udev, USBD_DEFERRED_IN, ept_num);
+#else
         usbd_core_in_handler(udev, ept_num);
+#endif
       }
 
       /* timeout condition interrupt */
@@ -266,19 +445,27 @@ void usbd_outept_handler(usbd_core_type *udev)
       if(ept_int & USB_OTG_DOEPINT_XFERC_FLAG)
       {
         usb_ept_out_clear(usbx, ept_num , USB_OTG_DOEPINT_XFERC_FLAG);
+#if (USBD_DEFERRED_EVENT == 1)
+        usbd_deferred_post(udev, USBD_DEFERRED_OUT, ept_num);
+#else
         usbd_core_out_handler(udev, ept_num);
+#endif
       }
 
       /* setup phase done interrupt */
       if(ept_int & USB_OTG_DOEPINT_SETUP_FLAG)
       {
         usb_ept_out_clear(usbx, ept_num , USB_OTG_DOEPINT_SETUP_FLAG);
+#if (USBD_DEFERRED_EVENT == 1)
+        usbd_deferred_post(udev, USBD_DEFERRED_SETUP, ept_num);
+#else
         usbd_core_setup_handler(udev, ept_num);
         if(udev->device_addr != 0)
         {
           OTG_DEVICE(udev->usb_reg)->dcfg_bit.devaddr = udev->device_addr;
           udev->device_addr = 0;
         }
+#endif
       }
 
       /* endpoint disable interrupt */
@@ -315,8 +502,12 @@ void usbd_enumdone_handler(usbd_core_type *udev)
   udev->conn_state = USB_CONN_STATE_DEFAULT;
 
   /* clear callback */
+#if (USBD_DEFERRED_EVENT == 1)
+  usbd_deferred_post(udev, USBD_DEFERRED_CLEAR, 0);
+#else
   if(udev->class_handler->clear_handler != 0)
     udev->class_handler->clear_handler(udev);
+#endif
 }
 
 /**
@@ -380,8 +571,12 @@ void usbd_rxflvl_handler(usbd_core_type *udev)
 void usbd_discon_handler(usbd_core_type *udev)
 {
   /* disconnect callback handler */
+#if (USBD_DEFERRED_EVENT == 1)
+  usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_DISCONNECT_EVNET);
+#else
   if(udev->class_handler->event_handler != 0)
     udev->class_handler->event_handler(udev, USBD_DISCONNECT_EVNET);
+#endif
 }
 
 
@@ -392,8 +587,12 @@ void usbd_discon_handler(usbd_core_type *udev)
   */
 void usbd_incomisoout_handler(usbd_core_type *udev)
 {
+#if (USBD_DEFERRED_EVENT == 1)
+    usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_OUTISOINCOM_EVENT);
+#else
     if(udev->class_handler->event_handler != 0)
       udev->class_handler->event_handler(udev, USBD_OUTISOINCOM_EVENT);
+#endif
 }
 
 /**
@@ -403,8 +602,12 @@ void usbd_incomisoout_handler(usbd_core_type *udev)
   */
 void usbd_incomisioin_handler(usbd_core_type *udev)
 {
+#if (USBD_DEFERRED_EVENT == 1)
+  usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_INISOINCOM_EVENT);
+#else
   if(udev->class_handler->event_handler != 0)
     udev->class_handler->event_handler(udev, USBD_INISOINCOM_EVENT);
+#endif
 }
 
 /**
@@ -464,8 +667,13 @@ void usbd_reset_handler(usbd_core_type *udev)
   udev->conn_state = USB_CONN_STATE_DEFAULT;
 
   /* user define reset event */
+#if (USBD_DEFERRED_EVENT == 1)
+  udev->deferred.epoch ++;
+  usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_RESET_EVENT);
+#else
   if(udev->class_handler->event_handler)
     udev->class_handler->event_handler(udev, USBD_RESET_EVENT);
+#endif
 }
 
 /**
@@ -501,8 +709,12 @@ void usbd_suspend_handler(usbd_core_type *udev)
     usbd_enter_suspend(udev);
 
     /* user suspend handler */
+#if (USBD_DEFERRED_EVENT == 1)
+    usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_SUSPEND_EVENT);
+#else
     if(udev->class_handler->event_handler != 0)
       udev->class_handler->event_handler(udev, USBD_SUSPEND_EVENT);
+#endif
   }
 }
 
@@ -525,8 +737,12 @@ void usbd_wakeup_handler(usbd_core_type *udev)
   udev->conn_state = udev->old_conn_state;
 
     /* user suspend handler */
+#if (USBD_DEFERRED_EVENT == 1)
+  usbd_deferred_post(udev, USBD_DEFERRED_CLASS_EVENT, USBD_WAKEUP_EVENT);
+#else
   if(udev->class_handler->event_handler != 0)
     udev->class_handler->event_handler(udev, USBD_WAKEUP_EVENT);
+#endif
 }
 /**
   * @}
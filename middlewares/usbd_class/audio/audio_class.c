@@ -85,7 +85,6 @@ static usb_sts_type class_init_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  usb_audio_type *paudio = (usb_audio_type *)pudev->class_handler->pdata;
 
   /* open microphone in endpoint */
   usbd_ept_open(pudev, USBD_AUDIO_MIC_IN_EPT, EPT_ISO_TYPE, AUDIO_MIC_IN_MAXPACKET_SIZE);
@@ -97,7 +96,7 @@ static usb_sts_type class_init_handler(void *udev)
   usbd_ept_open(pudev, USBD_AUDIO_FEEDBACK_EPT, EPT_ISO_TYPE, AUDIO_FEEDBACK_MAXPACKET_SIZE);
 #endif
   /* start receive speaker out data */
-  usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, paudio->audio_spk_data, AUDIO_SPK_OUT_MAXPACKET_SIZE);
+  usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, audio_codec_spk_rx_buffer(), AUDIO_SPK_OUT_MAXPACKET_SIZE);
 
   return status;
 }
@@ -306,15 +305,17 @@ static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
   usbd_core_type *pudev = (usbd_core_type *)udev;
   usb_audio_type *paudio = (usb_audio_type *)pudev->class_handler->pdata;
   uint32_t len = 0;
+  uint8_t *pdata;
 
   /* ...user code...
     trans next packet data
   */
   if((ept_num & 0x7F) == (USBD_AUDIO_MIC_IN_EPT & 0x7F))
   {
-    len = audio_codec_mic_get_data(paudio->audio_mic_data);
+    /* the packet is sent straight from the i2s dma ring */
+    len = audio_codec_mic_get_data(&pdata);
     usbd_flush_tx_fifo(udev, USBD_AUDIO_MIC_IN_EPT);
-    usbd_ept_send(udev, USBD_AUDIO_MIC_IN_EPT, paudio->audio_mic_data, len);
+    usbd_ept_send(udev, USBD_AUDIO_MIC_IN_EPT, pdata, len);
   }
 
   else if((ept_num & 0x7F) == (USBD_AUDIO_FEEDBACK_EPT & 0x7F))
@@ -343,11 +344,11 @@ static usb_sts_type class_out_handler(void *udev, uint8_t ept_num)
 
   if((ept_num & 0x7F) == (USBD_AUDIO_SPK_OUT_EPT & 0x7F))
   {
-    /* speaker data*/
-    audio_codec_spk_fifo_write(paudio->audio_spk_data, g_rxlen);
+    /* speaker data, received straight into the i2s dma ring */
+    audio_codec_spk_fifo_commit(g_rxlen);
     paudio->audio_spk_out_stage = 1;
     /* get next data */
-    usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, paudio->audio_spk_data, AUDIO_SPK_OUT_MAXPACKET_SIZE);
+    usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, audio_codec_spk_rx_buffer(), AUDIO_SPK_OUT_MAXPACKET_SIZE);
   }
 
   return status;
@@ -365,6 +366,9 @@ static usb_sts_type class_sof_handler(void *udev)
   usb_audio_type *paudio = (usb_audio_type *)pudev->class_handler->pdata;
 
 #if AUDIO_SUPPORT_FEEDBACK
+  /* speaker clock recovery */
+  audio_codec_spk_sof(OTG_DEVICE(pudev->usb_reg)->dsts_bit.soffn);
+
   if(paudio->audio_spk_out_stage & 2)
   {
     paudio->audio_spk_out_stage = 0;
@@ -449,6 +453,7 @@ static void audio_inisoincom_event(void *udev)
   uint32_t epctl_fb = USB_INEPT(pudev->usb_reg, (USBD_AUDIO_FEEDBACK_EPT&0x7F))->diepctl_bit.dpid;
   uint32_t epctl_in = USB_INEPT(pudev->usb_reg, (USBD_AUDIO_MIC_IN_EPT&0x7F))->diepctl_bit.dpid;
   uint32_t len = 0;
+  uint8_t *pdata;
 
   if((fnsof & 0x1) == epctl_fb)
   {
@@ -465,8 +470,8 @@ static void audio_inisoincom_event(void *udev)
     USB_INEPT(pudev->usb_reg, (USBD_AUDIO_MIC_IN_EPT&0x7F))->diepctl_bit.snak = 1;
     usb_flush_tx_fifo(pudev->usb_reg, USBD_AUDIO_MIC_IN_EPT&0x7F);
 
-    len = audio_codec_mic_get_data(paudio->audio_mic_data);
-    usbd_ept_send(pudev, USBD_AUDIO_MIC_IN_EPT, paudio->audio_mic_data, len);
+    len = audio_codec_mic_get_data(&pdata);
+    usbd_ept_send(pudev, USBD_AUDIO_MIC_IN_EPT, pdata, len);
   }
 #endif
 }
@@ -731,6 +736,7 @@ static void audio_req_get_res(void *udev, usb_setup_type *setup)
 static void audio_set_interface(void *udev, usb_setup_type *setup)
 {
   uint32_t len;
+  uint8_t *pdata;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   usb_audio_type *paudio = (usb_audio_type *)pudev->class_handler->pdata;
   if(LBYTE(setup->wIndex) == AUDIO_SPK_INTERFACE_NUMBER)
@@ -739,7 +745,7 @@ static void audio_set_interface(void *udev, usb_setup_type *setup)
     audio_codec_spk_alt_setting(paudio->spk_alt_setting);
     if(paudio->spk_alt_setting )
     {
-      usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, paudio->audio_spk_data, AUDIO_SPK_OUT_MAXPACKET_SIZE);
+      usbd_ept_recv(pudev, USBD_AUDIO_SPK_OUT_EPT, audio_codec_spk_rx_buffer(), AUDIO_SPK_OUT_MAXPACKET_SIZE);
     }
 
   }
@@ -749,8 +755,8 @@ static void audio_set_interface(void *udev, usb_setup_type *setup)
     audio_codec_mic_alt_setting(paudio->mic_alt_setting);
     if(paudio->mic_alt_setting)
     {
-      len = audio_codec_mic_get_data(paudio->audio_mic_data);
-      usbd_ept_send(pudev, USBD_AUDIO_MIC_IN_EPT, paudio->audio_mic_data, len);
+      len = audio_codec_mic_get_data(&pdata);
+      usbd_ept_send(pudev, USBD_AUDIO_MIC_IN_EPT, pdata, len);
     }
   }
 
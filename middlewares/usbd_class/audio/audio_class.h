@@ -105,8 +105,6 @@ typedef struct
   uint32_t spk_alt_setting;
   uint32_t mic_alt_setting;
   uint8_t g_audio_cur[64];
-  uint8_t audio_spk_data[AUDIO_SPK_OUT_MAXPACKET_SIZE];
-  uint8_t audio_mic_data[AUDIO_MIC_IN_MAXPACKET_SIZE];
   uint8_t audio_feed_back[AUDIO_FEEDBACK_MAXPACKET_SIZE+1];
 
    __IO uint16_t audio_feedback_state;
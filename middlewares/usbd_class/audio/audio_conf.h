@@ -47,15 +47,25 @@ extern "C" {
 #define AUDIO_SUPPORT_MIC                1
 #define AUDIO_SUPPORT_FEEDBACK           1
 
+/* the codec runs at a fixed rate, the usb rates are converted in software */
+#define AUDIO_SUPPORT_FREQ_8K            1
 #define AUDIO_SUPPORT_FREQ_16K           1
+#define AUDIO_SUPPORT_FREQ_32K           1
+#define AUDIO_SUPPORT_FREQ_44_1K         1
 #define AUDIO_SUPPORT_FREQ_48K           1
 
 
-#define AUDIO_SUPPORT_FREQ               (AUDIO_SUPPORT_FREQ_16K + \
+#define AUDIO_SUPPORT_FREQ               (AUDIO_SUPPORT_FREQ_8K + \
+                                          AUDIO_SUPPORT_FREQ_16K + \
+                                          AUDIO_SUPPORT_FREQ_32K + \
+                                          AUDIO_SUPPORT_FREQ_44_1K + \
                                           AUDIO_SUPPORT_FREQ_48K \
                                          )
 
+#define AUDIO_FREQ_8K                    8000
 #define AUDIO_FREQ_16K                   16000
+#define AUDIO_FREQ_32K                   32000
+#define AUDIO_FREQ_44_1K                 44100
 #define AUDIO_FREQ_48K                   48000
 #define AUDIO_BITW_16                    16
 
@@ -275,9 +275,18 @@ ALIGNED_HEAD static uint8_t g_usbd_configuration[USBD_AUDIO_CONFIG_DESC_SIZE] AL
   AUDIO_MIC_BITW / 8,                    /* bSubFrameSize: per audio subframe */
   AUDIO_MIC_BITW,                        /* bBitResolution: n bits per sample */
   AUDIO_MIC_FREQ_SIZE,                   /* bSamFreqType: n frequency supported */
+#if (AUDIO_SUPPORT_FREQ_8K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_8K),       /* tSamFreq: 8000hz */
+#endif
 #if (AUDIO_SUPPORT_FREQ_16K == 1)
   SAMPLE_FREQ(AT32_AUDIO_FREQ_16K),      /* tSamFreq: 16000hz */
 #endif
+#if (AUDIO_SUPPORT_FREQ_32K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_32K),      /* tSamFreq: 32000hz */
+#endif
+#if (AUDIO_SUPPORT_FREQ_44_1K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_44_1K),    /* tSamFreq: 44100hz */
+#endif
 #if (AUDIO_SUPPORT_FREQ_48K == 1)
   SAMPLE_FREQ(AT32_AUDIO_FREQ_48K),      /* tSamFreq: 48000hz */
 #endif
@@ -339,9 +348,18 @@ ALIGNED_HEAD static uint8_t g_usbd_configuration[USBD_AUDIO_CONFIG_DESC_SIZE] AL
   AUDIO_SPK_BITW / 8,                    /* bSubFrameSize: per audio subframe */
   AUDIO_SPK_BITW,                        /* bBitResolution: n bits per sample */
   AUDIO_SPK_FREQ_SIZE,                   /* bSamFreqType: n frequency supported */
+#if (AUDIO_SUPPORT_FREQ_8K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_8K),       /* tSamFreq: 8000hz */
+#endif
 #if (AUDIO_SUPPORT_FREQ_16K == 1)
   SAMPLE_FREQ(AT32_AUDIO_FREQ_16K),      /* tSamFreq: 16000hz */
 #endif
+#if (AUDIO_SUPPORT_FREQ_32K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_32K),      /* tSamFreq: 32000hz */
+#endif
+#if (AUDIO_SUPPORT_FREQ_44_1K == 1)
+  SAMPLE_FREQ(AT32_AUDIO_FREQ_44_1K),    /* tSamFreq: 44100hz */
+#endif
 #if (AUDIO_SUPPORT_FREQ_48K == 1)
   SAMPLE_FREQ(AT32_AUDIO_FREQ_48K),      /* tSamFreq: 48000hz */
 #endif
@@ -184,7 +184,10 @@ extern "C" {
 /**
   * @brief audio support freq
   */
+#define AT32_AUDIO_FREQ_8K               8000
 #define AT32_AUDIO_FREQ_16K              16000
+#define AT32_AUDIO_FREQ_32K              32000
+#define AT32_AUDIO_FREQ_44_1K            44100
 #define AT32_AUDIO_FREQ_48K              48000
 
 /**
@@ -64,6 +64,14 @@ linecoding_type linecoding =
 /* cdc data struct */
 cdc_struct_type cdc_struct;
 
+/* cdc endpoint addresses */
+cdc_ept_type cdc_ept =
+{
+  USBD_CDC_INT_EPT,
+  USBD_CDC_BULK_IN_EPT,
+  USBD_CDC_BULK_OUT_EPT
+};
+
 /* usb device class handler */
 usbd_class_handler cdc_class_handler =
 {
@@ -87,22 +95,22 @@ static usb_sts_type class_init_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
 
   /* init cdc struct */
   cdc_struct_init(pcdc);
 
   /* open in endpoint */
-  usbd_ept_open(pudev, USBD_CDC_INT_EPT, EPT_INT_TYPE, USBD_CDC_CMD_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, cdc_ept.int_ept, EPT_INT_TYPE, USBD_CDC_CMD_MAXPACKET_SIZE);
 
   /* open in endpoint */
-  usbd_ept_open(pudev, USBD_CDC_BULK_IN_EPT, EPT_BULK_TYPE, USBD_CDC_IN_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, cdc_ept.bulk_in_ept, EPT_BULK_TYPE, USBD_CDC_IN_MAXPACKET_SIZE);
 
   /* open out endpoint */
-  usbd_ept_open(pudev, USBD_CDC_BULK_OUT_EPT, EPT_BULK_TYPE, USBD_CDC_OUT_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, cdc_ept.bulk_out_ept, EPT_BULK_TYPE, USBD_CDC_OUT_MAXPACKET_SIZE);
 
   /* set out endpoint to receive status */
-  usbd_ept_recv(pudev, USBD_CDC_BULK_OUT_EPT, pcdc->g_rx_buff, USBD_CDC_OUT_MAXPACKET_SIZE);
+  usbd_ept_recv(pudev, cdc_ept.bulk_out_ept, pcdc->g_rx_buff, USBD_CDC_OUT_MAXPACKET_SIZE);
 
   return status;
 }
@@ -118,13 +126,13 @@ static usb_sts_type class_clear_handler(void *udev)
   usbd_core_type *pudev = (usbd_core_type *)udev;
 
   /* close in endpoint */
-  usbd_ept_close(pudev, USBD_CDC_INT_EPT);
+  usbd_ept_close(pudev, cdc_ept.int_ept);
 
   /* close in endpoint */
-  usbd_ept_close(pudev, USBD_CDC_BULK_IN_EPT);
+  usbd_ept_close(pudev, cdc_ept.bulk_in_ept);
 
   /* close out endpoint */
-  usbd_ept_close(pudev, USBD_CDC_BULK_OUT_EPT);
+  usbd_ept_close(pudev, cdc_ept.bulk_out_ept);
 
   return status;
 }
@@ -139,7 +147,7 @@ static usb_sts_type class_setup_handler(void *udev, usb_setup_type *setup)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
 
   switch(setup->bmRequestType & USB_REQ_TYPE_RESERVED)
   {
@@ -213,7 +221,7 @@ static usb_sts_type class_ept0_rx_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
   uint32_t recv_len = usbd_get_recv_len(pudev, 0);
   /* ...user code... */
   if( pcdc->g_req == SET_LINE_CODING)
@@ -234,7 +242,7 @@ static usb_sts_type class_ept0_rx_handler(void *udev)
 static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
   usb_sts_type status = USB_OK;
 
   /* ...user code...
@@ -256,7 +264,7 @@ static usb_sts_type class_out_handler(void *udev, uint8_t ept_num)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
 
   /* get endpoint receive data length  */
   pcdc->g_rxlen = usbd_get_recv_len(pudev, ept_num);
@@ -345,7 +353,7 @@ uint16_t usb_vcp_get_rxdata(void *udev, uint8_t *recv_data)
   uint16_t i_index = 0;
   uint16_t tmp_len = 0;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
 
   if(pcdc->g_rx_completed == 0)
   {
@@ -358,7 +366,7 @@ uint16_t usb_vcp_get_rxdata(void *udev, uint8_t *recv_data)
     recv_data[i_index] = pcdc->g_rx_buff[i_index];
   }
 
-  usbd_ept_recv(pudev, USBD_CDC_BULK_OUT_EPT, pcdc->g_rx_buff, USBD_CDC_OUT_MAXPACKET_SIZE);
+  usbd_ept_recv(pudev, cdc_ept.bulk_out_ept, pcdc->g_rx_buff, USBD_CDC_OUT_MAXPACKET_SIZE);
 
   return tmp_len;
 }
@@ -374,11 +382,11 @@ error_status usb_vcp_send_data(void *udev, uint8_t *send_data, uint16_t len)
 {
   error_status status = SUCCESS;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
   if(pcdc->g_tx_completed)
   {
     pcdc->g_tx_completed = 0;
-    usbd_ept_send(pudev, USBD_CDC_BULK_IN_EPT, send_data, len);
+    usbd_ept_send(pudev, cdc_ept.bulk_in_ept, send_data, len);
   }
   else
   {
@@ -397,8 +405,7 @@ error_status usb_vcp_send_data(void *udev, uint8_t *send_data, uint16_t len)
   */
 static void usb_vcp_cmd_process(void *udev, uint8_t cmd, uint8_t *buff, uint16_t len)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  cdc_struct_type *pcdc = (cdc_struct_type *)pudev->class_handler->pdata;
+  cdc_struct_type *pcdc = (cdc_struct_type *)cdc_class_handler.pdata;
   switch(cmd)
   {
     case SET_LINE_CODING:
@@ -82,6 +82,17 @@ typedef struct
   linecoding_type linecoding;
 }cdc_struct_type;
 
+/**
+  * @brief usb cdc endpoint addresses, the defines above unless a composite
+  *        device assigns others
+  */
+typedef struct
+{
+  uint8_t int_ept;
+  uint8_t bulk_in_ept;
+  uint8_t bulk_out_ept;
+}cdc_ept_type;
+
 
 /**
   * @}
@@ -91,6 +102,7 @@ typedef struct
   * @{
   */
 extern usbd_class_handler cdc_class_handler;
+extern cdc_ept_type cdc_ept;
 uint16_t usb_vcp_get_rxdata(void *udev, uint8_t *recv_data);
 error_status usb_vcp_send_data(void *udev, uint8_t *send_data, uint16_t len);
 
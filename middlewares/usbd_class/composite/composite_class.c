@@ -0,0 +1,434 @@
+/**
+  **************************************************************************
+  * @file     composite_class.c
+  * @brief    usb composite device class, functions built from class drivers
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+#include "usbd_core.h"
+#include "composite_class.h"
+#include "composite_desc.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @defgroup USB_composite_class
+  * @brief usb device composite class
+  * @{
+  */
+
+/** @defgroup USB_composite_class_private_functions
+  * @{
+  */
+
+static usb_sts_type class_init_handler(void *udev);
+static usb_sts_type class_clear_handler(void *udev);
+static usb_sts_type class_setup_handler(void *udev, usb_setup_type *setup);
+static usb_sts_type class_ept0_tx_handler(void *udev);
+static usb_sts_type class_ept0_rx_handler(void *udev);
+static usb_sts_type class_in_handler(void *udev, uint8_t ept_num);
+static usb_sts_type class_out_handler(void *udev, uint8_t ept_num);
+static usb_sts_type class_sof_handler(void *udev);
+static usb_sts_type class_event_handler(void *udev, usbd_event_type event);
+static error_status composite_fifo_plan(composite_struct_type *pcomp);
+
+/* composite data struct */
+composite_struct_type composite_struct;
+
+/* usb device class handler */
+usbd_class_handler composite_class_handler =
+{
+  class_init_handler,
+  class_clear_handler,
+  class_setup_handler,
+  class_ept0_tx_handler,
+  class_ept0_rx_handler,
+  class_in_handler,
+  class_out_handler,
+  class_sof_handler,
+  class_event_handler,
+  &composite_struct
+};
+
+/**
+  * @brief  initialize the endpoints of every function
+  * @param  udev: to the structure of usbd_core_type
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_init_handler(void *udev)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t index;
+
+  pcomp->ctrl_function = USBD_COMPOSITE_NONE;
+  for(index = 0; index < pcomp->function_count; index ++)
+  {
+    pcomp->function[index].class_handler->init_handler(udev);
+  }
+
+  return USB_OK;
+}
+
+/**
+  * @brief  clear the endpoints of every function
+  * @param  udev: to the structure of usbd_core_type
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_clear_handler(void *udev)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t index;
+
+  for(index = 0; index < pcomp->function_count; index ++)
+  {
+    pcomp->function[index].class_handler->clear_handler(udev);
+  }
+
+  return USB_OK;
+}
+
+/**
+  * @brief  usb device class setup request handler, the request goes to the
+  *         function of the interface or endpoint it addresses, requests to
+  *         the device go to the first function
+  * @param  udev: to the structure of usbd_core_type
+  * @param  setup: setup packet
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_setup_handler(void *udev, usb_setup_type *setup)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t func = USBD_COMPOSITE_NONE, index = LBYTE(setup->wIndex);
+
+  switch(setup->bmRequestType & USB_REQ_RECIPIENT_MASK)
+  {
+    case USB_REQ_RECIPIENT_INTERFACE:
+      if(index < USBD_COMPOSITE_INTERFACE_MAX)
+      {
+        func = pcomp->intf_owner[index];
+      }
+      break;
+    case USB_REQ_RECIPIENT_ENDPOINT:
+      if((index & 0x7F) < USB_EPT_MAX_NUM)
+      {
+        func = (index & 0x80) ? pcomp->in_owner[index & 0x7F] : pcomp->out_owner[index & 0x7F];
+      }
+      break;
+    case USB_REQ_RECIPIENT_DEVICE:
+      if(pcomp->function_count != 0)
+      {
+        func = 0;
+      }
+      break;
+    default:
+      break;
+  }
+
+  pcomp->ctrl_function = func;
+  if(func == USBD_COMPOSITE_NONE)
+  {
+    usbd_ctrl_unsupport(pudev);
+    return USB_FAIL;
+  }
+
+  return pcomp->function[func].class_handler->setup_handler(udev, setup);
+}
+
+/**
+  * @brief  usb device endpoint 0 in status stage complete
+  * @param  udev: to the structure of usbd_core_type
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_ept0_tx_handler(void *udev)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+
+  if(pcomp->ctrl_function == USBD_COMPOSITE_NONE ||
+     pcomp->function[pcomp->ctrl_function].class_handler->ept0_tx_handler == NULL)
+  {
+    return USB_OK;
+  }
+  return pcomp->function[pcomp->ctrl_function].class_handler->ept0_tx_handler(udev);
+}
+
+/**
+  * @brief  usb device endpoint 0 out status stage complete
+  * @param  udev: usb device core handler type
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_ept0_rx_handler(void *udev)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+
+  if(pcomp->ctrl_function == USBD_COMPOSITE_NONE ||
+     pcomp->function[pcomp->ctrl_function].class_handler->ept0_rx_handler == NULL)
+  {
+    return USB_OK;
+  }
+  return pcomp->function[pcomp->ctrl_function].class_handler->ept0_rx_handler(udev);
+}
+
+/**
+  * @brief  usb device transmision complete handler
+  * @param  udev: to the structure of usbd_core_type
+  * @param  ept_num: endpoint number
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t func = pcomp->in_owner[ept_num & 0x7F];
+
+  if(func == USBD_COMPOSITE_NONE)
+  {
+    return USB_OK;
+  }
+  return pcomp->function[func].class_handler->in_handler(udev, ept_num);
+}
+
+/**
+  * @brief  usb device endpoint receive data
+  * @param  udev: to the structure of usbd_core_type
+  * @param  ept_num: endpoint number
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_out_handler(void *udev, uint8_t ept_num)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t func = pcomp->out_owner[ept_num & 0x7F];
+
+  if(func == USBD_COMPOSITE_NONE)
+  {
+    return USB_OK;
+  }
+  return pcomp->function[func].class_handler->out_handler(udev, ept_num);
+}
+
+/**
+  * @brief  usb device sof handler
+  * @param  udev: to the structure of usbd_core_type
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_sof_handler(void *udev)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t index;
+
+  for(index = 0; index < pcomp->function_count; index ++)
+  {
+    if(pcomp->function[index].class_handler->sof_handler != NULL)
+    {
+      pcomp->function[index].class_handler->sof_handler(udev);
+    }
+  }
+
+  return USB_OK;
+}
+
+/**
+  * @brief  usb device event handler
+  * @param  udev: to the structure of usbd_core_type
+  * @param  event: usb device event
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  uint8_t index;
+
+  for(index = 0; index < pcomp->function_count; index ++)
+  {
+    if(pcomp->function[index].class_handler->event_handler != NULL)
+    {
+      pcomp->function[index].class_handler->event_handler(udev, event);
+    }
+  }
+
+  return USB_OK;
+}
+
+/**
+  * @brief  size the fifos from the declared bandwidth. every endpoint gets one
+  *         packet, the rest is handed out a packet at a time to the endpoint
+  *         with the most bandwidth per packet it can buffer, up to a frame of
+  *         data. out endpoints share the receive fifo, which gets what is left.
+  * @param  pcomp: to the structure of composite_struct_type
+  * @retval error status, ERROR when one packet per endpoint does not fit
+  */
+static error_status composite_fifo_plan(composite_struct_type *pcomp)
+{
+  usbd_fifo_plan_type *plan = &pcomp->fifo_plan;
+  uint32_t unit[USB_EPT_MAX_NUM], demand[USB_EPT_MAX_NUM], packets[USB_EPT_MAX_NUM];
+  uint32_t bandwidth[USB_EPT_MAX_NUM], cost[USB_EPT_MAX_NUM];
+  uint32_t used, max_out = USB_MAX_EP0_SIZE, out_count = 1;
+  uint8_t index, best;
+
+  /* index 0 stands for the receive fifo, endpoint 0 in keeps one packet */
+  demand[0] = 0;
+  bandwidth[0] = 0;
+  for(index = 1; index < USB_EPT_MAX_NUM; index ++)
+  {
+    if(pcomp->out_owner[index] != USBD_COMPOSITE_NONE)
+    {
+      out_count ++;
+      max_out = MAX(max_out, pcomp->out_maxpacket[index]);
+      bandwidth[0] += pcomp->out_bandwidth[index];
+      demand[0] += (pcomp->out_bandwidth[index] + pcomp->out_maxpacket[index] - 1) / pcomp->out_maxpacket[index];
+    }
+  }
+  unit[0] = max_out / 4 + 1;
+  demand[0] = MAX(1, demand[0]);
+  packets[0] = 1;
+
+  /* setup packets, one out packet with its status word, the out endpoints and
+     global nak, as the controller needs at least */
+  plan->rx_size = (5 + 8) + unit[0] + 2 * out_count + 1;
+  plan->tx_size[0] = MAX(16, USB_MAX_EP0_SIZE / 4);
+  used = plan->rx_size + plan->tx_size[0];
+
+  for(index = 1; index < USB_EPT_MAX_NUM; index ++)
+  {
+    plan->tx_size[index] = 0;
+    unit[index] = (pcomp->in_maxpacket[index] + 3) / 4;
+    packets[index] = 1;
+    bandwidth[index] = pcomp->in_bandwidth[index];
+    demand[index] = 0;
+    if(pcomp->in_owner[index] != USBD_COMPOSITE_NONE)
+    {
+      /* tx fifo depth is at least 16 words */
+      plan->tx_size[index] = MAX(16, unit[index]);
+      demand[index] = MAX(1, (bandwidth[index] + pcomp->in_maxpacket[index] - 1) / pcomp->in_maxpacket[index]);
+      used += plan->tx_size[index];
+    }
+  }
+
+  if(used > OTG_FIFO_SIZE)
+  {
+    return ERROR;
+  }
+
+  while(1)
+  {
+    best = USBD_COMPOSITE_NONE;
+    for(index = 0; index < USB_EPT_MAX_NUM; index ++)
+    {
+      /* words one more packet costs, small packets may fit in the minimum */
+      cost[index] = (index == 0) ? unit[0] : MAX(16, (packets[index] + 1) * unit[index]) - plan->tx_size[index];
+      if(packets[index] >= demand[index] || used + cost[index] > OTG_FIFO_SIZE)
+      {
+        continue;
+      }
+      if(best == USBD_COMPOSITE_NONE ||
+         bandwidth[index] * packets[best] > bandwidth[best] * packets[index])
+      {
+        best = index;
+      }
+    }
+    if(best == USBD_COMPOSITE_NONE)
+    {
+      break;
+    }
+
+    packets[best] ++;
+    used += cost[best];
+    if(best == 0)
+    {
+      plan->rx_size += cost[best];
+    }
+    else
+    {
+      plan->tx_size[best] += cost[best];
+    }
+  }
+
+  /* spare words buffer more out packets */
+  plan->rx_size += OTG_FIFO_SIZE - used;
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  add a class driver as a function of the composite device, before
+  *         usb_composite_build
+  * @param  class_handler: class driver
+  * @param  desc_handler: class descriptors, its configuration descriptor is the
+  *         template of the function
+  * @param  ept: endpoints of the class, by their address in the template
+  * @param  ept_count: number of endpoints
+  * @retval error status
+  */
+error_status usb_composite_add_function(usbd_class_handler *class_handler, usbd_desc_handler *desc_handler,
+                                        composite_ept_type *ept, uint8_t ept_count)
+{
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+  composite_function_type *pfunc;
+
+  if(pcomp->function_count == USBD_COMPOSITE_FUNCTION_MAX)
+  {
+    return ERROR;
+  }
+
+  pfunc = &pcomp->function[pcomp->function_count ++];
+  pfunc->class_handler = class_handler;
+  pfunc->desc_handler = desc_handler;
+  pfunc->ept = ept;
+  pfunc->ept_count = ept_count;
+  pfunc->first_intf = 0;
+  pfunc->intf_count = 0;
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  assemble the descriptors, assign interfaces and endpoints and plan
+  *         the fifos, before usbd_init with composite_class_handler and
+  *         composite_desc_handler
+  * @param  udev: to the structure of usbd_core_type
+  * @retval error status, ERROR when the functions do not fit or an endpoint
+  *         has a zero max packet
+  */
+error_status usb_composite_build(void *udev)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  composite_struct_type *pcomp = (composite_struct_type *)composite_class_handler.pdata;
+
+  if(composite_desc_build(pcomp) != SUCCESS || composite_fifo_plan(pcomp) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  pudev->fifo_plan = &pcomp->fifo_plan;
+  return SUCCESS;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
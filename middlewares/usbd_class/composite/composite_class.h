@@ -0,0 +1,149 @@
+/**
+  **************************************************************************
+  * @file     composite_class.h
+  * @brief    usb composite device class header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+ /* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __COMPOSITE_CLASS_H
+#define __COMPOSITE_CLASS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "usb_std.h"
+#include "usbd_core.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @addtogroup USB_composite_class
+  * @{
+  */
+
+/** @defgroup USB_composite_class_definition
+  * @{
+  */
+
+/**
+  * @brief a composite device is assembled at init from class drivers that are
+  *        added as functions. the configuration descriptor of each class is the
+  *        template of its function: interfaces are renumbered, endpoints are
+  *        numbered from 1 in the order they are declared, in and out apart,
+  *        and an interface association is added to functions with several
+  *        interfaces. a class can be a function when it finds its data through
+  *        its own class handler and keeps its endpoint addresses in variables
+  *        (cdc, msc and keyboard).
+  */
+#ifndef USBD_COMPOSITE_FUNCTION_MAX
+#define USBD_COMPOSITE_FUNCTION_MAX            4
+#endif
+#ifndef USBD_COMPOSITE_INTERFACE_MAX
+#define USBD_COMPOSITE_INTERFACE_MAX           8
+#endif
+
+/**
+  * @brief no function owns the interface or endpoint
+  */
+#define USBD_COMPOSITE_NONE                    0xFF
+
+/**
+  * @}
+  */
+
+/** @defgroup USB_composite_class_exported_types
+  * @{
+  */
+
+/**
+  * @brief endpoint of a function
+  */
+typedef struct
+{
+  uint8_t                                desc_addr;               /*!< address in the class descriptor */
+  uint8_t                                *addr;                   /*!< class address, set by the build */
+  uint16_t                               bandwidth;               /*!< expected bytes per frame        */
+}composite_ept_type;
+
+/**
+  * @brief function of the composite device
+  */
+typedef struct
+{
+  usbd_class_handler                     *class_handler;          /*!< class driver                    */
+  usbd_desc_handler                      *desc_handler;           /*!< class descriptors, the template */
+  composite_ept_type                     *ept;                    /*!< endpoints of the class          */
+  uint8_t                                ept_count;               /*!< number of endpoints             */
+  uint8_t                                first_intf;              /*!< first interface number          */
+  uint8_t                                intf_count;              /*!< number of interfaces            */
+}composite_function_type;
+
+/**
+  * @brief usb composite class struct
+  */
+typedef struct
+{
+  composite_function_type                function[USBD_COMPOSITE_FUNCTION_MAX];
+  uint8_t                                function_count;
+  uint8_t                                intf_count;
+  uint8_t                                intf_owner[USBD_COMPOSITE_INTERFACE_MAX];  /*!< function of an interface */
+  uint8_t                                in_owner[USB_EPT_MAX_NUM];                 /*!< function of an in endpoint  */
+  uint8_t                                out_owner[USB_EPT_MAX_NUM];                /*!< function of an out endpoint */
+  uint16_t                               in_maxpacket[USB_EPT_MAX_NUM];
+  uint16_t                               out_maxpacket[USB_EPT_MAX_NUM];
+  uint16_t                               in_bandwidth[USB_EPT_MAX_NUM];
+  uint16_t                               out_bandwidth[USB_EPT_MAX_NUM];
+  uint8_t                                ctrl_function;           /*!< function of the control transfer */
+  usbd_fifo_plan_type                    fifo_plan;
+}composite_struct_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup USB_composite_class_exported_functions
+  * @{
+  */
+extern usbd_class_handler composite_class_handler;
+extern composite_struct_type composite_struct;
+error_status usb_composite_add_function(usbd_class_handler *class_handler, usbd_desc_handler *desc_handler,
+                                        composite_ept_type *ept, uint8_t ept_count);
+error_status usb_composite_build(void *udev);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,630 @@
+/**
+  **************************************************************************
+  * @file     composite_desc.c
+  * @brief    usb composite device descriptor
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+#include "stdio.h"
+#include "usb_std.h"
+#include "usbd_sdr.h"
+#include "usbd_core.h"
+#include "composite_desc.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @defgroup USB_composite_desc
+  * @brief usb device composite descriptor
+  * @{
+  */
+
+/** @defgroup USB_composite_desc_private_functions
+  * @{
+  */
+
+static usbd_desc_t *get_device_descriptor(void);
+static usbd_desc_t *get_device_qualifier(void);
+static usbd_desc_t *get_device_configuration(void);
+static usbd_desc_t *get_device_other_speed(void);
+static usbd_desc_t *get_device_lang_id(void);
+static usbd_desc_t *get_device_manufacturer_string(void);
+static usbd_desc_t *get_device_product_string(void);
+static usbd_desc_t *get_device_serial_string(void);
+static usbd_desc_t *get_device_interface_string(void);
+static usbd_desc_t *get_device_config_string(void);
+
+static uint16_t usbd_unicode_convert(uint8_t *string, uint8_t *unicode_buf);
+static void usbd_int_to_unicode (uint32_t value , uint8_t *pbuf , uint8_t len);
+static void get_serial_num(void);
+static const uint8_t *composite_find_ept(const uint8_t *desc, uint16_t len, uint8_t ept_addr);
+static void composite_patch_intf(uint8_t *desc, uint8_t intf_class, uint8_t first_intf);
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD static uint8_t g_usbd_desc_buffer[256] ALIGNED_TAIL;
+
+/**
+  * @brief device descriptor handler structure
+  */
+usbd_desc_handler composite_desc_handler =
+{
+  get_device_descriptor,
+  get_device_qualifier,
+  get_device_configuration,
+  get_device_other_speed,
+  get_device_lang_id,
+  get_device_manufacturer_string,
+  get_device_product_string,
+  get_device_serial_string,
+  get_device_interface_string,
+  get_device_config_string,
+};
+
+
+/**
+  * @brief usb device standard descriptor, the class fields are set by the build
+  */
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD static uint8_t g_usbd_descriptor[USB_DEVICE_DESC_LEN] ALIGNED_TAIL =
+{
+  USB_DEVICE_DESC_LEN,                   /* bLength */
+  USB_DESCIPTOR_TYPE_DEVICE,             /* bDescriptorType */
+  0x00,                                  /* bcdUSB */
+  0x02,
+  0x00,                                  /* bDeviceClass */
+  0x00,                                  /* bDeviceSubClass */
+  0x00,                                  /* bDeviceProtocol */
+  USB_MAX_EP0_SIZE,                      /* bMaxPacketSize */
+  LBYTE(USBD_COMPOSITE_VENDOR_ID),       /* idVendor */
+  HBYTE(USBD_COMPOSITE_VENDOR_ID),       /* idVendor */
+  LBYTE(USBD_COMPOSITE_PRODUCT_ID),      /* idProduct */
+  HBYTE(USBD_COMPOSITE_PRODUCT_ID),      /* idProduct */
+  0x00,                                  /* bcdDevice rel. 2.00 */
+  0x02,
+  USB_MFC_STRING,                        /* Index of manufacturer string */
+  USB_PRODUCT_STRING,                    /* Index of product string */
+  USB_SERIAL_STRING,                     /* Index of serial number string */
+  1                                      /* bNumConfigurations */
+};
+
+/**
+  * @brief usb configuration standard descriptor, assembled by the build from
+  *        the configuration descriptors of the functions
+  */
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD static uint8_t g_usbd_configuration[USBD_COMPOSITE_CONFIG_DESC_MAXSIZE] ALIGNED_TAIL;
+
+/**
+  * @brief usb string lang id
+  */
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD static uint8_t g_string_lang_id[USBD_COMPOSITE_SIZ_STRING_LANGID] ALIGNED_TAIL =
+{
+  USBD_COMPOSITE_SIZ_STRING_LANGID,
+  USB_DESCIPTOR_TYPE_STRING,
+  0x09,
+  0x04,
+};
+
+/**
+  * @brief usb string serial
+  */
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD static uint8_t g_string_serial[USBD_COMPOSITE_SIZ_STRING_SERIAL] ALIGNED_TAIL =
+{
+  USBD_COMPOSITE_SIZ_STRING_SERIAL,
+  USB_DESCIPTOR_TYPE_STRING,
+};
+
+
+/* device descriptor */
+static usbd_desc_t device_descriptor =
+{
+  USB_DEVICE_DESC_LEN,
+  g_usbd_descriptor
+};
+
+/* config descriptor */
+static usbd_desc_t config_descriptor =
+{
+  USB_DEVICE_CFG_DESC_LEN,
+  g_usbd_configuration
+};
+
+/* langid descriptor */
+static usbd_desc_t langid_descriptor =
+{
+  USBD_COMPOSITE_SIZ_STRING_LANGID,
+  g_string_lang_id
+};
+
+/* serial descriptor */
+static usbd_desc_t serial_descriptor =
+{
+  USBD_COMPOSITE_SIZ_STRING_SERIAL,
+  g_string_serial
+};
+
+static usbd_desc_t vp_desc;
+
+/**
+  * @brief  standard usb unicode convert
+  * @param  string: source string
+  * @param  unicode_buf: unicode buffer
+  * @retval length
+  */
+static uint16_t usbd_unicode_convert(uint8_t *string, uint8_t *unicode_buf)
+{
+  uint16_t str_len = 0, id_pos = 2;
+  uint8_t *tmp_str = string;
+
+  while(*tmp_str != '\0')
+  {
+    str_len ++;
+    unicode_buf[id_pos ++] = *tmp_str ++;
+    unicode_buf[id_pos ++] = 0x00;
+  }
+
+  str_len = str_len * 2 + 2;
+  unicode_buf[0] = (uint8_t)str_len;
+  unicode_buf[1] = USB_DESCIPTOR_TYPE_STRING;
+
+  return str_len;
+}
+
+/**
+  * @brief  usb int convert to unicode
+  * @param  value: int value
+  * @param  pbus: unicode buffer
+  * @param  len: length
+  * @retval none
+  */
+static void usbd_int_to_unicode (uint32_t value , uint8_t *pbuf , uint8_t len)
+{
+  uint8_t idx = 0;
+
+  for( idx = 0 ; idx < len ; idx ++)
+  {
+    if( ((value >> 28)) < 0xA )
+    {
+      pbuf[ 2 * idx] = (value >> 28) + '0';
+  }
+  else
+  {
+      pbuf[2 * idx] = (value >> 28) + 'A' - 10;
+    }
+
+    value = value << 4;
+
+    pbuf[2 * idx + 1] = 0;
+  }
+}
+
+/**
+  * @brief  usb get serial number
+  * @param  none
+  * @retval none
+  */
+static void get_serial_num(void)
+{
+  uint32_t serial0, serial1, serial2;
+
+  serial0 = *(uint32_t*)MCU_ID1;
+  serial1 = *(uint32_t*)MCU_ID2;
+  serial2 = *(uint32_t*)MCU_ID3;
+
+  serial0 += serial2;
+
+  if (serial0 != 0)
+  {
+    usbd_int_to_unicode (serial0, &g_string_serial[2] ,8);
+    usbd_int_to_unicode (serial1, &g_string_serial[18] ,4);
+  }
+}
+
+/**
+  * @brief  get device descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_descriptor(void)
+{
+  return &device_descriptor;
+}
+
+/**
+  * @brief  get device qualifier
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t * get_device_qualifier(void)
+{
+  return NULL;
+}
+
+/**
+  * @brief  get config descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_configuration(void)
+{
+  return &config_descriptor;
+}
+
+/**
+  * @brief  get other speed descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_other_speed(void)
+{
+  return NULL;
+}
+
+/**
+  * @brief  get lang id descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_lang_id(void)
+{
+  return &langid_descriptor;
+}
+
+
+/**
+  * @brief  get manufacturer descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_manufacturer_string(void)
+{
+  vp_desc.length = usbd_unicode_convert((uint8_t *)USBD_COMPOSITE_DESC_MANUFACTURER_STRING, g_usbd_desc_buffer);
+  vp_desc.descriptor = g_usbd_desc_buffer;
+  return &vp_desc;
+}
+
+/**
+  * @brief  get product descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_product_string(void)
+{
+  vp_desc.length = usbd_unicode_convert((uint8_t *)USBD_COMPOSITE_DESC_PRODUCT_STRING, g_usbd_desc_buffer);
+  vp_desc.descriptor = g_usbd_desc_buffer;
+  return &vp_desc;
+}
+
+/**
+  * @brief  get serial descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_serial_string(void)
+{
+  get_serial_num();
+  return &serial_descriptor;
+}
+
+/**
+  * @brief  get interface descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_interface_string(void)
+{
+  vp_desc.length = usbd_unicode_convert((uint8_t *)USBD_COMPOSITE_DESC_INTERFACE_STRING, g_usbd_desc_buffer);
+  vp_desc.descriptor = g_usbd_desc_buffer;
+  return &vp_desc;
+}
+
+/**
+  * @brief  get device config descriptor
+  * @param  none
+  * @retval usbd_desc
+  */
+static usbd_desc_t *get_device_config_string(void)
+{
+  vp_desc.length = usbd_unicode_convert((uint8_t *)USBD_COMPOSITE_DESC_CONFIGURATION_STRING, g_usbd_desc_buffer);
+  vp_desc.descriptor = g_usbd_desc_buffer;
+  return &vp_desc;
+}
+
+/**
+  * @brief  find an endpoint descriptor in a configuration descriptor
+  * @param  desc: configuration descriptor
+  * @param  len: descriptor length
+  * @param  ept_addr: endpoint address
+  * @retval endpoint descriptor, NULL if not found
+  */
+static const uint8_t *composite_find_ept(const uint8_t *desc, uint16_t len, uint8_t ept_addr)
+{
+  uint16_t pos;
+
+  for(pos = 0; pos + 2 <= len && desc[pos] >= 2; pos += desc[pos])
+  {
+    if(desc[pos + 1] == USB_DESCIPTOR_TYPE_ENDPOINT && desc[pos] >= 7 && desc[pos + 2] == ept_addr)
+    {
+      return &desc[pos];
+    }
+  }
+  return NULL;
+}
+
+/**
+  * @brief  move the interface numbers inside a class specific interface
+  *         descriptor to the interfaces of the function
+  * @param  desc: class specific interface descriptor
+  * @param  intf_class: class of the interface the descriptor belongs to
+  * @param  first_intf: first interface of the function
+  * @retval none
+  */
+static void composite_patch_intf(uint8_t *desc, uint8_t intf_class, uint8_t first_intf)
+{
+  uint8_t index, start = 0;
+
+  if(intf_class == USB_CLASS_CODE_CDC)
+  {
+    /* call management: data interface, union: control and data interfaces */
+    if(desc[2] == 0x01 && desc[0] >= 5)
+    {
+      desc[4] += first_intf;
+    }
+    else if(desc[2] == 0x06)
+    {
+      start = 3;
+    }
+  }
+  else if(intf_class == USB_CLASS_CODE_AUDIO && desc[2] == 0x01)
+  {
+    /* audio control header: streaming interfaces of the collection */
+    start = 8;
+  }
+
+  if(start != 0)
+  {
+    for(index = start; index < desc[0]; index ++)
+    {
+      desc[index] += first_intf;
+    }
+  }
+}
+
+/**
+  * @brief  assemble the device and configuration descriptors of the composite
+  *         device and assign interfaces and endpoints to the functions
+  * @param  pcomp: to the structure of composite_struct_type
+  * @retval error status, ERROR when the functions do not fit
+  */
+error_status composite_desc_build(composite_struct_type *pcomp)
+{
+  composite_function_type *pfunc;
+  usbd_desc_t *pdesc;
+  const uint8_t *tmpl, *pept, *pintf;
+  uint8_t *cfg = g_usbd_configuration;
+  uint16_t pos = USB_DEVICE_CFG_DESC_LEN, tpos, tlen, len;
+  uint8_t func, index, num, next_in = 1, next_out = 1;
+  uint8_t intf_class = 0, has_iad, iad = 0;
+
+  pcomp->intf_count = 0;
+  for(index = 0; index < USBD_COMPOSITE_INTERFACE_MAX; index ++)
+  {
+    pcomp->intf_owner[index] = USBD_COMPOSITE_NONE;
+  }
+  for(index = 0; index < USB_EPT_MAX_NUM; index ++)
+  {
+    pcomp->in_owner[index] = USBD_COMPOSITE_NONE;
+    pcomp->out_owner[index] = USBD_COMPOSITE_NONE;
+    pcomp->in_maxpacket[index] = 0;
+    pcomp->out_maxpacket[index] = 0;
+    pcomp->in_bandwidth[index] = 0;
+    pcomp->out_bandwidth[index] = 0;
+  }
+
+  for(func = 0; func < pcomp->function_count; func ++)
+  {
+    pfunc = &pcomp->function[func];
+    pdesc = pfunc->desc_handler->get_device_configuration();
+    tmpl = pdesc->descriptor;
+    tlen = MIN(pdesc->length, tmpl[2] | (tmpl[3] << 8));
+    if(tlen < USB_DEVICE_CFG_DESC_LEN)
+    {
+      return ERROR;
+    }
+
+    if(func == 0)
+    {
+      /* attributes and power of the first function */
+      cfg[7] = tmpl[7];
+      cfg[8] = tmpl[8];
+    }
+
+    pfunc->first_intf = pcomp->intf_count;
+    pfunc->intf_count = tmpl[4];
+    if(pfunc->intf_count == 0 || pcomp->intf_count + pfunc->intf_count > USBD_COMPOSITE_INTERFACE_MAX)
+    {
+      return ERROR;
+    }
+    for(index = 0; index < pfunc->intf_count; index ++)
+    {
+      pcomp->intf_owner[pfunc->first_intf + index] = func;
+    }
+    pcomp->intf_count += pfunc->intf_count;
+
+    /* endpoints are numbered from 1 in the order they are declared */
+    for(index = 0; index < pfunc->ept_count; index ++)
+    {
+      pept = composite_find_ept(tmpl, tlen, pfunc->ept[index].desc_addr);
+      if(pept == NULL || ((pept[4] | (pept[5] << 8)) & 0x7FF) == 0)
+      {
+        /* a zero max packet cannot be given a fifo */
+        return ERROR;
+      }
+      if(pfunc->ept[index].desc_addr & 0x80)
+      {
+        num = next_in ++;
+        if(num >= USB_EPT_MAX_NUM)
+        {
+          return ERROR;
+        }
+        pcomp->in_owner[num] = func;
+        pcomp->in_maxpacket[num] = (pept[4] | (pept[5] << 8)) & 0x7FF;
+        pcomp->in_bandwidth[num] = pfunc->ept[index].bandwidth;
+        *pfunc->ept[index].addr = num | 0x80;
+      }
+      else
+      {
+        num = next_out ++;
+        if(num >= USB_EPT_MAX_NUM)
+        {
+          return ERROR;
+        }
+        pcomp->out_owner[num] = func;
+        pcomp->out_maxpacket[num] = (pept[4] | (pept[5] << 8)) & 0x7FF;
+        pcomp->out_bandwidth[num] = pfunc->ept[index].bandwidth;
+        *pfunc->ept[index].addr = num;
+      }
+    }
+
+    /* first interface and interface association of the class descriptor */
+    pintf = NULL;
+    has_iad = 0;
+    for(tpos = USB_DEVICE_CFG_DESC_LEN; tpos + 2 <= tlen && tmpl[tpos] >= 2; tpos += tmpl[tpos])
+    {
+      if(tmpl[tpos + 1] == USB_INTERFACE_ASSOCIATION_TYPE)
+      {
+        has_iad = 1;
+      }
+      else if(tmpl[tpos + 1] == USB_DESCIPTOR_TYPE_INTERFACE && pintf == NULL)
+      {
+        pintf = &tmpl[tpos];
+      }
+    }
+    if(pintf == NULL)
+    {
+      return ERROR;
+    }
+
+    /* a function with several interfaces is announced by an association */
+    if(pfunc->intf_count > 1 && has_iad == 0)
+    {
+      if(pos + USB_IAD_DESC_LEN > USBD_COMPOSITE_CONFIG_DESC_MAXSIZE)
+      {
+        return ERROR;
+      }
+      cfg[pos ++] = USB_IAD_DESC_LEN;               /* bLength */
+      cfg[pos ++] = USB_INTERFACE_ASSOCIATION_TYPE; /* bDescriptorType */
+      cfg[pos ++] = pfunc->first_intf;              /* bFirstInterface */
+      cfg[pos ++] = pfunc->intf_count;              /* bInterfaceCount */
+      cfg[pos ++] = pintf[5];                       /* bFunctionClass */
+      cfg[pos ++] = pintf[6];                       /* bFunctionSubClass */
+      cfg[pos ++] = pintf[7];                       /* bFunctionProtocol */
+      cfg[pos ++] = 0x00;                           /* iFunction */
+      has_iad = 1;
+    }
+    iad |= has_iad;
+
+    /* copy the interfaces, renumbered */
+    for(tpos = USB_DEVICE_CFG_DESC_LEN; tpos + 2 <= tlen && tmpl[tpos] >= 2; tpos += len)
+    {
+      len = tmpl[tpos];
+      if(tpos + len > tlen || pos + len > USBD_COMPOSITE_CONFIG_DESC_MAXSIZE)
+      {
+        return ERROR;
+      }
+      for(index = 0; index < len; index ++)
+      {
+        cfg[pos + index] = tmpl[tpos + index];
+      }
+
+      switch(cfg[pos + 1])
+      {
+        case USB_DESCIPTOR_TYPE_INTERFACE:
+          cfg[pos + 2] += pfunc->first_intf;
+          intf_class = cfg[pos + 5];
+          break;
+        case USB_INTERFACE_ASSOCIATION_TYPE:
+          cfg[pos + 2] += pfunc->first_intf;
+          break;
+        case USB_CS_INTERFACE_TYPE:
+          composite_patch_intf(&cfg[pos], intf_class, pfunc->first_intf);
+          break;
+        case USB_DESCIPTOR_TYPE_ENDPOINT:
+          for(index = 0; index < pfunc->ept_count; index ++)
+          {
+            if(pfunc->ept[index].desc_addr == tmpl[tpos + 2])
+            {
+              cfg[pos + 2] = *pfunc->ept[index].addr;
+              break;
+            }
+          }
+          if(index == pfunc->ept_count)
+          {
+            /* the function did not declare this endpoint */
+            return ERROR;
+          }
+          break;
+        default:
+          break;
+      }
+      pos += len;
+    }
+  }
+
+  cfg[0] = USB_DEVICE_CFG_DESC_LEN;              /* bLength: configuration descriptor size */
+  cfg[1] = USB_DESCIPTOR_TYPE_CONFIGURATION;     /* bDescriptorType: configuration */
+  cfg[2] = LBYTE(pos);                           /* wTotalLength: bytes returned */
+  cfg[3] = HBYTE(pos);
+  cfg[4] = pcomp->intf_count;                    /* bNumInterfaces */
+  cfg[5] = 0x01;                                 /* bConfigurationValue: configuration value */
+  cfg[6] = 0x00;                                 /* iConfiguration */
+  config_descriptor.length = pos;
+
+  /* miscellaneous device class with interface associations */
+  g_usbd_descriptor[4] = iad ? 0xEF : 0x00;
+  g_usbd_descriptor[5] = iad ? 0x02 : 0x00;
+  g_usbd_descriptor[6] = iad ? 0x01 : 0x00;
+
+  return SUCCESS;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
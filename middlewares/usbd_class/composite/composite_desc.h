@@ -0,0 +1,110 @@
+/**
+  **************************************************************************
+  * @file     composite_desc.h
+  * @brief    usb composite device descriptor header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __COMPOSITE_DESC_H
+#define __COMPOSITE_DESC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "composite_class.h"
+#include "usbd_core.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @addtogroup USB_composite_desc
+  * @{
+  */
+
+/** @defgroup USB_composite_desc_definition
+  * @{
+  */
+
+/**
+  * @brief usb vendor id and product id define, a product id stands for one set
+  *        of functions on the host, change it with the functions
+  */
+#ifndef USBD_COMPOSITE_VENDOR_ID
+#define USBD_COMPOSITE_VENDOR_ID             0x2E3C
+#endif
+#ifndef USBD_COMPOSITE_PRODUCT_ID
+#define USBD_COMPOSITE_PRODUCT_ID            0x5760
+#endif
+
+/**
+  * @brief usb descriptor size define
+  */
+#ifndef USBD_COMPOSITE_CONFIG_DESC_MAXSIZE
+#define USBD_COMPOSITE_CONFIG_DESC_MAXSIZE   256
+#endif
+#define USBD_COMPOSITE_SIZ_STRING_LANGID     4
+#define USBD_COMPOSITE_SIZ_STRING_SERIAL     0x1A
+
+/**
+  * @brief usb string define(vendor, product configuration, interface)
+  */
+#ifndef USBD_COMPOSITE_DESC_PRODUCT_STRING
+#define USBD_COMPOSITE_DESC_PRODUCT_STRING         "AT32 Composite Device"
+#endif
+#define USBD_COMPOSITE_DESC_MANUFACTURER_STRING    "Artery"
+#define USBD_COMPOSITE_DESC_CONFIGURATION_STRING   "Composite Config"
+#define USBD_COMPOSITE_DESC_INTERFACE_STRING       "Composite Interface"
+
+/**
+  * @brief usb descriptor type and subtype used by the build
+  */
+#define USB_INTERFACE_ASSOCIATION_TYPE       0x0B
+#define USB_CS_INTERFACE_TYPE                0x24
+#define USB_IAD_DESC_LEN                     0x08
+
+/**
+  * @brief usb mcu id address deine
+  */
+#define         MCU_ID1                   (0x1FFFF7E8)
+#define         MCU_ID2                   (0x1FFFF7EC)
+#define         MCU_ID3                   (0x1FFFF7F0)
+/**
+  * @}
+  */
+
+extern usbd_desc_handler composite_desc_handler;
+error_status composite_desc_build(composite_struct_type *pcomp);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,343 @@
+/**
+  **************************************************************************
+  * @file     composite_host_test.c
+  * @brief    host test of the composite descriptors and fifo plan
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * builds composite devices from the cdc, msc and keyboard descriptor
+ * templates with stand-in class drivers and checks what usb_composite_build
+ * hands to the core.
+ * - configuration descriptor: the lengths add up to wTotalLength, interfaces
+ *   are numbered 0..bNumInterfaces-1 once each, endpoint addresses are unique
+ *   and below USB_EPT_MAX_NUM, a function with several interfaces has an
+ *   interface association that covers them, and the cdc union and call
+ *   management descriptors name the interfaces of their own function.
+ * - endpoint numbers written back to the classes match the descriptor.
+ * - fifo plan: rx and tx sizes add up to OTG_FIFO_SIZE words at most, the
+ *   receive fifo keeps the controller minimum, every in endpoint in use
+ *   holds one max packet and at least 16 words, unused ones get none. a
+ *   function set that needs more endpoints than USB_EPT_MAX_NUM fails.
+ * - class requests, endpoint requests and transfer events reach the function
+ *   that owns the interface or endpoint.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "composite_class.h"
+#include "composite_desc.h"
+
+#define DESC_TYPE_INTERFACE              0x04
+#define DESC_TYPE_ENDPOINT               0x05
+#define DESC_TYPE_IAD                    0x0B
+#define DESC_TYPE_CS_INTERFACE           0x24
+#define CDC_SUBTYPE_CALL_MGMT            0x01
+#define CDC_SUBTYPE_UNION                0x06
+
+extern usbd_desc_handler cdc_desc_handler, msc_desc_handler, keyboard_desc_handler;
+
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+void usbd_ctrl_unsupport(usbd_core_type *udev)
+{
+}
+
+/* stand-in class drivers that count the calls they get */
+typedef struct
+{
+  uint32_t init;
+  uint32_t clear;
+  uint32_t setup;
+  uint32_t ept0_rx;
+  uint8_t in_ept;
+  uint8_t out_ept;
+} function_calls_type;
+
+static function_calls_type calls[3];
+
+#define FUNCTION_HANDLER(n) \
+static usb_sts_type init_##n(void *udev) { calls[n].init++; return USB_OK; } \
+static usb_sts_type clear_##n(void *udev) { calls[n].clear++; return USB_OK; } \
+static usb_sts_type setup_##n(void *udev, usb_setup_type *setup) { calls[n].setup++; return USB_OK; } \
+static usb_sts_type ept0_tx_##n(void *udev) { return USB_OK; } \
+static usb_sts_type ept0_rx_##n(void *udev) { calls[n].ept0_rx++; return USB_OK; } \
+static usb_sts_type in_##n(void *udev, uint8_t ept_num) { calls[n].in_ept = ept_num | 0x80; return USB_OK; } \
+static usb_sts_type out_##n(void *udev, uint8_t ept_num) { calls[n].out_ept = ept_num; return USB_OK; } \
+static usbd_class_handler handler_##n = {init_##n, clear_##n, setup_##n, ept0_tx_##n, ept0_rx_##n, in_##n, out_##n, NULL, NULL, NULL};
+
+FUNCTION_HANDLER(0)
+FUNCTION_HANDLER(1)
+FUNCTION_HANDLER(2)
+
+static uint8_t cdc_int, cdc_in, cdc_out, msc_in, msc_out, keyboard_in;
+
+static void composite_reset(void)
+{
+  memset(&composite_struct, 0, sizeof(composite_struct));
+  memset(calls, 0, sizeof(calls));
+}
+
+/* walk the configuration descriptor, returns the number of functions with
+   an interface association */
+static uint32_t config_check(const char *name)
+{
+  usbd_desc_t *config = composite_desc_handler.get_device_configuration();
+  uint8_t *desc = config->descriptor, intf_seen[USBD_COMPOSITE_INTERFACE_MAX] = {0};
+  uint8_t ept_seen[2][USB_EPT_MAX_NUM] = {{0}}, iad_first = 0, iad_count = 0, intf = 0;
+  uint32_t pos, intf_count = 0, iad_total = 0, index, ept;
+
+  CHECK((desc[2] | desc[3] << 8) == config->length);
+  for(pos = desc[0]; pos < config->length; pos += desc[pos])
+  {
+    if(desc[pos] < 2)
+    {
+      CHECK(desc[pos] >= 2);
+      break;
+    }
+    switch(desc[pos + 1])
+    {
+      case DESC_TYPE_IAD:
+        iad_first = desc[pos + 2];
+        iad_count = desc[pos + 3];
+        iad_total++;
+        /* the interfaces it covers follow it */
+        CHECK(iad_first == intf_count && iad_count >= 2);
+        break;
+      case DESC_TYPE_INTERFACE:
+        intf = desc[pos + 2];
+        if(desc[pos + 3] == 0)
+        {
+          CHECK(intf < USBD_COMPOSITE_INTERFACE_MAX && intf_seen[intf] == 0);
+          intf_seen[intf % USBD_COMPOSITE_INTERFACE_MAX] = 1;
+          intf_count++;
+        }
+        break;
+      case DESC_TYPE_ENDPOINT:
+        ept = desc[pos + 2] & 0x7F;
+        CHECK(ept != 0 && ept < USB_EPT_MAX_NUM);
+        CHECK(ept_seen[desc[pos + 2] >> 7][ept % USB_EPT_MAX_NUM] == 0);
+        ept_seen[desc[pos + 2] >> 7][ept % USB_EPT_MAX_NUM] = 1;
+        CHECK((desc[pos + 4] | desc[pos + 5] << 8) != 0);
+        break;
+      case DESC_TYPE_CS_INTERFACE:
+        /* cdc functional descriptors point inside their own function */
+        if(desc[pos + 2] == CDC_SUBTYPE_UNION)
+        {
+          CHECK(desc[pos + 3] == intf);
+          for(index = 4; index < desc[pos]; index++)
+          {
+            CHECK(desc[pos + index] >= iad_first && desc[pos + index] < iad_first + iad_count);
+          }
+        }
+        if(desc[pos + 2] == CDC_SUBTYPE_CALL_MGMT)
+        {
+          CHECK(desc[pos + 4] >= iad_first && desc[pos + 4] < iad_first + iad_count);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  CHECK(pos == config->length);
+  CHECK(intf_count == desc[4]);
+  for(index = 0; index < intf_count; index++)
+  {
+    CHECK(intf_seen[index] != 0);
+  }
+
+  printf("%s: config %u bytes, %u interfaces, %u associations\n", name, config->length, desc[4], iad_total);
+  return iad_total;
+}
+
+static void fifo_check(void)
+{
+  usbd_fifo_plan_type *plan = &composite_struct.fifo_plan;
+  uint32_t index, total = plan->rx_size, max_out = USB_MAX_EP0_SIZE, out_count = 1;
+
+  printf("  fifo words rx %u, tx", plan->rx_size);
+  for(index = 0; index < USB_EPT_MAX_NUM; index++)
+  {
+    printf(" %u", plan->tx_size[index]);
+    total += plan->tx_size[index];
+    if(index != 0 && composite_struct.out_owner[index] != USBD_COMPOSITE_NONE)
+    {
+      out_count++;
+      max_out = (composite_struct.out_maxpacket[index] > max_out) ? composite_struct.out_maxpacket[index] : max_out;
+    }
+  }
+  printf(", %u of %u\n", total, OTG_FIFO_SIZE);
+
+  CHECK(total <= OTG_FIFO_SIZE);
+  /* setup packets, one out packet with its status word, a word per out
+     endpoint for transfer complete and one for global nak */
+  CHECK(plan->rx_size >= 13 + (max_out / 4 + 1) + 2 * out_count + 1);
+  CHECK(plan->tx_size[0] >= 16 && plan->tx_size[0] * 4 >= USB_MAX_EP0_SIZE);
+  for(index = 1; index < USB_EPT_MAX_NUM; index++)
+  {
+    if(composite_struct.in_owner[index] != USBD_COMPOSITE_NONE)
+    {
+      CHECK(plan->tx_size[index] >= 16 && plan->tx_size[index] * 4 >= composite_struct.in_maxpacket[index]);
+    }
+    else
+    {
+      CHECK(plan->tx_size[index] == 0);
+    }
+  }
+}
+
+static void cdc_msc_test(void)
+{
+  composite_ept_type cdc_ept[] = {{0x82, &cdc_int, 8}, {0x81, &cdc_in, 1216}, {0x01, &cdc_out, 1216}};
+  composite_ept_type msc_ept[] = {{0x81, &msc_in, 1024}, {0x01, &msc_out, 1024}};
+  usbd_core_type dev;
+  usb_setup_type setup;
+
+  composite_reset();
+  memset(&dev, 0, sizeof(dev));
+  CHECK(usb_composite_add_function(&handler_0, &cdc_desc_handler, cdc_ept, 3) == SUCCESS);
+  CHECK(usb_composite_add_function(&handler_1, &msc_desc_handler, msc_ept, 2) == SUCCESS);
+  CHECK(usb_composite_build(&dev) == SUCCESS);
+  CHECK(dev.fifo_plan == &composite_struct.fifo_plan);
+  CHECK(config_check("cdc+msc") == 1);
+  fifo_check();
+
+  /* in and out numbered from 1 in the order declared */
+  CHECK(cdc_int == 0x81 && cdc_in == 0x82 && cdc_out == 0x01 && msc_in == 0x83 && msc_out == 0x02);
+
+  /* routing */
+  composite_class_handler.init_handler(&dev);
+  CHECK(calls[0].init == 1 && calls[1].init == 1);
+  composite_class_handler.in_handler(&dev, msc_in & 0x7F);
+  CHECK(calls[1].in_ept == msc_in && calls[0].in_ept == 0);
+  composite_class_handler.out_handler(&dev, cdc_out);
+  CHECK(calls[0].out_ept == cdc_out && calls[1].out_ept == 0);
+
+  /* interface requests by wIndex, msc is interface 2 */
+  setup.bmRequestType = 0x21;
+  setup.wIndex = 2;
+  composite_class_handler.setup_handler(&dev, &setup);
+  CHECK(calls[1].setup == 1 && calls[0].setup == 0);
+  setup.wIndex = 1;
+  composite_class_handler.setup_handler(&dev, &setup);
+  CHECK(calls[0].setup == 1);
+
+  /* the data stage goes to the function of the last request */
+  composite_class_handler.ept0_rx_handler(&dev);
+  CHECK(calls[0].ept0_rx == 1 && calls[1].ept0_rx == 0);
+
+  /* endpoint requests by address */
+  setup.bmRequestType = 0x02;
+  setup.wIndex = msc_in;
+  composite_class_handler.setup_handler(&dev, &setup);
+  CHECK(calls[1].setup == 2);
+
+  /* an interface nobody owns */
+  setup.bmRequestType = 0x21;
+  setup.wIndex = 5;
+  CHECK(composite_class_handler.setup_handler(&dev, &setup) == USB_FAIL);
+}
+
+static void endpoint_limit_test(void)
+{
+  composite_ept_type cdc_ept[] = {{0x82, &cdc_int, 8}, {0x81, &cdc_in, 64}, {0x01, &cdc_out, 64}};
+  composite_ept_type msc_ept[] = {{0x81, &msc_in, 64}, {0x01, &msc_out, 64}};
+  composite_ept_type keyboard_ept[] = {{0x81, &keyboard_in, 8}};
+  usbd_core_type dev;
+
+  composite_reset();
+  memset(&dev, 0, sizeof(dev));
+  usb_composite_add_function(&handler_0, &cdc_desc_handler, cdc_ept, 3);
+  usb_composite_add_function(&handler_2, &keyboard_desc_handler, keyboard_ept, 1);
+  CHECK(usb_composite_build(&dev) == SUCCESS);
+  CHECK(config_check("cdc+keyboard") == 1);
+  fifo_check();
+
+  /* four in endpoints do not fit below USB_EPT_MAX_NUM */
+  usb_composite_add_function(&handler_1, &msc_desc_handler, msc_ept, 2);
+  CHECK(usb_composite_build(&dev) == ERROR);
+  printf("cdc+keyboard+msc: refused, %u in endpoints for %u\n", 4, USB_EPT_MAX_NUM - 1);
+}
+
+static void no_association_test(void)
+{
+  composite_ept_type msc_ept[] = {{0x81, &msc_in, 1024}, {0x01, &msc_out, 1024}};
+  composite_ept_type keyboard_ept[] = {{0x81, &keyboard_in, 8}};
+  usbd_core_type dev;
+
+  composite_reset();
+  memset(&dev, 0, sizeof(dev));
+  usb_composite_add_function(&handler_1, &msc_desc_handler, msc_ept, 2);
+  usb_composite_add_function(&handler_2, &keyboard_desc_handler, keyboard_ept, 1);
+  CHECK(usb_composite_build(&dev) == SUCCESS);
+  CHECK(config_check("msc+keyboard") == 0);
+  fifo_check();
+  CHECK(msc_in == 0x81 && msc_out == 0x01 && keyboard_in == 0x82);
+}
+
+/* the plan stays within the fifo however much bandwidth is asked for */
+static void bandwidth_test(void)
+{
+  composite_ept_type cdc_ept[] = {{0x82, &cdc_int, 64}, {0x81, &cdc_in, 60000}, {0x01, &cdc_out, 60000}};
+  composite_ept_type msc_ept[] = {{0x81, &msc_in, 60000}, {0x01, &msc_out, 60000}};
+  composite_ept_type low_ept[] = {{0x82, &cdc_int, 0}, {0x81, &cdc_in, 0}, {0x01, &cdc_out, 0}};
+  usbd_core_type dev;
+
+  composite_reset();
+  memset(&dev, 0, sizeof(dev));
+  usb_composite_add_function(&handler_0, &cdc_desc_handler, cdc_ept, 3);
+  usb_composite_add_function(&handler_1, &msc_desc_handler, msc_ept, 2);
+  CHECK(usb_composite_build(&dev) == SUCCESS);
+  printf("cdc+msc, full bandwidth:\n");
+  fifo_check();
+
+  composite_reset();
+  usb_composite_add_function(&handler_0, &cdc_desc_handler, low_ept, 3);
+  CHECK(usb_composite_build(&dev) == SUCCESS);
+  printf("cdc, no bandwidth:\n");
+  fifo_check();
+}
+
+static void undeclared_endpoint_test(void)
+{
+  composite_ept_type cdc_ept[] = {{0x82, &cdc_int, 8}, {0x81, &cdc_in, 64}};
+  usbd_core_type dev;
+
+  /* the bulk out endpoint of the template is not in the list */
+  composite_reset();
+  memset(&dev, 0, sizeof(dev));
+  usb_composite_add_function(&handler_0, &cdc_desc_handler, cdc_ept, 2);
+  CHECK(usb_composite_build(&dev) == ERROR);
+}
+
+int main(void)
+{
+  cdc_msc_test();
+  endpoint_limit_test();
+  no_association_test();
+  bandwidth_test();
+  undeclared_endpoint_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -86,8 +86,9 @@ static usb_sts_type class_init_handler(void *udev)
   /* set out endpoint to receive status */
   usbd_ept_recv(pudev, USBD_CUSTOM_HID_OUT_EPT, pcshid->g_rxhid_buff, USBD_CUSTOM_OUT_MAXPACKET_SIZE);
 
-  pcshid->send_state = 0;
-  
+  hid_report_queue_init(&pcshid->report_queue, USBD_CUSTOM_HID_IN_EPT, pcshid->report_buffer[0],
+                        USBD_CUSTOM_REPORT_QUEUE_DEPTH, USBD_CUSTOM_IN_MAXPACKET_SIZE);
+
   return status;
 }
 
@@ -100,6 +101,7 @@ static usb_sts_type class_clear_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
+  custom_hid_type *pcshid = (custom_hid_type *)pudev->class_handler->pdata;
 
   /* close custom hid in endpoint */
   usbd_ept_close(pudev, USBD_CUSTOM_HID_IN_EPT);
@@ -107,6 +109,8 @@ static usb_sts_type class_clear_handler(void *udev)
   /* close custom hid out endpoint */
   usbd_ept_close(pudev, USBD_CUSTOM_HID_OUT_EPT);
 
+  hid_report_queue_flush(&pcshid->report_queue);
+
   return status;
 }
 
@@ -246,11 +250,8 @@ static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
   usbd_core_type *pudev = (usbd_core_type *)udev;
   custom_hid_type *pcshid = (custom_hid_type *)pudev->class_handler->pdata;
   
-  pcshid->send_state = 0;
-  
-  /* ...user code...
-    trans next packet data
-  */
+  /* send the next queued report */
+  hid_report_queue_in_complete(&pcshid->report_queue, pudev);
 
   return status;
 }
@@ -325,11 +326,13 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
 }
 
 /**
-  * @brief  usb device class send report
+  * @brief  usb device class send report, the report is copied into the queue
+  *         and sent after the reports already queued
   * @param  udev: to the structure of usbd_core_type
   * @param  report: report buffer
   * @param  len: report length
-  * @retval status of usb_sts_type
+  * @retval status of usb_sts_type, USB_FAIL when the queue is full or the
+  *         device is not configured
   */
 usb_sts_type custom_hid_class_send_report(void *udev, uint8_t *report, uint16_t len)
 {
@@ -337,10 +340,8 @@ usb_sts_type custom_hid_class_send_report(void *udev, uint8_t *report, uint16_t
   usbd_core_type *pudev = (usbd_core_type *)udev;
   custom_hid_type *pcshid = (custom_hid_type *)pudev->class_handler->pdata;
 
-  if(usbd_connect_state_get(pudev) == USB_CONN_STATE_CONFIGURED && pcshid->send_state == 0)
+  if(hid_report_queue_push(&pcshid->report_queue, pudev, report, len, NULL, NULL) == HID_REPORT_QUEUED)
   {
-    pcshid->send_state = 1;
-    usbd_ept_send(pudev, USBD_CUSTOM_HID_IN_EPT, report, len);
     status = USB_OK;
   }
   return status;
@@ -355,7 +356,6 @@ usb_sts_type custom_hid_class_send_report(void *udev, uint8_t *report, uint16_t
   */
 static void usb_hid_buf_process(void *udev, uint8_t *report, uint16_t len)
 {
-  uint32_t i_index;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   custom_hid_type *pcshid = (custom_hid_type *)pudev->class_handler->pdata;
 
@@ -392,11 +392,7 @@ static void usb_hid_buf_process(void *udev, uint8_t *report, uint16_t len)
       }
       break;
     case HID_REPORT_ID_6:
-      for(i_index = 0; i_index < len; i_index ++)
-      {
-        pcshid->g_txhid_buff[i_index] = report[i_index];
-      }
-      custom_hid_class_send_report(pudev, pcshid->g_txhid_buff, len);
+      custom_hid_class_send_report(pudev, report, len);
       break;
     default:
       break;
@@ -33,6 +33,7 @@ extern "C" {
 
 #include "usb_std.h"
 #include "usbd_core.h"
+#include "hid_report_queue.h"
 
 /** @addtogroup AT32F415_middlewares_usbd_class
   * @{
@@ -58,6 +59,13 @@ extern "C" {
 #define USBD_CUSTOM_IN_MAXPACKET_SIZE           0x40
 #define USBD_CUSTOM_OUT_MAXPACKET_SIZE          0x40
 
+/**
+  * @brief number of in reports buffered while the endpoint is busy
+  */
+#ifndef USBD_CUSTOM_REPORT_QUEUE_DEPTH
+#define USBD_CUSTOM_REPORT_QUEUE_DEPTH          4
+#endif
+
 /**
   * @}
   */
@@ -69,7 +77,9 @@ extern "C" {
 typedef struct
 {
   uint8_t g_rxhid_buff[USBD_CUSTOM_OUT_MAXPACKET_SIZE];
-  uint8_t g_txhid_buff[USBD_CUSTOM_IN_MAXPACKET_SIZE];
+
+  hid_report_queue_type report_queue;
+  uint8_t report_buffer[USBD_CUSTOM_REPORT_QUEUE_DEPTH][USBD_CUSTOM_IN_MAXPACKET_SIZE];
 
   uint32_t hid_protocol;
   uint32_t hid_set_idle;
@@ -78,7 +88,6 @@ typedef struct
   uint8_t hid_set_report[64];
   uint8_t hid_get_report[64];
   uint8_t hid_state;
-  uint8_t send_state;
 }custom_hid_type;
 
 /**
@@ -74,7 +74,7 @@ extern "C" {
 #define USBD_CUSHID_DESC_CONFIGURATION_STRING   "Custom HID Config"
 #define USBD_CUSHID_DESC_INTERFACE_STRING       "Custom HID Interface"
 
-#define CUSHID_BINTERVAL_TIME            0x0A
+#define CUSHID_BINTERVAL_TIME            0x01
 
 /**
   * @brief usb hid report id define
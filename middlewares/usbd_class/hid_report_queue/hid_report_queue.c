@@ -0,0 +1,213 @@
+/**
+  **************************************************************************
+  * @file     hid_report_queue.c
+  * @brief    usb hid in report queue
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+#include "usbd_core.h"
+#include "hid_report_queue.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @defgroup USB_hid_report_queue
+  * @brief usb hid in report queue
+  * @{
+  */
+
+/** @defgroup USB_hid_report_queue_private_functions
+  * @{
+  */
+
+/**
+  * @brief  start sending the head report, caller holds the critical section
+  * @param  queue: report queue
+  * @param  udev: to the structure of usbd_core_type
+  * @retval none
+  */
+static void hid_report_queue_start(hid_report_queue_type *queue, usbd_core_type *pudev)
+{
+  if(queue->busy == 0 && queue->count != 0)
+  {
+    queue->busy = 1;
+    usbd_ept_send(pudev, queue->ept, &queue->buffer[queue->head * queue->size], queue->length[queue->head]);
+  }
+}
+
+/**
+  * @brief  initialize a report queue
+  * @param  queue: report queue
+  * @param  ept: in endpoint address
+  * @param  buffer: depth * size bytes of report storage
+  * @param  depth: number of reports, at most HID_REPORT_QUEUE_DEPTH_MAX
+  * @param  size: largest report length
+  * @retval none
+  */
+void hid_report_queue_init(hid_report_queue_type *queue, uint8_t ept, uint8_t *buffer, uint8_t depth, uint8_t size)
+{
+  queue->buffer = buffer;
+  queue->ept = ept;
+  queue->depth = MIN(depth, HID_REPORT_QUEUE_DEPTH_MAX);
+  queue->size = size;
+  queue->max_count = 0;
+  queue->sent_count = 0;
+  queue->merge_count = 0;
+  queue->drop_count = 0;
+
+  hid_report_queue_flush(queue);
+}
+
+/**
+  * @brief  drop the queued reports, called when the endpoint is opened or closed
+  * @param  queue: report queue
+  * @retval none
+  */
+void hid_report_queue_flush(hid_report_queue_type *queue)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  queue->head = 0;
+  queue->count = 0;
+  queue->busy = 0;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  queue a report and start sending it when the endpoint is idle
+  * @param  queue: report queue
+  * @param  udev: to the structure of usbd_core_type
+  * @param  report: report buffer, copied into the queue
+  * @param  len: report length
+  * @param  merge: merge callback, NULL to never merge
+  * @param  arg: merge callback argument
+  * @retval push result of hid_report_result_type
+  */
+hid_report_result_type hid_report_queue_push(hid_report_queue_type *queue, void *udev, const uint8_t *report, uint16_t len,
+                                             hid_report_merge_type merge, void *arg)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  hid_report_result_type result;
+  uint16_t tail_len;
+  uint8_t tail, index;
+  uint32_t primask;
+
+  if(usbd_connect_state_get(pudev) != USB_CONN_STATE_CONFIGURED)
+  {
+    return HID_REPORT_OFFLINE;
+  }
+
+  len = MIN(len, queue->size);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+
+  tail = (queue->head + queue->count + queue->depth - 1) % queue->depth;
+  tail_len = queue->length[tail];
+
+  /* the tail can only be changed while it is not on the bus */
+  if(merge != NULL && queue->count > queue->busy &&
+     merge(arg, &queue->buffer[tail * queue->size], &tail_len, report, len) == TRUE)
+  {
+    queue->length[tail] = (uint8_t)MIN(tail_len, queue->size);
+    queue->merge_count++;
+    result = HID_REPORT_MERGED;
+  }
+  else if(queue->count == queue->depth)
+  {
+    queue->drop_count++;
+    result = HID_REPORT_FULL;
+  }
+  else
+  {
+    tail = (queue->head + queue->count) % queue->depth;
+    for(index = 0; index < len; index++)
+    {
+      queue->buffer[tail * queue->size + index] = report[index];
+    }
+    queue->length[tail] = (uint8_t)len;
+    queue->count++;
+
+    if(queue->count > queue->max_count)
+    {
+      queue->max_count = queue->count;
+    }
+    result = HID_REPORT_QUEUED;
+  }
+
+  hid_report_queue_start(queue, pudev);
+
+  __set_PRIMASK(primask);
+
+  return result;
+}
+
+/**
+  * @brief  release the report that was on the bus and send the next one, called
+  *         from the class in handler
+  * @param  queue: report queue
+  * @param  udev: to the structure of usbd_core_type
+  * @retval none
+  */
+void hid_report_queue_in_complete(hid_report_queue_type *queue, void *udev)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if(queue->busy != 0)
+  {
+    queue->busy = 0;
+    queue->head = (queue->head + 1) % queue->depth;
+    queue->count--;
+    queue->sent_count++;
+  }
+
+  if(usbd_connect_state_get(pudev) == USB_CONN_STATE_CONFIGURED)
+  {
+    hid_report_queue_start(queue, pudev);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  number of free report slots
+  * @param  queue: report queue
+  * @retval free slots
+  */
+uint8_t hid_report_queue_free(hid_report_queue_type *queue)
+{
+  return queue->depth - queue->count;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
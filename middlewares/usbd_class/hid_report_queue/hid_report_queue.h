@@ -0,0 +1,125 @@
+/**
+  **************************************************************************
+  * @file     hid_report_queue.h
+  * @brief    usb hid in report queue header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+ /* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HID_REPORT_QUEUE_H
+#define __HID_REPORT_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "usb_std.h"
+#include "usbd_core.h"
+
+/** @addtogroup AT32F415_middlewares_usbd_class
+  * @{
+  */
+
+/** @addtogroup USB_hid_report_queue
+  * @{
+  */
+
+/** @defgroup USB_hid_report_queue_definition
+  * @{
+  */
+
+/**
+  * @brief the queue holds reports for one interrupt in endpoint. the head report
+  *        stays in its slot while it is on the bus, the next one is sent from the
+  *        in complete callback, so a report is sent every bInterval without
+  *        waiting for the application. the queue is updated with interrupts
+  *        disabled, so reports can be pushed from thread level or from the usb
+  *        interrupt.
+  */
+#define HID_REPORT_QUEUE_DEPTH_MAX             16
+
+/**
+  * @brief merge callback, called with interrupts disabled when a report is
+  *        pushed and the tail of the queue is not yet on the bus. return TRUE
+  *        after combining report into tail, FALSE to queue report on its own.
+  */
+typedef confirm_state (*hid_report_merge_type)(void *arg, uint8_t *tail, uint16_t *tail_len,
+                                               const uint8_t *report, uint16_t len);
+
+/**
+  * @brief push result
+  */
+typedef enum
+{
+  HID_REPORT_QUEUED,                     /*!< report queued in a new slot */
+  HID_REPORT_MERGED,                     /*!< report merged into the tail */
+  HID_REPORT_FULL,                       /*!< no free slot, report dropped */
+  HID_REPORT_OFFLINE                     /*!< device not configured */
+} hid_report_result_type;
+
+/**
+  * @brief report queue of one in endpoint
+  */
+typedef struct
+{
+  uint8_t                                *buffer;                 /*!< depth slots of size bytes       */
+  uint8_t                                length[HID_REPORT_QUEUE_DEPTH_MAX];    /*!< report lengths */
+  uint8_t                                ept;                     /*!< in endpoint address             */
+  uint8_t                                depth;                   /*!< number of slots                 */
+  uint8_t                                size;                    /*!< slot size                       */
+  uint8_t                                head;                    /*!< oldest report                   */
+  __IO uint8_t                           count;                   /*!< queued reports                  */
+  __IO uint8_t                           busy;                    /*!< head report is on the bus       */
+  uint8_t                                max_count;               /*!< queue high water mark           */
+  __IO uint32_t                          sent_count;              /*!< reports sent                    */
+  uint32_t                               merge_count;             /*!< reports merged into the tail    */
+  uint32_t                               drop_count;              /*!< reports dropped, queue full     */
+} hid_report_queue_type;
+
+/**
+  * @}
+  */
+
+/** @defgroup USB_hid_report_queue_exported_functions
+  * @{
+  */
+void hid_report_queue_init(hid_report_queue_type *queue, uint8_t ept, uint8_t *buffer, uint8_t depth, uint8_t size);
+void hid_report_queue_flush(hid_report_queue_type *queue);
+hid_report_result_type hid_report_queue_push(hid_report_queue_type *queue, void *udev, const uint8_t *report, uint16_t len,
+                                             hid_report_merge_type merge, void *arg);
+void hid_report_queue_in_complete(hid_report_queue_type *queue, void *udev);
+uint8_t hid_report_queue_free(hid_report_queue_type *queue);
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,410 @@
+/**
+  **************************************************************************
+  * @file     hid_report_queue_host_test.c
+  * @brief    host model of the hid report queue with the usb hid classes
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs the keyboard, mouse and custom hid classes with their report queues
+ * against a model of the usb host. the in endpoint of each device holds a
+ * copy of the report usbd_ept_send armed, the host takes it once per 1 ms
+ * bInterval and the class in handler is called as the in complete interrupt
+ * would. the application runs every 10 us.
+ * - keyboard: a 5000 character macro typed with usb_hid_keyboard_send_char,
+ *   retried while the queue is full. the host decodes key presses as a host
+ *   does and must read the text back exactly.
+ * - mouse: an 8 khz sensor with random motion, clicks and flicks larger than
+ *   a report can hold. the motion the host sums plus what is still queued
+ *   must equal the sensor motion and the host must see every button edge.
+ * - custom hid: numbered reports in bursts. every report accepted is sent
+ *   once and in order, a report is refused only when the queue is full and
+ *   every report is refused while the device is not configured.
+ * an endpoint is never armed twice and interrupts are enabled again after
+ * every call. reports per second and loss are printed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "keyboard_class.h"
+#include "mouse_class.h"
+#include "custom_hid_class.h"
+
+#define TEXT_LENGTH                      5000
+#define APP_PERIOD_US                    10
+#define POLL_PERIOD_US                   1000
+#define SENSOR_PERIOD_US                 125
+#define MOUSE_RUN_US                     10000000
+#define CUSTOM_REPORTS                   20000
+
+typedef struct
+{
+  usbd_core_type dev;
+  uint8_t report[USBD_CUSTOM_IN_MAXPACKET_SIZE];
+  uint16_t len;
+  uint8_t armed;
+  uint32_t sent;
+} host_device_type;
+
+static host_device_type keyboard_dev, mouse_dev, custom_dev;
+static uint8_t keymap[2][256];
+static char text[TEXT_LENGTH + 1], typed[TEXT_LENGTH * 2 + 1];
+static uint32_t typed_len;
+static uint8_t host_keys[USBD_KEYBOARD_REPORT_SIZE];
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+uint8_t g_usbd_keyboard_report[1];
+uint8_t g_keyboard_usb_desc[1];
+uint8_t g_usbd_mouse_report[1];
+uint8_t g_mouse_usb_desc[1];
+uint8_t g_usbd_custom_hid_report[1];
+uint8_t g_custom_hid_usb_desc[1];
+
+/* the usb device core, only what the classes use */
+static host_device_type *host_device(void *udev)
+{
+  return (host_device_type *)udev;
+}
+
+usbd_conn_state usbd_connect_state_get(usbd_core_type *udev)
+{
+  return udev->conn_state;
+}
+
+void usbd_ept_send(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+  host_device_type *device = host_device(udev);
+
+  CHECK(device->armed == 0);
+  CHECK(host_primask == 1);
+  /* the controller takes the report when it is armed, a later change of the
+     slot must not reach the host */
+  memcpy(device->report, buffer, len);
+  device->len = len;
+  device->armed = 1;
+}
+
+void usbd_ept_recv(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+}
+
+void usbd_ept_open(usbd_core_type *udev, uint8_t ept_addr, uint8_t ept_type, uint16_t maxpacket)
+{
+}
+
+void usbd_ept_close(usbd_core_type *udev, uint8_t ept_addr)
+{
+}
+
+uint32_t usbd_get_recv_len(usbd_core_type *udev, uint8_t ept_addr)
+{
+  return 0;
+}
+
+void usbd_ctrl_send(usbd_core_type *udev, uint8_t *buffer, uint16_t len)
+{
+}
+
+void usbd_ctrl_recv(usbd_core_type *udev, uint8_t *buffer, uint16_t len)
+{
+}
+
+void usbd_ctrl_unsupport(usbd_core_type *udev)
+{
+}
+
+void at32_led_on(led_type led)
+{
+}
+
+void at32_led_off(led_type led)
+{
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static void device_init(host_device_type *device, usbd_class_handler *handler)
+{
+  memset(device, 0, sizeof(host_device_type));
+  device->dev.class_handler = handler;
+  device->dev.conn_state = USB_CONN_STATE_CONFIGURED;
+  handler->init_handler(&device->dev);
+}
+
+/* the host takes the armed report, then the in complete interrupt runs */
+static uint8_t *host_poll(host_device_type *device)
+{
+  static uint8_t report[USBD_CUSTOM_IN_MAXPACKET_SIZE];
+
+  if(device->armed == 0)
+  {
+    return NULL;
+  }
+  memcpy(report, device->report, device->len);
+  device->armed = 0;
+  device->sent++;
+  device->dev.class_handler->in_handler(&device->dev, USBD_KEYBOARD_IN_EPT & 0x7F);
+  CHECK(host_primask == 0);
+  return report;
+}
+
+/* a key that was not in the last report is a key press */
+static void host_keyboard_decode(const uint8_t *report)
+{
+  uint8_t shift = (report[0] & 0x22) != 0, index, prev;
+
+  for(index = 2; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+  {
+    if(report[index] == 0)
+    {
+      continue;
+    }
+    for(prev = 2; prev < USBD_KEYBOARD_REPORT_SIZE; prev++)
+    {
+      if(host_keys[prev] == report[index])
+      {
+        break;
+      }
+    }
+    if(prev == USBD_KEYBOARD_REPORT_SIZE && typed_len < sizeof(typed) - 1)
+    {
+      typed[typed_len++] = keymap[shift][report[index]] ? (char)keymap[shift][report[index]] : '?';
+    }
+  }
+  memcpy(host_keys, report, USBD_KEYBOARD_REPORT_SIZE);
+}
+
+/* learn the key of every character from the reports the class sends */
+static void keymap_build(void)
+{
+  uint8_t *report;
+  uint32_t ascii;
+
+  for(ascii = 1; ascii < 128; ascii++)
+  {
+    device_init(&keyboard_dev, &keyboard_class_handler);
+    if(usb_hid_keyboard_send_char(&keyboard_dev.dev, (uint8_t)ascii) != USB_OK)
+    {
+      continue;
+    }
+    while((report = host_poll(&keyboard_dev)) != NULL)
+    {
+      if(report[2] != 0 && keymap[(report[0] & 0x22) != 0][report[2]] == 0)
+      {
+        keymap[(report[0] & 0x22) != 0][report[2]] = (uint8_t)ascii;
+      }
+    }
+  }
+}
+
+static void keyboard_test(void)
+{
+  keyboard_type *keyboard = (keyboard_type *)keyboard_class_handler.pdata;
+  uint32_t index, typed_count = 0, retries = 0, t, t_end = 0;
+  uint8_t *report;
+
+  keymap_build();
+
+  for(index = 0; index < TEXT_LENGTH; index++)
+  {
+    text[index] = ((rand_get() % 100) < 3) ? '\n' : (char)(' ' + rand_get() % 95);
+    if(index != 0 && (rand_get() % 10) == 0)
+    {
+      /* repeated characters need a release in between */
+      text[index] = text[index - 1];
+    }
+  }
+  text[TEXT_LENGTH] = 0;
+
+  device_init(&keyboard_dev, &keyboard_class_handler);
+  memset(host_keys, 0, sizeof(host_keys));
+  typed_len = 0;
+
+  for(t = 0; t_end == 0; t += APP_PERIOD_US)
+  {
+    if(typed_count < TEXT_LENGTH)
+    {
+      if(usb_hid_keyboard_send_char(&keyboard_dev.dev, (uint8_t)text[typed_count]) == USB_OK)
+      {
+        typed_count++;
+      }
+      else
+      {
+        retries++;
+      }
+      CHECK(host_primask == 0);
+    }
+    else if(keyboard->report_queue.count == 0 && keyboard_dev.armed == 0)
+    {
+      t_end = t;
+    }
+
+    if((t % POLL_PERIOD_US) == 0 && (report = host_poll(&keyboard_dev)) != NULL)
+    {
+      host_keyboard_decode(report);
+    }
+  }
+  typed[typed_len] = 0;
+
+  printf("keyboard: %u chars in %.3f s, %.0f chars/s, %u reports, %.0f reports/s, %.2f reports/char, "
+         "merged %u, dropped %u, most queued %u, text %s\n",
+         TEXT_LENGTH, t_end / 1e6, TEXT_LENGTH / (t_end / 1e6), keyboard_dev.sent, keyboard_dev.sent / (t_end / 1e6),
+         (double)keyboard_dev.sent / TEXT_LENGTH, keyboard->report_queue.merge_count, keyboard->report_queue.drop_count,
+         keyboard->report_queue.max_count, strcmp(typed, text) == 0 ? "matches" : "DIFFERS");
+
+  CHECK(strcmp(typed, text) == 0);
+  CHECK(keyboard_dev.sent == keyboard->report_queue.sent_count);
+  CHECK(keyboard_dev.sent <= t_end / POLL_PERIOD_US + 1);
+  /* the old class sent a press and a release per character at most */
+  CHECK(TEXT_LENGTH / (t_end / 1e6) > 1e6 / (2 * POLL_PERIOD_US));
+}
+
+static void mouse_test(void)
+{
+  mouse_type *mouse = (mouse_type *)mouse_class_handler.pdata;
+  int64_t sensor_x = 0, sensor_y = 0, host_x = 0, host_y = 0, queued_x = 0, queued_y = 0;
+  uint32_t t, clicks = 0, host_clicks = 0, refused = 0, index;
+  uint8_t button = 0, host_button = 0, *report, *slot;
+  int16_t dx, dy;
+
+  device_init(&mouse_dev, &mouse_class_handler);
+
+  for(t = 0; t < MOUSE_RUN_US; t += SENSOR_PERIOD_US)
+  {
+    dx = (int16_t)(rand_get() % 81) - 40;
+    dy = (int16_t)(rand_get() % 81) - 40;
+    if((rand_get() % 400) == 0)
+    {
+      button ^= LEFT_BUTTON;
+      clicks++;
+    }
+    if((rand_get() % 2000) == 0)
+    {
+      /* a flick, more than one report can hold */
+      dx = 300;
+    }
+    sensor_x += dx;
+    sensor_y += dy;
+    if(usb_hid_mouse_report(&mouse_dev.dev, button, dx, dy, 0) != USB_OK)
+    {
+      refused++;
+    }
+    CHECK(host_primask == 0);
+
+    if((t % POLL_PERIOD_US) == 0 && (report = host_poll(&mouse_dev)) != NULL)
+    {
+      host_x += (int8_t)report[1];
+      host_y += (int8_t)report[2];
+      if(((report[0] ^ host_button) & LEFT_BUTTON) != 0)
+      {
+        host_clicks++;
+      }
+      host_button = report[0];
+    }
+  }
+
+  /* what is still queued, the armed head included */
+  for(index = 0; index < mouse->report_queue.count; index++)
+  {
+    slot = &mouse->report_queue.buffer[((mouse->report_queue.head + index) % mouse->report_queue.depth) * USBD_MOUSE_REPORT_SIZE];
+    queued_x += (int8_t)slot[1];
+    queued_y += (int8_t)slot[2];
+  }
+
+  printf("mouse: %.0f reports/s, sensor %lld %lld, host %lld %lld, queued %lld %lld, button edges %u of %u, "
+         "refused %u, merged %u, most queued %u\n",
+         mouse_dev.sent * 1e6 / MOUSE_RUN_US, (long long)sensor_x, (long long)sensor_y,
+         (long long)host_x, (long long)host_y, (long long)queued_x, (long long)queued_y,
+         host_clicks, clicks, refused, mouse->report_queue.merge_count, mouse->report_queue.max_count);
+
+  CHECK(refused == 0);
+  CHECK(host_x + queued_x == sensor_x && host_y + queued_y == sensor_y);
+  CHECK(host_clicks + (((host_button ^ button) & LEFT_BUTTON) != 0) == clicks);
+  CHECK(mouse_dev.sent <= MOUSE_RUN_US / POLL_PERIOD_US);
+}
+
+static void custom_test(void)
+{
+  custom_hid_type *custom = (custom_hid_type *)custom_hid_class_handler.pdata;
+  uint8_t report[USBD_CUSTOM_IN_MAXPACKET_SIZE], *sent;
+  uint32_t next = 0, expect = 0, accepted = 0, refused = 0, refused_full = 0, t, burst;
+
+  device_init(&custom_dev, &custom_hid_class_handler);
+  memset(report, 0, sizeof(report));
+
+  for(t = 0; expect < CUSTOM_REPORTS; t += APP_PERIOD_US)
+  {
+    if(next < CUSTOM_REPORTS && (rand_get() % 50) == 0)
+    {
+      for(burst = rand_get() % 8; burst != 0 && next < CUSTOM_REPORTS; burst--)
+      {
+        memcpy(report, &next, sizeof(next));
+        if(custom_hid_class_send_report(&custom_dev.dev, report, USBD_CUSTOM_IN_MAXPACKET_SIZE) == USB_OK)
+        {
+          accepted++;
+          next++;
+        }
+        else
+        {
+          /* a refused report is sent again by the application */
+          refused++;
+          refused_full += (custom->report_queue.count == custom->report_queue.depth);
+          break;
+        }
+      }
+    }
+
+    if((t % POLL_PERIOD_US) == 0 && (sent = host_poll(&custom_dev)) != NULL)
+    {
+      CHECK(custom_dev.len == USBD_CUSTOM_IN_MAXPACKET_SIZE);
+      CHECK(memcmp(sent, &expect, sizeof(expect)) == 0);
+      expect++;
+    }
+  }
+
+  /* nothing is queued while the device is not configured */
+  custom_dev.dev.conn_state = USB_CONN_STATE_DEFAULT;
+  CHECK(custom_hid_class_send_report(&custom_dev.dev, report, USBD_CUSTOM_IN_MAXPACKET_SIZE) == USB_FAIL);
+  CHECK(custom->report_queue.count == 0 && custom_dev.armed == 0);
+
+  printf("custom hid: %u reports in order, %u refused, all with the queue full, most queued %u\n",
+         expect, refused, custom->report_queue.max_count);
+
+  CHECK(accepted == CUSTOM_REPORTS && expect == CUSTOM_REPORTS);
+  CHECK(refused == refused_full);
+}
+
+int main(void)
+{
+  keyboard_test();
+  mouse_test();
+  custom_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
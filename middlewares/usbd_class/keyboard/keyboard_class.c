@@ -49,7 +49,18 @@ static usb_sts_type class_out_handler(void *udev, uint8_t ept_num);
 static usb_sts_type class_sof_handler(void *udev);
 static usb_sts_type class_event_handler(void *udev, usbd_event_type event);
 
+static void keyboard_report_copy(uint8_t *dst, const uint8_t *src);
+static confirm_state keyboard_report_has(const uint8_t *report, uint8_t key);
+static confirm_state keyboard_report_merge(void *arg, uint8_t *tail, uint16_t *tail_len, const uint8_t *report, uint16_t len);
+static usb_sts_type keyboard_report_push(void *udev, const uint8_t *report, uint16_t len, hid_report_merge_type merge);
+
 keyboard_type keyboard_struct;
+
+/* keyboard endpoint address */
+keyboard_ept_type keyboard_ept =
+{
+  USBD_KEYBOARD_IN_EPT
+};
 #define SHIFT 0x80
 const static unsigned char _asciimap[128] =
 {
@@ -208,13 +219,15 @@ static usb_sts_type class_init_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
 
   /* open hid in endpoint */
-  usbd_ept_open(pudev, USBD_KEYBOARD_IN_EPT, EPT_INT_TYPE, USBD_KEYBOARD_IN_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, keyboard_ept.in_ept, EPT_INT_TYPE, USBD_KEYBOARD_IN_MAXPACKET_SIZE);
 
-  pkeyboard->g_u8tx_completed = 1;
-  pkeyboard->send_state = 0;
+  hid_report_queue_init(&pkeyboard->report_queue, keyboard_ept.in_ept, pkeyboard->report_buffer[0],
+                        USBD_KEYBOARD_REPORT_QUEUE_DEPTH, USBD_KEYBOARD_REPORT_SIZE);
+  keyboard_report_copy(pkeyboard->key_state, NULL);
+  keyboard_report_copy(pkeyboard->prev_state, NULL);
 
   return status;
 }
@@ -228,9 +241,12 @@ static usb_sts_type class_clear_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
 
   /* close hid in endpoint */
-  usbd_ept_close(pudev, USBD_KEYBOARD_IN_EPT);
+  usbd_ept_close(pudev, keyboard_ept.in_ept);
+
+  hid_report_queue_flush(&pkeyboard->report_queue);
 
   return status;
 }
@@ -245,7 +261,7 @@ static usb_sts_type class_setup_handler(void *udev, usb_setup_type *setup)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
   uint16_t len;
   uint8_t *buf;
 
@@ -343,7 +359,7 @@ static usb_sts_type class_ept0_rx_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
   uint32_t recv_len = usbd_get_recv_len(pudev, 0);
   /* ...user code... */
   if( pkeyboard->hid_state == HID_REQ_SET_REPORT)
@@ -365,13 +381,10 @@ static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
 
-  /* ...user code...
-    trans next packet data
-  */
-  pkeyboard->g_u8tx_completed = 1;
-  pkeyboard->send_state = 0;
+  /* send the next queued report */
+  hid_report_queue_in_complete(&pkeyboard->report_queue, pudev);
 
   return status;
 }
@@ -412,8 +425,7 @@ static usb_sts_type class_sof_handler(void *udev)
 static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
 {
   usb_sts_type status = USB_OK;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
   switch(event)
   {
     case USBD_RESET_EVENT:
@@ -437,72 +449,266 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
 }
 
 /**
-  * @brief  usb device class send report
+  * @brief  copy a keyboard report
+  * @param  dst: destination report
+  * @param  src: source report, NULL for a report with no key pressed
+  * @retval none
+  */
+static void keyboard_report_copy(uint8_t *dst, const uint8_t *src)
+{
+  uint8_t index;
+
+  for(index = 0; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+  {
+    dst[index] = (src != NULL) ? src[index] : 0;
+  }
+}
+
+/**
+  * @brief  check if a key is in the key array of a keyboard report
+  * @param  report: keyboard report
+  * @param  key: key code
+  * @retval TRUE when the key is pressed
+  */
+static confirm_state keyboard_report_has(const uint8_t *report, uint8_t key)
+{
+  uint8_t index;
+
+  for(index = 2; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+  {
+    if(report[index] == key)
+    {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  * @brief  merge a key event into the report at the tail of the queue. the host
+  *         then goes from prev_state to report in one step, which gives the same
+  *         input when no key or modifier changes twice, at most one key is newly
+  *         pressed (their order would be lost) and no modifier changes after a
+  *         key press (hosts apply the modifier byte before the key array).
+  * @param  arg: keyboard_type
+  * @param  tail: report at the tail of the queue
+  * @param  tail_len: length of the tail report
+  * @param  report: new keyboard state
+  * @param  len: report length
+  * @retval TRUE when report replaced tail
+  */
+static confirm_state keyboard_report_merge(void *arg, uint8_t *tail, uint16_t *tail_len, const uint8_t *report, uint16_t len)
+{
+  keyboard_type *pkeyboard = (keyboard_type *)arg;
+  const uint8_t *prev = pkeyboard->prev_state;
+  uint8_t index, key, tail_press = 0, press = 0;
+
+  if(((prev[0] ^ tail[0]) & (tail[0] ^ report[0])) != 0)
+  {
+    return FALSE;
+  }
+
+  for(index = 2; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+  {
+    /* pressed by the tail, must not be released again */
+    key = tail[index];
+    if(key != 0 && keyboard_report_has(prev, key) == FALSE)
+    {
+      if(keyboard_report_has(report, key) == FALSE)
+      {
+        return FALSE;
+      }
+      tail_press++;
+    }
+
+    /* released by the tail, must not be pressed again */
+    key = prev[index];
+    if(key != 0 && keyboard_report_has(tail, key) == FALSE && keyboard_report_has(report, key) == TRUE)
+    {
+      return FALSE;
+    }
+
+    key = report[index];
+    if(key != 0 && keyboard_report_has(prev, key) == FALSE)
+    {
+      press++;
+    }
+  }
+
+  if(press > 1 || (tail_press != 0 && tail[0] != report[0]))
+  {
+    return FALSE;
+  }
+
+  keyboard_report_copy(tail, report);
+  *tail_len = len;
+
+  return TRUE;
+}
+
+/**
+  * @brief  queue a keyboard report and track the key state
   * @param  udev: to the structure of usbd_core_type
-  * @param  report: report buffer
+  * @param  report: keyboard report
   * @param  len: report length
+  * @param  merge: merge callback, NULL to always queue the report on its own
   * @retval status of usb_sts_type
   */
-usb_sts_type usb_keyboard_class_send_report(void *udev, uint8_t *report, uint16_t len)
+static usb_sts_type keyboard_report_push(void *udev, const uint8_t *report, uint16_t len, hid_report_merge_type merge)
 {
-  usb_sts_type status = USB_FAIL;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
-  
-  if(usbd_connect_state_get(pudev) == USB_CONN_STATE_CONFIGURED && pkeyboard->send_state == 0)
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
+
+  switch(hid_report_queue_push(&pkeyboard->report_queue, pudev, report, len, merge, pkeyboard))
   {
-    pkeyboard->send_state = 1;
-    usbd_ept_send(pudev, USBD_KEYBOARD_IN_EPT, report, len);
-    status = USB_OK;
+    case HID_REPORT_QUEUED:
+      keyboard_report_copy(pkeyboard->prev_state, pkeyboard->key_state);
+      break;
+    case HID_REPORT_MERGED:
+      break;
+    default:
+      return USB_FAIL;
   }
 
-  return status;
+  keyboard_report_copy(pkeyboard->key_state, report);
+
+  return USB_OK;
 }
 
+/**
+  * @brief  usb device class send report, the report is queued as is and sent
+  *         after the reports already queued
+  * @param  udev: to the structure of usbd_core_type
+  * @param  report: report buffer
+  * @param  len: report length
+  * @retval status of usb_sts_type
+  */
+usb_sts_type usb_keyboard_class_send_report(void *udev, uint8_t *report, uint16_t len)
+{
+  if(len < USBD_KEYBOARD_REPORT_SIZE)
+  {
+    return USB_FAIL;
+  }
+
+  return keyboard_report_push(udev, report, USBD_KEYBOARD_REPORT_SIZE, NULL);
+}
 
 /**
-  * @brief  usb device class report function
+  * @brief  press or release a key, events queued while the endpoint is busy are
+  *         merged into as few reports as possible. key events and reports are
+  *         sent from thread level only, the key state is not protected.
   * @param  udev: to the structure of usbd_core_type
-  * @param  op: operation
-  * @retval none
+  * @param  key: key code, KEYBOARD_KEY_LEFT_CTRL to KEYBOARD_KEY_RIGHT_GUI are
+  *         reported as modifier bits
+  * @param  pressed: TRUE to press, FALSE to release
+  * @retval status of usb_sts_type, USB_FAIL when the queue is full, the device
+  *         is not configured or USBD_KEYBOARD_REPORT_KEYS keys are already pressed
   */
-void usb_hid_keyboard_send_char(void *udev, uint8_t ascii_code)
+usb_sts_type usb_hid_keyboard_key_event(void *udev, uint8_t key, confirm_state pressed)
 {
-  uint8_t key_data = 0;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
+  uint8_t report[USBD_KEYBOARD_REPORT_SIZE];
+  uint8_t index, count = 2;
+
+  keyboard_report_copy(report, pkeyboard->key_state);
 
-  if(ascii_code > 128)
+  if(key >= KEYBOARD_KEY_LEFT_CTRL && key <= KEYBOARD_KEY_RIGHT_GUI)
   {
-    ascii_code = 0;
+    if(pressed == TRUE)
+    {
+      report[0] |= (uint8_t)(1 << (key - KEYBOARD_KEY_LEFT_CTRL));
+    }
+    else
+    {
+      report[0] &= (uint8_t)~(1 << (key - KEYBOARD_KEY_LEFT_CTRL));
+    }
+  }
+  else if(key != 0)
+  {
+    /* remove the key and keep the array packed */
+    for(index = 2; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+    {
+      if(report[index] != 0 && report[index] != key)
+      {
+        report[count++] = report[index];
+      }
+    }
+    for(index = count; index < USBD_KEYBOARD_REPORT_SIZE; index++)
+    {
+      report[index] = 0;
+    }
+
+    if(pressed == TRUE)
+    {
+      if(count == 2 + USBD_KEYBOARD_REPORT_KEYS)
+      {
+        return USB_FAIL;
+      }
+      report[count] = key;
+    }
   }
-  else
+
+  for(index = 0; index < USBD_KEYBOARD_REPORT_SIZE; index++)
   {
-    ascii_code = _asciimap[ascii_code];
-    if(!ascii_code)
+    if(report[index] != pkeyboard->key_state[index])
     {
-      ascii_code = 0;
+      return keyboard_report_push(udev, report, USBD_KEYBOARD_REPORT_SIZE, keyboard_report_merge);
     }
+  }
+
+  return USB_OK;
+}
 
-    if(ascii_code & SHIFT)
+/**
+  * @brief  type an ascii character, queues the key press and release
+  * @param  udev: to the structure of usbd_core_type
+  * @param  ascii_code: character, 0 or a character without key releases all keys
+  * @retval status of usb_sts_type, USB_FAIL when there is no room for the
+  *         whole character, nothing is queued then
+  */
+usb_sts_type usb_hid_keyboard_send_char(void *udev, uint8_t ascii_code)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  keyboard_type *pkeyboard = (keyboard_type *)keyboard_class_handler.pdata;
+  uint8_t key = 0, shift = 0;
+  uint8_t report[USBD_KEYBOARD_REPORT_SIZE];
+
+  if(ascii_code < 128)
+  {
+    key = _asciimap[ascii_code];
+    if(key & SHIFT)
     {
-      key_data = 0x2;
-      ascii_code &= 0x7F;
+      shift = 1;
+      key &= 0x7F;
     }
   }
 
-  if((pkeyboard->temp == ascii_code) && (ascii_code != 0))
+  if(key == 0)
   {
-    pkeyboard->keyboard_buf[0] = 0;
-    pkeyboard->keyboard_buf[2] = 0;
-    usb_keyboard_class_send_report(udev, pkeyboard->keyboard_buf, 8);
+    keyboard_report_copy(report, NULL);
+    return keyboard_report_push(udev, report, USBD_KEYBOARD_REPORT_SIZE, keyboard_report_merge);
   }
-  else
+
+  /* worst case every event needs its own report */
+  if(usbd_connect_state_get(pudev) != USB_CONN_STATE_CONFIGURED ||
+     hid_report_queue_free(&pkeyboard->report_queue) < (shift ? 4 : 2))
+  {
+    return USB_FAIL;
+  }
+
+  if(shift)
   {
-    pkeyboard->keyboard_buf[0] = key_data;
-    pkeyboard->keyboard_buf[2] = ascii_code;
-    usb_keyboard_class_send_report(udev, pkeyboard->keyboard_buf, 8);
+    usb_hid_keyboard_key_event(udev, KEYBOARD_KEY_LEFT_SHIFT, TRUE);
   }
+  usb_hid_keyboard_key_event(udev, key, TRUE);
+  usb_hid_keyboard_key_event(udev, key, FALSE);
+  if(shift)
+  {
+    usb_hid_keyboard_key_event(udev, KEYBOARD_KEY_LEFT_SHIFT, FALSE);
+  }
+
+  return USB_OK;
 }
 
 
@@ -33,6 +33,7 @@ extern "C" {
 
 #include "usb_std.h"
 #include "usbd_core.h"
+#include "hid_report_queue.h"
 
 /** @addtogroup AT32F415_middlewares_usbd_class
   * @{
@@ -57,6 +58,23 @@ extern "C" {
 #define USBD_KEYBOARD_IN_MAXPACKET_SIZE       0x40
 #define USBD_KEYBOARD_OUT_MAXPACKET_SIZE      0x40
 
+/**
+  * @brief boot keyboard report (modifiers, reserved, 6 key codes) and the number
+  *        of reports buffered while the endpoint is busy
+  */
+#define USBD_KEYBOARD_REPORT_SIZE             8
+#define USBD_KEYBOARD_REPORT_KEYS             6
+#ifndef USBD_KEYBOARD_REPORT_QUEUE_DEPTH
+#define USBD_KEYBOARD_REPORT_QUEUE_DEPTH      16
+#endif
+
+/**
+  * @brief modifier key codes, reported as bits of the first report byte
+  */
+#define KEYBOARD_KEY_LEFT_CTRL                0xE0
+#define KEYBOARD_KEY_LEFT_SHIFT               0xE1
+#define KEYBOARD_KEY_RIGHT_GUI                0xE7
+
 /**
   * @}
   */
@@ -68,23 +86,35 @@ typedef struct
   uint32_t hid_set_idle;
   uint32_t alt_setting;
   uint8_t hid_set_report[64];
-  uint8_t keyboard_buf[8];
+
+  hid_report_queue_type report_queue;
+  uint8_t report_buffer[USBD_KEYBOARD_REPORT_QUEUE_DEPTH][USBD_KEYBOARD_REPORT_SIZE];
+  uint8_t key_state[USBD_KEYBOARD_REPORT_SIZE];
+  uint8_t prev_state[USBD_KEYBOARD_REPORT_SIZE];
 
   __IO uint8_t hid_suspend_flag;
-  __IO uint8_t g_u8tx_completed;
-  uint8_t send_state;
   uint8_t hid_state;
-  uint8_t temp;
 
 }keyboard_type;
 
+/**
+  * @brief usb keyboard endpoint address, the define above unless a composite
+  *        device assigns another
+  */
+typedef struct
+{
+  uint8_t in_ept;
+}keyboard_ept_type;
+
 /** @defgroup USB_hid_class_exported_functions
   * @{
   */
 extern usbd_class_handler keyboard_class_handler;
+extern keyboard_ept_type keyboard_ept;
 
 usb_sts_type usb_keyboard_class_send_report(void *udev, uint8_t *report, uint16_t len);
-void usb_hid_keyboard_send_char(void *udev, uint8_t ascii_code);
+usb_sts_type usb_hid_keyboard_key_event(void *udev, uint8_t key, confirm_state pressed);
+usb_sts_type usb_hid_keyboard_send_char(void *udev, uint8_t ascii_code);
 /**
   * @}
   */
@@ -49,6 +49,8 @@ static usb_sts_type class_out_handler(void *udev, uint8_t ept_num);
 static usb_sts_type class_sof_handler(void *udev);
 static usb_sts_type class_event_handler(void *udev, usbd_event_type event);
 
+static confirm_state mouse_report_merge(void *arg, uint8_t *tail, uint16_t *tail_len, const uint8_t *report, uint16_t len);
+
 mouse_type mouse_struct;
 
 /* usb device class handler */
@@ -79,8 +81,9 @@ static usb_sts_type class_init_handler(void *udev)
 
   /* open hid in endpoint */
   usbd_ept_open(pudev, USBD_MOUSE_IN_EPT, EPT_INT_TYPE, USBD_MOUSE_IN_MAXPACKET_SIZE);
-  
-  pmouse->send_state = 0;
+
+  hid_report_queue_init(&pmouse->report_queue, USBD_MOUSE_IN_EPT, pmouse->report_buffer[0],
+                        USBD_MOUSE_REPORT_QUEUE_DEPTH, USBD_MOUSE_REPORT_SIZE);
 
   return status;
 }
@@ -94,10 +97,13 @@ static usb_sts_type class_clear_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
+  mouse_type *pmouse = (mouse_type *)pudev->class_handler->pdata;
 
   /* close hid in endpoint */
   usbd_ept_close(pudev, USBD_MOUSE_IN_EPT);
 
+  hid_report_queue_flush(&pmouse->report_queue);
+
   return status;
 }
 
@@ -233,10 +239,8 @@ static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
   usbd_core_type *pudev = (usbd_core_type *)udev;
   mouse_type *pmouse = (mouse_type *)pudev->class_handler->pdata;
 
-  /* ...user code...
-    trans next packet data
-  */
-  pmouse->send_state = 0;
+  /* send the next queued report */
+  hid_report_queue_in_complete(&pmouse->report_queue, pudev);
   return status;
 }
 
@@ -301,7 +305,45 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
 }
 
 /**
-  * @brief  usb device class send report
+  * @brief  merge a report into the report at the tail of the queue, movements
+  *         with the same buttons are added while they fit in a report
+  * @param  arg: mouse_type
+  * @param  tail: report at the tail of the queue
+  * @param  tail_len: length of the tail report
+  * @param  report: new report
+  * @param  len: report length
+  * @retval TRUE when report was added to tail
+  */
+static confirm_state mouse_report_merge(void *arg, uint8_t *tail, uint16_t *tail_len, const uint8_t *report, uint16_t len)
+{
+  int16_t sum[USBD_MOUSE_REPORT_SIZE];
+  uint8_t index;
+
+  if(len != USBD_MOUSE_REPORT_SIZE || *tail_len != USBD_MOUSE_REPORT_SIZE || tail[0] != report[0])
+  {
+    return FALSE;
+  }
+
+  for(index = 1; index < USBD_MOUSE_REPORT_SIZE; index++)
+  {
+    sum[index] = (int16_t)(int8_t)tail[index] + (int8_t)report[index];
+    if(sum[index] > 127 || sum[index] < -127)
+    {
+      return FALSE;
+    }
+  }
+
+  for(index = 1; index < USBD_MOUSE_REPORT_SIZE; index++)
+  {
+    tail[index] = (uint8_t)sum[index];
+  }
+
+  return TRUE;
+}
+
+/**
+  * @brief  usb device class send report, the report is queued as is and sent
+  *         after the reports already queued
   * @param  udev: to the structure of usbd_core_type
   * @param  report: report buffer
   * @param  len: report length
@@ -309,18 +351,64 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
   */
 usb_sts_type usb_mouse_class_send_report(void *udev, uint8_t *report, uint16_t len)
 {
-  usb_sts_type status = USB_FAIL;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   mouse_type *pmouse = (mouse_type *)pudev->class_handler->pdata;
 
-  if(usbd_connect_state_get(pudev) == USB_CONN_STATE_CONFIGURED && pmouse->send_state == 0)
+  if(hid_report_queue_push(&pmouse->report_queue, pudev, report, len, NULL, NULL) != HID_REPORT_QUEUED)
   {
-    pmouse->send_state = 1;
-    usbd_ept_send(pudev, USBD_MOUSE_IN_EPT, report, len);
-    status = USB_OK;
+    return USB_FAIL;
   }
 
-  return status;
+  return USB_OK;
+}
+
+/**
+  * @brief  report buttons and movement. movements are added to the queued report
+  *         while the buttons do not change, so no motion is lost when the host
+  *         polls slower than the sensor is read. large movements are split.
+  * @param  udev: to the structure of usbd_core_type
+  * @param  button: button bits
+  * @param  x: x movement
+  * @param  y: y movement
+  * @param  wheel: wheel movement
+  * @retval status of usb_sts_type, USB_FAIL when the queue is full or the
+  *         device is not configured
+  */
+usb_sts_type usb_hid_mouse_report(void *udev, uint8_t button, int16_t x, int16_t y, int8_t wheel)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  mouse_type *pmouse = (mouse_type *)pudev->class_handler->pdata;
+  uint8_t report[USBD_MOUSE_REPORT_SIZE];
+  hid_report_result_type result;
+  int16_t step_x, step_y;
+
+  if(wheel < -127)
+  {
+    wheel = -127;
+  }
+
+  do
+  {
+    step_x = (x > 127) ? 127 : ((x < -127) ? -127 : x);
+    step_y = (y > 127) ? 127 : ((y < -127) ? -127 : y);
+
+    report[0] = button;
+    report[1] = (uint8_t)step_x;
+    report[2] = (uint8_t)step_y;
+    report[3] = (uint8_t)wheel;
+
+    result = hid_report_queue_push(&pmouse->report_queue, pudev, report, USBD_MOUSE_REPORT_SIZE, mouse_report_merge, pmouse);
+    if(result != HID_REPORT_QUEUED && result != HID_REPORT_MERGED)
+    {
+      return USB_FAIL;
+    }
+
+    x -= step_x;
+    y -= step_y;
+    wheel = 0;
+  } while(x != 0 || y != 0);
+
+  return USB_OK;
 }
 
 /**
@@ -331,8 +419,6 @@ usb_sts_type usb_mouse_class_send_report(void *udev, uint8_t *report, uint16_t l
   */
 void usb_hid_mouse_send(void *udev, uint8_t op)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  mouse_type *pmouse = (mouse_type *)pudev->class_handler->pdata;
   int8_t posx = 0, posy = 0, button = 0;
   switch(op)
   {
@@ -363,11 +449,7 @@ void usb_hid_mouse_send(void *udev, uint8_t op)
     default:
       break;
   }
-  pmouse->mouse_buffer[0] = button;
-  pmouse->mouse_buffer[1] = posx;
-  pmouse->mouse_buffer[2] = posy;
-
-  usb_mouse_class_send_report(udev, pmouse->mouse_buffer, 4);
+  usb_hid_mouse_report(udev, button, posx, posy, 0);
 }
 
 /**
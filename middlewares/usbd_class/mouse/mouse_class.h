@@ -33,6 +33,7 @@ extern "C" {
 
 #include "usb_std.h"
 #include "usbd_core.h"
+#include "hid_report_queue.h"
 
 /** @addtogroup AT32F415_middlewares_usbd_class
   * @{
@@ -56,6 +57,15 @@ extern "C" {
   */
 #define USBD_MOUSE_IN_MAXPACKET_SIZE        0x40
 
+/**
+  * @brief mouse report (buttons, x, y, wheel) and the number of reports buffered
+  *        while the endpoint is busy
+  */
+#define USBD_MOUSE_REPORT_SIZE              4
+#ifndef USBD_MOUSE_REPORT_QUEUE_DEPTH
+#define USBD_MOUSE_REPORT_QUEUE_DEPTH       8
+#endif
+
 /**
   * @}
   */
@@ -85,10 +95,12 @@ typedef struct
   uint32_t alt_setting;
 
   uint8_t hid_set_report[64];
-  uint8_t mouse_buffer[4];
+
+  hid_report_queue_type report_queue;
+  uint8_t report_buffer[USBD_MOUSE_REPORT_QUEUE_DEPTH][USBD_MOUSE_REPORT_SIZE];
+
   uint8_t hid_state;
   __IO uint8_t hid_suspend_flag;
-  uint8_t send_state;
 }mouse_type;
 
 /**
@@ -100,6 +112,7 @@ typedef struct
   */
 extern usbd_class_handler mouse_class_handler;
 usb_sts_type usb_mouse_class_send_report(void *udev, uint8_t *report, uint16_t len);
+usb_sts_type usb_hid_mouse_report(void *udev, uint8_t button, int16_t x, int16_t y, int8_t wheel);
 void usb_hid_mouse_send(void *udev, uint8_t op);
 /**
   * @}
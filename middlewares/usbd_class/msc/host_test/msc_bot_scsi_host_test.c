@@ -0,0 +1,715 @@
+/**
+  **************************************************************************
+  * @file     msc_bot_scsi_host_test.c
+  * @brief    host cbw replay test of the msc bulk only transport and scsi commands
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * replays command blocks through the bulk only transport state machine of
+ * msc_bot_scsi.c against a ram disk of DISK_BLOCKS 512 byte blocks, with the
+ * usb_conf.h of the msc_spi_flash example (write cache and unmap on). the
+ * host model sends the cbw, moves the data phase a packet buffer at a time,
+ * clears a stalled in endpoint and takes the csw.
+ * - identification: inquiry and its vpd pages, read capacity 10 and 16 with
+ *   lbpme, mode sense 6 and 10 with the caching page and wce.
+ * - write cache: writes are acknowledged before they reach the disk, a read
+ *   of cached blocks flushes first, consecutive writes merge up to the cache
+ *   size, synchronize cache 10 and 16 and the idle timer flush, a newer
+ *   overlapping write wins, fua writes go to the disk.
+ * - unmap: cached blocks in the range are written first, a range past the
+ *   end rejects the whole list.
+ * - errors: out of range and wrapping lba, zero length transfers, a failed
+ *   background flush is reported once by the next synchronize cache, with
+ *   the sense data at its fixed format offsets.
+ * - RANDOM_COMMANDS random reads, writes, unmaps, syncs and idle periods
+ *   against a shadow image.
+ * built with two luns, lun 1 is a second ram disk of LUN1_BLOCKS 2048 byte
+ * blocks that can be removed:
+ * - every lun reports its own inquiry and capacity, a cbw for a lun past
+ *   MSC_SUPPORT_MAX_LUN is invalid.
+ * - isolation: sense data and not ready are kept per lun, a removed medium
+ *   fails only its own lun, cached blocks of one lun are never read back or
+ *   written on the other, the backends are only called for their own lun.
+ * - RANDOM_COMMANDS interleaved commands on both luns against two shadow
+ *   images.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msc_bot_scsi.h"
+#include "msc_diskio.h"
+
+#define DISK_BLOCKS                      1024
+#define BLOCK_SIZE                       512
+#define RANDOM_COMMANDS                  20000
+#define UNMAPPED                         0xEE
+#define LUN1_BLOCKS                      256
+#define LUN1_BLOCK_SIZE                  2048
+
+msc_type msc_struct;
+msc_ept_type msc_ept = {0x81, 0x01};
+usbd_class_handler msc_class_handler;
+static usbd_core_type dev;
+
+static uint8_t disk[DISK_BLOCKS * BLOCK_SIZE], shadow[DISK_BLOCKS * BLOCK_SIZE];
+static uint8_t lun1_disk[LUN1_BLOCKS * LUN1_BLOCK_SIZE], lun1_shadow[LUN1_BLOCKS * LUN1_BLOCK_SIZE];
+static uint8_t lun1_present = 1, host_lun;
+static uint32_t disk_writes, disk_write_bytes[4096], unmaps, fail_write;
+static uint64_t unmap_addr[64], unmap_len[64];
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* the bulk endpoints, the host side keeps what the device armed or sent */
+static uint8_t *rx_buffer, in_data[65536], csw[13];
+static uint32_t rx_len, rx_armed, rx_got, in_len, in_pending, csw_sent, stalled_in;
+
+void usbd_ept_send(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+  if(len == 13 && buffer == (uint8_t *)&msc_struct.csw_struct)
+  {
+    memcpy(csw, buffer, 13);
+    csw_sent = 1;
+    return;
+  }
+  memcpy(in_data + in_len, buffer, len);
+  in_len += len;
+  in_pending = 1;
+}
+
+void usbd_ept_recv(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+  rx_buffer = buffer;
+  rx_len = len;
+  rx_armed = 1;
+}
+
+uint32_t usbd_get_recv_len(usbd_core_type *udev, uint8_t ept_addr)
+{
+  return rx_got;
+}
+
+void usbd_set_stall(usbd_core_type *udev, uint8_t ept_addr)
+{
+  if(ept_addr & 0x80)
+  {
+    stalled_in = 1;
+  }
+}
+
+void usbd_flush_tx_fifo(usbd_core_type *udev, uint8_t ept_num)
+{
+}
+
+/* the ram disks, lun 1 only while its medium is present */
+static uint8_t inquiry_data[2][36] = {{0, 0x80, 0, 1, 31, 0, 0, 0, 'L', '0'}, {0, 0x80, 0, 1, 31, 0, 0, 0, 'L', '1'}};
+
+static uint8_t *lun_disk(uint8_t lun, uint64_t addr, uint64_t len)
+{
+  CHECK(lun < MSC_SUPPORT_MAX_LUN && (lun == 0 || lun1_present != 0));
+  if(lun == 1 && addr + len <= sizeof(lun1_disk) && (len % LUN1_BLOCK_SIZE) == 0)
+  {
+    return lun1_disk + addr;
+  }
+  if(lun == 0 && addr + len <= sizeof(disk) && (len % BLOCK_SIZE) == 0)
+  {
+    return disk + addr;
+  }
+  printf("disk access out of range, lun %u\n", lun);
+  exit(1);
+}
+
+uint8_t *get_inquiry(uint8_t lun)
+{
+  return (lun < 2) ? inquiry_data[lun] : NULL;
+}
+
+usb_sts_type msc_disk_read(uint8_t lun, uint64_t addr, uint8_t *read_buf, uint32_t len)
+{
+  memcpy(read_buf, lun_disk(lun, addr, len), len);
+  return USB_OK;
+}
+
+usb_sts_type msc_disk_write(uint8_t lun, uint64_t addr, uint8_t *buf, uint32_t len)
+{
+  if(fail_write)
+  {
+    return USB_FAIL;
+  }
+  memcpy(lun_disk(lun, addr, len), buf, len);
+  disk_write_bytes[disk_writes++ % 4096] = len;
+  return USB_OK;
+}
+
+usb_sts_type msc_disk_unmap(uint8_t lun, uint64_t addr, uint64_t len)
+{
+  unmap_addr[unmaps % 64] = addr;
+  unmap_len[unmaps % 64] = len;
+  unmaps++;
+  memset(lun_disk(lun, addr, len), UNMAPPED, len);
+  return USB_OK;
+}
+
+usb_sts_type msc_disk_capacity(uint8_t lun, uint32_t *blk_nbr, uint32_t *blk_size)
+{
+  if(lun == 1 && lun1_present != 0)
+  {
+    *blk_nbr = LUN1_BLOCKS;
+    *blk_size = LUN1_BLOCK_SIZE;
+    return USB_OK;
+  }
+  if(lun == 0)
+  {
+    *blk_nbr = DISK_BLOCKS;
+    *blk_size = BLOCK_SIZE;
+    return USB_OK;
+  }
+  return USB_FAIL;
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static void put_be(uint8_t *p, uint64_t value, int len)
+{
+  while(len--)
+  {
+    p[len] = (uint8_t)value;
+    value >>= 8;
+  }
+}
+
+static void fill(uint8_t *buffer, uint32_t len, uint32_t seed)
+{
+  uint32_t index;
+
+  for(index = 0; index < len; index++)
+  {
+    buffer[index] = (uint8_t)(seed * 131 + index * 7 + (index >> 9));
+  }
+}
+
+/* one command to host_lun: the cbw, its data phase and the csw. returns the
+   csw status, -1 when the device stalled an invalid cbw */
+static uint32_t tag = 1;
+
+static int command(const uint8_t *cdb, int cdb_len, int dir_in, uint8_t *data, uint32_t data_len)
+{
+  cbw_type cbw;
+  uint32_t done = 0, len, guard;
+
+  memset(&cbw, 0, sizeof(cbw));
+  cbw.dCBWSignature = CBW_DCBWSIGNATURE;
+  cbw.dCBWTage = tag++;
+  cbw.dCBWDataTransferLength = data_len;
+  cbw.bmCBWFlags = dir_in ? 0x80 : 0;
+  cbw.bCBWLUN = host_lun;
+  cbw.bCBWCBLength = cdb_len;
+  memcpy(cbw.CBWCB, cdb, cdb_len);
+  if(rx_armed == 0 || rx_len < 31)
+  {
+    printf("no cbw receive armed\n");
+    exit(1);
+  }
+  memcpy(rx_buffer, &cbw, 31);
+  rx_got = 31;
+  rx_armed = 0;
+  csw_sent = 0;
+  in_len = 0;
+  in_pending = 0;
+  stalled_in = 0;
+  bot_scsi_dataout_handler(&dev, 1);
+
+  for(guard = 0; guard < 100000 && csw_sent == 0; guard++)
+  {
+    if(stalled_in && msc_struct.bot_status == MSC_BOT_STATE_ERROR)
+    {
+      /* the host goes through reset recovery */
+      return -1;
+    }
+    if(stalled_in)
+    {
+      stalled_in = 0;
+      bot_scsi_clear_feature(&dev, 0x81);
+    }
+    else if(in_pending)
+    {
+      in_pending = 0;
+      bot_scsi_datain_handler(&dev, 1);
+    }
+    else if(rx_armed && dir_in == 0 && done < data_len)
+    {
+      len = (rx_len < data_len - done) ? rx_len : data_len - done;
+      memcpy(rx_buffer, data + done, len);
+      done += len;
+      rx_got = len;
+      rx_armed = 0;
+      bot_scsi_dataout_handler(&dev, 1);
+    }
+    else
+    {
+      break;
+    }
+  }
+  if(csw_sent == 0)
+  {
+    printf("no csw, tag %u opcode %02x\n", cbw.dCBWTage, cdb[0]);
+    exit(1);
+  }
+  if(dir_in && data != NULL)
+  {
+    memcpy(data, in_data, (in_len < data_len) ? in_len : data_len);
+  }
+  return csw[12];
+}
+
+static int read_write(uint8_t opcode, uint64_t lba, uint32_t count, uint8_t *buffer, int fua)
+{
+  uint8_t cdb[16] = {opcode};
+  int len = 10;
+
+  if(opcode == MSC_CMD_READ_10 || opcode == MSC_CMD_WRITE_10)
+  {
+    put_be(cdb + 2, lba, 4);
+    put_be(cdb + 7, count, 2);
+  }
+  else if(opcode == MSC_CMD_READ_12 || opcode == MSC_CMD_WRITE_12)
+  {
+    put_be(cdb + 2, lba, 4);
+    put_be(cdb + 6, count, 4);
+    len = 12;
+  }
+  else
+  {
+    put_be(cdb + 2, lba, 8);
+    put_be(cdb + 10, count, 4);
+    len = 16;
+  }
+  if(fua)
+  {
+    cdb[1] = 0x08;
+  }
+  return command(cdb, len, opcode == MSC_CMD_READ_10 || opcode == MSC_CMD_READ_12 || opcode == MSC_CMD_READ_16,
+                 buffer, count * ((host_lun == 1) ? LUN1_BLOCK_SIZE : BLOCK_SIZE));
+}
+
+static int no_data(uint8_t opcode)
+{
+  uint8_t cdb[16] = {opcode};
+
+  return command(cdb, (opcode == MSC_CMD_SYNC_CACHE_16) ? 16 : 10, 0, NULL, 0);
+}
+
+static int request_sense(uint8_t *key, uint8_t *asc)
+{
+  uint8_t cdb[6] = {MSC_CMD_REQUEST_SENSE, 0, 0, 0, 18}, data[18];
+  int status = command(cdb, 6, 1, data, 18);
+
+  *key = data[2];
+  *asc = data[12];
+  return status;
+}
+
+static int unmap(int count, const uint64_t *lba, const uint32_t *blocks)
+{
+  uint8_t data[8 + 16 * 8] = {0}, cdb[10] = {MSC_CMD_UNMAP};
+  int index;
+
+  put_be(data, 6 + 16 * count, 2);
+  put_be(data + 2, 16 * count, 2);
+  for(index = 0; index < count; index++)
+  {
+    put_be(data + 8 + 16 * index, lba[index], 8);
+    put_be(data + 16 + 16 * index, blocks[index], 4);
+  }
+  put_be(cdb + 7, 8 + 16 * count, 2);
+  return command(cdb, 10, 0, data, 8 + 16 * count);
+}
+
+static void identification_test(void)
+{
+  uint8_t data[64];
+
+  {
+    uint8_t cdb[6] = {MSC_CMD_INQUIRY, 0, 0, 0, 36};
+    CHECK(command(cdb, 6, 1, data, 36) == 0);
+  }
+  {
+    /* block limits */
+    uint8_t cdb[6] = {MSC_CMD_INQUIRY, 1, 0xB0, 0, 64};
+    CHECK(command(cdb, 6, 1, data, 64) == 0 && data[1] == 0xB0 && data[27] == MSC_UNMAP_DESCRIPTOR_MAX);
+  }
+  {
+    /* logical block provisioning, lbpu */
+    uint8_t cdb[6] = {MSC_CMD_INQUIRY, 1, 0xB2, 0, 8};
+    CHECK(command(cdb, 6, 1, data, 8) == 0 && (data[5] & 0x80) != 0);
+  }
+  {
+    /* supported pages */
+    uint8_t cdb[6] = {MSC_CMD_INQUIRY, 1, 0x00, 0, 7};
+    CHECK(command(cdb, 6, 1, data, 7) == 0 && data[3] == 3 && data[5] == 0xB0);
+  }
+  {
+    uint8_t cdb[6] = {MSC_CMD_INQUIRY, 1, 0x83, 0, 8};
+    CHECK(command(cdb, 6, 1, data, 8) == 1);
+  }
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == 0);
+  {
+    uint8_t cdb[10] = {MSC_CMD_READ_CAPACITY};
+    CHECK(command(cdb, 10, 1, data, 8) == 0 && data[2] == 0x03 && data[3] == 0xFF);
+  }
+  {
+    /* last lba, block size and lbpme */
+    uint8_t cdb[16] = {MSC_CMD_SERVICE_ACTION_IN, MSC_SA_READ_CAPACITY_16};
+    put_be(cdb + 10, 32, 4);
+    CHECK(command(cdb, 16, 1, data, 32) == 0 && data[6] == 0x03 && data[7] == 0xFF && data[10] == 2 && (data[14] & 0x80) != 0);
+  }
+  {
+    /* caching page with wce */
+    uint8_t cdb[6] = {MSC_CMD_MODE_SENSE6, 0, 0x3F, 0, 64};
+    CHECK(command(cdb, 6, 1, data, 24) == 0 && data[0] == 23 && data[4] == 0x08 && (data[6] & 0x04) != 0);
+  }
+  {
+    uint8_t cdb[10] = {MSC_CMD_MODE_SENSE10, 0, 0x08};
+    put_be(cdb + 7, 28, 2);
+    CHECK(command(cdb, 10, 1, data, 28) == 0 && data[1] == 26 && data[8] == 0x08 && (data[10] & 0x04) != 0);
+  }
+}
+
+static void cache_test(void)
+{
+  static uint8_t buffer[65536], buffer2[65536];
+  uint32_t index;
+
+  /* a write is acknowledged from the cache, reading it back flushes first */
+  fill(buffer, 8 * BLOCK_SIZE, 1);
+  disk_writes = 0;
+  CHECK(read_write(MSC_CMD_WRITE_10, 100, 8, buffer, 0) == 0);
+  CHECK(disk_writes == 0);
+  CHECK(read_write(MSC_CMD_READ_10, 100, 8, buffer2, 0) == 0 && memcmp(buffer, buffer2, 8 * BLOCK_SIZE) == 0);
+  CHECK(disk_writes == 1 && memcmp(disk + 100 * BLOCK_SIZE, buffer, 8 * BLOCK_SIZE) == 0);
+
+  /* consecutive writes merge up to the cache size */
+  disk_writes = 0;
+  for(index = 0; index < 16; index++)
+  {
+    fill(buffer, 8 * BLOCK_SIZE, 10 + index);
+    memcpy(shadow + (200 + index * 8) * BLOCK_SIZE, buffer, 8 * BLOCK_SIZE);
+    CHECK(read_write(MSC_CMD_WRITE_12, 200 + index * 8, 8, buffer, 0) == 0);
+  }
+  CHECK(disk_writes == 7 && disk_write_bytes[0] == MSC_WRITE_CACHE_SIZE);
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  CHECK(disk_writes == 8 && memcmp(disk + 200 * BLOCK_SIZE, shadow + 200 * BLOCK_SIZE, 128 * BLOCK_SIZE) == 0);
+
+  /* fua goes to the disk, 16 and 12 byte reads */
+  fill(buffer, 64 * BLOCK_SIZE, 99);
+  disk_writes = 0;
+  CHECK(read_write(MSC_CMD_WRITE_16, 300, 64, buffer, 1) == 0 && disk_writes == 8);
+  CHECK(read_write(MSC_CMD_READ_16, 300, 64, buffer2, 0) == 0 && memcmp(buffer, buffer2, 64 * BLOCK_SIZE) == 0);
+  CHECK(read_write(MSC_CMD_READ_12, 300, 64, buffer2, 0) == 0 && memcmp(buffer, buffer2, 64 * BLOCK_SIZE) == 0);
+
+  /* an overlapping write that does not continue the run keeps the order */
+  fill(buffer, 4 * BLOCK_SIZE, 5);
+  CHECK(read_write(MSC_CMD_WRITE_10, 10, 4, buffer, 0) == 0);
+  fill(buffer2, 8 * BLOCK_SIZE, 6);
+  CHECK(read_write(MSC_CMD_WRITE_10, 8, 8, buffer2, 0) == 0);
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_16) == 0);
+  CHECK(memcmp(disk + 8 * BLOCK_SIZE, buffer2, 8 * BLOCK_SIZE) == 0);
+
+  /* idle timer */
+  fill(buffer, BLOCK_SIZE, 7);
+  disk_writes = 0;
+  CHECK(read_write(MSC_CMD_WRITE_10, 50, 1, buffer, 0) == 0);
+  for(index = 0; index < MSC_WRITE_CACHE_DELAY - 1; index++)
+  {
+    bot_scsi_cache_timer(&dev);
+  }
+  CHECK(disk_writes == 0);
+  bot_scsi_cache_timer(&dev);
+  CHECK(disk_writes == 1 && memcmp(disk + 50 * BLOCK_SIZE, buffer, BLOCK_SIZE) == 0);
+}
+
+static void unmap_test(void)
+{
+  static uint8_t buffer[2 * BLOCK_SIZE];
+  uint8_t key, asc;
+
+  /* cached blocks in the range are written first, then unmapped */
+  fill(buffer, 2 * BLOCK_SIZE, 8);
+  CHECK(read_write(MSC_CMD_WRITE_10, 600, 2, buffer, 0) == 0);
+  {
+    uint64_t lba[2] = {590, 700};
+    uint32_t blocks[2] = {20, 0};
+
+    unmaps = 0;
+    disk_writes = 0;
+    CHECK(unmap(2, lba, blocks) == 0 && unmaps == 1 && disk_writes == 1);
+    CHECK(unmap_addr[0] == 590 * BLOCK_SIZE && unmap_len[0] == 20 * BLOCK_SIZE);
+    CHECK(disk[600 * BLOCK_SIZE] == UNMAPPED);
+  }
+
+  /* one range past the end rejects the list */
+  {
+    uint64_t lba[2] = {10, 1020};
+    uint32_t blocks[2] = {4, 8};
+
+    unmaps = 0;
+    CHECK(unmap(2, lba, blocks) == 1 && unmaps == 0);
+    CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_ILLEGAL_REQUEST && asc == ADDRESS_OUT_OF_RANGE);
+  }
+}
+
+static void error_test(void)
+{
+  static uint8_t buffer[0x20 * BLOCK_SIZE];
+  uint8_t key, asc;
+  uint32_t index;
+
+  CHECK(read_write(MSC_CMD_READ_16, 1020, 8, buffer, 0) == 1);
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_ILLEGAL_REQUEST && asc == ADDRESS_OUT_OF_RANGE);
+  {
+    /* the lba plus the length wraps */
+    uint8_t cdb[16] = {MSC_CMD_READ_16};
+    put_be(cdb + 2, 0xFFFFFFFFFFFFFFF0ull, 8);
+    put_be(cdb + 10, 0x20, 4);
+    CHECK(command(cdb, 16, 1, buffer, 0x20 * BLOCK_SIZE) == 1);
+  }
+  {
+    uint8_t cdb[10] = {MSC_CMD_WRITE_10};
+    put_be(cdb + 2, 5, 4);
+    CHECK(command(cdb, 10, 0, NULL, 0) == 0);
+  }
+
+  /* a failed background flush is reported once by the next sync */
+  fill(buffer, BLOCK_SIZE, 9);
+  CHECK(read_write(MSC_CMD_WRITE_10, 70, 1, buffer, 0) == 0);
+  fail_write = 1;
+  for(index = 0; index < MSC_WRITE_CACHE_DELAY; index++)
+  {
+    bot_scsi_cache_timer(&dev);
+  }
+  fail_write = 0;
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 1);
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_MEDIUM_ERROR && asc == WRITE_ERROR);
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+}
+
+static void random_test(void)
+{
+  static const uint8_t read_ops[3] = {MSC_CMD_READ_10, MSC_CMD_READ_12, MSC_CMD_READ_16};
+  static const uint8_t write_ops[3] = {MSC_CMD_WRITE_10, MSC_CMD_WRITE_12, MSC_CMD_WRITE_16};
+  static uint8_t buffer[40 * BLOCK_SIZE];
+  uint32_t index, op, count, blocks, step;
+  uint64_t lba;
+
+  memcpy(shadow, disk, sizeof(disk));
+  for(index = 0; index < RANDOM_COMMANDS && fails == 0; index++)
+  {
+    op = rand_get() % 10;
+    count = 1 + rand_get() % 40;
+    lba = rand_get() % (DISK_BLOCKS - count);
+    if(op < 4)
+    {
+      fill(buffer, count * BLOCK_SIZE, index);
+      memcpy(shadow + lba * BLOCK_SIZE, buffer, count * BLOCK_SIZE);
+      CHECK(read_write(write_ops[rand_get() % 3], lba, count, buffer, (rand_get() % 8) == 0) == 0);
+    }
+    else if(op < 5)
+    {
+      /* a sequential run of single block writes */
+      lba &= ~31u;
+      for(step = 0; step < 32; step++)
+      {
+        fill(buffer, BLOCK_SIZE, index + step);
+        memcpy(shadow + (lba + step) * BLOCK_SIZE, buffer, BLOCK_SIZE);
+        CHECK(read_write(MSC_CMD_WRITE_10, lba + step, 1, buffer, 0) == 0);
+      }
+    }
+    else if(op < 8)
+    {
+      CHECK(read_write(read_ops[rand_get() % 3], lba, count, buffer, 0) == 0);
+      CHECK(memcmp(buffer, shadow + lba * BLOCK_SIZE, count * BLOCK_SIZE) == 0);
+    }
+    else if(op < 9)
+    {
+      blocks = 1 + rand_get() % 8;
+      CHECK(unmap(1, &lba, &blocks) == 0);
+      memset(shadow + lba * BLOCK_SIZE, UNMAPPED, blocks * BLOCK_SIZE);
+    }
+    else if(rand_get() & 1)
+    {
+      CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+    }
+    else
+    {
+      for(step = rand_get() % 120; step != 0; step--)
+      {
+        bot_scsi_cache_timer(&dev);
+      }
+    }
+  }
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  CHECK(memcmp(disk, shadow, sizeof(disk)) == 0);
+  printf("%u random commands, %u cache flushes\n", index, msc_struct.cache_flush_count);
+}
+
+static void lun_identification_test(void)
+{
+  uint8_t cdb[10] = {0}, data[36];
+
+  CHECK(msc_struct.max_lun == MSC_SUPPORT_MAX_LUN - 1);
+  for(host_lun = 0; host_lun < 2; host_lun++)
+  {
+    cdb[0] = MSC_CMD_INQUIRY;
+    cdb[4] = 36;
+    CHECK(command(cdb, 6, 1, data, 36) == 0 && data[9] == '0' + host_lun);
+    CHECK(no_data(MSC_CMD_TEST_UNIT) == 0);
+    memset(cdb, 0, sizeof(cdb));
+    cdb[0] = MSC_CMD_READ_CAPACITY;
+    CHECK(command(cdb, 10, 1, data, 8) == 0);
+    CHECK(((data[2] << 8 | data[3]) + 1) == (host_lun ? LUN1_BLOCKS : DISK_BLOCKS));
+    CHECK((data[6] << 8 | data[7]) == (host_lun ? LUN1_BLOCK_SIZE : BLOCK_SIZE));
+    memset(cdb, 0, sizeof(cdb));
+  }
+
+  /* a lun past the last one is an invalid cbw */
+  host_lun = MSC_SUPPORT_MAX_LUN;
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == -1);
+  bot_scsi_reset(&dev);
+  bot_scsi_clear_feature(&dev, 0x81);
+  msc_struct.bot_status = MSC_BOT_STATE_IDLE;
+  host_lun = 0;
+}
+
+static void lun_isolation_test(void)
+{
+  static uint8_t buffer[4 * LUN1_BLOCK_SIZE], buffer2[4 * LUN1_BLOCK_SIZE];
+  uint8_t key, asc;
+
+  /* sense data of one lun is not seen on the other and is reported once */
+  host_lun = 0;
+  CHECK(read_write(MSC_CMD_READ_10, DISK_BLOCKS - 4, 8, buffer, 0) == 1);
+  host_lun = 1;
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == 0);
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_NO_SENSE);
+  host_lun = 0;
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_ILLEGAL_REQUEST && asc == ADDRESS_OUT_OF_RANGE);
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_NO_SENSE);
+
+  /* blocks cached for lun 0 are neither read back on lun 1 nor written there */
+  memcpy(lun1_shadow, lun1_disk, sizeof(lun1_disk));
+  fill(buffer, 4 * BLOCK_SIZE, 21);
+  host_lun = 0;
+  CHECK(read_write(MSC_CMD_WRITE_10, 0, 4, buffer, 0) == 0);
+  host_lun = 1;
+  CHECK(read_write(MSC_CMD_READ_10, 0, 1, buffer2, 0) == 0 && memcmp(buffer2, lun1_shadow, LUN1_BLOCK_SIZE) == 0);
+  /* lun 1 block 1 starts at the byte address that continues the lun 0 run */
+  fill(buffer2, 2 * LUN1_BLOCK_SIZE, 22);
+  memcpy(lun1_shadow + LUN1_BLOCK_SIZE, buffer2, 2 * LUN1_BLOCK_SIZE);
+  CHECK(read_write(MSC_CMD_WRITE_10, 1, 2, buffer2, 0) == 0);
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  host_lun = 0;
+  CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  CHECK(memcmp(disk, buffer, 4 * BLOCK_SIZE) == 0);
+  CHECK(memcmp(lun1_disk, lun1_shadow, sizeof(lun1_disk)) == 0);
+
+  /* a removed medium fails lun 1 alone, with not ready */
+  lun1_present = 0;
+  host_lun = 1;
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == 1);
+  CHECK(request_sense(&key, &asc) == 0 && key == SENSE_KEY_NOT_READY && asc == MEDIUM_NOT_PRESENT);
+  CHECK(read_write(MSC_CMD_READ_10, 0, 1, buffer, 0) == 1);
+  host_lun = 0;
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == 0);
+  CHECK(read_write(MSC_CMD_WRITE_10, 0, 4, buffer, 0) == 0 && no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  lun1_present = 1;
+  host_lun = 1;
+  CHECK(no_data(MSC_CMD_TEST_UNIT) == 0);
+  host_lun = 0;
+}
+
+/* interleaved commands on both luns, each against its own shadow image */
+static void lun_random_test(void)
+{
+  static uint8_t buffer[8 * LUN1_BLOCK_SIZE];
+  uint32_t index, count, block_size, blocks, op;
+  uint8_t *lun_shadow;
+  uint64_t lba;
+
+  memcpy(shadow, disk, sizeof(disk));
+  memcpy(lun1_shadow, lun1_disk, sizeof(lun1_disk));
+  for(index = 0; index < RANDOM_COMMANDS && fails == 0; index++)
+  {
+    host_lun = rand_get() & 1;
+    block_size = host_lun ? LUN1_BLOCK_SIZE : BLOCK_SIZE;
+    blocks = host_lun ? LUN1_BLOCKS : DISK_BLOCKS;
+    lun_shadow = host_lun ? lun1_shadow : shadow;
+    count = 1 + rand_get() % (sizeof(buffer) / block_size);
+    lba = rand_get() % (blocks - count);
+    op = rand_get() % 8;
+    if(op < 3)
+    {
+      fill(buffer, count * block_size, index);
+      memcpy(lun_shadow + lba * block_size, buffer, count * block_size);
+      CHECK(read_write(MSC_CMD_WRITE_10, lba, count, buffer, 0) == 0);
+    }
+    else if(op < 7)
+    {
+      CHECK(read_write(MSC_CMD_READ_10, lba, count, buffer, 0) == 0);
+      CHECK(memcmp(buffer, lun_shadow + lba * block_size, count * block_size) == 0);
+    }
+    else
+    {
+      CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+    }
+  }
+  for(host_lun = 0; host_lun < 2; host_lun++)
+  {
+    CHECK(no_data(MSC_CMD_SYNC_CACHE_10) == 0);
+  }
+  host_lun = 0;
+  CHECK(memcmp(disk, shadow, sizeof(disk)) == 0 && memcmp(lun1_disk, lun1_shadow, sizeof(lun1_disk)) == 0);
+  printf("%u random commands on two luns\n", index);
+}
+
+int main(void)
+{
+  msc_class_handler.pdata = &msc_struct;
+  bot_scsi_init(&dev);
+
+  identification_test();
+  cache_test();
+  unmap_test();
+  error_test();
+  random_test();
+  lun_identification_test();
+  lun_isolation_test();
+  lun_random_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -46,25 +46,47 @@ ALIGNED_HEAD uint8_t page00_inquiry_data[] ALIGNED_TAIL = {
   0x00,
   0x00,
   0x00,
+#if (MSC_SUPPORT_UNMAP == 1)
+  0x03,
   0x00,
+  0xB0,
+  0xB2,
+#else
   0x00,
+  0x00,
+#endif
 
 };
+
+#if (MSC_SUPPORT_UNMAP == 1)
 #if defined ( __ICCARM__ ) /* iar compiler */
   #pragma data_alignment=4
 #endif
-ALIGNED_HEAD sense_type sense_data ALIGNED_TAIL =
+/* block limits: unmap descriptors that fit the data buffer, any block count */
+ALIGNED_HEAD uint8_t page_b0_inquiry_data[64] ALIGNED_TAIL =
 {
-  0x70,
-  0x00,
-  SENSE_KEY_ILLEGAL_REQUEST,
-  0x00000000,
-  0x0A,
-  0x00000000,
-  0x20,
-  0x00,
-  0x00000000
+  0x00, 0xB0, 0x00, 0x3C,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0xFF, 0xFF, 0xFF, 0xFF,
+  (uint8_t)(MSC_UNMAP_DESCRIPTOR_MAX >> 24), (uint8_t)(MSC_UNMAP_DESCRIPTOR_MAX >> 16),
+  (uint8_t)(MSC_UNMAP_DESCRIPTOR_MAX >> 8), (uint8_t)MSC_UNMAP_DESCRIPTOR_MAX,
+};
+
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+/* logical block provisioning: unmap supported */
+ALIGNED_HEAD uint8_t page_b2_inquiry_data[8] ALIGNED_TAIL =
+{
+  0x00, 0xB2, 0x00, 0x04,
+  0x00, 0x80, 0x00, 0x00
 };
+#endif
+#if defined ( __ICCARM__ ) /* iar compiler */
+  #pragma data_alignment=4
+#endif
+ALIGNED_HEAD sense_type sense_data[MSC_SUPPORT_MAX_LUN] ALIGNED_TAIL;
 
 #if defined ( __ICCARM__ ) /* iar compiler */
   #pragma data_alignment=4
@@ -95,6 +117,179 @@ ALIGNED_HEAD uint8_t mode_sense10_data[8] ALIGNED_TAIL =
   0x00,
   0x00
 };
+
+#if (MSC_WRITE_CACHE_SIZE > 0)
+/* caching mode page, write cache enabled (wce) */
+const uint8_t mode_caching_page[20] =
+{
+  0x08, 0x12, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+#endif
+
+/**
+  * @brief  read a big endian field of a command block
+  * @param  buf: first byte of the field
+  * @param  len: field length, 2 to 8 bytes
+  * @retval field value
+  */
+static uint64_t bot_scsi_get_be(const uint8_t *buf, uint8_t len)
+{
+  uint64_t value = 0;
+  while(len--)
+  {
+    value = (value << 8) | *buf++;
+  }
+  return value;
+}
+
+#if (MSC_WRITE_CACHE_SIZE > 0)
+/**
+  * @brief  check whether a disk range overlaps the cached run
+  * @param  pmsc: msc struct
+  * @param  lun: logical units number
+  * @param  addr: byte address
+  * @param  len: byte length
+  * @retval TRUE when some cached byte is in the range
+  */
+static confirm_state bot_scsi_cache_overlap(msc_type *pmsc, uint8_t lun, uint64_t addr, uint64_t len)
+{
+  if(pmsc->cache_len != 0 && lun == pmsc->cache_lun &&
+     addr < pmsc->cache_addr + pmsc->cache_len && pmsc->cache_addr < addr + len)
+  {
+    return TRUE;
+  }
+  return FALSE;
+}
+#endif
+
+/**
+  * @brief  write received blocks, to the cache unless the command has the
+  *         fua bit or the blocks do not fit the cache
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @param  addr: byte address
+  * @param  buf: blocks received
+  * @param  len: byte length
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type bot_scsi_cache_write(void *udev, uint8_t lun, uint64_t addr, uint8_t *buf, uint32_t len)
+{
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint32_t index;
+
+  if((pmsc->cbw_struct.CBWCB[1] & 0x08) != 0 || len > MSC_WRITE_CACHE_SIZE)
+  {
+    /* older cached copies of these blocks must not be written after them */
+    if(bot_scsi_cache_overlap(pmsc, lun, addr, len) == TRUE && bot_scsi_cache_flush(udev) != USB_OK)
+    {
+      return USB_FAIL;
+    }
+  }
+  else
+  {
+    if(pmsc->cache_len != 0 &&
+       (lun != pmsc->cache_lun || addr != pmsc->cache_addr + pmsc->cache_len ||
+        pmsc->cache_len + len > MSC_WRITE_CACHE_SIZE))
+    {
+      if(bot_scsi_cache_flush(udev) != USB_OK)
+      {
+        return USB_FAIL;
+      }
+    }
+
+    if(pmsc->cache_len == 0)
+    {
+      pmsc->cache_lun = lun;
+      pmsc->cache_addr = addr;
+    }
+    for(index = 0; index < len; index++)
+    {
+      pmsc->cache[pmsc->cache_len + index] = buf[index];
+    }
+    pmsc->cache_len += len;
+    return USB_OK;
+  }
+#endif
+
+  if(msc_disk_write(lun, addr, buf, len) != USB_OK)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_HARDWARE_ERROR, MEDIUM_NOT_PRESENT);
+    return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  read the capacity of a lun, a lun without medium is not ready
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type bot_scsi_lun_ready(void *udev, uint8_t lun)
+{
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+
+  if(msc_disk_capacity(lun, &pmsc->blk_nbr[lun], &pmsc->blk_size[lun]) != USB_OK)
+  {
+    pmsc->blk_nbr[lun] = 0;
+    bot_scsi_sense_code(udev, SENSE_KEY_NOT_READY, MEDIUM_NOT_PRESENT);
+    return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  decode the block address and count of a read or write command,
+  *         check them against the disk and the cbw data length
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @retval status of usb_sts_type
+  */
+static usb_sts_type bot_scsi_rw_decode(void *udev, uint8_t lun)
+{
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint8_t *cmd = pmsc->cbw_struct.CBWCB;
+  uint64_t blk_addr;
+  uint32_t blk_count;
+
+  switch(cmd[0])
+  {
+    case MSC_CMD_READ_16:
+    case MSC_CMD_WRITE_16:
+      blk_addr = bot_scsi_get_be(&cmd[2], 8);
+      blk_count = (uint32_t)bot_scsi_get_be(&cmd[10], 4);
+      break;
+
+    case MSC_CMD_READ_12:
+    case MSC_CMD_WRITE_12:
+      blk_addr = bot_scsi_get_be(&cmd[2], 4);
+      blk_count = (uint32_t)bot_scsi_get_be(&cmd[6], 4);
+      break;
+
+    default:
+      blk_addr = bot_scsi_get_be(&cmd[2], 4);
+      blk_count = (uint32_t)bot_scsi_get_be(&cmd[7], 2);
+      break;
+  }
+
+  if(bot_scsi_check_address(udev, lun, blk_addr, blk_count) != USB_OK)
+  {
+    return USB_FAIL;
+  }
+
+  if(pmsc->cbw_struct.dCBWDataTransferLength != (uint64_t)blk_count * pmsc->blk_size[lun])
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
+    return USB_FAIL;
+  }
+
+  pmsc->blk_addr = blk_addr * pmsc->blk_size[lun];
+  pmsc->blk_len = blk_count * pmsc->blk_size[lun];
+  return USB_OK;
+}
+
 /**
   * @brief  initialize bulk-only transport and scsi
   * @param  udev: to the structure of usbd_core_type
@@ -103,20 +298,30 @@ ALIGNED_HEAD uint8_t mode_sense10_data[8] ALIGNED_TAIL =
 void bot_scsi_init(void *udev)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint8_t lun;
   pmsc->msc_state = MSC_STATE_MACHINE_IDLE;
   pmsc->bot_status = MSC_BOT_STATE_IDLE;
   pmsc->max_lun = MSC_SUPPORT_MAX_LUN - 1;
 
+  for(lun = 0; lun < MSC_SUPPORT_MAX_LUN; lun++)
+  {
+    sense_data[lun].err_code = 0x70;
+    sense_data[lun].sense_key = SENSE_KEY_NO_SENSE;
+    sense_data[lun].as_length = 0x0A;
+    sense_data[lun].asc = 0;
+    sense_data[lun].ascq = 0;
+  }
+
   pmsc->csw_struct.dCSWSignature = CSW_DCSWSIGNATURE;
   pmsc->csw_struct.dCSWDataResidue = 0;
   pmsc->csw_struct.dCSWSignature = 0;
   pmsc->csw_struct.dCSWTag = CSW_BCSWSTATUS_PASS;
 
-  usbd_flush_tx_fifo(pudev, USBD_MSC_BULK_IN_EPT&0x7F);
+  usbd_flush_tx_fifo(pudev, msc_ept.bulk_in_ept&0x7F);
 
   /* set out endpoint to receive status */
-  usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT, (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
+  usbd_ept_recv(pudev, msc_ept.bulk_out_ept, (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
 }
 
 /**
@@ -127,14 +332,14 @@ void bot_scsi_init(void *udev)
 void bot_scsi_reset(void *udev)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   pmsc->msc_state = MSC_STATE_MACHINE_IDLE;
   pmsc->bot_status = MSC_BOT_STATE_RECOVERY;
   pmsc->max_lun = MSC_SUPPORT_MAX_LUN - 1;
-  usbd_flush_tx_fifo(pudev, USBD_MSC_BULK_IN_EPT&0x7F);
+  usbd_flush_tx_fifo(pudev, msc_ept.bulk_in_ept&0x7F);
 
   /* set out endpoint to receive status */
-  usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT, (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
+  usbd_ept_recv(pudev, msc_ept.bulk_out_ept, (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
 }
 
 /**
@@ -145,8 +350,7 @@ void bot_scsi_reset(void *udev)
   */
 void bot_scsi_datain_handler(void *udev, uint8_t ept_num)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   switch(pmsc->msc_state)
   {
     case MSC_STATE_MACHINE_DATA_IN:
@@ -174,8 +378,7 @@ void bot_scsi_datain_handler(void *udev, uint8_t ept_num)
   */
 void bot_scsi_dataout_handler(void *udev, uint8_t ept_num)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   switch(pmsc->msc_state)
   {
     case MSC_STATE_MACHINE_IDLE:
@@ -199,15 +402,18 @@ void bot_scsi_dataout_handler(void *udev, uint8_t ept_num)
 void bot_cbw_decode(void *udev)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
 
   pmsc->csw_struct.dCSWTag = pmsc->cbw_struct.dCBWTage;
   pmsc->csw_struct.dCSWDataResidue = pmsc->cbw_struct.dCBWDataTransferLength;
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  pmsc->cache_age = 0;
+#endif
 
   /* check param */
   if((pmsc->cbw_struct.dCBWSignature != CBW_DCBWSIGNATURE) ||
-    (usbd_get_recv_len(pudev, USBD_MSC_BULK_OUT_EPT) != CBW_CMD_LENGTH)
-    || (pmsc->cbw_struct.bCBWLUN > MSC_SUPPORT_MAX_LUN) ||
+    (usbd_get_recv_len(pudev, msc_ept.bulk_out_ept) != CBW_CMD_LENGTH)
+    || (pmsc->cbw_struct.bCBWLUN >= MSC_SUPPORT_MAX_LUN) ||
       (pmsc->cbw_struct.bCBWCBLength < 1) || (pmsc->cbw_struct.bCBWCBLength > 16))
   {
     bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
@@ -246,7 +452,7 @@ void bot_cbw_decode(void *udev)
 void bot_scsi_send_data(void *udev, uint8_t *buffer, uint32_t len)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint32_t data_len = MIN(len, pmsc->cbw_struct.dCBWDataTransferLength);
 
   pmsc->csw_struct.dCSWDataResidue -= data_len;
@@ -254,7 +460,7 @@ void bot_scsi_send_data(void *udev, uint8_t *buffer, uint32_t len)
 
   pmsc->msc_state = MSC_STATE_MACHINE_SEND_DATA;
 
-  usbd_ept_send(pudev, USBD_MSC_BULK_IN_EPT,
+  usbd_ept_send(pudev, msc_ept.bulk_in_ept,
                 buffer, data_len);
 }
 
@@ -267,16 +473,16 @@ void bot_scsi_send_data(void *udev, uint8_t *buffer, uint32_t len)
 void bot_scsi_send_csw(void *udev, uint8_t status)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
 
   pmsc->csw_struct.bCSWStatus = status;
   pmsc->csw_struct.dCSWSignature = CSW_DCSWSIGNATURE;
   pmsc->msc_state = MSC_STATE_MACHINE_IDLE;
 
-  usbd_ept_send(pudev, USBD_MSC_BULK_IN_EPT,
+  usbd_ept_send(pudev, msc_ept.bulk_in_ept,
                 (uint8_t *)&pmsc->csw_struct, CSW_CMD_LENGTH);
 
-  usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT,
+  usbd_ept_recv(pudev, msc_ept.bulk_out_ept,
                (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
 }
 
@@ -290,8 +496,15 @@ void bot_scsi_send_csw(void *udev, uint8_t status)
   */
 void bot_scsi_sense_code(void *udev, uint8_t sense_key, uint8_t asc)
 {
-  sense_data.sense_key = sense_key;
-  sense_data.asc = asc;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint8_t lun = pmsc->cbw_struct.bCBWLUN;
+
+  /* a cbw with an invalid lun has no sense data to keep */
+  if(lun < MSC_SUPPORT_MAX_LUN)
+  {
+    sense_data[lun].sense_key = sense_key;
+    sense_data[lun].asc = asc;
+  }
 }
 
 
@@ -303,11 +516,10 @@ void bot_scsi_sense_code(void *udev, uint8_t sense_key, uint8_t asc)
   * @param  blk_count: blk number
   * @retval usb_sts_type
   */
-usb_sts_type bot_scsi_check_address(void *udev, uint8_t lun, uint32_t blk_offset, uint32_t blk_count)
+usb_sts_type bot_scsi_check_address(void *udev, uint8_t lun, uint64_t blk_offset, uint32_t blk_count)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
-  if((blk_offset + blk_count) > pmsc->blk_nbr[lun])
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  if(blk_offset > pmsc->blk_nbr[lun] || blk_count > pmsc->blk_nbr[lun] - blk_offset)
   {
     bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, ADDRESS_OUT_OF_RANGE);
     return USB_FAIL;
@@ -323,19 +535,19 @@ usb_sts_type bot_scsi_check_address(void *udev, uint8_t lun, uint32_t blk_offset
 void bot_scsi_stall(void *udev)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
 
   if((pmsc->cbw_struct.dCBWDataTransferLength != 0) &&
     (pmsc->cbw_struct.bmCBWFlags == 0) &&
     pmsc->bot_status == MSC_BOT_STATE_IDLE)
   {
-    usbd_set_stall(pudev, USBD_MSC_BULK_OUT_EPT);
+    usbd_set_stall(pudev, msc_ept.bulk_out_ept);
   }
-  usbd_set_stall(pudev, USBD_MSC_BULK_IN_EPT);
+  usbd_set_stall(pudev, msc_ept.bulk_in_ept);
 
   if(pmsc->bot_status == MSC_BOT_STATE_ERROR)
   {
-    usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT,
+    usbd_ept_recv(pudev, msc_ept.bulk_out_ept,
                  (uint8_t *)&pmsc->cbw_struct, CBW_CMD_LENGTH);
   }
 }
@@ -349,8 +561,7 @@ void bot_scsi_stall(void *udev)
 usb_sts_type bot_scsi_test_unit(void *udev, uint8_t lun)
 {
   usb_sts_type status = USB_OK;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
 
   if(pmsc->cbw_struct.dCBWDataTransferLength != 0)
   {
@@ -359,6 +570,7 @@ usb_sts_type bot_scsi_test_unit(void *udev, uint8_t lun)
   }
 
   pmsc->data_len = 0;
+  status = bot_scsi_lun_ready(udev, lun);
   return status;
 }
 
@@ -373,13 +585,34 @@ usb_sts_type bot_scsi_inquiry(void *udev, uint8_t lun)
   uint8_t *pdata;
   uint32_t trans_len = 0;
   usb_sts_type status = USB_OK;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
 
   if(pmsc->cbw_struct.CBWCB[1] & 0x01)
   {
+#if (MSC_SUPPORT_UNMAP == 1)
+    switch(pmsc->cbw_struct.CBWCB[2])
+    {
+      case 0x00:
+        pdata = page00_inquiry_data;
+        trans_len = sizeof(page00_inquiry_data);
+        break;
+      case 0xB0:
+        pdata = page_b0_inquiry_data;
+        trans_len = sizeof(page_b0_inquiry_data);
+        break;
+      case 0xB2:
+        pdata = page_b2_inquiry_data;
+        trans_len = sizeof(page_b2_inquiry_data);
+        break;
+      default:
+        bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
+        return USB_FAIL;
+    }
+    trans_len = MIN(trans_len, pmsc->cbw_struct.dCBWDataTransferLength);
+#else
     pdata = page00_inquiry_data;
     trans_len = 5;
+#endif
   }
   else
   {
@@ -411,10 +644,11 @@ usb_sts_type bot_scsi_inquiry(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_start_stop(void *udev, uint8_t lun)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   pmsc->data_len = 0;
-  return USB_OK;
+
+  /* the host stops or ejects the disk, the cached blocks go first */
+  return bot_scsi_cache_flush(udev);
 }
 
 /**
@@ -425,8 +659,7 @@ usb_sts_type bot_scsi_start_stop(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_allow_medium_removal(void *udev, uint8_t lun)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   pmsc->data_len = 0;
   return USB_OK;
 }
@@ -440,14 +673,24 @@ usb_sts_type bot_scsi_allow_medium_removal(void *udev, uint8_t lun)
 usb_sts_type bot_scsi_mode_sense6(void *udev, uint8_t lun)
 {
   uint8_t data_len = 8;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   pmsc->data_len = 8;
   while(data_len)
   {
     data_len --;
     pmsc->data[data_len] = mode_sense6_data[data_len];
   };
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  if((pmsc->cbw_struct.CBWCB[2] & 0x3F) == 0x08 || (pmsc->cbw_struct.CBWCB[2] & 0x3F) == 0x3F)
+  {
+    for(data_len = 0; data_len < sizeof(mode_caching_page); data_len++)
+    {
+      pmsc->data[4 + data_len] = mode_caching_page[data_len];
+    }
+    pmsc->data[0] = 4 + sizeof(mode_caching_page) - 1;
+    pmsc->data_len = 4 + sizeof(mode_caching_page);
+  }
+#endif
   return USB_OK;
 }
 
@@ -460,14 +703,25 @@ usb_sts_type bot_scsi_mode_sense6(void *udev, uint8_t lun)
 usb_sts_type bot_scsi_mode_sense10(void *udev, uint8_t lun)
 {
   uint8_t data_len = 8;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   pmsc->data_len = 8;
   while(data_len)
   {
     data_len --;
     pmsc->data[data_len] = mode_sense10_data[data_len];
   };
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  if((pmsc->cbw_struct.CBWCB[2] & 0x3F) == 0x08 || (pmsc->cbw_struct.CBWCB[2] & 0x3F) == 0x3F)
+  {
+    for(data_len = 0; data_len < sizeof(mode_caching_page); data_len++)
+    {
+      pmsc->data[8 + data_len] = mode_caching_page[data_len];
+    }
+    pmsc->data[0] = 0;
+    pmsc->data[1] = 8 + sizeof(mode_caching_page) - 2;
+    pmsc->data_len = 8 + sizeof(mode_caching_page);
+  }
+#endif
   return USB_OK;
 }
 
@@ -479,10 +733,12 @@ usb_sts_type bot_scsi_mode_sense10(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_capacity(void *udev, uint8_t lun)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint8_t *pdata = pmsc->data;
-  msc_disk_capacity(lun, &pmsc->blk_nbr[lun], &pmsc->blk_size[lun]);
+  if(bot_scsi_lun_ready(udev, lun) != USB_OK)
+  {
+    return USB_FAIL;
+  }
 
   pdata[0] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 24);
   pdata[1] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 16);
@@ -506,8 +762,7 @@ usb_sts_type bot_scsi_capacity(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_format_capacity(void *udev, uint8_t lun)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint8_t *pdata = pmsc->data;
 
   pdata[0] = 0;
@@ -515,7 +770,10 @@ usb_sts_type bot_scsi_format_capacity(void *udev, uint8_t lun)
   pdata[2] = 0;
   pdata[3] = 0x08;
 
-  msc_disk_capacity(lun, &pmsc->blk_nbr[lun], &pmsc->blk_size[lun]);
+  if(bot_scsi_lun_ready(udev, lun) != USB_OK)
+  {
+    return USB_FAIL;
+  }
 
   pdata[4] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 24);
   pdata[5] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 16);
@@ -541,17 +799,25 @@ usb_sts_type bot_scsi_format_capacity(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_request_sense(void *udev, uint8_t lun)
 {
-  uint32_t trans_len = 0x12;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  uint32_t trans_len = REQ_SENSE_STANDARD_DATA_LEN;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint8_t *pdata = pmsc->data;
-  uint8_t *sdata = (uint8_t *)&sense_data;
 
+  /* fixed format sense data, sense_data is not packed */
   while(trans_len)
   {
     trans_len --;
-    pdata[trans_len] = sdata[trans_len];
+    pdata[trans_len] = 0;
   }
+  pdata[0] = sense_data[lun].err_code;
+  pdata[2] = sense_data[lun].sense_key;
+  pdata[7] = sense_data[lun].as_length;
+  pdata[12] = sense_data[lun].asc;
+  pdata[13] = sense_data[lun].ascq;
+
+  /* the sense data is reported once */
+  sense_data[lun].sense_key = SENSE_KEY_NO_SENSE;
+  sense_data[lun].asc = 0;
 
   if(pmsc->cbw_struct.dCBWDataTransferLength < REQ_SENSE_STANDARD_DATA_LEN)
   {
@@ -572,8 +838,7 @@ usb_sts_type bot_scsi_request_sense(void *udev, uint8_t lun)
   */
 usb_sts_type bot_scsi_verify(void *udev, uint8_t lun)
 {
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint8_t *cmd = pmsc->cbw_struct.CBWCB;
   if((pmsc->cbw_struct.CBWCB[1] & 0x02) == 0x02)
   {
@@ -593,42 +858,44 @@ usb_sts_type bot_scsi_verify(void *udev, uint8_t lun)
 }
 
 /**
-  * @brief  bulk-only transport scsi command read10
+  * @brief  bulk-only transport scsi command read10, read12 and read16
   * @param  udev: to the structure of usbd_core_type
   * @param  lun: logical units number
   * @retval status of usb_sts_type
   */
-usb_sts_type bot_scsi_read10(void *udev, uint8_t lun)
+usb_sts_type bot_scsi_read(void *udev, uint8_t lun)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
-  uint8_t *cmd = pmsc->cbw_struct.CBWCB;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint32_t len;
 
   if(pmsc->msc_state == MSC_STATE_MACHINE_IDLE)
   {
-    if((pmsc->cbw_struct.bmCBWFlags & 0x80) != 0x80)
+    if((pmsc->cbw_struct.bmCBWFlags & 0x80) != 0x80 && pmsc->cbw_struct.dCBWDataTransferLength != 0)
     {
       bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
       return USB_FAIL;
     }
 
-    pmsc->blk_addr = cmd[2] << 24 | cmd[3] << 16 | cmd[4] << 8 | cmd[5];
-    pmsc->blk_len = cmd[7] << 8 | cmd[8];
-
-    if(bot_scsi_check_address(udev, lun, pmsc->blk_addr, pmsc->blk_len) != USB_OK)
+    if(bot_scsi_rw_decode(udev, lun) != USB_OK)
     {
       return USB_FAIL;
     }
 
-    pmsc->blk_addr *= pmsc->blk_size[lun];
-    pmsc->blk_len *= pmsc->blk_size[lun];
+    if(pmsc->blk_len == 0)
+    {
+      pmsc->data_len = 0;
+      return USB_OK;
+    }
 
-    if(pmsc->cbw_struct.dCBWDataTransferLength != pmsc->blk_len)
+#if (MSC_WRITE_CACHE_SIZE > 0)
+    /* the disk must hold the cached blocks before they are read back */
+    if(bot_scsi_cache_overlap(pmsc, lun, pmsc->blk_addr, pmsc->blk_len) == TRUE &&
+       bot_scsi_cache_flush(udev) != USB_OK)
     {
-      bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
       return USB_FAIL;
     }
+#endif
     pmsc->msc_state  = MSC_STATE_MACHINE_DATA_IN;
   }
   pmsc->data_len = MSC_MAX_DATA_BUF_LEN;
@@ -639,7 +906,7 @@ usb_sts_type bot_scsi_read10(void *udev, uint8_t lun)
     bot_scsi_sense_code(udev, SENSE_KEY_HARDWARE_ERROR, MEDIUM_NOT_PRESENT);
     return USB_FAIL;
   }
-  usbd_ept_send(pudev, USBD_MSC_BULK_IN_EPT, pmsc->data, len);
+  usbd_ept_send(pudev, msc_ept.bulk_in_ept, pmsc->data, len);
   pmsc->blk_addr += len;
   pmsc->blk_len -= len;
 
@@ -654,54 +921,46 @@ usb_sts_type bot_scsi_read10(void *udev, uint8_t lun)
 
 
 /**
-  * @brief  bulk-only transport scsi command write10
+  * @brief  bulk-only transport scsi command write10, write12 and write16
   * @param  udev: to the structure of usbd_core_type
   * @param  lun: logical units number
   * @retval status of usb_sts_type
   */
-usb_sts_type bot_scsi_write10(void *udev, uint8_t lun)
+usb_sts_type bot_scsi_write(void *udev, uint8_t lun)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
-  uint8_t *cmd = pmsc->cbw_struct.CBWCB;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   uint32_t len;
 
   if(pmsc->msc_state == MSC_STATE_MACHINE_IDLE)
   {
-    if((pmsc->cbw_struct.bmCBWFlags & 0x80) == 0x80)
+    if((pmsc->cbw_struct.bmCBWFlags & 0x80) == 0x80 && pmsc->cbw_struct.dCBWDataTransferLength != 0)
     {
       bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
       return USB_FAIL;
     }
 
-    pmsc->blk_addr = cmd[2] << 24 | cmd[3] << 16 | cmd[4] << 8 | cmd[5];
-    pmsc->blk_len = cmd[7] << 8 | cmd[8];
-
-    if(bot_scsi_check_address(udev, lun, pmsc->blk_addr, pmsc->blk_len) != USB_OK)
+    if(bot_scsi_rw_decode(udev, lun) != USB_OK)
     {
       return USB_FAIL;
     }
 
-    pmsc->blk_addr *= pmsc->blk_size[lun];
-    pmsc->blk_len *= pmsc->blk_size[lun];
-
-    if(pmsc->cbw_struct.dCBWDataTransferLength != pmsc->blk_len)
+    if(pmsc->blk_len == 0)
     {
-      bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
-      return USB_FAIL;
+      pmsc->data_len = 0;
+      return USB_OK;
     }
 
     pmsc->msc_state  = MSC_STATE_MACHINE_DATA_OUT;
     len = MIN(pmsc->blk_len, MSC_MAX_DATA_BUF_LEN);
-    usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT, (uint8_t *)pmsc->data, len);
+    usbd_ept_recv(pudev, msc_ept.bulk_out_ept, (uint8_t *)pmsc->data, len);
 
   }
   else
   {
     len = MIN(pmsc->blk_len, MSC_MAX_DATA_BUF_LEN);
-    if(msc_disk_write(lun, pmsc->blk_addr, pmsc->data, len) != USB_OK)
+    if(bot_scsi_cache_write(udev, lun, pmsc->blk_addr, pmsc->data, len) != USB_OK)
     {
-      bot_scsi_sense_code(udev, SENSE_KEY_HARDWARE_ERROR, MEDIUM_NOT_PRESENT);
       return USB_FAIL;
     }
 
@@ -717,12 +976,238 @@ usb_sts_type bot_scsi_write10(void *udev, uint8_t lun)
     else
     {
       len = MIN(pmsc->blk_len, MSC_MAX_DATA_BUF_LEN);
-      usbd_ept_recv(pudev, USBD_MSC_BULK_OUT_EPT, (uint8_t *)pmsc->data, len);
+      usbd_ept_recv(pudev, msc_ept.bulk_out_ept, (uint8_t *)pmsc->data, len);
+    }
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  bulk-only transport scsi command read capacity16
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @retval status of usb_sts_type
+  */
+usb_sts_type bot_scsi_capacity16(void *udev, uint8_t lun)
+{
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint8_t *cmd = pmsc->cbw_struct.CBWCB;
+  uint8_t *pdata = pmsc->data;
+  uint32_t index;
+
+  if((cmd[1] & 0x1F) != MSC_SA_READ_CAPACITY_16)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
+    return USB_FAIL;
+  }
+
+  if(bot_scsi_lun_ready(udev, lun) != USB_OK)
+  {
+    return USB_FAIL;
+  }
+
+  for(index = 0; index < 32; index++)
+  {
+    pdata[index] = 0;
+  }
+
+  pdata[4] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 24);
+  pdata[5] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 16);
+  pdata[6] = (uint8_t)((pmsc->blk_nbr[lun] - 1) >> 8);
+  pdata[7] = (uint8_t)((pmsc->blk_nbr[lun] - 1));
+
+  pdata[8] = (uint8_t)((pmsc->blk_size[lun]) >> 24);
+  pdata[9] = (uint8_t)((pmsc->blk_size[lun]) >> 16);
+  pdata[10] = (uint8_t)((pmsc->blk_size[lun]) >> 8);
+  pdata[11] = (uint8_t)((pmsc->blk_size[lun]));
+
+#if (MSC_SUPPORT_UNMAP == 1)
+  /* logical block provisioning management enabled */
+  pdata[14] = 0x80;
+#endif
+
+  pmsc->data_len = (uint32_t)MIN(32, bot_scsi_get_be(&cmd[10], 4));
+  return USB_OK;
+}
+
+/**
+  * @brief  bulk-only transport scsi command synchronize cache10 and
+  *         synchronize cache16, the whole cache is written
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @retval status of usb_sts_type
+  */
+usb_sts_type bot_scsi_sync_cache(void *udev, uint8_t lun)
+{
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  usb_sts_type status;
+
+  if(pmsc->cbw_struct.dCBWDataTransferLength != 0)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
+    return USB_FAIL;
+  }
+  pmsc->data_len = 0;
+
+  status = bot_scsi_cache_flush(udev);
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  /* report a write error of an earlier flush in the background */
+  if(status == USB_OK && pmsc->cache_status != USB_OK)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_MEDIUM_ERROR, WRITE_ERROR);
+    status = USB_FAIL;
+  }
+  pmsc->cache_status = USB_OK;
+#endif
+  return status;
+}
+
+/**
+  * @brief  bulk-only transport scsi command unmap, the block descriptors are
+  *         all checked before the first one is passed to msc_disk_unmap
+  * @param  udev: to the structure of usbd_core_type
+  * @param  lun: logical units number
+  * @retval status of usb_sts_type
+  */
+usb_sts_type bot_scsi_unmap(void *udev, uint8_t lun)
+{
+#if (MSC_SUPPORT_UNMAP == 1)
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint8_t *cmd = pmsc->cbw_struct.CBWCB;
+  uint8_t *desc;
+  uint32_t param_len, desc_len, index, blk_count;
+  uint64_t blk_addr;
+
+  if(pmsc->msc_state == MSC_STATE_MACHINE_IDLE)
+  {
+    param_len = (uint32_t)bot_scsi_get_be(&cmd[7], 2);
+    if(param_len == 0 && pmsc->cbw_struct.dCBWDataTransferLength == 0)
+    {
+      pmsc->data_len = 0;
+      return USB_OK;
+    }
+
+    if((pmsc->cbw_struct.bmCBWFlags & 0x80) == 0x80 ||
+       pmsc->cbw_struct.dCBWDataTransferLength != param_len || param_len > MSC_MAX_DATA_BUF_LEN)
+    {
+      bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_FIELED_IN_COMMAND);
+      return USB_FAIL;
     }
+
+    pmsc->blk_len = param_len;
+    pmsc->msc_state = MSC_STATE_MACHINE_DATA_OUT;
+    usbd_ept_recv(pudev, msc_ept.bulk_out_ept, (uint8_t *)pmsc->data, param_len);
+    return USB_OK;
+  }
+
+  param_len = pmsc->blk_len;
+  pmsc->csw_struct.dCSWDataResidue -= param_len;
+
+  if(param_len < 8)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, PARAMETER_LIST_LENGTH_ERROR);
+    return USB_FAIL;
   }
+
+  desc_len = (uint32_t)bot_scsi_get_be(&pmsc->data[2], 2);
+  if(desc_len + 8 > param_len || (desc_len % 16) != 0)
+  {
+    bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_FIELD_IN_PARAMETER_LIST);
+    return USB_FAIL;
+  }
+
+  for(index = 0; index < desc_len; index += 16)
+  {
+    desc = &pmsc->data[8 + index];
+    if(bot_scsi_check_address(udev, lun, bot_scsi_get_be(&desc[0], 8),
+                              (uint32_t)bot_scsi_get_be(&desc[8], 4)) != USB_OK)
+    {
+      return USB_FAIL;
+    }
+  }
+
+  for(index = 0; index < desc_len; index += 16)
+  {
+    desc = &pmsc->data[8 + index];
+    blk_addr = bot_scsi_get_be(&desc[0], 8) * pmsc->blk_size[lun];
+    blk_count = (uint32_t)bot_scsi_get_be(&desc[8], 4);
+    if(blk_count == 0)
+    {
+      continue;
+    }
+
+#if (MSC_WRITE_CACHE_SIZE > 0)
+    /* cached blocks written after the unmap would bring the data back */
+    if(bot_scsi_cache_overlap(pmsc, lun, blk_addr, (uint64_t)blk_count * pmsc->blk_size[lun]) == TRUE &&
+       bot_scsi_cache_flush(udev) != USB_OK)
+    {
+      return USB_FAIL;
+    }
+#endif
+
+    if(msc_disk_unmap(lun, blk_addr, (uint64_t)blk_count * pmsc->blk_size[lun]) != USB_OK)
+    {
+      bot_scsi_sense_code(udev, SENSE_KEY_HARDWARE_ERROR, MEDIUM_NOT_PRESENT);
+      return USB_FAIL;
+    }
+  }
+
+  bot_scsi_send_csw(udev, CSW_BCSWSTATUS_PASS);
+  return USB_OK;
+#else
+  bot_scsi_sense_code(udev, SENSE_KEY_ILLEGAL_REQUEST, INVALID_COMMAND);
+  return USB_FAIL;
+#endif
+}
+
+/**
+  * @brief  write the cached blocks to the disk. the application may call it
+  *         from the context of the usb class handlers, e.g. before power off.
+  * @param  udev: to the structure of usbd_core_type
+  * @retval status of usb_sts_type
+  */
+usb_sts_type bot_scsi_cache_flush(void *udev)
+{
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+  uint32_t len = pmsc->cache_len;
+
+  if(len != 0)
+  {
+    pmsc->cache_len = 0;
+    pmsc->cache_flush_count++;
+    if(msc_disk_write(pmsc->cache_lun, pmsc->cache_addr, pmsc->cache, len) != USB_OK)
+    {
+      /* the blocks are lost, the next synchronize cache fails */
+      pmsc->cache_status = USB_FAIL;
+      bot_scsi_sense_code(udev, SENSE_KEY_MEDIUM_ERROR, WRITE_ERROR);
+      return USB_FAIL;
+    }
+  }
+#endif
   return USB_OK;
 }
 
+/**
+  * @brief  write the cached blocks once the host has sent no command for
+  *         MSC_WRITE_CACHE_DELAY frames, called from the class sof handler
+  * @param  udev: to the structure of usbd_core_type
+  * @retval none
+  */
+void bot_scsi_cache_timer(void *udev)
+{
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
+
+  if(pmsc->cache_len != 0 && pmsc->msc_state == MSC_STATE_MACHINE_IDLE &&
+     ++pmsc->cache_age >= MSC_WRITE_CACHE_DELAY)
+  {
+    bot_scsi_cache_flush(udev);
+  }
+#endif
+}
+
 /**
   * @brief  clear feature
   * @param  udev: to the structure of usbd_core_type
@@ -732,10 +1217,10 @@ usb_sts_type bot_scsi_write10(void *udev, uint8_t lun)
 void bot_scsi_clear_feature(void *udev, uint8_t ept_num)
 {
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   if(pmsc->bot_status == MSC_BOT_STATE_ERROR)
   {
-    usbd_set_stall(pudev, USBD_MSC_BULK_IN_EPT);
+    usbd_set_stall(pudev, msc_ept.bulk_in_ept);
     pmsc->bot_status = MSC_BOT_STATE_IDLE;
   }
   else if(((ept_num & 0x80) == 0x80) && (pmsc->bot_status != MSC_BOT_STATE_RECOVERY))
@@ -752,8 +1237,7 @@ void bot_scsi_clear_feature(void *udev, uint8_t ept_num)
 usb_sts_type bot_scsi_cmd_process(void *udev)
 {
   usb_sts_type status = USB_FAIL;
-  usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   switch(pmsc->cbw_struct.CBWCB[0])
   {
     case MSC_CMD_INQUIRY:
@@ -777,7 +1261,9 @@ usb_sts_type bot_scsi_cmd_process(void *udev)
       break;
 
     case MSC_CMD_READ_10:
-      status = bot_scsi_read10(udev, pmsc->cbw_struct.bCBWLUN);
+    case MSC_CMD_READ_12:
+    case MSC_CMD_READ_16:
+      status = bot_scsi_read(udev, pmsc->cbw_struct.bCBWLUN);
       break;
 
     case MSC_CMD_READ_CAPACITY:
@@ -797,7 +1283,22 @@ usb_sts_type bot_scsi_cmd_process(void *udev)
       break;
 
     case MSC_CMD_WRITE_10:
-      status = bot_scsi_write10(udev, pmsc->cbw_struct.bCBWLUN);
+    case MSC_CMD_WRITE_12:
+    case MSC_CMD_WRITE_16:
+      status = bot_scsi_write(udev, pmsc->cbw_struct.bCBWLUN);
+      break;
+
+    case MSC_CMD_SERVICE_ACTION_IN:
+      status = bot_scsi_capacity16(udev, pmsc->cbw_struct.bCBWLUN);
+      break;
+
+    case MSC_CMD_SYNC_CACHE_10:
+    case MSC_CMD_SYNC_CACHE_16:
+      status = bot_scsi_sync_cache(udev, pmsc->cbw_struct.bCBWLUN);
+      break;
+
+    case MSC_CMD_UNMAP:
+      status = bot_scsi_unmap(udev, pmsc->cbw_struct.bCBWLUN);
       break;
 
     case MSC_CMD_READ_FORMAT_CAPACITY:
@@ -45,9 +45,44 @@ extern "C" {
   * @{
   */
 
+/**
+  * @brief number of logical units, define in usb_conf.h to override. every
+  *        lun has its own capacity, block size and sense data, the msc_disk
+  *        functions of the application select the medium by lun. a lun whose
+  *        msc_disk_capacity fails is reported as not ready.
+  */
+#ifndef MSC_SUPPORT_MAX_LUN
 #define MSC_SUPPORT_MAX_LUN              1
+#endif
 #define MSC_MAX_DATA_BUF_LEN             4096
 
+/**
+  * @brief write cache, define in usb_conf.h to override. written blocks are
+  *        kept in MSC_WRITE_CACHE_SIZE bytes as one run of consecutive blocks
+  *        and the csw is sent before they reach the disk. the run is written
+  *        with one msc_disk_write when a write does not continue it, before
+  *        a read or unmap of its blocks, on synchronize cache and start stop
+  *        unit, on usb reset or suspend and when the host has sent no command
+  *        for MSC_WRITE_CACHE_DELAY frames. writes with the fua bit bypass the
+  *        cache. set to 0 to write every block before its csw.
+  */
+#ifndef MSC_WRITE_CACHE_SIZE
+#define MSC_WRITE_CACHE_SIZE             0
+#endif
+#ifndef MSC_WRITE_CACHE_DELAY
+#define MSC_WRITE_CACHE_DELAY            100
+#endif
+
+/**
+  * @brief set MSC_SUPPORT_UNMAP to 1 in usb_conf.h when the disk implements
+  *        msc_disk_unmap, the unmap command and the logical block
+  *        provisioning pages are then reported to the host.
+  */
+#ifndef MSC_SUPPORT_UNMAP
+#define MSC_SUPPORT_UNMAP                0
+#endif
+#define MSC_UNMAP_DESCRIPTOR_MAX         ((MSC_MAX_DATA_BUF_LEN - 8) / 16)
+
 #define MSC_CMD_FORMAT_UNIT              0x04
 #define MSC_CMD_INQUIRY                  0x12
 #define MSC_CMD_START_STOP               0x1B
@@ -64,6 +99,13 @@ extern "C" {
 #define MSC_CMD_WRITE_10                 0x2A
 #define MSC_CMD_WRITE_12                 0xAA
 #define MSC_CMD_WRITE_VERIFY             0x2E
+#define MSC_CMD_READ_16                  0x88
+#define MSC_CMD_WRITE_16                 0x8A
+#define MSC_CMD_SYNC_CACHE_10            0x35
+#define MSC_CMD_SYNC_CACHE_16            0x91
+#define MSC_CMD_UNMAP                    0x42
+#define MSC_CMD_SERVICE_ACTION_IN        0x9E
+#define MSC_SA_READ_CAPACITY_16          0x10
 
 #define MSC_REQ_GET_MAX_LUN              0xFE  /*!< get max lun */
 #define MSC_REQ_BO_RESET                 0xFF  /*!< bulk only mass storage reset */
@@ -118,6 +160,7 @@ extern "C" {
 #define ADDRESS_OUT_OF_RANGE             0x21
 #define MEDIUM_NOT_PRESENT               0x3A
 #define MEDIUM_HAVE_CHANGED              0x28
+#define WRITE_ERROR                      0x0C
 
 #define SCSI_INQUIRY_DATA_LENGTH         36
 
@@ -209,6 +252,16 @@ typedef struct
   cbw_type cbw_struct;
   csw_type csw_struct;
 
+#if (MSC_WRITE_CACHE_SIZE > 0)
+  uint8_t cache_lun;
+  uint16_t cache_age;
+  uint64_t cache_addr;
+  uint32_t cache_len;
+  usb_sts_type cache_status;
+  uint32_t cache_flush_count;
+  uint8_t cache[MSC_WRITE_CACHE_SIZE];
+#endif
+
 }msc_type;
 
 void bot_scsi_init(void *udev);
@@ -219,7 +272,7 @@ void bot_cbw_decode(void *udev);
 void bot_scsi_send_data(void *udev, uint8_t *buffer, uint32_t len);
 void bot_scsi_send_csw(void *udev, uint8_t status);
 void bot_scsi_sense_code(void *udev, uint8_t sense_key, uint8_t asc);
-usb_sts_type bot_scsi_check_address(void *udev, uint8_t lun, uint32_t blk_offset, uint32_t blk_count);
+usb_sts_type bot_scsi_check_address(void *udev, uint8_t lun, uint64_t blk_offset, uint32_t blk_count);
 void bot_scsi_stall(void *udev);
 usb_sts_type bot_scsi_cmd_process(void *udev);
 
@@ -229,12 +282,17 @@ usb_sts_type bot_scsi_start_stop(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_allow_medium_removal(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_mode_sense6(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_mode_sense10(void *udev, uint8_t lun);
-usb_sts_type bot_scsi_read10(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_read(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_capacity(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_format_capacity(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_request_sense(void *udev, uint8_t lun);
 usb_sts_type bot_scsi_verify(void *udev, uint8_t lun);
-usb_sts_type bot_scsi_write10(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_write(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_capacity16(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_sync_cache(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_unmap(void *udev, uint8_t lun);
+usb_sts_type bot_scsi_cache_flush(void *udev);
+void bot_scsi_cache_timer(void *udev);
 void bot_scsi_clear_feature(void *udev, uint8_t ept_num);
 
 /**
@@ -52,6 +52,13 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event);
 
 msc_type msc_struct;
 
+/* msc endpoint addresses */
+msc_ept_type msc_ept =
+{
+  USBD_MSC_BULK_IN_EPT,
+  USBD_MSC_BULK_OUT_EPT
+};
+
 /* usb device class handler */
 usbd_class_handler msc_class_handler =
 {
@@ -78,10 +85,10 @@ static usb_sts_type class_init_handler(void *udev)
   usbd_core_type *pudev = (usbd_core_type *)udev;
 
   /* open in endpoint */
-  usbd_ept_open(pudev, USBD_MSC_BULK_IN_EPT, EPT_BULK_TYPE, USBD_OUT_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, msc_ept.bulk_in_ept, EPT_BULK_TYPE, USBD_OUT_MAXPACKET_SIZE);
 
   /* open out endpoint */
-  usbd_ept_open(pudev, USBD_MSC_BULK_OUT_EPT, EPT_BULK_TYPE, USBD_OUT_MAXPACKET_SIZE);
+  usbd_ept_open(pudev, msc_ept.bulk_out_ept, EPT_BULK_TYPE, USBD_OUT_MAXPACKET_SIZE);
 
   bot_scsi_init(udev);
 
@@ -99,10 +106,10 @@ static usb_sts_type class_clear_handler(void *udev)
   usbd_core_type *pudev = (usbd_core_type *)udev;
 
   /* close in endpoint */
-  usbd_ept_close(pudev, USBD_MSC_BULK_IN_EPT);
+  usbd_ept_close(pudev, msc_ept.bulk_in_ept);
 
   /* close out endpoint */
-  usbd_ept_close(pudev, USBD_MSC_BULK_OUT_EPT);
+  usbd_ept_close(pudev, msc_ept.bulk_out_ept);
 
   return status;
 }
@@ -117,7 +124,7 @@ static usb_sts_type class_setup_handler(void *udev, usb_setup_type *setup)
 {
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  msc_type *pmsc = (msc_type *)pudev->class_handler->pdata;
+  msc_type *pmsc = (msc_type *)msc_class_handler.pdata;
   switch(setup->bmRequestType & USB_REQ_TYPE_RESERVED)
   {
     /* class request */
@@ -246,7 +253,8 @@ static usb_sts_type class_sof_handler(void *udev)
 {
   usb_sts_type status = USB_OK;
 
-  /* ...user code... */
+  /* write the cached blocks once the host is idle */
+  bot_scsi_cache_timer(udev);
 
   return status;
 }
@@ -264,12 +272,13 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
   {
     case USBD_RESET_EVENT:
 
-      /* ...user code... */
+      /* the host may power the device off after a reset or suspend */
+      bot_scsi_cache_flush(udev);
 
       break;
     case USBD_SUSPEND_EVENT:
 
-      /* ...user code... */
+      bot_scsi_cache_flush(udev);
 
       break;
     case USBD_WAKEUP_EVENT:
@@ -51,8 +51,18 @@ extern "C" {
 #define USBD_IN_MAXPACKET_SIZE           0x40
 #define USBD_OUT_MAXPACKET_SIZE          0x40
 
+/**
+  * @brief usb msc endpoint addresses, the defines above unless a composite
+  *        device assigns others
+  */
+typedef struct
+{
+  uint8_t bulk_in_ept;
+  uint8_t bulk_out_ept;
+}msc_ept_type;
 
 extern usbd_class_handler msc_class_handler;
+extern msc_ept_type msc_ept;
 /**
   * @}
   */
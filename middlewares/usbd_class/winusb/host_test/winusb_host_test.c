@@ -0,0 +1,400 @@
+/**
+  **************************************************************************
+  * @file     winusb_host_test.c
+  * @brief    host loopback model of the winusb streaming class
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs the winusb class under the loopback loop of the winusb example against
+ * a model of the otg bulk endpoints and of a full speed host. a frame has
+ * FRAME_SLOTS bulk transactions, the host alternates out and in tokens and an
+ * endpoint that is not armed naks. the host writes a random byte stream in
+ * transfers of random length, packet multiples among them and without zero
+ * length packets, and keeps a read of HOST_READ_SIZE bytes pending on the in
+ * pipe. the application runs between transactions.
+ * - every byte comes back once and in order, also when the application has
+ *   more buffers than the in queue takes and a send is refused.
+ * - a zero length packet only follows a full packet, and the in pipe never
+ *   goes idle after a full packet, so no host read is left open.
+ * - an empty buffer is sent as a single zero length packet.
+ * loopback throughput is printed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "winusb_class.h"
+
+#define STREAM_SIZE                      (256 * 1024)
+#define FRAME_SLOTS                      19
+#define HOST_READ_SIZE                   4096
+#define APP_BUFFERS_MAX                  8
+#define MPS                              USBD_FS_WINUSB_MAXPACKET_SIZE
+
+typedef struct
+{
+  uint8_t *buffer;
+  uint32_t len;
+  uint32_t count;
+  uint32_t packets;
+  uint8_t armed;
+} host_ept_type;
+
+static usbd_core_type dev;
+static host_ept_type ept_in, ept_out;
+static uint8_t stream[STREAM_SIZE];
+static uint8_t app_buffer[APP_BUFFERS_MAX][1024];
+static uint8_t app_busy[APP_BUFFERS_MAX];
+static uint32_t app_buffers, tx_done_count;
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* the usb device core, only what the class uses */
+usbd_conn_state usbd_connect_state_get(usbd_core_type *udev)
+{
+  return udev->conn_state;
+}
+
+void usbd_ept_send(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+  CHECK(ept_addr == USBD_WINUSB_BULK_IN_EPT);
+  CHECK(ept_in.armed == 0);
+  CHECK(host_primask == 1);
+  ept_in.buffer = buffer;
+  ept_in.len = len;
+  ept_in.count = 0;
+  ept_in.packets = 0;
+  ept_in.armed = 1;
+}
+
+void usbd_ept_recv(usbd_core_type *udev, uint8_t ept_addr, uint8_t *buffer, uint16_t len)
+{
+  winusb_struct_type *p_winusb = (winusb_struct_type *)udev->class_handler->pdata;
+
+  CHECK(ept_addr == USBD_WINUSB_BULK_OUT_EPT);
+  CHECK(ept_out.armed == 0);
+  CHECK(host_primask == 1);
+  CHECK(len != 0 && (len % MPS) == 0);
+  /* inside the ring or the one packet guard past its end */
+  CHECK(buffer >= p_winusb->rx_ring && buffer + len <= p_winusb->rx_ring + USBD_WINUSB_STREAM_RX_SIZE + MPS);
+  ept_out.buffer = buffer;
+  ept_out.len = len;
+  ept_out.count = 0;
+  ept_out.armed = 1;
+}
+
+/* the received byte count of the out transfer, packets of a running transfer
+   included, as the rx fifo level interrupt counts them */
+uint32_t usbd_get_recv_len(usbd_core_type *udev, uint8_t ept_addr)
+{
+  return ept_out.count;
+}
+
+void usbd_ept_open(usbd_core_type *udev, uint8_t ept_addr, uint8_t ept_type, uint16_t maxpacket)
+{
+}
+
+void usbd_ept_close(usbd_core_type *udev, uint8_t ept_addr)
+{
+}
+
+void usbd_flush_tx_fifo(usbd_core_type *udev, uint8_t ept_num)
+{
+}
+
+void usbd_ctrl_send(usbd_core_type *udev, uint8_t *buffer, uint16_t len)
+{
+}
+
+void usbd_ctrl_unsupport(usbd_core_type *udev)
+{
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static void device_init(void)
+{
+  memset(&dev, 0, sizeof(dev));
+  memset(&ept_in, 0, sizeof(ept_in));
+  memset(&ept_out, 0, sizeof(ept_out));
+  memset(winusb_class_handler.pdata, 0, sizeof(winusb_struct_type));
+  dev.class_handler = &winusb_class_handler;
+  dev.conn_state = USB_CONN_STATE_CONFIGURED;
+  host_primask = 1;
+  winusb_class_handler.init_handler(&dev);
+  host_primask = 0;
+}
+
+/* tx done callback of the application, called from the usb interrupt */
+static void app_tx_done(void *udev, uint8_t *buffer, uint32_t len)
+{
+  uint32_t index;
+
+  for(index = 0; index < app_buffers; index++)
+  {
+    if(buffer == app_buffer[index])
+    {
+      CHECK(app_busy[index] != 0);
+      app_busy[index] = 0;
+    }
+  }
+  tx_done_count++;
+}
+
+/* the loop of the winusb example, with app_buffers buffers */
+static uint32_t app_index, app_refused, app_sent;
+
+static void app_run(void)
+{
+  uint32_t data_len;
+
+  if(app_busy[app_index] == 0 && usb_winusb_stream_rx_count(&dev) != 0)
+  {
+    data_len = usb_winusb_stream_peek(&dev, app_buffer[app_index], sizeof(app_buffer[app_index]));
+
+    app_busy[app_index] = 1;
+    if(usb_winusb_stream_send(&dev, app_buffer[app_index], data_len) == SUCCESS)
+    {
+      usb_winusb_stream_commit(&dev, data_len);
+      app_sent++;
+      app_index = (app_index + 1) % app_buffers;
+    }
+    else
+    {
+      app_busy[app_index] = 0;
+      app_refused++;
+    }
+  }
+  CHECK(host_primask == 0);
+}
+
+/* one out token, returns the bytes taken, -1 for a nak */
+static int host_out(const uint8_t *data, uint32_t len)
+{
+  uint32_t n = (len < MPS) ? len : MPS;
+
+  if(ept_out.armed == 0)
+  {
+    return -1;
+  }
+  CHECK(ept_out.count + n <= ept_out.len);
+  memcpy(ept_out.buffer + ept_out.count, data, n);
+  ept_out.count += n;
+  if(n < MPS || ept_out.count == ept_out.len)
+  {
+    /* transfer complete interrupt */
+    ept_out.armed = 0;
+    host_primask = 1;
+    winusb_class_handler.out_handler(&dev, USBD_WINUSB_BULK_OUT_EPT);
+    host_primask = 0;
+  }
+  return (int)n;
+}
+
+/* one in token, returns the packet length, -1 for a nak */
+static int host_in(uint8_t *data)
+{
+  uint32_t n;
+
+  if(ept_in.armed == 0)
+  {
+    return -1;
+  }
+  n = ept_in.len - ept_in.count;
+  n = (n < MPS) ? n : MPS;
+  memcpy(data, ept_in.buffer + ept_in.count, n);
+  ept_in.count += n;
+  ept_in.packets++;
+  if(ept_in.count == ept_in.len)
+  {
+    ept_in.armed = 0;
+    host_primask = 1;
+    winusb_class_handler.in_handler(&dev, USBD_WINUSB_BULK_IN_EPT & 0x7F);
+    host_primask = 0;
+  }
+  return (int)n;
+}
+
+static uint32_t out_transfer_length(void)
+{
+  switch(rand_get() % 4)
+  {
+    case 0:
+      return 1 + rand_get() % (MPS - 1);
+    case 1:
+      return MPS * (1 + rand_get() % 32);
+    default:
+      return 1 + rand_get() % 4096;
+  }
+}
+
+static void loopback_test(uint32_t buffers)
+{
+  winusb_struct_type *p_winusb = (winusb_struct_type *)winusb_class_handler.pdata;
+  uint32_t written = 0, transfer = 0, read = 0, read_transfer = 0, frames = 0, slot;
+  uint32_t zlps = 0, naks_out = 0, naks_in = 0, last_len = 0, in_packets = 0, errors = 0;
+  uint8_t packet[MPS];
+  int n;
+
+  device_init();
+  app_buffers = buffers;
+  app_index = 0;
+  app_refused = 0;
+  app_sent = 0;
+  tx_done_count = 0;
+  memset(app_busy, 0, sizeof(app_busy));
+  usb_winusb_stream_tx_callback(&dev, app_tx_done);
+
+  while(read < STREAM_SIZE && frames < 100000)
+  {
+    frames++;
+    for(slot = 0; slot < FRAME_SLOTS; slot++)
+    {
+      if((slot & 1) == 0 && written < STREAM_SIZE)
+      {
+        if(transfer == 0)
+        {
+          transfer = out_transfer_length();
+          transfer = (transfer < STREAM_SIZE - written) ? transfer : STREAM_SIZE - written;
+        }
+        n = host_out(&stream[written], transfer);
+        if(n < 0)
+        {
+          naks_out++;
+        }
+        else
+        {
+          written += n;
+          transfer -= n;
+        }
+      }
+      else
+      {
+        n = host_in(packet);
+        if(n < 0)
+        {
+          naks_in++;
+        }
+        else
+        {
+          in_packets++;
+          if(n == 0)
+          {
+            /* only needed to end a read on a packet boundary */
+            zlps++;
+            CHECK(last_len == MPS && read_transfer != 0);
+          }
+          if(read + n > STREAM_SIZE || memcmp(packet, &stream[read], n) != 0)
+          {
+            errors++;
+          }
+          read += n;
+          read_transfer += n;
+          last_len = n;
+          /* the host read ends on a short packet or when it is full */
+          if(n < MPS || read_transfer == HOST_READ_SIZE)
+          {
+            read_transfer = 0;
+          }
+        }
+      }
+
+      /* a read left open after a full packet would never complete */
+      if(ept_in.armed == 0 && p_winusb->tx_count == 0 && in_packets != 0)
+      {
+        CHECK(last_len < MPS || read_transfer == 0);
+      }
+
+      app_run();
+    }
+  }
+
+  printf("loopback with %u buffers: %u bytes in %u frames, %.0f kB/s each way, in packets %u, zlp %u, "
+         "nak out %u in %u, refused sends %u, ring full %u\n",
+         buffers, read, frames, read / (double)frames, in_packets, zlps, naks_out, naks_in,
+         app_refused, p_winusb->rx_full_count);
+
+  CHECK(read == STREAM_SIZE && written == STREAM_SIZE);
+  CHECK(errors == 0);
+  CHECK(zlps == p_winusb->tx_zlp_count);
+  CHECK(ept_in.armed == 0 && p_winusb->tx_count == 0 && usb_winusb_stream_rx_count(&dev) == 0);
+  CHECK(tx_done_count == app_sent);
+  /* full speed bulk moves at most FRAME_SLOTS / 2 packets each way a frame */
+  CHECK(read / (double)frames > 0.8 * MPS * FRAME_SLOTS / 2);
+}
+
+/* an empty buffer is a single zero length packet */
+static void empty_send_test(void)
+{
+  winusb_struct_type *p_winusb = (winusb_struct_type *)winusb_class_handler.pdata;
+  uint8_t packet[MPS];
+  uint32_t packets = 0;
+
+  device_init();
+  app_buffers = 0;
+  tx_done_count = 0;
+  usb_winusb_stream_tx_callback(&dev, app_tx_done);
+
+  CHECK(usb_winusb_stream_send(&dev, app_buffer[0], 0) == SUCCESS);
+  while(host_in(packet) == 0)
+  {
+    packets++;
+  }
+  CHECK(packets == 1);
+  CHECK(tx_done_count == 1 && p_winusb->tx_zlp_count == 0);
+
+  /* a packet multiple ends with one */
+  CHECK(usb_winusb_stream_send(&dev, app_buffer[0], 2 * MPS) == SUCCESS);
+  packets = 0;
+  while(host_in(packet) >= 0)
+  {
+    packets++;
+  }
+  CHECK(packets == 3 && p_winusb->tx_zlp_count == 1);
+
+  /* nothing is queued while the device is not configured */
+  dev.conn_state = USB_CONN_STATE_DEFAULT;
+  CHECK(usb_winusb_stream_send(&dev, app_buffer[0], 1) == ERROR);
+}
+
+int main(void)
+{
+  uint32_t index;
+
+  for(index = 0; index < STREAM_SIZE; index++)
+  {
+    stream[index] = (uint8_t)rand_get();
+  }
+
+  /* two buffers as the example, then more than the in queue takes */
+  loopback_test(2);
+  loopback_test(APP_BUFFERS_MAX);
+  empty_send_test();
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
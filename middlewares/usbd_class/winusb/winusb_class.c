@@ -55,12 +55,21 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event);
 static usb_sts_type usbd_get_winusb_descriptor(usbd_core_type *udev);
 #endif
 static usb_sts_type winusb_struct_init(winusb_struct_type *p_winusb);
+static void winusb_stream_rx_arm(usbd_core_type *pudev, winusb_struct_type *p_winusb);
+static void winusb_stream_tx_start(usbd_core_type *pudev, winusb_struct_type *p_winusb);
+static uint32_t winusb_stream_rx_level(usbd_core_type *pudev, winusb_struct_type *p_winusb, uint32_t *head);
 
 /* winusb data struct */
 winusb_struct_type winusb_struct;
 
-/*winusb receive buffer define*/
-static uint32_t g_winusb_rx_buffer[16];
+/* winusb receive ring, one max packet of guard past the end for transfers
+   that wrap, the guard is copied to the start of the ring on completion */
+static uint32_t g_winusb_rx_ring[(USBD_WINUSB_STREAM_RX_SIZE + USBD_WINUSB_OUT_MAXPACKET_SIZE) / 4];
+
+/* in transfer state */
+#define WINUSB_TX_IDLE                   0
+#define WINUSB_TX_DATA                   1
+#define WINUSB_TX_ZLP                    2
 
 /* usb device class handler */
 usbd_class_handler winusb_class_handler =
@@ -97,9 +106,9 @@ static usb_sts_type class_init_handler(void *udev)
 
   /* open in endpoint */
   usbd_ept_open(pudev, USBD_WINUSB_BULK_IN_EPT, EPT_BULK_TYPE, USBD_WINUSB_IN_MAXPACKET_SIZE);
-  
-  /* set out endpoint to receive status */
-  usbd_ept_recv(pudev, USBD_WINUSB_BULK_OUT_EPT, p_winusb->g_rx_buff, USBD_WINUSB_OUT_MAXPACKET_SIZE);
+
+  /* start receiving into the ring */
+  winusb_stream_rx_arm(pudev, p_winusb);
 
   return status;
 }
@@ -251,12 +260,40 @@ static usb_sts_type class_in_handler(void *udev, uint8_t ept_num)
   usbd_core_type *pudev = (usbd_core_type *)udev;
   winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
   usb_sts_type status = USB_OK;
+  winusb_stream_tx_type done;
 
-  /* ...user code...
-    trans next packet data
-  */
   usbd_flush_tx_fifo(pudev, ept_num);
-  p_winusb->g_tx_completed = 1;
+
+  if(p_winusb->tx_state == WINUSB_TX_DATA)
+  {
+    p_winusb->tx_offset += p_winusb->tx_chunk;
+    if(p_winusb->tx_offset >= p_winusb->tx_queue[p_winusb->tx_head].len)
+    {
+      done = p_winusb->tx_queue[p_winusb->tx_head];
+      p_winusb->tx_head = (p_winusb->tx_head + 1) % USBD_WINUSB_STREAM_TX_DEPTH;
+      p_winusb->tx_count--;
+      p_winusb->tx_offset = 0;
+
+      if(p_winusb->tx_done != NULL)
+      {
+        p_winusb->tx_done(udev, done.buffer, done.len);
+      }
+
+      /* end the host read with a zero length packet when the data stops on
+         a packet boundary, back to back transfers are streamed without it.
+         an empty buffer went out as a zero length packet already */
+      if(p_winusb->tx_count == 0 && done.len != 0 && (done.len % p_winusb->maxpacket) == 0)
+      {
+        p_winusb->tx_state = WINUSB_TX_ZLP;
+        p_winusb->tx_zlp_count++;
+        usbd_ept_send(pudev, USBD_WINUSB_BULK_IN_EPT, NULL, 0);
+        return status;
+      }
+    }
+  }
+
+  p_winusb->tx_state = WINUSB_TX_IDLE;
+  winusb_stream_tx_start(pudev, p_winusb);
 
   return status;
 }
@@ -272,12 +309,23 @@ static usb_sts_type class_out_handler(void *udev, uint8_t ept_num)
   usb_sts_type status = USB_OK;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+  uint32_t len, pos, index;
 
   /* get endpoint receive data length  */
-  p_winusb->g_rxlen = usbd_get_recv_len(pudev, ept_num);
+  len = usbd_get_recv_len(pudev, ept_num);
+  pos = p_winusb->rx_head % USBD_WINUSB_STREAM_RX_SIZE;
+
+  /* move the part received into the guard to the start of the ring */
+  for(index = USBD_WINUSB_STREAM_RX_SIZE; index < pos + len; index++)
+  {
+    p_winusb->rx_ring[index - USBD_WINUSB_STREAM_RX_SIZE] = p_winusb->rx_ring[index];
+  }
+
+  p_winusb->rx_head += len;
+  p_winusb->rx_armed = 0;
 
-  /*set recv flag*/
-  p_winusb->g_rx_completed = 1;
+  /* keep receiving while there is room, the host is nak'ed otherwise */
+  winusb_stream_rx_arm(pudev, p_winusb);
 
   return status;
 }
@@ -339,40 +387,279 @@ static usb_sts_type class_event_handler(void *udev, usbd_event_type event)
   */
 static usb_sts_type winusb_struct_init(winusb_struct_type *p_winusb)
 {
-  p_winusb->g_tx_completed = 1;
-  p_winusb->g_rx_completed = 0;
   p_winusb->alt_setting = 0;
-  p_winusb->g_rx_buff = (uint8_t *)g_winusb_rx_buffer;
+  p_winusb->rx_ring = (uint8_t *)g_winusb_rx_ring;
+  p_winusb->rx_head = 0;
+  p_winusb->rx_tail = 0;
+  p_winusb->rx_armed = 0;
+  p_winusb->tx_head = 0;
+  p_winusb->tx_count = 0;
+  p_winusb->tx_offset = 0;
+  p_winusb->tx_state = WINUSB_TX_IDLE;
   return USB_OK;
 }
 
 /**
-  * @brief  usb device class rx data process
+  * @brief  arm the out endpoint at the ring head when it is idle and a packet
+  *         fits, caller is the usb interrupt or holds interrupts disabled
+  * @param  pudev: to the structure of usbd_core_type
+  * @param  p_winusb: to the structure of winusb_struct
+  * @retval none
+  */
+static void winusb_stream_rx_arm(usbd_core_type *pudev, winusb_struct_type *p_winusb)
+{
+  uint32_t pos, len, space;
+
+  if(p_winusb->rx_armed != 0)
+  {
+    return;
+  }
+
+  pos = p_winusb->rx_head % USBD_WINUSB_STREAM_RX_SIZE;
+  space = USBD_WINUSB_STREAM_RX_SIZE - (p_winusb->rx_head - p_winusb->rx_tail);
+
+  /* stop at the end of the ring, only a single packet may wrap into the guard */
+  len = USBD_WINUSB_STREAM_RX_SIZE - pos;
+  if(len < p_winusb->maxpacket)
+  {
+    len = p_winusb->maxpacket;
+  }
+  len = MIN(len, USBD_WINUSB_STREAM_RX_CHUNK);
+  len = MIN(len, space);
+  len -= len % p_winusb->maxpacket;
+
+  if(len == 0)
+  {
+    /* ring full, the endpoint stays disabled and naks the host */
+    p_winusb->rx_full_count++;
+    return;
+  }
+
+  p_winusb->rx_armed = 1;
+  p_winusb->rx_arm_len = (uint16_t)len;
+  usbd_ept_recv(pudev, USBD_WINUSB_BULK_OUT_EPT, &p_winusb->rx_ring[pos], (uint16_t)len);
+}
+
+/**
+  * @brief  received bytes in the ring. packets of an out transfer that is still
+  *         running are already in place, they are counted too so the data is
+  *         seen without waiting for the transfer to end.
+  * @param  pudev: to the structure of usbd_core_type
+  * @param  p_winusb: to the structure of winusb_struct
+  * @param  head: ring head at the time of the count, may be NULL
+  * @retval byte count
+  */
+static uint32_t winusb_stream_rx_level(usbd_core_type *pudev, winusb_struct_type *p_winusb, uint32_t *head)
+{
+  uint32_t level, primask;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if(head != NULL)
+  {
+    *head = p_winusb->rx_head;
+  }
+  level = p_winusb->rx_head - p_winusb->rx_tail;
+  if(p_winusb->rx_armed != 0)
+  {
+    level += usbd_get_recv_len(pudev, USBD_WINUSB_BULK_OUT_EPT);
+  }
+  __set_PRIMASK(primask);
+
+  return level;
+}
+
+/**
+  * @brief  start the next in transfer when the endpoint is idle, caller is the
+  *         usb interrupt or holds interrupts disabled
+  * @param  pudev: to the structure of usbd_core_type
+  * @param  p_winusb: to the structure of winusb_struct
+  * @retval none
+  */
+static void winusb_stream_tx_start(usbd_core_type *pudev, winusb_struct_type *p_winusb)
+{
+  winusb_stream_tx_type *tx;
+
+  if(p_winusb->tx_state != WINUSB_TX_IDLE || p_winusb->tx_count == 0)
+  {
+    return;
+  }
+
+  tx = &p_winusb->tx_queue[p_winusb->tx_head];
+  p_winusb->tx_chunk = (uint16_t)MIN(tx->len - p_winusb->tx_offset, USBD_WINUSB_STREAM_TX_CHUNK);
+  p_winusb->tx_state = WINUSB_TX_DATA;
+  usbd_ept_send(pudev, USBD_WINUSB_BULK_IN_EPT, tx->buffer + p_winusb->tx_offset, p_winusb->tx_chunk);
+}
+
+/**
+  * @brief  queue an in transfer, the buffer is sent without copy and must stay
+  *         valid until the tx done callback, see usb_winusb_stream_tx_callback
   * @param  udev: to the structure of usbd_core_type
-  * @param  recv_data: receive buffer
-  * @retval receive data len
+  * @param  buffer: data buffer
+  * @param  len: data length, any size
+  * @retval error status, ERROR when the queue is full or the device is not configured
   */
-uint16_t usb_winusb_get_rxdata(void *udev, uint8_t *recv_data)
+error_status usb_winusb_stream_send(void *udev, uint8_t *buffer, uint32_t len)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+  error_status status = ERROR;
+  uint32_t primask;
+  uint8_t tail;
+
+  if(usbd_connect_state_get(pudev) != USB_CONN_STATE_CONFIGURED)
+  {
+    return ERROR;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if(p_winusb->tx_count < USBD_WINUSB_STREAM_TX_DEPTH)
+  {
+    tail = (p_winusb->tx_head + p_winusb->tx_count) % USBD_WINUSB_STREAM_TX_DEPTH;
+    p_winusb->tx_queue[tail].buffer = buffer;
+    p_winusb->tx_queue[tail].len = len;
+    p_winusb->tx_count++;
+
+    winusb_stream_tx_start(pudev, p_winusb);
+    status = SUCCESS;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  number of in transfers that can still be queued
+  * @param  udev: to the structure of usbd_core_type
+  * @retval free queue entries
+  */
+uint8_t usb_winusb_stream_tx_free(void *udev)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+
+  return USBD_WINUSB_STREAM_TX_DEPTH - p_winusb->tx_count;
+}
+
+/**
+  * @brief  set the callback called when a queued in buffer has been sent
+  * @param  udev: to the structure of usbd_core_type
+  * @param  tx_done: callback, NULL for none
+  * @retval none
+  */
+void usb_winusb_stream_tx_callback(void *udev, winusb_stream_tx_done_type tx_done)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+
+  p_winusb->tx_done = tx_done;
+}
+
+/**
+  * @brief  number of received bytes waiting in the ring
+  * @param  udev: to the structure of usbd_core_type
+  * @retval byte count
+  */
+uint32_t usb_winusb_stream_rx_count(void *udev)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+
+  return winusb_stream_rx_level(pudev, p_winusb, NULL);
+}
+
+/**
+  * @brief  copy received data from the ring without taking it, the bytes stay
+  *         in the ring until usb_winusb_stream_commit
+  * @param  udev: to the structure of usbd_core_type
+  * @param  buffer: destination
+  * @param  len: destination size
+  * @retval bytes copied
+  */
+uint32_t usb_winusb_stream_peek(void *udev, uint8_t *buffer, uint32_t len)
 {
-  uint16_t i_index = 0;
-  uint16_t tmp_len = 0;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+  uint32_t count, head, done, pos, index;
+
+  count = winusb_stream_rx_level(pudev, p_winusb, &head);
+  count = MIN(len, count);
+  /* the tail is past the head once packets of the running transfer were read */
+  done = ((int32_t)(head - p_winusb->rx_tail) > 0) ? (head - p_winusb->rx_tail) : 0;
+  done = MIN(done, count);
 
-  if(p_winusb->g_rx_completed == 0)
+  /* completed transfers, wrapped at the end of the ring */
+  pos = p_winusb->rx_tail % USBD_WINUSB_STREAM_RX_SIZE;
+  for(index = 0; index < done; index++)
   {
-    return 0;
+    buffer[index] = p_winusb->rx_ring[pos];
+    if(++pos == USBD_WINUSB_STREAM_RX_SIZE)
+    {
+      pos = 0;
+    }
   }
-  p_winusb->g_rx_completed = 0;
-  tmp_len = p_winusb->g_rxlen;
-  for(i_index = 0; i_index < p_winusb->g_rxlen; i_index ++)
+
+  /* packets of the running transfer follow the head without wrapping, they
+     may sit in the guard, which is only reused after the tail has passed it */
+  pos = head % USBD_WINUSB_STREAM_RX_SIZE + (p_winusb->rx_tail + done - head);
+  for(; index < count; index++)
   {
-    recv_data[i_index] = p_winusb->g_rx_buff[i_index];
+    buffer[index] = p_winusb->rx_ring[pos++];
   }
 
-  usbd_ept_recv(pudev, USBD_WINUSB_BULK_OUT_EPT, p_winusb->g_rx_buff, p_winusb->maxpacket);
+  return count;
+}
+
+/**
+  * @brief  take received data out of the ring, the out endpoint is armed
+  *         again as soon as a packet fits
+  * @param  udev: to the structure of usbd_core_type
+  * @param  len: bytes to take, at most the count of the last peek
+  * @retval bytes taken
+  */
+uint32_t usb_winusb_stream_commit(void *udev, uint32_t len)
+{
+  usbd_core_type *pudev = (usbd_core_type *)udev;
+  winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
+  uint32_t count, primask;
+
+  count = MIN(len, winusb_stream_rx_level(pudev, p_winusb, NULL));
+  p_winusb->rx_tail += count;
 
-  return tmp_len;
+  if(count != 0 && p_winusb->rx_armed == 0 && usbd_connect_state_get(pudev) == USB_CONN_STATE_CONFIGURED)
+  {
+    primask = __get_PRIMASK();
+    __disable_irq();
+    winusb_stream_rx_arm(pudev, p_winusb);
+    __set_PRIMASK(primask);
+  }
+
+  return count;
+}
+
+/**
+  * @brief  read received data from the ring, the out endpoint is armed again
+  *         as soon as a packet fits
+  * @param  udev: to the structure of usbd_core_type
+  * @param  buffer: destination
+  * @param  len: destination size
+  * @retval bytes read
+  */
+uint32_t usb_winusb_stream_read(void *udev, uint8_t *buffer, uint32_t len)
+{
+  return usb_winusb_stream_commit(udev, usb_winusb_stream_peek(udev, buffer, len));
+}
+
+/**
+  * @brief  usb device class rx data process
+  * @param  udev: to the structure of usbd_core_type
+  * @param  recv_data: receive buffer, USBD_WINUSB_OUT_MAXPACKET_SIZE bytes
+  * @retval receive data len
+  */
+uint16_t usb_winusb_get_rxdata(void *udev, uint8_t *recv_data)
+{
+  return (uint16_t)usb_winusb_stream_read(udev, recv_data, USBD_WINUSB_OUT_MAXPACKET_SIZE);
 }
 
 /**
@@ -380,23 +667,19 @@ uint16_t usb_winusb_get_rxdata(void *udev, uint8_t *recv_data)
   * @param  udev: to the structure of usbd_core_type
   * @param  send_data: send data buffer
   * @param  len: send length
-  * @retval error status
+  * @retval error status, ERROR while a previous transfer is still queued
   */
 error_status usb_winusb_send_data(void *udev, uint8_t *send_data, uint16_t len)
 {
-  error_status status = SUCCESS;
   usbd_core_type *pudev = (usbd_core_type *)udev;
   winusb_struct_type *p_winusb = (winusb_struct_type *)pudev->class_handler->pdata;
-  if(p_winusb->g_tx_completed)
-  {
-    p_winusb->g_tx_completed = 0;
-    usbd_ept_send(pudev, USBD_WINUSB_BULK_IN_EPT, send_data, len);
-  }
-  else
+
+  if(p_winusb->tx_count != 0 || p_winusb->tx_state != WINUSB_TX_IDLE)
   {
-    status = ERROR;
+    return ERROR;
   }
-  return status;
+
+  return usb_winusb_stream_send(udev, send_data, len);
 }
 
 /**
@@ -62,6 +62,27 @@ extern "C" {
 
 #define WINUSB_BMS_VENDOR_CODE            0xA0
 
+/**
+  * @brief streaming buffers. out data is received straight into a ring of
+  *        USBD_WINUSB_STREAM_RX_SIZE bytes, the out endpoint is armed for up to
+  *        USBD_WINUSB_STREAM_RX_CHUNK bytes at a time and left disabled while the
+  *        ring is full, so the host is nak'ed until the application reads.
+  *        in transfers are queued without copy, USBD_WINUSB_STREAM_TX_DEPTH
+  *        buffers at a time, each sent as multi-packet transfers of at most
+  *        USBD_WINUSB_STREAM_TX_CHUNK bytes (1023 packets, the otg packet count limit).
+  *        sizes are multiples of the max packet size.
+  */
+#ifndef USBD_WINUSB_STREAM_RX_SIZE
+#define USBD_WINUSB_STREAM_RX_SIZE           2048
+#endif
+#ifndef USBD_WINUSB_STREAM_RX_CHUNK
+#define USBD_WINUSB_STREAM_RX_CHUNK          512
+#endif
+#ifndef USBD_WINUSB_STREAM_TX_DEPTH
+#define USBD_WINUSB_STREAM_TX_DEPTH          4
+#endif
+#define USBD_WINUSB_STREAM_TX_CHUNK          (1023 * USBD_WINUSB_IN_MAXPACKET_SIZE)
+
 /**
   * @}
   */
@@ -70,16 +91,48 @@ extern "C" {
   * @{
   */
 
+/**
+  * @brief in transfer done callback, called from the usb interrupt when the
+  *        buffer given to usb_winusb_stream_send is no longer used
+  */
+typedef void (*winusb_stream_tx_done_type)(void *udev, uint8_t *buffer, uint32_t len);
+
+/**
+  * @brief queued in transfer
+  */
+typedef struct
+{
+  uint8_t *buffer;
+  uint32_t len;
+}winusb_stream_tx_type;
+
 /**
   * @brief usb winusb class struct
   */
 typedef struct
 {
   uint32_t alt_setting;
-  uint8_t *g_rx_buff;
-  uint16_t g_len, g_rxlen;
-  __IO uint8_t g_tx_completed, g_rx_completed;
   uint32_t maxpacket;
+
+  /* out ring, rx_head and rx_tail are free running byte counts */
+  uint8_t *rx_ring;
+  __IO uint32_t rx_head;
+  __IO uint32_t rx_tail;
+  uint16_t rx_arm_len;
+  __IO uint8_t rx_armed;
+
+  /* in transfer queue */
+  winusb_stream_tx_type tx_queue[USBD_WINUSB_STREAM_TX_DEPTH];
+  winusb_stream_tx_done_type tx_done;
+  uint32_t tx_offset;
+  uint16_t tx_chunk;
+  uint8_t tx_head;
+  __IO uint8_t tx_count;
+  __IO uint8_t tx_state;
+
+  /* statistics */
+  uint32_t rx_full_count;
+  uint32_t tx_zlp_count;
 }winusb_struct_type;
 
 
@@ -93,6 +146,13 @@ typedef struct
 extern usbd_class_handler winusb_class_handler;
 uint16_t usb_winusb_get_rxdata(void *udev, uint8_t *recv_data);
 error_status usb_winusb_send_data(void *udev, uint8_t *send_data, uint16_t len);
+error_status usb_winusb_stream_send(void *udev, uint8_t *buffer, uint32_t len);
+uint8_t usb_winusb_stream_tx_free(void *udev);
+void usb_winusb_stream_tx_callback(void *udev, winusb_stream_tx_done_type tx_done);
+uint32_t usb_winusb_stream_read(void *udev, uint8_t *buffer, uint32_t len);
+uint32_t usb_winusb_stream_peek(void *udev, uint8_t *buffer, uint32_t len);
+uint32_t usb_winusb_stream_commit(void *udev, uint32_t len);
+uint32_t usb_winusb_stream_rx_count(void *udev);
 
 /**
   * @}
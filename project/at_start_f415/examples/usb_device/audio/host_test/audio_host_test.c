@@ -0,0 +1,481 @@
+/**
+  **************************************************************************
+  * @file     audio_host_test.c
+  * @brief    host model of the usb audio speaker clock recovery
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * runs audio_codec.c against a model of the usb host and the i2s codec:
+ * - every 1 ms frame the device gets a sof, the host sends an out packet
+ *   sized by the feedback it read last, polled every 2^FEEDBACK_REFRESH_TIME
+ *   frames as a host does, and the speaker dma plays the ring at the codec
+ *   clock in slices across the frame
+ * - the codec clock is off from the usb clock by a fixed ppm plus a slow
+ *   wander, one sof in 2000 is missed
+ * - usb rates of 48 khz (packets land in the ring) and of 44.1 and 16 khz
+ *   (packets go through the converter)
+ * - one case stops the stream for half a second and starts it again
+ * - the microphone dma fills its ring at the same codec clock and the host
+ *   reads one in packet per frame
+ * after the settling time no underrun and no overrun may happen, the fill
+ * level must stay near half of the ring and the mean feedback must match
+ * the codec clock at the usb rate.
+ * the host sends and the microphone records a numbered sample stream. at
+ * 48 khz, where no converter runs, every sample the speaker dma plays and
+ * every sample sent in an in packet must be the next one of the stream, in
+ * left/right order, silence aside. the dma moves by whole stereo frames
+ * between the calls of the codec, as the wait in codec_spk_dma_source makes
+ * sure on the target.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "audio_codec.h"
+#include "audio_class.h"
+#include "i2c_application.h"
+
+#define FRAME_SLICES                     8
+#define SETTLE_FRAMES                    60000
+#define RUN_FRAMES                       300000
+#define PAUSE_FRAMES                     500
+#define SOF_MISS                         2000
+#define FILL_MARGIN                      (SPK_BUFFER_SIZE / 8)
+#define FB_ERROR_PPM                     30.0
+
+/* a left sample is even and never 0, its right sample the next odd value,
+   0 is silence */
+#define SAMPLE_LEFT(seq)                 ((uint16_t)((((seq) % 0x7FFF) + 1) * 2))
+#define SAMPLE_NEXT(left)                ((uint16_t)(((left) == 0xFFFE) ? 2 : (left) + 2))
+
+typedef struct
+{
+  uint32_t usb_freq;
+  double ppm;
+  double wander;
+  uint32_t pause_at;
+} audio_case_type;
+
+static const audio_case_type cases[] =
+{
+  {AUDIO_FREQ_48K,      0.0,  0.0,      0},
+  {AUDIO_FREQ_48K,    300.0, 20.0,      0},
+  {AUDIO_FREQ_48K,   -300.0, 20.0,      0},
+  {AUDIO_FREQ_48K,   1000.0, 50.0,      0},
+  {AUDIO_FREQ_48K,  -1000.0, 50.0,      0},
+  {AUDIO_FREQ_48K,    500.0, 20.0, 150000},
+  {AUDIO_FREQ_44_1K,  300.0, 20.0,      0},
+  {AUDIO_FREQ_44_1K, -300.0, 20.0,      0},
+  {AUDIO_FREQ_16K,    200.0, 20.0,      0},
+};
+
+extern audio_codec_type audio_codec;
+
+dma_channel_type host_dma_spk;
+dma_channel_type host_dma_mic;
+unsigned int system_core_clock = 144000000;
+
+static uint32_t spk_seq, mic_seq;
+static uint16_t spk_left, spk_next, mic_next;
+static uint8_t spk_synced, mic_synced, checking;
+static uint32_t spk_breaks, spk_swaps, spk_played, mic_breaks, mic_swaps, mic_sent;
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+/* the i2s dma channels, only what the codec programs */
+void dma_reset(dma_channel_type* dmax_channely)
+{
+  memset(dmax_channely, 0, sizeof(dma_channel_type));
+}
+
+void dma_default_para_init(dma_init_type* dma_init_struct)
+{
+  memset(dma_init_struct, 0, sizeof(dma_init_type));
+}
+
+void dma_init(dma_channel_type* dmax_channely, dma_init_type* dma_init_struct)
+{
+  dmax_channely->maddr = dma_init_struct->memory_base_addr;
+  dmax_channely->dtcnt = dma_init_struct->buffer_size;
+  dmax_channely->ctrl_bit.mincm = dma_init_struct->memory_inc_enable;
+  dmax_channely->ctrl_bit.lm = dma_init_struct->loop_mode_enable;
+}
+
+void dma_channel_enable(dma_channel_type* dmax_channely, confirm_state new_state)
+{
+  dmax_channely->ctrl_bit.chen = new_state;
+}
+
+/* the rest of the hardware init does nothing here */
+void crm_periph_clock_enable(crm_periph_clock_type value, confirm_state new_state)
+{
+}
+
+void gpio_default_para_init(gpio_init_type *gpio_init_struct)
+{
+}
+
+void gpio_init(gpio_type *gpio_x, gpio_init_type *gpio_init_struct)
+{
+}
+
+void spi_i2s_reset(spi_type *spi_x)
+{
+}
+
+void i2s_default_para_init(i2s_init_type* i2s_init_struct)
+{
+}
+
+void i2s_init(spi_type* spi_x, i2s_init_type* i2s_init_struct)
+{
+}
+
+void i2s_enable(spi_type* spi_x, confirm_state new_state)
+{
+}
+
+void spi_i2s_dma_transmitter_enable(spi_type* spi_x, confirm_state new_state)
+{
+}
+
+void spi_i2s_dma_receiver_enable(spi_type* spi_x, confirm_state new_state)
+{
+}
+
+void tmr_base_init(tmr_type* tmr_x, uint32_t tmr_pr, uint32_t tmr_div)
+{
+}
+
+void tmr_cnt_dir_set(tmr_type *tmr_x, tmr_count_mode_type tmr_cnt_dir)
+{
+}
+
+void tmr_clock_source_div_set(tmr_type *tmr_x, tmr_clock_division_type tmr_clock_div)
+{
+}
+
+void tmr_output_default_para_init(tmr_output_config_type *tmr_output_struct)
+{
+}
+
+void tmr_output_channel_config(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, tmr_output_config_type *tmr_output_struct)
+{
+}
+
+void tmr_channel_value_set(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, uint32_t tmr_channel_value)
+{
+}
+
+void tmr_output_channel_buffer_enable(tmr_type *tmr_x, tmr_channel_select_type tmr_channel, confirm_state new_state)
+{
+}
+
+void tmr_counter_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void tmr_output_enable(tmr_type *tmr_x, confirm_state new_state)
+{
+}
+
+void i2c_config(i2c_handle_type* hi2c)
+{
+}
+
+i2c_status_type i2c_master_transmit(i2c_handle_type* hi2c, uint16_t address, uint8_t* pdata, uint16_t size, uint32_t timeout)
+{
+  return I2C_OK;
+}
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+/* one sample the codec plays, from the ring or the silence word */
+static void spk_play(uint16_t value, uint8_t right)
+{
+  if(right)
+  {
+    if(value != ((spk_left == 0) ? 0 : spk_left + 1))
+    {
+      spk_swaps += checking;
+    }
+    return;
+  }
+
+  spk_left = value;
+  if(value == 0)
+  {
+    spk_synced = 0;
+    return;
+  }
+  if((value & 1) != 0)
+  {
+    spk_swaps += checking;
+  }
+  else if(spk_synced && value != spk_next)
+  {
+    spk_breaks += checking;
+  }
+  spk_next = SAMPLE_NEXT(value);
+  spk_synced = 1;
+  spk_played++;
+}
+
+/* one stereo frame of the speaker dma at the codec clock */
+static void spk_dma_frame(void)
+{
+  uint16_t *memory = (uint16_t *)(uintptr_t)host_dma_spk.maddr;
+  uint8_t right;
+
+  for(right = 0; right < AUDIO_SPK_CHANEL_NUM; right++)
+  {
+    if(host_dma_spk.ctrl_bit.chen == FALSE)
+    {
+      return;
+    }
+    spk_play(host_dma_spk.ctrl_bit.mincm ? memory[SPK_BUFFER_SIZE - host_dma_spk.dtcnt] : memory[0], right);
+    if(--host_dma_spk.dtcnt == 0)
+    {
+      host_dma_spk.dtcnt = SPK_BUFFER_SIZE;
+    }
+  }
+}
+
+/* one stereo frame of the microphone dma at the codec clock */
+static void mic_dma_frame(void)
+{
+  uint16_t *memory = (uint16_t *)(uintptr_t)host_dma_mic.maddr;
+  uint8_t right;
+
+  for(right = 0; right < AUDIO_MIC_CHANEL_NUM; right++)
+  {
+    if(host_dma_mic.ctrl_bit.chen == FALSE)
+    {
+      return;
+    }
+    memory[MIC_BUFFER_SIZE - host_dma_mic.dtcnt] = SAMPLE_LEFT(mic_seq) + right;
+    if(--host_dma_mic.dtcnt == 0)
+    {
+      host_dma_mic.dtcnt = MIC_BUFFER_SIZE;
+    }
+  }
+  mic_seq++;
+}
+
+/* the out packet the host sends, the next samples of the stream */
+static void spk_packet(uint8_t *rx, uint32_t samples)
+{
+  uint16_t *data = (uint16_t *)rx;
+  uint32_t index;
+
+  for(index = 0; index < samples; index++, spk_seq++)
+  {
+    data[index * 2] = SAMPLE_LEFT(spk_seq);
+    data[index * 2 + 1] = SAMPLE_LEFT(spk_seq) + 1;
+  }
+  audio_codec_spk_fifo_commit(samples * AUDIO_SPK_CHANEL_NUM * sizeof(uint16_t));
+}
+
+/* the in packet the host reads */
+static void mic_packet(uint32_t usb_freq)
+{
+  uint8_t *buffer;
+  uint16_t *data;
+  uint32_t len = audio_codec_mic_get_data(&buffer), frames, index;
+
+  data = (uint16_t *)buffer;
+  frames = len / (AUDIO_MIC_CHANEL_NUM * sizeof(uint16_t));
+  CHECK(len % (AUDIO_MIC_CHANEL_NUM * sizeof(uint16_t)) == 0);
+  CHECK(len <= AUDIO_MIC_IN_MAXPACKET_SIZE);
+  CHECK(frames + 2 >= usb_freq / 1000 && frames <= usb_freq / 1000 + 2);
+  if(usb_freq != AUDIO_CODEC_FREQ)
+  {
+    return;
+  }
+
+  for(index = 0; index < frames; index++)
+  {
+    if(data[index * 2] == 0)
+    {
+      /* the ring before the dma filled it */
+      mic_synced = 0;
+      continue;
+    }
+    if(((data[index * 2] & 1) != 0) || (data[index * 2 + 1] != data[index * 2] + 1))
+    {
+      mic_swaps += checking;
+    }
+    else if(mic_synced && data[index * 2] != mic_next)
+    {
+      mic_breaks += checking;
+    }
+    mic_next = SAMPLE_NEXT(data[index * 2]);
+    mic_synced = 1;
+    mic_sent++;
+  }
+}
+
+static void run(const audio_case_type *c)
+{
+  uint32_t frame, slice, feedback, usb_feedback, samples, underrun = 0, overrun = 0;
+  uint64_t host_acc = 0;
+  int32_t fill, fill_min = SPK_BUFFER_SIZE, fill_max = 0;
+  double codec_acc = 0, ppm, fb_error, fb_error_sum = 0, fb_error_max = 0;
+  uint32_t fb_count = 0, stream = 1;
+  uint8_t fb[3], *rx;
+
+  memset(&audio_codec, 0, sizeof(audio_codec));
+  memset(&host_dma_spk, 0, sizeof(host_dma_spk));
+  memset(&host_dma_mic, 0, sizeof(host_dma_mic));
+  spk_synced = mic_synced = 0;
+  spk_breaks = spk_swaps = spk_played = 0;
+  mic_breaks = mic_swaps = mic_sent = 0;
+  CHECK(audio_codec_init() == SUCCESS);
+  audio_codec_set_spk_freq(c->usb_freq);
+  audio_codec_set_mic_freq(c->usb_freq);
+  audio_codec_spk_alt_setting(1);
+  rx = audio_codec_spk_rx_buffer();
+  audio_codec_spk_feedback(fb);
+  usb_feedback = fb[0] | (fb[1] << 8) | (fb[2] << 16);
+
+  for(frame = 0; frame < RUN_FRAMES; frame++)
+  {
+    ppm = c->ppm + c->wander * sin(2 * M_PI * frame / 200000.0);
+    checking = (frame >= SETTLE_FRAMES) &&
+               ((c->pause_at == 0) || (frame < c->pause_at) || (frame >= c->pause_at + PAUSE_FRAMES + SETTLE_FRAMES));
+
+    if(c->pause_at != 0 && frame == c->pause_at)
+    {
+      /* the host selects alternate setting 0, then 1 again */
+      stream = 0;
+      audio_codec_spk_alt_setting(0);
+    }
+    if(c->pause_at != 0 && frame == c->pause_at + PAUSE_FRAMES)
+    {
+      stream = 1;
+      audio_codec_spk_alt_setting(1);
+      rx = audio_codec_spk_rx_buffer();
+    }
+
+    if((rand_get() % SOF_MISS) != 0)
+    {
+      audio_codec_spk_sof(frame & 0x7FF);
+    }
+
+    if((frame & ((1 << FEEDBACK_REFRESH_TIME) - 1)) == 0)
+    {
+      audio_codec_spk_feedback(fb);
+      usb_feedback = fb[0] | (fb[1] << 8) | (fb[2] << 16);
+    }
+
+    for(slice = 0; slice < FRAME_SLICES; slice++)
+    {
+      if(slice == FRAME_SLICES / 2 && stream)
+      {
+        /* the out packet, sized by the feedback */
+        host_acc += usb_feedback;
+        samples = (uint32_t)(host_acc >> 14);
+        host_acc -= (uint64_t)samples << 14;
+        CHECK(samples * AUDIO_SPK_CHANEL_NUM * sizeof(uint16_t) <= AUDIO_SPK_OUT_MAXPACKET_SIZE);
+        spk_packet(rx, samples);
+        rx = audio_codec_spk_rx_buffer();
+      }
+      if(slice == FRAME_SLICES / 4)
+      {
+        mic_packet(c->usb_freq);
+      }
+
+      codec_acc += AUDIO_CODEC_FREQ * (1 + ppm * 1e-6) / (1000.0 * FRAME_SLICES);
+      while(codec_acc >= 1)
+      {
+        codec_acc -= 1;
+        spk_dma_frame();
+        mic_dma_frame();
+      }
+    }
+
+    if(frame == SETTLE_FRAMES || (c->pause_at != 0 && frame == c->pause_at + PAUSE_FRAMES + SETTLE_FRAMES))
+    {
+      underrun = audio_codec.spk_underrun;
+      overrun = audio_codec.spk_overrun;
+      fill_min = SPK_BUFFER_SIZE;
+      fill_max = 0;
+      fb_error_sum = 0;
+      fb_error_max = 0;
+      fb_count = 0;
+    }
+    if(checking)
+    {
+      fill = (int32_t)(audio_codec.spk_wtotal - audio_codec.spk_rtotal);
+      fill_min = (fill < fill_min) ? fill : fill_min;
+      fill_max = (fill > fill_max) ? fill : fill_max;
+
+      /* feedback against the codec clock at the usb rate, in ppm */
+      feedback = audio_codec.spk_feedback;
+      fb_error = (feedback / 16384.0) / (c->usb_freq * (1 + ppm * 1e-6) / 1000.0) * 1e6 - 1e6;
+      fb_error_sum += fb_error;
+      fb_error_max = (fabs(fb_error) > fb_error_max) ? fabs(fb_error) : fb_error_max;
+      fb_count++;
+    }
+  }
+
+  printf("usb %5u hz codec %+6.0f ppm +-%2.0f%s: underrun %u overrun %u fill %d..%d feedback error mean %+5.1f peak %5.1f ppm\n",
+         c->usb_freq, c->ppm, c->wander, c->pause_at ? " restart" : "",
+         audio_codec.spk_underrun - underrun, audio_codec.spk_overrun - overrun, fill_min, fill_max,
+         fb_error_sum / fb_count, fb_error_max);
+  if(c->usb_freq == AUDIO_CODEC_FREQ)
+  {
+    printf("  played %u samples: %u breaks %u swaps, sent %u samples: %u breaks %u swaps\n",
+           spk_played, spk_breaks, spk_swaps, mic_sent, mic_breaks, mic_swaps);
+    CHECK(spk_played > (RUN_FRAMES - SETTLE_FRAMES) * (AUDIO_CODEC_FREQ / 1000));
+    CHECK(mic_sent > (RUN_FRAMES - SETTLE_FRAMES) * (AUDIO_CODEC_FREQ / 1000));
+    CHECK(spk_breaks == 0 && spk_swaps == 0);
+    CHECK(mic_breaks == 0 && mic_swaps == 0);
+  }
+
+  CHECK(audio_codec.spk_stage == 2);
+  CHECK(audio_codec.spk_underrun == underrun);
+  CHECK(audio_codec.spk_overrun == overrun);
+  CHECK(fill_min >= SPK_BUFFER_SIZE / 2 - FILL_MARGIN);
+  CHECK(fill_max <= SPK_BUFFER_SIZE / 2 + FILL_MARGIN);
+  CHECK(fabs(fb_error_sum / fb_count) < FB_ERROR_PPM);
+  CHECK(host_primask == 0);
+}
+
+int main(void)
+{
+  uint32_t index;
+
+  for(index = 0; index < sizeof(cases) / sizeof(cases[0]); index++)
+  {
+    run(&cases[index]);
+  }
+
+  printf("%s\n", fails ? "FAILED" : "PASSED");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+/**
+  **************************************************************************
+  * @file     audio_host_test.h
+  * @brief    i2s dma channels of the audio codec host test
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __AUDIO_HOST_TEST_H
+#define __AUDIO_HOST_TEST_H
+
+/* forced into every source of the test after at32_host.h: the speaker and
+   microphone i2s dma channels are memory of the test, which moves their
+   counters at the codec clock */
+extern dma_channel_type host_dma_spk;
+extern dma_channel_type host_dma_mic;
+
+#undef DMA1_CHANNEL3
+#define DMA1_CHANNEL3                    (&host_dma_spk)
+#undef DMA1_CHANNEL4
+#define DMA1_CHANNEL4                    (&host_dma_mic)
+
+#endif
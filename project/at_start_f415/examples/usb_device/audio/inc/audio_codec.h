@@ -42,6 +42,9 @@ extern "C" {
 
 /* includes ------------------------------------------------------------------*/
 #include "usb_conf.h"
+#include "audio_conf.h"
+#include "audio_src.h"
+#include "audio_mixer.h"
 
 /** @defgroup USB_device_audio_codec_reg_definition
   * @{
@@ -126,44 +129,77 @@ extern "C" {
 /** @defgroup USB_device_audio_codec_exported_functions
   * @{
   */
+/**
+  * @brief the codec always runs at AUDIO_CODEC_FREQ, other usb rates go through
+  *        the sample rate converters.
+  */
+#define AUDIO_CODEC_FREQ  AUDIO_FREQ_48K
+
 #define MIC_BUFFER_SIZE   1024
 #define SPK_BUFFER_SIZE   4096
-#define DMA_BUFFER_SIZE   288
+
+/**
+  * @brief the i2s dma rings are the usb packet buffers, the guard after each ring
+  *        holds the part of a packet that crosses the ring end. in halfwords, at
+  *        least AUDIO_SPK_OUT_MAXPACKET_SIZE / AUDIO_MIC_IN_MAXPACKET_SIZE bytes,
+  *        the usb side buffers of the converters have the same size.
+  */
+#define SPK_RING_GUARD    128
+#define MIC_RING_GUARD    128
+
+/**
+  * @brief speaker clock recovery: the i2s dma counter is sampled at every sof to
+  *        measure the codec rate in samples per usb frame, a pi controller on the
+  *        fifo fill level trims it and the result is the 10.14 feedback value.
+  */
+#define SPK_FB_MEASURE_FRAMES            1024     /* rate measurement window in frames */
+#define SPK_FB_PI_FRAMES                 64       /* pi controller period in frames */
+#define SPK_FB_KP                        8        /* 10.14 units per sample of fill error */
+#define SPK_FB_KI                        1        /* 10.14 units per sample of fill error per period */
+#define SPK_FB_LIMIT_SHIFT               7        /* feedback kept within nominal +- nominal/128 */
+#define SPK_SOF_MAX_GAP                  32       /* longest sof gap the dma position survives, in frames */
 
 typedef struct
 {
   uint32_t audio_freq;
   uint32_t audio_bitw;
-  //spk part
-  uint16_t spk_buffer[SPK_BUFFER_SIZE];
-  uint16_t *spk_roff;
+  //spk part, usb out packets are received in the i2s dma ring
+  uint16_t spk_buffer[SPK_BUFFER_SIZE + SPK_RING_GUARD];
   uint16_t *spk_woff;
-  uint16_t *spk_rend;
-  uint32_t spk_freq;
+  uint16_t spk_zero;
   uint32_t spk_wtotal;
   uint32_t spk_rtotal;
-  uint16_t spk_threshold;
-  uint16_t spk_calc;
   uint8_t  spk_stage;
-
-  //mic part
-  uint16_t mic_buffer[MIC_BUFFER_SIZE];
+  uint8_t  spk_drop;
+  uint32_t spk_usb_freq;
+  int16_t  spk_usb_buffer[SPK_RING_GUARD];
+  audio_src_type spk_src;
+  audio_mixer_type spk_mixer;
+
+  //spk clock recovery
+  uint32_t spk_feedback;
+  uint32_t spk_fb_nominal;
+  uint32_t spk_fb_measured;
+  int32_t  spk_fb_integral;
+  uint32_t spk_sof_samples;
+  uint16_t spk_sof_frames;
+  uint16_t spk_sof_fn;
+  uint16_t spk_dma_pos;
+  uint16_t spk_pi_count;
+  uint8_t  spk_sof_sync;
+  int32_t  spk_fill_sum;
+  uint32_t spk_underrun;
+  uint32_t spk_overrun;
+
+  //mic part, usb in packets are sent from the i2s dma ring
+  uint16_t mic_buffer[MIC_BUFFER_SIZE + MIC_RING_GUARD];
   uint16_t *mic_roff;
-  uint16_t *mic_woff;
-  uint16_t *mic_wend;
-  uint32_t mic_wtotal;
-  uint32_t mic_rtotal;
-  uint32_t mic_delta;
-  uint16_t mic_calc;
-  uint16_t mic_adj_count;
-  uint8_t  mic_adj_stage;
   uint8_t  mic_stage;
-
-  uint8_t mic_mute;
-  uint8_t spk_mute;
-
-  uint16_t mic_volume;
-  uint16_t spk_volume;
+  uint32_t mic_usb_freq;
+  uint32_t mic_usb_acc;
+  int16_t  mic_usb_buffer[MIC_RING_GUARD];
+  audio_src_type mic_src;
+  audio_mixer_type mic_mixer;
 
   uint32_t spk_tx_size;
   uint32_t mic_rx_size;
@@ -175,14 +211,15 @@ typedef struct
 
 error_status audio_codec_init(void);
 error_status audio_codec_loop(void);
-void audio_codec_modify_freq(uint32_t freq);
 
 /**
   * @brief audio codec interface
   */
-void audio_codec_spk_fifo_write(uint8_t *data, uint32_t len);
-uint32_t audio_codec_mic_get_data(uint8_t *buffer);
+uint8_t *audio_codec_spk_rx_buffer(void);
+void audio_codec_spk_fifo_commit(uint32_t len);
+uint32_t audio_codec_mic_get_data(uint8_t **buffer);
 uint8_t audio_codec_spk_feedback(uint8_t *feedback);
+void audio_codec_spk_sof(uint32_t frame_number);
 void audio_codec_spk_alt_setting(uint32_t alt_seting);
 void audio_codec_mic_alt_setting(uint32_t alt_seting);
 void audio_codec_set_mic_mute(uint8_t mute);
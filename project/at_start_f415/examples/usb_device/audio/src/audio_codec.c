@@ -103,44 +103,54 @@ uint16_t reg_addr_data[] =
 i2c_handle_type hi2cx;
 
 audio_codec_type audio_codec;
-uint16_t spk_dma_buffer[DMA_BUFFER_SIZE];
-uint16_t mic_dma_buffer[DMA_BUFFER_SIZE];
 
 void memset16_buffer(uint16_t *buffer, uint32_t set, uint32_t len);
-void codec_i2s_reset(void);
 void codec_i2s_init(audio_codec_type *param);
 void mclk_tmr1_init(void);
 void copy_buff(uint16_t *dest, uint16_t *src, uint32_t len);
+static void codec_spk_dma_source(uint16_t *addr, confirm_state inc);
+static void codec_spk_silence(void);
+static uint32_t codec_spk_feedback_usb(uint32_t feedback);
 
 /**
-  * @brief  audio codec set microphone freq
-  * @param  freq: freq (wm8988 microphone and speaker must same freq)
+  * @brief  audio codec set microphone freq, the codec keeps running at
+  *         AUDIO_CODEC_FREQ and the converter follows the usb rate
+  * @param  freq: usb freq
   * @retval none
   */
 void audio_codec_set_mic_freq(uint32_t freq)
 {
-  if(audio_codec.audio_freq != freq)
+  if(audio_codec.mic_usb_freq != freq)
   {
-    audio_codec.audio_freq = freq;
-    codec_i2s_reset();
-    audio_codec_modify_freq(freq);
-    codec_i2s_init(&audio_codec);
+    if(audio_src_init(&audio_codec.mic_src, audio_codec.audio_freq, freq, AUDIO_MIC_CHANEL_NUM) == SUCCESS)
+    {
+      audio_codec.mic_usb_freq = freq;
+      audio_codec.mic_usb_acc = 0;
+      audio_codec.mic_stage = 0;
+    }
   }
 }
 
 /**
-  * @brief  audio codec set speaker freq
-  * @param  freq: freq(wm8988 microphone and speaker must same freq)
+  * @brief  audio codec set speaker freq, the codec keeps running at
+  *         AUDIO_CODEC_FREQ and the converter follows the usb rate
+  * @param  freq: usb freq
   * @retval none
   */
 void audio_codec_set_spk_freq(uint32_t freq)
 {
-  if(audio_codec.audio_freq != freq)
+  if(audio_codec.spk_usb_freq != freq)
   {
-    audio_codec.audio_freq = freq;
-    codec_i2s_reset();
-    audio_codec_modify_freq(freq);
-    codec_i2s_init(&audio_codec);
+    if(audio_src_init(&audio_codec.spk_src, freq, audio_codec.audio_freq, AUDIO_SPK_CHANEL_NUM) == SUCCESS)
+    {
+      /* restart from silence, the ring holds samples of the old stream */
+      if(audio_codec.spk_stage != 0)
+      {
+        codec_spk_silence();
+      }
+      audio_codec.spk_usb_freq = freq;
+      audio_codec.spk_feedback = codec_spk_feedback_usb(audio_codec.spk_fb_measured);
+    }
   }
 }
 
@@ -154,6 +164,11 @@ void audio_codec_spk_alt_setting(uint32_t alt_seting)
 {
   if(alt_seting == 0)
   {
+    /* host stopped the stream, play silence until it restarts */
+    if(audio_codec.spk_stage != 0)
+    {
+      codec_spk_silence();
+    }
   }
   else
   {
@@ -169,6 +184,8 @@ void audio_codec_mic_alt_setting(uint32_t alt_seting)
 {
   if(alt_seting == 0)
   {
+    /* resync the read position to the dma when the stream restarts */
+    audio_codec.mic_stage = 0;
   }
   else
   {
@@ -182,7 +199,7 @@ void audio_codec_mic_alt_setting(uint32_t alt_seting)
   */
 void audio_codec_set_mic_mute(uint8_t mute)
 {
-  audio_codec.mic_mute = mute;
+  audio_mixer_set_mute(&audio_codec.mic_mixer, mute ? TRUE : FALSE);
 }
 
 
@@ -193,7 +210,7 @@ void audio_codec_set_mic_mute(uint8_t mute)
   */
 void audio_codec_set_spk_mute(uint8_t mute)
 {
-  audio_codec.spk_mute = mute;
+  audio_mixer_set_mute(&audio_codec.spk_mixer, mute ? TRUE : FALSE);
 }
 
 
@@ -204,12 +221,12 @@ void audio_codec_set_spk_mute(uint8_t mute)
   */
 void audio_codec_set_mic_volume(uint16_t volume)
 {
-  /* wm8988 adc have 256 steps */
-  audio_codec.mic_volume = volume;
-  if(audio_codec.mic_volume > 0xFF)
+  /* 256 steps over the mixer range */
+  if(volume > 0xFF)
   {
-    audio_codec.mic_volume = 0xFF;
+    volume = 0xFF;
   }
+  audio_mixer_set_volume(&audio_codec.mic_mixer, (uint8_t)(((0xFF - volume) * AUDIO_MIXER_RANGE_DB) / 0xFF));
 }
 
 /**
@@ -219,8 +236,19 @@ void audio_codec_set_mic_volume(uint16_t volume)
   */
 void audio_codec_set_spk_volume(uint16_t volume)
 {
-  /* wm8988 dac have 80 steps */
-  audio_codec.spk_volume = (volume * 0x50) / 0x64 + 0x30 - 1;
+  /* percent over the mixer range, 0 is off */
+  if(volume > 100)
+  {
+    volume = 100;
+  }
+  if(volume == 0)
+  {
+    audio_mixer_set_volume(&audio_codec.spk_mixer, AUDIO_MIXER_RANGE_DB + 1);
+  }
+  else
+  {
+    audio_mixer_set_volume(&audio_codec.spk_mixer, (uint8_t)(((100 - volume) * AUDIO_MIXER_RANGE_DB) / 100));
+  }
 }
 
 /**
@@ -230,8 +258,8 @@ void audio_codec_set_spk_volume(uint16_t volume)
   */
 uint8_t audio_codec_spk_feedback(uint8_t *feedback)
 {
-  uint32_t feedback_value = (audio_codec.spk_freq);
-  feedback_value = ((feedback_value/1000)<<14)|((feedback_value%1000)<<4);
+  /* 10.14 samples per frame */
+  uint32_t feedback_value = audio_codec.spk_feedback;
   feedback[0] = (uint8_t)(feedback_value);
   feedback[1] = (uint8_t)(feedback_value >> 8);
   feedback[2] = (uint8_t)(feedback_value >> 16);
@@ -239,127 +267,327 @@ uint8_t audio_codec_spk_feedback(uint8_t *feedback)
 }
 
 /**
-  * @brief  codec speaker write fifo
-  * @param  data: data buffer
-  * @param  len: data length
+  * @brief  speaker feedback at the usb rate from samples per frame at the
+  *         codec rate.
+  * @param  feedback: 10.14 codec samples per frame
+  * @retval 10.14 usb samples per frame
+  */
+static uint32_t codec_spk_feedback_usb(uint32_t feedback)
+{
+  return (uint32_t)(((uint64_t)feedback * audio_codec.spk_usb_freq) / audio_codec.audio_freq);
+}
+
+/**
+  * @brief  codec speaker clock recovery, called at every sof.
+  *         the i2s dma counter runs on the codec clock, sampling it at sof gives
+  *         the codec rate in samples per host frame. a pi controller on the fifo
+  *         fill level trims the measured rate so that the fifo stays half full.
+  * @param  frame_number: usb frame number
   * @retval none
   */
-void audio_codec_spk_fifo_write(uint8_t *data, uint32_t len)
+void audio_codec_spk_sof(uint32_t frame_number)
 {
-  uint16_t ulen = len / 2, i;
-  uint16_t *u16data = (uint16_t *)data;
-
-  switch(audio_codec.spk_stage)
-  {
-    case 0:
-      audio_codec.spk_woff = audio_codec.spk_roff = audio_codec.spk_buffer;
-      audio_codec.spk_wtotal = audio_codec.spk_rtotal = 0;
-      audio_codec.spk_stage = 1;
-      audio_codec.spk_threshold = SPK_BUFFER_SIZE/2;
-      break;
-    case 1:
-      if( audio_codec.spk_wtotal >= SPK_BUFFER_SIZE/2 )
-      {
-        audio_codec.spk_stage = 2;
-      }
-      break;
-    case 2:
-      break;
+  uint16_t dma_pos = (SPK_BUFFER_SIZE - DMA1_CHANNEL3->dtcnt) % SPK_BUFFER_SIZE;
+  uint16_t frames = (frame_number - audio_codec.spk_sof_fn) & 0x7FF;
+  uint16_t consumed = (dma_pos + SPK_BUFFER_SIZE - audio_codec.spk_dma_pos) % SPK_BUFFER_SIZE;
+  uint32_t measured;
+  int32_t fill, error, limit, feedback;
+
+  audio_codec.spk_sof_fn = frame_number;
+  audio_codec.spk_dma_pos = dma_pos;
+
+  /* the dma reads the ring in place, its progress is the read total */
+  audio_codec.spk_rtotal += consumed;
+
+  /* the ring lasts more than SPK_SOF_MAX_GAP frames, after a longer gap
+     (suspend, dma restart) the dma position is ambiguous: restart the window */
+  if(audio_codec.spk_sof_sync == 0 || frames > SPK_SOF_MAX_GAP)
+  {
+    audio_codec.spk_sof_sync = 1;
+    audio_codec.spk_sof_frames = 0;
+    audio_codec.spk_sof_samples = 0;
   }
-  for( i = 0; i < ulen; ++i )
+  else
   {
-    *audio_codec.spk_woff++ = *u16data++;
-    if( audio_codec.spk_woff >= audio_codec.spk_rend )
+    audio_codec.spk_sof_frames += frames;
+    audio_codec.spk_sof_samples += consumed;
+
+    if(audio_codec.spk_sof_frames >= SPK_FB_MEASURE_FRAMES)
     {
-      audio_codec.spk_woff = audio_codec.spk_buffer;
+      /* halfwords per window to samples per frame in 10.14 */
+      measured = (uint32_t)(((uint64_t)audio_codec.spk_sof_samples << 14) /
+                            (audio_codec.spk_sof_frames * AUDIO_SPK_CHANEL_NUM));
+      audio_codec.spk_fb_measured += ((int32_t)(measured - audio_codec.spk_fb_measured)) / 4;
+      audio_codec.spk_sof_frames = 0;
+      audio_codec.spk_sof_samples = 0;
     }
   }
-  audio_codec.spk_wtotal += ulen;
+
+  if(audio_codec.spk_stage == 2)
+  {
+    fill = (int32_t)(audio_codec.spk_wtotal - audio_codec.spk_rtotal);
+    if(fill < (int32_t)audio_codec.spk_tx_size)
+    {
+      /* underrun: play silence and prefill again */
+      audio_codec.spk_underrun++;
+      codec_spk_silence();
+    }
+  }
+
+  if(audio_codec.spk_stage != 2)
+  {
+    audio_codec.spk_pi_count = 0;
+    audio_codec.spk_fill_sum = 0;
+    audio_codec.spk_fb_integral = 0;
+    audio_codec.spk_feedback = codec_spk_feedback_usb(audio_codec.spk_fb_measured);
+    return;
+  }
+
+  audio_codec.spk_fill_sum += fill;
+
+  if(++audio_codec.spk_pi_count >= SPK_FB_PI_FRAMES)
+  {
+    /* fill error in samples, positive when the fifo is below half */
+    error = (SPK_BUFFER_SIZE / 2 - audio_codec.spk_fill_sum / SPK_FB_PI_FRAMES) / AUDIO_SPK_CHANEL_NUM;
+    limit = audio_codec.spk_fb_nominal >> SPK_FB_LIMIT_SHIFT;
+
+    audio_codec.spk_fb_integral += error * SPK_FB_KI;
+    if(audio_codec.spk_fb_integral > limit)
+    {
+      audio_codec.spk_fb_integral = limit;
+    }
+    else if(audio_codec.spk_fb_integral < -limit)
+    {
+      audio_codec.spk_fb_integral = -limit;
+    }
+
+    feedback = (int32_t)audio_codec.spk_fb_measured + error * SPK_FB_KP + audio_codec.spk_fb_integral;
+    if(feedback > (int32_t)audio_codec.spk_fb_nominal + limit)
+    {
+      feedback = audio_codec.spk_fb_nominal + limit;
+    }
+    else if(feedback < (int32_t)audio_codec.spk_fb_nominal - limit)
+    {
+      feedback = audio_codec.spk_fb_nominal - limit;
+    }
+    audio_codec.spk_feedback = codec_spk_feedback_usb((uint32_t)feedback);
+
+    audio_codec.spk_pi_count = 0;
+    audio_codec.spk_fill_sum = 0;
+  }
 }
 
 /**
-  * @brief  codec microphone get data
-  * @param  data: data buffer
-  * @retval data len
+  * @brief  switch the speaker dma source without breaking the left/right order.
+  *         the channel is stopped right after an even number of transfers, the
+  *         next i2s request is then a left sample and one sample period is left
+  *         to reprogram the channel.
+  * @param  addr: new source, the ring or the silence word
+  * @param  inc: TRUE to walk the ring, FALSE to repeat the silence word
+  * @retval none
   */
-uint32_t audio_codec_mic_get_data(uint8_t *buffer)
+static void codec_spk_dma_source(uint16_t *addr, confirm_state inc)
 {
-  //copy_buff((uint16_t *)buffer, audio_codec.mic_buffer + audio_codec.mic_hf_status, audio_codec.mic_rx_size);
-  uint16_t len = audio_codec.mic_rx_size << 1;
-  uint16_t i;
-  uint16_t* u16buf = (uint16_t*)buffer;
-  switch(audio_codec.mic_stage)
-  {
-    case 0:
-      audio_codec.mic_stage = 1;
-      memset( buffer, 0, len );
-      return len;
-    case 1:
-      if( audio_codec.mic_wtotal - audio_codec.mic_rtotal >= MIC_BUFFER_SIZE/2 )
-      {
-        audio_codec.mic_stage = 2;
-      }
-      return len;
+  uint32_t timeout = 0xFFFF;
+  uint16_t cnt;
+
+  do
+  {
+    cnt = DMA1_CHANNEL3->dtcnt;
+    while((DMA1_CHANNEL3->dtcnt == cnt) && (--timeout != 0));
+  } while(((DMA1_CHANNEL3->dtcnt & 1) != 0) && (timeout != 0));
+
+  DMA1_CHANNEL3->ctrl_bit.chen = FALSE;
+  DMA1_CHANNEL3->ctrl_bit.mincm = inc;
+  DMA1_CHANNEL3->maddr = (uint32_t)addr;
+  DMA1_CHANNEL3->dtcnt = SPK_BUFFER_SIZE;
+  DMA1_CHANNEL3->ctrl_bit.chen = TRUE;
+
+  /* restart the sof measurement from the new dma position */
+  audio_codec.spk_dma_pos = 0;
+  audio_codec.spk_sof_sync = 0;
+}
+
+/**
+  * @brief  codec speaker silence, the dma repeats a zero word until the ring
+  *         is prefilled again.
+  * @param  none
+  * @retval none
+  */
+static void codec_spk_silence(void)
+{
+  codec_spk_dma_source(&audio_codec.spk_zero, FALSE);
+  audio_codec.spk_stage = 0;
+  audio_codec.spk_drop = 0;
+}
+
+/**
+  * @brief  codec speaker receive buffer, at the codec rate the usb out packet
+  *         is received straight into the i2s dma ring at the write position,
+  *         other rates go through the converter.
+  * @param  none
+  * @retval receive buffer
+  */
+uint8_t *audio_codec_spk_rx_buffer(void)
+{
+  audio_codec.spk_drop = 0;
+  if((audio_codec.spk_stage == 2) &&
+     (audio_codec.spk_wtotal - audio_codec.spk_rtotal > SPK_BUFFER_SIZE - SPK_RING_GUARD))
+  {
+    /* overrun: no room for a packet, receive it in the guard area and drop it */
+    audio_codec.spk_drop = 1;
   }
-  switch( audio_codec.mic_adj_stage )
+
+  if(audio_codec.spk_usb_freq != audio_codec.audio_freq)
   {
-    case 0:
-      break;
-    case 1:
-      if( audio_codec.mic_adj_count >= 4 ){
-        len += 4;
-        audio_codec.mic_adj_count -= 4;
-      }
-      break;
-    case 2:
-      if( audio_codec.mic_adj_count >= 4 ){
-        len -= 4;
-        audio_codec.mic_adj_count -= 4;
-      }
-      break;
+    return (uint8_t *)audio_codec.spk_usb_buffer;
   }
+  if(audio_codec.spk_drop)
+  {
+    return (uint8_t *)&audio_codec.spk_buffer[SPK_BUFFER_SIZE];
+  }
+  return (uint8_t *)audio_codec.spk_woff;
+}
 
-  for( i = 0; i < len/2; ++i )
+/**
+  * @brief  codec speaker commit a packet received in audio_codec_spk_rx_buffer
+  * @param  len: data length
+  * @retval none
+  */
+void audio_codec_spk_fifo_commit(uint32_t len)
+{
+  uint32_t frames = len / (AUDIO_SPK_CHANEL_NUM * sizeof(uint16_t));
+  uint16_t ulen = len / 2;
+  uint16_t wpos;
+
+  if(audio_codec.spk_drop)
   {
-    *u16buf++ = *audio_codec.mic_roff++;
-    if( audio_codec.mic_roff >= audio_codec.mic_wend )
-    {
-      audio_codec.mic_roff = audio_codec.mic_buffer;
-    }
+    audio_codec.spk_overrun++;
+    return;
   }
-  if( audio_codec.mic_wtotal <= audio_codec.mic_rtotal )
-  { //should not happen
-    while(1);
+
+  if(audio_codec.spk_stage == 0)
+  {
+    /* first packet after silence landed at the old position, restart at the ring start */
+    audio_codec.spk_woff = audio_codec.spk_buffer;
+    audio_codec.spk_wtotal = 0;
+    audio_codec.spk_stage = 1;
+    audio_src_reset(&audio_codec.spk_src);
+    return;
   }
 
-  audio_codec.mic_rtotal += len/2;
-  audio_codec.mic_delta  += len/2;
-  return len;
+  if(audio_codec.spk_usb_freq == audio_codec.audio_freq)
+  {
+    audio_mixer_process(&audio_codec.spk_mixer, (int16_t *)audio_codec.spk_woff, frames);
+  }
+  else
+  {
+    /* volume at the usb rate, then the converter writes into the ring */
+    audio_mixer_process(&audio_codec.spk_mixer, audio_codec.spk_usb_buffer, frames);
+    ulen = audio_src_process(&audio_codec.spk_src, audio_codec.spk_usb_buffer, &frames,
+                             (int16_t *)audio_codec.spk_woff, SPK_RING_GUARD / AUDIO_SPK_CHANEL_NUM) * AUDIO_SPK_CHANEL_NUM;
+  }
+
+  wpos = (audio_codec.spk_woff - audio_codec.spk_buffer) + ulen;
+  if(wpos >= SPK_BUFFER_SIZE)
+  {
+    /* the packet ran into the guard area, move that part to the ring start */
+    wpos -= SPK_BUFFER_SIZE;
+    memcpy(audio_codec.spk_buffer, &audio_codec.spk_buffer[SPK_BUFFER_SIZE], wpos * sizeof(uint16_t));
+  }
+  audio_codec.spk_woff = &audio_codec.spk_buffer[wpos];
+  audio_codec.spk_wtotal += ulen;
+
+  if((audio_codec.spk_stage == 1) && (audio_codec.spk_wtotal >= SPK_BUFFER_SIZE / 2))
+  {
+    /* half full: the dma starts playing the ring from its start */
+    codec_spk_dma_source(audio_codec.spk_buffer, TRUE);
+    audio_codec.spk_rtotal = 0;
+    audio_codec.spk_stage = 2;
+  }
 }
 
 /**
-  * @brief  audio codec modify freq
-  * @param  freq: freq (wm8988 microphone and speaker must as same freq)
-  * @retval none
+  * @brief  codec microphone get data, half a ring behind the i2s dma. at the
+  *         codec rate the usb in packet is sent straight from the ring, other
+  *         rates go through the converter.
+  * @param  buffer: returns the packet address
+  * @retval data len
   */
-void audio_codec_modify_freq(uint32_t freq)
+uint32_t audio_codec_mic_get_data(uint8_t **buffer)
 {
-  uint16_t codec_cmd;
-  uint8_t i2c_cmd[2];
-  if(freq == AUDIO_FREQ_16K)
+  uint16_t dma_pos = (MIC_BUFFER_SIZE - DMA1_CHANNEL4->dtcnt) % MIC_BUFFER_SIZE;
+  uint16_t len = audio_codec.mic_rx_size;
+  uint16_t rpos = audio_codec.mic_roff - audio_codec.mic_buffer;
+  uint16_t avail = (dma_pos + MIC_BUFFER_SIZE - rpos) % MIC_BUFFER_SIZE;
+  uint32_t in_frames, frames;
+
+  if((audio_codec.mic_stage == 0) || (avail < len + MIC_RING_GUARD) ||
+     (avail > MIC_BUFFER_SIZE - MIC_RING_GUARD))
   {
-    codec_cmd = WM8988_REG_FREQ16K;
+    /* start or lost track of the dma: restart half a ring behind it, on a left sample */
+    rpos = ((dma_pos + MIC_BUFFER_SIZE / 2) % MIC_BUFFER_SIZE) & ~(AUDIO_MIC_CHANEL_NUM - 1);
+    avail = MIC_BUFFER_SIZE / 2;
+    audio_codec.mic_stage = 1;
+    audio_src_reset(&audio_codec.mic_src);
   }
-  else if(freq == AUDIO_FREQ_48K)
+
+  if(audio_codec.mic_usb_freq == audio_codec.audio_freq)
   {
-    codec_cmd = WM8988_REG_FREQ48K;
+    /* follow the codec clock, one sample more or less keeps the ring half full */
+    if(avail > MIC_BUFFER_SIZE / 2 + len / 2)
+    {
+      len += AUDIO_MIC_CHANEL_NUM;
+    }
+    else if(avail < MIC_BUFFER_SIZE / 2 - len / 2)
+    {
+      len -= AUDIO_MIC_CHANEL_NUM;
+    }
+
+    if(rpos + len > MIC_BUFFER_SIZE)
+    {
+      /* copy the ring start after the ring end so that the packet is contiguous */
+      memcpy(&audio_codec.mic_buffer[MIC_BUFFER_SIZE], audio_codec.mic_buffer,
+             (rpos + len - MIC_BUFFER_SIZE) * sizeof(uint16_t));
+    }
+
+    *buffer = (uint8_t *)&audio_codec.mic_buffer[rpos];
+    audio_mixer_process(&audio_codec.mic_mixer, (int16_t *)*buffer, len / AUDIO_MIC_CHANEL_NUM);
+    audio_codec.mic_roff = &audio_codec.mic_buffer[(rpos + len) % MIC_BUFFER_SIZE];
+
+    return len * sizeof(uint16_t);
   }
-  i2c_cmd[0] = (uint8_t)(codec_cmd >> 8);
-  i2c_cmd[1] = (uint8_t)codec_cmd & 0xFF;
-  if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
+
+  /* frames of this packet at the usb rate, 44.1 khz sends 44 or 45 */
+  audio_codec.mic_usb_acc += audio_codec.mic_usb_freq;
+  frames = audio_codec.mic_usb_acc / 1000;
+  audio_codec.mic_usb_acc %= 1000;
+
+  /* follow the codec clock, one frame more or less keeps the ring half full */
+  if(avail > MIC_BUFFER_SIZE / 2 + len / 2)
+  {
+    frames++;
+  }
+  else if(avail < MIC_BUFFER_SIZE / 2 - len / 2)
   {
-    while(1);
+    frames--;
   }
+
+  /* offer a guard of input, more than one packet needs */
+  in_frames = MIC_RING_GUARD / AUDIO_MIC_CHANEL_NUM;
+  if(rpos + MIC_RING_GUARD > MIC_BUFFER_SIZE)
+  {
+    memcpy(&audio_codec.mic_buffer[MIC_BUFFER_SIZE], audio_codec.mic_buffer,
+           (rpos + MIC_RING_GUARD - MIC_BUFFER_SIZE) * sizeof(uint16_t));
+  }
+
+  frames = audio_src_process(&audio_codec.mic_src, (int16_t *)&audio_codec.mic_buffer[rpos], &in_frames,
+                             audio_codec.mic_usb_buffer, frames);
+  audio_codec.mic_roff = &audio_codec.mic_buffer[(rpos + in_frames * AUDIO_MIC_CHANEL_NUM) % MIC_BUFFER_SIZE];
+  audio_mixer_process(&audio_codec.mic_mixer, audio_codec.mic_usb_buffer, frames);
+
+  *buffer = (uint8_t *)audio_codec.mic_usb_buffer;
+  return frames * AUDIO_MIC_CHANEL_NUM * sizeof(uint16_t);
 }
 
 /**
@@ -474,19 +702,6 @@ void mclk_tmr1_init(void)
 }
 
 
-/**
-  * @brief  audio codec i2s reset
-  * @param  none
-  * @retval none
-  */
-void codec_i2s_reset(void)
-{
-  i2s_enable(SPI1, FALSE);
-  i2s_enable(SPI2, FALSE);
-  dma_channel_enable(DMA1_CHANNEL3, FALSE);
-  dma_channel_enable(DMA1_CHANNEL4, FALSE);
-}
-
 /**
   * @brief  audio codec i2s init
   * @param  freq: audio sampling freq
@@ -506,27 +721,30 @@ void codec_i2s_init(audio_codec_type *param)
   crm_periph_clock_enable(CRM_SPI1_PERIPH_CLOCK, TRUE);
   crm_periph_clock_enable(CRM_SPI2_PERIPH_CLOCK, TRUE);
 
-  param->spk_freq = param->audio_freq;
-
   param->spk_tx_size = (param->audio_freq / 1000) * (param->audio_bitw / 8) * AUDIO_SPK_CHANEL_NUM / 2;
   param->mic_rx_size = (param->audio_freq / 1000) * (param->audio_bitw / 8) * AUDIO_MIC_CHANEL_NUM / 2;
 
-  memset(param->spk_buffer, 0, SPK_BUFFER_SIZE*sizeof(uint16_t));
-  memset(param->mic_buffer, 0, MIC_BUFFER_SIZE*sizeof(uint16_t));
+  memset(param->spk_buffer, 0, sizeof(param->spk_buffer));
+  memset(param->mic_buffer, 0, sizeof(param->mic_buffer));
+
+  param->spk_woff = param->spk_buffer;
+  param->spk_wtotal = param->spk_rtotal = 0;
+  param->spk_zero = 0;
+  param->spk_drop = 0;
+  param->mic_roff = param->mic_buffer;
+  param->mic_stage = 0;
+
+  /* nominal feedback in 10.14 samples per frame */
+  param->spk_fb_nominal = ((param->audio_freq / 1000) << 14) + (((param->audio_freq % 1000) << 14) / 1000);
+  param->spk_fb_measured = param->spk_fb_nominal;
+  param->spk_feedback = codec_spk_feedback_usb(param->spk_fb_nominal);
+  param->spk_fb_integral = 0;
+  param->spk_sof_sync = 0;
+  param->spk_dma_pos = 0;
+  param->spk_pi_count = 0;
+  param->spk_fill_sum = 0;
+  param->spk_stage = 0;
 
-  param->mic_wend = param->mic_woff = param->mic_roff = param->mic_buffer;
-  param->spk_rend = param->spk_woff = param->spk_roff = param->spk_buffer;
-
-  while(param->mic_wend < param->mic_buffer+MIC_BUFFER_SIZE)
-  {
-    param->mic_wend += param->mic_rx_size;
-  }
-  param->mic_wend -= param->mic_rx_size;
-  while(param->spk_rend < param->spk_buffer+SPK_BUFFER_SIZE)
-  {
-    param->spk_rend += param->spk_tx_size;
-  }
-  param->spk_rend -= param->spk_tx_size;
   if(param->audio_bitw == 16)
   {
     format = I2S_DATA_16BIT_CHANNEL_16BIT;
@@ -579,28 +797,25 @@ void codec_i2s_init(audio_codec_type *param)
   dma_reset(DMA1_CHANNEL3);
   dma_reset(DMA1_CHANNEL4);
 
-  /* dma1 channel3: speaker i2s1 tx */
+  /* dma1 channel3: speaker i2s1 tx, circular over the ring, starts on the silence word */
   dma_default_para_init(&dma_init_struct);
-  dma_init_struct.buffer_size = param->spk_tx_size << 1;
+  dma_init_struct.buffer_size = SPK_BUFFER_SIZE;
   dma_init_struct.direction = DMA_DIR_MEMORY_TO_PERIPHERAL;
-  dma_init_struct.memory_base_addr = (uint32_t)spk_dma_buffer;
+  dma_init_struct.memory_base_addr = (uint32_t)&param->spk_zero;
   dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_HALFWORD;
-  dma_init_struct.memory_inc_enable = TRUE;
+  dma_init_struct.memory_inc_enable = FALSE;
   dma_init_struct.peripheral_base_addr = (uint32_t)I2S1_DT_ADDRESS;
   dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_HALFWORD;
   dma_init_struct.peripheral_inc_enable = FALSE;
   dma_init_struct.priority = DMA_PRIORITY_HIGH;
   dma_init_struct.loop_mode_enable = TRUE;
   dma_init(DMA1_CHANNEL3, &dma_init_struct);
-  dma_interrupt_enable(DMA1_CHANNEL3, DMA_FDT_INT, TRUE);
-  dma_interrupt_enable(DMA1_CHANNEL3, DMA_HDT_INT, TRUE);
-  nvic_irq_enable(DMA1_Channel3_IRQn, 1, 0);
 
-  /* dma1 channel4: microphone i2s2 rx */
+  /* dma1 channel4: microphone i2s2 rx, circular over the ring */
   dma_default_para_init(&dma_init_struct);
-  dma_init_struct.buffer_size = param->mic_rx_size << 1;
+  dma_init_struct.buffer_size = MIC_BUFFER_SIZE;
   dma_init_struct.direction = DMA_DIR_PERIPHERAL_TO_MEMORY;
-  dma_init_struct.memory_base_addr = (uint32_t)mic_dma_buffer;
+  dma_init_struct.memory_base_addr = (uint32_t)param->mic_buffer;
   dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_HALFWORD;
   dma_init_struct.memory_inc_enable = TRUE;
   dma_init_struct.peripheral_base_addr = (uint32_t)I2S2_DT_ADDRESS;
@@ -609,9 +824,6 @@ void codec_i2s_init(audio_codec_type *param)
   dma_init_struct.priority = DMA_PRIORITY_HIGH;
   dma_init_struct.loop_mode_enable = TRUE;
   dma_init(DMA1_CHANNEL4, &dma_init_struct);
-  dma_interrupt_enable(DMA1_CHANNEL4, DMA_FDT_INT, TRUE);
-  dma_interrupt_enable(DMA1_CHANNEL4, DMA_HDT_INT, TRUE);
-  nvic_irq_enable(DMA1_Channel4_IRQn, 2, 0);
 
   /* i2s1 tx init */
   spi_i2s_reset(SPI1);
@@ -646,151 +858,6 @@ void codec_i2s_init(audio_codec_type *param)
 
 }
 
-/**
-  * @brief  this function handles dma1 channel3 interrupt.
-  * @param  none
-  * @retval none
-  */
-void DMA1_Channel3_IRQHandler(void)
-{
-  uint16_t half_size = audio_codec.spk_tx_size;
-  uint16_t *pdst;
-
-  if(dma_interrupt_flag_get(DMA1_HDT3_FLAG) == SET)
-  {
-    //copy_buff(audio_codec.spk_buffer, audio_codec.spk_tx_fifo + audio_codec.r_pos, half_size);
-    pdst = spk_dma_buffer;
-    dma_flag_clear(DMA1_HDT3_FLAG);
-  }
-  else if(dma_interrupt_flag_get(DMA1_FDT3_FLAG) == SET)
-  {
-    //copy_buff(&audio_codec.spk_buffer[half_size], audio_codec.spk_tx_fifo + audio_codec.r_pos, half_size);
-    pdst = spk_dma_buffer + half_size;
-    dma_flag_clear(DMA1_FDT3_FLAG);
-  }
-
-  switch( audio_codec.spk_stage )
-  {
-    case 0:
-    case 1:
-      memset( pdst, 0, half_size << 1);
-      break;
-    case 2:
-      if( audio_codec.spk_wtotal >= audio_codec.spk_rtotal + SPK_BUFFER_SIZE )
-      {
-        while(1);//should not happen;
-      }
-      if( audio_codec.spk_rtotal >= audio_codec.spk_wtotal )
-      {
-        audio_codec.spk_stage = 0;
-        audio_codec.spk_woff = audio_codec.spk_roff = audio_codec.spk_buffer;
-        audio_codec.spk_rtotal = audio_codec.spk_wtotal = 0;
-      }
-      else
-      {
-        memcpy( pdst, audio_codec.spk_roff, half_size << 1 );
-        audio_codec.spk_roff   += half_size;
-        audio_codec.spk_rtotal += half_size;
-        if( audio_codec.spk_roff >= audio_codec.spk_rend )
-        {
-          audio_codec.spk_roff = audio_codec.spk_buffer;
-        }
-        if( ++audio_codec.spk_calc == 256 )
-        {
-          uint16_t delta = audio_codec.spk_wtotal - audio_codec.spk_rtotal;
-          audio_codec.spk_calc = 0;
-          if( delta < audio_codec.spk_threshold - half_size )
-          {
-            audio_codec.spk_threshold -= half_size;
-            audio_codec.spk_freq += audio_codec.audio_freq/1024;
-          }
-          else if( delta > audio_codec.spk_threshold + half_size )
-          {
-            audio_codec.spk_threshold += half_size;
-            audio_codec.spk_freq -= audio_codec.audio_freq/1024;
-          }
-          if(audio_codec.spk_rtotal > 0x20000000)
-          {
-            audio_codec.spk_rtotal -= 0x10000000;
-            audio_codec.spk_wtotal -= 0x10000000;
-          }
-        }
-      }
-    break;
-  }
-
-}
-
-/**
-  * @brief  this function handles dma1 channel4 interrupt.
-  * @param  none
-  * @retval none
-  */
-void DMA1_Channel4_IRQHandler(void)
-{
-  uint16_t *psrc;
-  uint16_t len = audio_codec.mic_rx_size << 1;
-
-  if(dma_interrupt_flag_get(DMA1_HDT4_FLAG) == SET)
-  {
-    dma_flag_clear(DMA1_HDT4_FLAG);
-    psrc = mic_dma_buffer;
-  }
-  else if(dma_interrupt_flag_get(DMA1_FDT4_FLAG) == SET)
-  {
-    psrc = mic_dma_buffer + audio_codec.mic_rx_size;
-    dma_flag_clear(DMA1_FDT4_FLAG);
-  }
-  if( audio_codec.mic_stage )
-  {
-    memcpy( audio_codec.mic_woff, psrc, len );
-    audio_codec.mic_woff   += len/2;
-    audio_codec.mic_wtotal += len/2;
-    if( audio_codec.mic_woff >= audio_codec.mic_wend )
-    {
-      audio_codec.mic_woff = audio_codec.mic_buffer;
-    }
-    if( audio_codec.mic_stage == 2 )
-    {
-      if( 1024 == ++audio_codec.mic_calc )
-      {
-        uint32_t size_estimate = 1024*audio_codec.mic_rx_size;
-        audio_codec.mic_calc = 0;
-        if( audio_codec.mic_delta > size_estimate )
-        {
-          audio_codec.mic_adj_count = audio_codec.mic_delta - size_estimate;
-          audio_codec.mic_adj_stage = 2;
-        }
-        else if( audio_codec.mic_delta < size_estimate )
-        {
-          audio_codec.mic_adj_count = size_estimate - audio_codec.mic_delta;
-          audio_codec.mic_adj_stage = 1;
-        }
-        else
-        {
-          audio_codec.mic_adj_count = 0;
-          audio_codec.mic_adj_stage = 0;
-        }
-        audio_codec.mic_delta = 0;
-        if( audio_codec.mic_rtotal >= 0x80000000 )
-        {
-          audio_codec.mic_rtotal -= 0x80000000;
-          audio_codec.mic_wtotal -= 0x80000000;
-        }
-      }
-      if( audio_codec.mic_wtotal >= audio_codec.mic_rtotal + MIC_BUFFER_SIZE )
-      {
-        audio_codec.mic_delta = audio_codec.mic_wtotal = audio_codec.mic_rtotal = 0;
-        audio_codec.mic_woff = audio_codec.mic_roff = audio_codec.mic_buffer;
-        audio_codec.mic_stage = 0;
-        audio_codec.mic_adj_stage = 0;
-        audio_codec.mic_adj_count = 0;
-        audio_codec.mic_calc = 0;
-      }
-    }
-  }
-}
-
 /**
   * @brief  audio codec init
   * @param  none
@@ -802,12 +869,12 @@ error_status audio_codec_init(void)
   uint32_t i_index = 0;
   uint8_t i2c_cmd[2];
 
-  if(AUDIO_DEFAULT_FREQ == AUDIO_FREQ_16K)
+  if(AUDIO_CODEC_FREQ == AUDIO_FREQ_16K)
   {
     reg_addr_data[6] = WM8988_REG_FREQ16K;
     audio_codec.audio_freq = AUDIO_FREQ_16K;
   }
-  else if(AUDIO_DEFAULT_FREQ == AUDIO_FREQ_48K)
+  else if(AUDIO_CODEC_FREQ == AUDIO_FREQ_48K)
   {
     reg_addr_data[6] = WM8988_REG_FREQ48K;
     audio_codec.audio_freq = AUDIO_FREQ_48K;
@@ -842,6 +909,18 @@ error_status audio_codec_init(void)
     }
   }
 
+  /* the usb side starts at the default rate, volume and mute are done in software */
+  audio_codec.spk_usb_freq = AUDIO_DEFAULT_FREQ;
+  audio_codec.mic_usb_freq = AUDIO_DEFAULT_FREQ;
+  audio_codec.mic_usb_acc = 0;
+  if((audio_src_init(&audio_codec.spk_src, audio_codec.spk_usb_freq, audio_codec.audio_freq, AUDIO_SPK_CHANEL_NUM) != SUCCESS) ||
+     (audio_src_init(&audio_codec.mic_src, audio_codec.audio_freq, audio_codec.mic_usb_freq, AUDIO_MIC_CHANEL_NUM) != SUCCESS))
+  {
+    return ERROR;
+  }
+  audio_mixer_init(&audio_codec.spk_mixer, AUDIO_SPK_CHANEL_NUM);
+  audio_mixer_init(&audio_codec.mic_mixer, AUDIO_MIC_CHANEL_NUM);
+
   /* timer init */
   mclk_tmr1_init();
 
@@ -857,93 +936,8 @@ error_status audio_codec_init(void)
   */
 error_status audio_codec_loop(void)
 {
-  static uint8_t mic_mute = 0;
-  static uint16_t mic_volume = 0;
-  static uint8_t spk_mute = 0;
-  static uint16_t spk_volume = 0;
-  uint16_t audio_ctrl_l;
-  uint16_t audio_ctrl_r;
-  uint8_t i2c_cmd[2];
-
-  if(mic_mute != audio_codec.mic_mute)
-  {
-    mic_mute = audio_codec.mic_mute;
-    audio_ctrl_l = WM8988_R21_LEFT_ADC_VOLUME << 9 | 0x100;
-    audio_ctrl_r = WM8988_R22_RIGHT_ADC_VOLUME << 9 | 0x100;
-    if(audio_codec.mic_mute == 0)
-    {
-      audio_ctrl_l |= audio_codec.mic_volume;
-      audio_ctrl_r |= audio_codec.mic_volume;
-    }
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_l >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_l & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_r >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_r & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-  }
-
-  if(mic_volume != audio_codec.mic_volume)
-  {
-    mic_volume = audio_codec.mic_volume;
-    audio_ctrl_l = WM8988_R21_LEFT_ADC_VOLUME << 9 | 0x100;
-    audio_ctrl_r = WM8988_R22_RIGHT_ADC_VOLUME << 9 | 0x100;
-    audio_ctrl_l |= audio_codec.mic_volume;
-    audio_ctrl_r |= audio_codec.mic_volume;
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_l >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_l & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_r >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_r & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-  }
-
-  if(spk_mute != audio_codec.spk_mute)
-  {
-    spk_mute = audio_codec.spk_mute;
-    audio_ctrl_l = (WM8988_R5_ADC_DAC_CONTROL << 9) | 0x0006 | (audio_codec.spk_mute << 3);
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_l >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_l & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-  }
-
-  if(spk_volume != audio_codec.spk_volume)
-  {
-    spk_volume = audio_codec.spk_volume;
-    audio_ctrl_l = WM8988_R2_LOUT1_VOLUME << 9 | 0x100;
-    audio_ctrl_r = WM8988_R3_ROUT1_VOLUME << 9 | 0x100;
-    audio_ctrl_l |= audio_codec.spk_volume;
-    audio_ctrl_r |= audio_codec.spk_volume;
-
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_l >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_l & 0xFF;
-
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-    i2c_cmd[0] = (uint8_t)(audio_ctrl_r >> 8);
-    i2c_cmd[1] = (uint8_t)audio_ctrl_r & 0xFF;
-    if(i2c_master_transmit(&hi2cx, WM8988_I2C_ADDR_CSB_LOW, (uint8_t *)i2c_cmd, 2, 0xFFFF) != I2C_OK)
-    {
-      return ERROR;
-    }
-  }
+  /* volume and mute are applied by the software mixer in the usb interrupt,
+     the codec registers keep their init values */
   return SUCCESS;
 }
 
@@ -28,8 +28,12 @@
 #include "usb_conf.h"
 #include "usb_core.h"
 #include "usbd_int.h"
-#include "cdc_msc_class.h"
-#include "cdc_msc_desc.h"
+#include "cdc_class.h"
+#include "cdc_desc.h"
+#include "msc_class.h"
+#include "msc_desc.h"
+#include "composite_class.h"
+#include "composite_desc.h"
 
 /** @addtogroup AT32F415_periph_examples
   * @{
@@ -45,6 +49,20 @@ otg_core_type otg_core_struct;
   #pragma data_alignment=4
 #endif
 ALIGNED_HEAD uint8_t usb_buffer[256] ALIGNED_TAIL;
+
+/* functions of the composite device, the endpoint numbers are assigned by
+   usb_composite_build, the bandwidth in bytes per frame sizes the fifo */
+composite_ept_type cdc_ept_list[] =
+{
+  {USBD_CDC_INT_EPT,      &cdc_ept.int_ept,      8},
+  {USBD_CDC_BULK_IN_EPT,  &cdc_ept.bulk_in_ept,  1024},
+  {USBD_CDC_BULK_OUT_EPT, &cdc_ept.bulk_out_ept, 1024},
+};
+composite_ept_type msc_ept_list[] =
+{
+  {USBD_MSC_BULK_IN_EPT,  &msc_ept.bulk_in_ept,  1024},
+  {USBD_MSC_BULK_OUT_EPT, &msc_ept.bulk_out_ept, 1024},
+};
 void usb_clock48m_select(usb_clk48_s clk_s);
 void usb_gpio_config(void);
 void usb_low_power_wakeup_config(void);
@@ -84,12 +102,20 @@ int main(void)
   /* enable otgfs irq */
   nvic_irq_enable(OTG_IRQ, 0, 0);
 
+  /* build the cdc + msc configuration */
+  usb_composite_add_function(&cdc_class_handler, &cdc_desc_handler, cdc_ept_list, 3);
+  usb_composite_add_function(&msc_class_handler, &msc_desc_handler, msc_ept_list, 2);
+  if(usb_composite_build(&otg_core_struct.dev) != SUCCESS)
+  {
+    while(1);
+  }
+
   /* init usb */
   usbd_init(&otg_core_struct,
             USB_FULL_SPEED_CORE_ID,
             USB_ID,
-            &cdc_msc_class_handler,
-            &cdc_msc_desc_handler);
+            &composite_class_handler,
+            &composite_desc_handler);
   while(1)
   {
     /* get usb vcp receive data */
@@ -23,8 +23,7 @@
   **************************************************************************
   */
 #include "msc_diskio.h"
-// #include "msc_bot_scsi.h"
-#include "cdc_msc_class.h"
+#include "msc_bot_scsi.h"
 
 /** @addtogroup AT32F415_periph_examples
   * @{
@@ -60,26 +60,14 @@ void keyboard_send_string(void *udev, uint8_t *string, uint8_t len)
 {
   uint8_t index = 0;
   usbd_core_type *pudev = (usbd_core_type *)udev;
-  keyboard_type *pkeyboard = (keyboard_type *)pudev->class_handler->pdata;
   for(index = 0; index < len; index ++)
   {
-    while(1)
+    /* wait for room in the report queue */
+    while(usb_hid_keyboard_send_char(udev, string[index]) != USB_OK)
     {
-      if(pkeyboard->g_u8tx_completed == 1)
+      if(usbd_connect_state_get(pudev) != USB_CONN_STATE_CONFIGURED)
       {
-        pkeyboard->g_u8tx_completed = 0;
-        usb_hid_keyboard_send_char(udev, string[index]);
-        break;
-      }
-    }
-    /* send 0x00 */
-    while(1)
-    {
-      if(pkeyboard->g_u8tx_completed == 1)
-      {
-        pkeyboard->g_u8tx_completed = 0;
-        usb_hid_keyboard_send_char(udev, 0x00);
-        break;
+        return;
       }
     }
   }
@@ -133,6 +133,13 @@ extern "C" {
   */
 /* #define USB_LOW_POWER_WAKUP */
 
+/**
+  * @brief run the class handlers from PendSV instead of the usb interrupt, so
+  *        flash access in the scsi commands does not block the interrupts of
+  *        the same or lower priority. set to 0 to handle them in the interrupt.
+  */
+#define USBD_DEFERRED_EVENT              1
+
 void usb_delay_ms(uint32_t ms);
 void usb_delay_us(uint32_t us);
 
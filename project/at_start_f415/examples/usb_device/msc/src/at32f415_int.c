@@ -25,6 +25,9 @@
 
 /* includes ------------------------------------------------------------------*/
 #include "at32f415_int.h"
+#include "usb_conf.h"
+#include "usb_core.h"
+#include "usbd_int.h"
 
 /** @addtogroup AT32F415_periph_examples
   * @{
@@ -34,6 +37,8 @@
   * @{
   */
 
+extern otg_core_type otg_core_struct;
+
 /**
   * @brief  this function handles nmi exception.
   * @param  none
@@ -120,6 +125,10 @@ void DebugMon_Handler(void)
   */
 void PendSV_Handler(void)
 {
+#if (USBD_DEFERRED_EVENT == 1)
+  /* usb class handlers queued by the usb interrupt */
+  usbd_deferred_handler(&otg_core_struct);
+#endif
 }
 
 /**
@@ -76,6 +76,11 @@ int main(void)
   /* enable otgfs irq */
   nvic_irq_enable(OTG_IRQ, 0, 0);
 
+#if (USBD_DEFERRED_EVENT == 1)
+  /* the class handlers run in PendSV, below every other interrupt */
+  NVIC_SetPriority(PendSV_IRQn, 0x0F);
+#endif
+
   /* init usb */
   usbd_init(&otg_core_struct,
             USB_FULL_SPEED_CORE_ID,
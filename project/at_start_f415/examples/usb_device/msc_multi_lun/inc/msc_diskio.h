@@ -0,0 +1,90 @@
+/**
+  **************************************************************************
+  * @file     msc_diskio.h
+  * @brief    usb mass storage disk interface header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __MSC_DISKIO_H
+#define __MSC_DISKIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "usb_conf.h"
+#include "usb_std.h"
+#include "flash_ftl.h"
+
+/** @addtogroup AT32F415_periph_examples
+  * @{
+  */
+
+/** @addtogroup 415_USB_device_msc_multi_lun
+  * @{
+  */
+/**
+  * @brief lun 0 is the w25q behind the flash translation layer, lun 1 the sd
+  *        card on sdio1. a lun without media answers not ready.
+  */
+#define SPI_FLASH_LUN                    0
+#define SD_LUN                           1
+
+/**
+  * @brief sd card block size
+  */
+#define SD_BLOCK_SIZE                    512
+
+/**
+  * @brief the disk is kept by flash_ftl in the first MSC_FTL_SECTOR_COUNT 4 kb
+  *        sectors of the w25q from MSC_FTL_FLASH_OFFSET. the ftl collects
+  *        sectors from PendSV once the host has not written for
+  *        MSC_FTL_IDLE_TICKS idle requests of the main loop.
+  */
+#define MSC_FTL_FLASH_OFFSET             0
+#define MSC_FTL_SECTOR_COUNT             FLASH_FTL_SECTOR_MAX
+#define MSC_FTL_IDLE_TICKS               5
+
+void msc_disk_init(void);
+void msc_disk_idle_request(void);
+void msc_disk_idle(void);
+uint8_t *get_inquiry(uint8_t lun);
+usb_sts_type msc_disk_read(uint8_t lun, uint64_t addr, uint8_t *read_buf, uint32_t len);
+usb_sts_type msc_disk_write(uint8_t lun, uint64_t addr, uint8_t *buf, uint32_t len);
+usb_sts_type msc_disk_unmap(uint8_t lun, uint64_t addr, uint64_t len);
+usb_sts_type msc_disk_capacity(uint8_t lun, uint32_t *blk_nbr, uint32_t *blk_size);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+
@@ -0,0 +1,251 @@
+/**
+  **************************************************************************
+  * @file     main.c
+  * @brief    main program
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+#include "at32f415_board.h"
+#include "at32f415_clock.h"
+#include "usb_conf.h"
+#include "usb_core.h"
+#include "usbd_int.h"
+#include "msc_class.h"
+#include "msc_desc.h"
+#include "msc_diskio.h"
+
+
+
+/** @addtogroup AT32F415_periph_examples
+  * @{
+  */
+
+/** @addtogroup 415_USB_device_msc_multi_lun USB_device_msc_multi_lun
+  * @{
+  */
+
+/* usb global struct define */
+otg_core_type otg_core_struct;
+void usb_clock48m_select(usb_clk48_s clk_s);
+void usb_gpio_config(void);
+void usb_low_power_wakeup_config(void);
+
+/**
+  * @brief  main function.
+  * @param  none
+  * @retval none
+  */
+int main(void)
+{
+  nvic_priority_group_config(NVIC_PRIORITY_GROUP_4);
+
+  system_clock_config();
+
+  at32_board_init();
+
+  /* usb gpio config */
+  usb_gpio_config();
+
+#ifdef USB_LOW_POWER_WAKUP
+  usb_low_power_wakeup_config();
+#endif
+
+  /* enable otgfs clock */
+  crm_periph_clock_enable(OTG_CLOCK, TRUE);
+
+  /* select usb 48m clcok source */
+  usb_clock48m_select(USB_CLK_HEXT);
+
+  /* enable otgfs irq */
+  nvic_irq_enable(OTG_IRQ, 0, 0);
+
+#if (USBD_DEFERRED_EVENT == 1)
+  /* the class handlers run in PendSV, below every other interrupt */
+  NVIC_SetPriority(PendSV_IRQn, 0x0F);
+#endif
+
+  /* the sd transfers complete in the sdio interrupt, above PendSV */
+  nvic_irq_enable(SDIO1_IRQn, 1, 0);
+
+  /* mount the spi flash disk and init the sd card before the host can see them */
+  msc_disk_init();
+
+  /* init usb */
+  usbd_init(&otg_core_struct,
+            USB_FULL_SPEED_CORE_ID,
+            USB_ID,
+            &msc_class_handler,
+            &msc_desc_handler);
+
+  while(1)
+  {
+    /* let PendSV collect ftl sectors between host writes */
+    delay_ms(10);
+    msc_disk_idle_request();
+  }
+}
+
+/**
+  * @brief  usb 48M clock select
+  * @param  clk_s:USB_CLK_HICK, USB_CLK_HEXT
+  * @retval none
+  */
+void usb_clock48m_select(usb_clk48_s clk_s)
+{
+  crm_clocks_freq_type clocks_struct;
+  
+  crm_clocks_freq_get(&clocks_struct);
+  switch(clocks_struct.sclk_freq)
+  {
+    /* 48MHz */
+    case 48000000:
+      crm_usb_clock_div_set(CRM_USB_DIV_1);
+      break;
+
+    /* 72MHz */
+    case 72000000:
+      crm_usb_clock_div_set(CRM_USB_DIV_1_5);
+      break;
+
+    /* 96MHz */
+    case 96000000:
+      crm_usb_clock_div_set(CRM_USB_DIV_2);
+      break;
+
+    /* 120MHz */
+    case 120000000:
+      crm_usb_clock_div_set(CRM_USB_DIV_2_5);
+      break;
+
+    /* 144MHz */
+    case 144000000:
+      crm_usb_clock_div_set(CRM_USB_DIV_3);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+  * @brief  this function config gpio.
+  * @param  none
+  * @retval none
+  */
+void usb_gpio_config(void)
+{
+  gpio_init_type gpio_init_struct;
+
+  crm_periph_clock_enable(OTG_PIN_GPIO_CLOCK, TRUE);
+  gpio_default_para_init(&gpio_init_struct);
+
+  gpio_init_struct.gpio_drive_strength = GPIO_DRIVE_STRENGTH_STRONGER;
+  gpio_init_struct.gpio_out_type  = GPIO_OUTPUT_PUSH_PULL;
+  gpio_init_struct.gpio_mode = GPIO_MODE_MUX;
+  gpio_init_struct.gpio_pull = GPIO_PULL_NONE;
+
+#ifdef USB_SOF_OUTPUT_ENABLE
+  crm_periph_clock_enable(OTG_PIN_SOF_GPIO_CLOCK, TRUE);
+  gpio_init_struct.gpio_pins = OTG_PIN_SOF;
+  gpio_init(OTG_PIN_SOF_GPIO, &gpio_init_struct);
+#endif
+
+  /* otgfs use vbus pin */
+#ifndef USB_VBUS_IGNORE
+  gpio_init_struct.gpio_pins = OTG_PIN_VBUS;
+  gpio_init_struct.gpio_pull = GPIO_PULL_DOWN;
+  gpio_init_struct.gpio_mode = GPIO_MODE_INPUT;
+  gpio_init(OTG_PIN_GPIO, &gpio_init_struct);
+#endif
+
+
+}
+#ifdef USB_LOW_POWER_WAKUP
+/**
+  * @brief  usb low power wakeup interrupt config
+  * @param  none
+  * @retval none
+  */
+void usb_low_power_wakeup_config(void)
+{
+  exint_init_type exint_init_struct;
+
+  exint_default_para_init(&exint_init_struct);
+
+  exint_init_struct.line_enable = TRUE;
+  exint_init_struct.line_mode = EXINT_LINE_INTERRUPT;
+  exint_init_struct.line_select = OTG_WKUP_EXINT_LINE;
+  exint_init_struct.line_polarity = EXINT_TRIGGER_RISING_EDGE;
+  exint_init(&exint_init_struct);
+
+  nvic_irq_enable(OTG_WKUP_IRQ, 0, 0);
+}
+
+/**
+  * @brief  this function handles otgfs wakup interrupt.
+  * @param  none
+  * @retval none
+  */
+void OTG_WKUP_HANDLER(void)
+{
+  exint_flag_clear(OTG_WKUP_EXINT_LINE);
+}
+
+#endif
+
+/**
+  * @brief  this function handles otgfs interrupt.
+  * @param  none
+  * @retval none
+  */
+void OTG_IRQ_HANDLER(void)
+{
+  usbd_irq_handler(&otg_core_struct);
+}
+
+/**
+  * @brief  usb delay millisecond function.
+  * @param  ms: number of millisecond delay
+  * @retval none
+  */
+void usb_delay_ms(uint32_t ms)
+{
+  /* user can define self delay function */
+  delay_ms(ms);
+}
+
+/**
+  * @brief  usb delay microsecond function.
+  * @param  us: number of microsecond delay
+  * @retval none
+  */
+void usb_delay_us(uint32_t us)
+{
+  delay_us(us);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
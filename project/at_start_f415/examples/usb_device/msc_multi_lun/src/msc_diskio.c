@@ -0,0 +1,325 @@
+/**
+  **************************************************************************
+  * @file     msc_diskio.c
+  * @brief    usb mass storage disk function
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+#include "msc_diskio.h"
+#include "msc_bot_scsi.h"
+#include "spi_flash.h"
+#include "at32_sdio.h"
+
+/** @addtogroup AT32F415_periph_examples
+  * @{
+  */
+
+/** @addtogroup 415_USB_device_msc_multi_lun
+  * @{
+  */
+
+static error_status msc_ftl_read(uint32_t addr, uint8_t *buffer, uint32_t length);
+static error_status msc_ftl_program(uint32_t addr, const uint8_t *buffer, uint32_t length);
+static error_status msc_ftl_erase(uint32_t addr);
+
+static const flash_ftl_media_type msc_ftl_media =
+{
+  SPIF_SECTOR_SIZE,
+  MSC_FTL_SECTOR_COUNT,
+  msc_ftl_read,
+  msc_ftl_program,
+  msc_ftl_erase
+};
+
+flash_ftl_type msc_ftl;
+error_status msc_ftl_status = ERROR;
+static __IO uint8_t msc_idle_request = 0;
+static uint8_t msc_idle_ticks = 0;
+sd_error_status_type msc_sd_status = SD_ERROR;
+
+uint8_t scsi_inquiry[MSC_SUPPORT_MAX_LUN][SCSI_INQUIRY_DATA_LENGTH] =
+{
+  /* lun = 0 */
+  {
+    0x00,         /* peripheral device type (direct-access device) */
+    0x80,         /* removable media bit */
+    0x00,         /* ansi version, ecma version, iso version */
+    0x01,         /* respond data format */
+    SCSI_INQUIRY_DATA_LENGTH - 5, /* additional length */
+    0x00, 0x00, 0x00, /* reserved */
+    'A', 'T', '3', '2', ' ', ' ', ' ', ' ', /* vendor information "AT32" */
+    'D', 'i', 's', 'k', '0', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', /* Product identification "Disk" */
+    '2', '.', '0', '0'  /* product revision level */
+  },
+  /* lun = 1 */
+  {
+    0x00,         /* peripheral device type (direct-access device) */
+    0x80,         /* removable media bit */
+    0x00,         /* ansi version, ecma version, iso version */
+    0x01,         /* respond data format */
+    SCSI_INQUIRY_DATA_LENGTH - 5, /* additional length */
+    0x00, 0x00, 0x00, /* reserved */
+    'A', 'T', '3', '2', ' ', ' ', ' ', ' ', /* vendor information "AT32" */
+    'D', 'i', 's', 'k', '1', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', /* Product identification "Disk" */
+    '2', '.', '0', '0'  /* product revision level */
+  }
+};
+
+/**
+  * @brief  get disk inquiry
+  * @param  lun: logical units number
+  * @retval inquiry string
+  */
+uint8_t *get_inquiry(uint8_t lun)
+{
+  if(lun < MSC_SUPPORT_MAX_LUN)
+    return (uint8_t *)scsi_inquiry[lun];
+  else
+    return NULL;
+}
+
+/**
+  * @brief  read the w25q for the ftl
+  * @param  addr: offset in the ftl region
+  * @param  buffer: pointer to read buffer
+  * @param  length: read length
+  * @retval SUCCESS
+  */
+static error_status msc_ftl_read(uint32_t addr, uint8_t *buffer, uint32_t length)
+{
+  spiflash_read(buffer, MSC_FTL_FLASH_OFFSET + addr, length);
+  return SUCCESS;
+}
+
+/**
+  * @brief  program the w25q for the ftl, the region is never erased here
+  * @param  addr: offset in the ftl region
+  * @param  buffer: pointer to program buffer
+  * @param  length: program length
+  * @retval SUCCESS
+  */
+static error_status msc_ftl_program(uint32_t addr, const uint8_t *buffer, uint32_t length)
+{
+  spiflash_write_nocheck((uint8_t *)buffer, MSC_FTL_FLASH_OFFSET + addr, length);
+  return SUCCESS;
+}
+
+/**
+  * @brief  erase a w25q sector for the ftl
+  * @param  addr: offset of the sector in the ftl region
+  * @retval SUCCESS
+  */
+static error_status msc_ftl_erase(uint32_t addr)
+{
+  /* spiflash_sector_erase takes the sector number */
+  spiflash_sector_erase((MSC_FTL_FLASH_OFFSET + addr) / SPIF_SECTOR_SIZE);
+  return SUCCESS;
+}
+
+/**
+  * @brief  init the spi flash and mount the ftl, an unformatted flash is
+  *         mounted as an empty disk, then init the sd card
+  * @param  none
+  * @retval none
+  */
+void msc_disk_init(void)
+{
+  spiflash_init();
+  msc_ftl_status = flash_ftl_init(&msc_ftl, &msc_ftl_media);
+
+  msc_sd_status = sd_init();
+}
+
+/**
+  * @brief  count an idle period, called from the main loop. the count is
+  *         taken in PendSV, so it is serialized with the scsi commands.
+  * @param  none
+  * @retval none
+  */
+void msc_disk_idle_request(void)
+{
+  msc_idle_request = 1;
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+  * @brief  collect or erase one ftl sector when the host stopped writing,
+  *         called from PendSV after the usb class handlers
+  * @param  none
+  * @retval none
+  */
+void msc_disk_idle(void)
+{
+  if(msc_idle_request == 0)
+  {
+    return;
+  }
+  msc_idle_request = 0;
+
+  if(msc_idle_ticks < MSC_FTL_IDLE_TICKS)
+  {
+    msc_idle_ticks++;
+  }
+  else if(msc_ftl_status == SUCCESS)
+  {
+    flash_ftl_background(&msc_ftl);
+  }
+}
+
+/**
+  * @brief  disk read
+  * @param  lun: logical units number
+  * @param  addr: logical address
+  * @param  read_buf: pointer to read buffer
+  * @param  len: read length
+  * @retval status of usb_sts_type
+  */
+usb_sts_type msc_disk_read(uint8_t lun, uint64_t addr, uint8_t *read_buf, uint32_t len)
+{
+  switch(lun)
+  {
+    case SPI_FLASH_LUN:
+      if(msc_ftl_status != SUCCESS ||
+         flash_ftl_read(&msc_ftl, (uint32_t)(addr / FLASH_FTL_BLOCK_SIZE), read_buf,
+                        len / FLASH_FTL_BLOCK_SIZE) != SUCCESS)
+      {
+        return USB_FAIL;
+      }
+      break;
+    case SD_LUN:
+      if(msc_sd_status != SD_OK ||
+         sd_mult_blocks_read(read_buf, (long long)addr, SD_BLOCK_SIZE, len / SD_BLOCK_SIZE) != SD_OK)
+      {
+        return USB_FAIL;
+      }
+      break;
+    default:
+      return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  disk write
+  * @param  lun: logical units number
+  * @param  addr: logical address
+  * @param  buf: pointer to write buffer
+  * @param  len: write length
+  * @retval status of usb_sts_type
+  */
+usb_sts_type msc_disk_write(uint8_t lun, uint64_t addr, uint8_t *buf, uint32_t len)
+{
+  switch(lun)
+  {
+    case SPI_FLASH_LUN:
+      /* the host is busy, garbage collection waits for the next idle period */
+      msc_idle_ticks = 0;
+
+      if(msc_ftl_status != SUCCESS ||
+         flash_ftl_write(&msc_ftl, (uint32_t)(addr / FLASH_FTL_BLOCK_SIZE), buf,
+                         len / FLASH_FTL_BLOCK_SIZE) != SUCCESS)
+      {
+        return USB_FAIL;
+      }
+      break;
+    case SD_LUN:
+      if(msc_sd_status != SD_OK ||
+         sd_mult_blocks_write(buf, (long long)addr, SD_BLOCK_SIZE, len / SD_BLOCK_SIZE) != SD_OK)
+      {
+        return USB_FAIL;
+      }
+      break;
+    default:
+      return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  disk unmap, the blocks are dropped from the ftl map or erased on
+  *         the sd card
+  * @param  lun: logical units number
+  * @param  addr: logical address
+  * @param  len: unmap length
+  * @retval status of usb_sts_type
+  */
+usb_sts_type msc_disk_unmap(uint8_t lun, uint64_t addr, uint64_t len)
+{
+  switch(lun)
+  {
+    case SPI_FLASH_LUN:
+      if(msc_ftl_status != SUCCESS ||
+         flash_ftl_trim(&msc_ftl, (uint32_t)(addr / FLASH_FTL_BLOCK_SIZE),
+                        (uint32_t)(len / FLASH_FTL_BLOCK_SIZE)) != SUCCESS)
+      {
+        return USB_FAIL;
+      }
+      break;
+    case SD_LUN:
+      if(msc_sd_status != SD_OK ||
+         sd_blocks_erase((long long)addr, (uint32_t)(len / SD_BLOCK_SIZE)) != SD_OK)
+      {
+        return USB_FAIL;
+      }
+      break;
+    default:
+      return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @brief  disk capacity
+  * @param  lun: logical units number
+  * @param  blk_nbr: pointer to number of block
+  * @param  blk_size: pointer to block size
+  * @retval status of usb_sts_type
+  */
+usb_sts_type msc_disk_capacity(uint8_t lun, uint32_t *blk_nbr, uint32_t *blk_size)
+{
+  switch(lun)
+  {
+    case SPI_FLASH_LUN:
+      /* a disk that failed to mount reports one block, every access fails */
+      *blk_nbr = (msc_ftl_status == SUCCESS) ? msc_ftl.block_count : 1;
+      *blk_size = FLASH_FTL_BLOCK_SIZE;
+      break;
+    case SD_LUN:
+      /* no card, the lun answers not ready */
+      if(msc_sd_status != SD_OK)
+      {
+        return USB_FAIL;
+      }
+      *blk_nbr = (uint32_t)(sd_card_info.card_capacity / SD_BLOCK_SIZE);
+      *blk_size = SD_BLOCK_SIZE;
+      break;
+    default:
+      return USB_FAIL;
+  }
+  return USB_OK;
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
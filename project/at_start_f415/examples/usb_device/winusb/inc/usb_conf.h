@@ -81,7 +81,7 @@ extern "C" {
 /* otg1 device fifo */
 #define USBD_RX_SIZE                     128
 #define USBD_EP0_TX_SIZE                 24
-#define USBD_EP1_TX_SIZE                 20
+#define USBD_EP1_TX_SIZE                 64
 #define USBD_EP2_TX_SIZE                 20
 #define USBD_EP3_TX_SIZE                 20
 
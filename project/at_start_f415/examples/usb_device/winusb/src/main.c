@@ -44,7 +44,9 @@ otg_core_type otg_core_struct;
 #if defined ( __ICCARM__ ) /* iar compiler */
   #pragma data_alignment=4
 #endif
-ALIGNED_HEAD uint8_t usb_buffer[256] ALIGNED_TAIL;
+ALIGNED_HEAD uint8_t usb_buffer[2][1024] ALIGNED_TAIL;
+__IO uint8_t usb_buffer_busy[2];
+void loopback_tx_done(void *udev, uint8_t *buffer, uint32_t len);
 void usb_clock48m_select(usb_clk48_s clk_s);
 void usb_gpio_config(void);
 void usb_low_power_wakeup_config(void);
@@ -56,9 +58,8 @@ void usb_low_power_wakeup_config(void);
   */
 int main(void)
 {
-  uint16_t data_len;
-
-  uint32_t timeout;
+  uint32_t data_len;
+  uint8_t index = 0;
 
   nvic_priority_group_config(NVIC_PRIORITY_GROUP_4);
 
@@ -88,32 +89,46 @@ int main(void)
             USB_ID,
             &winusb_class_handler,
             &winusb_desc_handler);
+
+  /* release a loopback buffer when it has been sent */
+  usb_winusb_stream_tx_callback(&otg_core_struct.dev, loopback_tx_done);
+
   while(1)
   {
-    /* get usb winusb receive data */
-    data_len = usb_winusb_get_rxdata(&otg_core_struct.dev, usb_buffer);
-
-    if(data_len > 0)
+    /* echo the received data, one buffer is on the bus while the other fills.
+       the out endpoint keeps receiving into the class ring meanwhile and naks
+       the host only when the ring is full. the data is taken out of the ring
+       only once it is queued, a refused send is retried with the same bytes */
+    if(usb_buffer_busy[index] == 0 && usb_winusb_stream_rx_count(&otg_core_struct.dev) != 0)
     {
+      data_len = usb_winusb_stream_peek(&otg_core_struct.dev, usb_buffer[index], sizeof(usb_buffer[index]));
 
-      /* bulk transfer is complete when the endpoint does one of the following
-         1 has transferred exactly the amount of data expected
-         2 transfers a packet with a payload size less than wMaxPacketSize or transfers a zero-length packet
-      */
-
-      timeout = 5000000;
-      do
+      usb_buffer_busy[index] = 1;
+      if(usb_winusb_stream_send(&otg_core_struct.dev, usb_buffer[index], data_len) == SUCCESS)
+      {
+        usb_winusb_stream_commit(&otg_core_struct.dev, data_len);
+        index ^= 1;
+      }
+      else
       {
-        /* send data to host */
-        if(usb_winusb_send_data(&otg_core_struct.dev, usb_buffer, data_len) == SUCCESS)
-        {
-          break;
-        }
-      }while(timeout --);
+        usb_buffer_busy[index] = 0;
+      }
     }
   }
 }
 
+/**
+  * @brief  winusb in transfer complete callback, called from the usb interrupt
+  * @param  udev: to the structure of usbd_core_type
+  * @param  buffer: buffer that was sent
+  * @param  len: bytes sent
+  * @retval none
+  */
+void loopback_tx_done(void *udev, uint8_t *buffer, uint32_t len)
+{
+  usb_buffer_busy[buffer == usb_buffer[1]] = 0;
+}
+
 /**
   * @brief  usb 48M clock select
   * @param  clk_s:USB_CLK_HICK, USB_CLK_HEXT
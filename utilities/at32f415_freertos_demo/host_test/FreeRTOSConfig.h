@@ -0,0 +1,6 @@
+/* the demo configuration without the tickless port, whose kernel hooks are
+   not part of the host test */
+#include "../inc/FreeRTOSConfig.h"
+
+#undef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE          0
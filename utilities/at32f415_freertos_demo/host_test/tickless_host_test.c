@@ -0,0 +1,163 @@
+/**
+  **************************************************************************
+  * @file     tickless_host_test.c
+  * @brief    host model of the tickless idle tick compensation
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/*
+ * checks tickless_idle_compensate and tickless_idle_stamp_elapsed, the part
+ * of the tickless idle port that decides how many ticks a suppressed period
+ * was worth, against exact arithmetic:
+ * - the ertc stamp difference across the hourly wrap
+ * - whole ticks and sub-tick remainders of single sleeps
+ * - the phase carried from one sleep to the systick restart and on into
+ *   the next sleep, through the systick cycle conversions, over a long run
+ *   of sleeps and awake periods: the kernel tick must not drift from real
+ *   time
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "tickless_idle.h"
+
+#define STAMP_WRAP                       (3600UL * TICKLESS_SBS_FREQ)
+#define CYCLES_PER_TICK                  144000
+#define CHAIN_SLEEPS                     200000
+
+static uint32_t rand_state = 1;
+static int fails;
+
+#define CHECK(cond) do { if(!(cond)) { if(fails++ < 10) printf("FAIL line %d: %s\n", __LINE__, #cond); } } while(0)
+
+uint32_t system_core_clock = 144000000;
+
+static uint32_t rand_get(void)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return rand_state >> 8;
+}
+
+static void stamp_test(void)
+{
+  uint32_t index, start, length;
+
+  CHECK(tickless_idle_stamp_elapsed(100, 100) == 0);
+  CHECK(tickless_idle_stamp_elapsed(100, 4196) == 4096);
+  CHECK(tickless_idle_stamp_elapsed(STAMP_WRAP - 5, 10) == 15);
+  CHECK(tickless_idle_stamp_elapsed(STAMP_WRAP - 1, 0) == 1);
+  for(index = 0; index < 100000; index++)
+  {
+    start = rand_get() % STAMP_WRAP;
+    length = rand_get() % (TICKLESS_WAT_MAX_PERIODS * 2 + 1);
+    CHECK(tickless_idle_stamp_elapsed(start, (start + length) % STAMP_WRAP) == length);
+  }
+}
+
+static void single_test(void)
+{
+  uint32_t index, pre, counts, ticks, phase;
+
+  /* one tick of ertc counts from the start of a tick is exactly one tick */
+  CHECK(tickless_idle_compensate(0, TICKLESS_SBS_FREQ, &phase) == configTICK_RATE_HZ && phase == 0);
+  CHECK(tickless_idle_compensate(0, 0, &phase) == 0 && phase == 0);
+  CHECK(tickless_idle_compensate(TICKLESS_SBS_FREQ - 1, 0, &phase) == 0 && phase == TICKLESS_SBS_FREQ - 1);
+  /* 5 counts are 5000 units: one tick and 904 units, plus the 3000 before */
+  CHECK(tickless_idle_compensate(3000, 5, &phase) == 1 && phase == 3904);
+  CHECK(tickless_idle_compensate(3096, 1, &phase) == 1 && phase == 0);
+
+  for(index = 0; index < 1000000; index++)
+  {
+    pre = rand_get() % TICKLESS_SBS_FREQ;
+    counts = rand_get() % (TICKLESS_WAT_MAX_PERIODS * 2 + 1);
+    ticks = tickless_idle_compensate(pre, counts, &phase);
+    CHECK(phase < TICKLESS_SBS_FREQ);
+    CHECK((uint64_t)ticks * TICKLESS_SBS_FREQ + phase == (uint64_t)pre + (uint64_t)counts * configTICK_RATE_HZ);
+  }
+}
+
+/*
+ * time runs in "fine" steps of 1 / TICKLESS_SBS_FREQ cpu cycle: a tick is
+ * CYCLES_PER_TICK * TICKLESS_SBS_FREQ fine, an ertc count
+ * CYCLES_PER_TICK * configTICK_RATE_HZ fine, both exact. the systick is
+ * modelled in whole cycles and read as the port reads it.
+ */
+static void chain_test(void)
+{
+  const uint64_t tick_fine = (uint64_t)CYCLES_PER_TICK * TICKLESS_SBS_FREQ;
+  const uint64_t count_fine = (uint64_t)CYCLES_PER_TICK * configTICK_RATE_HZ;
+  uint64_t now = 0, next_tick = CYCLES_PER_TICK, kernel = 0, cycles, edge;
+  const uint64_t awake_max = 5 * CYCLES_PER_TICK;
+  uint32_t sleep, counts, pre, phase, ticks, reload, stamp_start, stamp_stop;
+  int64_t drift, drift_max = 0;
+
+  for(sleep = 0; sleep < CHAIN_SLEEPS; sleep++)
+  {
+    /* awake: the systick ticks every CYCLES_PER_TICK cycles */
+    now += (rand_get() % awake_max) * TICKLESS_SBS_FREQ;
+    while(next_tick * TICKLESS_SBS_FREQ <= now)
+    {
+      kernel++;
+      next_tick += CYCLES_PER_TICK;
+    }
+
+    /* idle: wait for an ertc edge, stop the systick and read its phase */
+    edge = (now / count_fine + 1) * count_fine;
+    while(next_tick * TICKLESS_SBS_FREQ <= edge)
+    {
+      kernel++;
+      next_tick += CYCLES_PER_TICK;
+    }
+    now = edge;
+    cycles = now / TICKLESS_SBS_FREQ;
+    pre = tickless_idle_cycles_to_units((uint32_t)(CYCLES_PER_TICK - (next_tick - cycles)), CYCLES_PER_TICK);
+    stamp_start = (uint32_t)((now / count_fine) % STAMP_WRAP);
+
+    /* sleep a whole number of ertc counts, up to the wakeup timer range */
+    counts = 1 + rand_get() % (TICKLESS_WAT_MAX_PERIODS * 2);
+    now += counts * count_fine;
+    stamp_stop = (uint32_t)((now / count_fine) % STAMP_WRAP);
+
+    ticks = tickless_idle_compensate(pre, tickless_idle_stamp_elapsed(stamp_start, stamp_stop), &phase);
+    kernel += ticks;
+
+    /* restart the systick from the phase reached inside the current tick */
+    reload = CYCLES_PER_TICK - tickless_idle_units_to_cycles(phase, CYCLES_PER_TICK);
+    next_tick = now / TICKLESS_SBS_FREQ + reload;
+
+    drift = (int64_t)kernel - (int64_t)(now / tick_fine);
+    drift_max = (llabs(drift) > drift_max) ? llabs(drift) : drift_max;
+    CHECK(llabs(drift) <= 1);
+  }
+  printf("chain: %u sleeps over %.1f hours, kernel %llu ticks, real %llu, max drift %lld\n", CHAIN_SLEEPS,
+         (double)now / tick_fine / configTICK_RATE_HZ / 3600, (unsigned long long)kernel,
+         (unsigned long long)(now / tick_fine), (long long)drift_max);
+}
+
+int main(void)
+{
+  stamp_test();
+  single_test();
+  chain_test();
+  printf(fails ? "FAILED %d\n" : "passed\n", fails);
+  return fails != 0;
+}
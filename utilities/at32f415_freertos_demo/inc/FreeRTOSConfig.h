@@ -77,6 +77,8 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
     #include <stdint.h>
     #include "system_at32f415.h"
+    extern void runtime_stats_timer_init(void);
+    extern uint32_t runtime_stats_counter_get(void);
 #endif
 
 
@@ -105,6 +107,18 @@
 #define configUSE_16_BIT_TICKS    0
 #define configIDLE_SHOULD_YIELD    1
 
+/* Tickless idle: vPortSuppressTicksAndSleep() is provided by tickless_idle.c,
+which uses the ERTC wakeup timer to bound sleep and deep sleep. */
+#define configUSE_TICKLESS_IDLE                2
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP  2
+
+/* Run time statistics: runtime_stats.c counts with TMR2 in 32-bit mode at
+1 MHz, the counter does not run in deep sleep. */
+#define configGENERATE_RUN_TIME_STATS          1
+#define configUSE_TRACE_FACILITY               1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() runtime_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()       runtime_stats_counter_get()
+
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES     0
@@ -151,10 +165,10 @@ header file. */
 #define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }
 
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
-standard names. */
+standard names. SysTick_Handler in at32f415_int.c calls xPortSysTickHandler
+so that the tick interrupt is timed by the run time statistics. */
 #define vPortSVCHandler SVC_Handler
 #define xPortPendSVHandler PendSV_Handler
-#define xPortSysTickHandler SysTick_Handler
 
 #ifdef __cplusplus
     }
@@ -0,0 +1,127 @@
+/**
+  **************************************************************************
+  * @file     runtime_stats.h
+  * @brief    freertos run-time statistics and binary report header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __RUNTIME_STATS_H
+#define __RUNTIME_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+/** @defgroup runtime_stats_definition
+  * @{
+  */
+
+/**
+  * @brief run time counter: tmr2 in 32-bit mode, wraps after 71 minutes at 1 mhz.
+  *        the host computes cpu load from the difference of two reports.
+  */
+#define RUNTIME_STATS_TIMER              TMR2
+#define RUNTIME_STATS_TIMER_CRM_CLK      CRM_TMR2_PERIPH_CLOCK
+#define RUNTIME_STATS_TIMER_FREQ         1000000
+
+#define RUNTIME_STATS_MAX_TASKS          8
+#define RUNTIME_STATS_ISR_MAX            4
+#define RUNTIME_STATS_NAME_LEN           8
+
+/**
+  * @brief binary report layout (little endian)
+  *        header : sync[2] = 0xA5 0x5A, length u16 (bytes from version to the end of the isr records),
+  *                 version u8, task count u8, isr count u8, reserved u8,
+  *                 run time u32, run time counter freq u32, cpu freq u32
+  *        task   : number u8, state u8, priority u8, reserved u8, name[8], run time u32,
+  *                 stack high water mark u16 (words), reserved u16
+  *        isr    : irq number s16, reserved u16, count u32, cycles u32, max cycles u32
+  *        trailer: crc16-ccitt u16 (poly 0x1021, init 0xFFFF) from version to the end of the isr records
+  */
+#define RUNTIME_STATS_SYNC0              0xA5
+#define RUNTIME_STATS_SYNC1              0x5A
+#define RUNTIME_STATS_VERSION            1
+#define RUNTIME_STATS_HEADER_SIZE        20
+#define RUNTIME_STATS_TASK_SIZE          20
+#define RUNTIME_STATS_ISR_SIZE           16
+#define RUNTIME_STATS_REPORT_MAX         (RUNTIME_STATS_HEADER_SIZE + RUNTIME_STATS_MAX_TASKS * RUNTIME_STATS_TASK_SIZE + \
+                                          RUNTIME_STATS_ISR_MAX * RUNTIME_STATS_ISR_SIZE + 2)
+
+/**
+  * @brief isr slots, time is inclusive of nested interrupts. svc and pendsv,
+  *        the kernel context switch, are not timed
+  */
+typedef enum
+{
+  RUNTIME_STATS_ISR_ERTC_WKUP            = 0x00, /*!< ertc wakeup timer interrupt */
+  RUNTIME_STATS_ISR_SERIAL_RX_DMA        = 0x01, /*!< usart1 rx dma full data interrupt */
+  RUNTIME_STATS_ISR_SERIAL_RX_IDLE       = 0x02, /*!< usart1 idle line interrupt */
+  RUNTIME_STATS_ISR_SYSTICK              = 0x03, /*!< freertos tick */
+} runtime_stats_isr_type;
+
+/**
+  * @brief start an isr measurement, returns the dwt cycle counter
+  */
+#define RUNTIME_STATS_ISR_ENTER()        (DWT->CYCCNT)
+
+/**
+  * @}
+  */
+
+/** @defgroup runtime_stats_exported_functions
+  * @{
+  */
+
+void runtime_stats_timer_init(void);
+uint32_t runtime_stats_counter_get(void);
+void runtime_stats_isr_exit(uint8_t slot, uint32_t start);
+uint16_t runtime_stats_report_build(uint8_t *buf, uint16_t size);
+void runtime_stats_report_send(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
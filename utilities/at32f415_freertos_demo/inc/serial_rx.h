@@ -0,0 +1,90 @@
+/**
+  **************************************************************************
+  * @file     serial_rx.h
+  * @brief    usart1 zero-copy dma reception header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SERIAL_RX_H
+#define __SERIAL_RX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+#include "buffer_pool.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+/** @defgroup serial_rx_definition
+  * @{
+  */
+
+/**
+  * @brief usart1 rx (pa10) is received by dma1 channel5 straight into pool
+  *        buffers. a buffer is handed to the consumer task when it is full or
+  *        when the line goes idle, the task releases it after use.
+  */
+#define SERIAL_RX_DMA_CHANNEL            DMA1_CHANNEL5
+#define SERIAL_RX_DMA_FDT_FLAG           DMA1_FDT5_FLAG
+#define SERIAL_RX_BUF_SIZE               64
+#define SERIAL_RX_BUF_COUNT              4
+#define SERIAL_RX_QUEUE_DEPTH            SERIAL_RX_BUF_COUNT
+
+/**
+  * @}
+  */
+
+/** @defgroup serial_rx_exported_functions
+  * @{
+  */
+
+error_status serial_rx_init(void);
+buffer_desc_type* serial_rx_receive(TickType_t wait);
+void serial_rx_dma_irq_handler(void);
+void serial_rx_usart_irq_handler(void);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,115 @@
+/**
+  **************************************************************************
+  * @file     tickless_idle.h
+  * @brief    freertos tickless idle with ertc wakeup header file
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TICKLESS_IDLE_H
+#define __TICKLESS_IDLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+/** @defgroup tickless_idle_definition
+  * @{
+  */
+
+/**
+  * @brief ertc divider used while tickless idle is enabled.
+  *        ck_a (sub second resolution) = LEXT_VALUE / (TICKLESS_ERTC_DIV_A + 1) = 4096 hz
+  *        ck_b (calendar second)       = ck_a / (TICKLESS_ERTC_DIV_B + 1)    = 1 hz
+  */
+#define TICKLESS_ERTC_DIV_A              7
+#define TICKLESS_ERTC_DIV_B              4095
+#define TICKLESS_SBS_FREQ                (LEXT_VALUE / (TICKLESS_ERTC_DIV_A + 1))
+
+/**
+  * @brief wakeup timer clocked by ertc_clk / 16, 16-bit counter (max 32 s)
+  */
+#define TICKLESS_WAT_FREQ                (LEXT_VALUE / 16)
+#define TICKLESS_WAT_MAX_PERIODS         65536
+
+/**
+  * @brief idle periods (in ticks) from which deep sleep is used instead of sleep.
+  *        short idle periods keep hext/pll running to avoid the clock restart time.
+  */
+#ifndef TICKLESS_DEEP_SLEEP_MIN_TICKS
+#define TICKLESS_DEEP_SLEEP_MIN_TICKS    20
+#endif
+
+/**
+  * @brief ticks reserved for deep sleep wakeup (hick start, hext and pll restart)
+  */
+#ifndef TICKLESS_DEEP_SLEEP_WAKEUP_TICKS
+#define TICKLESS_DEEP_SLEEP_WAKEUP_TICKS 1
+#endif
+
+/**
+  * @brief loops to wait 3 lick cycles (120us max) at 48 mhz hick after deep sleep
+  */
+#define TICKLESS_CLOCK_STABLE_LOOPS      2000
+
+/**
+  * @}
+  */
+
+/** @defgroup tickless_idle_exported_functions
+  * @{
+  */
+
+void tickless_idle_init(void);
+void tickless_idle_wakeup_handler(void);
+uint32_t tickless_idle_compensate(uint32_t pre_units, uint32_t sbs_counts, uint32_t *phase_units);
+uint32_t tickless_idle_stamp_elapsed(uint32_t start, uint32_t stop);
+uint32_t tickless_idle_cycles_to_units(uint32_t cycles, uint32_t cycles_per_tick);
+uint32_t tickless_idle_units_to_cycles(uint32_t units, uint32_t cycles_per_tick);
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -25,6 +25,12 @@
 
 /* includes ------------------------------------------------------------------*/
 #include "at32f415_int.h"
+#include "tickless_idle.h"
+#include "runtime_stats.h"
+#include "serial_rx.h"
+
+/* freertos port tick handler */
+extern void xPortSysTickHandler(void);
 
 /** @addtogroup UTILITIES_examples
   * @{
@@ -123,13 +129,54 @@ void DebugMon_Handler(void)
 //}
 
 /**
-  * @brief  this function handles systick handler.
+  * @brief  this function handles systick handler, the freertos tick.
   * @param  none
   * @retval none
   */
-//void SysTick_Handler(void)
-//{
-//}
+void SysTick_Handler(void)
+{
+  uint32_t start = RUNTIME_STATS_ISR_ENTER();
+  xPortSysTickHandler();
+  runtime_stats_isr_exit(RUNTIME_STATS_ISR_SYSTICK, start);
+}
+
+/**
+  * @brief  this function handles ertc wakeup timer interrupt request.
+  * @param  none
+  * @retval none
+  */
+void ERTC_WKUP_IRQHandler(void)
+{
+  uint32_t start = RUNTIME_STATS_ISR_ENTER();
+
+  tickless_idle_wakeup_handler();
+
+  runtime_stats_isr_exit(RUNTIME_STATS_ISR_ERTC_WKUP, start);
+}
+
+/**
+  * @brief  this function handles dma1 channel5 interrupt request.
+  * @param  none
+  * @retval none
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+  uint32_t start = RUNTIME_STATS_ISR_ENTER();
+  serial_rx_dma_irq_handler();
+  runtime_stats_isr_exit(RUNTIME_STATS_ISR_SERIAL_RX_DMA, start);
+}
+
+/**
+  * @brief  this function handles usart1 interrupt request.
+  * @param  none
+  * @retval none
+  */
+void USART1_IRQHandler(void)
+{
+  uint32_t start = RUNTIME_STATS_ISR_ENTER();
+  serial_rx_usart_irq_handler();
+  runtime_stats_isr_exit(RUNTIME_STATS_ISR_SERIAL_RX_IDLE, start);
+}
 
 /**
   * @}
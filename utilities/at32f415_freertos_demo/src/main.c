@@ -27,6 +27,9 @@
 #include "at32f415_clock.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "tickless_idle.h"
+#include "runtime_stats.h"
+#include "serial_rx.h"
 
 /** @addtogroup UTILITIES_examples
   * @{
@@ -37,11 +40,17 @@
   */
 TaskHandle_t led2_handler;
 TaskHandle_t led3_handler;
+TaskHandle_t stats_handler;
+TaskHandle_t echo_handler;
 
 /* led2 task */
 void led2_task_function(void *pvParameters);
 /* led3 task */
 void led3_task_function(void *pvParameters);
+/* stats task */
+void stats_task_function(void *pvParameters);
+/* echo task */
+void echo_task_function(void *pvParameters);
 
 /**
   * @brief  main function.
@@ -61,6 +70,17 @@ int main(void)
   /* init usart1 */
   uart_print_init(115200);
 
+  /* init ertc wakeup timer for tickless idle. the battery powered domain,
+     calendar and bpr registers included, is reset unless the ertc already
+     runs on lext */
+  tickless_idle_init();
+
+  /* receive usart1 by dma into pool buffers, the echo task consumes them */
+  if(serial_rx_init() != SUCCESS)
+  {
+    printf("serial rx could not be started.\r\n");
+  }
+
   /* enter critical */
   taskENTER_CRITICAL();
 
@@ -92,6 +112,35 @@ int main(void)
   {
     printf("LED3 task was created successfully.\r\n");
   }
+  /* create stats task */
+  if(xTaskCreate((TaskFunction_t )stats_task_function,
+                 (const char*    )"STATS",
+                 (uint16_t       )256,
+                 (void*          )NULL,
+                 (UBaseType_t    )1,
+                 (TaskHandle_t*  )&stats_handler) != pdPASS)
+  {
+    printf("STATS task could not be created as there was insufficient heap memory remaining.\r\n");
+  }
+  else
+  {
+    printf("STATS task was created successfully.\r\n");
+  }
+
+  /* create echo task */
+  if(xTaskCreate((TaskFunction_t )echo_task_function,
+                 (const char*    )"ECHO",
+                 (uint16_t       )128,
+                 (void*          )NULL,
+                 (UBaseType_t    )2,
+                 (TaskHandle_t*  )&echo_handler) != pdPASS)
+  {
+    printf("ECHO task could not be created as there was insufficient heap memory remaining.\r\n");
+  }
+  else
+  {
+    printf("ECHO task was created successfully.\r\n");
+  }
 
   /* exit critical */
   taskEXIT_CRITICAL();
@@ -120,6 +169,40 @@ void led3_task_function(void *pvParameters)
   }
 }
 
+/* stats task function, sends the binary run time report every 5 seconds */
+void stats_task_function(void *pvParameters)
+{
+  while(1)
+  {
+    vTaskDelay(5000);
+    runtime_stats_report_send();
+  }
+}
+
+/* echo task function, sends back what usart1 received. the bytes are read
+   from the pool buffer the dma wrote, then the buffer goes back to the pool */
+void echo_task_function(void *pvParameters)
+{
+  buffer_desc_type *desc;
+  uint16_t index;
+
+  while(1)
+  {
+    desc = serial_rx_receive(portMAX_DELAY);
+    if(desc == NULL)
+    {
+      continue;
+    }
+
+    for(index = 0; index < desc->length; index++)
+    {
+      while(usart_flag_get(PRINT_UART, USART_TDBE_FLAG) == RESET);
+      usart_data_transmit(PRINT_UART, desc->data[index]);
+    }
+    buffer_pool_release(desc);
+  }
+}
+
 /**
   * @}
   */
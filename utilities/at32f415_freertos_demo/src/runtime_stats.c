@@ -0,0 +1,270 @@
+/**
+  **************************************************************************
+  * @file     runtime_stats.c
+  * @brief    freertos run-time statistics and binary report
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415_board.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "runtime_stats.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+typedef struct
+{
+  int16_t irqn;
+  uint32_t count;
+  uint32_t cycles;
+  uint32_t max_cycles;
+} runtime_stats_isr_record_type;
+
+static runtime_stats_isr_record_type isr_record[RUNTIME_STATS_ISR_MAX];
+static TaskStatus_t task_status[RUNTIME_STATS_MAX_TASKS];
+static uint8_t report_buffer[RUNTIME_STATS_REPORT_MAX];
+
+/**
+  * @brief  start tmr2 as the 32-bit run time counter and the dwt cycle counter
+  *         used for isr timing. called by the kernel through
+  *         portCONFIGURE_TIMER_FOR_RUN_TIME_STATS().
+  * @param  none
+  * @retval none
+  */
+void runtime_stats_timer_init(void)
+{
+  crm_clocks_freq_type crm_clocks_freq_struct = {0};
+  uint32_t tmr_freq;
+  uint8_t slot;
+
+  /* tmr2 runs on apb1, twice the apb1 clock when apb1 is divided */
+  crm_clocks_freq_get(&crm_clocks_freq_struct);
+  tmr_freq = crm_clocks_freq_struct.apb1_freq;
+  if(CRM->cfg_bit.apb1div >= CRM_APB1_DIV_2)
+  {
+    tmr_freq *= 2;
+  }
+  crm_periph_clock_enable(RUNTIME_STATS_TIMER_CRM_CLK, TRUE);
+
+  tmr_32_bit_function_enable(RUNTIME_STATS_TIMER, TRUE);
+  tmr_base_init(RUNTIME_STATS_TIMER, 0xFFFFFFFF, (tmr_freq / RUNTIME_STATS_TIMER_FREQ) - 1);
+  tmr_cnt_dir_set(RUNTIME_STATS_TIMER, TMR_COUNT_UP);
+  tmr_counter_enable(RUNTIME_STATS_TIMER, TRUE);
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  for(slot = 0; slot < RUNTIME_STATS_ISR_MAX; slot++)
+  {
+    isr_record[slot].irqn = 0;
+    isr_record[slot].count = 0;
+    isr_record[slot].cycles = 0;
+    isr_record[slot].max_cycles = 0;
+  }
+}
+
+/**
+  * @brief  run time counter, portGET_RUN_TIME_COUNTER_VALUE().
+  * @param  none
+  * @retval counter value in 1/RUNTIME_STATS_TIMER_FREQ seconds
+  */
+uint32_t runtime_stats_counter_get(void)
+{
+  return tmr_counter_value_get(RUNTIME_STATS_TIMER);
+}
+
+/**
+  * @brief  end an isr measurement started with RUNTIME_STATS_ISR_ENTER().
+  * @param  slot: runtime_stats_isr_type slot of the interrupt
+  * @param  start: value returned by RUNTIME_STATS_ISR_ENTER()
+  * @retval none
+  */
+void runtime_stats_isr_exit(uint8_t slot, uint32_t start)
+{
+  uint32_t cycles = DWT->CYCCNT - start;
+  runtime_stats_isr_record_type *record = &isr_record[slot];
+
+  record->irqn = (int16_t)(SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) - 16;
+  record->count++;
+  record->cycles += cycles;
+
+  if(cycles > record->max_cycles)
+  {
+    record->max_cycles = cycles;
+  }
+}
+
+/**
+  * @brief  crc16-ccitt of the report.
+  * @param  buf: data
+  * @param  len: data length
+  * @retval crc
+  */
+static uint16_t runtime_stats_crc16(const uint8_t *buf, uint16_t len)
+{
+  uint16_t crc = 0xFFFF;
+  uint8_t bit;
+
+  while(len--)
+  {
+    crc ^= (uint16_t)(*buf++) << 8;
+    for(bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+/**
+  * @brief  store little endian values.
+  */
+static uint8_t *runtime_stats_put16(uint8_t *p, uint16_t value)
+{
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  return p + 2;
+}
+
+static uint8_t *runtime_stats_put32(uint8_t *p, uint32_t value)
+{
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+  p[2] = (uint8_t)(value >> 16);
+  p[3] = (uint8_t)(value >> 24);
+  return p + 4;
+}
+
+/**
+  * @brief  build the binary report of task run time, stack high water marks and
+  *         isr time, see runtime_stats.h for the layout.
+  * @param  buf: destination, RUNTIME_STATS_REPORT_MAX bytes are enough
+  * @param  size: size of buf
+  * @retval report length, 0 when buf is too small
+  */
+uint16_t runtime_stats_report_build(uint8_t *buf, uint16_t size)
+{
+  runtime_stats_isr_record_type isr_copy[RUNTIME_STATS_ISR_MAX];
+  uint32_t total_run_time;
+  UBaseType_t task_count, index;
+  uint16_t length;
+  uint8_t *p, name_index;
+  const char *name;
+
+  task_count = uxTaskGetSystemState(task_status, RUNTIME_STATS_MAX_TASKS, &total_run_time);
+
+  /* isr records are updated from interrupts, copy them atomically */
+  __disable_irq();
+  for(index = 0; index < RUNTIME_STATS_ISR_MAX; index++)
+  {
+    isr_copy[index] = isr_record[index];
+  }
+  __enable_irq();
+
+  length = RUNTIME_STATS_HEADER_SIZE + task_count * RUNTIME_STATS_TASK_SIZE + RUNTIME_STATS_ISR_MAX * RUNTIME_STATS_ISR_SIZE + 2;
+  if(length > size)
+  {
+    return 0;
+  }
+
+  p = buf;
+  *p++ = RUNTIME_STATS_SYNC0;
+  *p++ = RUNTIME_STATS_SYNC1;
+  p = runtime_stats_put16(p, length - 6);
+  *p++ = RUNTIME_STATS_VERSION;
+  *p++ = (uint8_t)task_count;
+  *p++ = RUNTIME_STATS_ISR_MAX;
+  *p++ = 0;
+  p = runtime_stats_put32(p, total_run_time);
+  p = runtime_stats_put32(p, RUNTIME_STATS_TIMER_FREQ);
+  p = runtime_stats_put32(p, system_core_clock);
+
+  for(index = 0; index < task_count; index++)
+  {
+    *p++ = (uint8_t)task_status[index].xTaskNumber;
+    *p++ = (uint8_t)task_status[index].eCurrentState;
+    *p++ = (uint8_t)task_status[index].uxCurrentPriority;
+    *p++ = 0;
+
+    name = task_status[index].pcTaskName;
+    for(name_index = 0; name_index < RUNTIME_STATS_NAME_LEN; name_index++)
+    {
+      *p++ = (uint8_t)*name;
+      if(*name != '\0')
+      {
+        name++;
+      }
+    }
+
+    p = runtime_stats_put32(p, task_status[index].ulRunTimeCounter);
+    p = runtime_stats_put16(p, (uint16_t)task_status[index].usStackHighWaterMark);
+    p = runtime_stats_put16(p, 0);
+  }
+
+  for(index = 0; index < RUNTIME_STATS_ISR_MAX; index++)
+  {
+    p = runtime_stats_put16(p, (uint16_t)isr_copy[index].irqn);
+    p = runtime_stats_put16(p, 0);
+    p = runtime_stats_put32(p, isr_copy[index].count);
+    p = runtime_stats_put32(p, isr_copy[index].cycles);
+    p = runtime_stats_put32(p, isr_copy[index].max_cycles);
+  }
+
+  runtime_stats_put16(p, runtime_stats_crc16(&buf[4], length - 6));
+
+  return length;
+}
+
+/**
+  * @brief  send the binary report on the print uart (usart1).
+  * @param  none
+  * @retval none
+  */
+void runtime_stats_report_send(void)
+{
+  uint16_t length, index;
+
+  length = runtime_stats_report_build(report_buffer, sizeof(report_buffer));
+
+  for(index = 0; index < length; index++)
+  {
+    while(usart_flag_get(PRINT_UART, USART_TDBE_FLAG) == RESET);
+    usart_data_transmit(PRINT_UART, report_buffer[index]);
+  }
+  while(usart_flag_get(PRINT_UART, USART_TDC_FLAG) == RESET);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,169 @@
+/**
+  **************************************************************************
+  * @file     serial_rx.c
+  * @brief    usart1 zero-copy dma reception
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "at32f415_board.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "serial_rx.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+static buffer_desc_type rx_desc[SERIAL_RX_BUF_COUNT];
+static uint32_t rx_mem[BUFFER_POOL_MEM_WORDS(SERIAL_RX_BUF_COUNT, SERIAL_RX_BUF_SIZE)];
+static buffer_pool_type rx_pool;
+static buffer_queue_type rx_queue;
+static buffer_dma_rx_type rx_dma;
+
+/**
+  * @brief  start the usart1 reception into the buffer pool. uart_print_init()
+  *         has already set up usart1 and its tx pin, this adds the rx pin, the
+  *         dma channel and the idle line interrupt. called before the
+  *         scheduler starts.
+  * @param  none
+  * @retval error_status (ERROR when the queue cannot be created)
+  */
+error_status serial_rx_init(void)
+{
+  gpio_init_type gpio_init_struct;
+  dma_init_type dma_init_struct;
+
+  buffer_pool_init(&rx_pool, rx_desc, rx_mem, SERIAL_RX_BUF_COUNT, SERIAL_RX_BUF_SIZE);
+  if(buffer_queue_init(&rx_queue, SERIAL_RX_QUEUE_DEPTH) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  crm_periph_clock_enable(CRM_DMA1_PERIPH_CLOCK, TRUE);
+  crm_periph_clock_enable(CRM_GPIOA_PERIPH_CLOCK, TRUE);
+
+  /* configure the usart1 rx pin */
+  gpio_default_para_init(&gpio_init_struct);
+  gpio_init_struct.gpio_mode = GPIO_MODE_INPUT;
+  gpio_init_struct.gpio_pins = GPIO_PINS_10;
+  gpio_init_struct.gpio_pull = GPIO_PULL_UP;
+  gpio_init(GPIOA, &gpio_init_struct);
+
+  /* dma1 channel5 for usart1 rx, the memory address and count are set for
+     each buffer by the buffer pool library */
+  dma_reset(SERIAL_RX_DMA_CHANNEL);
+  dma_default_para_init(&dma_init_struct);
+  dma_init_struct.buffer_size = SERIAL_RX_BUF_SIZE;
+  dma_init_struct.direction = DMA_DIR_PERIPHERAL_TO_MEMORY;
+  dma_init_struct.memory_base_addr = (uint32_t)rx_mem;
+  dma_init_struct.memory_data_width = DMA_MEMORY_DATA_WIDTH_BYTE;
+  dma_init_struct.memory_inc_enable = TRUE;
+  dma_init_struct.peripheral_base_addr = (uint32_t)&USART1->dt;
+  dma_init_struct.peripheral_data_width = DMA_PERIPHERAL_DATA_WIDTH_BYTE;
+  dma_init_struct.peripheral_inc_enable = FALSE;
+  dma_init_struct.priority = DMA_PRIORITY_MEDIUM;
+  dma_init_struct.loop_mode_enable = FALSE;
+  dma_init(SERIAL_RX_DMA_CHANNEL, &dma_init_struct);
+  dma_flexible_config(DMA1, FLEX_CHANNEL5, DMA_FLEXIBLE_UART1_RX);
+  dma_interrupt_enable(SERIAL_RX_DMA_CHANNEL, DMA_FDT_INT, TRUE);
+
+  /* both interrupts hand buffers to a queue, so they stay within the kernel
+     syscall priority. they share one priority and never preempt each other,
+     the dma receive handler is not reentrant */
+  nvic_irq_enable(DMA1_Channel5_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+  nvic_irq_enable(USART1_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY, 0);
+
+  rx_dma.dma_channel = SERIAL_RX_DMA_CHANNEL;
+  rx_dma.pool = &rx_pool;
+  rx_dma.queue = &rx_queue;
+  rx_dma.item_size = 1;
+  if(buffer_dma_rx_start(&rx_dma) != SUCCESS)
+  {
+    return ERROR;
+  }
+
+  usart_dma_receiver_enable(USART1, TRUE);
+  usart_interrupt_enable(USART1, USART_IDLE_INT, TRUE);
+  usart_receiver_enable(USART1, TRUE);
+
+  return SUCCESS;
+}
+
+/**
+  * @brief  take the next received buffer, the caller owns it until it calls
+  *         buffer_pool_release().
+  * @param  wait: ticks to wait for a buffer
+  * @retval descriptor, data and length of the received bytes, or NULL on timeout
+  */
+buffer_desc_type* serial_rx_receive(TickType_t wait)
+{
+  return buffer_queue_receive(&rx_queue, wait);
+}
+
+/**
+  * @brief  dma1 channel5 full data interrupt: the buffer is full.
+  * @param  none
+  * @retval none
+  */
+void serial_rx_dma_irq_handler(void)
+{
+  BaseType_t woken = pdFALSE;
+
+  if(dma_interrupt_flag_get(SERIAL_RX_DMA_FDT_FLAG) != RESET)
+  {
+    dma_flag_clear(SERIAL_RX_DMA_FDT_FLAG);
+    buffer_dma_rx_irq_handler(&rx_dma, &woken);
+  }
+
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+  * @brief  usart1 idle line interrupt: the sender paused, hand over the bytes
+  *         received so far.
+  * @param  none
+  * @retval none
+  */
+void serial_rx_usart_irq_handler(void)
+{
+  BaseType_t woken = pdFALSE;
+
+  if(usart_interrupt_flag_get(USART1, USART_IDLEF_FLAG) != RESET)
+  {
+    usart_flag_clear(USART1, USART_IDLEF_FLAG);
+    buffer_dma_rx_irq_handler(&rx_dma, &woken);
+  }
+
+  portYIELD_FROM_ISR(woken);
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
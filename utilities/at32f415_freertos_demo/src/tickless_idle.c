@@ -0,0 +1,371 @@
+/**
+  **************************************************************************
+  * @file     tickless_idle.c
+  * @brief    freertos tickless idle with ertc wakeup
+  **************************************************************************
+  *
+  * Copyright (c) 2025, Artery Technology, All rights reserved.
+  *
+  * The software Board Support Package (BSP) that is made available to
+  * download from Artery official website is the copyrighted work of Artery.
+  * Artery authorizes customers to use, copy, and distribute the BSP
+  * software and its related documentation for the purpose of design and
+  * development in conjunction with Artery microcontrollers. Use of the
+  * software is governed by this copyright notice and the following disclaimer.
+  *
+  * THIS SOFTWARE IS PROVIDED ON "AS IS" BASIS WITHOUT WARRANTIES,
+  * GUARANTEES OR REPRESENTATIONS OF ANY KIND. ARTERY EXPRESSLY DISCLAIMS,
+  * TO THE FULLEST EXTENT PERMITTED BY LAW, ALL EXPRESS, IMPLIED OR
+  * STATUTORY OR OTHER WARRANTIES, GUARANTEES OR REPRESENTATIONS,
+  * INCLUDING BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, OR NON-INFRINGEMENT.
+  *
+  **************************************************************************
+  */
+
+/* includes ------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "tickless_idle.h"
+
+/** @addtogroup UTILITIES_examples
+  * @{
+  */
+
+/** @addtogroup FreeRTOS_demo
+  * @{
+  */
+
+/*
+ * time is kept in "units" while the tick is suppressed:
+ *   one tick            = TICKLESS_SBS_FREQ units
+ *   one ertc sbs count  = configTICK_RATE_HZ units
+ * so both the systick phase and the ertc measurement are exact integers.
+ */
+#define TICKLESS_STAMP_WRAP              (3600UL * TICKLESS_SBS_FREQ)
+
+#if (configUSE_TICKLESS_IDLE == 2)
+
+static uint32_t timer_counts_for_one_tick = 0;
+
+/**
+  * @brief  read the ertc time as sub second counts inside the current hour.
+  * @param  none
+  * @retval ck_a counts from the beginning of the hour
+  */
+static uint32_t tickless_stamp_get(void)
+{
+  ertc_reg_time_type reg_tm;
+  uint32_t sbs;
+
+  /* direct read is enabled, read again until both registers are coherent */
+  do
+  {
+    sbs = ERTC->sbs;
+    reg_tm.time = ERTC->time;
+  } while((sbs != ERTC->sbs) || (reg_tm.time != ERTC->time));
+
+  return ((ertc_bcd_to_num(reg_tm.time_bit.m) * 60 + ertc_bcd_to_num(reg_tm.time_bit.s)) * TICKLESS_SBS_FREQ) + \
+         (TICKLESS_ERTC_DIV_B - (sbs & 0xFFFF));
+}
+
+/**
+  * @brief  wait for the next sub second edge so that measurements start and end
+  *         on an exact ck_a boundary.
+  * @param  none
+  * @retval stamp of the edge
+  */
+static uint32_t tickless_stamp_edge_wait(void)
+{
+  uint32_t stamp = tickless_stamp_get(), edge;
+
+  while((edge = tickless_stamp_get()) == stamp)
+  {
+  }
+
+  return edge;
+}
+
+/**
+  * @brief  restart hext and pll after deep sleep (pll setting is retained).
+  * @param  none
+  * @retval none
+  */
+static void tickless_clock_recover(void)
+{
+  volatile uint32_t index;
+
+  /* wait 3 lick cycles to ensure hick is stable */
+  for(index = 0; index < TICKLESS_CLOCK_STABLE_LOOPS; index++)
+  {
+  }
+
+  crm_clock_source_enable(CRM_CLOCK_SOURCE_HEXT, TRUE);
+  while(crm_hext_stable_wait() == ERROR)
+  {
+  }
+
+  crm_clock_source_enable(CRM_CLOCK_SOURCE_PLL, TRUE);
+  while(crm_flag_get(CRM_PLL_STABLE_FLAG) != SET)
+  {
+  }
+
+  crm_auto_step_mode_enable(TRUE);
+  crm_sysclk_switch(CRM_SCLK_PLL);
+  while(crm_sysclk_switch_status_get() != CRM_SCLK_PLL)
+  {
+  }
+  crm_auto_step_mode_enable(FALSE);
+}
+
+/**
+  * @brief  arm the ertc wakeup timer.
+  * @param  periods: wakeup timer periods (1 ~ TICKLESS_WAT_MAX_PERIODS)
+  * @retval none
+  */
+static void tickless_wakeup_arm(uint32_t periods)
+{
+  ertc_wakeup_enable(FALSE);
+  ertc_wakeup_counter_set(periods - 1);
+  ertc_flag_clear(ERTC_WATF_FLAG);
+  exint_flag_clear(EXINT_LINE_22);
+  ertc_wakeup_enable(TRUE);
+}
+
+#endif
+
+/**
+  * @brief  convert a suppressed period into whole ticks.
+  * @note   pure function, the remainder is returned so that nothing is lost
+  *         between sleeps: the caller restarts systick from that phase.
+  * @param  pre_units: part of the current tick elapsed before the sleep (units)
+  * @param  sbs_counts: sleep length measured by the ertc (ck_a counts)
+  * @param  phase_units: part of the next tick already elapsed (units)
+  * @retval whole ticks elapsed
+  */
+uint32_t tickless_idle_compensate(uint32_t pre_units, uint32_t sbs_counts, uint32_t *phase_units)
+{
+  uint32_t total = pre_units + sbs_counts * configTICK_RATE_HZ;
+
+  *phase_units = total % TICKLESS_SBS_FREQ;
+
+  return total / TICKLESS_SBS_FREQ;
+}
+
+/**
+  * @brief  ertc counts between two stamps, the stamp wraps every hour.
+  * @param  start: stamp at the beginning of the sleep
+  * @param  stop: stamp at the end of the sleep
+  * @retval ck_a counts elapsed (less than one hour)
+  */
+uint32_t tickless_idle_stamp_elapsed(uint32_t start, uint32_t stop)
+{
+  return (stop + TICKLESS_STAMP_WRAP - start) % TICKLESS_STAMP_WRAP;
+}
+
+/**
+  * @brief  systick cycles into units, rounded: a truncation would lose half
+  *         a unit on average at every sleep and the tick would fall behind.
+  * @param  cycles: systick cycles
+  * @param  cycles_per_tick: systick cycles of one tick
+  * @retval units
+  */
+uint32_t tickless_idle_cycles_to_units(uint32_t cycles, uint32_t cycles_per_tick)
+{
+  return (cycles * TICKLESS_SBS_FREQ + cycles_per_tick / 2) / cycles_per_tick;
+}
+
+/**
+  * @brief  units into systick cycles, rounded.
+  * @param  units: units, up to one tick
+  * @param  cycles_per_tick: systick cycles of one tick
+  * @retval cycles
+  */
+uint32_t tickless_idle_units_to_cycles(uint32_t units, uint32_t cycles_per_tick)
+{
+  return (units * cycles_per_tick + TICKLESS_SBS_FREQ / 2) / TICKLESS_SBS_FREQ;
+}
+
+#if (configUSE_TICKLESS_IDLE == 2)
+
+/**
+  * @brief  enter sleep or deep sleep with the tick suppressed, the ertc wakeup
+  *         timer bounds the sleep and the ertc sub second counter measures it.
+  * @param  xExpectedIdleTime: ticks until the next task unblocks
+  * @retval none
+  */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  uint32_t start, stop, pre_units, phase_units, elapsed_ticks, reload, periods;
+  TickType_t modifiable_idle_time, sleep_ticks;
+  confirm_state deep_sleep;
+
+  if(xExpectedIdleTime > (TICKLESS_WAT_MAX_PERIODS * configTICK_RATE_HZ / TICKLESS_WAT_FREQ))
+  {
+    xExpectedIdleTime = TICKLESS_WAT_MAX_PERIODS * configTICK_RATE_HZ / TICKLESS_WAT_FREQ;
+  }
+
+  deep_sleep = (xExpectedIdleTime >= TICKLESS_DEEP_SLEEP_MIN_TICKS) ? TRUE : FALSE;
+  sleep_ticks = xExpectedIdleTime - ((deep_sleep == TRUE) ? TICKLESS_DEEP_SLEEP_WAKEUP_TICKS : 0);
+
+  /* wake up at or before the expected time, never after */
+  periods = (sleep_ticks * TICKLESS_WAT_FREQ) / configTICK_RATE_HZ;
+  if(periods == 0)
+  {
+    return;
+  }
+
+  /* align on a sub second edge with interrupts still enabled */
+  start = tickless_stamp_edge_wait();
+
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  if(eTaskConfirmSleepModeStatus() == eAbortSleep)
+  {
+    __enable_irq();
+    return;
+  }
+
+  /* stop systick, the part of the tick already elapsed is kept as pre_units */
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  pre_units = tickless_idle_cycles_to_units(timer_counts_for_one_tick - 1 - SysTick->VAL, timer_counts_for_one_tick);
+
+  /* an interrupt may have delayed us past the edge */
+  start = tickless_stamp_get();
+
+  tickless_wakeup_arm(periods);
+
+  modifiable_idle_time = xExpectedIdleTime;
+  configPRE_SLEEP_PROCESSING(modifiable_idle_time);
+  if(modifiable_idle_time > 0)
+  {
+    if(deep_sleep == TRUE)
+    {
+      pwc_voltage_regulate_set(PWC_REGULATOR_LOW_POWER);
+      pwc_deep_sleep_mode_enter(PWC_DEEP_SLEEP_ENTER_WFI);
+      tickless_clock_recover();
+    }
+    else
+    {
+      pwc_sleep_mode_enter(PWC_SLEEP_ENTER_WFI);
+    }
+  }
+  configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+  ertc_wakeup_enable(FALSE);
+
+  /* end on an exact edge too, then account for the whole suppressed period */
+  stop = tickless_stamp_edge_wait();
+  elapsed_ticks = tickless_idle_compensate(pre_units, tickless_idle_stamp_elapsed(start, stop), &phase_units);
+
+  /* restart systick from the phase reached inside the current tick */
+  reload = timer_counts_for_one_tick - tickless_idle_units_to_cycles(phase_units, timer_counts_for_one_tick);
+  SysTick->LOAD = reload - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD = timer_counts_for_one_tick - 1;
+
+  if(elapsed_ticks >= xExpectedIdleTime)
+  {
+    /* the last tick is processed by the pended systick. the idle task holds
+       the scheduler suspended here, so xTaskCatchUpTicks() would assert: the
+       ticks slept past it are pended the same way instead and processed by
+       the xTaskResumeAll() that follows this function */
+    vTaskStepTick(xExpectedIdleTime - 1);
+    SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    for(elapsed_ticks -= xExpectedIdleTime; elapsed_ticks > 0; elapsed_ticks--)
+    {
+      (void)xTaskIncrementTick();
+    }
+  }
+  else
+  {
+    vTaskStepTick(elapsed_ticks);
+  }
+
+  __enable_irq();
+}
+
+#endif
+
+/**
+  * @brief  configure the ertc as the tickless idle time base.
+  * @note   call before vTaskStartScheduler(). the battery powered domain is
+  *         reset, clearing the calendar and the bpr registers, only when the
+  *         ertc does not already run on lext: its clock source cannot change
+  *         otherwise. a running calendar keeps its time, only the dividers
+  *         are set again.
+  * @param  none
+  * @retval none
+  */
+void tickless_idle_init(void)
+{
+  exint_init_type exint_init_struct;
+
+  crm_periph_clock_enable(CRM_PWC_PERIPH_CLOCK, TRUE);
+  pwc_battery_powered_domain_access(TRUE);
+
+  if((CRM->bpdc_bit.ertcsel != CRM_ERTC_CLOCK_LEXT) || (CRM->bpdc_bit.ertcen == FALSE))
+  {
+    crm_battery_powered_domain_reset(TRUE);
+    crm_battery_powered_domain_reset(FALSE);
+
+    crm_clock_source_enable(CRM_CLOCK_SOURCE_LEXT, TRUE);
+    while(crm_flag_get(CRM_LEXT_STABLE_FLAG) == RESET)
+    {
+    }
+
+    crm_ertc_clock_select(CRM_ERTC_CLOCK_LEXT);
+    crm_ertc_clock_enable(TRUE);
+
+    ertc_reset();
+  }
+  ertc_wait_update();
+  ertc_divider_set(TICKLESS_ERTC_DIV_A, TICKLESS_ERTC_DIV_B);
+  ertc_hour_mode_set(ERTC_HOUR_MODE_24);
+
+  /* read time and sub second without waiting for the shadow registers */
+  ertc_direct_read_enable(TRUE);
+
+  ertc_wakeup_enable(FALSE);
+  ertc_wakeup_clock_set(ERTC_WAT_CLK_ERTCCLK_DIV16);
+  ertc_interrupt_enable(ERTC_WAT_INT, TRUE);
+
+  /* the wakeup event reaches the core through exint line 22 in deep sleep */
+  exint_default_para_init(&exint_init_struct);
+  exint_init_struct.line_enable   = TRUE;
+  exint_init_struct.line_mode     = EXINT_LINE_INTERRUPT;
+  exint_init_struct.line_select   = EXINT_LINE_22;
+  exint_init_struct.line_polarity = EXINT_TRIGGER_RISING_EDGE;
+  exint_init(&exint_init_struct);
+
+  nvic_irq_enable(ERTC_WKUP_IRQn, configLIBRARY_LOWEST_INTERRUPT_PRIORITY, 0);
+
+#if (configUSE_TICKLESS_IDLE == 2)
+  timer_counts_for_one_tick = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+#endif
+}
+
+/**
+  * @brief  clear the ertc wakeup flags, called from ERTC_WKUP_IRQHandler.
+  * @param  none
+  * @retval none
+  */
+void tickless_idle_wakeup_handler(void)
+{
+  if(ertc_interrupt_flag_get(ERTC_WATF_FLAG) != RESET)
+  {
+    ertc_flag_clear(ERTC_WATF_FLAG);
+    exint_flag_clear(EXINT_LINE_22);
+  }
+}
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# **************************************************************************
+# file     runtime_stats_viewer.py
+# brief    decode the freertos demo run time reports (see inc/runtime_stats.h)
+# **************************************************************************
+#
+# usage: runtime_stats_viewer.py <serial port> [baudrate]   (needs pyserial)
+#        runtime_stats_viewer.py <capture file>
+#
+# the cpu load of each task is computed from the difference of two reports,
+# counters are 32-bit and wrap, so the differences are taken modulo 2^32.
+
+import struct
+import sys
+
+SYNC = b'\xa5\x5a'
+HEADER = struct.Struct('<BBBBIII')
+TASK = struct.Struct('<BBBB8sIHH')
+ISR = struct.Struct('<hHIII')
+STATES = {0: 'run', 1: 'ready', 2: 'block', 3: 'susp', 4: 'del'}
+
+
+def crc16(data):
+    crc = 0xffff
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xffff
+    return crc
+
+
+def frames(read):
+    buf = b''
+    while True:
+        chunk = read()
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                buf = buf[-1:]
+                break
+            buf = buf[start:]
+            if len(buf) < 4:
+                break
+            length = buf[2] | (buf[3] << 8)
+            if len(buf) < 4 + length + 2:
+                break
+            payload = buf[4:4 + length]
+            crc = buf[4 + length] | (buf[5 + length] << 8)
+            if crc == crc16(payload):
+                yield payload
+                buf = buf[6 + length:]
+            else:
+                buf = buf[1:]
+
+
+def decode(payload):
+    version, task_count, isr_count, _, total, freq, cpu_freq = HEADER.unpack_from(payload, 0)
+    offset = HEADER.size
+    tasks = {}
+    for _ in range(task_count):
+        number, state, prio, _, name, run, hwm, _ = TASK.unpack_from(payload, offset)
+        offset += TASK.size
+        tasks[number] = (name.rstrip(b'\0').decode(errors='replace'), state, prio, run, hwm)
+    isrs = []
+    for _ in range(isr_count):
+        isrs.append(ISR.unpack_from(payload, offset))
+        offset += ISR.size
+    return total, freq, cpu_freq, tasks, isrs
+
+
+def show(previous, current):
+    total, freq, cpu_freq, tasks, isrs = current
+    elapsed = (total - previous[0]) & 0xffffffff if previous else total
+    print('--- %.3f s of run time' % (elapsed / freq))
+    print('%-3s %-8s %-5s %4s %7s %10s' % ('#', 'task', 'state', 'prio', 'cpu%', 'stack free'))
+    for number in sorted(tasks):
+        name, state, prio, run, hwm = tasks[number]
+        if previous and number in previous[3]:
+            run = (run - previous[3][number][3]) & 0xffffffff
+        load = 100.0 * run / elapsed if elapsed else 0.0
+        print('%-3d %-8s %-5s %4d %6.1f%% %10d' % (number, name, STATES.get(state, '?'), prio, load, hwm * 4))
+    for index, (irqn, _, count, cycles, max_cycles) in enumerate(isrs):
+        if count == 0:
+            continue
+        if previous:
+            count = (count - previous[4][index][2]) & 0xffffffff
+            cycles = (cycles - previous[4][index][3]) & 0xffffffff
+        busy = 100.0 * cycles / cpu_freq / (elapsed / freq) if elapsed else 0.0
+        print('irq %-3d count %-8d load %5.2f%% max %d cycles' % (irqn, count, busy, max_cycles))
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage: runtime_stats_viewer.py <serial port|capture file> [baudrate]')
+    try:
+        import serial
+        port = serial.Serial(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else 115200, timeout=1)
+
+        def read():
+            data = b''
+            while not data:
+                data = port.read(256)
+            return data
+    except (ImportError, OSError, ValueError):
+        stream = open(sys.argv[1], 'rb')
+        read = lambda: stream.read(256)
+    previous = None
+    for payload in frames(read):
+        current = decode(payload)
+        show(previous, current)
+        previous = current
+
+
+if __name__ == '__main__':
+    main()